@@ -181,6 +181,7 @@ typedef struct fileinfo {
 	char		*bptr;		/* Buffer pointer	*/
 	int		line;		/* for include or macro */
 	FILE		*fp;		/* File if non-null	*/
+	char		*data;		/* Read from memory if non-null */
 	struct fileinfo *parent;	/* Link to includer	*/
 	char		*filename;	/* File/macro name	*/
 	char		*progname;	/* From #line statement */
@@ -103,6 +103,7 @@ int PREFIX fppPreProcess(REG(a0) struct fppTag *tags)
   global->output=NULL;
   global->error=NULL;
   global->dependency=NULL;
+  global->fileinput=NULL;
   global->first_file=NULL;
   global->userdata=NULL;
 
@@ -33,10 +33,19 @@ ReturnCode openfile(struct Global *global, char *filename)
    */
 
   FILE *fp;
+  char *data = NULL;
   ReturnCode ret;
 
-  //
-  if ((fp = fopen(filename, "r")) == NULL)
+  if (global->fileinput)
+    data = global->fileinput(filename, global->userdata);
+
+  if (data != NULL) {
+    /* Read from memory, stdin marks it as a file like the main input. */
+    ret=addfile(global, stdin, filename);
+    if(!ret)
+      global->infile->data = data;
+  }
+  else if ((fp = fopen(filename, "r")) == NULL)
     ret=FPP_OPEN_ERROR;
   else
     ret=addfile(global, fp, filename);
@@ -251,6 +260,9 @@ int dooptions(struct Global *global, struct fppTag *tags)
 	case FPPTAG_DEPENDENCY:
       global->dependency=(void (*)(char *))tags->data;
       break;
+    case FPPTAG_FILEINPUT:
+      global->fileinput=(char *(*)(char *, void *))tags->data;
+      break;
     case FPPTAG_ERROR:
       global->error=(void (*)(void *, char *, va_list))tags->data;
       break;
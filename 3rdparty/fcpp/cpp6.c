@@ -510,6 +510,7 @@ ReturnCode getfile(struct Global *global,
     return(FPP_OUT_OF_MEMORY);
   (*file)->parent = global->infile;             /* Chain files together */
   (*file)->fp = NULL;                           /* No file yet          */
+  (*file)->data = NULL;                         /* Not from memory      */
   (*file)->filename = savestring(global, name); /* Save file/macro name */
   (*file)->progname = NULL;                     /* No #line seen yet    */
   (*file)->unrecur = 0;                         /* No macro fixup       */
@@ -699,6 +700,27 @@ void outadefine(struct Global *global, DEFBUF *dp)
   Putchar(global, '\n');
 }
 
+static char *memgets(char *buffer, int size, char **data)
+{
+  /*
+   * Like fgets(), but reads the next line from a NUL terminated string
+   * and advances *data past it.
+   */
+  char *src = *data;
+  int len = 0;
+
+  if (*src == EOS)
+    return(NULL);
+  while (len < (size - 1) && src[len] != EOS) {
+    buffer[len] = src[len];
+    if (src[len++] == '\n')
+      break;
+  }
+  buffer[len] = EOS;
+  *data = src + len;
+  return(buffer);
+}
+
 /*
  *                      G E T
  */
@@ -748,12 +770,15 @@ int get(struct Global *global)
 
       if(global->input && global->first_file && !strcmp(global->first_file, file->filename))
         file->bptr = global->input(file->buffer, NBUFF, global->userdata);
+      else if(file->data)
+        file->bptr = memgets(file->buffer, NBUFF, &file->data);
       else
         file->bptr = fgets(file->buffer, NBUFF, file->fp);
       if(file->bptr != NULL) {
         goto newline;           /* process the line     */
       } else {
-        if(!(global->input && global->first_file && !strcmp(global->first_file, file->filename)))
+        if(!(global->input && global->first_file && !strcmp(global->first_file, file->filename)) &&
+           !file->data)
           /* If the input function isn't user supplied, close the file! */
           fclose(file->fp);           /* Close finished file  */
         if ((global->infile = file->parent) != NULL) {
@@ -211,6 +211,8 @@ struct Global {
 
   void (*dependency)(char *, void *);   /* dependency function */
 
+  char *(*fileinput)(char *, void *);   /* file input function */
+
   char linelines;
 
   char warnillegalcpp; /* warn for illegal preprocessor instructions? */
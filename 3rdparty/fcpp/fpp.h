@@ -159,4 +159,7 @@ struct fppTag {
 /* Dependency function: */
 #define FPPTAG_DEPENDENCY 34 /* data is a dependency function void(char*, void*) */
 
+/* File input function, returns file contents or NULL to read from disk: */
+#define FPPTAG_FILEINPUT 35 /* data is a file input function char*(char*, void*) */
+
 int PREFIX fppPreProcess(REG(a0) struct fppTag *);
@@ -18,6 +18,7 @@
 #include "graphics/render_resources.h"
 #include "graphics/material.h"
 #include "graphics/model.h"
+#include "graphics/texture_streaming.h"
 #include "imgui/manager.h"
 #include "job/function_job.h"
 #include "test_shared.h"
@@ -296,9 +297,11 @@ void DrawRenderPackets(Core::ArrayView<RenderPacketBase*> packets, const DrawCon
 	rmt_ScopedCPUSample(DrawRenderPackets, RMTSF_None);
 	if(auto event = drawCtx.cmdList_.Eventf(0, "DrawRenderPackets(\"%s\")", drawCtx.passName_))
 	{
-		// Gather mesh packets for this pass.
+		// Gather mesh & cluster mesh packets for this pass.
 		Core::Vector<MeshRenderPacket*> meshPackets;
 		Core::Vector<i32> meshPassTechIndices;
+		Core::Vector<ClusterMeshRenderPacket*> clusterPackets;
+		Core::Vector<i32> clusterPassTechIndices;
 		meshPackets.reserve(packets.size());
 		meshPassTechIndices.reserve(packets.size());
 		for(auto& packet : packets)
@@ -313,9 +316,20 @@ void DrawRenderPackets(Core::ArrayView<RenderPacketBase*> packets, const DrawCon
 					meshPassTechIndices.push_back(*passIdxIt);
 				}
 			}
+			else if(packet->type_ == ClusterMeshRenderPacket::TYPE)
+			{
+				auto* clusterPacket = static_cast<ClusterMeshRenderPacket*>(packet);
+				auto passIdxIt = clusterPacket->techs_->passIndices_.find(drawCtx.passName_);
+				if(passIdxIt != nullptr && *passIdxIt < clusterPacket->techs_->passTechniques_.size())
+				{
+					clusterPackets.push_back(clusterPacket);
+					clusterPassTechIndices.push_back(*passIdxIt);
+				}
+			}
 		}
 
-		MeshRenderPacket::DrawPackets(meshPackets, meshPassTechIndices, drawCtx);
+		MeshRenderPacket::DrawPackets(meshPackets, meshPassTechIndices, drawCtx, MeshRenderPacket::DrawMode::INDIRECT);
+		ClusterMeshRenderPacket::DrawPackets(clusterPackets, clusterPassTechIndices, drawCtx);
 	}
 }
 
@@ -424,6 +438,12 @@ void RunApp(const Core::CommandLine& cmdLine, IApp& app)
 			// Wait for reloading to occur. No important jobs should be running at this point.
 			Resource::Manager::WaitOnReload();
 
+			// Stream texture levels requested last frame, and update material bindings to match.
+			{
+				rmt_ScopedCPUSample(TextureStreaming, RMTSF_None);
+				Graphics::TextureStreaming::Update();
+			}
+
 			times_.getProfileData_ = Core::Timer::GetAbsoluteTime();
 
 			if(profilingEnabled)
@@ -456,6 +476,7 @@ void RunApp(const Core::CommandLine& cmdLine, IApp& app)
 				ImGui::Text("Process deletions: %f ms", times_.processDeletions_ * 1000.0);
 				ImGui::Text("Frame Time: %f ms", times_.frame_ * 1000.0, 1.0f / times_.frame_);
 				ImGui::Text("Tick Time: %f ms (%.2f FPS)", times_.tick_ * 1000.0, 1.0f / times_.tick_);
+				ImGui::Text("Commands: %i", GPU::Manager::GetNumFrameCommands());
 
 				auto genAllocStats = Core::GeneralAllocator().GetStats();
 				auto virAllocStats = Core::VirtualAllocator().GetStats();
@@ -540,12 +561,22 @@ void RunApp(const Core::CommandLine& cmdLine, IApp& app)
 			}
 
 
+			// Packets have no screen bounds, so request texture levels for materials drawn at full resolution.
+			const f32 textureScreenSize = (f32)Core::Max(w_, h_);
 			for(auto& packet : packets_)
 			{
 				if(packet->type_ == MeshRenderPacket::TYPE)
 				{
 					auto* meshPacket = static_cast<MeshRenderPacket*>(packet);
 					forwardPipeline.CreateTechniques(meshPacket->material_, meshPacket->techDesc_, *meshPacket->techs_);
+					meshPacket->material_->RequestTextureLevels(textureScreenSize);
+				}
+				else if(packet->type_ == ClusterMeshRenderPacket::TYPE)
+				{
+					auto* clusterPacket = static_cast<ClusterMeshRenderPacket*>(packet);
+					forwardPipeline.CreateTechniques(
+					    clusterPacket->material_, clusterPacket->techDesc_, *clusterPacket->techs_);
+					clusterPacket->material_->RequestTextureLevels(textureScreenSize);
 				}
 			}
 
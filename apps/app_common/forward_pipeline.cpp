@@ -5,6 +5,7 @@
 #include "gpu/command_list.h"
 #include "gpu/resources.h"
 #include "gpu/utils.h"
+#include "graphics/cluster_culling.h"
 #include "graphics/render_graph.h"
 #include "graphics/render_pass.h"
 #include "resource/manager.h"
@@ -32,7 +33,9 @@ static RenderGraphTextureDesc GetDepthTextureDesc(i32 w, i32 h)
 }
 
 const RenderGraphBufferDesc viewCBDesc = RenderGraphBufferDesc(sizeof(ViewConstants));
-const RenderGraphBufferDesc objectSBDesc = RenderGraphBufferDesc(sizeof(ObjectConstants) * 100000);
+const RenderGraphBufferDesc objectSBDesc =
+    RenderGraphBufferDesc(sizeof(ObjectConstants) * MeshRenderPacket::MAX_DRAW_OBJECTS);
+const RenderGraphBufferDesc drawArgsDesc = RenderGraphBufferDesc(MeshRenderPacket::MAX_DRAW_ARGS_SIZE);
 
 struct LightConstants
 {
@@ -52,6 +55,7 @@ struct CommonBuffers
 {
 	RenderGraphResource viewCB_;
 	RenderGraphResource objectSB_;
+	RenderGraphResource drawArgs_;
 };
 
 struct LightCullingData
@@ -71,6 +75,40 @@ struct BaseDrawFnData
 	DrawFn drawFn_;
 };
 
+/// Cluster culling outputs read by a draw pass.
+struct ClusterDrawData
+{
+	const ClusterScene* scene_ = nullptr;
+	RenderGraphResource inTransforms_;
+	RenderGraphResource inDrawArgs_;
+	RenderGraphResource inDrawCounts_;
+};
+
+static ClusterDrawData ReadClusterDrawData(
+    RenderGraphBuilder& builder, const ClusterScene* scene, const ClusterCullingData& clusters)
+{
+	ClusterDrawData data;
+	if(scene && clusters.outDrawArgs_)
+	{
+		data.scene_ = scene;
+		data.inTransforms_ = builder.Read(clusters.outTransforms_, GPU::BindFlags::SHADER_RESOURCE);
+		data.inDrawArgs_ = builder.Read(clusters.outDrawArgs_, GPU::BindFlags::INDIRECT_BUFFER);
+		data.inDrawCounts_ = builder.Read(clusters.outDrawCounts_, GPU::BindFlags::INDIRECT_BUFFER);
+	}
+	return data;
+}
+
+static void SetClusterDrawContext(RenderGraphResources& res, const ClusterDrawData& data, DrawContext& drawCtx)
+{
+	if(data.scene_)
+	{
+		drawCtx.clusterScene_ = data.scene_;
+		drawCtx.clusterTransformsHandle_ = res.GetBuffer(data.inTransforms_);
+		drawCtx.clusterDrawArgsHandle_ = res.GetBuffer(data.inDrawArgs_);
+		drawCtx.clusterDrawCountsHandle_ = res.GetBuffer(data.inDrawCounts_);
+	}
+}
+
 static LightCullingData AddLightCullingPasses(DrawFn drawFn, RenderGraph& renderGraph, const CommonBuffers& cbs,
     RenderGraphResource depth, Shader* shader, const Core::ArrayView<Light>& lights)
 {
@@ -166,6 +204,8 @@ static LightCullingData AddLightCullingPasses(DrawFn drawFn, RenderGraph& render
 	    renderGraph
 	        .AddCallbackRenderPass<ComputeTileInfoPassData>("Compute Tile Info",
 	            [&](RenderGraphBuilder& builder, ComputeTileInfoPassData& data) {
+		            builder.SetAsyncCompute();
+
 		            data.drawFn_ = drawFn;
 		            data.light_ = light;
 
@@ -217,6 +257,8 @@ static LightCullingData AddLightCullingPasses(DrawFn drawFn, RenderGraph& render
 	    renderGraph
 	        .AddCallbackRenderPass<ComputeLightListsPassData>("Compute Light Lists",
 	            [&](RenderGraphBuilder& builder, ComputeLightListsPassData& data) {
+		            builder.SetAsyncCompute();
+
 		            data.drawFn_ = drawFn;
 		            data.light_ = light;
 		            data.depthFormat_ = GPU::GetSRVFormatDepth(dsDesc.format_);
@@ -365,22 +407,26 @@ struct DepthData
 	RenderGraphResource outDepth_;
 	RenderGraphResource outHiZ_;
 	RenderGraphResource outObjectSB_;
+	RenderGraphResource outDrawArgs_;
 
 	GPU::FrameBindingSetDesc fbsDesc_;
 };
 
 static DepthData AddDepthPasses(DrawFn drawFn, RenderGraph& renderGraph, const CommonBuffers& cbs,
-    const RenderGraphTextureDesc& depthDesc, Shader* shader, RenderGraphResource depth, RenderGraphResource objectSB)
+    const RenderGraphTextureDesc& depthDesc, Shader* shader, RenderGraphResource depth, RenderGraphResource objectSB,
+    RenderGraphResource drawArgs, const ClusterScene* clusterScene, const ClusterCullingData& clusters)
 {
 	struct DepthPassData : BaseDrawFnData
 	{
 		GPU::DrawState drawState_;
+		ClusterDrawData clusters_;
 
 		RenderGraphResource inViewCB_;
 		RenderGraphResource inLightCB_;
 
 		RenderGraphResource outDepth_;
 		RenderGraphResource outObjectSB_;
+		RenderGraphResource outDrawArgs_;
 
 		mutable ShaderBindingSet viewBindings_;
 	};
@@ -419,6 +465,12 @@ static DepthData AddDepthPasses(DrawFn drawFn, RenderGraph& renderGraph, const C
 		    DBG_ASSERT(objectSB);
 		    data.outObjectSB_ = builder.Write(objectSB, GPU::BindFlags::SHADER_RESOURCE);
 
+		    // Indirect draw arguments.
+		    DBG_ASSERT(drawArgs);
+		    data.outDrawArgs_ = builder.Write(drawArgs, GPU::BindFlags::INDIRECT_BUFFER);
+
+		    data.clusters_ = ReadClusterDrawData(builder, clusterScene, clusters);
+
 		    // Setup frame buffer.
 		    data.outDepth_ = builder.SetDSV(depth);
 
@@ -443,7 +495,9 @@ static DepthData AddDepthPasses(DrawFn drawFn, RenderGraph& renderGraph, const C
 		    if(auto viewBind = shaderCtx.BeginBindingScope(data.viewBindings_))
 		    {
 			    DrawContext drawCtx(cmdList, shaderCtx, "RenderPassDepthPrepass", data.drawState_, fbs,
-			        res.GetBuffer(data.inViewCB_), res.GetBuffer(data.outObjectSB_), nullptr);
+			        res.GetBuffer(data.inViewCB_), res.GetBuffer(data.outObjectSB_), nullptr,
+			        res.GetBuffer(data.outDrawArgs_));
+			    SetClusterDrawContext(res, data.clusters_, drawCtx);
 
 			    data.drawFn_(drawCtx);
 		    }
@@ -509,7 +563,7 @@ static DepthData AddDepthPasses(DrawFn drawFn, RenderGraph& renderGraph, const C
 			    {
 				    GPU::Handle ps;
 				    Core::ArrayView<GPU::PipelineBinding> pb;
-				    if(shaderCtx.CommitBindings(data.tech_, ps, pb))
+				    if(shaderCtx.CommitBindings(data.techMip_, ps, pb))
 					    cmdList.Dispatch(ps, pb, GetGroups(w), GetGroups(h), 1);
 			    }
 		    }
@@ -518,6 +572,7 @@ static DepthData AddDepthPasses(DrawFn drawFn, RenderGraph& renderGraph, const C
 	DepthData output;
 	output.outDepth_ = depthPass.GetData().outDepth_;
 	output.outObjectSB_ = depthPass.GetData().outObjectSB_;
+	output.outDrawArgs_ = depthPass.GetData().outDrawArgs_;
 	output.outHiZ_ = hizPass.GetData().outDepth_;
 	output.fbsDesc_ = depthPass.GetFrameBindingDesc();
 	return output;
@@ -528,6 +583,7 @@ struct ForwardData
 	RenderGraphResource outColor_;
 	RenderGraphResource outDepth_;
 	RenderGraphResource outObjectSB_;
+	RenderGraphResource outDrawArgs_;
 
 	GPU::FrameBindingSetDesc fbsDesc_;
 };
@@ -535,12 +591,14 @@ struct ForwardData
 static ForwardData AddForwardPasses(DrawFn drawFn, RenderGraph& renderGraph, const CommonBuffers& cbs,
     const LightCullingData& lightCulling, const RenderGraphTextureDesc& colorDesc, RenderGraphResource color,
     const RenderGraphTextureDesc& depthDesc, RenderGraphResource depth, RenderGraphResource hiz,
-    RenderGraphResource objectSB)
+    RenderGraphResource objectSB, RenderGraphResource drawArgs, const ClusterScene* clusterScene,
+    const ClusterCullingData& clusters)
 {
 	struct ForwardPassData : BaseDrawFnData
 	{
 		GPU::DrawState drawState_;
 		i32 numLights_;
+		ClusterDrawData clusters_;
 
 		RenderGraphResource inViewCB_;
 		RenderGraphResource inLightCB_;
@@ -551,6 +609,7 @@ static ForwardData AddForwardPasses(DrawFn drawFn, RenderGraph& renderGraph, con
 		RenderGraphResource outColor_;
 		RenderGraphResource outDepth_;
 		RenderGraphResource outObjectSB_;
+		RenderGraphResource outDrawArgs_;
 
 		mutable ShaderBindingSet viewBindings_;
 		mutable ShaderBindingSet lightBindings_;
@@ -585,6 +644,12 @@ static ForwardData AddForwardPasses(DrawFn drawFn, RenderGraph& renderGraph, con
 		    DBG_ASSERT(objectSB);
 		    data.outObjectSB_ = builder.Write(objectSB, GPU::BindFlags::SHADER_RESOURCE);
 
+		    // Indirect draw arguments.
+		    DBG_ASSERT(drawArgs);
+		    data.outDrawArgs_ = builder.Write(drawArgs, GPU::BindFlags::INDIRECT_BUFFER);
+
+		    data.clusters_ = ReadClusterDrawData(builder, clusterScene, clusters);
+
 		    // Create binding sets.
 		    data.viewBindings_ = Shader::CreateSharedBindingSet("ViewBindings");
 		    data.lightBindings_ = Shader::CreateSharedBindingSet("LightBindings");
@@ -624,7 +689,9 @@ static ForwardData AddForwardPasses(DrawFn drawFn, RenderGraph& renderGraph, con
 				    if(auto lightTileBind = shaderCtx.BeginBindingScope(data.lightTileBindings_))
 				    {
 					    DrawContext drawCtx(cmdList, shaderCtx, "RenderPassForward", data.drawState_, fbs,
-					        res.GetBuffer(data.inViewCB_), res.GetBuffer(data.outObjectSB_), nullptr);
+					        res.GetBuffer(data.inViewCB_), res.GetBuffer(data.outObjectSB_), nullptr,
+					        res.GetBuffer(data.outDrawArgs_));
+					    SetClusterDrawContext(res, data.clusters_, drawCtx);
 
 					    data.drawFn_(drawCtx);
 				    }
@@ -636,6 +703,7 @@ static ForwardData AddForwardPasses(DrawFn drawFn, RenderGraph& renderGraph, con
 	output.outColor_ = pass.GetData().outColor_;
 	output.outDepth_ = pass.GetData().outDepth_;
 	output.outObjectSB_ = pass.GetData().outObjectSB_;
+	output.outDrawArgs_ = pass.GetData().outDrawArgs_;
 	output.fbsDesc_ = pass.GetFrameBindingDesc();
 	return output;
 }
@@ -719,13 +787,16 @@ ForwardPipeline::ForwardPipeline()
     : Pipeline(FORWARD_RESOURCE_NAMES)
 {
 	Resource::Manager::RequestResource(shader_, "shaders/forward_pipeline.esf");
+	Resource::Manager::RequestResource(clusterShader_, "shaders/cluster_culling.esf");
 	Resource::Manager::WaitForResource(shader_);
+	Resource::Manager::WaitForResource(clusterShader_);
 
 	ShaderTechniqueDesc desc;
 }
 
 ForwardPipeline::~ForwardPipeline()
 {
+	Resource::Manager::ReleaseResource(clusterShader_);
 	Resource::Manager::ReleaseResource(shader_);
 }
 
@@ -795,6 +866,8 @@ void ForwardPipeline::Setup(RenderGraph& renderGraph)
 		        builder.Write(builder.Create("View Constants", viewCBDesc), GPU::BindFlags::CONSTANT_BUFFER);
 		    data.cbs_.objectSB_ =
 		        builder.Write(builder.Create("Object Constants", objectSBDesc), GPU::BindFlags::SHADER_RESOURCE);
+		    data.cbs_.drawArgs_ =
+		        builder.Write(builder.Create("Draw Arguments", drawArgsDesc), GPU::BindFlags::INDIRECT_BUFFER);
 		},
 	    [](RenderGraphResources& res, GPU::CommandList& cmdList, const ViewConstantData& data) {
 		    cmdList.UpdateBuffer(res.GetBuffer(data.cbs_.viewCB_), 0, sizeof(data.view_), cmdList.Push(&data.view_));
@@ -802,8 +875,20 @@ void ForwardPipeline::Setup(RenderGraph& renderGraph)
 
 	auto cbs = renderPassCommonBuffers.GetData().cbs_;
 
-	auto renderPassDepth =
-	    AddDepthPasses(drawFn_, renderGraph, cbs, GetDepthTextureDesc(w, h), shader_, resources_[1], cbs.objectSB_);
+	// Clusters drawn in the depth pass are only frustum & cone culled, so its Hi-Z can cull them for the forward pass.
+	ClusterCullingSettings clusterSettings;
+	clusterSettings.viewProj_ = view_.viewProj_;
+	clusterSettings.eye_ = view_.invView_.Translation();
+
+	ClusterCullingData depthClusters;
+	if(clusterScene_)
+	{
+		clusterSettings.name_ = "Depth Cluster Culling";
+		depthClusters = AddClusterCullingPass(renderGraph, *clusterScene_, clusterShader_, clusterSettings);
+	}
+
+	auto renderPassDepth = AddDepthPasses(drawFn_, renderGraph, cbs, GetDepthTextureDesc(w, h), shader_,
+	    resources_[1], cbs.objectSB_, cbs.drawArgs_, clusterScene_, depthClusters);
 	fbsDescs_.insert("RenderPassDepthPrepass", renderPassDepth.fbsDesc_);
 
 	auto lightCulling = AddLightCullingPasses(drawFn_, renderGraph, cbs, renderPassDepth.outDepth_, shader_,
@@ -820,9 +905,17 @@ void ForwardPipeline::Setup(RenderGraph& renderGraph)
 	}
 	else
 	{
+		ClusterCullingData forwardClusters;
+		if(clusterScene_)
+		{
+			clusterSettings.name_ = "Forward Cluster Culling";
+			clusterSettings.hiz_ = renderPassDepth.outHiZ_;
+			forwardClusters = AddClusterCullingPass(renderGraph, *clusterScene_, clusterShader_, clusterSettings);
+		}
+
 		auto renderPassForward = AddForwardPasses(drawFn_, renderGraph, cbs, lightCulling, GetDefaultTextureDesc(w, h),
 		    resources_[0], GetDepthTextureDesc(w, h), renderPassDepth.outDepth_, renderPassDepth.outHiZ_,
-		    renderPassDepth.outObjectSB_);
+		    renderPassDepth.outObjectSB_, renderPassDepth.outDrawArgs_, clusterScene_, forwardClusters);
 
 		SetResource("out_color", renderPassForward.outColor_);
 		SetResource("out_depth", renderPassForward.outDepth_);
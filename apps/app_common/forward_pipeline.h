@@ -2,6 +2,7 @@
 
 #include "dll.h"
 #include "core/function.h"
+#include "graphics/cluster_culling.h"
 #include "graphics/pipeline.h"
 #include "graphics/shader.h"
 #include "math/vec3.h"
@@ -36,6 +37,11 @@ public:
 	DebugMode debugMode_ = DebugMode::OFF;
 
 	Graphics::Shader* shader_ = nullptr;
+	Graphics::Shader* clusterShader_ = nullptr;
+
+	/// Optional cluster scene, culled against the frustum for the depth pass & against Hi-Z for the forward pass.
+	/// Drawn by ClusterMeshRenderPacket.
+	Graphics::ClusterScene* clusterScene_ = nullptr;
 
 	Core::Vector<Light> lights_;
 
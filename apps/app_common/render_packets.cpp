@@ -2,85 +2,208 @@
 
 #include "render_packets.h"
 
+#include "core/hash.h"
+#include "core/map.h"
+#include "core/misc.h"
 #include "gpu/command_list.h"
+#include "gpu/manager.h"
 #include "gpu/types.h"
+#include "job/radix_sort.h"
 
-#include <algorithm>
-
-bool operator<(const RenderPacketBase& inA, const RenderPacketBase& inB)
+namespace
 {
-	if(inA.type_ < inB.type_)
-		return true;
-	else if(inA.type_ > inB.type_)
-		return false;
-
-	switch(inA.type_)
-	{
-	case RenderPacketType::MESH:
-	{
-		const MeshRenderPacket& a = static_cast<const MeshRenderPacket&>(inA);
-		const MeshRenderPacket& b = static_cast<const MeshRenderPacket&>(inB);
-
-		if(a.db_ < b.db_)
-			return true;
-		else if(a.db_ > b.db_)
-			return false;
-
-		auto draw = memcmp(&a.draw_, &b.draw_, sizeof(a.draw_));
-		if(draw < 0)
-			return true;
-		else if(draw > 0)
-			return false;
-
-		auto techDesc = memcmp(&a.techDesc_, &b.techDesc_, sizeof(a.techDesc_));
-		if(techDesc < 0)
-			return true;
-		else if(techDesc > 0)
-			return false;
-
-		if(a.material_ < b.material_)
-			return true;
-		else if(a.material_ > b.material_)
-			return false;
-
-		if(a.techs_ < b.techs_)
-			return true;
-		else if(a.techs_ > b.techs_)
-			return false;
+	/**
+	 * Compact ids for sort keys, allocated from hashes of the state they represent.
+	 * Scoped to a single packet list, see SortPackets. Once a table runs out of ids, the last id is
+	 * shared by all further entries, which still sort together but are no longer told apart by key.
+	 */
+	class SortKeyIds
+	{
+	public:
+		i32 GetTechniqueId(const Graphics::ShaderTechniqueDesc& desc)
+		{
+			return GetId(techniques_, Core::HashFNV1a(0, &desc, sizeof(desc)), SortKey::TECHNIQUE_BITS);
+		}
+
+		i32 GetMaterialId(const Graphics::Material* material, const ShaderTechniques* techs)
+		{
+			u64 hash = Core::HashFNV1a(0, &material, sizeof(material));
+			hash = Core::HashFNV1a(hash, &techs, sizeof(techs));
+			return GetId(materials_, hash, SortKey::MATERIAL_BITS);
+		}
+
+		i32 GetDrawId(GPU::Handle db, const Graphics::ModelMeshDraw& draw)
+		{
+			u64 hash = Core::HashFNV1a(0, &db, sizeof(db));
+			hash = Core::HashFNV1a(hash, &draw, sizeof(draw));
+			return GetId(draws_, hash, SortKey::DRAW_BITS);
+		}
+
+		/// @return true if any table ran out of ids.
+		bool IsSaturated() const { return saturated_; }
+
+	private:
+		i32 GetId(Core::Map<u64, i32>& ids, u64 hash, i32 bits)
+		{
+			if(auto* id = ids.find(hash))
+				return *id;
+
+			const i32 maxId = (1 << bits) - 1;
+			if(ids.size() >= maxId)
+			{
+				saturated_ = true;
+				return maxId;
+			}
+
+			const i32 id = ids.size();
+			ids.insert(hash, id);
+			return id;
+		}
+
+		Core::Map<u64, i32> techniques_;
+		Core::Map<u64, i32> materials_;
+		Core::Map<u64, i32> draws_;
+		bool saturated_ = false;
+	};
+
+	/// @return @a value in its field, saturated & reported if it doesn't fit in @a bits.
+	u64 MakeField(i32 value, i32 bits, i32 shift, const char* name)
+	{
+		const i32 maxValue = (1 << bits) - 1;
+		if(value < 0 || value > maxValue)
+		{
+			Core::Log("ERROR: Sort key %s %i out of range [0, %i].\n", name, value, maxValue);
+			DBG_ASSERT(false);
+			value = Core::Clamp(value, 0, maxValue);
+		}
+		return (u64)value << shift;
+	}
+
+	/// @return @a key with technique, material & draw ids replaced. Type, pass & depth are kept.
+	u64 SetSortKeyIds(u64 key, i32 techniqueId, i32 materialId, i32 drawId)
+	{
+		const u64 idsMask = ((1ULL << (SortKey::TECHNIQUE_BITS + SortKey::MATERIAL_BITS + SortKey::DRAW_BITS)) - 1)
+		                    << SortKey::DRAW_SHIFT;
+		return (key & ~idsMask) |
+		       MakeField(techniqueId, SortKey::TECHNIQUE_BITS, SortKey::TECHNIQUE_SHIFT, "technique") |
+		       MakeField(materialId, SortKey::MATERIAL_BITS, SortKey::MATERIAL_SHIFT, "material") |
+		       MakeField(drawId, SortKey::DRAW_BITS, SortKey::DRAW_SHIFT, "draw");
+	}
+
+	void SetSortKeyIds(SortKeyIds& ids, MeshRenderPacket& packet)
+	{
+		packet.sortKey_ = SetSortKeyIds(packet.sortKey_, ids.GetTechniqueId(packet.techDesc_),
+		    ids.GetMaterialId(packet.material_, packet.techs_), ids.GetDrawId(packet.db_, packet.draw_));
 	}
-	break;
+
+	void SetSortKeyIds(SortKeyIds& ids, ClusterMeshRenderPacket& packet)
+	{
+		const auto& mesh = packet.scene_->GetMeshes()[packet.meshIdx_];
+		packet.sortKey_ = SetSortKeyIds(packet.sortKey_, ids.GetTechniqueId(packet.techDesc_),
+		    ids.GetMaterialId(packet.material_, packet.techs_), ids.GetDrawId(mesh.db_, mesh.draw_));
+	}
+}
+
+namespace SortKey
+{
+	u64 Make(RenderPacketType type, i32 pass, i32 techniqueId, i32 materialId, i32 drawId, f32 depth)
+	{
+		return MakeField((i32)type, TYPE_BITS, TYPE_SHIFT, "type") | MakeField(pass, PASS_BITS, PASS_SHIFT, "pass") |
+		       MakeField(techniqueId, TECHNIQUE_BITS, TECHNIQUE_SHIFT, "technique") |
+		       MakeField(materialId, MATERIAL_BITS, MATERIAL_SHIFT, "material") |
+		       MakeField(drawId, DRAW_BITS, DRAW_SHIFT, "draw") | Depth(depth);
 	}
 
-	return false;
+	u64 Depth(f32 depth)
+	{
+		const f32 maxDepth = (f32)((1 << DEPTH_BITS) - 1);
+		return (u64)(Core::Clamp(depth, 0.0f, 1.0f) * maxDepth) << DEPTH_SHIFT;
+	}
 }
 
 void SortPackets(Core::Vector<RenderPacketBase*>& packets)
 {
-	std::sort(packets.begin(), packets.end());
+	// Ids are allocated per packet list, so they are bounded by what is drawn rather than by every
+	// material & draw ever seen.
+	SortKeyIds ids;
+	for(auto* packet : packets)
+	{
+		if(packet->type_ == MeshRenderPacket::TYPE)
+			SetSortKeyIds(ids, *static_cast<MeshRenderPacket*>(packet));
+		else if(packet->type_ == ClusterMeshRenderPacket::TYPE)
+			SetSortKeyIds(ids, *static_cast<ClusterMeshRenderPacket*>(packet));
+	}
+	if(ids.IsSaturated())
+		Core::Log("ERROR: Out of sort key ids for %i packets, sorting & batching will be less effective.\n",
+		    packets.size());
+
+	Core::Vector<u64> keys;
+	Core::Vector<i32> indices;
+	keys.resize(packets.size());
+	indices.resize(packets.size());
+	for(i32 idx = 0; idx < packets.size(); ++idx)
+	{
+		keys[idx] = packets[idx]->sortKey_;
+		indices[idx] = idx;
+	}
+
+	Job::RadixSort(keys, indices);
+
+	Core::Vector<RenderPacketBase*> sortedPackets;
+	sortedPackets.resize(packets.size());
+	for(i32 idx = 0; idx < packets.size(); ++idx)
+		sortedPackets[idx] = packets[indices[idx]];
+	packets.swap(sortedPackets);
 }
 
-void MeshRenderPacket::DrawPackets(
-    Core::ArrayView<MeshRenderPacket*> packets, Core::ArrayView<i32> passTechIndices, const DrawContext& drawCtx)
+void MeshRenderPacket::UpdateSortKey(i32 pass, f32 depth) { sortKey_ = SortKey::Make(TYPE, pass, 0, 0, 0, depth); }
+
+void MeshRenderPacket::DrawPackets(Core::ArrayView<MeshRenderPacket*> packets, Core::ArrayView<i32> passTechIndices,
+    const DrawContext& drawCtx, DrawMode mode)
 {
 	if(packets.size() == 0)
 		return;
 
-	// Allocate command list memory.
-	auto* objects = drawCtx.cmdList_.Alloc<ObjectConstants>(packets.size());
+	// Object constants & draw arguments are written from the start of fixed size buffers, so draw in chunks
+	// that fit. Runs are not merged across chunks.
+	if(packets.size() > MAX_DRAW_OBJECTS)
+	{
+		for(i32 base = 0; base < packets.size(); base += MAX_DRAW_OBJECTS)
+		{
+			const i32 num = Core::Min(MAX_DRAW_OBJECTS, packets.size() - base);
+			DrawPackets(Core::ArrayView<MeshRenderPacket*>(packets.data() + base, num),
+			    Core::ArrayView<i32>(passTechIndices.data() + base, num), drawCtx, mode);
+		}
+		return;
+	}
+
+	// Write uniforms straight into upload memory, falling back to command list memory if it's full.
+	const i32 objectsSize = sizeof(ObjectConstants) * packets.size();
+	const auto upload = GPU::Manager::AllocUpload(objectsSize);
+	auto* objects = upload ? static_cast<ObjectConstants*>(upload.address_)
+	                       : drawCtx.cmdList_.Alloc<ObjectConstants>(packets.size());
 
 	// Update all render packet uniforms.
 	for(i32 idx = 0; idx < packets.size(); ++idx)
 		objects[idx] = packets[idx]->object_;
-	drawCtx.cmdList_.UpdateBuffer(drawCtx.objectSBHandle_, 0, sizeof(ObjectConstants) * packets.size(), objects);
-
-	i32 baseInstanceIdx = 0;
-	i32 numInstances = 0;
+	if(upload)
+		drawCtx.cmdList_.UpdateBuffer(drawCtx.objectSBHandle_, 0, upload);
+	else
+		drawCtx.cmdList_.UpdateBuffer(drawCtx.objectSBHandle_, 0, objectsSize, objects);
 
 	Graphics::ShaderBindingSet objectBindings = Graphics::Shader::CreateSharedBindingSet("ObjectBindings");
 
-	// Draw all packets, instanced where possible.
-	const MeshRenderPacket* nextMeshPacket = nullptr;
-	const i32 objectDataSize = sizeof(ObjectConstants);
+	// Gather runs of instancable packets.
+	struct InstanceRun
+	{
+		const MeshRenderPacket* packet_ = nullptr;
+		Graphics::ShaderTechnique* tech_ = nullptr;
+		i32 baseInstanceIdx_ = 0;
+		i32 numInstances_ = 0;
+	};
+
+	Core::Vector<InstanceRun> runs;
+	InstanceRun run;
 	for(i32 idx = 0; idx < packets.size(); ++idx)
 	{
 		const auto* meshPacket = packets[idx];
@@ -92,37 +215,180 @@ void MeshRenderPacket::DrawPackets(
 			doDraw = drawCtx.customBindFn_(meshPacket->material_->GetShader(), tech);
 
 		if(doDraw)
-			++numInstances;
+			++run.numInstances_;
 
-		// If not instancable with the next mesh packet, on the last one, then draw last batch and start over.
-		nextMeshPacket = ((idx + 1) < packets.size()) ? packets[idx + 1] : nullptr;
+		// If not instancable with the next mesh packet, on the last one, then end run and start over.
+		const MeshRenderPacket* nextMeshPacket = ((idx + 1) < packets.size()) ? packets[idx + 1] : nullptr;
 		if(nextMeshPacket == nullptr || !meshPacket->IsInstancableWith(*nextMeshPacket))
 		{
-			if(numInstances > 0)
+			if(run.numInstances_ > 0)
+			{
+				run.packet_ = meshPacket;
+				run.tech_ = &tech;
+				runs.push_back(run);
+			}
+
+			run.baseInstanceIdx_ = idx + 1;
+			run.numInstances_ = 0;
+		}
+	}
+
+	const i32 objectDataSize = sizeof(ObjectConstants);
+	if(mode == DrawMode::DIRECT || !drawCtx.drawArgsHandle_)
+	{
+		// Draw each run instanced, with objects bound from its first instance.
+		for(const auto& drawRun : runs)
+		{
+			const auto* meshPacket = drawRun.packet_;
+			objectBindings.Set("inObject", GPU::Binding::Buffer(drawCtx.objectSBHandle_, GPU::Format::INVALID,
+			                                   drawRun.baseInstanceIdx_, drawRun.numInstances_, objectDataSize));
+			if(auto objectBind = drawCtx.shaderCtx_.BeginBindingScope(objectBindings))
 			{
-				objectBindings.Set("inObject",
-				    GPU::Binding::Buffer(
-				        drawCtx.objectSBHandle_, GPU::Format::INVALID, baseInstanceIdx, numInstances, objectDataSize));
-				if(auto objectBind = drawCtx.shaderCtx_.BeginBindingScope(objectBindings))
+				if(auto event = drawCtx.cmdList_.Eventf(0x0, "Material: %s", meshPacket->material_->GetName()))
 				{
-					if(auto event = drawCtx.cmdList_.Eventf(0x0, "Material: %s", meshPacket->material_->GetName()))
+					auto materialBind = drawCtx.shaderCtx_.BeginBindingScope(meshPacket->material_->GetBindingSet());
+					GPU::Handle ps;
+					Core::ArrayView<GPU::PipelineBinding> pb;
+					if(drawCtx.shaderCtx_.CommitBindings(*drawRun.tech_, ps, pb))
 					{
-						auto materialBind =
-						    drawCtx.shaderCtx_.BeginBindingScope(meshPacket->material_->GetBindingSet());
-						GPU::Handle ps;
-						Core::ArrayView<GPU::PipelineBinding> pb;
-						if(drawCtx.shaderCtx_.CommitBindings(tech, ps, pb))
-						{
-							drawCtx.cmdList_.Draw(ps, pb, meshPacket->db_, drawCtx.fbs_, drawCtx.drawState_,
-							    GPU::PrimitiveTopology::TRIANGLE_LIST, meshPacket->draw_.indexOffset_,
-							    meshPacket->draw_.vertexOffset_, meshPacket->draw_.noofIndices_, 0, numInstances);
-						}
+						drawCtx.cmdList_.Draw(ps, pb, meshPacket->db_, drawCtx.fbs_, drawCtx.drawState_,
+						    GPU::PrimitiveTopology::TRIANGLE_LIST, meshPacket->draw_.indexOffset_,
+						    meshPacket->draw_.vertexOffset_, meshPacket->draw_.noofIndices_, 0, drawRun.numInstances_);
 					}
 				}
 			}
+		}
+		return;
+	}
+
+	// Runs sharing technique, material & draw binding are batched into a single indirect draw.
+	// Each batch's arguments are a draw count followed by a DrawIndexedIdArgs per run, with the draw id
+	// offsetting into objects bound in full, so bindings are only committed once per batch.
+	auto IsBatchableWith = [](const InstanceRun& a, const InstanceRun& b) {
+		return (a.packet_->sortKey_ >> SortKey::MATERIAL_SHIFT) == (b.packet_->sortKey_ >> SortKey::MATERIAL_SHIFT) &&
+		       a.packet_->db_ == b.packet_->db_ && a.packet_->material_ == b.packet_->material_ &&
+		       a.packet_->techs_ == b.packet_->techs_ && a.tech_ == b.tech_ &&
+		       memcmp(&a.packet_->techDesc_, &b.packet_->techDesc_, sizeof(a.packet_->techDesc_)) == 0;
+	};
+
+	i32 numBatches = 0;
+	for(i32 idx = 0; idx < runs.size(); ++idx)
+		if(idx == 0 || !IsBatchableWith(runs[idx - 1], runs[idx]))
+			++numBatches;
+
+	const i32 argsSize = numBatches * sizeof(u32) + runs.size() * sizeof(GPU::DrawIndexedIdArgs);
+	DBG_ASSERT(argsSize <= MAX_DRAW_ARGS_SIZE);
+	const auto argsUpload = GPU::Manager::AllocUpload(argsSize);
+	u8* args = argsUpload ? static_cast<u8*>(argsUpload.address_) : drawCtx.cmdList_.Alloc<u8>(argsSize);
+
+	struct Batch
+	{
+		i32 beginRun_ = 0;
+		i32 endRun_ = 0;
+		i32 byteOffset_ = 0;
+	};
 
-			baseInstanceIdx = idx + 1;
-			numInstances = 0;
+	Core::Vector<Batch> batches;
+	batches.reserve(numBatches);
+	i32 byteOffset = 0;
+	for(i32 idx = 0; idx < runs.size();)
+	{
+		Batch batch;
+		batch.beginRun_ = idx;
+		batch.byteOffset_ = byteOffset;
+		do
+			++idx;
+		while(idx < runs.size() && IsBatchableWith(runs[idx - 1], runs[idx]));
+		batch.endRun_ = idx;
+
+		const u32 numDraws = batch.endRun_ - batch.beginRun_;
+		memcpy(args + byteOffset, &numDraws, sizeof(u32));
+		byteOffset += sizeof(u32);
+		for(i32 runIdx = batch.beginRun_; runIdx < batch.endRun_; ++runIdx)
+		{
+			const auto& drawRun = runs[runIdx];
+			GPU::DrawIndexedIdArgs drawArgs;
+			drawArgs.drawId_ = drawRun.baseInstanceIdx_;
+			drawArgs.args_.indexCountPerInstance_ = drawRun.packet_->draw_.noofIndices_;
+			drawArgs.args_.instanceCount_ = drawRun.numInstances_;
+			drawArgs.args_.startVertexLocation_ = drawRun.packet_->draw_.indexOffset_;
+			drawArgs.args_.baseVertexLocation_ = drawRun.packet_->draw_.vertexOffset_;
+			memcpy(args + byteOffset, &drawArgs, sizeof(drawArgs));
+			byteOffset += sizeof(drawArgs);
 		}
+		batches.push_back(batch);
 	}
+
+	if(argsUpload)
+		drawCtx.cmdList_.UpdateBuffer(drawCtx.drawArgsHandle_, 0, argsUpload);
+	else
+		drawCtx.cmdList_.UpdateBuffer(drawCtx.drawArgsHandle_, 0, argsSize, args);
+
+	objectBindings.Set("inObject", GPU::Binding::Buffer(drawCtx.objectSBHandle_, GPU::Format::INVALID, 0,
+	                                   packets.size(), objectDataSize));
+	if(auto objectBind = drawCtx.shaderCtx_.BeginBindingScope(objectBindings))
+	{
+		for(const auto& batch : batches)
+		{
+			const auto& drawRun = runs[batch.beginRun_];
+			const auto* meshPacket = drawRun.packet_;
+			if(auto event = drawCtx.cmdList_.Eventf(0x0, "Material: %s", meshPacket->material_->GetName()))
+			{
+				auto materialBind = drawCtx.shaderCtx_.BeginBindingScope(meshPacket->material_->GetBindingSet());
+				GPU::Handle ps;
+				Core::ArrayView<GPU::PipelineBinding> pb;
+				if(drawCtx.shaderCtx_.CommitBindings(*drawRun.tech_, ps, pb))
+				{
+					const i32 numDraws = batch.endRun_ - batch.beginRun_;
+					drawCtx.cmdList_.DrawIndirect(ps, pb, meshPacket->db_, drawCtx.fbs_, drawCtx.drawState_,
+					    GPU::PrimitiveTopology::TRIANGLE_LIST, drawCtx.drawArgsHandle_,
+					    batch.byteOffset_ + sizeof(u32), drawCtx.drawArgsHandle_, batch.byteOffset_, numDraws, true);
+				}
+			}
+		}
+	}
+}
+
+void ClusterMeshRenderPacket::DrawPackets(Core::ArrayView<ClusterMeshRenderPacket*> packets,
+    Core::ArrayView<i32> passTechIndices, const DrawContext& drawCtx)
+{
+	const auto* scene = drawCtx.clusterScene_;
+	if(packets.size() == 0 || scene == nullptr || scene->GetInstances().size() == 0)
+		return;
+
+	// Draw ids index instances, so transforms for all of them are bound once.
+	Graphics::ShaderBindingSet objectBindings = Graphics::Shader::CreateSharedBindingSet("ObjectBindings");
+	objectBindings.Set("inObject", GPU::Binding::Buffer(drawCtx.clusterTransformsHandle_, GPU::Format::INVALID, 0,
+	                                   scene->GetInstances().size(), sizeof(ObjectConstants)));
+	if(auto objectBind = drawCtx.shaderCtx_.BeginBindingScope(objectBindings))
+	{
+		for(i32 idx = 0; idx < packets.size(); ++idx)
+		{
+			const auto* clusterPacket = packets[idx];
+			if(clusterPacket->scene_ != scene)
+				continue;
+
+			auto& tech = clusterPacket->techs_->passTechniques_[passTechIndices[idx]];
+			if(drawCtx.customBindFn_ && !drawCtx.customBindFn_(clusterPacket->material_->GetShader(), tech))
+				continue;
+
+			if(auto event = drawCtx.cmdList_.Eventf(0x0, "Material: %s", clusterPacket->material_->GetName()))
+			{
+				auto materialBind = drawCtx.shaderCtx_.BeginBindingScope(clusterPacket->material_->GetBindingSet());
+				GPU::Handle ps;
+				Core::ArrayView<GPU::PipelineBinding> pb;
+				if(drawCtx.shaderCtx_.CommitBindings(tech, ps, pb))
+				{
+					scene->DrawMesh(drawCtx.cmdList_, clusterPacket->meshIdx_, ps, pb, drawCtx.fbs_,
+					    drawCtx.drawState_, drawCtx.clusterDrawArgsHandle_, drawCtx.clusterDrawCountsHandle_);
+				}
+			}
+		}
+	}
+}
+
+void ClusterMeshRenderPacket::UpdateSortKey(i32 pass)
+{
+	DBG_ASSERT(scene_ && meshIdx_ >= 0);
+	sortKey_ = SortKey::Make(TYPE, pass, 0, 0, 0, 0.0f);
 }
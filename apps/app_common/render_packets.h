@@ -2,6 +2,7 @@
 
 #include "core/function.h"
 #include "core/debug.h"
+#include "graphics/cluster_culling.h"
 #include "graphics/material.h"
 #include "graphics/model.h"
 #include "graphics/shader.h"
@@ -16,7 +17,7 @@ struct DrawContext
 {
 	DrawContext(GPU::CommandList& cmdList, Graphics::ShaderContext& shaderCtx, const char* passName,
 	    const GPU::DrawState& drawState, GPU::Handle fbs, GPU::Handle viewCBHandle, GPU::Handle objectSBHandle,
-	    CustomBindFn customBindFn)
+	    CustomBindFn customBindFn, GPU::Handle drawArgsHandle = GPU::Handle())
 	    : cmdList_(cmdList)
 	    , shaderCtx_(shaderCtx)
 	    , passName_(passName)
@@ -25,6 +26,7 @@ struct DrawContext
 	    , viewCBHandle_(viewCBHandle)
 	    , objectSBHandle_(objectSBHandle)
 	    , customBindFn_(customBindFn)
+	    , drawArgsHandle_(drawArgsHandle)
 	{
 	}
 
@@ -36,6 +38,15 @@ struct DrawContext
 	GPU::Handle viewCBHandle_;
 	GPU::Handle objectSBHandle_;
 	CustomBindFn customBindFn_;
+	/// Indirect argument buffer for batched draws. Invalid if unsupported by the pass.
+	GPU::Handle drawArgsHandle_;
+
+	/// Cluster scene culled for this pass, with its outputs. See Graphics::AddClusterCullingPass.
+	/// Null if the pass has no cluster culling.
+	const Graphics::ClusterScene* clusterScene_ = nullptr;
+	GPU::Handle clusterTransformsHandle_;
+	GPU::Handle clusterDrawArgsHandle_;
+	GPU::Handle clusterDrawCountsHandle_;
 };
 
 using DrawFn = Core::Function<void(DrawContext& drawCtx), 64>;
@@ -44,14 +55,61 @@ enum class RenderPacketType : i16
 {
 	UNKNOWN = 0,
 	MESH,
+	CLUSTER_MESH,
 
 	MAX,
 };
 
+/**
+ * Packed 64 bit render packet sort key.
+ * From most to least significant:
+ * - 4 bits: Packet type.
+ * - 4 bits: Pass bucket, lowest drawn first (e.g. opaque before translucent).
+ * - 10 bits: Technique id.
+ * - 14 bits: Material id.
+ * - 16 bits: Draw id.
+ * - 16 bits: Depth.
+ * Ids are allocated by SortPackets from the unique technique descs, materials & draws in the packet list,
+ * so packets sharing them sort together. Keys may alias once ids run out, so they only group packets;
+ * state is still compared exactly before instancing or batching.
+ */
+namespace SortKey
+{
+	static const i32 DEPTH_BITS = 16;
+	static const i32 DRAW_BITS = 16;
+	static const i32 MATERIAL_BITS = 14;
+	static const i32 TECHNIQUE_BITS = 10;
+	static const i32 PASS_BITS = 4;
+	static const i32 TYPE_BITS = 4;
+
+	static const i32 DEPTH_SHIFT = 0;
+	static const i32 DRAW_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+	static const i32 MATERIAL_SHIFT = DRAW_SHIFT + DRAW_BITS;
+	static const i32 TECHNIQUE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+	static const i32 PASS_SHIFT = TECHNIQUE_SHIFT + TECHNIQUE_BITS;
+	static const i32 TYPE_SHIFT = PASS_SHIFT + PASS_BITS;
+	static_assert((TYPE_SHIFT + TYPE_BITS) == 64, "Sort key must be 64 bits.");
+
+	/// Build key from its fields. Fields that don't fit in their bits are saturated & reported.
+	u64 Make(RenderPacketType type, i32 pass, i32 techniqueId, i32 materialId, i32 drawId, f32 depth);
+
+	/// @return Quantized depth, @a depth clamped to [0, 1].
+	u64 Depth(f32 depth);
+}
+
 struct RenderPacketBase
 {
 	RenderPacketType type_ = RenderPacketType::UNKNOWN;
 	i16 size_ = 0;
+	/// Sort key, see SortKey.
+	u64 sortKey_ = 0;
+
+	/// Replace depth in sort key, @a depth is clamped to [0, 1].
+	void SetSortDepth(f32 depth)
+	{
+		const u64 depthMask = ((1ULL << SortKey::DEPTH_BITS) - 1) << SortKey::DEPTH_SHIFT;
+		sortKey_ = (sortKey_ & ~depthMask) | SortKey::Depth(depth);
+	}
 };
 
 template<typename TYPE>
@@ -66,12 +124,23 @@ struct RenderPacket : RenderPacketBase
 	}
 };
 
+/**
+ * Sort packets by RenderPacketBase::sortKey_.
+ * Technique, material & draw ids in each key are first reassigned from this packet list.
+ * Uses a radix sort over keys & indices, split across job workers.
+ */
 void SortPackets(Core::Vector<RenderPacketBase*>& packets);
 
 struct MeshRenderPacket : RenderPacket<MeshRenderPacket>
 {
 	static const RenderPacketType TYPE = RenderPacketType::MESH;
 
+	/// Object constants drawn per chunk. DrawContext::objectSBHandle_ must hold this many ObjectConstants.
+	static const i32 MAX_DRAW_OBJECTS = 100000;
+	/// Worst case draw arguments per chunk, a draw count & draw per object.
+	/// DrawContext::drawArgsHandle_ must be at least this large.
+	static const i32 MAX_DRAW_ARGS_SIZE = (sizeof(u32) + sizeof(GPU::DrawIndexedIdArgs)) * MAX_DRAW_OBJECTS;
+
 	GPU::Handle db_;
 	Graphics::ModelMeshDraw draw_;
 	ObjectConstants object_;
@@ -79,13 +148,64 @@ struct MeshRenderPacket : RenderPacket<MeshRenderPacket>
 	Graphics::Material* material_ = nullptr;
 	ShaderTechniques* techs_ = nullptr;
 
-	static void DrawPackets(
-	    Core::ArrayView<MeshRenderPacket*> packets, Core::ArrayView<i32> passTechIndices, const DrawContext& drawCtx);
+	enum class DrawMode
+	{
+		/// Draw call per run of instancable packets.
+		DIRECT,
+		/// Indirect draw per run of packets sharing technique, material & draw binding.
+		/// Falls back to DIRECT if DrawContext::drawArgsHandle_ is invalid.
+		INDIRECT,
+	};
+
+	/**
+	 * Draw packets, in chunks of at most MAX_DRAW_OBJECTS.
+	 */
+	static void DrawPackets(Core::ArrayView<MeshRenderPacket*> packets, Core::ArrayView<i32> passTechIndices,
+	    const DrawContext& drawCtx, DrawMode mode = DrawMode::DIRECT);
+
+	/**
+	 * Build sort key from pass & depth. Ids for draw binding, draw, technique desc & material
+	 * are filled in by SortPackets.
+	 * @param pass Pass bucket, see SortKey.
+	 * @param depth Depth from camera, in [0, 1].
+	 */
+	void UpdateSortKey(i32 pass = 0, f32 depth = 0.0f);
 
 	bool IsInstancableWith(const MeshRenderPacket& other) const
 	{
+		DBG_ASSERT(sortKey_ != 0 && other.sortKey_ != 0);
+		if((sortKey_ >> SortKey::DRAW_SHIFT) != (other.sortKey_ >> SortKey::DRAW_SHIFT))
+			return false;
 		return db_ == other.db_ && memcmp(&draw_, &other.draw_, sizeof(draw_)) == 0 &&
 		       memcmp(&techDesc_, &other.techDesc_, sizeof(techDesc_)) == 0 && material_ == other.material_ &&
 		       techs_ == other.techs_;
 	}
 };
+
+/**
+ * Mesh in a Graphics::ClusterScene, drawn from the culled draw arguments of a pass's cluster scene.
+ * Not drawn in passes without cluster culling.
+ */
+struct ClusterMeshRenderPacket : RenderPacket<ClusterMeshRenderPacket>
+{
+	static const RenderPacketType TYPE = RenderPacketType::CLUSTER_MESH;
+
+	const Graphics::ClusterScene* scene_ = nullptr;
+	i32 meshIdx_ = -1;
+	Graphics::ShaderTechniqueDesc techDesc_;
+	Graphics::Material* material_ = nullptr;
+	ShaderTechniques* techs_ = nullptr;
+
+	/**
+	 * Draw all visible clusters of each packet's mesh with a single indirect draw.
+	 * Packets not from DrawContext::clusterScene_ are skipped.
+	 */
+	static void DrawPackets(Core::ArrayView<ClusterMeshRenderPacket*> packets, Core::ArrayView<i32> passTechIndices,
+	    const DrawContext& drawCtx);
+
+	/**
+	 * Build sort key from pass. Ids for scene mesh, technique desc & material are filled in by SortPackets.
+	 * @param pass Pass bucket, see SortKey.
+	 */
+	void UpdateSortKey(i32 pass = 0);
+};
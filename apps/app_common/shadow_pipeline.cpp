@@ -4,6 +4,7 @@
 #include "gpu/command_list.h"
 #include "gpu/resources.h"
 #include "gpu/utils.h"
+#include "graphics/cluster_culling.h"
 #include "graphics/render_graph.h"
 #include "graphics/render_pass.h"
 #include "resource/manager.h"
@@ -11,7 +12,8 @@
 using namespace Graphics;
 
 const RenderGraphBufferDesc viewCBDesc = RenderGraphBufferDesc(sizeof(ViewConstants));
-const RenderGraphBufferDesc objectSBDesc = RenderGraphBufferDesc(sizeof(ObjectConstants) * 100000);
+const RenderGraphBufferDesc objectSBDesc =
+    RenderGraphBufferDesc(sizeof(ObjectConstants) * MeshRenderPacket::MAX_DRAW_OBJECTS);
 
 struct BaseDrawFnData
 {
@@ -41,6 +43,10 @@ struct ShadowSettings
 	/// Common buffers.
 	CommonBuffers cbs_;
 
+	/// Optional cluster scene & its culling outputs to draw.
+	const ClusterScene* clusterScene_ = nullptr;
+	ClusterCullingData clusters_;
+
 	/// Output shadow map to render to.
 	RenderGraphResource outShadowMap_;
 	/// Index of element to render into.
@@ -64,8 +70,15 @@ static ShadowData AddShadowPass(DrawFn drawFn, RenderGraph& renderGraph, ShadowS
 		ViewConstants view_;
 		RenderGraphResource viewCB_;
 
+		const ClusterScene* clusterScene_ = nullptr;
+		RenderGraphResource inClusterTransforms_;
+		RenderGraphResource inClusterDrawArgs_;
+		RenderGraphResource inClusterDrawCounts_;
+
 		RenderGraphResource outShadowMap_;
 		RenderGraphResource outObjectSB_;
+
+		mutable ShaderBindingSet viewBindings_;
 	};
 
 	auto& renderPassShadowMap = renderGraph.AddCallbackRenderPass<ShadowPassData>("Shadow Map Pass",
@@ -88,6 +101,18 @@ static ShadowData AddShadowPass(DrawFn drawFn, RenderGraph& renderGraph, ShadowS
 			    settings.outShadowMap_ = builder.Create("Shadow Map", desc);
 		    }
 
+		    if(settings.clusterScene_ && settings.clusters_.outDrawArgs_)
+		    {
+			    data.clusterScene_ = settings.clusterScene_;
+			    data.viewCB_ = builder.Read(settings.cbs_.viewCB_, GPU::BindFlags::CONSTANT_BUFFER);
+			    data.inClusterTransforms_ =
+			        builder.Read(settings.clusters_.outTransforms_, GPU::BindFlags::SHADER_RESOURCE);
+			    data.inClusterDrawArgs_ =
+			        builder.Read(settings.clusters_.outDrawArgs_, GPU::BindFlags::INDIRECT_BUFFER);
+			    data.inClusterDrawCounts_ =
+			        builder.Read(settings.clusters_.outDrawCounts_, GPU::BindFlags::INDIRECT_BUFFER);
+			    data.viewBindings_ = Shader::CreateSharedBindingSet("ViewBindings");
+		    }
 
 		    // Setup frame buffer.
 		    data.outShadowMap_ = builder.SetDSV(settings.outShadowMap_);
@@ -101,6 +126,27 @@ static ShadowData AddShadowPass(DrawFn drawFn, RenderGraph& renderGraph, ShadowS
 		    // Clear depth buffer.
 		    cmdList.ClearDSV(fbs, 1.0f, 0);
 
+		    // Draw culled clusters.
+		    if(data.clusterScene_)
+		    {
+			    if(!data.drawFn_)
+				    return;
+
+			    data.viewBindings_.Set("viewParams", res.CBuffer(data.viewCB_, 0, sizeof(ViewConstants)));
+			    if(auto viewBind = shaderCtx.BeginBindingScope(data.viewBindings_))
+			    {
+				    DrawContext drawCtx(cmdList, shaderCtx, "RenderPassShadow", data.drawState_, fbs,
+				        res.GetBuffer(data.viewCB_), GPU::Handle(), nullptr);
+				    drawCtx.clusterScene_ = data.clusterScene_;
+				    drawCtx.clusterTransformsHandle_ = res.GetBuffer(data.inClusterTransforms_);
+				    drawCtx.clusterDrawArgsHandle_ = res.GetBuffer(data.inClusterDrawArgs_);
+				    drawCtx.clusterDrawCountsHandle_ = res.GetBuffer(data.inClusterDrawCounts_);
+
+				    data.drawFn_(drawCtx);
+			    }
+			    return;
+		    }
+
 		    DBG_ASSERT(false);
 #if 0
 			// Draw all render packets that are valid for this pass.
@@ -195,13 +241,16 @@ ShadowPipeline::ShadowPipeline()
     : Pipeline(SHADOW_RESOURCE_NAMES)
 {
 	Resource::Manager::RequestResource(shader_, "shaders/shadow_pipeline.esf");
+	Resource::Manager::RequestResource(clusterShader_, "shaders/cluster_culling.esf");
 	Resource::Manager::WaitForResource(shader_);
+	Resource::Manager::WaitForResource(clusterShader_);
 
 	ShaderTechniqueDesc desc;
 }
 
 ShadowPipeline::~ShadowPipeline()
 {
+	Resource::Manager::ReleaseResource(clusterShader_);
 	Resource::Manager::ReleaseResource(shader_);
 }
 
@@ -286,6 +335,19 @@ void ShadowPipeline::Setup(RenderGraph& renderGraph)
 		});
 
 	auto cbs = renderPassCommonBuffers.GetData().cbs_;
+	settings.cbs_ = cbs;
+
+	// Shadow casters facing away from the light still cast shadows, so only frustum cull.
+	if(clusterScene_)
+	{
+		ClusterCullingSettings clusterSettings;
+		clusterSettings.name_ = "Shadow Cluster Culling";
+		clusterSettings.viewProj_ = view_.viewProj_;
+		clusterSettings.eye_ = view_.invView_.Translation();
+		clusterSettings.backfaceCull_ = false;
+		settings.clusterScene_ = clusterScene_;
+		settings.clusters_ = AddClusterCullingPass(renderGraph, *clusterScene_, clusterShader_, clusterSettings);
+	}
 
 	auto renderPassShadow = AddShadowPass(drawFn_, renderGraph, settings);
 	fbsDescs_.insert("RenderPassShadow", renderPassShadow.fbsDesc_);
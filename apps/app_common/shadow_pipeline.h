@@ -2,6 +2,7 @@
 
 #include "dll.h"
 #include "core/function.h"
+#include "graphics/cluster_culling.h"
 #include "graphics/pipeline.h"
 #include "graphics/shader.h"
 #include "math/vec3.h"
@@ -27,6 +28,11 @@ public:
 	DrawFn drawFn_;
 
 	Graphics::Shader* shader_ = nullptr;
+	Graphics::Shader* clusterShader_ = nullptr;
+
+	/// Optional cluster scene, culled against the light's frustum for the shadow pass.
+	/// Drawn by ClusterMeshRenderPacket.
+	Graphics::ClusterScene* clusterScene_ = nullptr;
 
 	Math::Vec3 eyePos_;
 	Light directionalLight_;
@@ -16,6 +16,7 @@
 
 #include "graphics/material.h"
 #include "graphics/model.h"
+#include "graphics/pipeline_state_cache.h"
 #include "graphics/shader.h"
 #include "graphics/texture.h"
 
@@ -23,6 +24,9 @@
 
 namespace
 {
+	/// Technique records used to prewarm pipeline states, relative to executable path.
+	static const char* PIPELINE_STATE_CACHE_PATH = "pipeline_state_cache.dat";
+
 	GPU::SetupParams GetDefaultSetupParams(const Core::CommandLine& cmdLine)
 	{
 		GPU::SetupParams setupParams;
@@ -34,6 +38,14 @@ namespace
 			setupParams.debugFlags_ |= GPU::DebugFlags::GPU_BASED_VALIDATION;
 		if(cmdLine.HasArg(0, "disableassertions"))
 			Core::SetBreakOnAssertion(false);
+
+		// Setup params only hold pointers, so keep arguments alive.
+		static Core::String api;
+		static Core::String capturePath;
+		if(cmdLine.GetArg(0, "gpuapi", api))
+			setupParams.api_ = api.c_str();
+		if(cmdLine.GetArg(0, "gpucapture", capturePath))
+			setupParams.capturePath_ = capturePath.c_str();
 		return setupParams;
 	}
 
@@ -88,6 +100,9 @@ namespace
 			Graphics::Shader::RegisterFactory();
 			Graphics::Texture::RegisterFactory();
 
+			// Techniques used in previous runs are prewarmed as shaders load.
+			Graphics::PipelineStateCache::Load(PIPELINE_STATE_CACHE_PATH);
+
 			// Init device.
 			i32 numAdapters = GPU::Manager::EnumerateAdapters(nullptr, 0);
 			DBG_ASSERT(numAdapters > 0);
@@ -120,6 +135,7 @@ namespace
 		{
 			GPU::Manager::DestroyResource(fbsHandle);
 			GPU::Manager::DestroyResource(scHandle);
+			Graphics::PipelineStateCache::Save(PIPELINE_STATE_CACHE_PATH);
 			Graphics::Material::UnregisterFactory();
 			Graphics::Model::UnregisterFactory();
 			Graphics::Shader::UnregisterFactory();
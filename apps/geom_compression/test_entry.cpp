@@ -244,6 +244,7 @@ public:
 			packet.techs_ = techniques;
 			packet.object_.world_ = model->GetMeshWorldTransform(idx);
 
+			packet.UpdateSortKey();
 			packets_.emplace_back(new MeshRenderPacket(packet));
 		}
 	}
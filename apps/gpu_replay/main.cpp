@@ -0,0 +1,103 @@
+#include "client/manager.h"
+#include "client/window.h"
+#include "core/command_line.h"
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/misc.h"
+#include "core/string.h"
+#include "core/vector.h"
+#include "gpu/backend.h"
+#include "gpu/capture.h"
+#include "plugin/manager.h"
+
+#include "core/allocator_overrides.h"
+
+DECLARE_MODULE_ALLOCATOR("General/" MODULE_NAME);
+
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Replays a GPU capture (see GPU::SetupParams::capturePath_) and reports backend CPU cost.
+ *
+ * Usage: gpu_replay -capture=<path> [-api=<api>] [-iterations=<n>]
+ */
+int main(int argc, char* const argv[])
+{
+	Client::Manager::Scoped clientManager;
+
+	// Change to executable path.
+	char path[Core::MAX_PATH_LENGTH];
+	if(Core::FileSplitPath(argv[0], path, Core::MAX_PATH_LENGTH, nullptr, 0, nullptr, 0))
+	{
+		Core::FileChangeDir(path);
+	}
+
+	Core::CommandLine cmdLine(argc, argv);
+
+	Core::String capturePath;
+	if(!cmdLine.GetArg(0, "capture", capturePath))
+	{
+		Core::Log("Usage: gpu_replay -capture=<path> [-api=<api>] [-iterations=<n>]\n");
+		return 1;
+	}
+
+	Core::String api;
+	cmdLine.GetArg(0, "api", api);
+
+	GPU::ReplayParams params;
+	Core::String iterations;
+	if(cmdLine.GetArg(0, "iterations", iterations))
+		params.numIterations_ = Core::Max(1, atoi(iterations.c_str()));
+
+	Plugin::Manager::Scoped pluginManager;
+
+	// Find backend.
+	Core::Vector<GPU::BackendPlugin> plugins;
+	plugins.resize(Plugin::Manager::GetPlugins<GPU::BackendPlugin>(nullptr, 0));
+	Plugin::Manager::GetPlugins(plugins.data(), plugins.size());
+
+	const GPU::BackendPlugin* plugin = nullptr;
+	for(const auto& it : plugins)
+	{
+		if(api.size() > 0 ? strcmp(api.c_str(), it.api_) == 0 : strcmp(it.api_, "NULL") != 0)
+		{
+			plugin = &it;
+			break;
+		}
+	}
+
+	if(plugin == nullptr)
+	{
+		Core::Log("No backend found. Valid APIs:\n");
+		for(const auto& it : plugins)
+			Core::Log(" - %s (%s)\n", it.api_, it.name_);
+		return 1;
+	}
+
+	// Swap chains in the capture are created on this window.
+	Client::Window window("gpu_replay", 100, 100, 1280, 720, true);
+	params.outputWindow_ = window.GetPlatformData().handle_;
+
+	GPU::SetupParams setupParams;
+	setupParams.api_ = plugin->api_;
+	setupParams.deviceWindow_ = params.outputWindow_;
+	GPU::IBackend* backend = plugin->CreateBackend(setupParams);
+	if(backend == nullptr || backend->Initialize(0) != GPU::ErrorCode::OK)
+	{
+		Core::Log("Failed to initialize \"%s\" backend.\n", plugin->api_);
+		plugin->DestroyBackend(backend);
+		return 1;
+	}
+
+	Core::Log("Replaying \"%s\" on %s, %i iteration(s).\n", capturePath.c_str(), plugin->name_,
+	    params.numIterations_);
+
+	GPU::ReplayStats stats;
+	const bool success = GPU::ReplayCapture(*backend, capturePath.c_str(), params, stats);
+	if(success)
+		GPU::LogReplayStats(stats);
+
+	plugin->DestroyBackend(backend);
+	return success ? 0 : 1;
+}
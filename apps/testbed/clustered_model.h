@@ -18,6 +18,10 @@
  * finely than would be efficient to do on CPU.
  *
  * This will load directly from a model file, and flatten the entire hierarchy.
+ *
+ * Superseded by Graphics::ClusterScene & Graphics::AddClusterCullingPass, which cull the meshlets
+ * built by the model converter. Still compiled with the testbed, but only used by the testbed loop
+ * in test_entry.cpp, which is disabled.
  */
 class ClusteredModel
 {
@@ -28,6 +28,8 @@
 
 #include <cmath>
 
+// Testbed loop is disabled, main below just returns. Scene clusters are culled by
+// Graphics::AddClusterCullingPass in the app pipelines, ClusteredModel remains as a prototype.
 #if 0
 
 namespace
@@ -448,6 +450,7 @@ namespace
 	bool updateFrustum_ = true;
 	bool clusterCulling_ = false;
 	bool compressedModel_ = false;
+	bool indirectBatching_ = true;
 
 	void DrawRenderPackets(const DrawContext& drawCtx)
 	{
@@ -481,7 +484,8 @@ namespace
 				}
 			}
 
-			MeshRenderPacket::DrawPackets(meshPackets, meshPassTechIndices, drawCtx);
+			MeshRenderPacket::DrawPackets(meshPackets, meshPassTechIndices, drawCtx,
+			    indirectBatching_ ? MeshRenderPacket::DrawMode::INDIRECT : MeshRenderPacket::DrawMode::DIRECT);
 		}
 	}
 
@@ -500,6 +504,7 @@ namespace
 			ImGui::Checkbox("Update Frustum", &updateFrustum_);
 			ImGui::Checkbox("Cluster Culling", &clusterCulling_);
 			ImGui::Checkbox("Compressed Model", &compressedModel_);
+			ImGui::Checkbox("Indirect Batching", &indirectBatching_);
 
 			static int debugMode = 0;
 			ImGui::Text("Debug Modes:");
@@ -560,6 +565,7 @@ void Loop(const Core::CommandLine& cmdLine)
 
 			packet.object_.world_ = sponzaModel->GetMeshWorldTransform(idx);
 
+			packet.UpdateSortKey();
 			packets_.emplace_back(new MeshRenderPacket(packet));
 		}
 	}
@@ -683,6 +689,7 @@ void Loop(const Core::CommandLine& cmdLine)
 				ImGui::Text("Process deletions: %f ms", times_.processDeletions_ * 1000.0);
 				ImGui::Text("Frame Time: %f ms", times_.frame_ * 1000.0, 1.0f / times_.frame_);
 				ImGui::Text("Tick Time: %f ms (%.2f FPS)", times_.tick_ * 1000.0, 1.0f / times_.tick_);
+				ImGui::Text("Commands: %i", GPU::Manager::GetNumFrameCommands());
 			}
 			ImGui::End();
 
@@ -77,7 +77,8 @@ namespace Core
 	 * Handle allocator.
 	 * Provides a mechanism for allocating and validating handles for use in
 	 * various scenarios.
-	 * This is not thread safe, so this needs to be managed at the higher level.
+	 * Alloc and Free are lock-free and thread safe. A handle must only be freed once, by
+	 * one thread. GetTotalHandles and friends are only a snapshot while other threads allocate.
 	 */
 	class CORE_DLL HandleAllocator
 	{
@@ -157,7 +158,7 @@ namespace Core
 
 	private:
 		/// Magic IDs array used to validate handles for types.
-		u16* magicIDs_ = nullptr;
+		volatile u16* magicIDs_ = nullptr;
 		struct HandleAllocatorImpl* impl_ = nullptr;
 	};
 
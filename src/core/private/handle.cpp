@@ -1,7 +1,7 @@
 #include "core/handle.h"
 #include "core/array.h"
+#include "core/concurrency.h"
 #include "core/debug.h"
-#include "core/vector.h"
 
 #include <utility>
 
@@ -9,74 +9,109 @@ namespace Core
 {
 	struct HandleAllocatorImpl
 	{
+		/// Stored in next_ while an index is allocated.
+		static const i32 ALLOCATED = -1;
+
 		struct TypeData
 		{
-			Core::Vector<u32> freeList_;
-			Core::Vector<u8> allocated_;
+			/// Free list head. Low 32 bits are index + 1 (0 when empty), high 32 bits are a tag
+			/// incremented on every change so a stale head can't be swapped back in (ABA).
+			volatile i64 freeHead_ = 0;
+			/// Number of indices handed out from the never used range.
+			volatile i32 numIndices_ = 0;
+			/// Per index, next free index + 1 while free, or ALLOCATED.
+			volatile i32* next_ = nullptr;
 		};
 
 		Core::Array<TypeData, Handle::MAX_TYPE> types_;
+		i32 numTypes_ = 0;
 	};
 
 	namespace
 	{
-		inline u16& GetMagicID(u16* magicIds, u32 index, u32 type)
+		inline volatile u16& GetMagicID(volatile u16* magicIds, u32 index, u32 type)
 		{
 			return magicIds[index + (type * Handle::MAX_INDEX)];
 		}
+
+		inline i64 MakeFreeHead(i64 oldHead, i32 index)
+		{
+			const u64 tag = ((u64)oldHead & 0xffffffff00000000ULL) + 0x100000000ULL;
+			return (i64)(tag | (u32)(index + 1));
+		}
 	}
 
 	HandleAllocator::HandleAllocator(i32 numTypes)
 	{
+		DBG_ASSERT(numTypes > 0 && numTypes <= Handle::MAX_TYPE);
 		const i32 magicSize = Handle::MAX_TYPE * Handle::MAX_INDEX;
 		magicIDs_ = new u16[magicSize];
 		for(i32 i = 0; i < magicSize; ++i)
 			magicIDs_[i] = 1;
 		impl_ = new HandleAllocatorImpl();
+		impl_->numTypes_ = numTypes;
+		for(i32 type = 0; type < numTypes; ++type)
+		{
+			auto* next = new i32[Handle::MAX_INDEX];
+			memset(next, 0, sizeof(i32) * Handle::MAX_INDEX);
+			impl_->types_[type].next_ = next;
+		}
 	}
 
 	HandleAllocator::~HandleAllocator()
 	{
+		for(auto& typeData : impl_->types_)
+			delete[] typeData.next_;
 		delete impl_;
 		delete[] magicIDs_;
 	}
 
 	Handle HandleAllocator::Alloc(i32 type)
 	{
-		DBG_ASSERT(type >= 0 && type < impl_->types_.size());
+		DBG_ASSERT(type >= 0 && type < impl_->numTypes_);
 		HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
 
 		Handle handle;
 
 		// Reuse index from freelist if we can.
-		bool validHandle = false;
-		if(typeData.freeList_.size() > 0)
+		i32 index = -1;
+		i64 head = typeData.freeHead_;
+		while((head & 0xffffffff) != 0)
 		{
-			handle.index_ = typeData.freeList_.back();
-			typeData.freeList_.pop_back();
-			handle.type_ = type;
-			validHandle = true;
-		}
-		else
-		{
-			// Nothing in the free list, push new one into allocated.
-			if(typeData.allocated_.size() < Handle::MAX_INDEX)
+			// next_ may be stale if another thread pops this index first, but then the tag will have changed.
+			const i32 headIndex = (i32)(head & 0xffffffff) - 1;
+			const i64 newHead = MakeFreeHead(head, typeData.next_[headIndex] - 1);
+			const i64 oldHead = Core::AtomicCmpExchg(&typeData.freeHead_, newHead, head);
+			if(oldHead == head)
 			{
-				typeData.allocated_.push_back(0);
-				handle.index_ = typeData.allocated_.size() - 1;
-				handle.type_ = type;
-				validHandle = true;
+				index = headIndex;
+				break;
 			}
+			head = oldHead;
 		}
 
-		if(validHandle)
+		// Nothing in the free list, take a new index.
+		if(index < 0)
 		{
-			if((i32)handle.index_ >= typeData.allocated_.size())
+			i32 numIndices = typeData.numIndices_;
+			while(numIndices < Handle::MAX_INDEX)
 			{
-				typeData.allocated_.resize((i32)handle.index_ + 1, 0);
+				const i32 oldNumIndices = Core::AtomicCmpExchg(&typeData.numIndices_, numIndices + 1, numIndices);
+				if(oldNumIndices == numIndices)
+				{
+					index = numIndices;
+					break;
+				}
+				numIndices = oldNumIndices;
 			}
-			DBG_ASSERT(typeData.allocated_[handle.index_] == 0);
-			typeData.allocated_[handle.index_] = 1;
+		}
+
+		if(index >= 0)
+		{
+			DBG_ASSERT(typeData.next_[index] != HandleAllocatorImpl::ALLOCATED);
+			typeData.next_[index] = HandleAllocatorImpl::ALLOCATED;
+			handle.index_ = index;
+			handle.type_ = type;
 			handle.magic_ = GetMagicID(magicIDs_, handle.index_, handle.type_);
 			DBG_ASSERT(handle.magic_ != 0);
 		}
@@ -86,32 +121,37 @@ namespace Core
 	void HandleAllocator::Free(Handle handle)
 	{
 		DBG_ASSERT_MSG(IsValid(handle), "Attempting to free invalid handle.");
-		DBG_ASSERT((i32)handle.type_ < impl_->types_.size());
+		DBG_ASSERT((i32)handle.type_ < impl_->numTypes_);
 		HandleAllocatorImpl::TypeData& typeData = impl_->types_[handle.type_];
+		const i32 index = handle.index_;
 
-		// Increment magic, wrap if hit zero.
-		u16& magic = GetMagicID(magicIDs_, handle.index_, handle.type_);
-		if((++magic) >= Handle::MAX_MAGIC)
+		// Increment magic, wrap if hit zero. Only the owner of a handle frees it, and the index isn't visible to
+		// other threads until it's pushed onto the free list below.
+		volatile u16& magic = GetMagicID(magicIDs_, handle.index_, handle.type_);
+		const u16 newMagic = magic + 1;
+		magic = newMagic >= Handle::MAX_MAGIC ? 1 : newMagic;
+
+		// Push onto free list.
+		i64 head = typeData.freeHead_;
+		for(;;)
 		{
-			magic = 1;
+			typeData.next_[index] = (i32)(head & 0xffffffff);
+			const i64 oldHead = Core::AtomicCmpExchg(&typeData.freeHead_, MakeFreeHead(head, index), head);
+			if(oldHead == head)
+				break;
+			head = oldHead;
 		}
-
-		// Mark unallocated.
-		typeData.allocated_[handle.index_] = 0;
-
-		// Add to free list.
-		typeData.freeList_.push_back(handle.index_);
 	}
 
-
 	i32 HandleAllocator::GetTotalHandles(i32 type) const
 	{
-		DBG_ASSERT((i32)type < impl_->types_.size());
-		HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
+		DBG_ASSERT(type >= 0 && type < impl_->numTypes_);
+		const HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
+		const i32 numIndices = typeData.numIndices_;
 		i32 totalHandles = 0;
-		for(auto alloc : typeData.allocated_)
+		for(i32 index = 0; index < numIndices; ++index)
 		{
-			if(alloc)
+			if(typeData.next_[index] == HandleAllocatorImpl::ALLOCATED)
 				++totalHandles;
 		}
 		return totalHandles;
@@ -119,16 +159,15 @@ namespace Core
 
 	i32 HandleAllocator::GetMaxHandleIndex(i32 type) const
 	{
-		DBG_ASSERT((i32)type < impl_->types_.size());
-		HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
-		return typeData.allocated_.size();
+		DBG_ASSERT(type >= 0 && type < impl_->numTypes_);
+		return impl_->types_[type].numIndices_;
 	}
 
 	bool HandleAllocator::IsHandleIndexAllocated(i32 type, i32 index) const
 	{
-		DBG_ASSERT((i32)type < impl_->types_.size());
-		HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
-		return !!typeData.allocated_[index];
+		DBG_ASSERT(type >= 0 && type < impl_->numTypes_);
+		const HandleAllocatorImpl::TypeData& typeData = impl_->types_[type];
+		return index < typeData.numIndices_ && typeData.next_[index] == HandleAllocatorImpl::ALLOCATED;
 	}
 
 } // namespace Core
@@ -8,6 +8,21 @@
 #include <xmmintrin.h>
 #include <memory.h>
 
+#if ARCH_X86_64 || ARCH_X86
+#define TYPE_CONVERSION_SIMD 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if COMPILER_MSVC
+#include <intrin.h>
+#define TARGET_F16C
+#else
+#include <cpuid.h>
+#define TARGET_F16C __attribute__((target("f16c")))
+#endif
+#else
+#define TYPE_CONVERSION_SIMD 0
+#endif
+
 
 #if defined(COMPILER_MSVC)
 #pragma optimize("", on)
@@ -86,15 +101,137 @@ namespace Core
 
 		void F32toF16(void* outVal, const void* val, int c) { FloatToHalf((const f32*)val, (u16*)outVal, c); }
 
+		/// Maximum values passed to a ConvertFn in one call.
+		static const i32 MAX_BATCH_VALUES = 256;
+
 		template<typename TYPE, ConvertFn FN_A, ConvertFn FN_B>
 		void Adapter(void* outVal, const void* val, int c)
 		{
-			DBG_ASSERT(c <= 16);
-			Core::Array<TYPE, 16> intermediate;
+			DBG_ASSERT(c <= MAX_BATCH_VALUES);
+			Core::Array<TYPE, MAX_BATCH_VALUES> intermediate;
 			FN_A(intermediate.data(), val, c);
 			FN_B(outVal, intermediate.data(), c);
 		}
 
+#if TYPE_CONVERSION_SIMD
+		// SSE2 is always available on x86-64, F16C must be checked for.
+		bool HasF16C()
+		{
+#if COMPILER_MSVC
+			int info[4] = {};
+			__cpuid(info, 1);
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool f16c = (info[2] & (1 << 29)) != 0;
+			// F16C is VEX encoded, so OS must also save YMM state.
+			return osxsave && f16c && (_xgetbv(0) & 0x6) == 0x6;
+#else
+			unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+			if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+				return false;
+			return (ecx & bit_F16C) != 0 && __builtin_cpu_supports("avx");
+#endif
+		}
+
+		TARGET_F16C void F16toF32_F16C(void* outVal, const void* val, int c)
+		{
+			auto* outValT = (f32*)outVal;
+			const auto* inValT = (const u16*)val;
+			int i = 0;
+			for(; i + 8 <= c; i += 8)
+			{
+				const __m128i h = _mm_loadu_si128((const __m128i*)(inValT + i));
+				_mm_storeu_ps(outValT + i, _mm_cvtph_ps(h));
+				_mm_storeu_ps(outValT + i + 4, _mm_cvtph_ps(_mm_srli_si128(h, 8)));
+			}
+
+			// Remainder goes through a temporary so rounding matches the rest of the stream.
+			if(i < c)
+			{
+				Core::Array<u16, 8> inTmp = {};
+				Core::Array<f32, 8> outTmp;
+				memcpy(inTmp.data(), inValT + i, (c - i) * sizeof(u16));
+				const __m128i h = _mm_loadu_si128((const __m128i*)inTmp.data());
+				_mm_storeu_ps(outTmp.data(), _mm_cvtph_ps(h));
+				_mm_storeu_ps(outTmp.data() + 4, _mm_cvtph_ps(_mm_srli_si128(h, 8)));
+				memcpy(outValT + i, outTmp.data(), (c - i) * sizeof(f32));
+			}
+		}
+
+		TARGET_F16C void F32toF16_F16C(void* outVal, const void* val, int c)
+		{
+			auto* outValT = (u16*)outVal;
+			const auto* inValT = (const f32*)val;
+			int i = 0;
+			for(; i + 8 <= c; i += 8)
+			{
+				const __m128i a = _mm_cvtps_ph(_mm_loadu_ps(inValT + i), _MM_FROUND_TO_NEAREST_INT);
+				const __m128i b = _mm_cvtps_ph(_mm_loadu_ps(inValT + i + 4), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128((__m128i*)(outValT + i), _mm_unpacklo_epi64(a, b));
+			}
+
+			if(i < c)
+			{
+				Core::Array<f32, 8> inTmp = {};
+				Core::Array<u16, 8> outTmp;
+				memcpy(inTmp.data(), inValT + i, (c - i) * sizeof(f32));
+				const __m128i a = _mm_cvtps_ph(_mm_loadu_ps(inTmp.data()), _MM_FROUND_TO_NEAREST_INT);
+				const __m128i b = _mm_cvtps_ph(_mm_loadu_ps(inTmp.data() + 4), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128((__m128i*)outTmp.data(), _mm_unpacklo_epi64(a, b));
+				memcpy(outValT + i, outTmp.data(), (c - i) * sizeof(u16));
+			}
+		}
+
+		/// Matches F32toUNORM: clamp, scale, round half up, truncate.
+		inline __m128i F32toUNORM_SSE2(__m128 v, __m128 scale)
+		{
+			v = _mm_max_ps(_mm_setzero_ps(), _mm_min_ps(v, _mm_set1_ps(1.0f)));
+			return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), _mm_set1_ps(0.5f)));
+		}
+
+		/// Matches F32toSNORM: clamp, scale, round half away from zero, truncate.
+		inline __m128i F32toSNORM_SSE2(__m128 v, __m128 scale)
+		{
+			v = _mm_max_ps(_mm_set1_ps(-1.0f), _mm_min_ps(v, _mm_set1_ps(1.0f)));
+			v = _mm_mul_ps(v, scale);
+			const __m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(v, _mm_set1_ps(-0.0f)));
+			return _mm_cvttps_epi32(_mm_add_ps(v, half));
+		}
+
+		void F32toUNORM8_SSE2(void* outVal, const void* val, int c)
+		{
+			auto* outValT = (u8*)outVal;
+			const auto* inValT = (const f32*)val;
+			const __m128 scale = _mm_set1_ps(255.0f);
+			int i = 0;
+			for(; i + 16 <= c; i += 16)
+			{
+				const __m128i a = F32toUNORM_SSE2(_mm_loadu_ps(inValT + i), scale);
+				const __m128i b = F32toUNORM_SSE2(_mm_loadu_ps(inValT + i + 4), scale);
+				const __m128i c0 = F32toUNORM_SSE2(_mm_loadu_ps(inValT + i + 8), scale);
+				const __m128i d = F32toUNORM_SSE2(_mm_loadu_ps(inValT + i + 12), scale);
+				const __m128i ab = _mm_packs_epi32(a, b);
+				const __m128i cd = _mm_packs_epi32(c0, d);
+				_mm_storeu_si128((__m128i*)(outValT + i), _mm_packus_epi16(ab, cd));
+			}
+			F32toUNORM<u8>(outValT + i, inValT + i, c - i);
+		}
+
+		void F32toSNORM16_SSE2(void* outVal, const void* val, int c)
+		{
+			auto* outValT = (i16*)outVal;
+			const auto* inValT = (const f32*)val;
+			const __m128 scale = _mm_set1_ps(32767.0f);
+			int i = 0;
+			for(; i + 8 <= c; i += 8)
+			{
+				const __m128i a = F32toSNORM_SSE2(_mm_loadu_ps(inValT + i), scale);
+				const __m128i b = F32toSNORM_SSE2(_mm_loadu_ps(inValT + i + 4), scale);
+				_mm_storeu_si128((__m128i*)(outValT + i), _mm_packs_epi32(a, b));
+			}
+			F32toSNORM<i16>(outValT + i, inValT + i, c - i);
+		}
+#endif
+
 		// clang-format off
 		ConvertFn* FLOATtoFLOATFns[] = {
 		    // 8 -> (8, 16, 32)
@@ -311,6 +448,64 @@ namespace Core
 		};
 
 		// clang-format on
+
+		/**
+		 * Replace table entries with SIMD kernels supported by this CPU.
+		 * Table index is out + in * 3, where 0, 1, 2 are 8, 16, 32 bits.
+		 */
+		bool InitSIMDConvertFns()
+		{
+#if TYPE_CONVERSION_SIMD
+			FLOATtoUNORMFns[0 + 2 * 3] = F32toUNORM8_SSE2;
+			FLOATtoSNORMFns[1 + 2 * 3] = F32toSNORM16_SSE2;
+			if(HasF16C())
+			{
+				FLOATtoFLOATFns[2 + 1 * 3] = F16toF32_F16C;
+				FLOATtoFLOATFns[1 + 2 * 3] = F32toF16_F16C;
+			}
+#endif
+			return true;
+		}
+
+		template<i32 SIZE>
+		void CopyElements(u8* out, i32 outStride, const u8* in, i32 inStride, i32 num)
+		{
+			for(i32 i = 0; i < num; ++i, out += outStride, in += inStride)
+				memcpy(out, in, SIZE);
+		}
+
+		/**
+		 * Copy @a num elements of @a size bytes between strided streams.
+		 * Common vertex element sizes are specialised so the copy is inlined.
+		 */
+		void CopyElements(u8* out, i32 outStride, const u8* in, i32 inStride, i32 size, i32 num)
+		{
+			switch(size)
+			{
+			case 2:
+				CopyElements<2>(out, outStride, in, inStride, num);
+				break;
+			case 4:
+				CopyElements<4>(out, outStride, in, inStride, num);
+				break;
+			case 6:
+				CopyElements<6>(out, outStride, in, inStride, num);
+				break;
+			case 8:
+				CopyElements<8>(out, outStride, in, inStride, num);
+				break;
+			case 12:
+				CopyElements<12>(out, outStride, in, inStride, num);
+				break;
+			case 16:
+				CopyElements<16>(out, outStride, in, inStride, num);
+				break;
+			default:
+				for(i32 i = 0; i < num; ++i, out += outStride, in += inStride)
+					memcpy(out, in, size);
+				break;
+			}
+		}
 	}
 
 	bool Convert(StreamDesc outStream, StreamDesc inStream, i32 num, i32 components)
@@ -357,6 +552,9 @@ namespace Core
 		if(bitToBitIdx >= (NUM_BIT_SIZES * NUM_BIT_SIZES))
 			return false;
 
+		static const bool simdInitialized = InitSIMDConvertFns();
+		(void)simdInitialized;
+
 		auto typeConvFns = TypeToTypeFns[typeToTypeIdx];
 		if(typeConvFns == nullptr)
 			return false;
@@ -365,12 +563,38 @@ namespace Core
 		if(convertFn == nullptr)
 			return false;
 
-		for(i32 i = 0; i < num; ++i)
+		if(components < 1 || components > MAX_BATCH_VALUES)
+			return false;
+
+		// Convert in batches of elements, so each call converts many values at once. Interleaved streams
+		// are gathered into, and scattered out of, contiguous scratch.
+		const i32 inSize = (inStream.numBits_ >> 3) * components;
+		const i32 outSize = (outStream.numBits_ >> 3) * components;
+		const bool inPacked = inStream.stride_ == inSize;
+		const bool outPacked = outStream.stride_ == outSize;
+		const i32 batchSize = MAX_BATCH_VALUES / components;
+
+		Core::Array<u8, MAX_BATCH_VALUES * sizeof(u32)> inScratch;
+		Core::Array<u8, MAX_BATCH_VALUES * sizeof(u32)> outScratch;
+		for(i32 i = 0; i < num; i += batchSize)
 		{
-			convertFn(outStreamB, inStreamB, components);
+			const i32 batchNum = Core::Min(num - i, batchSize);
+
+			const u8* batchIn = inStreamB;
+			if(!inPacked)
+			{
+				CopyElements(inScratch.data(), inSize, inStreamB, inStream.stride_, inSize, batchNum);
+				batchIn = inScratch.data();
+			}
+
+			u8* batchOut = outPacked ? outStreamB : outScratch.data();
+			convertFn(batchOut, batchIn, batchNum * components);
+
+			if(!outPacked)
+				CopyElements(outStreamB, outStream.stride_, outScratch.data(), outSize, outSize, batchNum);
 
-			outStreamB += outStream.stride_;
-			inStreamB += inStream.stride_;
+			outStreamB += outStream.stride_ * batchNum;
+			inStreamB += inStream.stride_ * batchNum;
 		}
 
 		return true;
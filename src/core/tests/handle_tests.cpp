@@ -1,4 +1,8 @@
 #include "core/handle.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/timer.h"
+#include "core/vector.h"
 
 #include "catch.hpp"
 
@@ -62,3 +66,111 @@ TEST_CASE("handle-tests-types")
 	REQUIRE(alloc.GetTotalHandles(0) == 0);
 	REQUIRE(alloc.GetTotalHandles(1) == 0);
 }
+
+TEST_CASE("handle-tests-concurrent")
+{
+	HandleAllocator alloc(1);
+
+	struct Locals
+	{
+		HandleAllocator* alloc_ = nullptr;
+		volatile i32 sync_ = 0;
+		volatile i32 failed_ = 0;
+		i32 numThreads_ = 8;
+		i32 numHandles_ = 256;
+		i32 numIterations_ = 64;
+	};
+
+	Locals locals;
+	locals.alloc_ = &alloc;
+
+	Vector<Thread> threads;
+	for(i32 i = 0; i < locals.numThreads_; ++i)
+	{
+		threads.emplace_back(Thread(
+		    [](void* userData) -> int {
+			    Locals& locals = *reinterpret_cast<Locals*>(userData);
+			    AtomicInc(&locals.sync_);
+			    while(locals.sync_ < locals.numThreads_)
+				    SwitchThread();
+
+			    Vector<Handle> handles;
+			    handles.reserve(locals.numHandles_);
+			    for(i32 iteration = 0; iteration < locals.numIterations_; ++iteration)
+			    {
+				    for(i32 idx = 0; idx < locals.numHandles_; ++idx)
+					    handles.push_back(locals.alloc_->Alloc(0));
+
+				    // A handle also given to another thread would be invalidated when that thread frees it.
+				    for(auto handle : handles)
+					    if(!handle || !locals.alloc_->IsValid(handle))
+						    AtomicInc(&locals.failed_);
+
+				    for(auto handle : handles)
+					    locals.alloc_->Free(handle);
+				    handles.clear();
+			    }
+			    return 0;
+			},
+		    &locals));
+	}
+
+	for(auto& thread : threads)
+		thread.Join();
+
+	REQUIRE(locals.failed_ == 0);
+	REQUIRE(alloc.GetTotalHandles(0) == 0);
+	REQUIRE(alloc.GetMaxHandleIndex(0) <= locals.numThreads_ * locals.numHandles_);
+}
+
+TEST_CASE("handle-tests-concurrent-benchmark")
+{
+	HandleAllocator alloc(1);
+
+	struct Locals
+	{
+		HandleAllocator* alloc_ = nullptr;
+		volatile i32 sync_ = 0;
+		i32 numThreads_ = 8;
+		i32 numHandles_ = 1024;
+		i32 numIterations_ = 256;
+	};
+
+	Locals locals;
+	locals.alloc_ = &alloc;
+
+	Timer timer;
+	timer.Mark();
+	Vector<Thread> threads;
+	for(i32 i = 0; i < locals.numThreads_; ++i)
+	{
+		threads.emplace_back(Thread(
+		    [](void* userData) -> int {
+			    Locals& locals = *reinterpret_cast<Locals*>(userData);
+			    AtomicInc(&locals.sync_);
+			    while(locals.sync_ < locals.numThreads_)
+				    SwitchThread();
+
+			    Vector<Handle> handles;
+			    handles.resize(locals.numHandles_);
+			    for(i32 iteration = 0; iteration < locals.numIterations_; ++iteration)
+			    {
+				    for(auto& handle : handles)
+					    handle = locals.alloc_->Alloc(0);
+				    for(auto handle : handles)
+					    locals.alloc_->Free(handle);
+			    }
+			    return 0;
+			},
+		    &locals));
+	}
+
+	for(auto& thread : threads)
+		thread.Join();
+	const f64 time = timer.GetTime();
+
+	const i32 numHandles = locals.numThreads_ * locals.numHandles_ * locals.numIterations_;
+	Log("handle-tests-concurrent-benchmark: %i handles, %i threads: %f ms (%f ns per alloc & free)\n", numHandles,
+	    locals.numThreads_, time * 1000.0, time * 1000000000.0 / (f64)numHandles);
+	REQUIRE(alloc.GetTotalHandles(0) == 0);
+}
@@ -1,11 +1,15 @@
 #include "core/array.h"
 #include "core/debug.h"
+#include "core/half.h"
 #include "core/misc.h"
+#include "core/timer.h"
 #include "core/type_conversion.h"
 #include "core/vector.h"
 
 #include "catch.hpp"
 
+#include <cmath>
+
 namespace
 {
 	Core::Array<f32, 11> floatArray_UNORM = {0.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.0f};
@@ -59,6 +63,114 @@ namespace
 		}
 		return error;
 	}
+
+	const u8* GetValuePtr(const Core::StreamDesc& stream, i32 idx, i32 component)
+	{
+		return (const u8*)stream.data_ + idx * stream.stride_ + component * (stream.numBits_ / 8);
+	}
+
+	/// Read float input, 16 or 32 bit.
+	f32 ReadFloat(const Core::StreamDesc& stream, i32 idx, i32 component)
+	{
+		const u8* ptr = GetValuePtr(stream, idx, component);
+		f32 value = 0.0f;
+		if(stream.numBits_ == 16)
+			Core::HalfToFloat((const u16*)ptr, &value, 1);
+		else
+			memcpy(&value, ptr, sizeof(f32));
+		return value;
+	}
+
+	/// Read output bits, zero extended.
+	u32 ReadBits(const Core::StreamDesc& stream, i32 idx, i32 component)
+	{
+		const u8* ptr = GetValuePtr(stream, idx, component);
+		u32 bits = 0;
+		memcpy(&bits, ptr, stream.numBits_ / 8);
+		return bits;
+	}
+
+	/// Scalar reference conversion from float, matching the non-SIMD conversion functions.
+	u32 ReferenceBits(f32 value, Core::DataType dataType, i32 numBits)
+	{
+		u32 bits = 0;
+		if(dataType == Core::DataType::FLOAT && numBits == 16)
+		{
+			u16 half = 0;
+			Core::FloatToHalf(&value, &half, 1);
+			bits = half;
+		}
+		else if(dataType == Core::DataType::FLOAT && numBits == 32)
+		{
+			memcpy(&bits, &value, sizeof(f32));
+		}
+		else if(dataType == Core::DataType::UNORM)
+		{
+			const f32 scale = (f32)((1 << numBits) - 1);
+			bits = (u32)(Core::Clamp(value, 0.0f, 1.0f) * scale + 0.5f);
+		}
+		else if(dataType == Core::DataType::SNORM)
+		{
+			const f32 scale = (f32)((1 << (numBits - 1)) - 1);
+			const f32 v = Core::Clamp(value, -1.0f, 1.0f) * scale;
+			bits = (u32)(i32)(v >= 0.0f ? v + 0.5f : v - 0.5f) & ((1 << numBits) - 1);
+		}
+		return bits;
+	}
+
+	/**
+	 * Compare every value in @a outStream against a scalar reference conversion of @a inStream.
+	 * Float outputs may differ by @a floatULPs, as hardware conversion rounds to nearest even.
+	 * @return Number of mismatching values.
+	 */
+	i32 CountMismatches(const Core::StreamDesc& outStream, const Core::StreamDesc& inStream, i32 num, i32 components,
+	    u32 floatULPs = 1)
+	{
+		const u32 tolerance = outStream.dataType_ == Core::DataType::FLOAT ? floatULPs : 0;
+		i32 numMismatches = 0;
+		for(i32 idx = 0; idx < num; ++idx)
+		{
+			for(i32 component = 0; component < components; ++component)
+			{
+				const f32 value = ReadFloat(inStream, idx, component);
+				const u32 expected = ReferenceBits(value, outStream.dataType_, outStream.numBits_);
+				const u32 actual = ReadBits(outStream, idx, component);
+				const u32 diff = expected > actual ? expected - actual : actual - expected;
+				if(diff > tolerance)
+				{
+					if(numMismatches++ == 0)
+						Core::Log("First mismatch at element %d, component %d: %f expected 0x%x, got 0x%x\n", idx,
+						    component, value, expected, actual);
+				}
+			}
+		}
+		return numMismatches;
+	}
+
+	/// Values covering clamping, rounding boundaries and sign, in the normal half range.
+	void FillTestValues(Core::Vector<f32>& values, i32 num)
+	{
+		values.resize(num);
+		for(i32 i = 0; i < num; ++i)
+		{
+			switch(i % 4)
+			{
+			case 0:
+				values[i] = std::sin((f32)i * 0.37f) * 1.25f;
+				break;
+			case 1:
+				// Just either side of UNORM8 rounding boundaries.
+				values[i] = ((f32)((i / 4) % 255) + 0.5f) / 255.0f + ((i & 8) ? 1.0e-5f : -1.0e-5f);
+				break;
+			case 2:
+				values[i] = -values[i - 1];
+				break;
+			case 3:
+				values[i] = (f32)((i / 4) % 64 - 32) * 0.125f;
+				break;
+			}
+		}
+	}
 }
 
 TEST_CASE("type-conversion-tests-f32-to-f16")
@@ -256,3 +368,177 @@ TEST_CASE("type-conversion-tests-interleaved-data")
 	const f32 MAX_ERROR = 1.0f / (f32)0xff;
 	CHECK(doConversionTest(interleavedArray.data(), interleavedArray.size()) < MAX_ERROR);
 }
+
+TEST_CASE("type-conversion-tests-simd-vs-scalar")
+{
+	// Odd sizes, so 16 wide and 8 wide loops have remainders, and more than one 256 value batch.
+	const i32 sizes[] = {1, 7, 15, 16, 17, 255, 256, 257, 4099};
+
+	Core::Vector<f32> floatIn;
+	FillTestValues(floatIn, 4099 * 4);
+	Core::Vector<u16> halfIn;
+	halfIn.resize(floatIn.size());
+	Core::FloatToHalf(floatIn.data(), halfIn.data(), floatIn.size());
+	Core::Vector<u8> out;
+	out.resize(floatIn.size() * sizeof(f32));
+
+	struct TestCase
+	{
+		const char* name_;
+		Core::StreamDesc outStream_;
+		Core::StreamDesc inStream_;
+	};
+
+	const TestCase cases[] = {
+	    {"f32 -> unorm8", {out.data(), Core::DataType::UNORM, 8, sizeof(u8)},
+	        {floatIn.data(), Core::DataType::FLOAT, 32, sizeof(f32)}},
+	    {"f32 -> snorm16", {out.data(), Core::DataType::SNORM, 16, sizeof(i16)},
+	        {floatIn.data(), Core::DataType::FLOAT, 32, sizeof(f32)}},
+	    {"f32 -> f16", {out.data(), Core::DataType::FLOAT, 16, sizeof(u16)},
+	        {floatIn.data(), Core::DataType::FLOAT, 32, sizeof(f32)}},
+	    {"f16 -> f32", {out.data(), Core::DataType::FLOAT, 32, sizeof(f32)},
+	        {halfIn.data(), Core::DataType::FLOAT, 16, sizeof(u16)}},
+	};
+
+	for(const auto& testCase : cases)
+	{
+		for(i32 num : sizes)
+		{
+			INFO(testCase.name_ << ", " << num << " elements");
+			memset(out.data(), 0xcd, out.size());
+			REQUIRE(Core::Convert(testCase.outStream_, testCase.inStream_, num, 1));
+			CHECK(CountMismatches(testCase.outStream_, testCase.inStream_, num, 1) == 0);
+
+			// Values past the end must be untouched.
+			const i32 outBytes = num * testCase.outStream_.stride_;
+			CHECK(out[outBytes] == 0xcd);
+		}
+	}
+}
+
+TEST_CASE("type-conversion-tests-strided-batches")
+{
+	// Strided in and out streams are gathered & scattered through 256 value batches. Component counts that
+	// don't divide 256 leave partial batches, and element counts straddle batch boundaries.
+	const i32 components[] = {1, 3, 4, 5};
+	const i32 sizes[] = {1, 51, 85, 86, 256, 257, 1001};
+	const i32 MAX_COMPONENTS = 5;
+	const i32 IN_STRIDE = sizeof(f32) * (MAX_COMPONENTS + 2);
+	const i32 MAX_SIZE = 1001;
+
+	Core::Vector<f32> values;
+	FillTestValues(values, MAX_SIZE * (IN_STRIDE / sizeof(f32)));
+	Core::Vector<u8> out;
+
+	struct TestCase
+	{
+		const char* name_;
+		Core::DataType dataType_;
+		i32 numBits_;
+	};
+
+	const TestCase cases[] = {
+	    {"unorm8", Core::DataType::UNORM, 8},
+	    {"snorm16", Core::DataType::SNORM, 16},
+	    {"f16", Core::DataType::FLOAT, 16},
+	    {"f32", Core::DataType::FLOAT, 32},
+	};
+
+	for(const auto& testCase : cases)
+	{
+		for(i32 numComponents : components)
+		{
+			// Odd output stride, 3 bytes of padding per element.
+			const i32 outStride = (testCase.numBits_ / 8) * numComponents + 3;
+			out.resize(MAX_SIZE * outStride + 1);
+
+			for(i32 num : sizes)
+			{
+				INFO(testCase.name_ << " x" << numComponents << ", " << num << " elements");
+				memset(out.data(), 0xcd, out.size());
+
+				Core::StreamDesc inStream(values.data(), Core::DataType::FLOAT, 32, IN_STRIDE);
+				Core::StreamDesc outStream(out.data(), testCase.dataType_, testCase.numBits_, outStride);
+				REQUIRE(Core::Convert(outStream, inStream, num, numComponents));
+				CHECK(CountMismatches(outStream, inStream, num, numComponents) == 0);
+
+				// Padding between elements must be untouched.
+				i32 numPaddingWritten = 0;
+				for(i32 idx = 0; idx < num; ++idx)
+					for(i32 pad = outStride - 3; pad < outStride; ++pad)
+						numPaddingWritten += out[idx * outStride + pad] != 0xcd ? 1 : 0;
+				CHECK(numPaddingWritten == 0);
+			}
+		}
+	}
+}
+
+TEST_CASE("type-conversion-tests-benchmark")
+{
+	const i32 NUM_ELEMENTS = 1024 * 1024;
+	const i32 NUM_ITERATIONS = 8;
+
+	Core::Vector<f32> floatData;
+	Core::Vector<u16> halfData;
+	Core::Vector<u8> outData;
+	Core::Vector<InterleavedDataIn> interleavedIn;
+	Core::Vector<InterleavedDataOut> interleavedOut;
+	floatData.resize(NUM_ELEMENTS * 4);
+	halfData.resize(NUM_ELEMENTS * 4);
+	outData.resize(NUM_ELEMENTS * 4 * sizeof(f32));
+	interleavedIn.resize(NUM_ELEMENTS);
+	interleavedOut.resize(NUM_ELEMENTS);
+
+	for(i32 i = 0; i < floatData.size(); ++i)
+		floatData[i] = std::sin((f32)i * 0.01f);
+	Core::FloatToHalf(floatData.data(), halfData.data(), floatData.size());
+	for(i32 i = 0; i < interleavedIn.size(); ++i)
+		memcpy(&interleavedIn[i], &floatData[(i * 9) % (floatData.size() - 9)], sizeof(InterleavedDataIn));
+
+	struct BenchmarkCase
+	{
+		const char* name_;
+		Core::StreamDesc outStream_;
+		Core::StreamDesc inStream_;
+		i32 components_;
+	};
+
+	const BenchmarkCase cases[] = {
+	    {"f32x4 -> f16x4", {outData.data(), Core::DataType::FLOAT, 16, sizeof(u16) * 4},
+	        {floatData.data(), Core::DataType::FLOAT, 32, sizeof(f32) * 4}, 4},
+	    {"f16x4 -> f32x4", {outData.data(), Core::DataType::FLOAT, 32, sizeof(f32) * 4},
+	        {halfData.data(), Core::DataType::FLOAT, 16, sizeof(u16) * 4}, 4},
+	    {"f32x4 -> unorm8x4", {outData.data(), Core::DataType::UNORM, 8, sizeof(u8) * 4},
+	        {floatData.data(), Core::DataType::FLOAT, 32, sizeof(f32) * 4}, 4},
+	    {"f32x4 -> snorm16x4", {outData.data(), Core::DataType::SNORM, 16, sizeof(i16) * 4},
+	        {floatData.data(), Core::DataType::FLOAT, 32, sizeof(f32) * 4}, 4},
+	    {"f32x3 -> f16x3 interleave", {&interleavedOut[0].x_, Core::DataType::FLOAT, 16, sizeof(InterleavedDataOut)},
+	        {floatData.data(), Core::DataType::FLOAT, 32, sizeof(f32) * 3}, 3},
+	    {"f32x4 -> unorm8x4 interleave", {&interleavedOut[0].r_, Core::DataType::UNORM, 8, sizeof(InterleavedDataOut)},
+	        {floatData.data(), Core::DataType::FLOAT, 32, sizeof(f32) * 4}, 4},
+	    {"f32x3 -> f32x3 deinterleave", {outData.data(), Core::DataType::FLOAT, 32, sizeof(f32) * 3},
+	        {&interleavedIn[0].x_, Core::DataType::FLOAT, 32, sizeof(InterleavedDataIn)}, 3},
+	    {"f32x4 -> unorm8x4 deinterleave", {outData.data(), Core::DataType::UNORM, 8, sizeof(u8) * 4},
+	        {&interleavedIn[0].r_, Core::DataType::FLOAT, 32, sizeof(InterleavedDataIn)}, 4},
+	};
+
+	Core::Log("Stream conversion, %d elements:\n", NUM_ELEMENTS);
+	for(const auto& benchmarkCase : cases)
+	{
+		Core::Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			REQUIRE(Core::Convert(
+			    benchmarkCase.outStream_, benchmarkCase.inStream_, NUM_ELEMENTS, benchmarkCase.components_));
+		const f64 time = timer.GetTime();
+
+		// Output must match scalar conversion, or the timing means nothing.
+		CHECK(CountMismatches(benchmarkCase.outStream_, benchmarkCase.inStream_, NUM_ELEMENTS,
+		          benchmarkCase.components_) == 0);
+
+		// Only bytes read & written count, not stride padding.
+		const i32 numBits = benchmarkCase.outStream_.numBits_ + benchmarkCase.inStream_.numBits_;
+		const f64 numBytes = (f64)NUM_ELEMENTS * benchmarkCase.components_ * (numBits / 8) * NUM_ITERATIONS;
+		Core::Log(" - %-32s %8.2f GB/s\n", benchmarkCase.name_, numBytes / time / 1000000000.0);
+	}
+}
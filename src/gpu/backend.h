@@ -46,6 +46,13 @@ namespace GPU
 		virtual ErrorCode CreateFence(Handle handle, const char* debugName) = 0;
 		virtual ErrorCode DestroyResource(Handle handle) = 0;
 
+		/**
+		 * Upload management.
+		 * Create persistently mapped upload memory of @a size bytes that the GPU can copy from.
+		 * Offsets into it are passed in CommandUpdateBuffer & CommandUpdateTextureSubResource.
+		 */
+		virtual ErrorCode CreateUploadRing(i64 size, void** outAddress) = 0;
+
 		/**
 		 * Binding management.
 		 */
@@ -62,8 +69,15 @@ namespace GPU
 		/**
 		 * Command list management.
 		 */
-		virtual ErrorCode CompileCommandList(Handle handle, const CommandList& commandList) = 0;
-		virtual ErrorCode SubmitCommandLists(Core::ArrayView<Handle> handles) = 0;
+		virtual ErrorCode CompileCommandList(
+		    Handle handle, const CommandList& commandList, CommandQueueType queueType) = 0;
+		virtual ErrorCode SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType) = 0;
+
+		/**
+		 * Queue synchronization.
+		 */
+		virtual ErrorCode SignalFence(CommandQueueType queueType, Handle handle, i64 value) = 0;
+		virtual ErrorCode WaitOnFence(CommandQueueType queueType, Handle handle, i64 value) = 0;
 
 		/**
 		 * Swapchain management.
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gpu/dll.h"
+#include "gpu/commands.h"
+#include "gpu/types.h"
+#include "core/array.h"
+
+namespace GPU
+{
+	class IBackend;
+
+	/**
+	 * Replay parameters.
+	 */
+	struct GPU_DLL ReplayParams
+	{
+		/// Number of times to replay the whole capture.
+		i32 numIterations_ = 1;
+		/// Window to create captured swap chains on. Required by backends that present.
+		void* outputWindow_ = nullptr;
+	};
+
+	/**
+	 * Replay statistics.
+	 * All times are CPU time spent inside the backend, in seconds, summed over all iterations.
+	 */
+	struct GPU_DLL ReplayStats
+	{
+		/// Number of iterations replayed.
+		i32 numIterations_ = 0;
+		/// Number of frames replayed.
+		i32 numFrames_ = 0;
+		/// Number of backend calls that failed.
+		i32 numErrors_ = 0;
+
+		/// Time spent creating & destroying resources.
+		f64 resourceTime_ = 0.0;
+		/// Time spent updating & copying pipeline bindings.
+		f64 bindingTime_ = 0.0;
+		/// Time spent compiling command lists.
+		f64 compileTime_ = 0.0;
+		/// Time spent submitting command lists, signalling fences & presenting.
+		f64 submitTime_ = 0.0;
+
+		/// Number of each command type compiled.
+		Core::Array<i32, (i32)CommandType::MAX> commandCount_ = {};
+		/// Time spent compiling each command type.
+		Core::Array<f64, (i32)CommandType::MAX> commandTime_ = {};
+	};
+
+	/**
+	 * Replay a capture written by a backend created with SetupParams::capturePath_ set.
+	 * Resources are created, and command lists compiled and submitted in the same order they
+	 * were captured. Each command list is also recompiled once per command type containing only
+	 * commands of that type, to attribute backend CPU cost to individual command types.
+	 * @param backend Initialized backend to replay into.
+	 * @param path Capture file path.
+	 * @param params Replay parameters.
+	 * @param outStats Statistics gathered during replay.
+	 * @return true if capture was successfully read. Individual backend failures are counted in outStats.
+	 */
+	GPU_DLL bool ReplayCapture(IBackend& backend, const char* path, const ReplayParams& params, ReplayStats& outStats);
+
+	/**
+	 * Log replay statistics as a table.
+	 */
+	GPU_DLL void LogReplayStats(const ReplayStats& stats);
+
+} // namespace GPU
@@ -35,10 +35,11 @@ namespace GPU
 		/**
 		 * Allocate from command list.
 		 * @param bytes Number of bytes to allocate.
+		 * @param align Alignment of allocation. Must be power of 2.
 		 * @return Allocated memory. Only valid until submission.
 		 * @pre @a bytes > 0.
 		 */
-		GPU_DLL void* Alloc(i32 bytes);
+		GPU_DLL void* Alloc(i32 bytes, i32 align = sizeof(size_t));
 
 		/**
 		 * Templated alloc. See above.
@@ -46,7 +47,7 @@ namespace GPU
 		template<typename TYPE>
 		TYPE* Alloc(i32 num = 1)
 		{
-			auto* data = Alloc(sizeof(TYPE) * num);
+			auto* data = Alloc(sizeof(TYPE) * num, alignof(TYPE));
 			if(data)
 				return new(data) TYPE[num];
 			return nullptr;
@@ -67,7 +68,7 @@ namespace GPU
 		template<typename TYPE>
 		const TYPE* Push(const TYPE* data, i32 num = 1)
 		{
-			TYPE* dest = reinterpret_cast<TYPE*>(Alloc(sizeof(TYPE) * num));
+			TYPE* dest = reinterpret_cast<TYPE*>(Alloc(sizeof(TYPE) * num, alignof(TYPE)));
 			if(dest)
 				for(i32 idx = 0; idx < num; ++idx)
 					new(dest + idx) TYPE(data[idx]);
@@ -80,7 +81,7 @@ namespace GPU
 		template<typename TYPE>
 		Core::ArrayView<TYPE> Push(const Core::ArrayView<TYPE> data)
 		{
-			TYPE* dest = reinterpret_cast<TYPE*>(Alloc(sizeof(TYPE) * data.size()));
+			TYPE* dest = reinterpret_cast<TYPE*>(Alloc(sizeof(TYPE) * data.size(), alignof(TYPE)));
 			if(dest)
 				for(i32 idx = 0; idx < data.size(); ++idx)
 					new(dest + idx) TYPE(data[idx]);
@@ -125,11 +126,12 @@ namespace GPU
 		 * @pre @a countBuffer nullptr, or valid buffer.
 		 * @pre @a countByteOffset >= 0.
 		 * @pre @a maxCommands >= 1.
+		 * @param drawIds Arguments are DrawIdArgs or DrawIndexedIdArgs, see CommandDrawIndirect::drawIds_.
 		 * @return Dispatch command. nullptr if failure.
 		 */
 		GPU_DLL CommandDrawIndirect* DrawIndirect(Handle ps, Core::ArrayView<PipelineBinding> pb, Handle drawBinding,
 		    Handle frameBinding, const DrawState& drawState, PrimitiveTopology primitive, Handle indirectBuffer,
-		    i32 argByteOffset, Handle countBuffer, i32 countByteOffset, i32 maxCommands);
+		    i32 argByteOffset, Handle countBuffer, i32 countByteOffset, i32 maxCommands, bool drawIds = false);
 
 		/**
 		 * See @a CommandDispatch.
@@ -195,6 +197,16 @@ namespace GPU
 		 */
 		GPU_DLL CommandUpdateBuffer* UpdateBuffer(Handle buffer, i32 offset, i32 size, const void* data);
 
+		/**
+		 * See @a CommandUpdateBuffer.
+		 * Data is copied straight from the upload ring, rather than the command list.
+		 * @pre @a buffer is valid.
+		 * @pre @a offset >= 0.
+		 * @pre @a upload is valid.
+		 * @return Update command. nullptr if failure.
+		 */
+		GPU_DLL CommandUpdateBuffer* UpdateBuffer(Handle buffer, i32 offset, const UploadAllocation& upload);
+
 		/**
 		 * See @a CommandUpdateTextureSubResource.
 		 * @pre @a texture is valid.
@@ -205,6 +217,18 @@ namespace GPU
 		GPU_DLL CommandUpdateTextureSubResource* UpdateTextureSubResource(
 		    Handle texture, i32 subResourceIdx, const TextureSubResourceData& data);
 
+		/**
+		 * See @a CommandUpdateTextureSubResource.
+		 * Data is copied straight from the upload ring, rather than the command list.
+		 * @pre @a texture is valid.
+		 * @pre @a subResourceIdx >= 0.
+		 * @pre @a upload is valid, and aligned to UPLOAD_TEXTURE_DATA_ALIGNMENT.
+		 * @pre @a rowPitch > 0, and @a slicePitch > 0.
+		 * @return Update command. nullptr if failure.
+		 */
+		GPU_DLL CommandUpdateTextureSubResource* UpdateTextureSubResource(
+		    Handle texture, i32 subResourceIdx, const UploadAllocation& upload, i32 rowPitch, i32 slicePitch);
+
 		/**
 		 * See @a CommandCopyBuffer.
 		 * @pre @a srcBuffer is valid.
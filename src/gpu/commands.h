@@ -34,6 +34,8 @@ namespace GPU
 		// Debug.
 		BEGIN_EVENT,
 		END_EVENT,
+
+		MAX,
 	};
 
 	/**
@@ -152,6 +154,9 @@ namespace GPU
 		i32 countByteOffset_ = 0;
 		/// Maximum number of commands to invoke.
 		i32 maxCommands_ = 0;
+		/// Arguments are DrawIdArgs or DrawIndexedIdArgs, each setting drawParams.drawId for its draw.
+		/// Otherwise drawParams.drawId is 0, as for CommandDraw.
+		bool drawIds_ = false;
 	};
 
 	/**
@@ -260,6 +265,8 @@ namespace GPU
 		i32 size_ = 0;
 		/// Pointer to data.
 		const void* data_ = nullptr;
+		/// Offset of data within upload ring. -1 if data isn't in the upload ring.
+		i64 uploadOffset_ = -1;
 	};
 
 	/**
@@ -275,6 +282,8 @@ namespace GPU
 		i16 subResourceIdx_ = 0;
 		/// Subresource data.
 		TextureSubResourceData data_;
+		/// Offset of data within upload ring. -1 if data isn't in the upload ring.
+		i64 uploadOffset_ = -1;
 	};
 
 	/**
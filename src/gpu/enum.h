@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gpu/dll.h"
+#include "gpu/commands.h"
 #include "gpu/types.h"
 #include "core/enum.h"
 
@@ -18,4 +19,5 @@ namespace Core
 	GPU_DLL const char* EnumToString(GPU::CompareMode val);
 	GPU_DLL const char* EnumToString(GPU::StencilFunc val);
 	GPU_DLL const char* EnumToString(GPU::ShaderType val);
+	GPU_DLL const char* EnumToString(GPU::CommandType val);
 }
\ No newline at end of file
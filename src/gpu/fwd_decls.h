@@ -32,6 +32,7 @@ namespace GPU
 	struct GPU_DLL BufferDesc;
 	struct GPU_DLL TextureDesc;
 	struct GPU_DLL TextureSubResourceData;
+	struct GPU_DLL UploadAllocation;
 	struct GPU_DLL SamplerState;
 	struct GPU_DLL ShaderDesc;
 	struct GPU_DLL BlendState;
@@ -128,6 +128,18 @@ namespace GPU
 		 */
 		static Handle AllocTemporaryPipelineBindingSet(const PipelineBindingSetDesc& desc);
 
+		/**
+		 * Allocate from upload ring.
+		 * Memory can be written to directly, then passed to CommandList::UpdateBuffer or
+		 * CommandList::UpdateTextureSubResource, which avoids copying it into the command list.
+		 * This will allocate memory that is only valid for the next (MAX_GPU_FRAMES-1) frames.
+		 * @param size Size in bytes.
+		 * @param alignment Power of two alignment.
+		 * @return Allocation. Invalid if the upload ring is full or disabled, in which case callers should
+		 * fall back to CommandList::Alloc.
+		 */
+		static UploadAllocation AllocUpload(i32 size, i32 alignment = RESOURCE_DATA_ALIGNMENT);
+
 		/**
 		 * Update pipeline bindings. 
 		 * @param handle Handle to pipeline binding set.
@@ -159,9 +171,11 @@ namespace GPU
 		 * Compile command list.
 		 * @param handle Handle to command list.
 		 * @param commandList Input software command list.
+		 * @param queueType Queue the command list will be submitted to.
 		 * @return Success.
 		 */
-		static bool CompileCommandList(Handle handle, const CommandList& commandList);
+		static bool CompileCommandList(
+		    Handle handle, const CommandList& commandList, CommandQueueType queueType = CommandQueueType::GRAPHICS);
 
 		/**
 		 * Submit command list.
@@ -173,9 +187,29 @@ namespace GPU
 		/**
 		 * Submit command lists.
 		 * @param handles Handles to command lists.
+		 * @param queueType Queue to submit to. Must be GRAPHICS or COMPUTE.
+		 * @return Success.
+		 */
+		static bool SubmitCommandLists(
+		    Core::ArrayView<Handle> handles, CommandQueueType queueType = CommandQueueType::GRAPHICS);
+
+		/**
+		 * Signal fence from queue once all previously submitted work on it has completed.
+		 * @param queueType Queue to signal from.
+		 * @param fence Fence to signal.
+		 * @param value Value to set fence to.
 		 * @return Success.
 		 */
-		static bool SubmitCommandLists(Core::ArrayView<Handle> handles);
+		static bool SignalFence(CommandQueueType queueType, Handle fence, i64 value);
+
+		/**
+		 * Make queue wait until fence has reached value before executing subsequently submitted work.
+		 * @param queueType Queue that should wait.
+		 * @param fence Fence to wait on.
+		 * @param value Value to wait for.
+		 * @return Success.
+		 */
+		static bool WaitOnFence(CommandQueueType queueType, Handle fence, i64 value);
 
 		/**
 		 * Present swapchain.
@@ -192,6 +226,11 @@ namespace GPU
 		 */
 		static void NextFrame();
 
+		/**
+		 * @return Number of commands compiled between the last two calls to NextFrame.
+		 */
+		static i32 GetNumFrameCommands();
+
 		/**
 		 * Is valid handle?
 		 */
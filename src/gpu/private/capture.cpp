@@ -0,0 +1,1401 @@
+#include "gpu/capture.h"
+#include "gpu/backend.h"
+#include "gpu/command_list.h"
+#include "gpu/enum.h"
+#include "gpu/private/capture_backend.h"
+
+#include "core/debug.h"
+#include "core/handle.h"
+#include "core/misc.h"
+#include "core/timer.h"
+
+#include <climits>
+#include <cstring>
+#include <type_traits>
+
+namespace GPU
+{
+	namespace
+	{
+		/**
+		 * Serializes record payloads into a flat buffer.
+		 */
+		class CaptureWriter
+		{
+		public:
+			template<typename TYPE>
+			void Write(const TYPE& value)
+			{
+				static_assert(std::is_trivially_copyable<TYPE>::value, "Type must be trivially copyable.");
+				WriteBytes(&value, sizeof(TYPE));
+			}
+
+			void WriteBytes(const void* data, i64 size)
+			{
+				DBG_ASSERT(size >= 0 && size < INT_MAX);
+				if(size > 0)
+				{
+					DBG_ASSERT(data);
+					const i32 offset = data_.size();
+					data_.resize(offset + (i32)size);
+					memcpy(data_.data() + offset, data, (size_t)size);
+				}
+			}
+
+			template<typename TYPE>
+			void WriteArray(Core::ArrayView<TYPE> values)
+			{
+				Write(values.size());
+				WriteBytes(values.data(), sizeof(TYPE) * values.size());
+			}
+
+			void WriteString(const char* str)
+			{
+				const i32 length = str ? (i32)strlen(str) : 0;
+				Write(length);
+				WriteBytes(str, length);
+			}
+
+			Core::Vector<u8> data_;
+		};
+
+		/**
+		 * Reads record payloads written by CaptureWriter.
+		 * Reads past the end of the payload fail and mark the reader as invalid.
+		 */
+		class CaptureReader
+		{
+		public:
+			CaptureReader(const u8* data, i32 size)
+			    : data_(data)
+			    , size_(size)
+			{
+			}
+
+			template<typename TYPE>
+			bool Read(TYPE& outValue)
+			{
+				if(const void* src = ReadBytes(sizeof(TYPE)))
+				{
+					memcpy(&outValue, src, sizeof(TYPE));
+					return true;
+				}
+				return false;
+			}
+
+			const void* ReadBytes(i64 size)
+			{
+				if(size < 0 || (offset_ + size) > size_)
+				{
+					valid_ = false;
+					return nullptr;
+				}
+				const void* retVal = data_ + offset_;
+				offset_ += (i32)size;
+				return retVal;
+			}
+
+			template<typename TYPE>
+			bool ReadArray(Core::Vector<TYPE>& outValues)
+			{
+				i32 num = 0;
+				if(!Read(num))
+					return false;
+				const void* src = ReadBytes(sizeof(TYPE) * (i64)num);
+				if(src == nullptr)
+					return false;
+				outValues.resize(num);
+				memcpy(outValues.data(), src, sizeof(TYPE) * num);
+				return true;
+			}
+
+			bool ReadString(Core::Vector<char>& outString)
+			{
+				i32 length = 0;
+				if(!Read(length))
+					return false;
+				const void* src = ReadBytes(length);
+				if(src == nullptr)
+					return false;
+				outString.resize(length + 1);
+				memcpy(outString.data(), src, length);
+				outString[length] = '\0';
+				return true;
+			}
+
+			bool IsValid() const { return valid_; }
+			bool IsEnd() const { return offset_ >= size_; }
+			i32 GetRemaining() const { return size_ - offset_; }
+
+		private:
+			const u8* data_ = nullptr;
+			i32 size_ = 0;
+			i32 offset_ = 0;
+			bool valid_ = true;
+		};
+
+		i32 GetNumSubResources(const TextureDesc& desc)
+		{
+			return desc.levels_ * desc.elements_ * (desc.type_ == TextureType::TEXCUBE ? 6 : 1);
+		}
+
+		i64 GetSubResourceSize(const TextureDesc& desc, i32 subResourceIdx, const TextureSubResourceData& data)
+		{
+			const i32 mipIdx = subResourceIdx % desc.levels_;
+			const i32 depth = desc.type_ == TextureType::TEX3D ? Core::Max(1, desc.depth_ >> mipIdx) : 1;
+			return (i64)data.slicePitch_ * depth;
+		}
+
+		template<typename TYPE>
+		void WriteCommand(CaptureWriter& writer, const TYPE& command)
+		{
+			writer.Write(command.type_);
+			writer.WriteBytes(&command, sizeof(TYPE));
+		}
+
+		template<typename TYPE>
+		void WritePipelineBindings(CaptureWriter& writer, Core::ArrayView<TYPE> pipelineBindings)
+		{
+			writer.WriteArray(pipelineBindings);
+		}
+	}
+
+	CaptureBackend::CaptureBackend(IBackend* backend, const char* path)
+	    : backend_(backend)
+	    , file_(path, Core::FileFlags::DEFAULT_WRITE)
+	{
+		DBG_ASSERT(backend_);
+		DBG_ASSERT_MSG(!!file_, "Unable to open \"%s\" for writing.", path);
+
+		CaptureHeader header;
+		if(file_)
+			file_.Write(&header, sizeof(header));
+	}
+
+	CaptureBackend::~CaptureBackend() {}
+
+	void CaptureBackend::WriteRecord(CaptureRecordType type, const Core::Vector<u8>& payload)
+	{
+		WriteRecord(type, payload.data(), payload.size());
+	}
+
+	void CaptureBackend::WriteRecord(CaptureRecordType type, const void* payload, i32 size)
+	{
+		if(!file_)
+			return;
+
+		CaptureRecordHeader header;
+		header.type_ = type;
+		header.size_ = size;
+
+		Core::ScopedMutex lock(mutex_);
+		file_.Write(&header, sizeof(header));
+		if(size > 0)
+			file_.Write(payload, size);
+	}
+
+	i32 CaptureBackend::EnumerateAdapters(AdapterInfo* outAdapters, i32 maxAdapters)
+	{
+		return backend_->EnumerateAdapters(outAdapters, maxAdapters);
+	}
+
+	bool CaptureBackend::IsInitialized() const { return backend_->IsInitialized(); }
+
+	ErrorCode CaptureBackend::Initialize(i32 adapterIdx) { return backend_->Initialize(adapterIdx); }
+
+	ErrorCode CaptureBackend::CreateSwapChain(Handle handle, const SwapChainDesc& desc, const char* debugName)
+	{
+		auto retVal = backend_->CreateSwapChain(handle, desc, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_SWAP_CHAIN, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateBuffer(
+	    Handle handle, const BufferDesc& desc, const void* initialData, const char* debugName)
+	{
+		auto retVal = backend_->CreateBuffer(handle, desc, initialData, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.Write(initialData != nullptr);
+			if(initialData)
+				writer.WriteBytes(initialData, desc.size_);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_BUFFER, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateTexture(
+	    Handle handle, const TextureDesc& desc, const TextureSubResourceData* initialData, const char* debugName)
+	{
+		auto retVal = backend_->CreateTexture(handle, desc, initialData, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			{
+				Core::ScopedWriteLock lock(texturesLock_);
+				textures_[handle.GetCombined()] = desc;
+			}
+
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.Write(initialData != nullptr);
+			if(initialData)
+			{
+				for(i32 idx = 0; idx < GetNumSubResources(desc); ++idx)
+				{
+					writer.Write(initialData[idx].rowPitch_);
+					writer.Write(initialData[idx].slicePitch_);
+					writer.WriteBytes(initialData[idx].data_, GetSubResourceSize(desc, idx, initialData[idx]));
+				}
+			}
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_TEXTURE, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateShader(Handle handle, const ShaderDesc& desc, const char* debugName)
+	{
+		auto retVal = backend_->CreateShader(handle, desc, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc.type_);
+			writer.Write(desc.dataSize_);
+			writer.WriteBytes(desc.data_, desc.dataSize_);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_SHADER, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateGraphicsPipelineState(
+	    Handle handle, const GraphicsPipelineStateDesc& desc, const char* debugName)
+	{
+		auto retVal = backend_->CreateGraphicsPipelineState(handle, desc, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_GRAPHICS_PIPELINE_STATE, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateComputePipelineState(
+	    Handle handle, const ComputePipelineStateDesc& desc, const char* debugName)
+	{
+		auto retVal = backend_->CreateComputePipelineState(handle, desc, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_COMPUTE_PIPELINE_STATE, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreatePipelineBindingSet(
+	    Handle handle, const PipelineBindingSetDesc& desc, const char* debugName)
+	{
+		auto retVal = backend_->CreatePipelineBindingSet(handle, desc, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_PIPELINE_BINDING_SET, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateDrawBindingSet(Handle handle, const DrawBindingSetDesc& desc, const char* debugName)
+	{
+		auto retVal = backend_->CreateDrawBindingSet(handle, desc, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_DRAW_BINDING_SET, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateFrameBindingSet(
+	    Handle handle, const FrameBindingSetDesc& desc, const char* debugName)
+	{
+		auto retVal = backend_->CreateFrameBindingSet(handle, desc, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_FRAME_BINDING_SET, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateCommandList(Handle handle, const char* debugName)
+	{
+		auto retVal = backend_->CreateCommandList(handle, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_COMMAND_LIST, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateFence(Handle handle, const char* debugName)
+	{
+		auto retVal = backend_->CreateFence(handle, debugName);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.WriteString(debugName);
+			WriteRecord(CaptureRecordType::CREATE_FENCE, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::DestroyResource(Handle handle)
+	{
+		auto retVal = backend_->DestroyResource(handle);
+		if(retVal == ErrorCode::OK)
+		{
+			if(handle.GetType() == ResourceType::TEXTURE)
+			{
+				Core::ScopedWriteLock lock(texturesLock_);
+				textures_.erase(handle.GetCombined());
+			}
+			WriteRecord(CaptureRecordType::DESTROY_RESOURCE, &handle, sizeof(handle));
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CreateUploadRing(i64 size, void** outAddress)
+	{
+		// Upload data is captured with the commands that reference it.
+		return backend_->CreateUploadRing(size, outAddress);
+	}
+
+	ErrorCode CaptureBackend::AllocTemporaryPipelineBindingSet(Handle handle, const PipelineBindingSetDesc& desc)
+	{
+		auto retVal = backend_->AllocTemporaryPipelineBindingSet(handle, desc);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(desc);
+			WriteRecord(CaptureRecordType::ALLOC_TEMPORARY_PIPELINE_BINDING_SET, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingCBV> descs)
+	{
+		auto retVal = backend_->UpdatePipelineBindings(handle, base, descs);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(base);
+			writer.WriteArray(descs);
+			WriteRecord(CaptureRecordType::UPDATE_CBVS, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingSRV> descs)
+	{
+		auto retVal = backend_->UpdatePipelineBindings(handle, base, descs);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(base);
+			writer.WriteArray(descs);
+			WriteRecord(CaptureRecordType::UPDATE_SRVS, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingUAV> descs)
+	{
+		auto retVal = backend_->UpdatePipelineBindings(handle, base, descs);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(base);
+			writer.WriteArray(descs);
+			WriteRecord(CaptureRecordType::UPDATE_UAVS, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::UpdatePipelineBindings(
+	    Handle handle, i32 base, Core::ArrayView<const SamplerState> descs)
+	{
+		auto retVal = backend_->UpdatePipelineBindings(handle, base, descs);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(base);
+			writer.WriteArray(descs);
+			WriteRecord(CaptureRecordType::UPDATE_SAMPLERS, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::CopyPipelineBindings(
+	    Core::ArrayView<const PipelineBinding> dst, Core::ArrayView<const PipelineBinding> src)
+	{
+		auto retVal = backend_->CopyPipelineBindings(dst, src);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.WriteArray(dst);
+			writer.WriteArray(src);
+			WriteRecord(CaptureRecordType::COPY_PIPELINE_BINDINGS, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::ValidatePipelineBindings(Core::ArrayView<const PipelineBinding> pb)
+	{
+		return backend_->ValidatePipelineBindings(pb);
+	}
+
+	ErrorCode CaptureBackend::CompileCommandList(
+	    Handle handle, const CommandList& commandList, CommandQueueType queueType)
+	{
+		auto retVal = backend_->CompileCommandList(handle, commandList, queueType);
+		if(retVal != ErrorCode::OK)
+			return retVal;
+
+		CaptureWriter writer;
+		writer.Write(handle);
+		writer.Write(queueType);
+		writer.Write(commandList.NumCommands());
+
+		Core::ScopedReadLock lock(texturesLock_);
+		for(const auto* command : commandList)
+		{
+#define CASE_COMMAND(TYPE_STRUCT)                                                                                      \
+	case TYPE_STRUCT::TYPE:                                                                                            \
+		WriteCommand(writer, *static_cast<const TYPE_STRUCT*>(command));                                               \
+		break
+
+			switch(command->type_)
+			{
+				CASE_COMMAND(CommandDraw);
+				CASE_COMMAND(CommandDrawIndirect);
+				CASE_COMMAND(CommandDispatch);
+				CASE_COMMAND(CommandDispatchIndirect);
+				CASE_COMMAND(CommandClearRTV);
+				CASE_COMMAND(CommandClearDSV);
+				CASE_COMMAND(CommandClearUAV);
+				CASE_COMMAND(CommandUpdateBuffer);
+				CASE_COMMAND(CommandUpdateTextureSubResource);
+				CASE_COMMAND(CommandCopyBuffer);
+				CASE_COMMAND(CommandCopyTextureSubResource);
+				CASE_COMMAND(CommandBeginEvent);
+				CASE_COMMAND(CommandEndEvent);
+			default:
+				DBG_ASSERT(false);
+				break;
+			}
+#undef CASE_COMMAND
+
+			// Data referenced by commands.
+			switch(command->type_)
+			{
+			case CommandType::DRAW:
+			{
+				const auto* draw = static_cast<const CommandDraw*>(command);
+				WritePipelineBindings(writer, draw->pipelineBindings_);
+				writer.Write(*draw->drawState_);
+			}
+			break;
+			case CommandType::DRAW_INDIRECT:
+			{
+				const auto* draw = static_cast<const CommandDrawIndirect*>(command);
+				WritePipelineBindings(writer, draw->pipelineBindings_);
+				writer.Write(*draw->drawState_);
+			}
+			break;
+			case CommandType::DISPATCH:
+				WritePipelineBindings(writer, static_cast<const CommandDispatch*>(command)->pipelineBindings_);
+				break;
+			case CommandType::DISPATCH_INDIRECT:
+				WritePipelineBindings(writer, static_cast<const CommandDispatchIndirect*>(command)->pipelineBindings_);
+				break;
+			case CommandType::UPDATE_BUFFER:
+			{
+				const auto* update = static_cast<const CommandUpdateBuffer*>(command);
+				writer.WriteBytes(update->data_, update->size_);
+			}
+			break;
+			case CommandType::UPDATE_TEXTURE_SUBRESOURCE:
+			{
+				const auto* update = static_cast<const CommandUpdateTextureSubResource*>(command);
+				const auto* desc = textures_.find(update->texture_.GetCombined());
+				DBG_ASSERT(desc);
+				const i64 size = desc ? GetSubResourceSize(*desc, update->subResourceIdx_, update->data_) : 0;
+				writer.Write(size);
+				writer.WriteBytes(update->data_.data_, size);
+			}
+			break;
+			case CommandType::BEGIN_EVENT:
+				writer.WriteString(static_cast<const CommandBeginEvent*>(command)->text_);
+				break;
+			default:
+				break;
+			}
+		}
+
+		WriteRecord(CaptureRecordType::COMPILE_COMMAND_LIST, writer.data_);
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType)
+	{
+		auto retVal = backend_->SubmitCommandLists(handles, queueType);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(queueType);
+			writer.WriteArray(handles);
+			WriteRecord(CaptureRecordType::SUBMIT_COMMAND_LISTS, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::SignalFence(CommandQueueType queueType, Handle handle, i64 value)
+	{
+		auto retVal = backend_->SignalFence(queueType, handle, value);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(queueType);
+			writer.Write(handle);
+			writer.Write(value);
+			WriteRecord(CaptureRecordType::SIGNAL_FENCE, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::WaitOnFence(CommandQueueType queueType, Handle handle, i64 value)
+	{
+		auto retVal = backend_->WaitOnFence(queueType, handle, value);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(queueType);
+			writer.Write(handle);
+			writer.Write(value);
+			WriteRecord(CaptureRecordType::WAIT_ON_FENCE, writer.data_);
+		}
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::PresentSwapChain(Handle handle)
+	{
+		auto retVal = backend_->PresentSwapChain(handle);
+		if(retVal == ErrorCode::OK)
+			WriteRecord(CaptureRecordType::PRESENT_SWAP_CHAIN, &handle, sizeof(handle));
+		return retVal;
+	}
+
+	ErrorCode CaptureBackend::ResizeSwapChain(Handle handle, i32 width, i32 height)
+	{
+		auto retVal = backend_->ResizeSwapChain(handle, width, height);
+		if(retVal == ErrorCode::OK)
+		{
+			CaptureWriter writer;
+			writer.Write(handle);
+			writer.Write(width);
+			writer.Write(height);
+			WriteRecord(CaptureRecordType::RESIZE_SWAP_CHAIN, writer.data_);
+		}
+		return retVal;
+	}
+
+	void CaptureBackend::NextFrame()
+	{
+		backend_->NextFrame();
+		WriteRecord(CaptureRecordType::NEXT_FRAME, nullptr, 0);
+	}
+
+	namespace
+	{
+		/**
+		 * Replays a capture into a backend.
+		 * Captured handles are remapped to handles allocated during replay, so the capture
+		 * is independent of handle allocation order.
+		 */
+		class CaptureReplayer
+		{
+		public:
+			CaptureReplayer(IBackend& backend, const ReplayParams& params, ReplayStats& stats)
+			    : backend_(backend)
+			    , params_(params)
+			    , stats_(stats)
+			{
+			}
+
+			~CaptureReplayer() { DestroyAll(); }
+
+			bool Replay(const Core::Vector<u8>& data)
+			{
+				CaptureReader reader(data.data(), data.size());
+
+				CaptureHeader header;
+				if(!reader.Read(header) || header.magic_ != CaptureHeader::MAGIC ||
+				    header.majorVersion_ != CaptureHeader::MAJOR_VERSION)
+				{
+					Core::Log("ReplayCapture: Invalid capture header.\n");
+					return false;
+				}
+
+				scratchCommandList_ = handles_.Alloc<Handle>(ResourceType::COMMAND_LIST);
+				Check(backend_.CreateCommandList(scratchCommandList_, "ReplayCapture scratch"));
+
+				while(!reader.IsEnd())
+				{
+					CaptureRecordHeader recordHeader;
+					if(!reader.Read(recordHeader))
+						break;
+					const u8* payload = static_cast<const u8*>(reader.ReadBytes(recordHeader.size_));
+					if(payload == nullptr)
+						break;
+
+					CaptureReader recordReader(payload, recordHeader.size_);
+					if(!ReplayRecord(recordHeader.type_, recordReader) || !recordReader.IsValid())
+					{
+						Core::Log("ReplayCapture: Failed to read record of type %u.\n", (u32)recordHeader.type_);
+						return false;
+					}
+				}
+
+				DestroyAll();
+				return reader.IsValid();
+			}
+
+		private:
+			void Check(ErrorCode errorCode)
+			{
+				if(errorCode != ErrorCode::OK)
+					stats_.numErrors_++;
+			}
+
+			Handle Remap(Handle handle) const
+			{
+				if(!handle)
+					return Handle();
+				if(const auto* found = handleMap_.find(handle.GetCombined()))
+					return *found;
+				return Handle();
+			}
+
+			Handle AllocHandle(Handle capturedHandle)
+			{
+				Handle handle = handles_.Alloc<Handle>(capturedHandle.GetType());
+				handleMap_[capturedHandle.GetCombined()] = handle;
+				return handle;
+			}
+
+			void Remap(PipelineBinding& pb) const { pb.pbs_ = Remap(pb.pbs_); }
+
+			template<typename TYPE>
+			void RemapViews(Core::Vector<TYPE>& views) const
+			{
+				for(auto& view : views)
+					view.resource_ = Remap(view.resource_);
+			}
+
+			void DestroyAll()
+			{
+				// Destroy dependent resources first.
+				for(i32 type = (i32)ResourceType::MAX - 1; type >= 0; --type)
+				{
+					for(auto it : handleMap_)
+					{
+						if(it.value.GetType() == (ResourceType)type)
+						{
+							Core::Timer timer;
+							timer.Mark();
+							backend_.DestroyResource(it.value);
+							stats_.resourceTime_ += timer.GetTime();
+							handles_.Free(it.value);
+						}
+					}
+				}
+				handleMap_.clear();
+
+				if(scratchCommandList_)
+				{
+					backend_.DestroyResource(scratchCommandList_);
+					handles_.Free(scratchCommandList_);
+					scratchCommandList_ = Handle();
+				}
+			}
+
+			bool ReplayRecord(CaptureRecordType type, CaptureReader& reader)
+			{
+				Core::Timer timer;
+				Handle handle;
+				Core::Vector<char> debugName;
+
+				switch(type)
+				{
+				case CaptureRecordType::CREATE_SWAP_CHAIN:
+				{
+					SwapChainDesc desc;
+					if(!reader.Read(handle) || !reader.Read(desc) || !reader.ReadString(debugName))
+						return false;
+					desc.outputWindow_ = params_.outputWindow_;
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateSwapChain(handle, desc, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_BUFFER:
+				{
+					BufferDesc desc;
+					bool hasData = false;
+					if(!reader.Read(handle) || !reader.Read(desc) || !reader.Read(hasData))
+						return false;
+					const void* initialData = hasData ? reader.ReadBytes(desc.size_) : nullptr;
+					if(!reader.ReadString(debugName))
+						return false;
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateBuffer(handle, desc, initialData, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_TEXTURE:
+				{
+					TextureDesc desc;
+					bool hasData = false;
+					if(!reader.Read(handle) || !reader.Read(desc) || !reader.Read(hasData))
+						return false;
+					Core::Vector<TextureSubResourceData> initialData;
+					if(hasData)
+					{
+						initialData.resize(GetNumSubResources(desc));
+						for(i32 idx = 0; idx < initialData.size(); ++idx)
+						{
+							auto& subRsc = initialData[idx];
+							if(!reader.Read(subRsc.rowPitch_) || !reader.Read(subRsc.slicePitch_))
+								return false;
+							subRsc.data_ = reader.ReadBytes(GetSubResourceSize(desc, idx, subRsc));
+						}
+					}
+					if(!reader.ReadString(debugName))
+						return false;
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateTexture(
+					    handle, desc, hasData ? initialData.data() : nullptr, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_SHADER:
+				{
+					ShaderDesc desc;
+					if(!reader.Read(handle) || !reader.Read(desc.type_) || !reader.Read(desc.dataSize_))
+						return false;
+					desc.data_ = reader.ReadBytes(desc.dataSize_);
+					if(!reader.ReadString(debugName))
+						return false;
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateShader(handle, desc, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_GRAPHICS_PIPELINE_STATE:
+				{
+					GraphicsPipelineStateDesc desc;
+					if(!reader.Read(handle) || !reader.Read(desc) || !reader.ReadString(debugName))
+						return false;
+					for(auto& shader : desc.shaders_)
+						shader = Remap(shader);
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateGraphicsPipelineState(handle, desc, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_COMPUTE_PIPELINE_STATE:
+				{
+					ComputePipelineStateDesc desc;
+					if(!reader.Read(handle) || !reader.Read(desc) || !reader.ReadString(debugName))
+						return false;
+					desc.shader_ = Remap(desc.shader_);
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateComputePipelineState(handle, desc, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_PIPELINE_BINDING_SET:
+				case CaptureRecordType::ALLOC_TEMPORARY_PIPELINE_BINDING_SET:
+				{
+					PipelineBindingSetDesc desc;
+					if(!reader.Read(handle) || !reader.Read(desc))
+						return false;
+					const bool temporary = type == CaptureRecordType::ALLOC_TEMPORARY_PIPELINE_BINDING_SET;
+					if(!temporary && !reader.ReadString(debugName))
+						return false;
+					handle = AllocHandle(handle);
+					timer.Mark();
+					if(temporary)
+						Check(backend_.AllocTemporaryPipelineBindingSet(handle, desc));
+					else
+						Check(backend_.CreatePipelineBindingSet(handle, desc, debugName.data()));
+					stats_.bindingTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_DRAW_BINDING_SET:
+				{
+					DrawBindingSetDesc desc;
+					if(!reader.Read(handle) || !reader.Read(desc) || !reader.ReadString(debugName))
+						return false;
+					for(auto& vb : desc.vbs_)
+						vb.resource_ = Remap(vb.resource_);
+					desc.ib_.resource_ = Remap(desc.ib_.resource_);
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateDrawBindingSet(handle, desc, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_FRAME_BINDING_SET:
+				{
+					FrameBindingSetDesc desc;
+					if(!reader.Read(handle) || !reader.Read(desc) || !reader.ReadString(debugName))
+						return false;
+					for(auto& rtv : desc.rtvs_)
+						rtv.resource_ = Remap(rtv.resource_);
+					desc.dsv_.resource_ = Remap(desc.dsv_.resource_);
+					handle = AllocHandle(handle);
+					timer.Mark();
+					Check(backend_.CreateFrameBindingSet(handle, desc, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::CREATE_COMMAND_LIST:
+				case CaptureRecordType::CREATE_FENCE:
+				{
+					if(!reader.Read(handle) || !reader.ReadString(debugName))
+						return false;
+					handle = AllocHandle(handle);
+					timer.Mark();
+					if(type == CaptureRecordType::CREATE_COMMAND_LIST)
+						Check(backend_.CreateCommandList(handle, debugName.data()));
+					else
+						Check(backend_.CreateFence(handle, debugName.data()));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::DESTROY_RESOURCE:
+				{
+					Handle capturedHandle;
+					if(!reader.Read(capturedHandle))
+						return false;
+					handle = Remap(capturedHandle);
+					if(handle)
+					{
+						timer.Mark();
+						Check(backend_.DestroyResource(handle));
+						stats_.resourceTime_ += timer.GetTime();
+						handles_.Free(handle);
+						handleMap_.erase(capturedHandle.GetCombined());
+					}
+				}
+				break;
+
+				case CaptureRecordType::UPDATE_CBVS:
+					return ReplayUpdateBindings<BindingCBV>(reader);
+				case CaptureRecordType::UPDATE_SRVS:
+					return ReplayUpdateBindings<BindingSRV>(reader);
+				case CaptureRecordType::UPDATE_UAVS:
+					return ReplayUpdateBindings<BindingUAV>(reader);
+				case CaptureRecordType::UPDATE_SAMPLERS:
+					return ReplayUpdateBindings<SamplerState>(reader);
+
+				case CaptureRecordType::COPY_PIPELINE_BINDINGS:
+				{
+					Core::Vector<PipelineBinding> dst;
+					Core::Vector<PipelineBinding> src;
+					if(!reader.ReadArray(dst) || !reader.ReadArray(src))
+						return false;
+					for(auto& pb : dst)
+						Remap(pb);
+					for(auto& pb : src)
+						Remap(pb);
+					timer.Mark();
+					Check(backend_.CopyPipelineBindings(dst, src));
+					stats_.bindingTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::COMPILE_COMMAND_LIST:
+					return ReplayCompile(reader);
+
+				case CaptureRecordType::SUBMIT_COMMAND_LISTS:
+				{
+					CommandQueueType queueType;
+					Core::Vector<Handle> commandLists;
+					if(!reader.Read(queueType) || !reader.ReadArray(commandLists))
+						return false;
+					for(auto& commandList : commandLists)
+						commandList = Remap(commandList);
+					timer.Mark();
+					Check(backend_.SubmitCommandLists(commandLists, queueType));
+					stats_.submitTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::SIGNAL_FENCE:
+				case CaptureRecordType::WAIT_ON_FENCE:
+				{
+					CommandQueueType queueType;
+					i64 value = 0;
+					if(!reader.Read(queueType) || !reader.Read(handle) || !reader.Read(value))
+						return false;
+					handle = Remap(handle);
+					timer.Mark();
+					if(type == CaptureRecordType::SIGNAL_FENCE)
+						Check(backend_.SignalFence(queueType, handle, value));
+					else
+						Check(backend_.WaitOnFence(queueType, handle, value));
+					stats_.submitTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::PRESENT_SWAP_CHAIN:
+				{
+					if(!reader.Read(handle))
+						return false;
+					handle = Remap(handle);
+					timer.Mark();
+					Check(backend_.PresentSwapChain(handle));
+					stats_.submitTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::RESIZE_SWAP_CHAIN:
+				{
+					i32 width = 0;
+					i32 height = 0;
+					if(!reader.Read(handle) || !reader.Read(width) || !reader.Read(height))
+						return false;
+					handle = Remap(handle);
+					timer.Mark();
+					Check(backend_.ResizeSwapChain(handle, width, height));
+					stats_.resourceTime_ += timer.GetTime();
+				}
+				break;
+
+				case CaptureRecordType::NEXT_FRAME:
+					timer.Mark();
+					backend_.NextFrame();
+					stats_.submitTime_ += timer.GetTime();
+					stats_.numFrames_++;
+					break;
+
+				default:
+					return false;
+				}
+
+				return true;
+			}
+
+			template<typename TYPE>
+			bool ReplayUpdateBindings(CaptureReader& reader)
+			{
+				Handle handle;
+				i32 base = 0;
+				Core::Vector<TYPE> descs;
+				if(!reader.Read(handle) || !reader.Read(base) || !reader.ReadArray(descs))
+					return false;
+				RemapBindings(descs);
+
+				Core::Timer timer;
+				timer.Mark();
+				Check(backend_.UpdatePipelineBindings(Remap(handle), base, Core::ArrayView<const TYPE>(descs)));
+				stats_.bindingTime_ += timer.GetTime();
+				return true;
+			}
+
+			void RemapBindings(Core::Vector<BindingCBV>& descs) const
+			{
+				for(auto& desc : descs)
+					desc.resource_ = Remap(desc.resource_);
+			}
+			void RemapBindings(Core::Vector<BindingSRV>& descs) const { RemapViews(descs); }
+			void RemapBindings(Core::Vector<BindingUAV>& descs) const { RemapViews(descs); }
+			void RemapBindings(Core::Vector<SamplerState>& descs) const {}
+
+			/**
+			 * Read a command from @a reader, and append it to @a outCommandList if @a include is true.
+			 */
+			bool ReadCommand(CaptureReader& reader, CommandList& outCommandList, bool include, CommandType& outType)
+			{
+				if(!reader.Read(outType))
+					return false;
+
+				Core::Vector<PipelineBinding> pipelineBindings;
+				auto ReadPipelineBindings = [&]() {
+					if(!reader.ReadArray(pipelineBindings))
+						return false;
+					for(auto& pb : pipelineBindings)
+						Remap(pb);
+					return true;
+				};
+
+				switch(outType)
+				{
+				case CommandType::DRAW:
+				{
+					CommandDraw command;
+					DrawState drawState;
+					if(!reader.Read(command) || !ReadPipelineBindings() || !reader.Read(drawState))
+						return false;
+					if(include)
+						outCommandList.Draw(Remap(command.pipelineState_), pipelineBindings,
+						    Remap(command.drawBinding_), Remap(command.frameBinding_), drawState, command.primitive_,
+						    command.indexOffset_, command.vertexOffset_, command.noofVertices_,
+						    command.firstInstance_, command.noofInstances_);
+				}
+				break;
+				case CommandType::DRAW_INDIRECT:
+				{
+					CommandDrawIndirect command;
+					DrawState drawState;
+					if(!reader.Read(command) || !ReadPipelineBindings() || !reader.Read(drawState))
+						return false;
+					if(include)
+						outCommandList.DrawIndirect(Remap(command.pipelineState_), pipelineBindings,
+						    Remap(command.drawBinding_), Remap(command.frameBinding_), drawState, command.primitive_,
+						    Remap(command.indirectBuffer_), command.argByteOffset_, Remap(command.countBuffer_),
+						    command.countByteOffset_, command.maxCommands_, command.drawIds_);
+				}
+				break;
+				case CommandType::DISPATCH:
+				{
+					CommandDispatch command;
+					if(!reader.Read(command) || !ReadPipelineBindings())
+						return false;
+					if(include)
+						outCommandList.Dispatch(Remap(command.pipelineState_), pipelineBindings, command.xGroups_,
+						    command.yGroups_, command.zGroups_);
+				}
+				break;
+				case CommandType::DISPATCH_INDIRECT:
+				{
+					CommandDispatchIndirect command;
+					if(!reader.Read(command) || !ReadPipelineBindings())
+						return false;
+					if(include)
+						outCommandList.DispatchIndirect(Remap(command.pipelineState_), pipelineBindings,
+						    Remap(command.indirectBuffer_), command.argByteOffset_, Remap(command.countBuffer_),
+						    command.countByteOffset_, command.maxCommands_);
+				}
+				break;
+				case CommandType::CLEAR_RTV:
+				{
+					CommandClearRTV command;
+					if(!reader.Read(command))
+						return false;
+					if(include)
+						outCommandList.ClearRTV(Remap(command.frameBinding_), command.rtvIdx_, command.color_);
+				}
+				break;
+				case CommandType::CLEAR_DSV:
+				{
+					CommandClearDSV command;
+					if(!reader.Read(command))
+						return false;
+					if(include)
+						outCommandList.ClearDSV(Remap(command.frameBinding_), command.depth_, command.stencil_);
+				}
+				break;
+				case CommandType::CLEAR_UAV:
+				{
+					CommandClearUAV command;
+					if(!reader.Read(command))
+						return false;
+					if(include)
+						outCommandList.ClearUAV(Remap(command.pipelineBinding_), command.uavIdx_, command.u_);
+				}
+				break;
+				case CommandType::UPDATE_BUFFER:
+				{
+					CommandUpdateBuffer command;
+					if(!reader.Read(command))
+						return false;
+					const void* data = reader.ReadBytes(command.size_);
+					if(data == nullptr)
+						return false;
+					if(include)
+						outCommandList.UpdateBuffer(Remap(command.buffer_), command.offset_, command.size_, data);
+				}
+				break;
+				case CommandType::UPDATE_TEXTURE_SUBRESOURCE:
+				{
+					CommandUpdateTextureSubResource command;
+					i64 size = 0;
+					if(!reader.Read(command) || !reader.Read(size))
+						return false;
+					command.data_.data_ = reader.ReadBytes(size);
+					if(command.data_.data_ == nullptr)
+						return false;
+					if(include)
+						outCommandList.UpdateTextureSubResource(
+						    Remap(command.texture_), command.subResourceIdx_, command.data_);
+				}
+				break;
+				case CommandType::COPY_BUFFER:
+				{
+					CommandCopyBuffer command;
+					if(!reader.Read(command))
+						return false;
+					if(include)
+						outCommandList.CopyBuffer(Remap(command.dstBuffer_), command.dstOffset_,
+						    Remap(command.srcBuffer_), command.srcOffset_, command.srcSize_);
+				}
+				break;
+				case CommandType::COPY_TEXTURE_SUBRESOURCE:
+				{
+					CommandCopyTextureSubResource command;
+					if(!reader.Read(command))
+						return false;
+					if(include)
+						outCommandList.CopyTextureSubResource(Remap(command.dstTexture_), command.dstSubResourceIdx_,
+						    command.dstPoint_, Remap(command.srcTexture_), command.srcSubResourceIdx_,
+						    command.srcBox_);
+				}
+				break;
+				case CommandType::BEGIN_EVENT:
+				{
+					CommandBeginEvent command;
+					Core::Vector<char> text;
+					if(!reader.Read(command) || !reader.ReadString(text))
+						return false;
+					// Matching end event is read as its own command, and ends the scoped event.
+					if(include)
+						openEvents_.push_back(
+						    new CommandList::ScopedEvent(outCommandList.Event(command.metaData_, text.data())));
+				}
+				break;
+				case CommandType::END_EVENT:
+				{
+					CommandEndEvent command;
+					if(!reader.Read(command))
+						return false;
+					if(include && openEvents_.size() > 0)
+					{
+						delete openEvents_.back();
+						openEvents_.pop_back();
+					}
+				}
+				break;
+				default:
+					return false;
+				}
+				return true;
+			}
+
+			/**
+			 * Build a command list from a captured one.
+			 * @param filter Only include commands of this type. MAX to include all.
+			 */
+			bool BuildCommandList(
+			    CaptureReader& reader, i32 numCommands, CommandType filter, CommandList& outCommandList)
+			{
+				for(i32 idx = 0; idx < numCommands; ++idx)
+				{
+					CaptureReader peekReader = reader;
+					CommandType type = CommandType::INVALID;
+					if(!peekReader.Read(type))
+						return false;
+
+					// Events are only meaningful in begin/end pairs, so are attributed to BEGIN_EVENT.
+					bool include = filter == CommandType::MAX || type == filter;
+					if(filter == CommandType::BEGIN_EVENT && type == CommandType::END_EVENT)
+						include = true;
+
+					if(!ReadCommand(reader, outCommandList, include, type))
+						return false;
+				}
+
+				// Close any unbalanced events.
+				while(openEvents_.size() > 0)
+				{
+					delete openEvents_.back();
+					openEvents_.pop_back();
+				}
+				return true;
+			}
+
+			bool ReplayCompile(CaptureReader& reader)
+			{
+				Handle handle;
+				CommandQueueType queueType;
+				i32 numCommands = 0;
+				if(!reader.Read(handle) || !reader.Read(queueType) || !reader.Read(numCommands))
+					return false;
+				handle = Remap(handle);
+
+				const CaptureReader commandsReader = reader;
+				const i32 bufferSize = Core::Max(CommandList::DEFAULT_BUFFER_SIZE, reader.GetRemaining() * 2);
+
+				// Full command list.
+				Core::Array<i32, (i32)CommandType::MAX> commandCount = {};
+				{
+					CommandList commandList(bufferSize, handles_);
+					CaptureReader passReader = commandsReader;
+					if(!BuildCommandList(passReader, numCommands, CommandType::MAX, commandList))
+						return false;
+					for(const auto* command : commandList)
+						commandCount[(i32)command->type_]++;
+
+					Core::Timer timer;
+					timer.Mark();
+					Check(backend_.CompileCommandList(handle, commandList, queueType));
+					stats_.compileTime_ += timer.GetTime();
+				}
+
+				// Command list per command type, to attribute cost.
+				for(i32 type = 0; type < (i32)CommandType::MAX; ++type)
+				{
+					stats_.commandCount_[type] += commandCount[type];
+					if(commandCount[type] == 0 || (CommandType)type == CommandType::END_EVENT)
+						continue;
+
+					CommandList commandList(bufferSize, handles_);
+					CaptureReader passReader = commandsReader;
+					if(!BuildCommandList(passReader, numCommands, (CommandType)type, commandList))
+						return false;
+
+					Core::Timer timer;
+					timer.Mark();
+					Check(backend_.CompileCommandList(scratchCommandList_, commandList, queueType));
+					stats_.commandTime_[type] += timer.GetTime();
+				}
+
+				// Skip over commands.
+				CommandList commandList(bufferSize, handles_);
+				return BuildCommandList(reader, numCommands, CommandType::INVALID, commandList);
+			}
+
+			IBackend& backend_;
+			const ReplayParams& params_;
+			ReplayStats& stats_;
+
+			Core::HandleAllocator handles_ = Core::HandleAllocator(ResourceType::MAX);
+			Core::Map<i32, Handle> handleMap_;
+			Handle scratchCommandList_;
+			Core::Vector<CommandList::ScopedEvent*> openEvents_;
+		};
+	}
+
+	bool ReplayCapture(IBackend& backend, const char* path, const ReplayParams& params, ReplayStats& outStats)
+	{
+		DBG_ASSERT(path);
+		DBG_ASSERT(params.numIterations_ > 0);
+
+		Core::Vector<u8> data;
+		{
+			Core::File file(path, Core::FileFlags::READ);
+			if(!file)
+			{
+				Core::Log("ReplayCapture: Unable to open \"%s\".\n", path);
+				return false;
+			}
+			data.resize((i32)file.Size());
+			if(file.Read(data.data(), data.size()) != data.size())
+				return false;
+		}
+
+		outStats = ReplayStats();
+		for(i32 iteration = 0; iteration < params.numIterations_; ++iteration)
+		{
+			CaptureReplayer replayer(backend, params, outStats);
+			if(!replayer.Replay(data))
+				return false;
+			outStats.numIterations_++;
+		}
+		return true;
+	}
+
+	void LogReplayStats(const ReplayStats& stats)
+	{
+		const f64 iterations = (f64)Core::Max(1, stats.numIterations_);
+		const f64 frames = (f64)Core::Max(1, stats.numFrames_);
+
+		Core::Log("Replayed %i iteration(s), %i frame(s), %i error(s).\n", stats.numIterations_, stats.numFrames_,
+		    stats.numErrors_);
+		Core::Log("%-28s %12s %12s\n", "Stage", "ms/iter", "ms/frame");
+		Core::Log("%-28s %12.3f %12.3f\n", "Resources", stats.resourceTime_ * 1000.0 / iterations,
+		    stats.resourceTime_ * 1000.0 / frames);
+		Core::Log("%-28s %12.3f %12.3f\n", "Bindings", stats.bindingTime_ * 1000.0 / iterations,
+		    stats.bindingTime_ * 1000.0 / frames);
+		Core::Log("%-28s %12.3f %12.3f\n", "Compile", stats.compileTime_ * 1000.0 / iterations,
+		    stats.compileTime_ * 1000.0 / frames);
+		Core::Log("%-28s %12.3f %12.3f\n", "Submit", stats.submitTime_ * 1000.0 / iterations,
+		    stats.submitTime_ * 1000.0 / frames);
+
+		Core::Log("%-28s %12s %12s %12s\n", "Command", "count/iter", "ms/iter", "us/command");
+		for(i32 type = 0; type < (i32)CommandType::MAX; ++type)
+		{
+			const i32 count = stats.commandCount_[type];
+			if(count == 0)
+				continue;
+			const f64 time = stats.commandTime_[type];
+			Core::Log("%-28s %12.0f %12.3f %12.3f\n", Core::EnumToString((CommandType)type), count / iterations,
+			    time * 1000.0 / iterations, time * 1000000.0 / count);
+		}
+	}
+} // namespace GPU
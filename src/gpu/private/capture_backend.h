@@ -0,0 +1,142 @@
+#pragma once
+
+#include "gpu/backend.h"
+#include "core/concurrency.h"
+#include "core/file.h"
+#include "core/map.h"
+#include "core/vector.h"
+
+namespace GPU
+{
+	/**
+	 * Capture file header.
+	 */
+	struct CaptureHeader
+	{
+		/// Magic number.
+		static const u32 MAGIC = 0x50414347;
+		/// Major version signifies a breaking change to the binary format.
+		static const i16 MAJOR_VERSION = 0x0004;
+		/// Minor version signifies non-breaking change to binary format.
+		static const i16 MINOR_VERSION = 0x0000;
+
+		u32 magic_ = MAGIC;
+		i16 majorVersion_ = MAJOR_VERSION;
+		i16 minorVersion_ = MINOR_VERSION;
+	};
+
+	/**
+	 * Record types within a capture.
+	 * Each record is a CaptureRecordHeader followed by its payload.
+	 */
+	enum class CaptureRecordType : u32
+	{
+		INVALID = 0,
+		CREATE_SWAP_CHAIN,
+		CREATE_BUFFER,
+		CREATE_TEXTURE,
+		CREATE_SHADER,
+		CREATE_GRAPHICS_PIPELINE_STATE,
+		CREATE_COMPUTE_PIPELINE_STATE,
+		CREATE_PIPELINE_BINDING_SET,
+		CREATE_DRAW_BINDING_SET,
+		CREATE_FRAME_BINDING_SET,
+		CREATE_COMMAND_LIST,
+		CREATE_FENCE,
+		DESTROY_RESOURCE,
+		ALLOC_TEMPORARY_PIPELINE_BINDING_SET,
+		UPDATE_CBVS,
+		UPDATE_SRVS,
+		UPDATE_UAVS,
+		UPDATE_SAMPLERS,
+		COPY_PIPELINE_BINDINGS,
+		COMPILE_COMMAND_LIST,
+		SUBMIT_COMMAND_LISTS,
+		SIGNAL_FENCE,
+		WAIT_ON_FENCE,
+		PRESENT_SWAP_CHAIN,
+		RESIZE_SWAP_CHAIN,
+		NEXT_FRAME,
+	};
+
+	struct CaptureRecordHeader
+	{
+		CaptureRecordType type_ = CaptureRecordType::INVALID;
+		/// Size of payload in bytes.
+		i32 size_ = 0;
+	};
+
+	/**
+	 * Backend which forwards all calls to another backend, and writes them to a capture file.
+	 * Records are buffered and written under a lock, so calls may come from multiple threads.
+	 */
+	class CaptureBackend : public IBackend
+	{
+	public:
+		CaptureBackend(IBackend* backend, const char* path);
+		~CaptureBackend();
+
+		i32 EnumerateAdapters(AdapterInfo* outAdapters, i32 maxAdapters) override;
+		bool IsInitialized() const override;
+		ErrorCode Initialize(i32 adapterIdx) override;
+
+		ErrorCode CreateSwapChain(Handle handle, const SwapChainDesc& desc, const char* debugName) override;
+		ErrorCode CreateBuffer(
+		    Handle handle, const BufferDesc& desc, const void* initialData, const char* debugName) override;
+		ErrorCode CreateTexture(Handle handle, const TextureDesc& desc, const TextureSubResourceData* initialData,
+		    const char* debugName) override;
+		ErrorCode CreateShader(Handle handle, const ShaderDesc& desc, const char* debugName) override;
+		ErrorCode CreateGraphicsPipelineState(
+		    Handle handle, const GraphicsPipelineStateDesc& desc, const char* debugName) override;
+		ErrorCode CreateComputePipelineState(
+		    Handle handle, const ComputePipelineStateDesc& desc, const char* debugName) override;
+		ErrorCode CreatePipelineBindingSet(
+		    Handle handle, const PipelineBindingSetDesc& desc, const char* debugName) override;
+		ErrorCode CreateDrawBindingSet(Handle handle, const DrawBindingSetDesc& desc, const char* debugName) override;
+		ErrorCode CreateFrameBindingSet(Handle handle, const FrameBindingSetDesc& desc, const char* debugName) override;
+		ErrorCode CreateCommandList(Handle handle, const char* debugName) override;
+		ErrorCode CreateFence(Handle handle, const char* debugName) override;
+		ErrorCode DestroyResource(Handle handle) override;
+
+		ErrorCode CreateUploadRing(i64 size, void** outAddress) override;
+
+		ErrorCode AllocTemporaryPipelineBindingSet(Handle handle, const PipelineBindingSetDesc& desc) override;
+		ErrorCode UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingCBV> descs) override;
+		ErrorCode UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingSRV> descs) override;
+		ErrorCode UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingUAV> descs) override;
+		ErrorCode UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const SamplerState> descs) override;
+		ErrorCode CopyPipelineBindings(
+		    Core::ArrayView<const PipelineBinding> dst, Core::ArrayView<const PipelineBinding> src) override;
+		ErrorCode ValidatePipelineBindings(Core::ArrayView<const PipelineBinding> pb) override;
+
+		ErrorCode CompileCommandList(
+		    Handle handle, const CommandList& commandList, CommandQueueType queueType) override;
+		ErrorCode SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType) override;
+
+		ErrorCode SignalFence(CommandQueueType queueType, Handle handle, i64 value) override;
+		ErrorCode WaitOnFence(CommandQueueType queueType, Handle handle, i64 value) override;
+
+		ErrorCode PresentSwapChain(Handle handle) override;
+		ErrorCode ResizeSwapChain(Handle handle, i32 width, i32 height) override;
+
+		void NextFrame() override;
+
+		/**
+		 * @return Backend being captured.
+		 */
+		IBackend* GetBackend() const { return backend_; }
+
+	private:
+		void WriteRecord(CaptureRecordType type, const Core::Vector<u8>& payload);
+		void WriteRecord(CaptureRecordType type, const void* payload, i32 size);
+
+		IBackend* backend_ = nullptr;
+
+		Core::Mutex mutex_;
+		Core::File file_;
+
+		/// Texture descs of live textures, required to size subresource data.
+		Core::RWLock texturesLock_;
+		Core::Map<i32, TextureDesc> textures_;
+	};
+} // namespace GPU
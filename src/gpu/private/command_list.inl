@@ -8,13 +8,17 @@
 
 namespace GPU
 {
-	INLINE void* CommandList::Alloc(i32 bytes)
+	INLINE void* CommandList::Alloc(i32 bytes, i32 align)
 	{
-		const i32 requiredMinSize = Core::PotRoundUp(allocatedBytes_ + bytes, sizeof(size_t));
+		// Align the address rather than the offset, command data is only byte aligned.
+		const uintptr_t base = (uintptr_t)commandData_.data();
+		align = Core::Max(align, (i32)sizeof(size_t));
+		const i32 offset = (i32)(Core::PotRoundUp(base + allocatedBytes_, align) - base);
+		const i32 requiredMinSize = Core::PotRoundUp(offset + bytes, sizeof(size_t));
 		if(commandData_.size() < requiredMinSize)
 			return nullptr; // TODO: Look at adding resizing later.
-		void* data = &commandData_[allocatedBytes_];
-		allocatedBytes_ += Core::PotRoundUp(bytes, sizeof(size_t));
+		void* data = &commandData_[offset];
+		allocatedBytes_ = requiredMinSize;
 		return data;
 	}
 
@@ -83,7 +87,8 @@ namespace GPU
 
 	INLINE CommandDrawIndirect* CommandList::DrawIndirect(Handle ps, Core::ArrayView<PipelineBinding> pb,
 	    Handle drawBinding, Handle frameBinding, const DrawState& drawState, PrimitiveTopology primitive,
-	    Handle indirectBuffer, i32 argByteOffset, Handle countBuffer, i32 countByteOffset, i32 maxCommands)
+	    Handle indirectBuffer, i32 argByteOffset, Handle countBuffer, i32 countByteOffset, i32 maxCommands,
+	    bool drawIds)
 	{
 		DBG_ASSERT(handleAllocator_.IsValid(ps) && ps.GetType() == ResourceType::GRAPHICS_PIPELINE_STATE);
 		DBG_ASSERT(!drawBinding ||
@@ -114,6 +119,7 @@ namespace GPU
 		command->countBuffer_ = countBuffer;
 		command->countByteOffset_ = countByteOffset;
 		command->maxCommands_ = maxCommands;
+		command->drawIds_ = drawIds;
 		if(cachedDrawState_ && drawState == *cachedDrawState_)
 		{
 			command->drawState_ = cachedDrawState_;
@@ -275,6 +281,17 @@ namespace GPU
 		return command;
 	}
 
+	INLINE CommandUpdateBuffer* CommandList::UpdateBuffer(Handle buffer, i32 offset, const UploadAllocation& upload)
+	{
+		DBG_ASSERT(upload);
+		DBG_ASSERT(upload.offset_ >= 0);
+
+		auto* command = UpdateBuffer(buffer, offset, upload.size_, upload.address_);
+		if(command)
+			command->uploadOffset_ = upload.offset_;
+		return command;
+	}
+
 	INLINE CommandUpdateTextureSubResource* CommandList::UpdateTextureSubResource(
 	    Handle texture, i32 subResourceIdx, const TextureSubResourceData& data)
 	{
@@ -294,6 +311,23 @@ namespace GPU
 		return command;
 	}
 
+	INLINE CommandUpdateTextureSubResource* CommandList::UpdateTextureSubResource(
+	    Handle texture, i32 subResourceIdx, const UploadAllocation& upload, i32 rowPitch, i32 slicePitch)
+	{
+		DBG_ASSERT(upload);
+		DBG_ASSERT(upload.offset_ >= 0);
+		DBG_ASSERT((upload.offset_ % UPLOAD_TEXTURE_DATA_ALIGNMENT) == 0);
+
+		TextureSubResourceData data;
+		data.data_ = upload.address_;
+		data.rowPitch_ = rowPitch;
+		data.slicePitch_ = slicePitch;
+		auto* command = UpdateTextureSubResource(texture, subResourceIdx, data);
+		if(command)
+			command->uploadOffset_ = upload.offset_;
+		return command;
+	}
+
 	INLINE CommandCopyBuffer* CommandList::CopyBuffer(
 	    Handle dstBuffer, i32 dstOffset, Handle srcBuffer, i32 srcOffset, i32 srcSize)
 	{
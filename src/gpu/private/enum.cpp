@@ -335,6 +335,35 @@ case GPU::ShaderType::##ENUM_VALUE : return #ENUM_VALUE;
 			CASE_STRING(CS)
 		}
 
+#undef CASE_STRING
+		return nullptr;
+	}
+
+	const char* EnumToString(GPU::CommandType val)
+	{
+#define CASE_STRING(ENUM_VALUE)                                                                                        \
+	\
+case GPU::CommandType::##ENUM_VALUE : return #ENUM_VALUE;
+
+		switch(val)
+		{
+			CASE_STRING(INVALID)
+			CASE_STRING(DRAW)
+			CASE_STRING(DRAW_INDIRECT)
+			CASE_STRING(DISPATCH)
+			CASE_STRING(DISPATCH_INDIRECT)
+			CASE_STRING(CLEAR_RTV)
+			CASE_STRING(CLEAR_DSV)
+			CASE_STRING(CLEAR_UAV)
+			CASE_STRING(UPDATE_BUFFER)
+			CASE_STRING(UPDATE_TEXTURE_SUBRESOURCE)
+			CASE_STRING(COPY_BUFFER)
+			CASE_STRING(COPY_TEXTURE_SUBRESOURCE)
+			CASE_STRING(BEGIN_EVENT)
+			CASE_STRING(END_EVENT)
+			CASE_STRING(MAX)
+		}
+
 #undef CASE_STRING
 		return nullptr;
 	}
@@ -3,6 +3,9 @@
 #include "gpu/resources.h"
 
 #include "gpu/backend.h"
+#include "gpu/command_list.h"
+#include "gpu/private/capture_backend.h"
+#include "gpu/private/upload_ring.h"
 
 #include "core/array.h"
 #include "core/concurrency.h"
@@ -205,17 +208,35 @@ namespace GPU
 
 		BackendPlugin plugin_;
 		IBackend* backend_ = nullptr;
+		CaptureBackend* captureBackend_ = nullptr;
 
-		Core::Mutex mutex_;
 		Core::HandleAllocator handles_ = Core::HandleAllocator(ResourceType::MAX);
 
-		Core::Array<Core::Vector<Handle>, MAX_GPU_FRAMES> deferredDeletions_ = {};
-		i64 frameIdx_ = 0;
+		/**
+		 * Deferred deletions. One lock-free list per frame, linked through the handles being deleted,
+		 * as a handle can only be pending deletion once.
+		 * Heads and links are a slot (see GetDeletionSlot) + 1, or 0 for the end of the list.
+		 */
+		Core::Array<volatile i32, MAX_GPU_FRAMES> deferredDeletions_ = {};
+		Core::Vector<Handle> deletionHandles_;
+		Core::Vector<i32> deletionNext_;
+		volatile i64 frameIdx_ = 0;
+
+		/// Commands compiled this frame, and last frame.
+		volatile i32 numCommands_ = 0;
+		i32 numFrameCommands_ = 0;
+
+		i64 uploadRingSize_ = 0;
+		UploadRing* uploadRing_ = nullptr;
 
 		ManagerImpl(const SetupParams& setupParams)
 		    : deviceWindow_(setupParams.deviceWindow_)
 		    , debugFlags_(setupParams.debugFlags_)
+		    , uploadRingSize_(setupParams.uploadRingSize_)
 		{
+			deletionHandles_.resize((i32)ResourceType::MAX * Handle::MAX_INDEX);
+			deletionNext_.resize((i32)ResourceType::MAX * Handle::MAX_INDEX);
+
 			// Create matching backend.
 			Core::Vector<BackendPlugin> plugins;
 
@@ -233,7 +254,9 @@ namespace GPU
 
 			for(const auto& plugin : plugins)
 			{
-				if(setupParams.api_ == nullptr || strcmp(setupParams.api_, plugin.api_) == 0)
+				// Null backend must be explicitly requested.
+				const bool isDefault = setupParams.api_ == nullptr && strcmp(plugin.api_, "NULL") != 0;
+				if(isDefault || (setupParams.api_ && strcmp(setupParams.api_, plugin.api_) == 0))
 				{
 					plugin_ = plugin;
 					backend_ = plugin_.CreateBackend(setupParams);
@@ -251,26 +274,63 @@ namespace GPU
 				}
 				DBG_ASSERT(false);
 			}
+
+			// Wrap backend to capture all calls made to it.
+			if(backend_ && setupParams.capturePath_)
+			{
+				captureBackend_ = new CaptureBackend(backend_, setupParams.capturePath_);
+				backend_ = captureBackend_;
+			}
+		}
+
+		~ManagerImpl()
+		{
+			delete uploadRing_;
+			if(captureBackend_)
+			{
+				backend_ = captureBackend_->GetBackend();
+				delete captureBackend_;
+			}
+			plugin_.DestroyBackend(backend_);
 		}
 
-		~ManagerImpl() { plugin_.DestroyBackend(backend_); }
+		Handle AllocHandle(ResourceType type) { return handles_.Alloc<Handle>(type); }
 
-		Handle AllocHandle(ResourceType type)
+		static i32 GetDeletionSlot(Handle handle)
 		{
-			Core::ScopedMutex lock(mutex_);
-			return handles_.Alloc<Handle>(type);
+			return (i32)handle.GetType() * Handle::MAX_INDEX + handle.GetIndex();
+		}
+
+		void DeferDeletion(Handle handle)
+		{
+			const i32 slot = GetDeletionSlot(handle);
+			deletionHandles_[slot] = handle;
+
+			volatile i32& head = deferredDeletions_[frameIdx_ % deferredDeletions_.size()];
+			i32 oldHead = head;
+			for(;;)
+			{
+				deletionNext_[slot] = oldHead;
+				const i32 prevHead = Core::AtomicCmpExchg(&head, slot + 1, oldHead);
+				if(prevHead == oldHead)
+					break;
+				oldHead = prevHead;
+			}
 		}
 
 		void ProcessDeletions()
 		{
-			Core::ScopedMutex lock(mutex_);
-			auto& deletions = deferredDeletions_[frameIdx_ % deferredDeletions_.size()];
-			for(auto handle : deletions)
+			// Take the whole list at once. Anything deferred into it after this waits until it comes around again.
+			volatile i32& head = deferredDeletions_[frameIdx_ % deferredDeletions_.size()];
+			i32 next = Core::AtomicExchg(&head, 0);
+			while(next != 0)
 			{
+				const i32 slot = next - 1;
+				const Handle handle = deletionHandles_[slot];
+				next = deletionNext_[slot];
 				backend_->DestroyResource(handle);
 				handles_.Free(handle);
 			}
-			deletions.clear();
 		}
 
 		bool HandleErrorCode(Handle& handle, ErrorCode errorCode)
@@ -376,7 +436,16 @@ namespace GPU
 		DBG_ASSERT(IsInitialized());
 		DBG_ASSERT(!IsAdapterCreated());
 		DBG_ASSERT(impl_->backend_);
-		return impl_->backend_->Initialize(adapterIdx);
+		ErrorCode retVal = impl_->backend_->Initialize(adapterIdx);
+		if(retVal != ErrorCode::OK)
+			return retVal;
+
+		// Upload ring is optional, allocations fall back to command list memory without it.
+		void* uploadAddress = nullptr;
+		if(impl_->uploadRingSize_ >= UploadRing::SIZE_ALIGNMENT &&
+		    impl_->backend_->CreateUploadRing(impl_->uploadRingSize_, &uploadAddress) == ErrorCode::OK)
+			impl_->uploadRing_ = new UploadRing(uploadAddress, impl_->uploadRingSize_);
+		return ErrorCode::OK;
 	}
 
 	bool Manager::IsAdapterCreated()
@@ -513,9 +582,7 @@ namespace GPU
 		if(handle)
 		{
 			DBG_ASSERT_MSG(impl_->handles_.IsValid(handle), "Attempting to destroy invalid handle.");
-			Core::ScopedMutex lock(impl_->mutex_);
-			auto& deletions = impl_->deferredDeletions_[impl_->frameIdx_ % impl_->deferredDeletions_.size()];
-			deletions.push_back(handle);
+			impl_->DeferDeletion(handle);
 		}
 	}
 
@@ -535,6 +602,24 @@ namespace GPU
 		return handle;
 	}
 
+	UploadAllocation Manager::AllocUpload(i32 size, i32 alignment)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(size > 0);
+		UploadAllocation upload;
+		if(impl_->uploadRing_)
+		{
+			const i64 offset = impl_->uploadRing_->Alloc(size, alignment);
+			if(offset >= 0)
+			{
+				upload.address_ = impl_->uploadRing_->GetAddress(offset);
+				upload.offset_ = offset;
+				upload.size_ = size;
+			}
+		}
+		return upload;
+	}
+
 	bool Manager::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingCBV> descs)
 	{
 		DBG_ASSERT(IsInitialized());
@@ -598,12 +683,17 @@ namespace GPU
 	}
 
 
-	bool Manager::CompileCommandList(Handle handle, const CommandList& commandList)
+	bool Manager::CompileCommandList(Handle handle, const CommandList& commandList, CommandQueueType queueType)
 	{
 		DBG_ASSERT(IsInitialized());
 		DBG_ASSERT(handle.GetType() == ResourceType::COMMAND_LIST);
+		DBG_ASSERT(queueType == CommandQueueType::GRAPHICS || queueType == CommandQueueType::COMPUTE);
+		DBG_ASSERT_MSG(queueType == CommandQueueType::GRAPHICS ||
+		                   !Core::ContainsAnyFlags(commandList.GetType(), CommandQueueType::GRAPHICS),
+		    "Command list contains graphics commands, but is to be executed on a compute queue.");
 		rmt_ScopedCPUSample(GPU_CompileCommandList, RMTSF_None);
-		return impl_->HandleErrorCode(impl_->backend_->CompileCommandList(handle, commandList));
+		Core::AtomicAdd(&impl_->numCommands_, commandList.NumCommands());
+		return impl_->HandleErrorCode(impl_->backend_->CompileCommandList(handle, commandList, queueType));
 	}
 
 	bool Manager::SubmitCommandList(Handle handle)
@@ -611,18 +701,38 @@ namespace GPU
 		DBG_ASSERT(IsInitialized());
 		DBG_ASSERT(handle.GetType() == ResourceType::COMMAND_LIST);
 		rmt_ScopedCPUSample(GPU_SubmitCommandList, RMTSF_None);
-		return impl_->HandleErrorCode(impl_->backend_->SubmitCommandLists(Core::ArrayView<Handle>(&handle, 1)));
+		return impl_->HandleErrorCode(impl_->backend_->SubmitCommandLists(
+		    Core::ArrayView<Handle>(&handle, 1), CommandQueueType::GRAPHICS));
 	}
 
-	bool Manager::SubmitCommandLists(Core::ArrayView<Handle> handles)
+	bool Manager::SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType)
 	{
 		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(queueType == CommandQueueType::GRAPHICS || queueType == CommandQueueType::COMPUTE);
 #if !defined(_RELEASE)
 		for(auto handle : handles)
 			DBG_ASSERT(handle.GetType() == ResourceType::COMMAND_LIST);
 #endif
 		rmt_ScopedCPUSample(GPU_SubmitCommandLists, RMTSF_None);
-		return impl_->HandleErrorCode(impl_->backend_->SubmitCommandLists(handles));
+		return impl_->HandleErrorCode(impl_->backend_->SubmitCommandLists(handles, queueType));
+	}
+
+	bool Manager::SignalFence(CommandQueueType queueType, Handle fence, i64 value)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(queueType == CommandQueueType::GRAPHICS || queueType == CommandQueueType::COMPUTE);
+		DBG_ASSERT(fence.GetType() == ResourceType::FENCE);
+		rmt_ScopedCPUSample(GPU_SignalFence, RMTSF_None);
+		return impl_->HandleErrorCode(impl_->backend_->SignalFence(queueType, fence, value));
+	}
+
+	bool Manager::WaitOnFence(CommandQueueType queueType, Handle fence, i64 value)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(queueType == CommandQueueType::GRAPHICS || queueType == CommandQueueType::COMPUTE);
+		DBG_ASSERT(fence.GetType() == ResourceType::FENCE);
+		rmt_ScopedCPUSample(GPU_WaitOnFence, RMTSF_None);
+		return impl_->HandleErrorCode(impl_->backend_->WaitOnFence(queueType, fence, value));
 	}
 
 	bool Manager::PresentSwapChain(Handle handle)
@@ -646,8 +756,17 @@ namespace GPU
 		DBG_ASSERT(IsInitialized());
 		rmt_ScopedCPUSample(GPU_NextFrame, RMTSF_None);
 		impl_->frameIdx_++;
+		impl_->numFrameCommands_ = Core::AtomicExchg(&impl_->numCommands_, 0);
 		impl_->backend_->NextFrame();
 		impl_->ProcessDeletions();
+		if(impl_->uploadRing_)
+			impl_->uploadRing_->NextFrame();
+	}
+
+	i32 Manager::GetNumFrameCommands()
+	{
+		DBG_ASSERT(IsInitialized());
+		return impl_->numFrameCommands_;
 	}
 
 	bool Manager::IsValidHandle(Handle handle)
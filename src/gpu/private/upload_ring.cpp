@@ -0,0 +1,59 @@
+#include "gpu/private/upload_ring.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/misc.h"
+
+namespace GPU
+{
+	UploadRing::UploadRing(void* baseAddress, i64 size)
+	    : baseAddress_(static_cast<u8*>(baseAddress))
+	    , size_(size - (size % SIZE_ALIGNMENT))
+	{
+		DBG_ASSERT(baseAddress_);
+		DBG_ASSERT(size_ > 0);
+	}
+
+	i64 UploadRing::Alloc(i64 size, i64 alignment)
+	{
+		DBG_ASSERT(size > 0);
+		DBG_ASSERT(alignment > 0 && alignment <= SIZE_ALIGNMENT);
+		DBG_ASSERT(Core::Pot(alignment));
+		if(size > size_)
+			return -1;
+
+		// Ring size is a multiple of alignment, so aligning total bytes also aligns the offset.
+		i64 head = head_;
+		for(;;)
+		{
+			i64 begin = Core::PotRoundUp(head, alignment);
+
+			// Allocations can't straddle the end of the ring, so skip to the start.
+			if(((begin % size_) + size) > size_)
+				begin = ((begin / size_) + 1) * size_;
+
+			// Anything from tail_ onwards may still be in use, unless nothing is.
+			const i64 tail = tail_;
+			const bool isEmpty = head == tail;
+			const i64 end = begin + size;
+			if(!isEmpty && (end - tail) > size_)
+				return -1;
+
+			const i64 oldHead = Core::AtomicCmpExchg(&head_, end, head);
+			if(oldHead == head)
+			{
+				// Nothing before this allocation is in use, so don't count any bytes skipped to wrap around.
+				if(isEmpty)
+					tail_ = begin;
+				return begin % size_;
+			}
+			head = oldHead;
+		}
+	}
+
+	void UploadRing::NextFrame()
+	{
+		frameHeads_[frameIdx_ % MAX_GPU_FRAMES] = head_;
+		frameIdx_++;
+		tail_ = Core::Max(tail_, frameHeads_[frameIdx_ % MAX_GPU_FRAMES]);
+	}
+} // namespace GPU
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "gpu/types.h"
+#include "core/array.h"
+
+namespace GPU
+{
+	/**
+	 * Frame fenced ring allocator for upload memory.
+	 * Allocations are made from persistently mapped memory, and are reclaimed once MAX_GPU_FRAMES
+	 * frames have passed, matching the lifetime of deferred resource destruction.
+	 * Alloc is thread safe, NextFrame must not be called concurrently with it.
+	 */
+	class UploadRing
+	{
+	public:
+		/// Ring size is rounded down to a multiple of this.
+		static const i64 SIZE_ALIGNMENT = 64 * 1024;
+
+		UploadRing(void* baseAddress, i64 size);
+
+		/**
+		 * Allocate from ring.
+		 * @param size Size in bytes.
+		 * @param alignment Power of two alignment, no larger than SIZE_ALIGNMENT.
+		 * @return Offset within ring. -1 if ring is full.
+		 */
+		i64 Alloc(i64 size, i64 alignment);
+
+		/**
+		 * Advance to next frame, reclaiming memory from MAX_GPU_FRAMES frames ago.
+		 */
+		void NextFrame();
+
+		/// @return Address of @a offset.
+		void* GetAddress(i64 offset) const { return baseAddress_ + offset; }
+
+		/// @return Ring size.
+		i64 GetSize() const { return size_; }
+
+		/// @return Bytes allocated that have not been reclaimed.
+		i64 GetUsedBytes() const { return head_ - tail_; }
+
+	private:
+		u8* baseAddress_ = nullptr;
+		i64 size_ = 0;
+
+		/// Total bytes allocated, including any skipped to wrap around.
+		volatile i64 head_ = 0;
+		/// Total bytes reclaimed.
+		volatile i64 tail_ = 0;
+		/// head_ at the end of each frame in flight.
+		Core::Array<i64, MAX_GPU_FRAMES> frameHeads_ = {};
+		i64 frameIdx_ = 0;
+	};
+} // namespace GPU
@@ -102,6 +102,23 @@ namespace GPU
 		i32 slicePitch_ = 0;
 	};
 
+	/**
+	 * Upload allocation.
+	 * Memory in the upload ring that can be written to directly, then copied from by the GPU.
+	 * See Manager::AllocUpload.
+	 */
+	struct GPU_DLL UploadAllocation
+	{
+		/// Address to write data to.
+		void* address_ = nullptr;
+		/// Offset within upload ring.
+		i64 offset_ = -1;
+		/// Size of allocation.
+		i32 size_ = 0;
+
+		explicit operator bool() const { return !!address_; }
+	};
+
 	/**
 	 * Sampler state.
 	 */
@@ -5,6 +5,11 @@
 
 namespace
 {
+	// Same layout as Math::Mat44, gpu doesn't depend on math.
+	struct alignas(16) Matrix
+	{
+		f32 m_[16];
+	};
 }
 
 TEST_CASE("commandlist-tests-alloc")
@@ -21,6 +26,23 @@ TEST_CASE("commandlist-tests-alloc")
 	REQUIRE(commandList.Alloc(sizeof(size_t)) == nullptr);
 }
 
+TEST_CASE("commandlist-tests-alloc-aligned")
+{
+	Core::HandleAllocator handleAllocator = Core::HandleAllocator(GPU::ResourceType::MAX);
+	GPU::CommandList commandList(1024, handleAllocator);
+
+	// Odd sized allocation first, so the next one would only be size_t aligned.
+	for(i32 idx = 0; idx < 8; ++idx)
+	{
+		REQUIRE(commandList.Alloc(idx * 4 + 3) != nullptr);
+		auto* matrix = commandList.Alloc<Matrix>();
+		REQUIRE(matrix != nullptr);
+		REQUIRE(((uintptr_t)matrix % alignof(Matrix)) == 0);
+	}
+
+	REQUIRE(((uintptr_t)commandList.Alloc(1, 64) % 64) == 0);
+}
+
 TEST_CASE("commandlist-tests-commands")
 {
 	Core::HandleAllocator handleAllocator = Core::HandleAllocator(GPU::ResourceType::MAX);
@@ -1,8 +1,13 @@
+#include "gpu/backend.h"
+#include "gpu/capture.h"
 #include "gpu/manager.h"
 #include "gpu/utils.h"
 #include "client/window.h"
 #include "core/array.h"
 #include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/timer.h"
 #include "core/vector.h"
 
 #include "plugin/manager.h"
@@ -1220,4 +1225,482 @@ TEST_CASE("gpu-tests-mt-create-buffers")
 
 	while(locals.sync_ < (locals.total_ * 3))
 		Core::SwitchThread();
-}
\ No newline at end of file
+}
+
+TEST_CASE("gpu-tests-mt-deferred-destroy-benchmark")
+{
+	Plugin::Manager::Scoped pluginManager;
+	GPU::SetupParams setupParams = GetDefaultSetupParams();
+	setupParams.api_ = "NULL";
+	GPU::Manager::Scoped gpuManager(setupParams);
+
+	REQUIRE(GPU::Manager::CreateAdapter(0) == GPU::ErrorCode::OK);
+
+	struct Locals
+	{
+		GPU::Handle* handles_ = nullptr;
+		volatile i32 sync_ = 0;
+		i32 numThreads_ = 8;
+		i32 numResources_ = 4096;
+	};
+
+	Locals locals;
+
+	// Created up front and not timed, as creation goes through the backend.
+	GPU::BufferDesc bufferDesc;
+	bufferDesc.bindFlags_ = GPU::BindFlags::VERTEX_BUFFER;
+	bufferDesc.size_ = 256;
+	Core::Vector<GPU::Handle> handles;
+	handles.reserve(locals.numThreads_ * locals.numResources_);
+	for(i32 idx = 0; idx < locals.numThreads_ * locals.numResources_; ++idx)
+	{
+		handles.push_back(GPU::Manager::CreateBuffer(bufferDesc, nullptr, "benchmark"));
+		REQUIRE(handles.back());
+	}
+	locals.handles_ = handles.data();
+
+	// Queue destruction from many threads at once.
+	Core::Timer timer;
+	timer.Mark();
+	Core::Vector<Core::Thread> threads;
+	for(i32 i = 0; i < locals.numThreads_; ++i)
+	{
+		threads.emplace_back(Core::Thread(
+		    [](void* userData) -> int {
+			    Locals& locals = *reinterpret_cast<Locals*>(userData);
+			    const i32 threadIdx = Core::AtomicInc(&locals.sync_) - 1;
+			    while(locals.sync_ < locals.numThreads_)
+				    Core::SwitchThread();
+
+			    const GPU::Handle* handles = locals.handles_ + threadIdx * locals.numResources_;
+			    for(i32 idx = 0; idx < locals.numResources_; ++idx)
+				    GPU::Manager::DestroyResource(handles[idx]);
+			    return 0;
+			},
+		    &locals));
+	}
+
+	for(auto& thread : threads)
+		thread.Join();
+	const f64 destroyTime = timer.GetTime();
+
+	// Process deferred destruction once frames have completed.
+	timer.Mark();
+	for(i32 frame = 0; frame <= GPU::MAX_GPU_FRAMES; ++frame)
+		GPU::Manager::NextFrame();
+	const f64 nextFrameTime = timer.GetTime();
+
+	const i32 numResources = locals.numThreads_ * locals.numResources_;
+	Core::Log("gpu-tests-mt-deferred-destroy-benchmark: %i resources, %i threads\n", numResources, locals.numThreads_);
+	Core::Log(" - DestroyResource: %f ms (%f us avg)\n", destroyTime * 1000.0,
+	    destroyTime * 1000000.0 / (f64)numResources);
+	Core::Log(" - NextFrame: %f ms (%f us avg)\n", nextFrameTime * 1000.0,
+	    nextFrameTime * 1000000.0 / (f64)numResources);
+
+	i32 numValid = 0;
+	for(auto handle : handles)
+		numValid += GPU::Manager::IsValidHandle(handle) ? 1 : 0;
+	REQUIRE(numValid == 0);
+}
+
+TEST_CASE("gpu-tests-null-backend")
+{
+	auto testName = Catch::getResultCapture().getCurrentTestName();
+	Plugin::Manager::Scoped pluginManager;
+
+	GPU::SetupParams setupParams = GetDefaultSetupParams();
+	setupParams.api_ = "NULL";
+	GPU::Manager::Scoped gpuManager(setupParams);
+
+	i32 numAdapters = GPU::Manager::EnumerateAdapters(nullptr, 0);
+	REQUIRE(numAdapters > 0);
+
+	REQUIRE(GPU::Manager::CreateAdapter(0) == GPU::ErrorCode::OK);
+
+	f32 data[8] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+	GPU::BufferDesc vbDesc;
+	vbDesc.bindFlags_ = GPU::BindFlags::VERTEX_BUFFER;
+	vbDesc.size_ = sizeof(data);
+	GPU::Handle vb0Handle = GPU::Manager::CreateBuffer(vbDesc, data, testName.c_str());
+	GPU::Handle vb1Handle = GPU::Manager::CreateBuffer(vbDesc, nullptr, testName.c_str());
+	REQUIRE(vb0Handle);
+	REQUIRE(vb1Handle);
+
+	GPU::Handle cmdHandle = GPU::Manager::CreateCommandList(testName.c_str());
+	REQUIRE(cmdHandle);
+
+	// Valid command list.
+	{
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.UpdateBuffer(vb0Handle, 0, sizeof(data), data));
+		REQUIRE(cmdList.CopyBuffer(vb1Handle, 0, vb0Handle, 0, sizeof(data)));
+		REQUIRE(GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+		REQUIRE(GPU::Manager::SubmitCommandList(cmdHandle));
+	}
+
+	// Command list compiled for the compute queue can only be submitted to it.
+	{
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.CopyBuffer(vb1Handle, 0, vb0Handle, 0, sizeof(data)));
+		REQUIRE(GPU::Manager::CompileCommandList(cmdHandle, cmdList, GPU::CommandQueueType::COMPUTE));
+		REQUIRE(GPU::Manager::SubmitCommandLists(cmdHandle, GPU::CommandQueueType::COMPUTE));
+		REQUIRE(!GPU::Manager::SubmitCommandLists(cmdHandle, GPU::CommandQueueType::GRAPHICS));
+	}
+
+	// Update out of buffer bounds.
+	{
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.UpdateBuffer(vb0Handle, sizeof(f32), sizeof(data), data));
+		REQUIRE(!GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+	}
+
+	// Unordered access on a buffer without UNORDERED_ACCESS bind flag.
+	{
+		GPU::PipelineBindingSetDesc pbsDesc;
+		pbsDesc.numUAVs_ = 1;
+		GPU::Handle pbsHandle = GPU::Manager::CreatePipelineBindingSet(pbsDesc, testName.c_str());
+		REQUIRE(pbsHandle);
+
+		GPU::BindingUAV uav;
+		uav.resource_ = vb0Handle;
+		uav.format_ = GPU::Format::R32_TYPELESS;
+		uav.dimension_ = GPU::ViewDimension::BUFFER;
+		REQUIRE(GPU::Manager::UpdatePipelineBindings(pbsHandle, 0, uav));
+
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.ClearUAV(pbsHandle, 0, data));
+		REQUIRE(!GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+
+		GPU::Manager::DestroyResource(pbsHandle);
+	}
+
+	GPU::Manager::DestroyResource(cmdHandle);
+	GPU::Manager::DestroyResource(vb1Handle);
+	GPU::Manager::DestroyResource(vb0Handle);
+}
+
+TEST_CASE("gpu-tests-null-draw-indirect-ids")
+{
+	auto testName = Catch::getResultCapture().getCurrentTestName();
+	Plugin::Manager::Scoped pluginManager;
+
+	GPU::SetupParams setupParams = GetDefaultSetupParams();
+	setupParams.api_ = "NULL";
+	GPU::Manager::Scoped gpuManager(setupParams);
+
+	REQUIRE(GPU::Manager::CreateAdapter(0) == GPU::ErrorCode::OK);
+
+	const i32 NUM_DRAWS = 8;
+
+	f32 vertices[] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f};
+	u16 indices[] = {0, 1, 2};
+
+	GPU::BufferDesc vbDesc;
+	vbDesc.bindFlags_ = GPU::BindFlags::VERTEX_BUFFER;
+	vbDesc.size_ = sizeof(vertices);
+	GPU::Handle vbHandle = GPU::Manager::CreateBuffer(vbDesc, vertices, testName.c_str());
+	REQUIRE(vbHandle);
+
+	GPU::BufferDesc ibDesc;
+	ibDesc.bindFlags_ = GPU::BindFlags::INDEX_BUFFER;
+	ibDesc.size_ = sizeof(indices);
+	GPU::Handle ibHandle = GPU::Manager::CreateBuffer(ibDesc, indices, testName.c_str());
+	REQUIRE(ibHandle);
+
+	// Laid out as the batched mesh path does: a draw count followed by the draw arguments.
+	GPU::BufferDesc argsDesc;
+	argsDesc.bindFlags_ = GPU::BindFlags::INDIRECT_BUFFER;
+	argsDesc.size_ = sizeof(u32) + NUM_DRAWS * sizeof(GPU::DrawIndexedIdArgs);
+	GPU::Handle argsHandle = GPU::Manager::CreateBuffer(argsDesc, nullptr, testName.c_str());
+	REQUIRE(argsHandle);
+
+	GPU::DrawBindingSetDesc dbsDesc;
+	dbsDesc.vbs_[0].resource_ = vbHandle;
+	dbsDesc.vbs_[0].size_ = (i32)vbDesc.size_;
+	dbsDesc.vbs_[0].stride_ = sizeof(f32) * 4;
+	dbsDesc.ib_.resource_ = ibHandle;
+	dbsDesc.ib_.size_ = (i32)ibDesc.size_;
+	dbsDesc.ib_.stride_ = sizeof(u16);
+	GPU::Handle dbsHandle = GPU::Manager::CreateDrawBindingSet(dbsDesc, testName.c_str());
+	REQUIRE(dbsHandle);
+
+	GPU::TextureDesc rtDesc;
+	rtDesc.type_ = GPU::TextureType::TEX2D;
+	rtDesc.bindFlags_ = GPU::BindFlags::RENDER_TARGET;
+	rtDesc.width_ = 128;
+	rtDesc.height_ = 128;
+	rtDesc.format_ = GPU::Format::R8G8B8A8_UNORM;
+	GPU::Handle rtHandle = GPU::Manager::CreateTexture(rtDesc, nullptr, testName.c_str());
+	REQUIRE(rtHandle);
+
+	GPU::FrameBindingSetDesc fbDesc;
+	fbDesc.rtvs_[0].resource_ = rtHandle;
+	fbDesc.rtvs_[0].format_ = rtDesc.format_;
+	fbDesc.rtvs_[0].dimension_ = GPU::ViewDimension::TEX2D;
+	GPU::Handle fbsHandle = GPU::Manager::CreateFrameBindingSet(fbDesc, testName.c_str());
+	REQUIRE(fbsHandle);
+
+	GPU::ShaderDesc vsDesc;
+	vsDesc.type_ = GPU::ShaderType::VS;
+	vsDesc.dataSize_ = sizeof(g_VShader);
+	vsDesc.data_ = g_VShader;
+	GPU::Handle vsHandle = GPU::Manager::CreateShader(vsDesc, testName.c_str());
+	REQUIRE(vsHandle);
+
+	GPU::GraphicsPipelineStateDesc pipelineDesc;
+	pipelineDesc.shaders_[(i32)GPU::ShaderType::VS] = vsHandle;
+	pipelineDesc.numRTs_ = 1;
+	pipelineDesc.rtvFormats_[0] = rtDesc.format_;
+	GPU::Handle pipelineHandle = GPU::Manager::CreateGraphicsPipelineState(pipelineDesc, testName.c_str());
+	REQUIRE(pipelineHandle);
+
+	GPU::Handle cmdHandle = GPU::Manager::CreateCommandList(testName.c_str());
+	REQUIRE(cmdHandle);
+
+	GPU::DrawState drawState;
+	drawState.viewport_.w_ = (f32)rtDesc.width_;
+	drawState.viewport_.h_ = (f32)rtDesc.height_;
+	drawState.scissorRect_.w_ = rtDesc.width_;
+	drawState.scissorRect_.h_ = rtDesc.height_;
+
+	u8 args[sizeof(u32) + NUM_DRAWS * sizeof(GPU::DrawIndexedIdArgs)];
+	const u32 numDraws = NUM_DRAWS;
+	memcpy(args, &numDraws, sizeof(u32));
+	for(i32 idx = 0; idx < NUM_DRAWS; ++idx)
+	{
+		GPU::DrawIndexedIdArgs drawArgs;
+		drawArgs.drawId_ = idx;
+		drawArgs.args_.indexCountPerInstance_ = 3;
+		drawArgs.args_.instanceCount_ = 1;
+		memcpy(args + sizeof(u32) + idx * sizeof(drawArgs), &drawArgs, sizeof(drawArgs));
+	}
+
+	// Reset frame command count.
+	GPU::Manager::NextFrame();
+
+	// Per-packet: one draw command per packet.
+	i32 numPerPacketCommands = 0;
+	{
+		GPU::CommandList cmdList;
+		for(i32 idx = 0; idx < NUM_DRAWS; ++idx)
+			REQUIRE(cmdList.Draw(pipelineHandle, {}, dbsHandle, fbsHandle, drawState,
+			    GPU::PrimitiveTopology::TRIANGLE_LIST, 0, 0, 3, 0, 1));
+		REQUIRE(GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+		REQUIRE(GPU::Manager::SubmitCommandList(cmdHandle));
+		GPU::Manager::NextFrame();
+		numPerPacketCommands = GPU::Manager::GetNumFrameCommands();
+		REQUIRE(numPerPacketCommands == NUM_DRAWS);
+	}
+
+	// Batched: argument upload plus a single indirect draw, ids set per draw via DRAW_ID_ROOT_PARAMETER.
+	i32 numBatchedCommands = 0;
+	{
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.UpdateBuffer(argsHandle, 0, sizeof(args), args));
+		REQUIRE(cmdList.DrawIndirect(pipelineHandle, {}, dbsHandle, fbsHandle, drawState,
+		    GPU::PrimitiveTopology::TRIANGLE_LIST, argsHandle, sizeof(u32), argsHandle, 0, NUM_DRAWS, true));
+		REQUIRE(GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+		REQUIRE(GPU::Manager::SubmitCommandList(cmdHandle));
+		GPU::Manager::NextFrame();
+		numBatchedCommands = GPU::Manager::GetNumFrameCommands();
+		REQUIRE(numBatchedCommands == 2);
+	}
+	REQUIRE(numBatchedCommands < numPerPacketCommands);
+
+	// No commands compiled this frame.
+	GPU::Manager::NextFrame();
+	REQUIRE(GPU::Manager::GetNumFrameCommands() == 0);
+
+	// Argument stride includes the draw id: fits without it, but not with it.
+	{
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.DrawIndirect(pipelineHandle, {}, dbsHandle, fbsHandle, drawState,
+		    GPU::PrimitiveTopology::TRIANGLE_LIST, argsHandle, sizeof(u32) * 2, nullptr, 0, NUM_DRAWS, false));
+		REQUIRE(GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+	}
+	{
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.DrawIndirect(pipelineHandle, {}, dbsHandle, fbsHandle, drawState,
+		    GPU::PrimitiveTopology::TRIANGLE_LIST, argsHandle, sizeof(u32) * 2, nullptr, 0, NUM_DRAWS, true));
+		REQUIRE(!GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+	}
+
+	GPU::Manager::DestroyResource(cmdHandle);
+	GPU::Manager::DestroyResource(pipelineHandle);
+	GPU::Manager::DestroyResource(vsHandle);
+	GPU::Manager::DestroyResource(fbsHandle);
+	GPU::Manager::DestroyResource(rtHandle);
+	GPU::Manager::DestroyResource(dbsHandle);
+	GPU::Manager::DestroyResource(argsHandle);
+	GPU::Manager::DestroyResource(ibHandle);
+	GPU::Manager::DestroyResource(vbHandle);
+}
+
+TEST_CASE("gpu-tests-upload-ring")
+{
+	auto testName = Catch::getResultCapture().getCurrentTestName();
+	Plugin::Manager::Scoped pluginManager;
+
+	const i32 ringSize = 64 * 1024;
+	const i32 allocSize = ringSize / 4;
+	GPU::SetupParams setupParams = GetDefaultSetupParams();
+	setupParams.api_ = "NULL";
+	setupParams.uploadRingSize_ = ringSize;
+	GPU::Manager::Scoped gpuManager(setupParams);
+
+	REQUIRE(GPU::Manager::CreateAdapter(0) == GPU::ErrorCode::OK);
+
+	f32 data[8] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+	GPU::BufferDesc vbDesc;
+	vbDesc.bindFlags_ = GPU::BindFlags::VERTEX_BUFFER;
+	vbDesc.size_ = sizeof(data);
+	GPU::Handle vbHandle = GPU::Manager::CreateBuffer(vbDesc, nullptr, testName.c_str());
+	REQUIRE(vbHandle);
+
+	GPU::Handle cmdHandle = GPU::Manager::CreateCommandList(testName.c_str());
+	REQUIRE(cmdHandle);
+
+	// Allocations don't overlap, and fail once ring is full.
+	Core::Vector<GPU::UploadAllocation> uploads;
+	while(auto upload = GPU::Manager::AllocUpload(allocSize))
+	{
+		for(const auto& other : uploads)
+			REQUIRE((upload.offset_ >= (other.offset_ + other.size_) || other.offset_ >= (upload.offset_ + allocSize)));
+		uploads.push_back(upload);
+		REQUIRE(uploads.size() <= (ringSize / allocSize));
+	}
+	REQUIRE(uploads.size() == (ringSize / allocSize));
+
+	// Memory is only reclaimed once the frame it was allocated in is no longer in flight.
+	for(i32 frame = 0; frame < (GPU::MAX_GPU_FRAMES - 1); ++frame)
+	{
+		GPU::Manager::NextFrame();
+		REQUIRE(!GPU::Manager::AllocUpload(allocSize));
+	}
+	GPU::Manager::NextFrame();
+	REQUIRE(GPU::Manager::AllocUpload(allocSize).offset_ == 0);
+
+	// Allocations that would straddle the end of the ring wrap to the start.
+	for(i32 frame = 0; frame < GPU::MAX_GPU_FRAMES; ++frame)
+		GPU::Manager::NextFrame();
+	REQUIRE(GPU::Manager::AllocUpload(allocSize).offset_ == allocSize);
+	REQUIRE(!GPU::Manager::AllocUpload(allocSize * 3));
+	for(i32 frame = 0; frame < GPU::MAX_GPU_FRAMES; ++frame)
+		GPU::Manager::NextFrame();
+	REQUIRE(GPU::Manager::AllocUpload(allocSize * 3).offset_ == 0);
+
+	// Update from upload ring.
+	{
+		auto upload = GPU::Manager::AllocUpload(sizeof(data));
+		REQUIRE(upload);
+		REQUIRE((upload.offset_ % GPU::RESOURCE_DATA_ALIGNMENT) == 0);
+		memcpy(upload.address_, data, sizeof(data));
+
+		GPU::CommandList cmdList;
+		auto* command = cmdList.UpdateBuffer(vbHandle, 0, upload);
+		REQUIRE(command);
+		REQUIRE(command->uploadOffset_ == upload.offset_);
+		REQUIRE(command->size_ == sizeof(data));
+		REQUIRE(GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+		REQUIRE(GPU::Manager::SubmitCommandList(cmdHandle));
+	}
+
+	// Update using data not at its upload offset.
+	{
+		auto upload = GPU::Manager::AllocUpload(sizeof(data));
+		REQUIRE(upload);
+		upload.offset_ += GPU::RESOURCE_DATA_ALIGNMENT;
+
+		GPU::CommandList cmdList;
+		REQUIRE(cmdList.UpdateBuffer(vbHandle, 0, upload));
+		REQUIRE(!GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+	}
+
+	GPU::Manager::DestroyResource(cmdHandle);
+	GPU::Manager::DestroyResource(vbHandle);
+}
+
+TEST_CASE("gpu-tests-capture-replay")
+{
+	auto testName = Catch::getResultCapture().getCurrentTestName();
+	Plugin::Manager::Scoped pluginManager;
+
+	const char* capturePath = "gpu-tests-capture-replay.cap";
+	const i32 numFrames = 4;
+
+	// Capture a few frames.
+	{
+		GPU::SetupParams setupParams = GetDefaultSetupParams();
+		setupParams.api_ = "NULL";
+		setupParams.capturePath_ = capturePath;
+		GPU::Manager::Scoped gpuManager(setupParams);
+		REQUIRE(GPU::Manager::CreateAdapter(0) == GPU::ErrorCode::OK);
+
+		f32 data[8] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+		GPU::BufferDesc vbDesc;
+		vbDesc.bindFlags_ = GPU::BindFlags::VERTEX_BUFFER;
+		vbDesc.size_ = sizeof(data);
+		GPU::Handle vb0Handle = GPU::Manager::CreateBuffer(vbDesc, data, testName.c_str());
+		GPU::Handle vb1Handle = GPU::Manager::CreateBuffer(vbDesc, nullptr, testName.c_str());
+		GPU::Handle cmdHandle = GPU::Manager::CreateCommandList(testName.c_str());
+		REQUIRE(vb0Handle);
+		REQUIRE(vb1Handle);
+		REQUIRE(cmdHandle);
+
+		for(i32 frame = 0; frame < numFrames; ++frame)
+		{
+			GPU::CommandList cmdList;
+			{
+				auto event = cmdList.Eventf(0, "Frame %i", frame);
+				REQUIRE(cmdList.UpdateBuffer(vb0Handle, 0, sizeof(data), data));
+				REQUIRE(cmdList.CopyBuffer(vb1Handle, 0, vb0Handle, 0, sizeof(data)));
+			}
+			REQUIRE(GPU::Manager::CompileCommandList(cmdHandle, cmdList));
+			REQUIRE(GPU::Manager::SubmitCommandList(cmdHandle));
+			GPU::Manager::NextFrame();
+		}
+
+		GPU::Manager::DestroyResource(cmdHandle);
+		GPU::Manager::DestroyResource(vb1Handle);
+		GPU::Manager::DestroyResource(vb0Handle);
+	}
+
+	// Replay it.
+	{
+		GPU::BackendPlugin plugin;
+		bool found = false;
+		Core::Vector<GPU::BackendPlugin> plugins;
+		plugins.resize(Plugin::Manager::GetPlugins<GPU::BackendPlugin>(nullptr, 0));
+		Plugin::Manager::GetPlugins(plugins.data(), plugins.size());
+		for(const auto& it : plugins)
+		{
+			if(strcmp(it.api_, "NULL") == 0)
+			{
+				plugin = it;
+				found = true;
+			}
+		}
+		REQUIRE(found);
+
+		GPU::IBackend* backend = plugin.CreateBackend(GetDefaultSetupParams());
+		REQUIRE(backend);
+		REQUIRE(backend->Initialize(0) == GPU::ErrorCode::OK);
+
+		GPU::ReplayParams params;
+		params.numIterations_ = 2;
+		GPU::ReplayStats stats;
+		REQUIRE(GPU::ReplayCapture(*backend, capturePath, params, stats));
+		GPU::LogReplayStats(stats);
+
+		CHECK(stats.numIterations_ == params.numIterations_);
+		CHECK(stats.numErrors_ == 0);
+		CHECK(stats.numFrames_ >= numFrames * params.numIterations_);
+		CHECK(stats.commandCount_[(i32)GPU::CommandType::UPDATE_BUFFER] == numFrames * params.numIterations_);
+		CHECK(stats.commandCount_[(i32)GPU::CommandType::COPY_BUFFER] == numFrames * params.numIterations_);
+		CHECK(stats.commandCount_[(i32)GPU::CommandType::BEGIN_EVENT] == numFrames * params.numIterations_);
+
+		plugin.DestroyBackend(backend);
+	}
+
+	Core::FileRemove(capturePath);
+}
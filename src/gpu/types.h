@@ -33,6 +33,8 @@ namespace GPU
 	static const i32 MAX_SAMPLER_BINDINGS = 8;
 	/// Resource data alignment. TODO: Make queryable.
 	static const i32 RESOURCE_DATA_ALIGNMENT = 256;
+	/// Upload data alignment required for texture updates from the upload ring. TODO: Make queryable.
+	static const i32 UPLOAD_TEXTURE_DATA_ALIGNMENT = 512;
 	/// Maximum number of combined SRVs, UAVs, and CBVs in a pipeline binding set. TODO: Make queryable.
 	static const i32 MAX_PIPELINE_BINDING_SET_VIEWS = 1000000;
 	/// Maximum number of SRVs in pipeline binding set. TODO: Make queryable.
@@ -460,6 +462,12 @@ namespace GPU
 		void* deviceWindow_ = nullptr;
 		/// Debuggers to natively support integration of.
 		DebugFlags debugFlags_ = DebugFlags::NONE;
+		/// File to write compiled command streams to. Only supported by some backends (i.e. "NULL").
+		const char* commandStreamPath_ = nullptr;
+		/// File to capture all backend calls to for later replay. See gpu/capture.h.
+		const char* capturePath_ = nullptr;
+		/// Size of upload ring. See Manager::AllocUpload. 0 disables it.
+		i64 uploadRingSize_ = 32 * 1024 * 1024;
 	};
 
 	/**
@@ -611,6 +619,26 @@ namespace GPU
 		u32 startInstanceLocation_ = 0;
 	};
 
+	/**
+	 * Draw arguments preceded by a draw id.
+	 * Used by CommandDrawIndirect::drawIds_. The id is visible to shaders as drawParams.drawId.
+	 */
+	struct GPU_DLL DrawIdArgs
+	{
+		u32 drawId_ = 0;
+		DrawArgs args_;
+	};
+
+	/**
+	 * Draw indexed arguments preceded by a draw id.
+	 * Used by CommandDrawIndirect::drawIds_. The id is visible to shaders as drawParams.drawId.
+	 */
+	struct GPU_DLL DrawIndexedIdArgs
+	{
+		u32 drawId_ = 0;
+		DrawIndexedArgs args_;
+	};
+
 	/**
 	 * Dispatch arguments.
 	 * - Should currently match D3D12 & Vulkan structure.
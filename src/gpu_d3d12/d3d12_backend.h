@@ -46,6 +46,8 @@ namespace GPU
 		ErrorCode CreateFence(Handle handle, const char* debugName) override;
 		ErrorCode DestroyResource(Handle handle) override;
 
+		ErrorCode CreateUploadRing(i64 size, void** outAddress) override;
+
 		ErrorCode AllocTemporaryPipelineBindingSet(Handle handle, const PipelineBindingSetDesc& desc) override;
 		ErrorCode UpdatePipelineBindings(Handle pbs, i32 base, Core::ArrayView<const BindingCBV> descs) override;
 		ErrorCode UpdatePipelineBindings(Handle pbs, i32 base, Core::ArrayView<const BindingSRV> descs) override;
@@ -55,8 +57,12 @@ namespace GPU
 		    Core::ArrayView<const PipelineBinding> dst, Core::ArrayView<const PipelineBinding> src) override;
 		ErrorCode ValidatePipelineBindings(Core::ArrayView<const PipelineBinding> pb) override;
 
-		ErrorCode CompileCommandList(Handle handle, const CommandList& commandList) override;
-		ErrorCode SubmitCommandLists(Core::ArrayView<Handle> handles) override;
+		ErrorCode CompileCommandList(
+		    Handle handle, const CommandList& commandList, CommandQueueType queueType) override;
+		ErrorCode SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType) override;
+
+		ErrorCode SignalFence(CommandQueueType queueType, Handle handle, i64 value) override;
+		ErrorCode WaitOnFence(CommandQueueType queueType, Handle handle, i64 value) override;
 
 		ErrorCode PresentSwapChain(Handle handle) override;
 		ErrorCode ResizeSwapChain(Handle handle, i32 width, i32 height) override;
@@ -107,8 +113,22 @@ namespace GPU
 		ResourcePool<D3D12PipelineBindingSet> pipelineBindingSets_;
 		ResourcePool<D3D12DrawBindingSet> drawBindingSets_;
 		ResourcePool<D3D12FrameBindingSet> frameBindingSets_;
-		ResourcePool<D3D12CommandList*> commandLists_;
-
+		ResourcePool<D3D12CommandLists> commandLists_;
+		ResourcePool<D3D12Fence> fences_;
+
+		/// Compute exit barriers not yet submitted on the graphics queue. They are tagged with the first compute fence
+		/// signalled after them, and submitted when graphics waits on that fence, or at the end of the frame.
+		struct PendingComputeExit
+		{
+			D3D12CommandList* commandList_ = nullptr;
+			Handle fence_;
+			i64 value_ = 0;
+		};
+		Core::Vector<PendingComputeExit> pendingComputeExits_;
+		Core::Mutex pendingComputeExitMutex_;
+
+		/// Submit pending compute exit barriers, after syncing graphics with compute if @a sync is set.
+		ErrorCode SubmitPendingComputeExits(Handle fence, i64 value, bool sync);
 
 		/// Vendor specific extensions.
 		AGSContext* agsContext_ = nullptr;
@@ -3,6 +3,7 @@
 #include "gpu_d3d12/dll.h"
 #include "gpu_d3d12/d3d12_types.h"
 #include "gpu/command_list.h"
+#include "core/string.h"
 #include "core/vector.h"
 
 namespace GPU
@@ -57,4 +58,24 @@ namespace GPU
 		ComPtr<ID3D12Fence> d3dFence_;
 	};
 
+	/**
+	 * Command lists backing a command list handle.
+	 * Compute queue lists are created the first time the handle is compiled for the compute queue.
+	 */
+	struct D3D12CommandLists
+	{
+		D3D12CommandList* direct_ = nullptr;
+		D3D12CommandList* compute_ = nullptr;
+
+		/// Direct lists transitioning resources from graphics only states before compute_ executes, and back after.
+		D3D12CommandList* computeEnter_ = nullptr;
+		D3D12CommandList* computeExit_ = nullptr;
+		bool hasComputeEnter_ = false;
+		bool hasComputeExit_ = false;
+
+		/// Queue last compiled for.
+		CommandQueueType queueType_ = CommandQueueType::NONE;
+		Core::String debugName_;
+	};
+
 } // namespace GPU
@@ -10,10 +10,11 @@ namespace GPU
 {
 	struct D3D12CompileContext
 	{
-		D3D12CompileContext(class D3D12Backend& backend);
+		D3D12CompileContext(class D3D12Backend& backend, CommandQueueType queueType = CommandQueueType::GRAPHICS);
 		~D3D12CompileContext();
 
 		class D3D12Backend& backend_;
+		CommandQueueType queueType_ = CommandQueueType::GRAPHICS;
 		ID3D12GraphicsCommandList* d3dCommandList_ = nullptr;
 
 		struct Subresource
@@ -47,6 +48,11 @@ namespace GPU
 		Core::Map<Subresource, D3D12_RESOURCE_BARRIER, SubresourceHasher> pendingBarriers_;
 		Core::Vector<D3D12_RESOURCE_BARRIER> barriers_;
 
+		/// Compute queue only: transitions out of and back into graphics only states.
+		/// These can't be recorded on a compute command list, so are executed on the direct queue.
+		Core::Vector<D3D12_RESOURCE_BARRIER> enterBarriers_;
+		Core::Vector<D3D12_RESOURCE_BARRIER> exitBarriers_;
+
 		struct DescriptorCopyParams
 		{
 			Core::Vector<D3D12_CPU_DESCRIPTOR_HANDLE> dstHandles_;
@@ -67,6 +73,8 @@ namespace GPU
 		PrimitiveTopology primitiveBound_ = PrimitiveTopology::INVALID;
 		GPU::Handle fbsBound_;
 		RootSignatureType rootSigBound_ = RootSignatureType::INVALID;
+		/// -1 when unknown.
+		i32 drawIdBound_ = -1;
 		ID3D12PipelineState* psBound_ = nullptr;
 
 		Core::Array<ID3D12DescriptorHeap*, 2> descHeapsBound_ = {};
@@ -76,6 +84,12 @@ namespace GPU
 		Core::Vector<const char*> eventStack_;
 
 		ErrorCode CompileCommandList(class D3D12CommandList& outCommandList, const class CommandList& commandList);
+
+		/**
+		 * Record @a barriers into @a outCommandList.
+		 */
+		ErrorCode CompileBarriers(
+		    class D3D12CommandList& outCommandList, Core::ArrayView<const D3D12_RESOURCE_BARRIER> barriers);
 		ErrorCode CompileCommand(const struct CommandDraw* command);
 		ErrorCode CompileCommand(const struct CommandDrawIndirect* command);
 		ErrorCode CompileCommand(const struct CommandDispatch* command);
@@ -92,6 +106,7 @@ namespace GPU
 		ErrorCode SetPipeline(Handle ps, Core::ArrayView<PipelineBinding> pbs);
 		ErrorCode SetFrameBinding(Handle fbsHandle);
 		ErrorCode SetDrawState(const DrawState* drawState);
+		ErrorCode SetDrawId(i32 drawId);
 
 		/**
 		 * Add resource transition.
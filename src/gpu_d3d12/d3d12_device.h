@@ -3,6 +3,7 @@
 #include "gpu_d3d12/d3d12_types.h"
 #include "gpu_d3d12/d3d12_backend.h"
 #include "gpu_d3d12/d3d12_command_list.h"
+#include "gpu_d3d12/d3d12_linear_heap_allocator.h"
 #include "gpu_d3d12/d3d12_resources.h"
 #include "gpu/resources.h"
 #include "core/array.h"
@@ -22,6 +23,7 @@ namespace GPU
 		void CreateCommandSignatures();
 		void CreateDefaultPSOs();
 		void CreateUploadAllocators();
+		ErrorCode CreateUploadRing(i64 size, void** outAddress);
 		void CreateDescriptorAllocators();
 
 		void NextFrame();
@@ -55,7 +57,17 @@ namespace GPU
 		ErrorCode UpdateFrameBindingSet(D3D12FrameBindingSet& frameBindingSet,
 		    const D3D12_RENDER_TARGET_VIEW_DESC* rtvDescs, const D3D12_DEPTH_STENCIL_VIEW_DESC* dsvDesc);
 
-		ErrorCode SubmitCommandLists(Core::ArrayView<D3D12CommandList*> commandLists);
+		ErrorCode SubmitCommandLists(Core::ArrayView<D3D12CommandList*> commandLists, CommandQueueType queueType);
+
+		/**
+		 * Get D3D12 command queue to use for @a queueType.
+		 */
+		ID3D12CommandQueue* GetCommandQueue(CommandQueueType queueType) const;
+
+		/**
+		 * Make @a waitQueueType wait for all work submitted so far to @a signalQueueType.
+		 */
+		ErrorCode SyncQueues(CommandQueueType waitQueueType, CommandQueueType signalQueueType);
 
 		ErrorCode ResizeSwapChain(D3D12SwapChain& swapChain, i32 width, i32 height);
 
@@ -73,6 +85,10 @@ namespace GPU
 		ComPtr<ID3D12CommandQueue> d3dDirectQueue_;       // direct
 		ComPtr<ID3D12CommandQueue> d3dAsyncComputeQueue_; // compute
 
+		/// Fence for backend internal synchronization between queues.
+		ComPtr<ID3D12Fence> d3dQueueSyncFence_;
+		volatile i64 queueSyncFenceIdx_ = 0;
+
 		/// Frame counter.
 		i64 frameIdx_ = 0;
 		ComPtr<ID3D12Fence> d3dFrameFence_;
@@ -88,6 +104,10 @@ namespace GPU
 		volatile i64 uploadCommandsPending_ = 0;
 		volatile i64 uploadFenceIdx_ = 0;
 
+		/// Upload ring. Offsets within it are managed by GPU::Manager.
+		class D3D12LinearHeapAllocator* uploadRingAllocator_ = nullptr;
+		D3D12ResourceAllocation uploadRing_;
+
 		/// Descriptor allocators.
 		class D3D12DescriptorHeapAllocator* cpuViewAllocator_ = nullptr;
 		class D3D12DescriptorHeapAllocator* cpuSamplerAllocator_ = nullptr;
@@ -152,6 +172,8 @@ namespace GPU
 		/// Command signatures
 		ComPtr<ID3D12CommandSignature> d3dDrawCmdSig_;
 		ComPtr<ID3D12CommandSignature> d3dDrawIndexedCmdSig_;
+		ComPtr<ID3D12CommandSignature> d3dDrawIdCmdSig_;
+		ComPtr<ID3D12CommandSignature> d3dDrawIndexedIdCmdSig_;
 		ComPtr<ID3D12CommandSignature> d3dDispatchCmdSig_;
 
 		Core::Vector<ComPtr<ID3D12PipelineState>> d3dDefaultPSOs_;
@@ -51,6 +51,11 @@ namespace GPU
 		MAX
 	};
 
+	/// Graphics root parameter holding drawParams.drawId, a single root constant.
+	static const i32 DRAW_ID_ROOT_PARAMETER = 4;
+	/// Register space of drawParams, at register b0.
+	static const i32 DRAW_ID_REGISTER_SPACE = 9;
+
 	enum class DescriptorHeapSubType : i32
 	{
 		INVALID = -1,
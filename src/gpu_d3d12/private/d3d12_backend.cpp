@@ -60,7 +60,8 @@ namespace GPU
 	    , pipelineBindingSets_("D3D12PipelineBindingSet")
 	    , drawBindingSets_("D3D12DrawBindingSet")
 	    , frameBindingSets_("D3D12FrameBindingSet")
-	    , commandLists_("D3D12CommandList")
+	    , commandLists_("D3D12CommandLists")
+	    , fences_("D3D12Fence")
 	{
 		auto retVal = LoadLibraries();
 		DBG_ASSERT(retVal == ErrorCode::OK);
@@ -773,17 +774,27 @@ namespace GPU
 
 	ErrorCode D3D12Backend::CreateCommandList(Handle handle, const char* debugName)
 	{
-		auto commandList = commandLists_.Write(handle);
+		auto commandLists = commandLists_.Write(handle);
 
-		*commandList = new D3D12CommandList(*device_, 0x0, D3D12_COMMAND_LIST_TYPE_DIRECT, debugName);
+		commandLists->direct_ = new D3D12CommandList(*device_, 0x0, D3D12_COMMAND_LIST_TYPE_DIRECT, debugName);
+		commandLists->debugName_ = debugName ? debugName : "";
 
 		return ErrorCode::OK;
 	}
 
 	ErrorCode D3D12Backend::CreateFence(Handle handle, const char* debugName)
 	{
-		//
-		return ErrorCode::UNIMPLEMENTED;
+		D3D12Fence fence;
+		HRESULT hr = S_OK;
+		CHECK_D3D(hr = device_->d3dDevice_->CreateFence(
+		              0, D3D12_FENCE_FLAG_NONE, IID_ID3D12Fence, (void**)fence.fence_.GetAddressOf()));
+		if(FAILED(hr))
+			return ErrorCode::FAIL;
+		SetObjectName(fence.fence_.Get(), debugName);
+
+		*fences_.Write(handle) = fence;
+
+		return ErrorCode::OK;
 	}
 
 	ErrorCode D3D12Backend::DestroyResource(Handle handle)
@@ -830,12 +841,18 @@ namespace GPU
 			}
 			break;
 		case ResourceType::COMMAND_LIST:
-			if(auto commandList = commandLists_.Write(handle))
+			if(auto commandLists = commandLists_.Write(handle))
 			{
-				delete *commandList;
-				*commandList = nullptr;
+				delete commandLists->direct_;
+				delete commandLists->compute_;
+				delete commandLists->computeEnter_;
+				delete commandLists->computeExit_;
+				*commandLists = D3D12CommandLists();
 			}
 			break;
+		case ResourceType::FENCE:
+			*fences_.Write(handle) = D3D12Fence();
+			break;
 		default:
 			return ErrorCode::UNIMPLEMENTED;
 		}
@@ -843,6 +860,11 @@ namespace GPU
 		return ErrorCode::OK;
 	}
 
+	ErrorCode D3D12Backend::CreateUploadRing(i64 size, void** outAddress)
+	{
+		return device_->CreateUploadRing(size, outAddress);
+	}
+
 	ErrorCode D3D12Backend::AllocTemporaryPipelineBindingSet(Handle handle, const PipelineBindingSetDesc& desc)
 	{
 		auto pbs = pipelineBindingSets_.Write(handle);
@@ -1290,37 +1312,170 @@ namespace GPU
 		return ErrorCode::OK;
 	}
 
-	ErrorCode D3D12Backend::CompileCommandList(Handle handle, const CommandList& commandList)
+	ErrorCode D3D12Backend::CompileCommandList(
+	    Handle handle, const CommandList& commandList, CommandQueueType queueType)
 	{
 		DBG_ASSERT(handle.GetIndex() < commandLists_.size());
 
-		auto outCommandList = commandLists_.Write(handle);
-		D3D12CompileContext context(*this);
-		return context.CompileCommandList(**outCommandList, commandList);
+		auto outCommandLists = commandLists_.Write(handle);
+		outCommandLists->queueType_ = queueType;
+
+		D3D12CompileContext context(*this, queueType);
+		if(queueType != CommandQueueType::COMPUTE)
+			return context.CompileCommandList(*outCommandLists->direct_, commandList);
+
+		if(outCommandLists->compute_ == nullptr)
+		{
+			const char* debugName = outCommandLists->debugName_.c_str();
+			outCommandLists->compute_ =
+			    new D3D12CommandList(*device_, 0x0, D3D12_COMMAND_LIST_TYPE_COMPUTE, debugName);
+			outCommandLists->computeEnter_ =
+			    new D3D12CommandList(*device_, 0x0, D3D12_COMMAND_LIST_TYPE_DIRECT, debugName);
+			outCommandLists->computeExit_ =
+			    new D3D12CommandList(*device_, 0x0, D3D12_COMMAND_LIST_TYPE_DIRECT, debugName);
+		}
+
+		RETURN_ON_ERROR(context.CompileCommandList(*outCommandLists->compute_, commandList));
+
+		outCommandLists->hasComputeEnter_ = context.enterBarriers_.size() > 0;
+		if(outCommandLists->hasComputeEnter_)
+			RETURN_ON_ERROR(context.CompileBarriers(*outCommandLists->computeEnter_, context.enterBarriers_));
+
+		outCommandLists->hasComputeExit_ = context.exitBarriers_.size() > 0;
+		if(outCommandLists->hasComputeExit_)
+			RETURN_ON_ERROR(context.CompileBarriers(*outCommandLists->computeExit_, context.exitBarriers_));
+
+		return ErrorCode::OK;
 	}
 
-	ErrorCode D3D12Backend::SubmitCommandLists(Core::ArrayView<Handle> handles)
+	ErrorCode D3D12Backend::SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType)
 	{
 		Core::Array<D3D12CommandList*, COMMAND_LIST_BATCH_SIZE> commandLists;
+		Core::Array<D3D12CommandList*, COMMAND_LIST_BATCH_SIZE> enterCommandLists;
+		Core::Array<D3D12CommandList*, COMMAND_LIST_BATCH_SIZE> exitCommandLists;
 		i32 numBatches = (handles.size() + (COMMAND_LIST_BATCH_SIZE - 1)) / COMMAND_LIST_BATCH_SIZE;
 		for(i32 batch = 0; batch < numBatches; ++batch)
 		{
 			const i32 baseHandle = batch * COMMAND_LIST_BATCH_SIZE;
 			const i32 numHandles = Core::Min(COMMAND_LIST_BATCH_SIZE, handles.size() - baseHandle);
+			i32 numEnter = 0;
+			i32 numExit = 0;
 			for(i32 i = 0; i < numHandles; ++i)
 			{
-				commandLists[i] = *commandLists_.Read(handles[i]);
+				auto lists = commandLists_.Read(handles[baseHandle + i]);
+				DBG_ASSERT_MSG(lists->queueType_ == queueType, "Command list wasn't compiled for this queue.");
+				if(queueType == CommandQueueType::COMPUTE)
+				{
+					commandLists[i] = lists->compute_;
+					if(lists->hasComputeEnter_)
+						enterCommandLists[numEnter++] = lists->computeEnter_;
+					if(lists->hasComputeExit_)
+						exitCommandLists[numExit++] = lists->computeExit_;
+				}
+				else
+				{
+					commandLists[i] = lists->direct_;
+				}
 				DBG_ASSERT(commandLists[i]);
 			}
 
-			auto retVal =
-			    device_->SubmitCommandLists(Core::ArrayView<D3D12CommandList*>(commandLists.data(), numHandles));
-			if(retVal != ErrorCode::OK)
-				return retVal;
+			// Resources in graphics only states are transitioned on the direct queue before the compute work.
+			if(numEnter > 0)
+			{
+				Core::ArrayView<D3D12CommandList*> enterLists(enterCommandLists.data(), numEnter);
+				RETURN_ON_ERROR(device_->SubmitCommandLists(enterLists, CommandQueueType::GRAPHICS));
+				RETURN_ON_ERROR(device_->SyncQueues(CommandQueueType::COMPUTE, CommandQueueType::GRAPHICS));
+			}
+
+			RETURN_ON_ERROR(device_->SubmitCommandLists(
+			    Core::ArrayView<D3D12CommandList*>(commandLists.data(), numHandles), queueType));
+
+			// ...and back to them after, once graphics waits on the compute work. Syncing here would stall graphics
+			// on compute work nothing on graphics depends on yet.
+			if(numExit > 0)
+			{
+				Core::ScopedMutex lock(pendingComputeExitMutex_);
+				for(i32 i = 0; i < numExit; ++i)
+				{
+					PendingComputeExit pendingExit;
+					pendingExit.commandList_ = exitCommandLists[i];
+					pendingComputeExits_.push_back(pendingExit);
+				}
+			}
 		}
 		return ErrorCode::OK;
 	}
 
+	ErrorCode D3D12Backend::SubmitPendingComputeExits(Handle fence, i64 value, bool sync)
+	{
+		Core::Vector<D3D12CommandList*> exitLists;
+		{
+			Core::ScopedMutex lock(pendingComputeExitMutex_);
+			for(i32 idx = 0; idx < pendingComputeExits_.size();)
+			{
+				const auto& pendingExit = pendingComputeExits_[idx];
+				if(!fence || (pendingExit.fence_ == fence && pendingExit.value_ <= value))
+				{
+					exitLists.push_back(pendingExit.commandList_);
+					pendingComputeExits_.erase(pendingComputeExits_.begin() + idx);
+				}
+				else
+				{
+					++idx;
+				}
+			}
+		}
+
+		if(exitLists.size() == 0)
+			return ErrorCode::OK;
+		if(sync)
+			RETURN_ON_ERROR(device_->SyncQueues(CommandQueueType::GRAPHICS, CommandQueueType::COMPUTE));
+		return device_->SubmitCommandLists(
+		    Core::ArrayView<D3D12CommandList*>(exitLists.data(), exitLists.size()), CommandQueueType::GRAPHICS);
+	}
+
+	ErrorCode D3D12Backend::SignalFence(CommandQueueType queueType, Handle handle, i64 value)
+	{
+		auto fence = fences_.Read(handle);
+		DBG_ASSERT(fence->fence_);
+
+		HRESULT hr = S_OK;
+		CHECK_D3D(hr = device_->GetCommandQueue(queueType)->Signal(fence->fence_.Get(), value));
+		if(FAILED(hr))
+			return ErrorCode::FAIL;
+
+		// Compute exit barriers submitted before this signal are covered by it.
+		if(queueType == CommandQueueType::COMPUTE)
+		{
+			Core::ScopedMutex lock(pendingComputeExitMutex_);
+			for(auto& pendingExit : pendingComputeExits_)
+			{
+				if(!pendingExit.fence_)
+				{
+					pendingExit.fence_ = handle;
+					pendingExit.value_ = value;
+				}
+			}
+		}
+		return ErrorCode::OK;
+	}
+
+	ErrorCode D3D12Backend::WaitOnFence(CommandQueueType queueType, Handle handle, i64 value)
+	{
+		auto fence = fences_.Read(handle);
+		DBG_ASSERT(fence->fence_);
+
+		HRESULT hr = S_OK;
+		CHECK_D3D(hr = device_->GetCommandQueue(queueType)->Wait(fence->fence_.Get(), value));
+		if(FAILED(hr))
+			return ErrorCode::FAIL;
+
+		// Graphics now observes the compute work, so transition its resources back.
+		if(queueType == CommandQueueType::GRAPHICS)
+			return SubmitPendingComputeExits(handle, value, false);
+		return ErrorCode::OK;
+	}
+
 	ErrorCode D3D12Backend::PresentSwapChain(Handle handle)
 	{
 		auto swapChain = swapchainResources_.Write(handle);
@@ -1347,7 +1502,11 @@ namespace GPU
 	void D3D12Backend::NextFrame()
 	{
 		if(device_)
+		{
+			// Any compute exit barriers graphics never waited on must still be submitted before the frame ends.
+			SubmitPendingComputeExits(Handle(), 0, true);
 			device_->NextFrame();
+		}
 	}
 
 	ResourceRead<D3D12Resource> D3D12Backend::GetD3D12Resource(Handle handle)
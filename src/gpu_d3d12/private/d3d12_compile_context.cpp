@@ -7,6 +7,7 @@
 #include "gpu/command_list.h"
 #include "gpu/commands.h"
 #include "gpu/manager.h"
+#include "core/misc.h"
 
 #include <pix_win.h>
 
@@ -14,8 +15,25 @@
 
 namespace GPU
 {
-	D3D12CompileContext::D3D12CompileContext(D3D12Backend& backend)
+	namespace
+	{
+		/// States that can't be used on a compute command list.
+		const D3D12_RESOURCE_STATES GRAPHICS_ONLY_STATES =
+		    D3D12_RESOURCE_STATE_INDEX_BUFFER | D3D12_RESOURCE_STATE_RENDER_TARGET |
+		    D3D12_RESOURCE_STATE_DEPTH_WRITE | D3D12_RESOURCE_STATE_DEPTH_READ |
+		    D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_STREAM_OUT |
+		    D3D12_RESOURCE_STATE_RESOLVE_DEST | D3D12_RESOURCE_STATE_RESOLVE_SOURCE;
+
+		/// States that allow writes, and so can't be combined with others.
+		const D3D12_RESOURCE_STATES WRITE_STATES = D3D12_RESOURCE_STATE_RENDER_TARGET |
+		                                           D3D12_RESOURCE_STATE_UNORDERED_ACCESS |
+		                                           D3D12_RESOURCE_STATE_DEPTH_WRITE | D3D12_RESOURCE_STATE_COPY_DEST |
+		                                           D3D12_RESOURCE_STATE_STREAM_OUT | D3D12_RESOURCE_STATE_RESOLVE_DEST;
+	} // namespace
+
+	D3D12CompileContext::D3D12CompileContext(D3D12Backend& backend, CommandQueueType queueType)
 	    : backend_(backend)
+	    , queueType_(queueType)
 	{
 	}
 
@@ -99,11 +117,22 @@ namespace GPU
 		return ErrorCode::FAIL;
 	}
 
+	ErrorCode D3D12CompileContext::CompileBarriers(
+	    D3D12CommandList& outCommandList, Core::ArrayView<const D3D12_RESOURCE_BARRIER> barriers)
+	{
+		auto* d3dCommandList = outCommandList.Open();
+		if(d3dCommandList == nullptr)
+			return ErrorCode::FAIL;
+		d3dCommandList->ResourceBarrier(barriers.size(), barriers.data());
+		return outCommandList.Close();
+	}
+
 	ErrorCode D3D12CompileContext::CompileCommand(const CommandDraw* command)
 	{
 		SetPipeline(command->pipelineState_, command->pipelineBindings_);
 		SetFrameBinding(command->frameBinding_);
 		SetDrawState(command->drawState_);
+		SetDrawId(0);
 
 		if(command->drawBinding_ != GPU::Handle())
 		{
@@ -140,6 +169,7 @@ namespace GPU
 		ResourceRead<D3D12Buffer> countBuffer;
 		if(command->countBuffer_)
 			countBuffer = backend_.bufferResources_.Read(command->countBuffer_);
+		ID3D12Resource* d3dCountBuffer = countBuffer ? countBuffer->resource_.Get() : nullptr;
 
 		SetPipeline(command->pipelineState_, command->pipelineBindings_);
 		SetFrameBinding(command->frameBinding_);
@@ -148,6 +178,19 @@ namespace GPU
 		if(countBuffer)
 			AddTransition(&(*countBuffer), 0, 1, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
 
+		const auto& device = *backend_.device_;
+		ID3D12CommandSignature* drawCmdSig = device.d3dDrawCmdSig_.Get();
+		ID3D12CommandSignature* drawIndexedCmdSig = device.d3dDrawIndexedCmdSig_.Get();
+		if(command->drawIds_)
+		{
+			drawCmdSig = device.d3dDrawIdCmdSig_.Get();
+			drawIndexedCmdSig = device.d3dDrawIndexedIdCmdSig_.Get();
+		}
+		else
+		{
+			SetDrawId(0);
+		}
+
 		if(command->drawBinding_ != GPU::Handle())
 		{
 			auto dbs = backend_.drawBindingSets_.Read(command->drawBinding_);
@@ -155,28 +198,22 @@ namespace GPU
 			SetDrawBinding(command->drawBinding_, command->primitive_);
 
 			FlushTransitions();
-			if(dbs->ib_.BufferLocation == 0)
-			{
-				d3dCommandList_->ExecuteIndirect(backend_.device_->d3dDrawCmdSig_.Get(), command->maxCommands_,
-				    indirectBuffer->resource_.Get(), command->argByteOffset_, countBuffer->resource_.Get(),
-				    command->countByteOffset_);
-			}
-			else
-			{
-				d3dCommandList_->ExecuteIndirect(backend_.device_->d3dDrawIndexedCmdSig_.Get(), command->maxCommands_,
-				    indirectBuffer->resource_.Get(), command->argByteOffset_, countBuffer->resource_.Get(),
-				    command->countByteOffset_);
-			}
+			d3dCommandList_->ExecuteIndirect(dbs->ib_.BufferLocation == 0 ? drawCmdSig : drawIndexedCmdSig,
+			    command->maxCommands_, indirectBuffer->resource_.Get(), command->argByteOffset_, d3dCountBuffer,
+			    command->countByteOffset_);
 		}
 		else
 		{
 			d3dCommandList_->IASetPrimitiveTopology(GetPrimitiveTopology(command->primitive_));
 
 			FlushTransitions();
-			d3dCommandList_->ExecuteIndirect(backend_.device_->d3dDrawCmdSig_.Get(), command->maxCommands_,
-			    indirectBuffer->resource_.Get(), command->argByteOffset_, countBuffer->resource_.Get(),
-			    command->countByteOffset_);
+			d3dCommandList_->ExecuteIndirect(drawCmdSig, command->maxCommands_, indirectBuffer->resource_.Get(),
+			    command->argByteOffset_, d3dCountBuffer, command->countByteOffset_);
 		}
+
+		// Draw id is left as whatever the last executed draw set it to.
+		if(command->drawIds_)
+			drawIdBound_ = -1;
 		return ErrorCode::OK;
 	}
 
@@ -266,8 +303,18 @@ namespace GPU
 		auto buf = backend_.GetD3D12Buffer(command->buffer_);
 		DBG_ASSERT(buf && buf->resource_);
 
-		auto uploadAlloc = backend_.device_->GetUploadAllocator().Alloc(command->size_);
-		memcpy(uploadAlloc.address_, command->data_, command->size_);
+		// Copy straight from the upload ring if data is in it.
+		D3D12ResourceAllocation uploadAlloc;
+		if(command->uploadOffset_ >= 0)
+		{
+			uploadAlloc = backend_.device_->uploadRing_;
+			uploadAlloc.offsetInBaseResource_ += command->uploadOffset_;
+		}
+		else
+		{
+			uploadAlloc = backend_.device_->GetUploadAllocator().Alloc(command->size_);
+			memcpy(uploadAlloc.address_, command->data_, command->size_);
+		}
 
 		AddTransition(&(*buf), 0, 1, D3D12_RESOURCE_STATE_COPY_DEST);
 		FlushTransitions();
@@ -293,20 +340,37 @@ namespace GPU
 		backend_.device_->d3dDevice_->GetCopyableFootprints(&resDesc, command->subResourceIdx_, 1, 0, &dstLayout,
 		    (u32*)&numRows, (u64*)&rowSizeInBytes, (u64*)&totalBytes);
 
-		auto resAlloc = backend_.device_->GetUploadAllocator().Alloc(totalBytes);
-		DBG_ASSERT(srcLayout.rowPitch_ <= rowSizeInBytes);
-		const u8* srcData = (const u8*)command->data_.data_;
-		u8* dstData = (u8*)resAlloc.address_ + dstLayout.Offset;
-		for(i32 slice = 0; slice < tex->desc_.depth_; ++slice)
+		// Copy straight from the upload ring if data is in it and laid out how D3D12 requires.
+		// Placement alignment is only asserted when recording, so check it here too.
+		D3D12ResourceAllocation resAlloc;
+		const i64 ringOffset = backend_.device_->uploadRing_.offsetInBaseResource_ + command->uploadOffset_;
+		if(command->uploadOffset_ >= 0 && (ringOffset % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) == 0 &&
+		    (srcLayout.rowPitch_ % D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) == 0 && srcLayout.rowPitch_ >= rowSizeInBytes &&
+		    (tex->desc_.depth_ == 1 || srcLayout.slicePitch_ == srcLayout.rowPitch_ * numRows))
 		{
-			const u8* rowSrcData = srcData;
-			for(i32 row = 0; row < numRows; ++row)
+			resAlloc = backend_.device_->uploadRing_;
+			dstLayout.Offset = ringOffset;
+			dstLayout.Footprint.RowPitch = srcLayout.rowPitch_;
+		}
+		else
+		{
+			// Repack rows to the pitch D3D12 requires.
+			resAlloc = backend_.device_->GetUploadAllocator().Alloc(totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+			const i64 rowCopyBytes = Core::Min((i64)srcLayout.rowPitch_, rowSizeInBytes);
+			const u8* srcData = (const u8*)command->data_.data_;
+			u8* dstData = (u8*)resAlloc.address_ + dstLayout.Offset;
+			for(i32 slice = 0; slice < tex->desc_.depth_; ++slice)
 			{
-				memcpy(dstData, srcData, srcLayout.rowPitch_);
-				dstData += rowSizeInBytes;
-				rowSrcData += srcLayout.rowPitch_;
+				const u8* rowSrcData = srcData;
+				for(i32 row = 0; row < numRows; ++row)
+				{
+					memcpy(dstData, rowSrcData, rowCopyBytes);
+					dstData += dstLayout.Footprint.RowPitch;
+					rowSrcData += srcLayout.rowPitch_;
+				}
+				srcData += srcLayout.slicePitch_;
 			}
-			rowSrcData += srcLayout.slicePitch_;
+			dstLayout.Offset += resAlloc.offsetInBaseResource_;
 		}
 
 		D3D12_TEXTURE_COPY_LOCATION dst;
@@ -455,8 +519,12 @@ namespace GPU
 			if(pbs->srvTransitions_[i])
 			{
 				DBG_ASSERT(pbs->srvTransitions_[i]);
-				AddTransition(pbs->srvTransitions_[i],
-				    D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+				// Compute lists can only read as a non-pixel shader resource.
+				if(queueType_ == CommandQueueType::COMPUTE)
+					AddTransition(pbs->srvTransitions_[i], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+				else
+					AddTransition(pbs->srvTransitions_[i], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+					                                           D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 			}
 		}
 		for(i32 i = 0; i < pbs->uavTransitions_.size(); ++i)
@@ -504,6 +572,7 @@ namespace GPU
 				d3dCommandList_->SetGraphicsRootSignature(backend_.device_->d3dRootSignatures_[(i32)rootSig].Get());
 				rootSigBound_ = rootSig;
 				rootSigChanged = true;
+				drawIdBound_ = -1;
 			}
 
 			if(rootSigChanged || gfxDescHandlesBound_[0].ptr != pbs->samplers_.GetGPUHandle(0).ptr)
@@ -654,6 +723,17 @@ namespace GPU
 		return ErrorCode::OK;
 	}
 
+	ErrorCode D3D12CompileContext::SetDrawId(i32 drawId)
+	{
+		DBG_ASSERT(rootSigBound_ == RootSignatureType::GRAPHICS);
+		if(drawIdBound_ != drawId)
+		{
+			d3dCommandList_->SetGraphicsRoot32BitConstant(DRAW_ID_ROOT_PARAMETER, (UINT)drawId, 0);
+			drawIdBound_ = drawId;
+		}
+		return ErrorCode::OK;
+	}
+
 	bool D3D12CompileContext::AddTransition(const D3D12SubresourceRange& subRsc, D3D12_RESOURCE_STATES state)
 	{
 		return AddTransition(subRsc.resource_, subRsc.firstSubRsc_, subRsc.numSubRsc_, state);
@@ -687,6 +767,41 @@ namespace GPU
 				barrier.Transition.Subresource = subRscIdx;
 				barrier.Transition.StateBefore = *stateEntry;
 				barrier.Transition.StateAfter = state;
+
+				if(queueType_ == CommandQueueType::COMPUTE)
+				{
+					// Already readable in a combined read state, i.e. the default shader resource state.
+					if(state != D3D12_RESOURCE_STATE_COMMON && (state & WRITE_STATES) == 0 &&
+					    Core::ContainsAllFlags(prevState, state))
+						continue;
+
+					// Returning to a graphics only default state is done after the compute list has executed.
+					if((state & GRAPHICS_ONLY_STATES) != 0)
+					{
+						DBG_ASSERT(state == resource->defaultState_);
+						exitBarriers_.push_back(barrier);
+						*stateEntry = state;
+						changed = true;
+						continue;
+					}
+
+					// Leaving a graphics only default state is done before the compute list executes. Only the
+					// graphics only part is dropped, so reads that were satisfied by the default state still are.
+					if((prevState & GRAPHICS_ONLY_STATES) != 0)
+					{
+						DBG_ASSERT(prevState == resource->defaultState_);
+						const D3D12_RESOURCE_STATES computeState = prevState & ~GRAPHICS_ONLY_STATES;
+						barrier.Transition.StateAfter = computeState;
+						enterBarriers_.push_back(barrier);
+						barrier.Transition.StateBefore = computeState;
+						barrier.Transition.StateAfter = state;
+						*stateEntry = state;
+						changed = true;
+						if(computeState == state)
+							continue;
+					}
+				}
+
 				pendingBarriers_.insert(Subresource(resource, barrier.Transition.Subresource), barrier);
 				*stateEntry = state;
 				changed = true;
@@ -136,9 +136,13 @@ namespace GPU
 		delete uploadCommandList_;
 		for(auto& d3dUploadAllocator : uploadAllocators_)
 			delete d3dUploadAllocator;
+		uploadRing_ = D3D12ResourceAllocation();
+		delete uploadRingAllocator_;
 
 		d3dDrawCmdSig_.Reset();
 		d3dDrawIndexedCmdSig_.Reset();
+		d3dDrawIdCmdSig_.Reset();
+		d3dDrawIndexedIdCmdSig_.Reset();
 		d3dDispatchCmdSig_.Reset();
 
 		for(auto& allocator : descriptorAllocators_)
@@ -177,6 +181,10 @@ namespace GPU
 
 		SetObjectName(d3dDirectQueue_.Get(), "Direct Command Queue");
 		SetObjectName(d3dAsyncComputeQueue_.Get(), "Async Compute Command Queue");
+
+		CHECK_D3D(hr = d3dDevice_->CreateFence(
+		              0, D3D12_FENCE_FLAG_NONE, IID_ID3D12Fence, (void**)d3dQueueSyncFence_.ReleaseAndGetAddressOf()));
+		SetObjectName(d3dQueueSyncFence_.Get(), "Queue Sync Fence");
 	}
 
 	void D3D12Device::CreateRootSignatures()
@@ -268,8 +276,15 @@ namespace GPU
 			parameters[3].DescriptorTable.pDescriptorRanges = &descriptorRanges[3];
 			parameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 
+			// Draw id, set per draw & by indirect draws.
+			parameters[DRAW_ID_ROOT_PARAMETER].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+			parameters[DRAW_ID_ROOT_PARAMETER].Constants.ShaderRegister = 0;
+			parameters[DRAW_ID_ROOT_PARAMETER].Constants.RegisterSpace = DRAW_ID_REGISTER_SPACE;
+			parameters[DRAW_ID_ROOT_PARAMETER].Constants.Num32BitValues = 1;
+			parameters[DRAW_ID_ROOT_PARAMETER].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
 			D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc;
-			rootSignatureDesc.NumParameters = 4;
+			rootSignatureDesc.NumParameters = DRAW_ID_ROOT_PARAMETER + 1;
 			rootSignatureDesc.NumStaticSamplers = staticSamplers.size();
 			rootSignatureDesc.pParameters = parameters;
 			rootSignatureDesc.pStaticSamplers = staticSamplers.data();
@@ -316,6 +331,18 @@ namespace GPU
 		D3D12_INDIRECT_ARGUMENT_DESC dispatchArg = {};
 		dispatchArg.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
 
+		// Draw id root constant followed by draw arguments.
+		D3D12_INDIRECT_ARGUMENT_DESC drawIdArgs[2] = {};
+		drawIdArgs[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+		drawIdArgs[0].Constant.RootParameterIndex = DRAW_ID_ROOT_PARAMETER;
+		drawIdArgs[0].Constant.DestOffsetIn32BitValues = 0;
+		drawIdArgs[0].Constant.Num32BitValuesToSet = 1;
+		drawIdArgs[1] = drawArg;
+
+		D3D12_INDIRECT_ARGUMENT_DESC drawIndexedIdArgs[2] = {};
+		drawIndexedIdArgs[0] = drawIdArgs[0];
+		drawIndexedIdArgs[1] = drawIndexedArg;
+
 		D3D12_COMMAND_SIGNATURE_DESC drawDesc = {};
 		drawDesc.ByteStride = sizeof(DrawArgs);
 		drawDesc.NumArgumentDescs = 1;
@@ -328,6 +355,18 @@ namespace GPU
 		drawIndexedDesc.pArgumentDescs = &drawIndexedArg;
 		drawIndexedDesc.NodeMask = 0x0;
 
+		D3D12_COMMAND_SIGNATURE_DESC drawIdDesc = {};
+		drawIdDesc.ByteStride = sizeof(DrawIdArgs);
+		drawIdDesc.NumArgumentDescs = 2;
+		drawIdDesc.pArgumentDescs = drawIdArgs;
+		drawIdDesc.NodeMask = 0x0;
+
+		D3D12_COMMAND_SIGNATURE_DESC drawIndexedIdDesc = {};
+		drawIndexedIdDesc.ByteStride = sizeof(DrawIndexedIdArgs);
+		drawIndexedIdDesc.NumArgumentDescs = 2;
+		drawIndexedIdDesc.pArgumentDescs = drawIndexedIdArgs;
+		drawIndexedIdDesc.NodeMask = 0x0;
+
 		D3D12_COMMAND_SIGNATURE_DESC dispatchDesc = {};
 		dispatchDesc.ByteStride = sizeof(DispatchArgs);
 		dispatchDesc.NumArgumentDescs = 1;
@@ -342,6 +381,16 @@ namespace GPU
 		    &drawIndexedDesc, nullptr, IID_ID3D12CommandSignature, (void**)d3dDrawIndexedCmdSig_.GetAddressOf()));
 		SetObjectName(d3dDrawIndexedCmdSig_.Get(), "DrawIndexedIndirect");
 
+		// Signatures that change root arguments are tied to the root signature.
+		auto* graphicsRootSig = d3dRootSignatures_[(i32)RootSignatureType::GRAPHICS].Get();
+		CHECK_D3D(d3dDevice_->CreateCommandSignature(
+		    &drawIdDesc, graphicsRootSig, IID_ID3D12CommandSignature, (void**)d3dDrawIdCmdSig_.GetAddressOf()));
+		SetObjectName(d3dDrawIdCmdSig_.Get(), "DrawIdIndirect");
+
+		CHECK_D3D(d3dDevice_->CreateCommandSignature(&drawIndexedIdDesc, graphicsRootSig, IID_ID3D12CommandSignature,
+		    (void**)d3dDrawIndexedIdCmdSig_.GetAddressOf()));
+		SetObjectName(d3dDrawIndexedIdCmdSig_.Get(), "DrawIndexedIdIndirect");
+
 		CHECK_D3D(d3dDevice_->CreateCommandSignature(
 		    &dispatchDesc, nullptr, IID_ID3D12CommandSignature, (void**)d3dDispatchCmdSig_.GetAddressOf()));
 		SetObjectName(d3dDispatchCmdSig_.Get(), "DispatchIndirect");
@@ -406,6 +455,21 @@ namespace GPU
 		uploadFenceEvent_ = ::CreateEvent(nullptr, FALSE, FALSE, "Upload fence");
 	}
 
+	ErrorCode D3D12Device::CreateUploadRing(i64 size, void** outAddress)
+	{
+		if(uploadRingAllocator_)
+			return ErrorCode::FAIL;
+
+		// Single persistently mapped block, never reset.
+		uploadRingAllocator_ = new D3D12LinearHeapAllocator(d3dDevice_.Get(), D3D12_HEAP_TYPE_UPLOAD, size);
+		uploadRing_ = uploadRingAllocator_->Alloc(size, D3D12LinearHeapAllocator::MAX_ALIGNMENT);
+		if(uploadRing_.address_ == nullptr)
+			return ErrorCode::FAIL;
+
+		*outAddress = uploadRing_.address_;
+		return ErrorCode::OK;
+	}
+
 	void D3D12Device::CreateDescriptorAllocators()
 	{
 		i32 cpuViewBlockSize = 1024 * 1024;
@@ -1060,9 +1124,32 @@ namespace GPU
 		return ErrorCode::OK;
 	}
 
-	ErrorCode D3D12Device::SubmitCommandLists(Core::ArrayView<D3D12CommandList*> commandLists)
+	ID3D12CommandQueue* D3D12Device::GetCommandQueue(CommandQueueType queueType) const
+	{
+		DBG_ASSERT(queueType == CommandQueueType::GRAPHICS || queueType == CommandQueueType::COMPUTE);
+		if(queueType == CommandQueueType::COMPUTE)
+			return d3dAsyncComputeQueue_.Get();
+		return d3dDirectQueue_.Get();
+	}
+
+	ErrorCode D3D12Device::SyncQueues(CommandQueueType waitQueueType, CommandQueueType signalQueueType)
+	{
+		DBG_ASSERT(waitQueueType != signalQueueType);
+		const i64 value = Core::AtomicInc(&queueSyncFenceIdx_);
+
+		HRESULT hr = S_OK;
+		CHECK_D3D(hr = GetCommandQueue(signalQueueType)->Signal(d3dQueueSyncFence_.Get(), value));
+		if(FAILED(hr))
+			return ErrorCode::FAIL;
+		CHECK_D3D(hr = GetCommandQueue(waitQueueType)->Wait(d3dQueueSyncFence_.Get(), value));
+		return SUCCEEDED(hr) ? ErrorCode::OK : ErrorCode::FAIL;
+	}
+
+	ErrorCode D3D12Device::SubmitCommandLists(
+	    Core::ArrayView<D3D12CommandList*> commandLists, CommandQueueType queueType)
 	{
 		DBG_ASSERT(commandLists.size() <= COMMAND_LIST_BATCH_SIZE);
+		ID3D12CommandQueue* d3dQueue = GetCommandQueue(queueType);
 
 		Core::Array<ID3D12CommandList*, COMMAND_LIST_BATCH_SIZE> d3dCommandLists;
 		Core::Array<D3D12CommandList*, COMMAND_LIST_BATCH_SIZE> sigCommandLists;
@@ -1079,14 +1166,16 @@ namespace GPU
 			// Wait for pending uploads to complete.
 			d3dDirectQueue_->Wait(d3dUploadFence_.Get(), uploadFenceIdx_);
 		}
+		if(d3dQueue != d3dDirectQueue_.Get())
+			d3dQueue->Wait(d3dUploadFence_.Get(), uploadFenceIdx_);
 
-		d3dDirectQueue_->ExecuteCommandLists(commandLists.size(), d3dCommandLists.data());
+		d3dQueue->ExecuteCommandLists(commandLists.size(), d3dCommandLists.data());
 
 		// Signal command list availability.
 		// TODO: Remove this mechanism and rely entirely on the per-frame signal.
 		for(i32 i = 0; i < commandLists.size(); ++i)
 		{
-			auto retVal = sigCommandLists[i]->SignalNext(d3dDirectQueue_.Get());
+			auto retVal = sigCommandLists[i]->SignalNext(d3dQueue);
 			if(retVal != ErrorCode::OK)
 				return retVal;
 		}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "core/portability.h"
+
+#if GPU_NULL_DLL_EXPORT
+#define GPU_NULL_DLL EXPORT
+#else
+#define GPU_NULL_DLL IMPORT
+#endif
+
+#if CODE_INLINE
+#define GPU_NULL_DLL_INLINE
+#else
+#define GPU_NULL_DLL_INLINE GPU_DLL
+#endif
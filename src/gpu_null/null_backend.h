@@ -0,0 +1,208 @@
+#pragma once
+
+#include "gpu/dll.h"
+#include "gpu/backend.h"
+
+#include "core/concurrency.h"
+#include "core/file.h"
+#include "core/string.h"
+#include "core/vector.h"
+
+namespace GPU
+{
+	/**
+	 * Resource state as tracked during command list compilation.
+	 */
+	enum class NullResourceState : i32
+	{
+		COMMON = 0,
+		VERTEX_CONSTANT_BUFFER,
+		INDEX_BUFFER,
+		INDIRECT_ARGUMENT,
+		SHADER_RESOURCE,
+		UNORDERED_ACCESS,
+		RENDER_TARGET,
+		DEPTH_WRITE,
+		DEPTH_READ,
+		COPY_SOURCE,
+		COPY_DEST,
+		PRESENT,
+	};
+
+	struct NullSwapChain
+	{
+		bool alive_ = false;
+		SwapChainDesc desc_;
+	};
+
+	struct NullBuffer
+	{
+		bool alive_ = false;
+		BufferDesc desc_;
+	};
+
+	struct NullTexture
+	{
+		bool alive_ = false;
+		TextureDesc desc_;
+	};
+
+	struct NullShader
+	{
+		bool alive_ = false;
+		ShaderType type_ = ShaderType::INVALID;
+	};
+
+	struct NullGraphicsPipelineState
+	{
+		bool alive_ = false;
+		i32 numRTs_ = 0;
+		Format rtvFormats_[MAX_BOUND_RTVS];
+		Format dsvFormat_ = Format::INVALID;
+	};
+
+	struct NullComputePipelineState
+	{
+		bool alive_ = false;
+	};
+
+	struct NullPipelineBindingSet
+	{
+		bool alive_ = false;
+		bool temporary_ = false;
+		Core::Vector<BindingCBV> cbvs_;
+		Core::Vector<BindingSRV> srvs_;
+		Core::Vector<BindingUAV> uavs_;
+		Core::Vector<SamplerState> samplers_;
+	};
+
+	struct NullDrawBindingSet
+	{
+		bool alive_ = false;
+		DrawBindingSetDesc desc_;
+	};
+
+	struct NullFrameBindingSet
+	{
+		bool alive_ = false;
+		FrameBindingSetDesc desc_;
+		i32 numRTs_ = 0;
+	};
+
+	struct NullCommandList
+	{
+		bool alive_ = false;
+		bool compiled_ = false;
+		CommandQueueType queueType_ = CommandQueueType::NONE;
+		/// Queue the command list was compiled for.
+		CommandQueueType submitQueueType_ = CommandQueueType::NONE;
+		i32 numCommands_ = 0;
+		i32 numTransitions_ = 0;
+		/// Serialized command stream. Only filled in if SetupParams::commandStreamPath_ is set.
+		Core::String stream_;
+	};
+
+	struct NullFence
+	{
+		bool alive_ = false;
+		i64 value_ = 0;
+	};
+
+	/**
+	 * Headless backend.
+	 * Performs no GPU work, but tracks all resources, validates command lists as they
+	 * are compiled, and can serialize compiled command streams to disk. Intended for
+	 * running tests and measuring renderer CPU overhead without a GPU.
+	 */
+	class NullBackend : public IBackend
+	{
+	public:
+		NullBackend(const SetupParams& setupParams);
+		~NullBackend();
+
+		/**
+		 * device operations.
+		 */
+		i32 EnumerateAdapters(AdapterInfo* outAdapters, i32 maxAdapters) override;
+		bool IsInitialized() const override;
+		ErrorCode Initialize(i32 adapterIdx) override;
+
+		/**
+		 * Resource creation/destruction.
+		 */
+		ErrorCode CreateSwapChain(Handle handle, const SwapChainDesc& desc, const char* debugName) override;
+		ErrorCode CreateBuffer(
+		    Handle handle, const BufferDesc& desc, const void* initialData, const char* debugName) override;
+		ErrorCode CreateTexture(Handle handle, const TextureDesc& desc, const TextureSubResourceData* initialData,
+		    const char* debugName) override;
+		ErrorCode CreateShader(Handle handle, const ShaderDesc& desc, const char* debugName) override;
+		ErrorCode CreateGraphicsPipelineState(
+		    Handle handle, const GraphicsPipelineStateDesc& desc, const char* debugName) override;
+		ErrorCode CreateComputePipelineState(
+		    Handle handle, const ComputePipelineStateDesc& desc, const char* debugName) override;
+		ErrorCode CreatePipelineBindingSet(
+		    Handle handle, const PipelineBindingSetDesc& desc, const char* debugName) override;
+		ErrorCode CreateDrawBindingSet(Handle handle, const DrawBindingSetDesc& desc, const char* debugName) override;
+		ErrorCode CreateFrameBindingSet(Handle handle, const FrameBindingSetDesc& desc, const char* debugName) override;
+		ErrorCode CreateCommandList(Handle handle, const char* debugName) override;
+		ErrorCode CreateFence(Handle handle, const char* debugName) override;
+		ErrorCode DestroyResource(Handle handle) override;
+
+		ErrorCode CreateUploadRing(i64 size, void** outAddress) override;
+
+		ErrorCode AllocTemporaryPipelineBindingSet(Handle handle, const PipelineBindingSetDesc& desc) override;
+		ErrorCode UpdatePipelineBindings(Handle pbs, i32 base, Core::ArrayView<const BindingCBV> descs) override;
+		ErrorCode UpdatePipelineBindings(Handle pbs, i32 base, Core::ArrayView<const BindingSRV> descs) override;
+		ErrorCode UpdatePipelineBindings(Handle pbs, i32 base, Core::ArrayView<const BindingUAV> descs) override;
+		ErrorCode UpdatePipelineBindings(Handle pbs, i32 base, Core::ArrayView<const SamplerState> descs) override;
+		ErrorCode CopyPipelineBindings(
+		    Core::ArrayView<const PipelineBinding> dst, Core::ArrayView<const PipelineBinding> src) override;
+		ErrorCode ValidatePipelineBindings(Core::ArrayView<const PipelineBinding> pb) override;
+
+		ErrorCode CompileCommandList(
+		    Handle handle, const CommandList& commandList, CommandQueueType queueType) override;
+		ErrorCode SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType) override;
+
+		ErrorCode SignalFence(CommandQueueType queueType, Handle handle, i64 value) override;
+		ErrorCode WaitOnFence(CommandQueueType queueType, Handle handle, i64 value) override;
+
+		ErrorCode PresentSwapChain(Handle handle) override;
+		ErrorCode ResizeSwapChain(Handle handle, i32 width, i32 height) override;
+
+		void NextFrame() override;
+
+		/**
+		 * @return true if @a handle refers to a live resource in this backend.
+		 */
+		bool IsAlive(Handle handle) const;
+
+		/**
+		 * @return Bind flags a live buffer, texture or swap chain was created with.
+		 */
+		BindFlags GetBindFlags(Handle handle) const;
+
+		/// Resources.
+		Core::RWLock resourceLock_;
+		Core::Vector<NullSwapChain> swapChains_;
+		Core::Vector<NullBuffer> buffers_;
+		Core::Vector<NullTexture> textures_;
+		Core::Vector<NullShader> shaders_;
+		Core::Vector<NullGraphicsPipelineState> graphicsPipelineStates_;
+		Core::Vector<NullComputePipelineState> computePipelineStates_;
+		Core::Vector<NullPipelineBindingSet> pipelineBindingSets_;
+		Core::Vector<NullDrawBindingSet> drawBindingSets_;
+		Core::Vector<NullFrameBindingSet> frameBindingSets_;
+		Core::Vector<NullCommandList> commandLists_;
+		Core::Vector<NullFence> fences_;
+
+		/// Upload ring memory.
+		Core::Vector<u8> uploadRing_;
+
+		/// Command stream output.
+		Core::Mutex streamMutex_;
+		Core::File streamFile_;
+
+		bool isInitialized_ = false;
+		i64 frameIdx_ = 0;
+	};
+} // namespace GPU
@@ -0,0 +1,1070 @@
+#include "gpu_null/null_backend.h"
+#include "gpu/enum.h"
+#include "gpu/utils.h"
+#include "core/debug.h"
+#include "core/map.h"
+#include "core/misc.h"
+#include "core/string.h"
+
+#include <climits>
+#include <cstdarg>
+#include <utility>
+
+extern "C" {
+EXPORT bool GetPlugin(struct Plugin::Plugin* outPlugin, Core::UUID uuid)
+{
+	bool retVal = false;
+
+	// Fill in base info.
+	if(uuid == Plugin::Plugin::GetUUID() || uuid == GPU::BackendPlugin::GetUUID())
+	{
+		if(outPlugin)
+		{
+			outPlugin->systemVersion_ = Plugin::PLUGIN_SYSTEM_VERSION;
+			outPlugin->pluginVersion_ = GPU::BackendPlugin::PLUGIN_VERSION;
+			outPlugin->uuid_ = GPU::BackendPlugin::GetUUID();
+			outPlugin->name_ = "Null Backend";
+			outPlugin->desc_ = "Headless backend for testing & profiling.";
+		}
+		retVal = true;
+	}
+
+	// Fill in plugin specific.
+	if(uuid == GPU::BackendPlugin::GetUUID())
+	{
+		if(outPlugin)
+		{
+			auto* plugin = static_cast<GPU::BackendPlugin*>(outPlugin);
+			plugin->api_ = "NULL";
+			plugin->CreateBackend = [](
+			    const GPU::SetupParams& setupParams) -> GPU::IBackend* { return new GPU::NullBackend(setupParams); };
+			plugin->DestroyBackend = [](GPU::IBackend*& backend) {
+				delete backend;
+				backend = nullptr;
+			};
+		}
+		retVal = true;
+	}
+
+	return retVal;
+}
+}
+
+namespace GPU
+{
+	namespace
+	{
+		const char* GetCommandName(CommandType type)
+		{
+			switch(type)
+			{
+			case CommandType::DRAW:
+				return "Draw";
+			case CommandType::DRAW_INDIRECT:
+				return "DrawIndirect";
+			case CommandType::DISPATCH:
+				return "Dispatch";
+			case CommandType::DISPATCH_INDIRECT:
+				return "DispatchIndirect";
+			case CommandType::CLEAR_RTV:
+				return "ClearRTV";
+			case CommandType::CLEAR_DSV:
+				return "ClearDSV";
+			case CommandType::CLEAR_UAV:
+				return "ClearUAV";
+			case CommandType::UPDATE_BUFFER:
+				return "UpdateBuffer";
+			case CommandType::UPDATE_TEXTURE_SUBRESOURCE:
+				return "UpdateTextureSubResource";
+			case CommandType::COPY_BUFFER:
+				return "CopyBuffer";
+			case CommandType::COPY_TEXTURE_SUBRESOURCE:
+				return "CopyTextureSubResource";
+			case CommandType::BEGIN_EVENT:
+				return "BeginEvent";
+			case CommandType::END_EVENT:
+				return "EndEvent";
+			default:
+				return "INVALID";
+			}
+		}
+
+		const char* GetStateName(NullResourceState state)
+		{
+			switch(state)
+			{
+			case NullResourceState::COMMON:
+				return "COMMON";
+			case NullResourceState::VERTEX_CONSTANT_BUFFER:
+				return "VERTEX_CONSTANT_BUFFER";
+			case NullResourceState::INDEX_BUFFER:
+				return "INDEX_BUFFER";
+			case NullResourceState::INDIRECT_ARGUMENT:
+				return "INDIRECT_ARGUMENT";
+			case NullResourceState::SHADER_RESOURCE:
+				return "SHADER_RESOURCE";
+			case NullResourceState::UNORDERED_ACCESS:
+				return "UNORDERED_ACCESS";
+			case NullResourceState::RENDER_TARGET:
+				return "RENDER_TARGET";
+			case NullResourceState::DEPTH_WRITE:
+				return "DEPTH_WRITE";
+			case NullResourceState::DEPTH_READ:
+				return "DEPTH_READ";
+			case NullResourceState::COPY_SOURCE:
+				return "COPY_SOURCE";
+			case NullResourceState::COPY_DEST:
+				return "COPY_DEST";
+			case NullResourceState::PRESENT:
+				return "PRESENT";
+			default:
+				return "INVALID";
+			}
+		}
+
+		template<typename TYPE>
+		TYPE& AllocResource(Core::Vector<TYPE>& pool, Handle handle)
+		{
+			if(pool.size() <= handle.GetIndex())
+				pool.resize(Core::PotRoundUp(handle.GetIndex() + 1, 32));
+			auto& res = pool[handle.GetIndex()];
+			res = TYPE();
+			res.alive_ = true;
+			return res;
+		}
+
+		template<typename TYPE>
+		TYPE* GetResource(Core::Vector<TYPE>& pool, Handle handle)
+		{
+			if(handle.GetIndex() < pool.size() && pool[handle.GetIndex()].alive_)
+				return &pool[handle.GetIndex()];
+			return nullptr;
+		}
+
+		template<typename TYPE>
+		const TYPE* GetResource(const Core::Vector<TYPE>& pool, Handle handle)
+		{
+			if(handle.GetIndex() < pool.size() && pool[handle.GetIndex()].alive_)
+				return &pool[handle.GetIndex()];
+			return nullptr;
+		}
+
+		template<typename TYPE>
+		ErrorCode FreeResource(Core::Vector<TYPE>& pool, Handle handle)
+		{
+			if(auto* res = GetResource(pool, handle))
+			{
+				*res = TYPE();
+				return ErrorCode::OK;
+			}
+			return ErrorCode::FAIL;
+		}
+
+		/**
+		 * Validates a command list, and tracks resource states across it.
+		 */
+		class NullCompileContext
+		{
+		public:
+			NullCompileContext(const NullBackend& backend, NullCommandList& outCommandList, bool writeStream)
+			    : backend_(backend)
+			    , outCommandList_(outCommandList)
+			    , writeStream_(writeStream)
+			{
+			}
+
+			ErrorCode CompileCommandList(const CommandList& commandList)
+			{
+				outCommandList_.compiled_ = false;
+				outCommandList_.queueType_ = commandList.GetType();
+				outCommandList_.numCommands_ = 0;
+				outCommandList_.numTransitions_ = 0;
+				outCommandList_.stream_.clear();
+
+				i32 eventDepth = 0;
+				for(const auto* command : commandList)
+				{
+					Stream("%s\n", GetCommandName(command->type_));
+
+#define CASE_COMMAND(TYPE_STRUCT)                                                                                      \
+	case TYPE_STRUCT::TYPE:                                                                                            \
+		Validate(*static_cast<const TYPE_STRUCT*>(command));                                                           \
+		break
+
+					switch(command->type_)
+					{
+						CASE_COMMAND(CommandDraw);
+						CASE_COMMAND(CommandDrawIndirect);
+						CASE_COMMAND(CommandDispatch);
+						CASE_COMMAND(CommandDispatchIndirect);
+						CASE_COMMAND(CommandClearRTV);
+						CASE_COMMAND(CommandClearDSV);
+						CASE_COMMAND(CommandClearUAV);
+						CASE_COMMAND(CommandUpdateBuffer);
+						CASE_COMMAND(CommandUpdateTextureSubResource);
+						CASE_COMMAND(CommandCopyBuffer);
+						CASE_COMMAND(CommandCopyTextureSubResource);
+					case CommandType::BEGIN_EVENT:
+						eventDepth++;
+						break;
+					case CommandType::END_EVENT:
+						if(--eventDepth < 0)
+							Error("EndEvent without matching BeginEvent.");
+						break;
+					default:
+						Error("Unknown command type %i.", (i32)command->type_);
+						break;
+					}
+#undef CASE_COMMAND
+
+					outCommandList_.numCommands_++;
+					if(numErrors_ > 0)
+						return ErrorCode::FAIL;
+				}
+
+				if(eventDepth != 0)
+					Error("%i unterminated events.", eventDepth);
+
+				// Return everything to common state at the end of the command list.
+				for(auto state : states_)
+					TransitionKey(state.key, NullResourceState::COMMON);
+
+				outCommandList_.compiled_ = numErrors_ == 0;
+				return numErrors_ == 0 ? ErrorCode::OK : ErrorCode::FAIL;
+			}
+
+		private:
+			void Stream(const char* format, ...)
+			{
+				if(writeStream_)
+				{
+					va_list argList;
+					va_start(argList, format);
+					Core::String str;
+					str.Printfv(format, argList);
+					va_end(argList);
+					outCommandList_.stream_.append(str);
+				}
+			}
+
+			void Error(const char* format, ...)
+			{
+				Core::String msg;
+				va_list argList;
+				va_start(argList, format);
+				msg.Printfv(format, argList);
+				va_end(argList);
+				Core::Log("gpu_null: Command %i: %s\n", outCommandList_.numCommands_, msg.c_str());
+				numErrors_++;
+			}
+
+			bool ValidateHandle(Handle handle, ResourceType type, const char* what)
+			{
+				if(!handle)
+				{
+					Error("%s: Null handle.", what);
+					return false;
+				}
+				if(handle.GetType() != type)
+				{
+					Error("%s: Handle is type %i, expected %i.", what, (i32)handle.GetType(), (i32)type);
+					return false;
+				}
+				if(!backend_.IsAlive(handle))
+				{
+					Error("%s: Handle [%i, %i] is not a live resource.", what, handle.GetIndex(), (i32)type);
+					return false;
+				}
+				return true;
+			}
+
+			bool ValidateResource(Handle handle, BindFlags requiredFlags, const char* what)
+			{
+				if(!handle)
+				{
+					Error("%s: Null handle.", what);
+					return false;
+				}
+				if(handle.GetType() != ResourceType::BUFFER && handle.GetType() != ResourceType::TEXTURE &&
+				    handle.GetType() != ResourceType::SWAP_CHAIN)
+				{
+					Error("%s: Handle is type %i, expected a buffer or texture.", what, (i32)handle.GetType());
+					return false;
+				}
+				if(!backend_.IsAlive(handle))
+				{
+					Error("%s: Handle [%i, %i] is not a live resource.", what, handle.GetIndex(),
+					    (i32)handle.GetType());
+					return false;
+				}
+				if(!Core::ContainsAllFlags(backend_.GetBindFlags(handle), requiredFlags))
+				{
+					Error("%s: Resource [%i, %i] created without required bind flags (0x%x).", what,
+					    handle.GetIndex(), (i32)handle.GetType(), (u32)requiredFlags);
+					return false;
+				}
+				return true;
+			}
+
+			void TransitionKey(i32 key, NullResourceState state)
+			{
+				auto* prevState = states_.find(key);
+				const NullResourceState before = prevState ? *prevState : NullResourceState::COMMON;
+				if(before != state)
+				{
+					Stream("  Transition 0x%08x: %s -> %s\n", key, GetStateName(before), GetStateName(state));
+					outCommandList_.numTransitions_++;
+					states_[key] = state;
+				}
+			}
+
+			void Transition(Handle handle, NullResourceState state)
+			{
+				if(handle)
+					TransitionKey(handle.GetCombined(), state);
+			}
+
+			void ValidatePipelineBindings(Core::ArrayView<PipelineBinding> pipelineBindings)
+			{
+				for(const auto& pb : pipelineBindings)
+				{
+					if(!ValidateHandle(pb.pbs_, ResourceType::PIPELINE_BINDING_SET, "PipelineBinding"))
+						continue;
+
+					const auto* pbs = GetResource(backend_.pipelineBindingSets_, pb.pbs_);
+					const auto ValidateRange = [this](const PipelineBinding::Range& range, i32 size, const char* what) {
+						if(range.srcOffset_ < 0 || range.num_ < 0 || (range.srcOffset_ + range.num_) > size)
+						{
+							Error("PipelineBinding: %s range [%i, %i) out of bounds (%i).", what, range.srcOffset_,
+							    range.srcOffset_ + range.num_, size);
+							return false;
+						}
+						return true;
+					};
+
+					if(ValidateRange(pb.cbvs_, pbs->cbvs_.size(), "CBV"))
+						for(i32 idx = pb.cbvs_.srcOffset_; idx < (pb.cbvs_.srcOffset_ + pb.cbvs_.num_); ++idx)
+							if(auto res = pbs->cbvs_[idx].resource_)
+								if(ValidateResource(res, BindFlags::CONSTANT_BUFFER, "CBV"))
+									Transition(res, NullResourceState::VERTEX_CONSTANT_BUFFER);
+
+					if(ValidateRange(pb.srvs_, pbs->srvs_.size(), "SRV"))
+						for(i32 idx = pb.srvs_.srcOffset_; idx < (pb.srvs_.srcOffset_ + pb.srvs_.num_); ++idx)
+							if(auto res = pbs->srvs_[idx].resource_)
+								if(ValidateResource(res, BindFlags::SHADER_RESOURCE, "SRV"))
+									Transition(res, NullResourceState::SHADER_RESOURCE);
+
+					if(ValidateRange(pb.uavs_, pbs->uavs_.size(), "UAV"))
+						for(i32 idx = pb.uavs_.srcOffset_; idx < (pb.uavs_.srcOffset_ + pb.uavs_.num_); ++idx)
+							if(auto res = pbs->uavs_[idx].resource_)
+								if(ValidateResource(res, BindFlags::UNORDERED_ACCESS, "UAV"))
+									Transition(res, NullResourceState::UNORDERED_ACCESS);
+
+					ValidateRange(pb.samplers_, pbs->samplers_.size(), "Sampler");
+				}
+			}
+
+			void ValidateDrawBinding(Handle drawBinding)
+			{
+				if(!drawBinding)
+					return;
+				if(!ValidateHandle(drawBinding, ResourceType::DRAW_BINDING_SET, "DrawBinding"))
+					return;
+
+				const auto* dbs = GetResource(backend_.drawBindingSets_, drawBinding);
+				for(const auto& vb : dbs->desc_.vbs_)
+					if(vb.resource_ && ValidateResource(vb.resource_, BindFlags::VERTEX_BUFFER, "VertexBuffer"))
+						Transition(vb.resource_, NullResourceState::VERTEX_CONSTANT_BUFFER);
+				if(dbs->desc_.ib_.resource_ &&
+				    ValidateResource(dbs->desc_.ib_.resource_, BindFlags::INDEX_BUFFER, "IndexBuffer"))
+					Transition(dbs->desc_.ib_.resource_, NullResourceState::INDEX_BUFFER);
+			}
+
+			const NullFrameBindingSet* ValidateFrameBinding(Handle frameBinding)
+			{
+				if(!ValidateHandle(frameBinding, ResourceType::FRAME_BINDING_SET, "FrameBinding"))
+					return nullptr;
+
+				const auto* fbs = GetResource(backend_.frameBindingSets_, frameBinding);
+				for(i32 idx = 0; idx < fbs->numRTs_; ++idx)
+				{
+					const auto res = fbs->desc_.rtvs_[idx].resource_;
+					if(ValidateResource(res, BindFlags::RENDER_TARGET, "RTV"))
+						Transition(res, NullResourceState::RENDER_TARGET);
+				}
+				if(const auto res = fbs->desc_.dsv_.resource_)
+				{
+					const bool readOnly = Core::ContainsAllFlags(
+					    fbs->desc_.dsv_.flags_, DSVFlags::READ_ONLY_DEPTH | DSVFlags::READ_ONLY_STENCIL);
+					if(ValidateResource(res, BindFlags::DEPTH_STENCIL, "DSV"))
+						Transition(res, readOnly ? NullResourceState::DEPTH_READ : NullResourceState::DEPTH_WRITE);
+				}
+				return fbs;
+			}
+
+			void ValidateIndirect(Handle indirectBuffer, i32 argByteOffset, i32 argStride, Handle countBuffer,
+			    i32 countByteOffset, i32 maxCommands)
+			{
+				if(ValidateResource(indirectBuffer, BindFlags::INDIRECT_BUFFER, "IndirectBuffer"))
+				{
+					Transition(indirectBuffer, NullResourceState::INDIRECT_ARGUMENT);
+					if(maxCommands > 0)
+						ValidateBufferRange(
+						    indirectBuffer, argByteOffset, (i64)argStride * maxCommands, "IndirectBuffer");
+				}
+				if(countBuffer && ValidateResource(countBuffer, BindFlags::INDIRECT_BUFFER, "CountBuffer"))
+				{
+					Transition(countBuffer, NullResourceState::INDIRECT_ARGUMENT);
+					ValidateBufferRange(countBuffer, countByteOffset, sizeof(u32), "CountBuffer");
+				}
+				if(maxCommands <= 0)
+					Error("maxCommands (%i) must be > 0.", maxCommands);
+			}
+
+			void ValidateGraphicsPipeline(Handle pipelineState, const NullFrameBindingSet* fbs)
+			{
+				if(!ValidateHandle(pipelineState, ResourceType::GRAPHICS_PIPELINE_STATE, "PipelineState"))
+					return;
+
+				const auto* gps = GetResource(backend_.graphicsPipelineStates_, pipelineState);
+				if(fbs && gps->numRTs_ != fbs->numRTs_)
+					Error("PipelineState has %i RTs, FrameBinding has %i.", gps->numRTs_, fbs->numRTs_);
+			}
+
+			void Validate(const CommandDraw& command)
+			{
+				const auto* fbs = ValidateFrameBinding(command.frameBinding_);
+				ValidateGraphicsPipeline(command.pipelineState_, fbs);
+				ValidatePipelineBindings(command.pipelineBindings_);
+				ValidateDrawBinding(command.drawBinding_);
+				if(command.noofVertices_ <= 0 || command.noofInstances_ <= 0)
+					Error("Draw with %i vertices, %i instances.", command.noofVertices_, command.noofInstances_);
+			}
+
+			void Validate(const CommandDrawIndirect& command)
+			{
+				const auto* fbs = ValidateFrameBinding(command.frameBinding_);
+				ValidateGraphicsPipeline(command.pipelineState_, fbs);
+				ValidatePipelineBindings(command.pipelineBindings_);
+				ValidateDrawBinding(command.drawBinding_);
+
+				// Argument layout depends on draw binding (indexed or not) and drawIds_ (DRAW_ID_ROOT_PARAMETER).
+				bool indexed = false;
+				if(command.drawBinding_ && backend_.IsAlive(command.drawBinding_))
+					indexed = !!GetResource(backend_.drawBindingSets_, command.drawBinding_)->desc_.ib_.resource_;
+				i32 argStride = indexed ? sizeof(DrawIndexedArgs) : sizeof(DrawArgs);
+				if(command.drawIds_)
+					argStride = indexed ? sizeof(DrawIndexedIdArgs) : sizeof(DrawIdArgs);
+				ValidateIndirect(command.indirectBuffer_, command.argByteOffset_, argStride, command.countBuffer_,
+				    command.countByteOffset_, command.maxCommands_);
+			}
+
+			void Validate(const CommandDispatch& command)
+			{
+				ValidateHandle(command.pipelineState_, ResourceType::COMPUTE_PIPELINE_STATE, "PipelineState");
+				ValidatePipelineBindings(command.pipelineBindings_);
+				if(command.xGroups_ <= 0 || command.yGroups_ <= 0 || command.zGroups_ <= 0)
+					Error("Dispatch with %i x %i x %i groups.", command.xGroups_, command.yGroups_, command.zGroups_);
+			}
+
+			void Validate(const CommandDispatchIndirect& command)
+			{
+				ValidateHandle(command.pipelineState_, ResourceType::COMPUTE_PIPELINE_STATE, "PipelineState");
+				ValidatePipelineBindings(command.pipelineBindings_);
+				ValidateIndirect(command.indirectBuffer_, command.argByteOffset_, sizeof(DispatchArgs),
+				    command.countBuffer_, command.countByteOffset_, command.maxCommands_);
+			}
+
+			void Validate(const CommandClearRTV& command)
+			{
+				if(const auto* fbs = ValidateFrameBinding(command.frameBinding_))
+					if(command.rtvIdx_ < 0 || command.rtvIdx_ >= fbs->numRTs_)
+						Error("ClearRTV index %i out of bounds (%i).", command.rtvIdx_, fbs->numRTs_);
+			}
+
+			void Validate(const CommandClearDSV& command)
+			{
+				if(const auto* fbs = ValidateFrameBinding(command.frameBinding_))
+					if(!fbs->desc_.dsv_.resource_)
+						Error("ClearDSV on frame binding with no DSV.");
+			}
+
+			void Validate(const CommandClearUAV& command)
+			{
+				if(!ValidateHandle(command.pipelineBinding_, ResourceType::PIPELINE_BINDING_SET, "PipelineBinding"))
+					return;
+				const auto* pbs = GetResource(backend_.pipelineBindingSets_, command.pipelineBinding_);
+				if(command.uavIdx_ < 0 || command.uavIdx_ >= pbs->uavs_.size())
+					Error("ClearUAV index %i out of bounds (%i).", command.uavIdx_, pbs->uavs_.size());
+				else if(ValidateResource(pbs->uavs_[command.uavIdx_].resource_, BindFlags::UNORDERED_ACCESS, "UAV"))
+					Transition(pbs->uavs_[command.uavIdx_].resource_, NullResourceState::UNORDERED_ACCESS);
+			}
+
+			void ValidateBufferRange(Handle handle, i64 offset, i64 size, const char* what)
+			{
+				if(!ValidateHandle(handle, ResourceType::BUFFER, what))
+					return;
+				const auto* buffer = GetResource(backend_.buffers_, handle);
+				if(offset < 0 || size <= 0 || (offset + size) > buffer->desc_.size_)
+					Error("%s: Range [%lld, %lld) out of bounds (%lld).", what, offset, offset + size,
+					    buffer->desc_.size_);
+			}
+
+			void ValidateSubResource(Handle handle, i32 subResourceIdx, const char* what)
+			{
+				if(!ValidateHandle(handle, ResourceType::TEXTURE, what))
+					return;
+				const auto& desc = GetResource(backend_.textures_, handle)->desc_;
+				const i32 numFaces = desc.type_ == TextureType::TEXCUBE ? 6 : 1;
+				const i32 numSubResources = desc.levels_ * desc.elements_ * numFaces;
+				if(subResourceIdx < 0 || subResourceIdx >= numSubResources)
+					Error("%s: Subresource %i out of bounds (%i).", what, subResourceIdx, numSubResources);
+			}
+
+			void ValidateUploadRange(i64 offset, i64 size, const void* data, const char* what)
+			{
+				const auto& uploadRing = backend_.uploadRing_;
+				if(offset < 0 || (offset + size) > uploadRing.size())
+					Error("%s: Upload range [%lld, %lld) out of bounds (%i).", what, offset, offset + size,
+					    uploadRing.size());
+				else if(data != uploadRing.data() + offset)
+					Error("%s: Data doesn't match upload offset %lld.", what, offset);
+			}
+
+			void Validate(const CommandUpdateBuffer& command)
+			{
+				ValidateBufferRange(command.buffer_, command.offset_, command.size_, "UpdateBuffer");
+				if(command.data_ == nullptr)
+					Error("UpdateBuffer: No data.");
+				if(command.uploadOffset_ >= 0)
+					ValidateUploadRange(command.uploadOffset_, command.size_, command.data_, "UpdateBuffer");
+				Transition(command.buffer_, NullResourceState::COPY_DEST);
+			}
+
+			void Validate(const CommandUpdateTextureSubResource& command)
+			{
+				ValidateSubResource(command.texture_, command.subResourceIdx_, "UpdateTextureSubResource");
+				if(command.data_.data_ == nullptr)
+					Error("UpdateTextureSubResource: No data.");
+				if(command.uploadOffset_ >= 0)
+				{
+					if((command.uploadOffset_ % UPLOAD_TEXTURE_DATA_ALIGNMENT) != 0)
+						Error("UpdateTextureSubResource: Upload offset %lld not aligned to %i.", command.uploadOffset_,
+						    UPLOAD_TEXTURE_DATA_ALIGNMENT);
+					ValidateUploadRange(command.uploadOffset_, command.data_.slicePitch_, command.data_.data_,
+					    "UpdateTextureSubResource");
+				}
+				Transition(command.texture_, NullResourceState::COPY_DEST);
+			}
+
+			void Validate(const CommandCopyBuffer& command)
+			{
+				ValidateBufferRange(command.dstBuffer_, command.dstOffset_, command.srcSize_, "CopyBuffer dst");
+				ValidateBufferRange(command.srcBuffer_, command.srcOffset_, command.srcSize_, "CopyBuffer src");
+				if(command.dstBuffer_ == command.srcBuffer_)
+					Error("CopyBuffer: Source and destination are the same buffer.");
+				Transition(command.dstBuffer_, NullResourceState::COPY_DEST);
+				Transition(command.srcBuffer_, NullResourceState::COPY_SOURCE);
+			}
+
+			void Validate(const CommandCopyTextureSubResource& command)
+			{
+				ValidateSubResource(command.dstTexture_, command.dstSubResourceIdx_, "CopyTextureSubResource dst");
+				ValidateSubResource(command.srcTexture_, command.srcSubResourceIdx_, "CopyTextureSubResource src");
+				Transition(command.dstTexture_, NullResourceState::COPY_DEST);
+				Transition(command.srcTexture_, NullResourceState::COPY_SOURCE);
+			}
+
+			const NullBackend& backend_;
+			NullCommandList& outCommandList_;
+			bool writeStream_ = false;
+			i32 numErrors_ = 0;
+			Core::Map<i32, NullResourceState> states_;
+		};
+	}
+
+	NullBackend::NullBackend(const SetupParams& setupParams)
+	{
+		if(setupParams.commandStreamPath_)
+		{
+			streamFile_ = Core::File(setupParams.commandStreamPath_, Core::FileFlags::DEFAULT_WRITE);
+			DBG_ASSERT_MSG(!!streamFile_, "Unable to open \"%s\" for writing.", setupParams.commandStreamPath_);
+		}
+	}
+
+	NullBackend::~NullBackend()
+	{
+#if !defined(_RELEASE)
+		// Report any leaked resources.
+		auto ReportLeaks = [](const auto& pool, const char* name) {
+			i32 numLeaked = 0;
+			for(const auto& res : pool)
+				numLeaked += res.alive_ ? 1 : 0;
+			if(numLeaked > 0)
+				Core::Log("gpu_null: %i %s resources still alive on shutdown.\n", numLeaked, name);
+		};
+		ReportLeaks(swapChains_, "SwapChain");
+		ReportLeaks(buffers_, "Buffer");
+		ReportLeaks(textures_, "Texture");
+		ReportLeaks(shaders_, "Shader");
+		ReportLeaks(graphicsPipelineStates_, "GraphicsPipelineState");
+		ReportLeaks(computePipelineStates_, "ComputePipelineState");
+		ReportLeaks(drawBindingSets_, "DrawBindingSet");
+		ReportLeaks(frameBindingSets_, "FrameBindingSet");
+		ReportLeaks(commandLists_, "CommandList");
+		ReportLeaks(fences_, "Fence");
+#endif
+	}
+
+	i32 NullBackend::EnumerateAdapters(AdapterInfo* outAdapters, i32 maxAdapters)
+	{
+		if(outAdapters && maxAdapters > 0)
+		{
+			AdapterInfo& info = outAdapters[0];
+			info = AdapterInfo();
+			strcpy_s(info.description_, sizeof(info.description_), "Null Adapter");
+			info.vendorId_ = 0;
+			info.deviceId_ = 0;
+			info.subSysId_ = 0;
+			info.revision_ = 0;
+			info.dedicatedVideoMemory_ = 0;
+			info.dedicatedSystemMemory_ = 0;
+			info.sharedSystemMemory_ = 0;
+		}
+		return 1;
+	}
+
+	bool NullBackend::IsInitialized() const { return isInitialized_; }
+
+	ErrorCode NullBackend::Initialize(i32 adapterIdx)
+	{
+		if(adapterIdx != 0)
+			return ErrorCode::FAIL;
+		isInitialized_ = true;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateSwapChain(Handle handle, const SwapChainDesc& desc, const char* debugName)
+	{
+		if(desc.width_ <= 0 || desc.height_ <= 0 || desc.bufferCount_ <= 0)
+			return ErrorCode::FAIL;
+
+		Core::ScopedWriteLock lock(resourceLock_);
+		AllocResource(swapChains_, handle).desc_ = desc;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateBuffer(
+	    Handle handle, const BufferDesc& desc, const void* initialData, const char* debugName)
+	{
+		if(desc.size_ <= 0)
+			return ErrorCode::FAIL;
+
+		Core::ScopedWriteLock lock(resourceLock_);
+		AllocResource(buffers_, handle).desc_ = desc;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateTexture(
+	    Handle handle, const TextureDesc& desc, const TextureSubResourceData* initialData, const char* debugName)
+	{
+		if(desc.type_ == TextureType::INVALID || desc.format_ == Format::INVALID || desc.width_ <= 0 ||
+		    desc.height_ <= 0 || desc.depth_ <= 0 || desc.levels_ <= 0 || desc.elements_ <= 0)
+			return ErrorCode::FAIL;
+
+		Core::ScopedWriteLock lock(resourceLock_);
+		AllocResource(textures_, handle).desc_ = desc;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateShader(Handle handle, const ShaderDesc& desc, const char* debugName)
+	{
+		if(desc.type_ == ShaderType::INVALID || desc.data_ == nullptr || desc.dataSize_ <= 0)
+			return ErrorCode::FAIL;
+
+		Core::ScopedWriteLock lock(resourceLock_);
+		AllocResource(shaders_, handle).type_ = desc.type_;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateGraphicsPipelineState(
+	    Handle handle, const GraphicsPipelineStateDesc& desc, const char* debugName)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		for(auto shader : desc.shaders_)
+			if(shader && GetResource(shaders_, shader) == nullptr)
+				return ErrorCode::FAIL;
+
+		auto& gps = AllocResource(graphicsPipelineStates_, handle);
+		gps.numRTs_ = desc.numRTs_;
+		memcpy(gps.rtvFormats_, desc.rtvFormats_, sizeof(gps.rtvFormats_));
+		gps.dsvFormat_ = desc.dsvFormat_;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateComputePipelineState(
+	    Handle handle, const ComputePipelineStateDesc& desc, const char* debugName)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		const auto* shader = GetResource(shaders_, desc.shader_);
+		if(shader == nullptr || shader->type_ != ShaderType::CS)
+			return ErrorCode::FAIL;
+
+		AllocResource(computePipelineStates_, handle);
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreatePipelineBindingSet(
+	    Handle handle, const PipelineBindingSetDesc& desc, const char* debugName)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		auto& pbs = AllocResource(pipelineBindingSets_, handle);
+		pbs.cbvs_.resize(desc.numCBVs_);
+		pbs.srvs_.resize(desc.numSRVs_);
+		pbs.uavs_.resize(desc.numUAVs_);
+		pbs.samplers_.resize(desc.numSamplers_);
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateDrawBindingSet(Handle handle, const DrawBindingSetDesc& desc, const char* debugName)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		AllocResource(drawBindingSets_, handle).desc_ = desc;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateFrameBindingSet(Handle handle, const FrameBindingSetDesc& desc, const char* debugName)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		auto& fbs = AllocResource(frameBindingSets_, handle);
+		fbs.desc_ = desc;
+		for(i32 idx = 0; idx < MAX_BOUND_RTVS; ++idx)
+		{
+			if(!desc.rtvs_[idx].resource_)
+				break;
+			fbs.numRTs_++;
+		}
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateCommandList(Handle handle, const char* debugName)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		AllocResource(commandLists_, handle);
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CreateFence(Handle handle, const char* debugName)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		AllocResource(fences_, handle);
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::DestroyResource(Handle handle)
+	{
+		Core::ScopedWriteLock lock(resourceLock_);
+		switch(handle.GetType())
+		{
+		case ResourceType::SWAP_CHAIN:
+			return FreeResource(swapChains_, handle);
+		case ResourceType::BUFFER:
+			return FreeResource(buffers_, handle);
+		case ResourceType::TEXTURE:
+			return FreeResource(textures_, handle);
+		case ResourceType::SHADER:
+			return FreeResource(shaders_, handle);
+		case ResourceType::GRAPHICS_PIPELINE_STATE:
+			return FreeResource(graphicsPipelineStates_, handle);
+		case ResourceType::COMPUTE_PIPELINE_STATE:
+			return FreeResource(computePipelineStates_, handle);
+		case ResourceType::PIPELINE_BINDING_SET:
+			return FreeResource(pipelineBindingSets_, handle);
+		case ResourceType::DRAW_BINDING_SET:
+			return FreeResource(drawBindingSets_, handle);
+		case ResourceType::FRAME_BINDING_SET:
+			return FreeResource(frameBindingSets_, handle);
+		case ResourceType::COMMAND_LIST:
+			return FreeResource(commandLists_, handle);
+		case ResourceType::FENCE:
+			return FreeResource(fences_, handle);
+		default:
+			return ErrorCode::UNIMPLEMENTED;
+		}
+	}
+
+	ErrorCode NullBackend::CreateUploadRing(i64 size, void** outAddress)
+	{
+		if(size <= 0 || size > INT_MAX || uploadRing_.size() > 0)
+			return ErrorCode::FAIL;
+		uploadRing_.resize((i32)size);
+		*outAddress = uploadRing_.data();
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::AllocTemporaryPipelineBindingSet(Handle handle, const PipelineBindingSetDesc& desc)
+	{
+		auto retVal = CreatePipelineBindingSet(handle, desc, nullptr);
+		if(retVal == ErrorCode::OK)
+		{
+			Core::ScopedWriteLock lock(resourceLock_);
+			pipelineBindingSets_[handle.GetIndex()].temporary_ = true;
+		}
+		return retVal;
+	}
+
+	template<typename TYPE>
+	static ErrorCode UpdateBindings(Core::Vector<TYPE>& dst, i32 base, Core::ArrayView<const TYPE> descs)
+	{
+		if(base < 0 || (base + descs.size()) > dst.size())
+			return ErrorCode::FAIL;
+		for(i32 idx = 0; idx < descs.size(); ++idx)
+			dst[base + idx] = descs[idx];
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingCBV> descs)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		auto* pbs = GetResource(pipelineBindingSets_, handle);
+		return pbs ? UpdateBindings(pbs->cbvs_, base, descs) : ErrorCode::FAIL;
+	}
+
+	ErrorCode NullBackend::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingSRV> descs)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		auto* pbs = GetResource(pipelineBindingSets_, handle);
+		return pbs ? UpdateBindings(pbs->srvs_, base, descs) : ErrorCode::FAIL;
+	}
+
+	ErrorCode NullBackend::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const BindingUAV> descs)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		auto* pbs = GetResource(pipelineBindingSets_, handle);
+		return pbs ? UpdateBindings(pbs->uavs_, base, descs) : ErrorCode::FAIL;
+	}
+
+	ErrorCode NullBackend::UpdatePipelineBindings(Handle handle, i32 base, Core::ArrayView<const SamplerState> descs)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		auto* pbs = GetResource(pipelineBindingSets_, handle);
+		return pbs ? UpdateBindings(pbs->samplers_, base, descs) : ErrorCode::FAIL;
+	}
+
+	template<typename TYPE>
+	static ErrorCode CopyBindings(Core::Vector<TYPE>& dst, const PipelineBinding::Range& dstRange,
+	    const Core::Vector<TYPE>& src, const PipelineBinding::Range& srcRange)
+	{
+		if(dstRange.num_ != srcRange.num_)
+			return ErrorCode::FAIL;
+		if(srcRange.srcOffset_ < 0 || (srcRange.srcOffset_ + srcRange.num_) > src.size())
+			return ErrorCode::FAIL;
+		if(dstRange.dstOffset_ < 0 || (dstRange.dstOffset_ + dstRange.num_) > dst.size())
+			return ErrorCode::FAIL;
+		for(i32 idx = 0; idx < srcRange.num_; ++idx)
+			dst[dstRange.dstOffset_ + idx] = src[srcRange.srcOffset_ + idx];
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CopyPipelineBindings(
+	    Core::ArrayView<const PipelineBinding> dst, Core::ArrayView<const PipelineBinding> src)
+	{
+		if(dst.size() != src.size())
+			return ErrorCode::FAIL;
+
+		Core::ScopedReadLock lock(resourceLock_);
+		for(i32 idx = 0; idx < dst.size(); ++idx)
+		{
+			auto* dstPbs = GetResource(pipelineBindingSets_, dst[idx].pbs_);
+			const auto* srcPbs = GetResource(pipelineBindingSets_, src[idx].pbs_);
+			if(dstPbs == nullptr || srcPbs == nullptr)
+				return ErrorCode::FAIL;
+
+			ErrorCode retVal = ErrorCode::OK;
+			if((retVal = CopyBindings(dstPbs->cbvs_, dst[idx].cbvs_, srcPbs->cbvs_, src[idx].cbvs_)) != ErrorCode::OK)
+				return retVal;
+			if((retVal = CopyBindings(dstPbs->srvs_, dst[idx].srvs_, srcPbs->srvs_, src[idx].srvs_)) != ErrorCode::OK)
+				return retVal;
+			if((retVal = CopyBindings(dstPbs->uavs_, dst[idx].uavs_, srcPbs->uavs_, src[idx].uavs_)) != ErrorCode::OK)
+				return retVal;
+			if((retVal = CopyBindings(dstPbs->samplers_, dst[idx].samplers_, srcPbs->samplers_, src[idx].samplers_)) !=
+			    ErrorCode::OK)
+				return retVal;
+		}
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::ValidatePipelineBindings(Core::ArrayView<const PipelineBinding> pb)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		for(const auto& binding : pb)
+			if(GetResource(pipelineBindingSets_, binding.pbs_) == nullptr)
+				return ErrorCode::FAIL;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::CompileCommandList(
+	    Handle handle, const CommandList& commandList, CommandQueueType queueType)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		auto* outCommandList = GetResource(commandLists_, handle);
+		if(outCommandList == nullptr)
+			return ErrorCode::FAIL;
+
+		if(queueType == CommandQueueType::COMPUTE &&
+		    Core::ContainsAnyFlags(commandList.GetType(), CommandQueueType::GRAPHICS))
+		{
+			Core::Log("gpu_null: Compiling graphics command list [%i] for compute queue.\n", handle.GetIndex());
+			return ErrorCode::FAIL;
+		}
+
+		NullCompileContext context(*this, *outCommandList, !!streamFile_);
+		RETURN_ON_ERROR(context.CompileCommandList(commandList));
+		outCommandList->submitQueueType_ = queueType;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::SubmitCommandLists(Core::ArrayView<Handle> handles, CommandQueueType queueType)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		for(auto handle : handles)
+		{
+			const auto* commandList = GetResource(commandLists_, handle);
+			if(commandList == nullptr || !commandList->compiled_)
+			{
+				Core::Log("gpu_null: Submitting command list [%i] that is not compiled.\n", handle.GetIndex());
+				return ErrorCode::FAIL;
+			}
+
+			if(queueType != commandList->submitQueueType_)
+			{
+				Core::Log("gpu_null: Submitting command list [%i] to a queue it wasn't compiled for.\n",
+				    handle.GetIndex());
+				return ErrorCode::FAIL;
+			}
+		}
+
+		if(streamFile_)
+		{
+			Core::ScopedMutex streamLock(streamMutex_);
+			for(auto handle : handles)
+			{
+				const auto* commandList = GetResource(commandLists_, handle);
+				Core::String header;
+				header.Printf("# Frame %lld, %s queue, command list [%i], %i commands, %i transitions\n", frameIdx_,
+				    queueType == CommandQueueType::COMPUTE ? "compute" : "graphics", handle.GetIndex(),
+				    commandList->numCommands_, commandList->numTransitions_);
+				streamFile_.Write(header.c_str(), header.size());
+				streamFile_.Write(commandList->stream_.c_str(), commandList->stream_.size());
+			}
+		}
+
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::SignalFence(CommandQueueType queueType, Handle handle, i64 value)
+	{
+		// Write lock, as WaitOnFence reads the value under a read lock.
+		Core::ScopedWriteLock lock(resourceLock_);
+		auto* fence = GetResource(fences_, handle);
+		if(fence == nullptr)
+			return ErrorCode::FAIL;
+
+		// Work completes on submission, so signal immediately.
+		fence->value_ = value;
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::WaitOnFence(CommandQueueType queueType, Handle handle, i64 value)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		const auto* fence = GetResource(fences_, handle);
+		if(fence == nullptr)
+			return ErrorCode::FAIL;
+
+		// Waiting on a value that has not been signalled would deadlock a real queue.
+		if(fence->value_ < value)
+		{
+			Core::Log("gpu_null: Waiting on fence [%i] for value %lld, but it has only been signalled to %lld.\n",
+			    handle.GetIndex(), value, fence->value_);
+			return ErrorCode::FAIL;
+		}
+		return ErrorCode::OK;
+	}
+
+	ErrorCode NullBackend::PresentSwapChain(Handle handle)
+	{
+		Core::ScopedReadLock lock(resourceLock_);
+		return GetResource(swapChains_, handle) ? ErrorCode::OK : ErrorCode::FAIL;
+	}
+
+	ErrorCode NullBackend::ResizeSwapChain(Handle handle, i32 width, i32 height)
+	{
+		if(width <= 0 || height <= 0)
+			return ErrorCode::FAIL;
+
+		Core::ScopedWriteLock lock(resourceLock_);
+		auto* swapChain = GetResource(swapChains_, handle);
+		if(swapChain == nullptr)
+			return ErrorCode::FAIL;
+		swapChain->desc_.width_ = width;
+		swapChain->desc_.height_ = height;
+		return ErrorCode::OK;
+	}
+
+	void NullBackend::NextFrame() { frameIdx_++; }
+
+	bool NullBackend::IsAlive(Handle handle) const
+	{
+		switch(handle.GetType())
+		{
+		case ResourceType::SWAP_CHAIN:
+			return GetResource(swapChains_, handle) != nullptr;
+		case ResourceType::BUFFER:
+			return GetResource(buffers_, handle) != nullptr;
+		case ResourceType::TEXTURE:
+			return GetResource(textures_, handle) != nullptr;
+		case ResourceType::SHADER:
+			return GetResource(shaders_, handle) != nullptr;
+		case ResourceType::GRAPHICS_PIPELINE_STATE:
+			return GetResource(graphicsPipelineStates_, handle) != nullptr;
+		case ResourceType::COMPUTE_PIPELINE_STATE:
+			return GetResource(computePipelineStates_, handle) != nullptr;
+		case ResourceType::PIPELINE_BINDING_SET:
+			return GetResource(pipelineBindingSets_, handle) != nullptr;
+		case ResourceType::DRAW_BINDING_SET:
+			return GetResource(drawBindingSets_, handle) != nullptr;
+		case ResourceType::FRAME_BINDING_SET:
+			return GetResource(frameBindingSets_, handle) != nullptr;
+		case ResourceType::COMMAND_LIST:
+			return GetResource(commandLists_, handle) != nullptr;
+		case ResourceType::FENCE:
+			return GetResource(fences_, handle) != nullptr;
+		default:
+			return false;
+		}
+	}
+
+	BindFlags NullBackend::GetBindFlags(Handle handle) const
+	{
+		switch(handle.GetType())
+		{
+		case ResourceType::SWAP_CHAIN:
+			if(GetResource(swapChains_, handle))
+				return BindFlags::RENDER_TARGET | BindFlags::PRESENT;
+			break;
+		case ResourceType::BUFFER:
+			if(const auto* buffer = GetResource(buffers_, handle))
+				return buffer->desc_.bindFlags_;
+			break;
+		case ResourceType::TEXTURE:
+			if(const auto* texture = GetResource(textures_, handle))
+				return texture->desc_.bindFlags_;
+			break;
+		default:
+			break;
+		}
+		return BindFlags::NONE;
+	}
+
+} // namespace GPU
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "graphics/dll.h"
+#include "graphics/fwd_decls.h"
+#include "graphics/model.h"
+#include "graphics/render_resources.h"
+#include "core/array_view.h"
+#include "core/vector.h"
+#include "gpu/fwd_decls.h"
+#include "gpu/types.h"
+#include "math/mat44.h"
+#include "math/vec3.h"
+
+namespace Graphics
+{
+	class OcclusionBuffer;
+	class RenderGraph;
+	struct ClusterSceneImpl;
+
+	/**
+	 * Cluster as laid out for the GPU, see cluster_culling.esf.
+	 * Bounds are in mesh space, as in ModelMeshlet.
+	 */
+	struct ClusterCullingCluster
+	{
+		Math::Vec3 center_;
+		f32 radius_ = 0.0f;
+		Math::Vec3 coneAxis_;
+		f32 coneCutoff_ = 1.0f;
+		/// Range of indices, absolute within the mesh's index buffer.
+		i32 indexOffset_ = 0;
+		i32 noofIndices_ = 0;
+		i32 padding_[2] = {};
+	};
+
+	/**
+	 * Mesh in a cluster scene.
+	 * Visible clusters of all its instances are compacted into one range of draw arguments,
+	 * so each mesh is drawn with a single indirect draw.
+	 */
+	struct ClusterCullingMesh
+	{
+		GPU::Handle db_;
+		ModelMeshDraw draw_;
+		i32 baseCluster_ = 0;
+		i32 noofClusters_ = 0;
+		/// Range of draw arguments, enough for every cluster of every instance.
+		i32 baseDrawArg_ = 0;
+		i32 maxDrawArgs_ = 0;
+	};
+
+	struct ClusterCullingInstance
+	{
+		Math::Mat44 world_;
+		i32 meshIdx_ = 0;
+	};
+
+	/**
+	 * Scene wide cluster & instance data for GPU cluster culling.
+	 * Clusters are meshlets built by the model converter, see ModelMeshlet.
+	 * Culled by AddClusterCullingPass, which outputs per mesh draw arguments & counts to draw with DrawMesh.
+	 */
+	class GRAPHICS_DLL ClusterScene final
+	{
+	public:
+		ClusterScene();
+		~ClusterScene();
+
+		/**
+		 * Add mesh with clusters.
+		 * @param meshlets Clusters, with index ranges relative to @a draw.
+		 * @return Mesh index.
+		 */
+		i32 AddMesh(GPU::Handle db, const ModelMeshDraw& draw, Core::ArrayView<const ModelMeshlet> meshlets);
+
+		/**
+		 * Add mesh @a meshIdx of @a model.
+		 * @return Mesh index. -1 if @a model has no meshlets for @a meshIdx.
+		 */
+		i32 AddModelMesh(const Model& model, i32 meshIdx);
+
+		/**
+		 * Add instance of @a meshIdx.
+		 * @return Instance index, also used as draw ID for its clusters.
+		 */
+		i32 AddInstance(i32 meshIdx, const Math::Mat44& world);
+
+		void SetInstanceTransform(i32 instanceIdx, const Math::Mat44& world);
+
+		/**
+		 * Remove all instances. Meshes & clusters are kept.
+		 */
+		void ClearInstances();
+
+		Core::ArrayView<const ClusterCullingMesh> GetMeshes() const;
+		Core::ArrayView<const ClusterCullingInstance> GetInstances() const;
+		Core::ArrayView<const ClusterCullingCluster> GetClusters() const;
+
+		/// @return Number of draw arguments needed for all meshes.
+		i32 GetMaxDrawArgs() const;
+
+		/// @return Largest number of clusters in any instance.
+		i32 GetMaxInstanceClusters() const;
+
+		/**
+		 * Cull on the CPU, with the same tests and output layout as AddClusterCullingPass.
+		 * Arguments within each mesh's range are in instance then cluster order, rather than in GPU completion order.
+		 * @param eye Eye position in world space, for backface culling.
+		 * @param occlusion Optional occlusion buffer to test cluster bounds against.
+		 * @param outDrawArgs Draw arguments. Resized to GetMaxDrawArgs.
+		 * @param outDrawCounts Number of visible clusters per mesh. Resized to number of meshes.
+		 * @return Total number of visible clusters.
+		 */
+		i32 Cull(const Math::Mat44& viewProj, const Math::Vec3& eye, bool backfaceCull,
+		    const OcclusionBuffer* occlusion, Core::Vector<GPU::DrawIndexedIdArgs>& outDrawArgs,
+		    Core::Vector<u32>& outDrawCounts) const;
+
+		/**
+		 * @return Cluster buffer, (re)created if clusters have been added since it was last requested.
+		 * Invalid if there are no clusters.
+		 */
+		GPU::Handle GetClusterBuffer();
+
+		/**
+		 * Draw visible clusters of @a meshIdx.
+		 * @param drawArgs Draw arguments output by AddClusterCullingPass.
+		 * @param drawCounts Draw counts output by AddClusterCullingPass.
+		 * @pre Instance transforms output by AddClusterCullingPass are bound as the vertex shader's objects.
+		 */
+		void DrawMesh(GPU::CommandList& cmdList, i32 meshIdx, GPU::Handle ps, Core::ArrayView<GPU::PipelineBinding> pb,
+		    GPU::Handle fbs, const GPU::DrawState& drawState, GPU::Handle drawArgs, GPU::Handle drawCounts) const;
+
+	private:
+		ClusterScene(const ClusterScene&) = delete;
+		ClusterScene& operator=(const ClusterScene&) = delete;
+
+		ClusterSceneImpl* impl_ = nullptr;
+	};
+
+	struct GRAPHICS_DLL ClusterCullingSettings
+	{
+		/// Pass name.
+		const char* name_ = "Cluster Culling";
+		Math::Mat44 viewProj_;
+		/// Eye position in world space.
+		Math::Vec3 eye_;
+		bool backfaceCull_ = true;
+		/// Optional Hi-Z texture, R32G32_FLOAT min & max depth with a full mip chain.
+		RenderGraphResource hiz_;
+	};
+
+	struct GRAPHICS_DLL ClusterCullingData
+	{
+		/// World transform per instance, indexed by draw ID.
+		RenderGraphResource outTransforms_;
+		/// DrawIndexedIdArgs, ranges per mesh given by ClusterCullingMesh.
+		RenderGraphResource outDrawArgs_;
+		/// u32 draw count per mesh.
+		RenderGraphResource outDrawCounts_;
+	};
+
+	/**
+	 * Add compute pass culling all clusters of @a scene's instances against the frustum, their normal cones,
+	 * and optionally Hi-Z, and compacting visible ones into per mesh draw arguments.
+	 * Consumers should read draw arguments & counts as INDIRECT_BUFFER, and transforms as SHADER_RESOURCE.
+	 * @param shader Loaded from "shaders/cluster_culling.esf".
+	 * @pre @a scene outlives execution of @a renderGraph.
+	 */
+	GRAPHICS_DLL ClusterCullingData AddClusterCullingPass(
+	    RenderGraph& renderGraph, ClusterScene& scene, Shader* shader, const ClusterCullingSettings& settings);
+
+} // namespace Graphics
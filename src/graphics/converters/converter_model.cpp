@@ -1,5 +1,6 @@
 #include "graphics/model.h"
 #include "graphics/converters/import_model.h"
+#include "graphics/converters/mesh_optimizer.h"
 #include "graphics/private/model_impl.h"
 #include "core/concurrency.h"
 #include "core/file.h"
@@ -9,6 +10,7 @@
 #include "core/type_conversion.h"
 #include "gpu/enum.h"
 #include "gpu/utils.h"
+#include "job/parallel_for.h"
 #include "math/aabb.h"
 #include "math/mat44.h"
 #include "resource/converter.h"
@@ -188,6 +190,15 @@ namespace
 			BinaryStream indexData_;
 		};
 
+		/// Optimized triangle order & vertex order for a scene mesh.
+		struct OptimizedMesh
+		{
+			Core::Vector<u32> indices_;
+			/// New index of each vertex.
+			Core::Vector<u32> vertexRemap_;
+			Core::Vector<Graphics::ModelMeshlet> meshlets_;
+		};
+
 		bool SupportsFileType(const char* fileExt, const Core::UUID& type) const override
 		{
 			return (type == Graphics::Model::GetTypeUUID()) ||
@@ -210,6 +221,23 @@ namespace
 			}
 			std::reverse(metaData_.materials_.begin(), metaData_.materials_.end());
 
+			// Encoded streams need normalized formats to decode back to their range.
+			auto& vertexFormat = metaData_.vertexFormat_;
+			if(metaData_.quantizePositions_ &&
+			    GPU::GetFormatInfo(vertexFormat.position_).rgbaFormat_ != Core::DataType::UNORM)
+				vertexFormat.position_ = GPU::Format::R16G16B16A16_UNORM;
+			if(metaData_.octahedralNormals_)
+			{
+				auto IsOctahedralFormat = [](GPU::Format format) {
+					const auto formatInfo = GPU::GetFormatInfo(format);
+					return formatInfo.rgbaFormat_ == Core::DataType::SNORM && formatInfo.channels_ == 2;
+				};
+				if(!IsOctahedralFormat(vertexFormat.normal_))
+					vertexFormat.normal_ = GPU::Format::R16G16_SNORM;
+				if(vertexFormat.tangent_ != GPU::Format::INVALID && !IsOctahedralFormat(vertexFormat.tangent_))
+					vertexFormat.tangent_ = GPU::Format::R16G16_SNORM;
+			}
+
 			char resolvedSourcePath[Core::MAX_PATH_LENGTH];
 			memset(resolvedSourcePath, 0, sizeof(resolvedSourcePath));
 			if(!context.GetPathResolver()->ResolvePath(sourceFile, resolvedSourcePath, sizeof(resolvedSourcePath)))
@@ -250,6 +278,10 @@ namespace
 				int flags = aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_SplitByBoneCount |
 				            aiProcess_LimitBoneWeights | aiProcess_ConvertToLeftHanded;
 
+				// Triangles are reordered by OptimizeMeshes instead.
+				if(metaData_.optimizeMeshes_)
+					flags &= ~aiProcess_ImproveCacheLocality;
+
 				if(metaData_.flattenHierarchy_)
 				{
 					flags |= aiProcess_OptimizeGraph | aiProcess_RemoveComponent;
@@ -266,6 +298,8 @@ namespace
 			if(scene_ == nullptr)
 				return false;
 
+			OptimizeMeshes();
+
 			i32 nodeIdx = 0;
 			i32 meshIdx = 0;
 			RecursiveSerialiseNodes(scene_->mRootNode, -1, nodeIdx, meshIdx);
@@ -287,6 +321,7 @@ namespace
 				modelData.numBonePalettes_ = meshNodeBonePaletteDatas_.size();
 				modelData.numInverseBindPoses_ = meshNodeInverseBindposeDatas_.size();
 				modelData.numMaterials_ = 0;
+				modelData.numMeshlets_ = meshlets_.size();
 				outFile.Write(&modelData, sizeof(modelData));
 
 				// Local, world, and parent indices for nodes.
@@ -364,6 +399,10 @@ namespace
 					}
 				}
 
+				// Meshlets.
+				if(meshlets_.size() > 0)
+					outFile.Write(meshlets_.data(), meshlets_.size() * sizeof(Graphics::ModelMeshlet));
+
 				// Write out mesh vertex + index buffers.
 				for(const auto& mesh : meshDatas_)
 				{
@@ -407,7 +446,7 @@ namespace
 			{
 				for(size_t idx = 0; idx < node->mNumMeshes; ++idx)
 				{
-					SerialiseMesh(scene_->mMeshes[node->mMeshes[idx]], parentIdx, nodeIdx, meshIdx);
+					SerialiseMesh(node->mMeshes[idx], parentIdx, nodeIdx, meshIdx);
 				}
 			}
 
@@ -420,8 +459,86 @@ namespace
 			}
 		}
 
-		void SerialiseMesh(struct aiMesh* mesh, i32 parentIdx, i32& nodeIdx, i32& meshIdx)
+		void OptimizeMeshes()
+		{
+			optimizedMeshes_.clear();
+			optimizedMeshes_.resize(scene_->mNumMeshes);
+			metaData_.meshStats_.clear();
+			metaData_.meshStats_.resize(scene_->mNumMeshes);
+
+			// Meshes are independent, so optimize them in parallel.
+			Job::ParallelFor("ConverterModel::OptimizeMeshes", scene_->mNumMeshes, 1, [this](i32 begin, i32 end) {
+				for(i32 idx = begin; idx < end; ++idx)
+					OptimizeMesh(idx);
+			});
+		}
+
+		void OptimizeMesh(i32 sceneMeshIdx)
+		{
+			const aiMesh* mesh = scene_->mMeshes[sceneMeshIdx];
+			auto& optimizedMesh = optimizedMeshes_[sceneMeshIdx];
+			auto& stats = metaData_.meshStats_[sceneMeshIdx];
+			const i32 numVertices = mesh->mNumVertices;
+
+			for(i32 faceidx = 0; faceidx < (i32)mesh->mNumFaces; ++faceidx)
+			{
+				const auto& face = mesh->mFaces[faceidx];
+				for(i32 indexidx = 0; indexidx < (i32)face.mNumIndices; ++indexidx)
+					optimizedMesh.indices_.push_back(face.mIndices[indexidx]);
+			}
+			const i32 numIndices = optimizedMesh.indices_.size();
+
+			optimizedMesh.vertexRemap_.resize(numVertices);
+			for(i32 idx = 0; idx < numVertices; ++idx)
+				optimizedMesh.vertexRemap_[idx] = idx;
+
+			stats.name_ = mesh->mName.C_Str();
+			stats.numVertices_ = numVertices;
+			stats.numIndices_ = numIndices;
+			if(mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE || mesh->mVertices == nullptr)
+				return;
+
+			const i32 cacheSize = metaData_.vertexCacheSize_;
+			const auto before =
+			    Graphics::AnalyzeVertexCache(optimizedMesh.indices_.data(), numIndices, numVertices, cacheSize);
+			stats.acmrBefore_ = stats.acmrAfter_ = before.acmr_;
+			stats.atvrBefore_ = stats.atvrAfter_ = before.atvr_;
+
+			if(metaData_.optimizeMeshes_)
+			{
+				Core::Vector<u32> cacheIndices;
+				cacheIndices.resize(numIndices);
+				Graphics::OptimizeVertexCache(
+				    cacheIndices.data(), optimizedMesh.indices_.data(), numIndices, numVertices);
+				Graphics::OptimizeOverdraw(optimizedMesh.indices_.data(), cacheIndices.data(), numIndices,
+				    &mesh->mVertices[0].x, sizeof(aiVector3D), numVertices, cacheSize, metaData_.overdrawThreshold_);
+			}
+
+			// Meshlets are ranges of the final triangle order, so vertex order doesn't matter.
+			if(metaData_.generateMeshlets_)
+			{
+				stats.numMeshlets_ = Graphics::BuildMeshlets(optimizedMesh.meshlets_, optimizedMesh.indices_.data(),
+				    numIndices, &mesh->mVertices[0].x, sizeof(aiVector3D), numVertices, metaData_.maxMeshletVertices_,
+				    metaData_.maxMeshletTriangles_);
+			}
+
+			if(!metaData_.optimizeMeshes_)
+				return;
+
+			Graphics::OptimizeVertexFetchRemap(
+			    optimizedMesh.vertexRemap_.data(), optimizedMesh.indices_.data(), numIndices, numVertices);
+			Graphics::RemapIndices(optimizedMesh.indices_.data(), numIndices, optimizedMesh.vertexRemap_.data());
+
+			const auto after =
+			    Graphics::AnalyzeVertexCache(optimizedMesh.indices_.data(), numIndices, numVertices, cacheSize);
+			stats.acmrAfter_ = after.acmr_;
+			stats.atvrAfter_ = after.atvr_;
+		}
+
+		void SerialiseMesh(u32 sceneMeshIdx, i32 parentIdx, i32& nodeIdx, i32& meshIdx)
 		{
+			struct aiMesh* mesh = scene_->mMeshes[sceneMeshIdx];
+			const auto& optimizedMesh = optimizedMeshes_[sceneMeshIdx];
 			if(mesh->HasPositions() && mesh->HasFaces())
 			{
 				// Calculate number of primitives.
@@ -569,18 +686,27 @@ namespace
 				// Export vertices.
 				draw.vertexOffset_ = meshData.noofVertices_;
 				draw.noofVertices_ =
-				    SerialiseVertices(mesh, elements.data(), numElements, modelMeshAABB.aabb_, meshData.vertexData_);
+				    SerialiseVertices(mesh, optimizedMesh.vertexRemap_.data(), elements.data(), numElements,
+				        modelMeshAABB.aabb_, meshData.vertexData_);
 				meshData.noofVertices_ += draw.noofVertices_;
 
 				// Export indices.
 				draw.indexOffset_ = meshData.noofIndices_;
-				draw.noofIndices_ = SerialiseIndices(mesh, meshData.indexData_);
+				draw.noofIndices_ = SerialiseIndices(optimizedMesh, meshData.indexData_);
 				meshData.noofIndices_ += draw.noofIndices_;
 
 				// Push AABB.
 				meshNode.aabbIdx_ = meshNodeAABBDatas_.size();
 				meshNodeAABBDatas_.push_back(modelMeshAABB);
 
+				// Push meshlets.
+				if(optimizedMesh.meshlets_.size() > 0)
+				{
+					meshNode.meshletIdx_ = meshlets_.size();
+					meshNode.noofMeshlets_ = optimizedMesh.meshlets_.size();
+					meshlets_.insert(optimizedMesh.meshlets_.begin(), optimizedMesh.meshlets_.end());
+				}
+
 				// Add draw to render mesh.
 				meshData.draws_.push_back(draw);
 				meshNode.drawIdx_ = meshData.draws_.size() - 1;
@@ -600,8 +726,8 @@ namespace
 			}
 		}
 
-		u32 SerialiseVertices(struct aiMesh* mesh, GPU::VertexElement* elements, i32 numElements, Math::AABB& aabb,
-		    VertexBinaryStreams& streams) const
+		u32 SerialiseVertices(struct aiMesh* mesh, const u32* vertexRemap, GPU::VertexElement* elements,
+		    i32 numElements, Math::AABB& aabb, VertexBinaryStreams& streams) const
 		{
 			aabb.Empty();
 
@@ -656,6 +782,33 @@ namespace
 				aabb.ExpandBy(Math::Vec3(position.x, position.y, position.z));
 			}
 
+			// Encode streams that aren't stored as plain vectors.
+			Core::Vector<f32> quantizedPositions;
+			if(metaData_.quantizePositions_ && mesh->mVertices != nullptr)
+			{
+				quantizedPositions.resize(mesh->mNumVertices * 3);
+				Graphics::QuantizePositions(quantizedPositions.data(), &mesh->mVertices[0].x, sizeof(aiVector3D),
+				    mesh->mNumVertices, &aabb.Minimum().x, &aabb.Maximum().x);
+			}
+
+			Core::Vector<f32> octahedralNormals;
+			Core::Vector<f32> octahedralTangents;
+			if(metaData_.octahedralNormals_)
+			{
+				if(mesh->mNormals != nullptr)
+				{
+					octahedralNormals.resize(mesh->mNumVertices * 2);
+					Graphics::EncodeOctahedral(
+					    octahedralNormals.data(), &mesh->mNormals[0].x, sizeof(aiVector3D), mesh->mNumVertices);
+				}
+				if(mesh->mTangents != nullptr)
+				{
+					octahedralTangents.resize(mesh->mNumVertices * 2);
+					Graphics::EncodeOctahedral(
+					    octahedralTangents.data(), &mesh->mTangents[0].x, sizeof(aiVector3D), mesh->mNumVertices);
+				}
+			}
+
 			for(i32 vtxStreamIdx = 0; vtxStreamIdx < GPU::MAX_VERTEX_STREAMS; ++vtxStreamIdx)
 			{
 				// Setup stream descs.
@@ -678,15 +831,27 @@ namespace
 								{
 								case GPU::VertexUsage::POSITION:
 									inStreamDesc.data_ = mesh->mVertices;
+									if(quantizedPositions.size() > 0)
+										inStreamDesc.data_ = quantizedPositions.data();
 									break;
 								case GPU::VertexUsage::NORMAL:
 									inStreamDesc.data_ = mesh->mNormals;
+									if(octahedralNormals.size() > 0)
+									{
+										inStreamDesc.data_ = octahedralNormals.data();
+										inStreamDesc.stride_ = 2 * sizeof(f32);
+									}
 									break;
 								case GPU::VertexUsage::TEXCOORD:
 									inStreamDesc.data_ = mesh->mTextureCoords[element.usageIdx_];
 									break;
 								case GPU::VertexUsage::TANGENT:
 									inStreamDesc.data_ = mesh->mTangents;
+									if(octahedralTangents.size() > 0)
+									{
+										inStreamDesc.data_ = octahedralTangents.data();
+										inStreamDesc.stride_ = 2 * sizeof(f32);
+									}
 									break;
 								case GPU::VertexUsage::BINORMAL:
 									inStreamDesc.data_ = mesh->mBitangents;
@@ -735,27 +900,24 @@ namespace
 						DBG_ASSERT_MSG(retVal, "Unable to convert stream.");
 					}
 
-					streams[vtxStreamIdx].Write(vertexData.data(), vertexData.size());
+					// Write in optimized vertex order.
+					Core::Vector<u8> remappedVertexData(vertexData.size(), 0);
+					Graphics::RemapVertices(
+					    remappedVertexData.data(), vertexData.data(), mesh->mNumVertices, stride, vertexRemap);
+					streams[vtxStreamIdx].Write(remappedVertexData.data(), remappedVertexData.size());
 				}
 			}
 			return mesh->mNumVertices;
 		}
 
-		i32 SerialiseIndices(struct aiMesh* mesh, BinaryStream& stream) const
+		i32 SerialiseIndices(const OptimizedMesh& optimizedMesh, BinaryStream& stream) const
 		{
-			i32 totalIndices = 0;
-			for(i32 faceidx = 0; faceidx < (i32)mesh->mNumFaces; ++faceidx)
+			for(u32 index : optimizedMesh.indices_)
 			{
-				const auto& face = mesh->mFaces[faceidx];
-				for(i32 indexidx = 0; indexidx < (i32)face.mNumIndices; ++indexidx)
-				{
-					i32 index = face.mIndices[indexidx];
-					DBG_ASSERT(index < 0x10000);
-					stream.Write(u16(index));
-					++totalIndices;
-				}
+				DBG_ASSERT(index < 0x10000);
+				stream.Write(u16(index));
 			}
-			return totalIndices;
+			return optimizedMesh.indices_.size();
 		}
 
 		MeshData& GetMeshData(
@@ -972,6 +1134,8 @@ namespace
 		Core::Vector<Core::Pair<i32, Graphics::MeshNodeBonePalette*>> meshNodeBonePaletteDatas_;
 		Core::Vector<Core::Pair<i32, Graphics::MeshNodeInverseBindpose*>> meshNodeInverseBindposeDatas_;
 		Core::Vector<MeshData> meshDatas_;
+		Core::Vector<OptimizedMesh> optimizedMeshes_;
+		Core::Vector<Graphics::ModelMeshlet> meshlets_;
 
 		Core::Map<Core::String, Core::UUID> defaultTextures_;
 		Core::Map<Core::String, Core::UUID> addedMaterials_;
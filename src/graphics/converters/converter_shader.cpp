@@ -8,6 +8,7 @@
 #include "core/linear_allocator.h"
 #include "core/misc.h"
 #include "core/string.h"
+#include "core/timer.h"
 #include "core/vector.h"
 
 #include "gpu/enum.h"
@@ -17,11 +18,13 @@
 #include "serialization/serializer.h"
 #include "graphics/private/shader_impl.h"
 #include "graphics/converters/import_shader.h"
+#include "graphics/converters/shader_compile_cache.h"
 #include "graphics/converters/shader_backend_hlsl.h"
 #include "graphics/converters/shader_backend_metadata.h"
 #include "graphics/converters/shader_compiler_hlsl.h"
 #include "graphics/converters/shader_parser.h"
 #include "graphics/converters/shader_preprocessor.h"
+#include "job/parallel_for.h"
 
 #include <cstring>
 
@@ -30,8 +33,17 @@
 #define DUMP_ESF_PATH "tmp.esf"
 #define DUMP_HLSL_PATH "shader_dump\\%s-%s.hlsl"
 
+#define COMPILE_CACHE_PATH "shader_cache"
+
 namespace
 {
+	/// Include files shared between all shaders converted, as converters only live for a single conversion.
+	Graphics::ShaderIncludeCache& GetIncludeCache()
+	{
+		static Graphics::ShaderIncludeCache includeCache;
+		return includeCache;
+	}
+
 	class ConverterShader : public Resource::IConverter
 	{
 	public:
@@ -77,13 +89,16 @@ namespace
 				shaderSource.resize((i32)shaderFile.Size() + 1, '\0');
 				shaderFile.Read(shaderSource.data(), shaderFile.Size());
 
-				Graphics::ShaderPreprocessor preprocessor;
+				Graphics::ShaderPreprocessor preprocessor(&GetIncludeCache());
 
 				// Setup include path to root of shader.
 				preprocessor.AddInclude(path);
 
+				Core::Timer timer;
+				timer.Mark();
 				if(!preprocessor.Preprocess(fullPath, shaderSource.data()))
 					return false;
+				context.AddTiming("Preprocess", timer.GetTime());
 
 #if DEBUG_DUMP_SHADERS
 				if(Core::FileExists(DUMP_ESF_PATH))
@@ -96,19 +111,21 @@ namespace
 
 				// Add dependencies from preprocessor stage.
 				Core::Array<char, Core::MAX_PATH_LENGTH> originalPath;
-				for(const char* dep : preprocessor.GetDependencies())
+				for(const auto& dep : preprocessor.GetDependencies())
 				{
-					if(pathResolver->OriginalPath(dep, originalPath.data(), originalPath.size()))
+					if(pathResolver->OriginalPath(dep.c_str(), originalPath.data(), originalPath.size()))
 						context.AddDependency(originalPath.data());
-					else if(Core::FileExists(dep))
-						context.AddDependency(dep);
+					else if(Core::FileExists(dep.c_str()))
+						context.AddDependency(dep.c_str());
 				}
 
 				// Parse shader into an AST.
+				timer.Mark();
 				Graphics::ShaderParser shaderParser;
 				auto node = shaderParser.Parse(sourceFile, preprocessor.GetOutput().c_str());
 				if(node == nullptr)
 					return false;
+				context.AddTiming("Parse", timer.GetTime());
 
 				// Parse shader metadata from AST to determine what needs to be compiled.
 				Graphics::ShaderBackendMetadata backendMetadata;
@@ -175,15 +192,20 @@ namespace
 				};
 
 				Graphics::ShaderCompilerHLSL compilerHLSL;
-				auto GenerateAndCompile = [&](const Graphics::BindingMap& bindingMap,
+				Graphics::ShaderCompileCache compileCache(COMPILE_CACHE_PATH, compilerHLSL.GetVersion());
+				auto GenerateAndCompile = [&](const char* passName, const Graphics::BindingMap& bindingMap,
 				    Core::Vector<CompileInfo>& outCompileInfo,
 				    Core::Vector<Graphics::ShaderCompileOutput>& outCompileOutput) {
 					outCompileInfo.clear();
 					outCompileOutput.clear();
 
 					// Generate HLSL for the whole ESF.
+					Core::Timer passTimer;
+					passTimer.Mark();
 					Graphics::ShaderBackendHLSL backendHLSL(bindingMap, functionExports, true);
 					node->Visit(&backendHLSL);
+					Core::String stageName;
+					context.AddTiming(stageName.Printf("%s: Generate HLSL", passName).c_str(), passTimer.GetTime());
 
 #if DEBUG_DUMP_SHADERS
 					Core::String hlslFileName;
@@ -227,15 +249,69 @@ namespace
 							outCompileInfo.emplace_back(sourceFile, backendHLSL.GetOutputCode(), shader,
 							    (GPU::ShaderType)idx, GetTarget((GPU::ShaderType)idx, majorVer, minorVer));
 
-					for(const auto& compile : outCompileInfo)
+					// Compile each entry point on job workers, reusing cached output where inputs are unchanged.
+					struct CompileJob
 					{
-						auto outCompile = compilerHLSL.Compile(compile.name_.c_str(), compile.code_.c_str(),
-						    compile.entryPoint_.c_str(), compile.type_, compile.target_.c_str());
-						if(outCompile)
+						const CompileInfo* info_ = nullptr;
+						Graphics::ShaderCompileOutput* output_ = nullptr;
+						f64* times_ = nullptr;
+						Graphics::ShaderCompilerHLSL* compiler_ = nullptr;
+						Graphics::ShaderCompileCache* cache_ = nullptr;
+					};
+
+					Core::Vector<f64> compileTimes(outCompileInfo.size(), 0.0);
+					outCompileOutput.resize(outCompileInfo.size());
+
+					CompileJob compileJob;
+					compileJob.info_ = outCompileInfo.data();
+					compileJob.output_ = outCompileOutput.data();
+					compileJob.times_ = compileTimes.data();
+					compileJob.compiler_ = &compilerHLSL;
+					compileJob.cache_ = &compileCache;
+
+					const CompileJob* compileJobPtr = &compileJob;
+					passTimer.Mark();
+					Job::ParallelFor("ConverterShader::Compile", outCompileInfo.size(), 1,
+					    [compileJobPtr](i32 begin, i32 end) {
+						    for(i32 idx = begin; idx < end; ++idx)
+						    {
+							    const auto& compile = compileJobPtr->info_[idx];
+							    auto& outCompile = compileJobPtr->output_[idx];
+
+							    Core::Timer compileTimer;
+							    compileTimer.Mark();
+							    const auto key = compileJobPtr->cache_->GetKey(compile.name_.c_str(),
+							        compile.code_.c_str(), compile.entryPoint_.c_str(), compile.target_.c_str());
+							    if(!compileJobPtr->cache_->Find(key, outCompile))
+							    {
+								    outCompile = compileJobPtr->compiler_->Compile(compile.name_.c_str(),
+								        compile.code_.c_str(), compile.entryPoint_.c_str(), compile.type_,
+								        compile.target_.c_str());
+								    if(outCompile)
+									    compileJobPtr->cache_->Store(key, outCompile);
+							    }
+							    compileJobPtr->times_[idx] = compileTimer.GetTime();
+						    }
+					    });
+
+					// Report time per shader stage, summed over entry points.
+					Core::Array<f64, (i32)GPU::ShaderType::MAX> stageTimes;
+					stageTimes.fill(0.0);
+					for(i32 idx = 0; idx < outCompileInfo.size(); ++idx)
+						stageTimes[(i32)outCompileInfo[idx].type_] += compileTimes[idx];
+					for(i32 idx = 0; idx < stageTimes.size(); ++idx)
+					{
+						if(shaders[idx].size() > 0)
 						{
-							outCompileOutput.emplace_back(outCompile);
+							stageName.Printf("%s: Compile %s", passName, Core::EnumToString((GPU::ShaderType)idx));
+							context.AddTiming(stageName.c_str(), stageTimes[idx]);
 						}
-						else
+					}
+					context.AddTiming(stageName.Printf("%s: Compile", passName).c_str(), passTimer.GetTime());
+
+					for(const auto& outCompile : outCompileOutput)
+					{
+						if(!outCompile)
 						{
 							Core::String errStr(outCompile.errorsBegin_, outCompile.errorsEnd_);
 							Core::Log("%s", errStr.c_str());
@@ -249,7 +325,7 @@ namespace
 				// Generate and compile initial pass.
 				Core::Vector<CompileInfo> compileInfo;
 				Core::Vector<Graphics::ShaderCompileOutput> compileOutput;
-				if(!GenerateAndCompile(Graphics::BindingMap(), compileInfo, compileOutput))
+				if(!GenerateAndCompile("Initial pass", Graphics::BindingMap(), compileInfo, compileOutput))
 				{
 					// ERROR.
 					return false;
@@ -278,7 +354,7 @@ namespace
 					AddBindings(compile.samplers_, usedBindings);
 
 				// Regenerate HLSL with only the used bindings.
-				if(!GenerateAndCompile(usedBindings, compileInfo, compileOutput))
+				if(!GenerateAndCompile("Final pass", usedBindings, compileInfo, compileOutput))
 				{
 					// ERROR.
 					return false;
@@ -329,6 +405,7 @@ namespace
 						Graphics::ShaderBindingHeader bindingHeader;
 						memset(&bindingHeader, 0, sizeof(bindingHeader));
 						strcpy_s(bindingHeader.name_, sizeof(bindingHeader.name_), member.c_str());
+						bindingHeader.nameHash_ = Graphics::HashShaderName(bindingHeader.name_);
 						bindingHeader.handle_ = (Graphics::ShaderBindingHandle)(
 						    flags | (Graphics::ShaderBindingFlags(idx) & Graphics::ShaderBindingFlags::INDEX_MASK));
 						outBindingHeaders.push_back(bindingHeader);
@@ -345,6 +422,7 @@ namespace
 					const auto& bindingSet = inBindingSets[idx];
 					Graphics::ShaderBindingSetHeader outBindingSet;
 					strcpy_s(outBindingSet.name_, sizeof(outBindingSet), bindingSet.name_.c_str());
+					outBindingSet.nameHash_ = Graphics::HashShaderName(outBindingSet.name_);
 
 					outBindingSet.isShared_ = bindingSet.shared_;
 					if(bindingSet.frequency_ == "LOW")
@@ -422,15 +500,16 @@ namespace
 				}
 
 				Core::Vector<Graphics::ShaderBytecodeHeader> outBytecodeHeaders;
+				const i32 bytecodeAlignment = Graphics::ShaderHeader::BYTECODE_ALIGNMENT;
 				i32 bytecodeOffset = 0;
 				for(const auto& compile : compileOutput)
 				{
 					Graphics::ShaderBytecodeHeader bytecodeHeader;
 					bytecodeHeader.type_ = compile.type_;
-					bytecodeHeader.offset_ = bytecodeOffset;
+					bytecodeHeader.offset_ = Core::PotRoundUp(bytecodeOffset, bytecodeAlignment);
 					bytecodeHeader.numBytes_ = (i32)(compile.byteCodeEnd_ - compile.byteCodeBegin_);
 
-					bytecodeOffset += bytecodeHeader.numBytes_;
+					bytecodeOffset = bytecodeHeader.offset_ + bytecodeHeader.numBytes_;
 					outBytecodeHeaders.push_back(bytecodeHeader);
 				};
 
@@ -443,6 +522,7 @@ namespace
 					Graphics::ShaderTechniqueHeader techniqueHeader;
 					memset(&techniqueHeader, 0, sizeof(techniqueHeader));
 					strcpy_s(techniqueHeader.name_, sizeof(techniqueHeader.name_), technique.name_.c_str());
+					techniqueHeader.nameHash_ = Graphics::HashShaderName(techniqueHeader.name_);
 
 					techniqueHeader.vs_ = FindShaderIdx(technique.vs_.c_str());
 					techniqueHeader.gs_ = FindShaderIdx(technique.gs_.c_str());
@@ -511,6 +591,36 @@ namespace
 					outTechniqueHeaders.push_back(techniqueHeader);
 				}
 
+				// Runtime resolves names by hash, so they must be unique within techniques & each binding set.
+				auto CheckNameHashes = [&context](const char* type, auto begin, auto end) {
+					Core::Map<u32, const char*> names;
+					for(auto it = begin; it != end; ++it)
+					{
+						if(const char** name = names.find(it->nameHash_))
+						{
+							context.AddError(__FILE__, __LINE__,
+							    "ERROR: %s name hash collision between \"%s\" and \"%s\"", type, *name, it->name_);
+							return false;
+						}
+						names.insert(it->nameHash_, it->name_);
+					}
+					return true;
+				};
+
+				bool namesValid = CheckNameHashes("Technique", outTechniqueHeaders.begin(), outTechniqueHeaders.end());
+				namesValid &= CheckNameHashes("Binding set", outBindingSets.begin(), outBindingSets.end());
+				i32 bindingOffset = 0;
+				for(const auto& bindingSet : outBindingSets)
+				{
+					const i32 numBindings =
+					    bindingSet.numCBVs_ + bindingSet.numSRVs_ + bindingSet.numUAVs_ + bindingSet.numSamplers_;
+					const auto* bindingBegin = outBindingHeaders.begin() + bindingOffset;
+					namesValid &= CheckNameHashes("Binding", bindingBegin, bindingBegin + numBindings);
+					bindingOffset += numBindings;
+				}
+				if(!namesValid)
+					return false;
+
 				Graphics::ShaderHeader outHeader;
 				outHeader.numShaders_ = compileOutput.size();
 				outHeader.numTechniques_ = techniques.size();
@@ -538,11 +648,22 @@ namespace
 							outFile.Write(outSamplerStateHeaders.data(),
 							    outSamplerStateHeaders.size() * sizeof(Graphics::ShaderSamplerStateHeader));
 
-						i64 outBytes = 0;
-						for(const auto& compile : compileOutput)
+						// Pad bytecode to alignment, so it can be used in place when loaded.
+						const u8 padding[Graphics::ShaderHeader::BYTECODE_ALIGNMENT] = {};
+						auto WritePadding = [&](i64 offset) {
+							const i64 alignedOffset = Core::PotRoundUp(offset, bytecodeAlignment);
+							if(alignedOffset > offset)
+								outFile.Write(padding, alignedOffset - offset);
+						};
+
+						WritePadding(outFile.Tell());
+						const i64 bytecodeBase = outFile.Tell();
+						for(i32 idx = 0; idx < compileOutput.size(); ++idx)
 						{
-							outBytes +=
-							    outFile.Write(compile.byteCodeBegin_, compile.byteCodeEnd_ - compile.byteCodeBegin_);
+							const auto& compile = compileOutput[idx];
+							WritePadding(outFile.Tell() - bytecodeBase);
+							DBG_ASSERT(outFile.Tell() - bytecodeBase == outBytecodeHeaders[idx].offset_);
+							outFile.Write(compile.byteCodeBegin_, compile.byteCodeEnd_ - compile.byteCodeBegin_);
 						}
 
 						return true;
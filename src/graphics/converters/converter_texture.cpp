@@ -1,5 +1,6 @@
 #include "graphics/converters/import_texture.h"
 #include "graphics/texture.h"
+#include "graphics/private/texture_impl.h"
 #include "resource/converter.h"
 #include "core/array.h"
 #include "core/debug.h"
@@ -81,42 +82,30 @@ namespace
 					metaData.generateMipLevels_ = true;
 				}
 
+				auto formatInfo = GPU::GetFormatInfo(metaData.format_);
+				const bool isBlockCompressed = formatInfo.blockW_ > 1 || formatInfo.blockH_ > 1;
 				if(metaData.generateMipLevels_)
 				{
-					u32 maxDim = Core::Max(image.GetWidth(), Core::Max(image.GetHeight(), image.GetDepth()));
-					i32 levels = 32 - Core::CountLeadingZeros(maxDim);
-					Image::Image lsImage(image.GetType(), GPU::Format::R32G32B32A32_FLOAT, image.GetWidth(),
-					    image.GetHeight(), image.GetDepth(), levels, nullptr, nullptr);
-					Image::Image newImage(image.GetType(), image.GetFormat(), image.GetWidth(), image.GetHeight(),
-					    image.GetDepth(), levels, nullptr, nullptr);
-
-					bool success = true;
-
-					// Unpack to floating point.
-					success &= Image::Convert(lsImage, image, Image::ImageFormat::R32G32B32A32_FLOAT);
-					DBG_ASSERT(success);
-
-					// Convert to linear space.
-					success &= Image::GammaToLinear(lsImage, lsImage);
-					DBG_ASSERT(success);
-
-					// Generate mips.
-					success &= Image::GenerateMips(lsImage, lsImage);
-					DBG_ASSERT(success);
-
-					// Convert to gamma space.
-					success &= Image::LinearToGamma(lsImage, lsImage);
-					DBG_ASSERT(success);
-
-					// Pack back to 32-bit RGBA.
-					success &= Image::Convert(newImage, lsImage, Image::ImageFormat::R8G8B8A8_UNORM);
+					// Generate & encode in a single tiled pass.
+					// TODO: Use better than VERY_LOW in tools.
+					Image::MipChainParams params;
+					params.format_ = isBlockCompressed ? metaData.format_ : GPU::Format::R8G8B8A8_UNORM;
+					params.quality_ = Image::ConvertQuality::VERY_LOW;
+
+					Image::Image newImage;
+					bool success = Image::GenerateMipChain(newImage, image, params);
+					if(!success && params.format_ != GPU::Format::R8G8B8A8_UNORM)
+					{
+						// Format can't be encoded, leave uncompressed.
+						params.format_ = GPU::Format::R8G8B8A8_UNORM;
+						success = Image::GenerateMipChain(newImage, image, params);
+					}
 					DBG_ASSERT(success);
 
-					std::swap(image, newImage);
+					if(success)
+						std::swap(image, newImage);
 				}
-
-				auto formatInfo = GPU::GetFormatInfo(metaData.format_);
-				if(formatInfo.blockW_ > 1 || formatInfo.blockH_ > 1)
+				else if(isBlockCompressed)
 				{
 					Image::Image encodedImage;
 					// TODO: Use better than VERY_LOW in tools.
@@ -166,14 +155,48 @@ namespace
 
 		bool WriteTexture(const char* outFilename, const GPU::TextureDesc& desc, const u8* data)
 		{
+			// Source data is a level chain per element. Sizes for each level.
+			Core::Vector<i64> levelSizes;
+			Core::Vector<i64> levelOffsets;
+			i64 elementSize = 0;
+			for(i32 level = 0; level < desc.levels_; ++level)
+			{
+				const auto width = Core::Max(1, desc.width_ >> level);
+				const auto height = Core::Max(1, desc.height_ >> level);
+				const auto depth = Core::Max(1, desc.depth_ >> level);
+				levelOffsets.push_back(elementSize);
+				levelSizes.push_back(GPU::GetTextureSize(desc.format_, width, height, depth, 1, 1));
+				elementSize += levelSizes.back();
+			}
+
+			// Lay data out a level at a time so streaming can read all levels below any given one at once.
+			Graphics::TextureHeader header;
+			header.desc_ = desc;
+			Core::Vector<Graphics::TextureSubResourceHeader> subRscHeaders;
+			subRscHeaders.resize(desc.levels_ * desc.elements_);
+			i64 offset = sizeof(header) + subRscHeaders.size() * sizeof(Graphics::TextureSubResourceHeader);
+			for(i32 level = 0; level < desc.levels_; ++level)
+			{
+				for(i32 element = 0; element < desc.elements_; ++element)
+				{
+					auto& subRscHeader = subRscHeaders[Graphics::GetTextureSubResourceIdx(desc, element, level)];
+					subRscHeader.offset_ = offset;
+					subRscHeader.size_ = levelSizes[level];
+					offset += levelSizes[level];
+				}
+			}
+
 			// Write out texture data.
 			Core::File outFile(outFilename, Core::FileFlags::DEFAULT_WRITE);
 			if(outFile)
 			{
-				outFile.Write(&desc, sizeof(desc));
-				i64 size = GPU::GetTextureSize(
-				    desc.format_, desc.width_, desc.height_, desc.depth_, desc.levels_, desc.elements_);
-				outFile.Write(data, size);
+				outFile.Write(&header, sizeof(header));
+				outFile.Write(subRscHeaders.data(), subRscHeaders.size() * sizeof(Graphics::TextureSubResourceHeader));
+				for(i32 level = 0; level < desc.levels_; ++level)
+				{
+					for(i32 element = 0; element < desc.elements_; ++element)
+						outFile.Write(data + element * elementSize + levelOffsets[level], levelSizes[level]);
+				}
 
 				return true;
 			}
@@ -15,6 +15,16 @@ namespace Graphics
 		i32 maxBones_ = 256;
 		i32 maxBoneInfluences_ = 4;
 		f32 smoothingAngle_ = 90.0f;
+		bool optimizeMeshes_ = true;
+		i32 vertexCacheSize_ = 16;
+		f32 overdrawThreshold_ = 1.05f;
+		/// Store positions relative to mesh AABB, in a UNORM format.
+		bool quantizePositions_ = false;
+		/// Store normals & tangents octahedral encoded, in a 2 component SNORM format.
+		bool octahedralNormals_ = false;
+		bool generateMeshlets_ = true;
+		i32 maxMeshletVertices_ = 64;
+		i32 maxMeshletTriangles_ = 124;
 
 		struct
 		{
@@ -41,6 +51,35 @@ namespace Graphics
 
 		Core::Vector<Material> materials_;
 
+		/// Optimization statistics for each mesh, written by the converter.
+		struct MeshStats
+		{
+			Core::String name_;
+			i32 numVertices_ = 0;
+			i32 numIndices_ = 0;
+			i32 numMeshlets_ = 0;
+			f32 acmrBefore_ = 0.0f;
+			f32 acmrAfter_ = 0.0f;
+			f32 atvrBefore_ = 0.0f;
+			f32 atvrAfter_ = 0.0f;
+
+			bool Serialize(Serialization::Serializer& serializer)
+			{
+				bool retVal = true;
+				retVal &= serializer.Serialize("name", name_);
+				retVal &= serializer.Serialize("numVertices", numVertices_);
+				retVal &= serializer.Serialize("numIndices", numIndices_);
+				retVal &= serializer.Serialize("numMeshlets", numMeshlets_);
+				retVal &= serializer.Serialize("acmrBefore", acmrBefore_);
+				retVal &= serializer.Serialize("acmrAfter", acmrAfter_);
+				retVal &= serializer.Serialize("atvrBefore", atvrBefore_);
+				retVal &= serializer.Serialize("atvrAfter", atvrAfter_);
+				return retVal;
+			}
+		};
+
+		Core::Vector<MeshStats> meshStats_;
+
 		bool Serialize(Serialization::Serializer& serializer)
 		{
 			isInitialized_ = true;
@@ -51,6 +90,14 @@ namespace Graphics
 			retVal &= serializer.Serialize("smoothingAngle", smoothingAngle_);
 			retVal &= serializer.Serialize("maxBones", maxBones_);
 			retVal &= serializer.Serialize("maxBoneInfluences", maxBoneInfluences_);
+			retVal &= serializer.Serialize("optimizeMeshes", optimizeMeshes_);
+			retVal &= serializer.Serialize("vertexCacheSize", vertexCacheSize_);
+			retVal &= serializer.Serialize("overdrawThreshold", overdrawThreshold_);
+			retVal &= serializer.Serialize("quantizePositions", quantizePositions_);
+			retVal &= serializer.Serialize("octahedralNormals", octahedralNormals_);
+			retVal &= serializer.Serialize("generateMeshlets", generateMeshlets_);
+			retVal &= serializer.Serialize("maxMeshletVertices", maxMeshletVertices_);
+			retVal &= serializer.Serialize("maxMeshletTriangles", maxMeshletTriangles_);
 			if(auto object = serializer.Object("vertexFormat"))
 			{
 				retVal &= serializer.Serialize("position", vertexFormat_.position_);
@@ -60,6 +107,7 @@ namespace Graphics
 				retVal &= serializer.Serialize("color", vertexFormat_.color_);
 			}
 			retVal &= serializer.Serialize("materials", materials_);
+			retVal &= serializer.Serialize("meshStats", meshStats_);
 			return retVal;
 		}
 	};
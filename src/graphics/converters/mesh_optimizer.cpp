@@ -0,0 +1,555 @@
+#include "graphics/converters/mesh_optimizer.h"
+#include "core/debug.h"
+#include "core/misc.h"
+#include "core/vector.h"
+#include "math/vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Graphics
+{
+	namespace
+	{
+		/// LRU cache size modelled by Forsyth's scoring.
+		static const i32 FORSYTH_CACHE_SIZE = 32;
+		static const f32 FORSYTH_CACHE_DECAY_POWER = 1.5f;
+		static const f32 FORSYTH_LAST_TRI_SCORE = 0.75f;
+		static const f32 FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+		static const f32 FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+		f32 ForsythVertexScore(i32 cachePos, i32 numLiveTris)
+		{
+			// No triangles left to use this vertex.
+			if(numLiveTris == 0)
+				return -1.0f;
+
+			f32 score = 0.0f;
+			if(cachePos >= 0)
+			{
+				// Vertices of the last triangle get a fixed score, so it doesn't matter which way round it was added.
+				if(cachePos < 3)
+				{
+					score = FORSYTH_LAST_TRI_SCORE;
+				}
+				else
+				{
+					const f32 scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+					score = std::pow(1.0f - (cachePos - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+				}
+			}
+
+			// Boost vertices with few triangles left, so lone triangles get picked off.
+			score += FORSYTH_VALENCE_BOOST_SCALE * std::pow((f32)numLiveTris, -FORSYTH_VALENCE_BOOST_POWER);
+			return score;
+		}
+
+		/// Triangles using each vertex.
+		struct VertexTriangles
+		{
+			VertexTriangles(const u32* indices, i32 numIndices, i32 numVertices)
+			{
+				counts_.resize(numVertices, 0);
+				offsets_.resize(numVertices + 1, 0);
+				for(i32 idx = 0; idx < numIndices; ++idx)
+					++counts_[indices[idx]];
+				for(i32 idx = 0; idx < numVertices; ++idx)
+					offsets_[idx + 1] = offsets_[idx] + counts_[idx];
+
+				Core::Vector<i32> cursors(offsets_);
+				triangles_.resize(numIndices);
+				for(i32 idx = 0; idx < numIndices; ++idx)
+					triangles_[cursors[indices[idx]]++] = idx / 3;
+			}
+
+			Core::Vector<i32> counts_;
+			Core::Vector<i32> offsets_;
+			Core::Vector<i32> triangles_;
+		};
+
+		template<typename GET_POSITION>
+		void ComputeMeshletBounds(ModelMeshlet& meshlet, const u32* indices, const GET_POSITION& getPosition)
+		{
+			const u32* meshletIndices = indices + meshlet.indexOffset_;
+
+			// Sphere around centre of bounding box.
+			Math::Vec3 minimum = getPosition(meshletIndices[0]);
+			Math::Vec3 maximum = minimum;
+			for(i32 idx = 1; idx < meshlet.noofIndices_; ++idx)
+			{
+				const Math::Vec3 position = getPosition(meshletIndices[idx]);
+				minimum = Math::Vec3(Core::Min(minimum.x, position.x), Core::Min(minimum.y, position.y),
+				    Core::Min(minimum.z, position.z));
+				maximum = Math::Vec3(Core::Max(maximum.x, position.x), Core::Max(maximum.y, position.y),
+				    Core::Max(maximum.z, position.z));
+			}
+			meshlet.center_ = (minimum + maximum) * 0.5f;
+			meshlet.radius_ = 0.0f;
+			for(i32 idx = 0; idx < meshlet.noofIndices_; ++idx)
+				meshlet.radius_ =
+				    Core::Max(meshlet.radius_, (getPosition(meshletIndices[idx]) - meshlet.center_).Magnitude());
+
+			// Cone axis is the average triangle normal, and its angle the widest from that.
+			auto GetNormal = [meshletIndices, &getPosition](i32 idx, Math::Vec3& outNormal) {
+				const Math::Vec3 a = getPosition(meshletIndices[idx]);
+				const Math::Vec3 b = getPosition(meshletIndices[idx + 1]);
+				const Math::Vec3 c = getPosition(meshletIndices[idx + 2]);
+				outNormal = (b - a).Cross(c - a);
+				const f32 length = outNormal.Magnitude();
+				if(length <= 0.0f)
+					return false;
+				outNormal = outNormal / length;
+				return true;
+			};
+
+			Math::Vec3 axis(0.0f, 0.0f, 0.0f);
+			Math::Vec3 normal;
+			for(i32 idx = 0; idx < meshlet.noofIndices_; idx += 3)
+				if(GetNormal(idx, normal))
+					axis = axis + normal;
+
+			meshlet.coneAxis_ = Math::Vec3(0.0f, 0.0f, 1.0f);
+			meshlet.coneCutoff_ = 1.0f;
+			const f32 axisLength = axis.Magnitude();
+			if(axisLength <= 0.0f)
+				return;
+			axis = axis / axisLength;
+
+			f32 minDot = 1.0f;
+			for(i32 idx = 0; idx < meshlet.noofIndices_; idx += 3)
+				if(GetNormal(idx, normal))
+					minDot = Core::Min(minDot, normal.Dot(axis));
+
+			// Cones 90 degrees or wider always have some front faces in view, so keep the cutoff at 1.
+			meshlet.coneAxis_ = axis;
+			if(minDot > 0.0f)
+				meshlet.coneCutoff_ = std::sqrt(1.0f - minDot * minDot);
+		}
+
+		f32 SignNotZero(f32 value) { return value >= 0.0f ? 1.0f : -1.0f; }
+	}
+
+	MeshCacheStats AnalyzeVertexCache(const u32* indices, i32 numIndices, i32 numVertices, i32 cacheSize)
+	{
+		DBG_ASSERT(numIndices % 3 == 0);
+		DBG_ASSERT(cacheSize > 0);
+
+		MeshCacheStats stats;
+		if(numIndices == 0)
+			return stats;
+
+		// Timestamp each vertex entered the cache: it's still cached while within cacheSize misses.
+		Core::Vector<i32> timestamps;
+		timestamps.resize(numVertices, -1);
+		i32 numMisses = 0;
+		i32 numReferenced = 0;
+		for(i32 idx = 0; idx < numIndices; ++idx)
+		{
+			const u32 vertexIdx = indices[idx];
+			DBG_ASSERT((i32)vertexIdx < numVertices);
+			if(timestamps[vertexIdx] < 0)
+				++numReferenced;
+			if(timestamps[vertexIdx] < 0 || (numMisses - timestamps[vertexIdx]) > cacheSize)
+				timestamps[vertexIdx] = numMisses++;
+		}
+
+		stats.acmr_ = (f32)numMisses / (f32)(numIndices / 3);
+		stats.atvr_ = (f32)numMisses / (f32)numReferenced;
+		return stats;
+	}
+
+	void OptimizeVertexCache(u32* outIndices, const u32* indices, i32 numIndices, i32 numVertices)
+	{
+		DBG_ASSERT(numIndices % 3 == 0);
+		DBG_ASSERT(outIndices != indices);
+
+		const i32 numTris = numIndices / 3;
+		if(numTris == 0)
+			return;
+
+		VertexTriangles vertexTris(indices, numIndices, numVertices);
+		Core::Vector<i32>& numLiveTris = vertexTris.counts_;
+
+		Core::Vector<f32> vertexScores;
+		vertexScores.resize(numVertices);
+		for(i32 idx = 0; idx < numVertices; ++idx)
+			vertexScores[idx] = ForsythVertexScore(-1, numLiveTris[idx]);
+
+		Core::Vector<f32> triScores;
+		Core::Vector<u8> triEmitted;
+		triScores.resize(numTris);
+		triEmitted.resize(numTris, 0);
+		for(i32 triIdx = 0; triIdx < numTris; ++triIdx)
+		{
+			const u32* tri = indices + triIdx * 3;
+			triScores[triIdx] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+		}
+
+		// Room for a full cache plus the 3 vertices pushed in by a new triangle.
+		i32 cache[FORSYTH_CACHE_SIZE + 3];
+		i32 newCache[FORSYTH_CACHE_SIZE + 3];
+		i32 cacheSize = 0;
+
+		i32 bestTri = 0;
+		i32 inputCursor = 0;
+		for(i32 outTri = 0; outTri < numTris; ++outTri)
+		{
+			// Nothing in cache to carry on from, start with the next triangle in input order.
+			if(bestTri < 0)
+			{
+				while(triEmitted[inputCursor])
+					++inputCursor;
+				bestTri = inputCursor;
+			}
+
+			const u32* tri = indices + bestTri * 3;
+			memcpy(outIndices + outTri * 3, tri, sizeof(u32) * 3);
+			triEmitted[bestTri] = 1;
+
+			// Remove triangle from its vertices' live lists.
+			for(i32 corner = 0; corner < 3; ++corner)
+			{
+				const u32 vertexIdx = tri[corner];
+				i32* vertexTriangles = vertexTris.triangles_.data() + vertexTris.offsets_[vertexIdx];
+				i32& numVertexTris = numLiveTris[vertexIdx];
+				for(i32 idx = 0; idx < numVertexTris; ++idx)
+				{
+					if(vertexTriangles[idx] == bestTri)
+					{
+						vertexTriangles[idx] = vertexTriangles[numVertexTris - 1];
+						--numVertexTris;
+						break;
+					}
+				}
+			}
+
+			// New triangle's vertices go to the front of the cache.
+			i32 newCacheSize = 0;
+			for(i32 corner = 0; corner < 3; ++corner)
+				newCache[newCacheSize++] = tri[corner];
+			for(i32 idx = 0; idx < cacheSize; ++idx)
+			{
+				const i32 vertexIdx = cache[idx];
+				if(vertexIdx != (i32)tri[0] && vertexIdx != (i32)tri[1] && vertexIdx != (i32)tri[2])
+					newCache[newCacheSize++] = vertexIdx;
+			}
+
+			// Vertices pushed out of the cache.
+			for(i32 idx = FORSYTH_CACHE_SIZE; idx < newCacheSize; ++idx)
+			{
+				const i32 vertexIdx = newCache[idx];
+				const f32 score = ForsythVertexScore(-1, numLiveTris[vertexIdx]);
+				const f32 delta = score - vertexScores[vertexIdx];
+				vertexScores[vertexIdx] = score;
+				const i32* vertexTriangles = vertexTris.triangles_.data() + vertexTris.offsets_[vertexIdx];
+				for(i32 triIdx = 0; triIdx < numLiveTris[vertexIdx]; ++triIdx)
+					triScores[vertexTriangles[triIdx]] += delta;
+			}
+			cacheSize = Core::Min(newCacheSize, FORSYTH_CACHE_SIZE);
+			memcpy(cache, newCache, sizeof(i32) * cacheSize);
+
+			// Rescore cached vertices and their triangles.
+			for(i32 idx = 0; idx < cacheSize; ++idx)
+			{
+				const i32 vertexIdx = cache[idx];
+				const f32 score = ForsythVertexScore(idx, numLiveTris[vertexIdx]);
+				const f32 delta = score - vertexScores[vertexIdx];
+				vertexScores[vertexIdx] = score;
+				const i32* vertexTriangles = vertexTris.triangles_.data() + vertexTris.offsets_[vertexIdx];
+				for(i32 triIdx = 0; triIdx < numLiveTris[vertexIdx]; ++triIdx)
+					triScores[vertexTriangles[triIdx]] += delta;
+			}
+
+			// Best next triangle is one using a cached vertex.
+			bestTri = -1;
+			f32 bestScore = -1.0f;
+			for(i32 idx = 0; idx < cacheSize; ++idx)
+			{
+				const i32 vertexIdx = cache[idx];
+				const i32* vertexTriangles = vertexTris.triangles_.data() + vertexTris.offsets_[vertexIdx];
+				for(i32 triIdx = 0; triIdx < numLiveTris[vertexIdx]; ++triIdx)
+				{
+					const i32 candidate = vertexTriangles[triIdx];
+					if(triScores[candidate] > bestScore)
+					{
+						bestScore = triScores[candidate];
+						bestTri = candidate;
+					}
+				}
+			}
+		}
+	}
+
+	void OptimizeOverdraw(u32* outIndices, const u32* indices, i32 numIndices, const f32* positions,
+	    i32 positionStride, i32 numVertices, i32 cacheSize, f32 threshold)
+	{
+		DBG_ASSERT(numIndices % 3 == 0);
+		DBG_ASSERT(outIndices != indices);
+
+		const i32 numTris = numIndices / 3;
+		memcpy(outIndices, indices, sizeof(u32) * numIndices);
+		if(numTris == 0)
+			return;
+
+		auto GetPosition = [positions, positionStride](u32 vertexIdx) {
+			const f32* position = (const f32*)((const u8*)positions + vertexIdx * positionStride);
+			return Math::Vec3(position[0], position[1], position[2]);
+		};
+
+		// Split into clusters where all of a triangle's vertices miss the cache.
+		Core::Vector<i32> clusterStarts;
+		Core::Vector<i32> timestamps;
+		timestamps.resize(numVertices, -1);
+		i32 numMisses = 0;
+		for(i32 triIdx = 0; triIdx < numTris; ++triIdx)
+		{
+			i32 numTriMisses = 0;
+			for(i32 corner = 0; corner < 3; ++corner)
+			{
+				const u32 vertexIdx = indices[triIdx * 3 + corner];
+				if(timestamps[vertexIdx] < 0 || (numMisses - timestamps[vertexIdx]) > cacheSize)
+				{
+					timestamps[vertexIdx] = numMisses++;
+					++numTriMisses;
+				}
+			}
+			if(numTriMisses == 3)
+				clusterStarts.push_back(triIdx);
+		}
+		clusterStarts.push_back(numTris);
+
+		const i32 numClusters = clusterStarts.size() - 1;
+		if(numClusters <= 1)
+			return;
+
+		// Area weighted centroid & normal of each cluster, and of the whole mesh.
+		Core::Vector<Math::Vec3> clusterCentroids;
+		Core::Vector<Math::Vec3> clusterNormals;
+		clusterCentroids.resize(numClusters);
+		clusterNormals.resize(numClusters);
+		Math::Vec3 meshCentroid(0.0f, 0.0f, 0.0f);
+		f32 meshArea = 0.0f;
+		for(i32 clusterIdx = 0; clusterIdx < numClusters; ++clusterIdx)
+		{
+			Math::Vec3 centroid(0.0f, 0.0f, 0.0f);
+			Math::Vec3 normal(0.0f, 0.0f, 0.0f);
+			f32 area = 0.0f;
+			for(i32 triIdx = clusterStarts[clusterIdx]; triIdx < clusterStarts[clusterIdx + 1]; ++triIdx)
+			{
+				const Math::Vec3 a = GetPosition(indices[triIdx * 3 + 0]);
+				const Math::Vec3 b = GetPosition(indices[triIdx * 3 + 1]);
+				const Math::Vec3 c = GetPosition(indices[triIdx * 3 + 2]);
+				const Math::Vec3 triNormal = (b - a).Cross(c - a);
+				const f32 triArea = triNormal.Magnitude();
+				centroid += (a + b + c) * (triArea / 3.0f);
+				normal += triNormal;
+				area += triArea;
+			}
+
+			meshCentroid += centroid;
+			meshArea += area;
+			clusterCentroids[clusterIdx] = area > 0.0f ? centroid / area : centroid;
+			clusterNormals[clusterIdx] = normal;
+		}
+		if(meshArea > 0.0f)
+			meshCentroid = meshCentroid / meshArea;
+
+		// Clusters facing away from the centre are more likely to occlude others, so draw them first.
+		Core::Vector<f32> sortKeys;
+		Core::Vector<i32> clusterOrder;
+		sortKeys.resize(numClusters);
+		clusterOrder.resize(numClusters);
+		for(i32 clusterIdx = 0; clusterIdx < numClusters; ++clusterIdx)
+		{
+			const Math::Vec3& normal = clusterNormals[clusterIdx];
+			const f32 normalLength = normal.Magnitude();
+			sortKeys[clusterIdx] = normalLength > 0.0f
+			                           ? (clusterCentroids[clusterIdx] - meshCentroid).Dot(normal) / normalLength
+			                           : 0.0f;
+			clusterOrder[clusterIdx] = clusterIdx;
+		}
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+		    [&sortKeys](i32 a, i32 b) { return sortKeys[a] > sortKeys[b]; });
+
+		i32 outIdx = 0;
+		for(i32 clusterIdx : clusterOrder)
+		{
+			const i32 begin = clusterStarts[clusterIdx] * 3;
+			const i32 end = clusterStarts[clusterIdx + 1] * 3;
+			memcpy(outIndices + outIdx, indices + begin, sizeof(u32) * (end - begin));
+			outIdx += end - begin;
+		}
+		DBG_ASSERT(outIdx == numIndices);
+
+		// Keep input order if reordering clusters costs too much vertex cache efficiency.
+		const f32 inputACMR = AnalyzeVertexCache(indices, numIndices, numVertices, cacheSize).acmr_;
+		const f32 outputACMR = AnalyzeVertexCache(outIndices, numIndices, numVertices, cacheSize).acmr_;
+		if(outputACMR > inputACMR * threshold)
+			memcpy(outIndices, indices, sizeof(u32) * numIndices);
+	}
+
+	i32 OptimizeVertexFetchRemap(u32* outRemap, const u32* indices, i32 numIndices, i32 numVertices)
+	{
+		memset(outRemap, 0xff, sizeof(u32) * numVertices);
+
+		u32 numReferenced = 0;
+		for(i32 idx = 0; idx < numIndices; ++idx)
+		{
+			const u32 vertexIdx = indices[idx];
+			DBG_ASSERT((i32)vertexIdx < numVertices);
+			if(outRemap[vertexIdx] == 0xffffffff)
+				outRemap[vertexIdx] = numReferenced++;
+		}
+
+		u32 nextIdx = numReferenced;
+		for(i32 idx = 0; idx < numVertices; ++idx)
+			if(outRemap[idx] == 0xffffffff)
+				outRemap[idx] = nextIdx++;
+
+		return (i32)numReferenced;
+	}
+
+	void RemapIndices(u32* indices, i32 numIndices, const u32* remap)
+	{
+		for(i32 idx = 0; idx < numIndices; ++idx)
+			indices[idx] = remap[indices[idx]];
+	}
+
+	void RemapVertices(void* outVertices, const void* vertices, i32 numVertices, i32 stride, const u32* remap)
+	{
+		DBG_ASSERT(outVertices != vertices);
+		u8* outData = static_cast<u8*>(outVertices);
+		const u8* inData = static_cast<const u8*>(vertices);
+		for(i32 idx = 0; idx < numVertices; ++idx)
+			memcpy(outData + remap[idx] * stride, inData + idx * stride, stride);
+	}
+
+	i32 BuildMeshlets(Core::Vector<ModelMeshlet>& outMeshlets, const u32* indices, i32 numIndices,
+	    const f32* positions, i32 positionStride, i32 numVertices, i32 maxVertices, i32 maxTriangles)
+	{
+		DBG_ASSERT(numIndices % 3 == 0);
+		DBG_ASSERT(maxVertices >= 3);
+		DBG_ASSERT(maxTriangles > 0);
+		outMeshlets.clear();
+
+		auto GetPosition = [positions, positionStride](u32 vertexIdx) {
+			const f32* position = (const f32*)((const u8*)positions + vertexIdx * positionStride);
+			return Math::Vec3(position[0], position[1], position[2]);
+		};
+
+		// Meshlet each vertex was last added to, to count unique vertices.
+		Core::Vector<i32> vertexMeshlets;
+		vertexMeshlets.resize(numVertices, -1);
+
+		ModelMeshlet meshlet;
+		i32 numMeshletVertices = 0;
+		for(i32 idx = 0; idx < numIndices; idx += 3)
+		{
+			i32 numNewVertices = 0;
+			for(i32 corner = 0; corner < 3; ++corner)
+			{
+				DBG_ASSERT((i32)indices[idx + corner] < numVertices);
+				if(vertexMeshlets[indices[idx + corner]] != outMeshlets.size())
+					++numNewVertices;
+			}
+
+			// Start a new meshlet when this triangle doesn't fit.
+			if(meshlet.noofIndices_ > 0 &&
+			    ((numMeshletVertices + numNewVertices) > maxVertices || (meshlet.noofIndices_ / 3) >= maxTriangles))
+			{
+				ComputeMeshletBounds(meshlet, indices, GetPosition);
+				outMeshlets.push_back(meshlet);
+
+				meshlet = ModelMeshlet();
+				meshlet.indexOffset_ = idx;
+				numMeshletVertices = 0;
+			}
+
+			for(i32 corner = 0; corner < 3; ++corner)
+			{
+				i32& vertexMeshlet = vertexMeshlets[indices[idx + corner]];
+				if(vertexMeshlet != outMeshlets.size())
+				{
+					vertexMeshlet = outMeshlets.size();
+					++numMeshletVertices;
+				}
+			}
+			meshlet.noofIndices_ += 3;
+		}
+
+		if(meshlet.noofIndices_ > 0)
+		{
+			ComputeMeshletBounds(meshlet, indices, GetPosition);
+			outMeshlets.push_back(meshlet);
+		}
+
+		return outMeshlets.size();
+	}
+
+	void QuantizePositions(f32* outPositions, const f32* positions, i32 positionStride, i32 numVertices,
+	    const f32* boundsMin, const f32* boundsMax)
+	{
+		f32 scale[3];
+		for(i32 axis = 0; axis < 3; ++axis)
+		{
+			const f32 extent = boundsMax[axis] - boundsMin[axis];
+			scale[axis] = extent > 0.0f ? 1.0f / extent : 0.0f;
+		}
+
+		for(i32 idx = 0; idx < numVertices; ++idx)
+		{
+			const f32* position = (const f32*)((const u8*)positions + idx * positionStride);
+			for(i32 axis = 0; axis < 3; ++axis)
+				outPositions[idx * 3 + axis] =
+				    Core::Clamp((position[axis] - boundsMin[axis]) * scale[axis], 0.0f, 1.0f);
+		}
+	}
+
+	void EncodeOctahedral(f32* outEncoded, const f32* vectors, i32 vectorStride, i32 numVectors)
+	{
+		for(i32 idx = 0; idx < numVectors; ++idx)
+		{
+			const f32* vector = (const f32*)((const u8*)vectors + idx * vectorStride);
+			f32* encoded = outEncoded + idx * 2;
+
+			// Project onto octahedron, then fold lower hemisphere over the upper one.
+			const f32 length = std::abs(vector[0]) + std::abs(vector[1]) + std::abs(vector[2]);
+			const f32 scale = length > 0.0f ? 1.0f / length : 0.0f;
+			const f32 x = vector[0] * scale;
+			const f32 y = vector[1] * scale;
+			if(vector[2] >= 0.0f)
+			{
+				encoded[0] = x;
+				encoded[1] = y;
+			}
+			else
+			{
+				encoded[0] = (1.0f - std::abs(y)) * SignNotZero(x);
+				encoded[1] = (1.0f - std::abs(x)) * SignNotZero(y);
+			}
+		}
+	}
+
+	void DecodeOctahedral(f32* outVectors, const f32* encoded, i32 numVectors)
+	{
+		for(i32 idx = 0; idx < numVectors; ++idx)
+		{
+			f32 x = encoded[idx * 2];
+			f32 y = encoded[idx * 2 + 1];
+			const f32 z = 1.0f - std::abs(x) - std::abs(y);
+			if(z < 0.0f)
+			{
+				const f32 foldedX = (1.0f - std::abs(y)) * SignNotZero(x);
+				y = (1.0f - std::abs(x)) * SignNotZero(y);
+				x = foldedX;
+			}
+
+			const Math::Vec3 vector = Math::Vec3(x, y, z).Normal();
+			outVectors[idx * 3] = vector.x;
+			outVectors[idx * 3 + 1] = vector.y;
+			outVectors[idx * 3 + 2] = vector.z;
+		}
+	}
+
+} // namespace Graphics
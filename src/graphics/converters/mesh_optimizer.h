@@ -0,0 +1,98 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/vector.h"
+#include "graphics/model.h"
+
+namespace Graphics
+{
+	/**
+	 * Post-transform vertex cache statistics for an indexed triangle list.
+	 */
+	struct MeshCacheStats
+	{
+		/// Average cache miss ratio: transformed vertices per triangle. 0.5 is ideal for large regular meshes.
+		f32 acmr_ = 0.0f;
+		/// Average transform to vertex ratio: transformed vertices per referenced vertex. 1.0 is ideal.
+		f32 atvr_ = 0.0f;
+	};
+
+	/**
+	 * Simulate a FIFO post-transform cache of @a cacheSize vertices over an indexed triangle list.
+	 */
+	MeshCacheStats AnalyzeVertexCache(const u32* indices, i32 numIndices, i32 numVertices, i32 cacheSize = 16);
+
+	/**
+	 * Reorder triangles for post-transform cache efficiency, using Tom Forsyth's
+	 * "Linear-Speed Vertex Cache Optimisation".
+	 * @param outIndices Reordered indices. Must not alias @a indices.
+	 */
+	void OptimizeVertexCache(u32* outIndices, const u32* indices, i32 numIndices, i32 numVertices);
+
+	/**
+	 * Reorder clusters of cache optimized triangles to reduce overdraw, after Sander et al's
+	 * "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+	 * Clusters start where the cache has to be refilled, and are sorted so those facing out from the
+	 * mesh's centre are drawn first.
+	 * The new order is only used if its ACMR is within @a threshold of the input's.
+	 * @param outIndices Reordered indices. Must not alias @a indices.
+	 * @param positions First position, 3 floats.
+	 * @param positionStride Bytes between positions.
+	 */
+	void OptimizeOverdraw(u32* outIndices, const u32* indices, i32 numIndices, const f32* positions,
+	    i32 positionStride, i32 numVertices, i32 cacheSize = 16, f32 threshold = 1.05f);
+
+	/**
+	 * Build remap table that orders vertices by first use in @a indices, for fetch locality.
+	 * Unreferenced vertices are placed at the end.
+	 * @param outRemap New index of each vertex.
+	 * @return Number of referenced vertices.
+	 */
+	i32 OptimizeVertexFetchRemap(u32* outRemap, const u32* indices, i32 numIndices, i32 numVertices);
+
+	/**
+	 * Apply remap table to indices, in place.
+	 */
+	void RemapIndices(u32* indices, i32 numIndices, const u32* remap);
+
+	/**
+	 * Apply remap table to vertices of @a stride bytes.
+	 * @param outVertices Remapped vertices. Must not alias @a vertices.
+	 */
+	void RemapVertices(void* outVertices, const void* vertices, i32 numVertices, i32 stride, const u32* remap);
+
+	/**
+	 * Split triangle list into meshlets of at most @a maxVertices unique vertices and @a maxTriangles triangles.
+	 * Triangles are taken in order, so each meshlet is a contiguous range of @a indices. Run after
+	 * OptimizeVertexCache, which keeps neighbouring triangles together.
+	 * Cone bounds assume clockwise front faces, as output by the model converter.
+	 * @param positions First position, 3 floats.
+	 * @param positionStride Bytes between positions.
+	 * @return Number of meshlets.
+	 */
+	i32 BuildMeshlets(Core::Vector<ModelMeshlet>& outMeshlets, const u32* indices, i32 numIndices,
+	    const f32* positions, i32 positionStride, i32 numVertices, i32 maxVertices = 64, i32 maxTriangles = 124);
+
+	/**
+	 * Encode positions relative to bounds, as 3 floats in [0, 1] ready to convert to a UNORM format.
+	 * Axes with no extent encode as 0.
+	 * @param positions First position, 3 floats.
+	 * @param positionStride Bytes between positions.
+	 * @param boundsMin, boundsMax Bounds of all positions, 3 floats.
+	 */
+	void QuantizePositions(f32* outPositions, const f32* positions, i32 positionStride, i32 numVertices,
+	    const f32* boundsMin, const f32* boundsMax);
+
+	/**
+	 * Encode unit vectors with an octahedral mapping, as 2 floats in [-1, 1] ready to convert to a SNORM format.
+	 * @param vectors First vector, 3 floats.
+	 * @param vectorStride Bytes between vectors.
+	 */
+	void EncodeOctahedral(f32* outEncoded, const f32* vectors, i32 vectorStride, i32 numVectors);
+
+	/**
+	 * Decode unit vectors written by EncodeOctahedral, as 3 floats each.
+	 */
+	void DecodeOctahedral(f32* outVectors, const f32* encoded, i32 numVectors);
+
+} // namespace Graphics
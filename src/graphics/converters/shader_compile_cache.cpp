@@ -0,0 +1,190 @@
+#include "graphics/converters/shader_compile_cache.h"
+#include "core/debug.h"
+#include "core/file.h"
+
+#include <cstring>
+
+namespace Graphics
+{
+	namespace
+	{
+		bool WriteBindings(Core::File& file, const Core::Vector<ShaderBinding>& bindings)
+		{
+			for(const auto& binding : bindings)
+			{
+				const i32 nameLength = binding.name_.size();
+				if(file.Write(&binding.slot_, sizeof(i32)) != sizeof(i32) ||
+				    file.Write(&nameLength, sizeof(i32)) != sizeof(i32) ||
+				    file.Write(binding.name_.c_str(), nameLength) != nameLength)
+					return false;
+			}
+			return true;
+		}
+
+		bool ReadBindings(Core::File& file, i32 num, Core::Vector<ShaderBinding>& outBindings)
+		{
+			Core::Vector<char> name;
+			for(i32 idx = 0; idx < num; ++idx)
+			{
+				i32 slot = 0;
+				i32 nameLength = 0;
+				if(file.Read(&slot, sizeof(i32)) != sizeof(i32) ||
+				    file.Read(&nameLength, sizeof(i32)) != sizeof(i32) || nameLength < 0)
+					return false;
+
+				name.resize(nameLength + 1, '\0');
+				if(file.Read(name.data(), nameLength) != nameLength)
+					return false;
+				name[nameLength] = '\0';
+				outBindings.emplace_back(slot, name.data());
+			}
+			return true;
+		}
+	}
+
+	ShaderCompileCache::ShaderCompileCache(const char* path, const char* compilerVersion)
+	    : path_(path)
+	    , compilerVersion_(compilerVersion)
+	{
+		Core::FileCreateDir(path);
+	}
+
+	ShaderCompileCache::~ShaderCompileCache()
+	{
+		for(u8* data : entryData_)
+			delete[] data;
+	}
+
+	Core::HashSHA1Digest ShaderCompileCache::GetKey(
+	    const char* name, const char* source, const char* entryPoint, const char* target) const
+	{
+		// Separators keep inputs from running into each other.
+		Core::String key;
+		key.Printf("%s\n%s\n%s\n%s\n", compilerVersion_.c_str(), name, target, entryPoint);
+		key.Append(source);
+		return Core::HashSHA1(key.c_str(), key.size());
+	}
+
+	bool ShaderCompileCache::Find(const Core::HashSHA1Digest& key, ShaderCompileOutput& outOutput)
+	{
+		const Core::String entryPath = GetEntryPath(key);
+		auto OnMiss = [this]() {
+			Core::AtomicInc(&stats_.numMisses_);
+			return false;
+		};
+
+		if(!Core::FileExists(entryPath.c_str()))
+			return OnMiss();
+
+		Core::File file(entryPath.c_str(), Core::FileFlags::READ);
+		if(!file)
+			return OnMiss();
+
+		ShaderCompileCacheHeader header;
+		if(file.Read(&header, sizeof(header)) != sizeof(header))
+			return OnMiss();
+
+		if(header.magic_ != ShaderCompileCacheHeader::MAGIC ||
+		    header.majorVersion_ != ShaderCompileCacheHeader::MAJOR_VERSION)
+			return OnMiss();
+
+		const i64 numBytes =
+		    (i64)header.numByteCodeBytes_ + (i64)header.numStrippedByteCodeBytes_ + (i64)header.numErrorBytes_;
+		if(header.numByteCodeBytes_ <= 0 || header.numStrippedByteCodeBytes_ < 0 || header.numErrorBytes_ < 0)
+			return OnMiss();
+
+		u8* data = new u8[numBytes];
+		ShaderCompileOutput output;
+		output.type_ = header.type_;
+		bool succeeded = file.Read(data, numBytes) == numBytes;
+		succeeded = succeeded && ReadBindings(file, header.numCBuffers_, output.cbuffers_);
+		succeeded = succeeded && ReadBindings(file, header.numSamplers_, output.samplers_);
+		succeeded = succeeded && ReadBindings(file, header.numSRVs_, output.srvs_);
+		succeeded = succeeded && ReadBindings(file, header.numUAVs_, output.uavs_);
+		if(!succeeded)
+		{
+			delete[] data;
+			return OnMiss();
+		}
+
+		output.byteCodeBegin_ = data;
+		output.byteCodeEnd_ = output.byteCodeBegin_ + header.numByteCodeBytes_;
+		output.byteCodeHash_ = Core::HashSHA1(output.byteCodeBegin_, header.numByteCodeBytes_);
+		if(header.numStrippedByteCodeBytes_ > 0)
+		{
+			output.strippedByteCodeBegin_ = output.byteCodeEnd_;
+			output.strippedByteCodeEnd_ = output.strippedByteCodeBegin_ + header.numStrippedByteCodeBytes_;
+			output.strippedByteCodeHash_ =
+			    Core::HashSHA1(output.strippedByteCodeBegin_, header.numStrippedByteCodeBytes_);
+		}
+		if(header.numErrorBytes_ > 0)
+		{
+			output.errorsBegin_ = (const char*)(output.byteCodeEnd_ + header.numStrippedByteCodeBytes_);
+			output.errorsEnd_ = output.errorsBegin_ + header.numErrorBytes_;
+			output.errorsHash_ = Core::HashSHA1(output.errorsBegin_, header.numErrorBytes_);
+		}
+
+		{
+			Core::ScopedMutex lock(mutex_);
+			entryData_.push_back(data);
+		}
+
+		outOutput = output;
+		Core::AtomicInc(&stats_.numHits_);
+		return true;
+	}
+
+	bool ShaderCompileCache::Store(const Core::HashSHA1Digest& key, const ShaderCompileOutput& output)
+	{
+		DBG_ASSERT(output);
+
+		ShaderCompileCacheHeader header;
+		header.type_ = output.type_;
+		header.numByteCodeBytes_ = (i32)(output.byteCodeEnd_ - output.byteCodeBegin_);
+		header.numStrippedByteCodeBytes_ = (i32)(output.strippedByteCodeEnd_ - output.strippedByteCodeBegin_);
+		header.numErrorBytes_ = (i32)(output.errorsEnd_ - output.errorsBegin_);
+		header.numCBuffers_ = output.cbuffers_.size();
+		header.numSamplers_ = output.samplers_.size();
+		header.numSRVs_ = output.srvs_.size();
+		header.numUAVs_ = output.uavs_.size();
+
+		// Write to a temporary file, so a failed or concurrent store never leaves a partial entry behind.
+		const Core::String entryPath = GetEntryPath(key);
+		Core::String tempPath;
+		tempPath.Printf("%s.%d.tmp", entryPath.c_str(), Core::AtomicInc(&nextTempIdx_));
+		Core::File file(tempPath.c_str(), Core::FileFlags::DEFAULT_WRITE);
+		if(!file)
+			return false;
+
+		auto WriteBytes = [&file](const void* data, i32 numBytes) {
+			return numBytes == 0 || file.Write(data, numBytes) == numBytes;
+		};
+
+		bool succeeded = WriteBytes(&header, sizeof(header));
+		succeeded = succeeded && WriteBytes(output.byteCodeBegin_, header.numByteCodeBytes_);
+		succeeded = succeeded && WriteBytes(output.strippedByteCodeBegin_, header.numStrippedByteCodeBytes_);
+		succeeded = succeeded && WriteBytes(output.errorsBegin_, header.numErrorBytes_);
+		succeeded = succeeded && WriteBindings(file, output.cbuffers_);
+		succeeded = succeeded && WriteBindings(file, output.samplers_);
+		succeeded = succeeded && WriteBindings(file, output.srvs_);
+		succeeded = succeeded && WriteBindings(file, output.uavs_);
+		file = Core::File();
+
+		// Entries are immutable, so if another store of the same key won the rename, its data is the same.
+		if(succeeded && !Core::FileRename(tempPath.c_str(), entryPath.c_str()))
+			succeeded = Core::FileExists(entryPath.c_str());
+		if(Core::FileExists(tempPath.c_str()))
+			Core::FileRemove(tempPath.c_str());
+		return succeeded;
+	}
+
+	Core::String ShaderCompileCache::GetEntryPath(const Core::HashSHA1Digest& key) const
+	{
+		Core::String entryPath;
+		entryPath.Printf("%s/", path_.c_str());
+		for(u8 byte : key.data8_)
+			entryPath.Appendf("%02x", byte);
+		entryPath.Append(".bin");
+		return entryPath;
+	}
+} // namespace Graphics
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "graphics/converters/shader_compiler_hlsl.h"
+#include "core/concurrency.h"
+#include "core/string.h"
+#include "core/vector.h"
+
+namespace Graphics
+{
+	struct ShaderCompileCacheHeader
+	{
+		/// Magic number.
+		static const u32 MAGIC = 0x43435345;
+		/// Major version signifies a breaking change to the binary format.
+		static const i16 MAJOR_VERSION = 0x0001;
+		/// Minor version signifies non-breaking change to binary format.
+		static const i16 MINOR_VERSION = 0x0000;
+
+		u32 magic_ = MAGIC;
+		i16 majorVersion_ = MAJOR_VERSION;
+		i16 minorVersion_ = MINOR_VERSION;
+
+		GPU::ShaderType type_ = GPU::ShaderType::INVALID;
+		i32 numByteCodeBytes_ = 0;
+		i32 numStrippedByteCodeBytes_ = 0;
+		i32 numErrorBytes_ = 0;
+		i32 numCBuffers_ = 0;
+		i32 numSamplers_ = 0;
+		i32 numSRVs_ = 0;
+		i32 numUAVs_ = 0;
+	};
+
+	struct ShaderCompileCacheStats
+	{
+		volatile i32 numHits_ = 0;
+		volatile i32 numMisses_ = 0;
+	};
+
+	/**
+	 * Content addressed cache of shader compiler output on disk.
+	 * Entries are keyed by everything that affects compilation, so no invalidation is needed.
+	 * All methods are thread safe.
+	 */
+	class ShaderCompileCache
+	{
+	public:
+		/**
+		 * @param path Directory to store entries in. Created if it doesn't exist.
+		 * @param compilerVersion Identifies compiler & settings, so cache misses when they change.
+		 */
+		ShaderCompileCache(const char* path, const char* compilerVersion);
+		~ShaderCompileCache();
+
+		/**
+		 * Get key for compiling @a entryPoint from @a source with @a target profile.
+		 * @param name Shader name passed to the compiler, which is embedded in debug bytecode.
+		 */
+		Core::HashSHA1Digest GetKey(
+		    const char* name, const char* source, const char* entryPoint, const char* target) const;
+
+		/**
+		 * Find cached compile output.
+		 * @return true if found. Output is only valid to use while this cache remains in scope.
+		 */
+		bool Find(const Core::HashSHA1Digest& key, ShaderCompileOutput& outOutput);
+
+		/**
+		 * Store successful compile output.
+		 * Written to a temporary file then renamed, so readers never see a partial entry.
+		 */
+		bool Store(const Core::HashSHA1Digest& key, const ShaderCompileOutput& output);
+
+		const ShaderCompileCacheStats& GetStats() const { return stats_; }
+
+	private:
+		Core::String GetEntryPath(const Core::HashSHA1Digest& key) const;
+
+		Core::String path_;
+		Core::String compilerVersion_;
+		ShaderCompileCacheStats stats_;
+
+		// Data loaded by Find, referenced by its outputs.
+		Core::Mutex mutex_;
+		Core::Vector<u8*> entryData_;
+
+		// Makes temporary file names unique between threads storing the same key.
+		volatile i32 nextTempIdx_ = 0;
+	};
+} // namespace Graphics
@@ -1,5 +1,6 @@
 #include "graphics/converters/shader_compiler_hlsl.h"
 
+#include "core/concurrency.h"
 #include "core/library.h"
 
 #include <cstdarg>
@@ -13,20 +14,26 @@ const GUID IID_ID3D11ShaderReflection = {0x8d536ca1, 0x0cca, 0x4956, {0xa8, 0x37
 
 namespace Graphics
 {
+	static const u32 COMPILE_FLAGS = D3DCOMPILE_OPTIMIZATION_LEVEL3 | D3DCOMPILE_DEBUG;
+
 	struct ShaderCompilerHLSLImpl
 	{
 		Core::LibHandle d3dCompilerLib_;
+		Core::String version_;
 
 		decltype(D3DCompile)* d3dCompile_;
 		decltype(D3DStripShader)* d3dStripShader_;
 		decltype(D3DReflect)* d3dReflect_;
 
+		// Guards blobs, as compiles may run concurrently.
+		Core::Mutex mutex_;
 		Core::Vector<ComPtr<ID3DBlob>> byteCodes_;
 		Core::Vector<ComPtr<ID3DBlob>> strippedByteCodes_;
 		Core::Vector<ComPtr<ID3DBlob>> errors_;
 
 		ShaderCompilerHLSLImpl()
 		{
+			version_.Printf("%s/%x", D3DCOMPILER_DLL_A, COMPILE_FLAGS);
 			d3dCompilerLib_ = Core::LibraryOpen(D3DCOMPILER_DLL_A);
 			DBG_ASSERT(d3dCompilerLib_);
 			if(d3dCompilerLib_)
@@ -61,6 +68,8 @@ namespace Graphics
 		impl_ = nullptr;
 	}
 
+	const char* ShaderCompilerHLSL::GetVersion() const { return impl_->version_.c_str(); }
+
 	ShaderCompileOutput ShaderCompilerHLSL::Compile(const char* shaderName, const char* shaderSource,
 	    const char* entryPoint, GPU::ShaderType type, const char* target)
 	{
@@ -69,13 +78,13 @@ namespace Graphics
 		ComPtr<ID3DBlob> byteCode;
 		ComPtr<ID3DBlob> errors;
 		HRESULT retVal = impl_->d3dCompile_(shaderSource, strlen(shaderSource), shaderName, nullptr, nullptr,
-		    entryPoint, target, D3DCOMPILE_OPTIMIZATION_LEVEL3 | D3DCOMPILE_DEBUG, 0, byteCode.ReleaseAndGetAddressOf(),
-		    errors.ReleaseAndGetAddressOf());
+		    entryPoint, target, COMPILE_FLAGS, 0, byteCode.ReleaseAndGetAddressOf(), errors.ReleaseAndGetAddressOf());
 
 		ShaderCompileOutput output;
 
 		if(errors)
 		{
+			Core::ScopedMutex lock(impl_->mutex_);
 			impl_->errors_.push_back(errors);
 
 			output.errorsBegin_ = (const char*)errors->GetBufferPointer();
@@ -85,7 +94,10 @@ namespace Graphics
 
 		if(SUCCEEDED(retVal))
 		{
-			impl_->byteCodes_.push_back(byteCode);
+			{
+				Core::ScopedMutex lock(impl_->mutex_);
+				impl_->byteCodes_.push_back(byteCode);
+			}
 
 			output.byteCodeBegin_ = (const u8*)byteCode->GetBufferPointer();
 			output.byteCodeEnd_ = output.byteCodeBegin_ + byteCode->GetBufferSize();
@@ -99,7 +111,10 @@ namespace Graphics
 			    strippedByteCode.ReleaseAndGetAddressOf());
 			if(SUCCEEDED(retVal))
 			{
-				impl_->strippedByteCodes_.push_back(strippedByteCode);
+				{
+					Core::ScopedMutex lock(impl_->mutex_);
+					impl_->strippedByteCodes_.push_back(strippedByteCode);
+				}
 
 				output.strippedByteCodeBegin_ = (const u8*)strippedByteCode->GetBufferPointer();
 				output.strippedByteCodeEnd_ = output.strippedByteCodeBegin_ + strippedByteCode->GetBufferSize();
@@ -48,7 +48,12 @@ namespace Graphics
 		virtual ~ShaderCompilerHLSL();
 
 		/**
-		 * Compile shader.
+		 * @return Compiler version & settings, to identify its output.
+		 */
+		const char* GetVersion() const;
+
+		/**
+		 * Compile shader. Safe to call from multiple threads.
 		 * @return Compile output. Contains errors and bytecode (if successful). Only valid to use while this ShaderCompilerHLSL object remains in scope.
 		 */
 		ShaderCompileOutput Compile(const char* shaderName, const char* shaderSource, const char* entryPoint,
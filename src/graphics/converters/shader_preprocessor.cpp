@@ -14,8 +14,52 @@ namespace
 
 namespace Graphics
 {
-	ShaderPreprocessor::ShaderPreprocessor()
-	    : allocator_(256 * 1024)
+	ShaderIncludeCache::~ShaderIncludeCache()
+	{
+		for(auto it : files_)
+			delete it.value;
+		for(auto* file : staleFiles_)
+			delete file;
+	}
+
+	const ShaderIncludeFile* ShaderIncludeCache::GetFile(const char* path)
+	{
+		Core::FileTimestamp timestamp;
+		if(!Core::FileStats(path, nullptr, &timestamp, nullptr))
+			return nullptr;
+
+		Core::ScopedMutex lock(mutex_);
+		ShaderIncludeFile** cachedFile = files_.find(path);
+		if(cachedFile && (*cachedFile)->timestamp_ == timestamp)
+		{
+			Core::AtomicInc(&stats_.numHits_);
+			return *cachedFile;
+		}
+
+		Core::File file(path, Core::FileFlags::DEFAULT_READ);
+		if(!file)
+			return nullptr;
+
+		Core::Vector<char> data;
+		data.resize((i32)file.Size() + 1, '\0');
+		if(file.Read(data.data(), file.Size()) != file.Size())
+			return nullptr;
+
+		auto* includeFile = new ShaderIncludeFile();
+		includeFile->data_ = Core::String(data.data()).replace("\r\n", "\n");
+		includeFile->hash_ = Core::HashSHA1(includeFile->data_.c_str(), includeFile->data_.size());
+		includeFile->timestamp_ = timestamp;
+
+		if(cachedFile)
+			staleFiles_.push_back(*cachedFile);
+		files_.insert(path, includeFile);
+		Core::AtomicInc(&stats_.numMisses_);
+		return includeFile;
+	}
+
+	ShaderPreprocessor::ShaderPreprocessor(ShaderIncludeCache* includeCache)
+	    : includeCache_(includeCache)
+	    , allocator_(256 * 1024)
 	{
 	}
 
@@ -84,6 +128,10 @@ namespace Graphics
 		tag.data = (void*)cbDependency;
 		tags_.push_back(tag);
 
+		tag.tag = FPPTAG_FILEINPUT;
+		tag.data = (void*)cbFileInput;
+		tags_.push_back(tag);
+
 		tag.tag = FPPTAG_IGNOREVERSION;
 		tag.data = (void*)0;
 		tags_.push_back(tag);
@@ -161,9 +209,21 @@ namespace Graphics
 	void ShaderPreprocessor::cbDependency(char* dependency, void* userData)
 	{
 		auto* _this = static_cast<Graphics::ShaderPreprocessor*>(userData);
-		i32 len = (i32)strlen((char*)dependency) + 1;
-		char* str = _this->allocator_.Allocate<char>(len);
-		strcpy_s(str, len, (char*)dependency);
-		_this->dependencies_.push_back(str);
+		for(const auto& existing : _this->dependencies_)
+			if(existing == dependency)
+				return;
+		_this->dependencies_.push_back(dependency);
+	}
+
+	char* ShaderPreprocessor::cbFileInput(char* fileName, void* userData)
+	{
+		auto* _this = static_cast<Graphics::ShaderPreprocessor*>(userData);
+		if(_this->includeCache_ == nullptr)
+			return nullptr;
+
+		// fpp only reads from the returned data, it's safe to cast away const.
+		if(const auto* file = _this->includeCache_->GetFile(fileName))
+			return const_cast<char*>(file->data_.c_str());
+		return nullptr;
 	}
 } // namespace Graphics
@@ -1,8 +1,13 @@
 #pragma once
 
 #include "core/types.h"
+#include "core/concurrency.h"
+#include "core/file.h"
+#include "core/hash.h"
 #include "core/linear_allocator.h"
+#include "core/map.h"
 #include "core/string.h"
+#include "core/vector.h"
 
 extern "C" {
 struct fppTag;
@@ -10,31 +15,83 @@ struct fppTag;
 
 namespace Graphics
 {
+	struct ShaderIncludeFile
+	{
+		/// Contents with unix line endings.
+		Core::String data_;
+		/// Hash of contents.
+		Core::HashSHA1Digest hash_;
+		Core::FileTimestamp timestamp_;
+	};
+
+	struct ShaderIncludeCacheStats
+	{
+		volatile i32 numHits_ = 0;
+		volatile i32 numMisses_ = 0;
+	};
+
+	/**
+	 * In memory cache of include files, shared between preprocessors.
+	 * Files are read once and only reread when their timestamp changes.
+	 * All methods are thread safe.
+	 */
+	class ShaderIncludeCache
+	{
+	public:
+		ShaderIncludeCache() = default;
+		~ShaderIncludeCache();
+
+		/**
+		 * Get include file at @a path.
+		 * @return File, or nullptr if it can't be read. Valid while this cache remains in scope.
+		 */
+		const ShaderIncludeFile* GetFile(const char* path);
+
+		const ShaderIncludeCacheStats& GetStats() const { return stats_; }
+
+	private:
+		ShaderIncludeCache(const ShaderIncludeCache&) = delete;
+		ShaderIncludeCache& operator=(const ShaderIncludeCache&) = delete;
+
+		Core::Mutex mutex_;
+		Core::Map<Core::String, ShaderIncludeFile*> files_;
+		// Files replaced by newer versions, still referenced by earlier callers.
+		Core::Vector<ShaderIncludeFile*> staleFiles_;
+		ShaderIncludeCacheStats stats_;
+	};
+
 	class ShaderPreprocessor
 	{
 	public:
-		ShaderPreprocessor();
+		/**
+		 * @param includeCache Cache to read include files through. Optional.
+		 */
+		ShaderPreprocessor(ShaderIncludeCache* includeCache = nullptr);
 		~ShaderPreprocessor();
 
 		void AddInclude(const char* includePath);
 		void AddDefine(const char* define, const char* value);
 		bool Preprocess(const char* inputFile, const char* inputData);
 		const Core::String& GetOutput() const { return output_; }
-		const Core::Vector<const char*> GetDependencies() const { return dependencies_; }
+
+		/// @return Files read while preprocessing, without duplicates.
+		const Core::Vector<Core::String>& GetDependencies() const { return dependencies_; }
 
 	private:
 		static void ShaderPreprocessor::cbError(void* userData, char* format, va_list varArgs);
 		static char* ShaderPreprocessor::cbInput(char* buffer, int size, void* userData);
 		static void ShaderPreprocessor::cbOutput(int inChar, void* userData);
 		static void ShaderPreprocessor::cbDependency(char* dependency, void* userData);
+		static char* ShaderPreprocessor::cbFileInput(char* fileName, void* userData);
 
+		ShaderIncludeCache* includeCache_ = nullptr;
 		Core::Vector<fppTag> tags_;
 		char* inputData_;
 		i32 inputOffset_;
 		i32 inputSize_;
 		Core::LinearAllocator allocator_;
 		Core::String output_;
-		Core::Vector<const char*> dependencies_;
+		Core::Vector<Core::String> dependencies_;
 	};
 
 } // namespace Graphics
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "graphics/dll.h"
+#include "graphics/fwd_decls.h"
+#include "core/vector.h"
+#include "math/aabb.h"
+#include "math/mat44.h"
+
+namespace Graphics
+{
+	struct OcclusionBufferImpl;
+
+	/**
+	 * Frustum planes used for culling.
+	 * Each plane is stored as (normal, d), with normals pointing into the frustum:
+	 * a point p is inside a plane when dot(normal, p) + d >= 0.
+	 */
+	struct GRAPHICS_DLL CullingFrustum
+	{
+		static const i32 NUM_PLANES = 6;
+
+		CullingFrustum() = default;
+
+		/**
+		 * Extract planes from @a viewProj.
+		 */
+		CullingFrustum(const Math::Mat44& viewProj);
+
+		Math::Vec4 planes_[NUM_PLANES];
+	};
+
+	/**
+	 * Axis aligned bounding boxes, stored as structure of arrays.
+	 */
+	struct GRAPHICS_DLL CullingBoxes
+	{
+		void Add(const Math::AABB& aabb);
+		void Set(i32 idx, const Math::AABB& aabb);
+		void Resize(i32 num);
+		void Clear();
+		i32 Size() const { return minX_.size(); }
+
+		Core::Vector<f32> minX_;
+		Core::Vector<f32> minY_;
+		Core::Vector<f32> minZ_;
+		Core::Vector<f32> maxX_;
+		Core::Vector<f32> maxY_;
+		Core::Vector<f32> maxZ_;
+	};
+
+	/**
+	 * Bounding spheres, stored as structure of arrays.
+	 */
+	struct GRAPHICS_DLL CullingSpheres
+	{
+		void Add(const Math::Vec3& center, f32 radius);
+		void Set(i32 idx, const Math::Vec3& center, f32 radius);
+		void Resize(i32 num);
+		void Clear();
+		i32 Size() const { return x_.size(); }
+
+		Core::Vector<f32> x_;
+		Core::Vector<f32> y_;
+		Core::Vector<f32> z_;
+		Core::Vector<f32> radius_;
+	};
+
+	/**
+	 * Software rasterised hierarchical depth buffer for occlusion culling.
+	 * Usage per frame:
+	 * - Begin with the camera's view projection.
+	 * - Add occluders. They must be solid, as the volume they cover is assumed to hide anything behind it.
+	 * - End to build the depth hierarchy.
+	 * - Pass to CullBoxes or CullSpheres, or test bounds directly with IsVisible.
+	 * Occluders are rasterised at pixel centres with their farthest depth, so a low resolution
+	 * (e.g. 256x128) is typically enough.
+	 */
+	class GRAPHICS_DLL OcclusionBuffer final
+	{
+	public:
+		OcclusionBuffer(i32 width, i32 height);
+		~OcclusionBuffer();
+
+		/**
+		 * Clear buffer and set view projection for following occluders.
+		 */
+		void Begin(const Math::Mat44& viewProj);
+
+		/**
+		 * Rasterise indexed triangle list in world space.
+		 * Triangles crossing the near plane are skipped.
+		 */
+		void AddOccluder(const Math::Vec3* vertices, const u32* indices, i32 numIndices);
+
+		/**
+		 * Rasterise box in world space.
+		 */
+		void AddOccluder(const Math::AABB& aabb);
+
+		/**
+		 * Build depth hierarchy. Must be called before testing.
+		 */
+		void End();
+
+		/**
+		 * @return false if @a aabb is entirely behind occluders.
+		 * @pre End has been called.
+		 */
+		bool IsVisible(const Math::AABB& aabb) const;
+
+		i32 GetWidth() const;
+		i32 GetHeight() const;
+
+		/**
+		 * @return Depth of pixel in the finest level, 0 at near plane, 1 at far plane.
+		 */
+		f32 GetDepth(i32 x, i32 y) const;
+
+	private:
+		OcclusionBuffer(const OcclusionBuffer&) = delete;
+		OcclusionBuffer& operator=(const OcclusionBuffer&) = delete;
+
+		OcclusionBufferImpl* impl_ = nullptr;
+	};
+
+	/**
+	 * Culling parameters.
+	 */
+	struct GRAPHICS_DLL CullingParams
+	{
+		/// Optional occlusion buffer to test frustum visible bounds against.
+		const OcclusionBuffer* occlusion_ = nullptr;
+		/// Number of bounds tested per job. Rounded up to a multiple of 8.
+		i32 batchSize_ = 4096;
+	};
+
+	/**
+	 * Cull @a boxes against @a frustum, and optionally an occlusion buffer.
+	 * Bounds are tested 8 at a time with SIMD, split across job workers.
+	 * @param outVisible Indices of visible boxes, in ascending order.
+	 * @return Number of visible boxes.
+	 */
+	GRAPHICS_DLL i32 CullBoxes(const CullingFrustum& frustum, const CullingBoxes& boxes,
+	    Core::Vector<i32>& outVisible, const CullingParams& params = CullingParams());
+
+	/**
+	 * Cull @a spheres against @a frustum, and optionally an occlusion buffer.
+	 * Bounds are tested 8 at a time with SIMD, split across job workers.
+	 * @param outVisible Indices of visible spheres, in ascending order.
+	 * @return Number of visible spheres.
+	 */
+	GRAPHICS_DLL i32 CullSpheres(const CullingFrustum& frustum, const CullingSpheres& spheres,
+	    Core::Vector<i32>& outVisible, const CullingParams& params = CullingParams());
+
+	/**
+	 * @return true if all of @a meshlet's triangles face away from @a eye, which is in mesh space.
+	 * Conservative: meshlets are only culled when their whole bounding sphere is behind the normal cone.
+	 */
+	GRAPHICS_DLL bool IsMeshletBackfacing(const ModelMeshlet& meshlet, const Math::Vec3& eye);
+
+	/**
+	 * Cull @a meshlets against @a frustum, and by their normal cones against @a eye.
+	 * Meshlet bounds are in mesh space, so build @a frustum from world * viewProj, and pass @a eye in mesh space.
+	 * @param outVisible Indices of visible meshlets, in ascending order.
+	 * @return Number of visible meshlets.
+	 */
+	GRAPHICS_DLL i32 CullMeshlets(const CullingFrustum& frustum, const Math::Vec3& eye, const ModelMeshlet* meshlets,
+	    i32 numMeshlets, Core::Vector<i32>& outVisible);
+
+} // namespace Graphics
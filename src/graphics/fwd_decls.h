@@ -4,11 +4,17 @@ namespace Graphics
 {
 	class Material;
 
+	struct ModelMeshlet;
+
 	class Shader;
 	struct ShaderTechniqueDesc;
 	class ShaderTechnique;
 	class ShaderBindingSet;
 
+	struct SkinningBones;
+
 	class Texture;
 
+	class TransformHierarchy;
+
 } // namespace Graphics
\ No newline at end of file
@@ -20,9 +20,16 @@ namespace Graphics
 		/// @return Get shader associated with this material.
 		Shader* GetShader() const;
 
-		/// Get binding set.
+		/// Get binding set. Texture bindings are updated by TextureStreaming::Update.
 		const ShaderBindingSet& GetBindingSet() const;
 
+		/**
+		 * Request levels of streamed textures needed to draw at @a screenSize pixels across.
+		 * Should be called every frame the material is used.
+		 * @see Texture::RequestLevel.
+		 */
+		void RequestTextureLevels(f32 screenSize) const;
+
 		/// Create shader technique.
 		ShaderTechnique CreateTechnique(const char* name, const ShaderTechniqueDesc& desc);
 
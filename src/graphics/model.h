@@ -7,6 +7,7 @@
 #include "gpu/types.h"
 #include "resource/ref.h"
 #include "resource/resource.h"
+#include "math/aabb.h"
 #include "math/mat44.h"
 
 
@@ -20,12 +21,30 @@ namespace Graphics
 		i32 noofIndices_ = 0;
 	};
 
+	/**
+	 * Cluster of a mesh's triangles, with bounds for culling.
+	 * Bounds are in mesh space. See CullMeshlets.
+	 */
+	struct ModelMeshlet
+	{
+		/// Bounding sphere.
+		Math::Vec3 center_;
+		f32 radius_ = 0.0f;
+		/// Cone containing all triangle normals, given as axis & sine of its half angle.
+		/// A cutoff of 1 or more means the meshlet can't be backface culled.
+		Math::Vec3 coneAxis_;
+		f32 coneCutoff_ = 1.0f;
+		/// Range of triangles, relative to ModelMeshDraw::indexOffset_.
+		i32 indexOffset_ = 0;
+		i32 noofIndices_ = 0;
+	};
+
 	using ModelRef = Resource::Ref<class Model>;
 
 	class GRAPHICS_DLL Model
 	{
 	public:
-		DECLARE_RESOURCE(Model, "Graphics.Model", 1);
+		DECLARE_RESOURCE(Model, "Graphics.Model", 2);
 
 		/// @return Number of meshes.
 		i32 GetNumMeshes() const;
@@ -39,12 +58,42 @@ namespace Graphics
 		/// @return Draw info for @a meshIdx.
 		ModelMeshDraw GetMeshDraw(i32 meshIdx) const;
 
+		/// @return Meshlets for @a meshIdx. Empty if they weren't generated by the converter.
+		Core::ArrayView<ModelMeshlet> GetMeshMeshlets(i32 meshIdx) const;
+
 		/// @return Material for @a meshIdx.
 		Material* Model::GetMeshMaterial(i32 meshIdx) const;
 
+		/**
+		 * Get bounds of @a meshIdx, in mesh space.
+		 * Quantized positions are stored relative to these, so should be decoded as
+		 * aabb.Minimum() + position * aabb.Dimensions().
+		 */
+		Math::AABB GetMeshAABB(i32 meshIdx) const;
+
 		/// @return Mesh world transform.
 		Math::Mat44 GetMeshWorldTransform(i32 meshIdx) const;
 
+		/// @return Number of nodes.
+		i32 GetNumNodes() const;
+
+		/// @return Node index for @a meshIdx.
+		i32 GetMeshNodeIdx(i32 meshIdx) const;
+
+		/**
+		 * Add model's nodes to @a hierarchy, so they can be animated at runtime.
+		 * @param parentIdx Node in @a hierarchy to parent model's root nodes to, or -1.
+		 * @return Index of model's first node in @a hierarchy. Model node n is at this index + n.
+		 */
+		i32 AddToHierarchy(TransformHierarchy& hierarchy, i32 parentIdx = -1) const;
+
+		/**
+		 * Add bone palette of @a meshIdx to @a bones.
+		 * @param nodeBaseIdx Index of model's first node, as returned by AddToHierarchy.
+		 * @return Index of mesh's first bone in @a bones, or -1 if mesh isn't skinned.
+		 */
+		i32 AddSkinningBones(i32 meshIdx, SkinningBones& bones, i32 nodeBaseIdx = 0) const;
+
 		/// @return Is model ready for use?
 		bool IsReady() const { return !!impl_; }
 
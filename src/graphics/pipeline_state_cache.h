@@ -0,0 +1,69 @@
+#pragma once
+
+#include "graphics/dll.h"
+#include "core/types.h"
+
+namespace Graphics
+{
+	/**
+	 * Pipeline state cache statistics.
+	 */
+	struct GRAPHICS_DLL PipelineStateCacheStats
+	{
+		/// Number of pipeline states currently alive in the cache.
+		i32 numEntries_ = 0;
+		/// Number of recorded techniques that will be persisted by PipelineStateCache::Save.
+		i32 numRecords_ = 0;
+		/// Number of technique setups that found an existing pipeline state.
+		i32 numHits_ = 0;
+		/// Number of technique setups that had to create a pipeline state on the calling thread.
+		i32 numMisses_ = 0;
+		/// Number of pipeline states created ahead of use on job workers.
+		i32 numPrewarmed_ = 0;
+		/// Time spent creating pipeline states on misses, in seconds.
+		f64 missTime_ = 0.0;
+		/// Time spent creating pipeline states while prewarming, in seconds.
+		f64 prewarmTime_ = 0.0;
+	};
+
+	/**
+	 * Global pipeline state cache.
+	 * Pipeline states are shared between all shaders, keyed by a hash of shader bytecode, render state,
+	 * vertex layout, topology and render target formats.
+	 * Each technique set up is recorded, and the record list can be saved to disk. When loaded back in
+	 * a later run, shaders will create the recorded pipeline states on job workers as soon as they
+	 * are loaded, rather than on first use.
+	 * @pre Shader factory must be registered.
+	 */
+	class GRAPHICS_DLL PipelineStateCache final
+	{
+	public:
+		/**
+		 * Load recorded techniques from @a path.
+		 * Should be called before any shaders are loaded for them to be prewarmed.
+		 * @return true if loaded.
+		 */
+		static bool Load(const char* path);
+
+		/**
+		 * Save recorded techniques to @a path.
+		 * @return true if saved.
+		 */
+		static bool Save(const char* path);
+
+		/**
+		 * @return Current statistics.
+		 */
+		static PipelineStateCacheStats GetStats();
+
+		/**
+		 * Reset hit, miss, and timing statistics.
+		 */
+		static void ResetStats();
+
+	private:
+		PipelineStateCache() = delete;
+		~PipelineStateCache() = delete;
+	};
+
+} // namespace Graphics
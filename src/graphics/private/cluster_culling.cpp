@@ -0,0 +1,472 @@
+#include "graphics/cluster_culling.h"
+#include "graphics/culling.h"
+#include "graphics/render_graph.h"
+#include "graphics/render_pass.h"
+#include "graphics/shader.h"
+#include "core/debug.h"
+#include "core/misc.h"
+#include "gpu/command_list.h"
+#include "gpu/manager.h"
+#include "math/aabb.h"
+
+namespace Graphics
+{
+	namespace
+	{
+		static const i32 CULL_GROUP_SIZE = 64;
+
+		/// Instance as laid out for the GPU, see cluster_culling.esf.
+		struct ClusterCullingGPUInstance
+		{
+			Math::Mat44 world_;
+			/// Eye in mesh space, for backface culling.
+			Math::Vec3 eye_;
+			/// Largest axis scale of world_, for bounding spheres.
+			f32 scale_ = 1.0f;
+			i32 baseCluster_ = 0;
+			i32 noofClusters_ = 0;
+			i32 meshIdx_ = 0;
+			i32 baseDrawArg_ = 0;
+			i32 vertexOffset_ = 0;
+			i32 padding_[3] = {};
+		};
+		static_assert(sizeof(ClusterCullingGPUInstance) == 112, "Must match Instance in cluster_culling.esf.");
+		static_assert(sizeof(ClusterCullingCluster) == 48, "Must match Cluster in cluster_culling.esf.");
+
+		/// Culling constants, see cluster_culling.esf.
+		struct ClusterCullingParams
+		{
+			Math::Mat44 viewProj_;
+			Math::Vec4 frustumPlanes_[CullingFrustum::NUM_PLANES];
+			i32 numInstances_ = 0;
+			i32 backfaceCull_ = 0;
+			i32 padding_[2] = {};
+		};
+
+		ClusterCullingGPUInstance GetGPUInstance(
+		    const ClusterCullingInstance& instance, const ClusterCullingMesh& mesh, const Math::Vec3& eye)
+		{
+			ClusterCullingGPUInstance gpuInstance;
+			gpuInstance.world_ = instance.world_;
+
+			Math::Mat44 invWorld = instance.world_;
+			invWorld.Inverse();
+			gpuInstance.eye_ = eye * invWorld;
+
+			auto RowScale = [](const Math::Vec4& row) { return Math::Vec3(row.x, row.y, row.z).Magnitude(); };
+			gpuInstance.scale_ = Core::Max(RowScale(instance.world_.Row0()),
+			    Core::Max(RowScale(instance.world_.Row1()), RowScale(instance.world_.Row2())));
+
+			gpuInstance.baseCluster_ = mesh.baseCluster_;
+			gpuInstance.noofClusters_ = mesh.noofClusters_;
+			gpuInstance.meshIdx_ = instance.meshIdx_;
+			gpuInstance.baseDrawArg_ = mesh.baseDrawArg_;
+			gpuInstance.vertexOffset_ = mesh.draw_.vertexOffset_;
+			return gpuInstance;
+		}
+
+		/// Copy @a num elements filled by @a fillFn into @a buffer, through upload memory if there is room.
+		template<typename TYPE, typename FILL_FN>
+		void UpdateBufferData(GPU::CommandList& cmdList, GPU::Handle buffer, i32 num, FILL_FN&& fillFn)
+		{
+			if(num == 0)
+				return;
+
+			const i32 size = sizeof(TYPE) * num;
+			const auto upload = GPU::Manager::AllocUpload(size);
+			TYPE* data = upload ? static_cast<TYPE*>(upload.address_) : cmdList.Alloc<TYPE>(num);
+			fillFn(data);
+			if(upload)
+				cmdList.UpdateBuffer(buffer, 0, upload);
+			else
+				cmdList.UpdateBuffer(buffer, 0, size, data);
+		}
+	}
+
+	struct ClusterSceneImpl
+	{
+		Core::Vector<ClusterCullingMesh> meshes_;
+		Core::Vector<ClusterCullingInstance> instances_;
+		Core::Vector<ClusterCullingCluster> clusters_;
+
+		/// Instances per mesh, to size draw argument ranges.
+		Core::Vector<i32> meshInstances_;
+		i32 maxDrawArgs_ = 0;
+		i32 maxInstanceClusters_ = 0;
+		bool layoutDirty_ = false;
+
+		GPU::Handle clusterBuffer_;
+		i32 noofBufferClusters_ = 0;
+
+		void UpdateLayout()
+		{
+			if(!layoutDirty_)
+				return;
+
+			maxDrawArgs_ = 0;
+			maxInstanceClusters_ = 0;
+			for(i32 idx = 0; idx < meshes_.size(); ++idx)
+			{
+				auto& mesh = meshes_[idx];
+				mesh.baseDrawArg_ = maxDrawArgs_;
+				mesh.maxDrawArgs_ = mesh.noofClusters_ * meshInstances_[idx];
+				maxDrawArgs_ += mesh.maxDrawArgs_;
+				if(meshInstances_[idx] > 0)
+					maxInstanceClusters_ = Core::Max(maxInstanceClusters_, mesh.noofClusters_);
+			}
+			layoutDirty_ = false;
+		}
+	};
+
+	ClusterScene::ClusterScene() { impl_ = new ClusterSceneImpl(); }
+
+	ClusterScene::~ClusterScene()
+	{
+		if(impl_->clusterBuffer_)
+			GPU::Manager::DestroyResource(impl_->clusterBuffer_);
+		delete impl_;
+	}
+
+	i32 ClusterScene::AddMesh(GPU::Handle db, const ModelMeshDraw& draw, Core::ArrayView<const ModelMeshlet> meshlets)
+	{
+		ClusterCullingMesh mesh;
+		mesh.db_ = db;
+		mesh.draw_ = draw;
+		mesh.baseCluster_ = impl_->clusters_.size();
+		mesh.noofClusters_ = meshlets.size();
+
+		impl_->clusters_.reserve(impl_->clusters_.size() + meshlets.size());
+		for(const auto& meshlet : meshlets)
+		{
+			DBG_ASSERT((meshlet.indexOffset_ + meshlet.noofIndices_) <= draw.noofIndices_);
+			ClusterCullingCluster cluster;
+			cluster.center_ = meshlet.center_;
+			cluster.radius_ = meshlet.radius_;
+			cluster.coneAxis_ = meshlet.coneAxis_;
+			cluster.coneCutoff_ = meshlet.coneCutoff_;
+			cluster.indexOffset_ = draw.indexOffset_ + meshlet.indexOffset_;
+			cluster.noofIndices_ = meshlet.noofIndices_;
+			impl_->clusters_.push_back(cluster);
+		}
+
+		impl_->meshes_.push_back(mesh);
+		impl_->meshInstances_.push_back(0);
+		impl_->layoutDirty_ = true;
+		return impl_->meshes_.size() - 1;
+	}
+
+	i32 ClusterScene::AddModelMesh(const Model& model, i32 meshIdx)
+	{
+		const auto meshlets = model.GetMeshMeshlets(meshIdx);
+		if(meshlets.size() == 0)
+			return -1;
+		return AddMesh(model.GetMeshDrawBinding(meshIdx), model.GetMeshDraw(meshIdx), meshlets);
+	}
+
+	i32 ClusterScene::AddInstance(i32 meshIdx, const Math::Mat44& world)
+	{
+		DBG_ASSERT(meshIdx >= 0 && meshIdx < impl_->meshes_.size());
+		ClusterCullingInstance instance;
+		instance.world_ = world;
+		instance.meshIdx_ = meshIdx;
+		impl_->instances_.push_back(instance);
+		impl_->meshInstances_[meshIdx]++;
+		impl_->layoutDirty_ = true;
+		return impl_->instances_.size() - 1;
+	}
+
+	void ClusterScene::SetInstanceTransform(i32 instanceIdx, const Math::Mat44& world)
+	{
+		impl_->instances_[instanceIdx].world_ = world;
+	}
+
+	void ClusterScene::ClearInstances()
+	{
+		impl_->instances_.clear();
+		for(auto& meshInstances : impl_->meshInstances_)
+			meshInstances = 0;
+		impl_->layoutDirty_ = true;
+	}
+
+	Core::ArrayView<const ClusterCullingMesh> ClusterScene::GetMeshes() const
+	{
+		impl_->UpdateLayout();
+		return Core::ArrayView<const ClusterCullingMesh>(impl_->meshes_.data(), impl_->meshes_.size());
+	}
+
+	Core::ArrayView<const ClusterCullingInstance> ClusterScene::GetInstances() const
+	{
+		return Core::ArrayView<const ClusterCullingInstance>(impl_->instances_.data(), impl_->instances_.size());
+	}
+
+	Core::ArrayView<const ClusterCullingCluster> ClusterScene::GetClusters() const
+	{
+		return Core::ArrayView<const ClusterCullingCluster>(impl_->clusters_.data(), impl_->clusters_.size());
+	}
+
+	i32 ClusterScene::GetMaxDrawArgs() const
+	{
+		impl_->UpdateLayout();
+		return impl_->maxDrawArgs_;
+	}
+
+	i32 ClusterScene::GetMaxInstanceClusters() const
+	{
+		impl_->UpdateLayout();
+		return impl_->maxInstanceClusters_;
+	}
+
+	i32 ClusterScene::Cull(const Math::Mat44& viewProj, const Math::Vec3& eye, bool backfaceCull,
+	    const OcclusionBuffer* occlusion, Core::Vector<GPU::DrawIndexedIdArgs>& outDrawArgs,
+	    Core::Vector<u32>& outDrawCounts) const
+	{
+		impl_->UpdateLayout();
+		outDrawArgs.clear();
+		outDrawArgs.resize(impl_->maxDrawArgs_);
+		outDrawCounts.clear();
+		outDrawCounts.resize(impl_->meshes_.size(), 0);
+
+		// Same tests as cs_cull_clusters.
+		const CullingFrustum frustum(viewProj);
+		i32 numVisible = 0;
+		for(i32 instanceIdx = 0; instanceIdx < impl_->instances_.size(); ++instanceIdx)
+		{
+			const auto& instance = impl_->instances_[instanceIdx];
+			const auto& mesh = impl_->meshes_[instance.meshIdx_];
+			const auto gpuInstance = GetGPUInstance(instance, mesh, eye);
+			for(i32 clusterIdx = 0; clusterIdx < mesh.noofClusters_; ++clusterIdx)
+			{
+				const auto& cluster = impl_->clusters_[mesh.baseCluster_ + clusterIdx];
+				if(backfaceCull && cluster.coneCutoff_ < 1.0f)
+				{
+					const Math::Vec3 view = cluster.center_ - gpuInstance.eye_;
+					if(view.Dot(cluster.coneAxis_) >
+					    cluster.coneCutoff_ * (view.Magnitude() + cluster.radius_) + cluster.radius_)
+						continue;
+				}
+
+				const Math::Vec3 center = cluster.center_ * instance.world_;
+				const f32 radius = cluster.radius_ * gpuInstance.scale_;
+				bool visible = true;
+				for(i32 planeIdx = 0; visible && planeIdx < CullingFrustum::NUM_PLANES; ++planeIdx)
+				{
+					const Math::Vec4& plane = frustum.planes_[planeIdx];
+					visible = (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w) >= -radius;
+				}
+
+				const Math::Vec3 extents(radius, radius, radius);
+				if(!visible || (occlusion && !occlusion->IsVisible(Math::AABB(center - extents, center + extents))))
+					continue;
+
+				GPU::DrawIndexedIdArgs drawArgs;
+				drawArgs.drawId_ = instanceIdx;
+				drawArgs.args_.indexCountPerInstance_ = cluster.noofIndices_;
+				drawArgs.args_.instanceCount_ = 1;
+				drawArgs.args_.startVertexLocation_ = cluster.indexOffset_;
+				drawArgs.args_.baseVertexLocation_ = mesh.draw_.vertexOffset_;
+				outDrawArgs[mesh.baseDrawArg_ + outDrawCounts[instance.meshIdx_]++] = drawArgs;
+				++numVisible;
+			}
+		}
+		return numVisible;
+	}
+
+	GPU::Handle ClusterScene::GetClusterBuffer()
+	{
+		if(impl_->noofBufferClusters_ != impl_->clusters_.size())
+		{
+			// Old buffer is kept alive by the GPU manager until frames using it are complete.
+			if(impl_->clusterBuffer_)
+				GPU::Manager::DestroyResource(impl_->clusterBuffer_);
+			impl_->clusterBuffer_ = GPU::Handle();
+			impl_->noofBufferClusters_ = impl_->clusters_.size();
+
+			if(impl_->clusters_.size() > 0)
+			{
+				GPU::BufferDesc desc;
+				desc.bindFlags_ = GPU::BindFlags::SHADER_RESOURCE;
+				desc.size_ = sizeof(ClusterCullingCluster) * impl_->clusters_.size();
+				impl_->clusterBuffer_ =
+				    GPU::Manager::CreateBuffer(desc, impl_->clusters_.data(), "ClusterScene/clusters");
+			}
+		}
+		return impl_->clusterBuffer_;
+	}
+
+	void ClusterScene::DrawMesh(GPU::CommandList& cmdList, i32 meshIdx, GPU::Handle ps,
+	    Core::ArrayView<GPU::PipelineBinding> pb, GPU::Handle fbs, const GPU::DrawState& drawState,
+	    GPU::Handle drawArgs, GPU::Handle drawCounts) const
+	{
+		const auto& mesh = GetMeshes()[meshIdx];
+		if(mesh.maxDrawArgs_ == 0)
+			return;
+
+		cmdList.DrawIndirect(ps, pb, mesh.db_, fbs, drawState, GPU::PrimitiveTopology::TRIANGLE_LIST, drawArgs,
+		    mesh.baseDrawArg_ * sizeof(GPU::DrawIndexedIdArgs), drawCounts, meshIdx * sizeof(u32), mesh.maxDrawArgs_,
+		    true);
+	}
+
+	ClusterCullingData AddClusterCullingPass(
+	    RenderGraph& renderGraph, ClusterScene& scene, Shader* shader, const ClusterCullingSettings& settings)
+	{
+		struct ClusterCullingPassData
+		{
+			const ClusterScene* scene_ = nullptr;
+			ClusterCullingParams params_;
+			Math::Vec3 eye_;
+			i32 numMeshes_ = 0;
+			i32 numClusters_ = 0;
+			i32 maxDrawArgs_ = 0;
+			i32 maxInstanceClusters_ = 0;
+			i32 hizLevels_ = 0;
+
+			RenderGraphResource inClusters_;
+			RenderGraphResource inHiZ_;
+			RenderGraphResource outParamsCB_;
+			RenderGraphResource outInstancesSB_;
+			RenderGraphResource outTransforms_;
+			RenderGraphResource outDrawArgs_;
+			RenderGraphResource outDrawCounts_;
+
+			ShaderTechnique tech_;
+
+			mutable ShaderBindingSet cullingBindings_;
+			mutable ShaderBindingSet hizBindings_;
+		};
+
+		// Clusters persist across frames, so are imported rather than created by the pass.
+		RenderGraphResource clusters;
+		if(GPU::Handle clusterBuffer = scene.GetClusterBuffer())
+			clusters = renderGraph.ImportResource("Cluster Culling Clusters", clusterBuffer,
+			    RenderGraphBufferDesc(scene.GetClusters().size() * sizeof(ClusterCullingCluster)));
+
+		auto& pass = renderGraph.AddCallbackRenderPass<ClusterCullingPassData>(settings.name_,
+		    [&](RenderGraphBuilder& builder, ClusterCullingPassData& data) {
+			    const CullingFrustum frustum(settings.viewProj_);
+			    data.scene_ = &scene;
+			    data.params_.viewProj_ = settings.viewProj_;
+			    for(i32 idx = 0; idx < CullingFrustum::NUM_PLANES; ++idx)
+				    data.params_.frustumPlanes_[idx] = frustum.planes_[idx];
+			    data.params_.numInstances_ = scene.GetInstances().size();
+			    data.params_.backfaceCull_ = settings.backfaceCull_ ? 1 : 0;
+			    data.eye_ = settings.eye_;
+			    data.numMeshes_ = scene.GetMeshes().size();
+			    data.numClusters_ = scene.GetClusters().size();
+			    data.maxDrawArgs_ = scene.GetMaxDrawArgs();
+			    data.maxInstanceClusters_ = scene.GetMaxInstanceClusters();
+
+			    const i32 numInstances = data.params_.numInstances_;
+			    if(clusters)
+				    data.inClusters_ = builder.Read(clusters, GPU::BindFlags::SHADER_RESOURCE);
+
+			    if(settings.hiz_)
+			    {
+				    RenderGraphTextureDesc hizDesc;
+				    builder.GetTexture(settings.hiz_, &hizDesc);
+				    data.hizLevels_ = hizDesc.levels_;
+				    data.inHiZ_ = builder.Read(settings.hiz_, GPU::BindFlags::SHADER_RESOURCE);
+			    }
+
+			    // Keep buffers non-empty, so descs are valid for empty scenes.
+			    auto CreateBuffer = [&builder](const char* name, i32 num, i32 stride) {
+				    return builder.Create(name, RenderGraphBufferDesc(Core::Max(1, num) * stride));
+			    };
+
+			    auto paramsCB = CreateBuffer("Cluster Culling Params", 1, sizeof(ClusterCullingParams));
+			    auto instancesSB =
+			        CreateBuffer("Cluster Culling Instances", numInstances, sizeof(ClusterCullingGPUInstance));
+			    auto transforms = CreateBuffer("Cluster Culling Transforms", numInstances, sizeof(Math::Mat44));
+			    auto drawArgs =
+			        CreateBuffer("Cluster Culling Draw Args", data.maxDrawArgs_, sizeof(GPU::DrawIndexedIdArgs));
+			    auto drawCounts = CreateBuffer("Cluster Culling Draw Counts", data.numMeshes_, sizeof(u32));
+
+			    data.outParamsCB_ = builder.Write(paramsCB, GPU::BindFlags::CONSTANT_BUFFER);
+			    data.outInstancesSB_ = builder.Write(instancesSB, GPU::BindFlags::SHADER_RESOURCE);
+			    data.outTransforms_ = builder.Write(transforms, GPU::BindFlags::SHADER_RESOURCE);
+			    data.outDrawArgs_ = builder.Write(drawArgs, GPU::BindFlags::UNORDERED_ACCESS);
+			    data.outDrawCounts_ = builder.Write(drawCounts, GPU::BindFlags::UNORDERED_ACCESS);
+
+			    data.tech_ = shader->CreateTechnique(
+			        data.inHiZ_ ? "TECH_CULL_CLUSTERS_HIZ" : "TECH_CULL_CLUSTERS", ShaderTechniqueDesc());
+			    data.cullingBindings_ = shader->CreateBindingSet("ClusterCullingBindings");
+			    data.hizBindings_ = shader->CreateBindingSet("ClusterHiZBindings");
+			},
+		    [](RenderGraphResources& res, GPU::CommandList& cmdList, const ClusterCullingPassData& data) {
+			    const auto meshes = data.scene_->GetMeshes();
+			    const auto instances = data.scene_->GetInstances();
+			    DBG_ASSERT(instances.size() == data.params_.numInstances_);
+			    DBG_ASSERT(meshes.size() == data.numMeshes_);
+
+			    cmdList.UpdateBuffer(
+			        res.GetBuffer(data.outParamsCB_), 0, sizeof(data.params_), cmdList.Push(&data.params_));
+
+			    UpdateBufferData<ClusterCullingGPUInstance>(cmdList, res.GetBuffer(data.outInstancesSB_),
+			        instances.size(), [&](ClusterCullingGPUInstance* gpuInstances) {
+				        for(i32 idx = 0; idx < instances.size(); ++idx)
+				        {
+					        const auto& instance = instances[idx];
+					        gpuInstances[idx] = GetGPUInstance(instance, meshes[instance.meshIdx_], data.eye_);
+				        }
+			        });
+
+			    UpdateBufferData<Math::Mat44>(
+			        cmdList, res.GetBuffer(data.outTransforms_), instances.size(), [&](Math::Mat44* transforms) {
+				        for(i32 idx = 0; idx < instances.size(); ++idx)
+					        transforms[idx] = instances[idx].world_;
+			        });
+
+			    // Counts are accumulated into by the compute shader.
+			    UpdateBufferData<u32>(cmdList, res.GetBuffer(data.outDrawCounts_), meshes.size(), [&](u32* counts) {
+				    for(i32 idx = 0; idx < meshes.size(); ++idx)
+					    counts[idx] = 0;
+			    });
+
+			    if(instances.size() == 0 || data.maxInstanceClusters_ == 0)
+				    return;
+
+			    ShaderContext shaderCtx(cmdList);
+
+			    data.cullingBindings_.Set(
+			        "cullParams", res.CBuffer(data.outParamsCB_, 0, sizeof(ClusterCullingParams)));
+			    data.cullingBindings_.Set("inClusters", res.Buffer(data.inClusters_, GPU::Format::INVALID, 0,
+			                                                data.numClusters_, sizeof(ClusterCullingCluster)));
+			    data.cullingBindings_.Set("inInstances", res.Buffer(data.outInstancesSB_, GPU::Format::INVALID, 0,
+			                                                 instances.size(), sizeof(ClusterCullingGPUInstance)));
+			    data.cullingBindings_.Set("outDrawArgs", res.RWBuffer(data.outDrawArgs_, GPU::Format::INVALID, 0,
+			                                                 data.maxDrawArgs_, sizeof(GPU::DrawIndexedIdArgs)));
+			    data.cullingBindings_.Set("outDrawCounts",
+			        res.RWBuffer(data.outDrawCounts_, GPU::Format::INVALID, 0, meshes.size(), sizeof(u32)));
+
+			    // One group row per instance, enough groups across for the instance with most clusters.
+			    const i32 xGroups = (data.maxInstanceClusters_ + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+			    auto Dispatch = [&]() {
+				    GPU::Handle ps;
+				    Core::ArrayView<GPU::PipelineBinding> pb;
+				    if(shaderCtx.CommitBindings(data.tech_, ps, pb))
+					    cmdList.Dispatch(ps, pb, xGroups, instances.size(), 1);
+			    };
+
+			    if(auto cullingBind = shaderCtx.BeginBindingScope(data.cullingBindings_))
+			    {
+				    if(data.inHiZ_)
+				    {
+					    data.hizBindings_.Set("inHiZ",
+					        res.Texture2D(data.inHiZ_, GPU::Format::R32G32_FLOAT, 0, data.hizLevels_));
+					    if(auto hizBind = shaderCtx.BeginBindingScope(data.hizBindings_))
+						    Dispatch();
+				    }
+				    else
+				    {
+					    Dispatch();
+				    }
+			    }
+			});
+
+		ClusterCullingData output;
+		output.outTransforms_ = pass.GetData().outTransforms_;
+		output.outDrawArgs_ = pass.GetData().outDrawArgs_;
+		output.outDrawCounts_ = pass.GetData().outDrawCounts_;
+		return output;
+	}
+
+} // namespace Graphics
@@ -0,0 +1,541 @@
+#include "graphics/culling.h"
+#include "graphics/model.h"
+#include "core/misc.h"
+#include "job/parallel_for.h"
+#include "math/simd.h"
+
+#include <cfloat>
+#include <cmath>
+
+namespace Graphics
+{
+	CullingFrustum::CullingFrustum(const Math::Mat44& viewProj)
+	{
+		// Clip space is v * viewProj, so planes come from the columns.
+		auto Column = [&viewProj](i32 idx) {
+			return Math::Vec4(viewProj[0][idx], viewProj[1][idx], viewProj[2][idx], viewProj[3][idx]);
+		};
+		const Math::Vec4 x = Column(0);
+		const Math::Vec4 y = Column(1);
+		const Math::Vec4 z = Column(2);
+		const Math::Vec4 w = Column(3);
+
+		planes_[0] = w + x;
+		planes_[1] = w - x;
+		planes_[2] = w + y;
+		planes_[3] = w - y;
+		planes_[4] = w + z;
+		planes_[5] = w - z;
+
+		// Normalise so sphere radii can be compared against distances.
+		for(auto& plane : planes_)
+		{
+			const f32 length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			if(length > 0.0f)
+				plane = plane * (1.0f / length);
+		}
+	}
+
+	void CullingBoxes::Add(const Math::AABB& aabb)
+	{
+		minX_.push_back(aabb.Minimum().x);
+		minY_.push_back(aabb.Minimum().y);
+		minZ_.push_back(aabb.Minimum().z);
+		maxX_.push_back(aabb.Maximum().x);
+		maxY_.push_back(aabb.Maximum().y);
+		maxZ_.push_back(aabb.Maximum().z);
+	}
+
+	void CullingBoxes::Set(i32 idx, const Math::AABB& aabb)
+	{
+		minX_[idx] = aabb.Minimum().x;
+		minY_[idx] = aabb.Minimum().y;
+		minZ_[idx] = aabb.Minimum().z;
+		maxX_[idx] = aabb.Maximum().x;
+		maxY_[idx] = aabb.Maximum().y;
+		maxZ_[idx] = aabb.Maximum().z;
+	}
+
+	void CullingBoxes::Resize(i32 num)
+	{
+		minX_.resize(num);
+		minY_.resize(num);
+		minZ_.resize(num);
+		maxX_.resize(num);
+		maxY_.resize(num);
+		maxZ_.resize(num);
+	}
+
+	void CullingBoxes::Clear() { Resize(0); }
+
+	void CullingSpheres::Add(const Math::Vec3& center, f32 radius)
+	{
+		x_.push_back(center.x);
+		y_.push_back(center.y);
+		z_.push_back(center.z);
+		radius_.push_back(radius);
+	}
+
+	void CullingSpheres::Set(i32 idx, const Math::Vec3& center, f32 radius)
+	{
+		x_[idx] = center.x;
+		y_[idx] = center.y;
+		z_[idx] = center.z;
+		radius_[idx] = radius;
+	}
+
+	void CullingSpheres::Resize(i32 num)
+	{
+		x_.resize(num);
+		y_.resize(num);
+		z_.resize(num);
+		radius_.resize(num);
+	}
+
+	void CullingSpheres::Clear() { Resize(0); }
+
+	struct OcclusionBufferImpl
+	{
+		struct Level
+		{
+			i32 width_ = 0;
+			i32 height_ = 0;
+			i32 offset_ = 0;
+		};
+
+		/// Depth for all levels, finest first.
+		Core::Vector<f32> depth_;
+		Core::Vector<Level> levels_;
+		Math::Mat44 viewProj_;
+
+		f32* GetLevel(i32 level) { return depth_.data() + levels_[level].offset_; }
+		const f32* GetLevel(i32 level) const { return depth_.data() + levels_[level].offset_; }
+
+		/**
+		 * Project @a point to pixel coordinates, with depth in z.
+		 * @return false if point is behind the camera.
+		 */
+		bool Project(const Math::Vec3& point, Math::Vec3& outPoint) const
+		{
+			const Math::Vec4 clip = Math::Vec4(point, 1.0f) * viewProj_;
+			if(clip.w < 1e-4f)
+				return false;
+			const f32 invW = 1.0f / clip.w;
+			outPoint.x = (clip.x * invW * 0.5f + 0.5f) * levels_[0].width_;
+			outPoint.y = (0.5f - clip.y * invW * 0.5f) * levels_[0].height_;
+			outPoint.z = Core::Clamp(clip.z * invW * 0.5f + 0.5f, 0.0f, 1.0f);
+			return true;
+		}
+
+		/**
+		 * Rasterise triangle at pixel centres with a constant depth.
+		 */
+		void RasterizeTriangle(Math::Vec3 a, Math::Vec3 b, Math::Vec3 c, f32 depth)
+		{
+			auto Edge = [](const Math::Vec3& a, const Math::Vec3& b, f32 x, f32 y) {
+				return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+			};
+
+			const f32 area = Edge(a, b, c.x, c.y);
+			if(std::abs(area) < 1e-8f)
+				return;
+			if(area < 0.0f)
+				std::swap(b, c);
+
+			const Level& level = levels_[0];
+			const f32 width = (f32)level.width_;
+			const f32 height = (f32)level.height_;
+			const i32 minX = (i32)Core::Clamp(Core::Min(a.x, Core::Min(b.x, c.x)), 0.0f, width);
+			const i32 maxX = (i32)Core::Clamp(Core::Max(a.x, Core::Max(b.x, c.x)), 0.0f, width - 1.0f);
+			const i32 minY = (i32)Core::Clamp(Core::Min(a.y, Core::Min(b.y, c.y)), 0.0f, height);
+			const i32 maxY = (i32)Core::Clamp(Core::Max(a.y, Core::Max(b.y, c.y)), 0.0f, height - 1.0f);
+
+			f32* depthData = GetLevel(0);
+			for(i32 y = minY; y <= maxY; ++y)
+			{
+				const f32 py = y + 0.5f;
+				f32* row = depthData + y * level.width_;
+				for(i32 x = minX; x <= maxX; ++x)
+				{
+					const f32 px = x + 0.5f;
+					if(Edge(a, b, px, py) >= 0.0f && Edge(b, c, px, py) >= 0.0f && Edge(c, a, px, py) >= 0.0f)
+						row[x] = Core::Min(row[x], depth);
+				}
+			}
+		}
+	};
+
+	OcclusionBuffer::OcclusionBuffer(i32 width, i32 height)
+	{
+		DBG_ASSERT(width > 0 && height > 0);
+		impl_ = new OcclusionBufferImpl();
+
+		i32 offset = 0;
+		for(;;)
+		{
+			OcclusionBufferImpl::Level level;
+			level.width_ = width;
+			level.height_ = height;
+			level.offset_ = offset;
+			impl_->levels_.push_back(level);
+			offset += width * height;
+			if(width == 1 && height == 1)
+				break;
+			width = (width + 1) / 2;
+			height = (height + 1) / 2;
+		}
+		impl_->depth_.resize(offset, 1.0f);
+	}
+
+	OcclusionBuffer::~OcclusionBuffer() { delete impl_; }
+
+	void OcclusionBuffer::Begin(const Math::Mat44& viewProj)
+	{
+		impl_->viewProj_ = viewProj;
+		for(auto& depth : impl_->depth_)
+			depth = 1.0f;
+	}
+
+	void OcclusionBuffer::AddOccluder(const Math::Vec3* vertices, const u32* indices, i32 numIndices)
+	{
+		DBG_ASSERT((numIndices % 3) == 0);
+		for(i32 idx = 0; idx < numIndices; idx += 3)
+		{
+			Math::Vec3 a, b, c;
+			if(!impl_->Project(vertices[indices[idx + 0]], a) || !impl_->Project(vertices[indices[idx + 1]], b) ||
+			    !impl_->Project(vertices[indices[idx + 2]], c))
+				continue;
+
+			// Farthest depth, so the occluder never hides anything in front of it.
+			impl_->RasterizeTriangle(a, b, c, Core::Max(a.z, Core::Max(b.z, c.z)));
+		}
+	}
+
+	void OcclusionBuffer::AddOccluder(const Math::AABB& aabb)
+	{
+		// Faces made of corners sharing one bit of the corner index.
+		static const u32 indices[] = {
+		    0, 2, 6, 0, 6, 4, 1, 3, 7, 1, 7, 5, // x
+		    0, 1, 5, 0, 5, 4, 2, 3, 7, 2, 7, 6, // y
+		    0, 1, 3, 0, 3, 2, 4, 5, 7, 4, 7, 6, // z
+		};
+
+		Math::Vec3 corners[8];
+		for(u32 idx = 0; idx < 8; ++idx)
+			corners[idx] = aabb.Corner(idx);
+		AddOccluder(corners, indices, 36);
+	}
+
+	void OcclusionBuffer::End()
+	{
+		// Each texel is the farthest depth of the 2x2 texels below it.
+		for(i32 levelIdx = 1; levelIdx < impl_->levels_.size(); ++levelIdx)
+		{
+			const auto& src = impl_->levels_[levelIdx - 1];
+			const auto& dst = impl_->levels_[levelIdx];
+			const f32* srcData = impl_->GetLevel(levelIdx - 1);
+			f32* dstData = impl_->GetLevel(levelIdx);
+			for(i32 y = 0; y < dst.height_; ++y)
+			{
+				const i32 y0 = y * 2;
+				const i32 y1 = Core::Min(y0 + 1, src.height_ - 1);
+				for(i32 x = 0; x < dst.width_; ++x)
+				{
+					const i32 x0 = x * 2;
+					const i32 x1 = Core::Min(x0 + 1, src.width_ - 1);
+					dstData[y * dst.width_ + x] =
+					    Core::Max(Core::Max(srcData[y0 * src.width_ + x0], srcData[y0 * src.width_ + x1]),
+					        Core::Max(srcData[y1 * src.width_ + x0], srcData[y1 * src.width_ + x1]));
+				}
+			}
+		}
+	}
+
+	bool OcclusionBuffer::IsVisible(const Math::AABB& aabb) const
+	{
+		Math::Vec3 minimum(FLT_MAX, FLT_MAX, FLT_MAX);
+		Math::Vec3 maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for(u32 idx = 0; idx < 8; ++idx)
+		{
+			Math::Vec3 point;
+			if(!impl_->Project(aabb.Corner(idx), point))
+				return true;
+			minimum = Math::Vec3(Core::Min(minimum.x, point.x), Core::Min(minimum.y, point.y),
+			    Core::Min(minimum.z, point.z));
+			maximum = Math::Vec3(Core::Max(maximum.x, point.x), Core::Max(maximum.y, point.y),
+			    Core::Max(maximum.z, point.z));
+		}
+
+		const auto& base = impl_->levels_[0];
+		if(maximum.x < 0.0f || maximum.y < 0.0f || minimum.x >= base.width_ || minimum.y >= base.height_)
+			return true;
+
+		const i32 minX = (i32)Core::Max(minimum.x, 0.0f);
+		const i32 minY = (i32)Core::Max(minimum.y, 0.0f);
+		const i32 maxX = (i32)Core::Min(maximum.x, base.width_ - 1.0f);
+		const i32 maxY = (i32)Core::Min(maximum.y, base.height_ - 1.0f);
+
+		// Pick level where the rect covers at most 3x3 texels.
+		const i32 size = Core::Max(maxX - minX, maxY - minY) + 1;
+		i32 levelIdx = 0;
+		while((size >> levelIdx) > 2 && (levelIdx + 1) < impl_->levels_.size())
+			++levelIdx;
+
+		const auto& level = impl_->levels_[levelIdx];
+		const f32* depthData = impl_->GetLevel(levelIdx);
+		for(i32 y = minY >> levelIdx; y <= (maxY >> levelIdx); ++y)
+			for(i32 x = minX >> levelIdx; x <= (maxX >> levelIdx); ++x)
+				if(minimum.z <= depthData[y * level.width_ + x])
+					return true;
+		return false;
+	}
+
+	i32 OcclusionBuffer::GetWidth() const { return impl_->levels_[0].width_; }
+
+	i32 OcclusionBuffer::GetHeight() const { return impl_->levels_[0].height_; }
+
+	f32 OcclusionBuffer::GetDepth(i32 x, i32 y) const
+	{
+		DBG_ASSERT(x >= 0 && x < GetWidth());
+		DBG_ASSERT(y >= 0 && y < GetHeight());
+		return impl_->GetLevel(0)[y * GetWidth() + x];
+	}
+
+	namespace
+	{
+		/**
+		 * Cull [0, @a num) in batches across job workers, then compact the visible indices.
+		 * @param cullFn Called with (begin, end, outVisible), returns number of visible indices written.
+		 */
+		template<typename CULL_FN>
+		i32 CullParallel(i32 num, const CullingParams& params, Core::Vector<i32>& outVisible, CULL_FN cullFn)
+		{
+			outVisible.resize(num);
+			if(num == 0)
+				return 0;
+
+			const i32 batchSize = Core::PotRoundUp(Core::Max(params.batchSize_, 8), 8);
+			const i32 numBatches = (num + batchSize - 1) / batchSize;
+			Core::Vector<i32> batchCounts;
+			batchCounts.resize(numBatches);
+
+			// Each batch writes to its own range of the output, so no synchronisation needed.
+			i32* visible = outVisible.data();
+			i32* counts = batchCounts.data();
+			Job::ParallelFor("Graphics::Cull", num, batchSize,
+			    [visible, counts, batchSize, &cullFn](i32 begin, i32 end) {
+				    counts[begin / batchSize] = cullFn(begin, end, visible + begin);
+				});
+
+			i32 numVisible = 0;
+			for(i32 batchIdx = 0; batchIdx < numBatches; ++batchIdx)
+			{
+				const i32 count = batchCounts[batchIdx];
+				const i32 begin = batchIdx * batchSize;
+				if(numVisible != begin && count > 0)
+					memmove(visible + numVisible, visible + begin, count * sizeof(i32));
+				numVisible += count;
+			}
+			outVisible.resize(numVisible);
+			return numVisible;
+		}
+
+		/// Write indices for set bits of @a mask.
+		i32 WriteVisible(i32 mask, i32 base, i32* outVisible)
+		{
+			i32 numVisible = 0;
+			for(i32 bit = 0; mask != 0; ++bit, mask >>= 1)
+				if(mask & 1)
+					outVisible[numVisible++] = base + bit;
+			return numVisible;
+		}
+
+		/// Remove occluded boxes from @a visible, using @a getBoundsFn to get bounds for each.
+		template<typename BOUNDS_FN>
+		i32 CullOccluded(const OcclusionBuffer& occlusion, i32* visible, i32 numVisible, BOUNDS_FN getBoundsFn)
+		{
+			i32 numOut = 0;
+			for(i32 idx = 0; idx < numVisible; ++idx)
+				if(occlusion.IsVisible(getBoundsFn(visible[idx])))
+					visible[numOut++] = visible[idx];
+			return numOut;
+		}
+
+		i32 CullBoxesRange(
+		    const CullingFrustum& frustum, const CullingBoxes& boxes, i32 begin, i32 end, i32* outVisible)
+		{
+			using namespace Math::SIMD;
+
+			// Only the corner farthest along each plane normal needs testing.
+			const f32* xs[CullingFrustum::NUM_PLANES];
+			const f32* ys[CullingFrustum::NUM_PLANES];
+			const f32* zs[CullingFrustum::NUM_PLANES];
+			for(i32 planeIdx = 0; planeIdx < CullingFrustum::NUM_PLANES; ++planeIdx)
+			{
+				const Math::Vec4& plane = frustum.planes_[planeIdx];
+				xs[planeIdx] = plane.x >= 0.0f ? boxes.maxX_.data() : boxes.minX_.data();
+				ys[planeIdx] = plane.y >= 0.0f ? boxes.maxY_.data() : boxes.minY_.data();
+				zs[planeIdx] = plane.z >= 0.0f ? boxes.maxZ_.data() : boxes.minZ_.data();
+			}
+
+			i32 numVisible = 0;
+			i32 idx = begin;
+			for(; (idx + 8) <= end; idx += 8)
+			{
+				i32 mask = 0xff;
+				for(i32 planeIdx = 0; planeIdx < CullingFrustum::NUM_PLANES && mask != 0; ++planeIdx)
+				{
+					const Math::Vec4& plane = frustum.planes_[planeIdx];
+					const Float4 nx = Splat(plane.x);
+					const Float4 ny = Splat(plane.y);
+					const Float4 nz = Splat(plane.z);
+					const Float4 d = Splat(-plane.w);
+					const f32* x = xs[planeIdx] + idx;
+					const f32* y = ys[planeIdx] + idx;
+					const f32* z = zs[planeIdx] + idx;
+					const Float4 dist0 = MulAdd(nz, Load(z), MulAdd(ny, Load(y), Mul(nx, Load(x))));
+					const Float4 dist1 = MulAdd(nz, Load(z + 4), MulAdd(ny, Load(y + 4), Mul(nx, Load(x + 4))));
+					mask &= MaskGreaterEqual(dist0, d) | (MaskGreaterEqual(dist1, d) << 4);
+				}
+				numVisible += WriteVisible(mask, idx, outVisible + numVisible);
+			}
+
+			for(; idx < end; ++idx)
+			{
+				bool visible = true;
+				for(i32 planeIdx = 0; planeIdx < CullingFrustum::NUM_PLANES && visible; ++planeIdx)
+				{
+					const Math::Vec4& plane = frustum.planes_[planeIdx];
+					const f32 x = xs[planeIdx][idx];
+					const f32 y = ys[planeIdx][idx];
+					const f32 z = zs[planeIdx][idx];
+					const f32 dist = plane.z * z + (plane.y * y + plane.x * x);
+					visible = dist >= -plane.w;
+				}
+				if(visible)
+					outVisible[numVisible++] = idx;
+			}
+			return numVisible;
+		}
+
+		i32 CullSpheresRange(
+		    const CullingFrustum& frustum, const CullingSpheres& spheres, i32 begin, i32 end, i32* outVisible)
+		{
+			using namespace Math::SIMD;
+
+			const f32* xs = spheres.x_.data();
+			const f32* ys = spheres.y_.data();
+			const f32* zs = spheres.z_.data();
+			const f32* radii = spheres.radius_.data();
+
+			i32 numVisible = 0;
+			i32 idx = begin;
+			for(; (idx + 8) <= end; idx += 8)
+			{
+				const Float4 x0 = Load(xs + idx);
+				const Float4 x1 = Load(xs + idx + 4);
+				const Float4 y0 = Load(ys + idx);
+				const Float4 y1 = Load(ys + idx + 4);
+				const Float4 z0 = Load(zs + idx);
+				const Float4 z1 = Load(zs + idx + 4);
+				const Float4 r0 = Load(radii + idx);
+				const Float4 r1 = Load(radii + idx + 4);
+
+				i32 mask = 0xff;
+				for(i32 planeIdx = 0; planeIdx < CullingFrustum::NUM_PLANES && mask != 0; ++planeIdx)
+				{
+					const Math::Vec4& plane = frustum.planes_[planeIdx];
+					const Float4 nx = Splat(plane.x);
+					const Float4 ny = Splat(plane.y);
+					const Float4 nz = Splat(plane.z);
+					const Float4 d = Splat(-plane.w);
+					const Float4 dist0 = Add(MulAdd(nz, z0, MulAdd(ny, y0, Mul(nx, x0))), r0);
+					const Float4 dist1 = Add(MulAdd(nz, z1, MulAdd(ny, y1, Mul(nx, x1))), r1);
+					mask &= MaskGreaterEqual(dist0, d) | (MaskGreaterEqual(dist1, d) << 4);
+				}
+				numVisible += WriteVisible(mask, idx, outVisible + numVisible);
+			}
+
+			for(; idx < end; ++idx)
+			{
+				bool visible = true;
+				for(i32 planeIdx = 0; planeIdx < CullingFrustum::NUM_PLANES && visible; ++planeIdx)
+				{
+					const Math::Vec4& plane = frustum.planes_[planeIdx];
+					const f32 dist = (plane.z * zs[idx] + (plane.y * ys[idx] + plane.x * xs[idx])) + radii[idx];
+					visible = dist >= -plane.w;
+				}
+				if(visible)
+					outVisible[numVisible++] = idx;
+			}
+			return numVisible;
+		}
+	}
+
+	i32 CullBoxes(const CullingFrustum& frustum, const CullingBoxes& boxes, Core::Vector<i32>& outVisible,
+	    const CullingParams& params)
+	{
+		return CullParallel(boxes.Size(), params, outVisible, [&](i32 begin, i32 end, i32* visible) {
+			i32 numVisible = CullBoxesRange(frustum, boxes, begin, end, visible);
+			if(params.occlusion_)
+			{
+				numVisible = CullOccluded(*params.occlusion_, visible, numVisible, [&boxes](i32 idx) {
+					return Math::AABB(Math::Vec3(boxes.minX_[idx], boxes.minY_[idx], boxes.minZ_[idx]),
+					    Math::Vec3(boxes.maxX_[idx], boxes.maxY_[idx], boxes.maxZ_[idx]));
+				});
+			}
+			return numVisible;
+		});
+	}
+
+	i32 CullSpheres(const CullingFrustum& frustum, const CullingSpheres& spheres, Core::Vector<i32>& outVisible,
+	    const CullingParams& params)
+	{
+		return CullParallel(spheres.Size(), params, outVisible, [&](i32 begin, i32 end, i32* visible) {
+			i32 numVisible = CullSpheresRange(frustum, spheres, begin, end, visible);
+			if(params.occlusion_)
+			{
+				numVisible = CullOccluded(*params.occlusion_, visible, numVisible, [&spheres](i32 idx) {
+					const Math::Vec3 center(spheres.x_[idx], spheres.y_[idx], spheres.z_[idx]);
+					const Math::Vec3 extents(spheres.radius_[idx], spheres.radius_[idx], spheres.radius_[idx]);
+					return Math::AABB(center - extents, center + extents);
+				});
+			}
+			return numVisible;
+		});
+	}
+
+	bool IsMeshletBackfacing(const ModelMeshlet& meshlet, const Math::Vec3& eye)
+	{
+		if(meshlet.coneCutoff_ >= 1.0f)
+			return false;
+
+		// Every point in the bounding sphere must be seen within 90 degrees minus the cone's half angle
+		// of its axis, which is when every triangle normal points away from the eye.
+		const Math::Vec3 view = meshlet.center_ - eye;
+		return view.Dot(meshlet.coneAxis_) >
+		       meshlet.coneCutoff_ * (view.Magnitude() + meshlet.radius_) + meshlet.radius_;
+	}
+
+	i32 CullMeshlets(const CullingFrustum& frustum, const Math::Vec3& eye, const ModelMeshlet* meshlets,
+	    i32 numMeshlets, Core::Vector<i32>& outVisible)
+	{
+		outVisible.clear();
+		for(i32 idx = 0; idx < numMeshlets; ++idx)
+		{
+			const ModelMeshlet& meshlet = meshlets[idx];
+			bool visible = !IsMeshletBackfacing(meshlet, eye);
+			for(i32 planeIdx = 0; visible && planeIdx < CullingFrustum::NUM_PLANES; ++planeIdx)
+			{
+				const Math::Vec4& plane = frustum.planes_[planeIdx];
+				const f32 distance = plane.x * meshlet.center_.x + plane.y * meshlet.center_.y +
+				                     plane.z * meshlet.center_.z + plane.w;
+				visible = distance >= -meshlet.radius_;
+			}
+			if(visible)
+				outVisible.push_back(idx);
+		}
+		return outVisible.size();
+	}
+
+} // namespace Graphics
@@ -2,12 +2,42 @@
 #include "graphics/texture.h"
 #include "graphics/private/material_impl.h"
 #include "gpu/manager.h"
+#include "core/concurrency.h"
 #include "core/file.h"
 #include "resource/factory.h"
 #include "resource/manager.h"
 
+#include <algorithm>
+
 namespace Graphics
 {
+	namespace
+	{
+		void SetTextureBinding(ShaderBindingSet& bindings, const char* bindingName, Texture* tex)
+		{
+			const auto& texDesc = tex->GetDesc();
+			switch(texDesc.type_)
+			{
+			case GPU::TextureType::TEX1D:
+				bindings.Set(
+				    bindingName, GPU::Binding::Texture1D(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
+				break;
+			case GPU::TextureType::TEX2D:
+				bindings.Set(
+				    bindingName, GPU::Binding::Texture2D(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
+				break;
+			case GPU::TextureType::TEX3D:
+				bindings.Set(
+				    bindingName, GPU::Binding::Texture3D(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
+				break;
+			case GPU::TextureType::TEXCUBE:
+				bindings.Set(
+				    bindingName, GPU::Binding::TextureCube(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
+				break;
+			}
+		}
+	}
+
 	class MaterialFactory : public Resource::IFactory
 	{
 	public:
@@ -29,8 +59,14 @@ namespace Graphics
 		bool DestroyResource(Resource::IFactoryContext& context, void** inResource, const Core::UUID& type) override
 		{
 			DBG_ASSERT(type == Material::GetTypeUUID());
-			auto* shader = reinterpret_cast<Material*>(*inResource);
-			delete shader;
+			auto* material = reinterpret_cast<Material*>(*inResource);
+			{
+				Core::ScopedMutex lock(materialsMutex_);
+				auto it = std::find(materials_.begin(), materials_.end(), material);
+				if(it != materials_.end())
+					materials_.erase(it);
+			}
+			delete material;
 			*inResource = nullptr;
 			return true;
 		}
@@ -75,6 +111,7 @@ namespace Graphics
 			// Attempt to load in all dependent resources.
 			impl->shaderRes_ = ShaderRef(impl->data_.shader_);
 			impl->textureRes_.reserve(impl->data_.numTextures_);
+			impl->textureVersions_.resize(impl->data_.numTextures_, -1);
 
 			// Wait on resources to finish loading.
 			impl->shaderRes_.WaitUntilReady();
@@ -102,26 +139,8 @@ namespace Graphics
 						Texture* tex = impl->textureRes_[idx];
 						if(tex)
 						{
-							const auto& texDesc = tex->GetDesc();
-							switch(texDesc.type_)
-							{
-							case GPU::TextureType::TEX1D:
-								impl->bindings_.Set(bindingName,
-								    GPU::Binding::Texture1D(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
-								break;
-							case GPU::TextureType::TEX2D:
-								impl->bindings_.Set(bindingName,
-								    GPU::Binding::Texture2D(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
-								break;
-							case GPU::TextureType::TEX3D:
-								impl->bindings_.Set(bindingName,
-								    GPU::Binding::Texture3D(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
-								break;
-							case GPU::TextureType::TEXCUBE:
-								impl->bindings_.Set(bindingName,
-								    GPU::Binding::TextureCube(tex->GetHandle(), texDesc.format_, 0, texDesc.levels_));
-								break;
-							}
+							SetTextureBinding(impl->bindings_, bindingName, tex);
+							impl->textureVersions_[idx] = tex->GetVersion();
 						}
 					}
 				}
@@ -130,15 +149,43 @@ namespace Graphics
 			}
 
 			impl->name_ = name;
+
+			Core::ScopedMutex lock(materialsMutex_);
 			material->impl_ = impl;
+			if(std::find(materials_.begin(), materials_.end(), material) == materials_.end())
+				materials_.push_back(material);
 
 			return true;
 		}
 
 		bool SerializeSettings(Serialization::Serializer& ser) override { return true; }
 
+		void UpdateTextureBindings()
+		{
+			Core::ScopedMutex lock(materialsMutex_);
+			for(auto* material : materials_)
+			{
+				auto* impl = material->impl_;
+				if(!impl->bindings_)
+					continue;
+
+				for(i32 idx = 0; idx < impl->textureRes_.size(); ++idx)
+				{
+					Texture* tex = impl->textureRes_[idx];
+					if(tex && tex->GetVersion() != impl->textureVersions_[idx])
+					{
+						SetTextureBinding(impl->bindings_, impl->textures_[idx].bindingName_.data(), tex);
+						impl->textureVersions_[idx] = tex->GetVersion();
+					}
+				}
+			}
+		}
 
 		GPU::Handle defaultTex_;
+
+		// Loaded materials, to update texture bindings.
+		Core::Mutex materialsMutex_;
+		Core::Vector<Material*> materials_;
 	};
 
 	DEFINE_RESOURCE(Material);
@@ -149,6 +196,21 @@ namespace Graphics
 
 	const ShaderBindingSet& Material::GetBindingSet() const { return impl_->bindings_; }
 
+	void Material::RequestTextureLevels(f32 screenSize) const
+	{
+		for(auto& textureRes : impl_->textureRes_)
+		{
+			if(Texture* tex = textureRes)
+				tex->RequestLevel(tex->GetLevelForScreenSize(screenSize));
+		}
+	}
+
+	void UpdateMaterialTextureBindings()
+	{
+		if(auto* factory = Material::GetFactory())
+			factory->UpdateTextureBindings();
+	}
+
 	ShaderTechnique Material::CreateTechnique(const char* name, const ShaderTechniqueDesc& desc)
 	{
 		auto tech = impl_->shaderRes_->CreateTechnique(name, desc);
@@ -31,6 +31,8 @@ namespace Graphics
 		Core::String name_;
 		ShaderRef shaderRes_;
 		Core::Vector<TextureRef> textureRes_;
+		/// Texture versions bindings_ were last set from.
+		Core::Vector<i32> textureVersions_;
 
 		ShaderBindingSet bindings_;
 
@@ -38,4 +40,10 @@ namespace Graphics
 		~MaterialImpl();
 	};
 
+	/**
+	 * Rebind textures whose handles changed due to streaming or reload, in all loaded materials.
+	 * Called from TextureStreaming::Update, so bindings only change at that once per frame sync point.
+	 */
+	void UpdateMaterialTextureBindings();
+
 } // namespace Graphics
@@ -1,5 +1,7 @@
 #include "graphics/model.h"
 #include "graphics/private/model_impl.h"
+#include "graphics/skinning.h"
+#include "graphics/transform_hierarchy.h"
 
 #include "resource/factory.h"
 #include "resource/manager.h"
@@ -58,8 +60,6 @@ namespace Graphics
 			impl->nodeDatas_.parents_.resize(impl->data_.numNodes_);
 			impl->meshNodes_.resize(impl->data_.numMeshNodes_);
 			impl->meshNodeAABBDatas_.resize(impl->data_.numAABBs_);
-			impl->meshNodeBonePaletteDatas_.resize(impl->data_.numBonePalettes_);
-			impl->meshNodeInverseBindposeDatas_.resize(impl->data_.numInverseBindPoses_);
 
 			readBytes = sizeof(Math::Mat44) * impl->data_.numNodes_;
 			if(inFile.Read(impl->nodeDatas_.local_.data(), readBytes) != readBytes)
@@ -96,15 +96,26 @@ namespace Graphics
 				return false;
 			}
 
-			readBytes = sizeof(MeshNodeBonePalette) * impl->data_.numBonePalettes_;
-			if(inFile.Read(impl->meshNodeBonePaletteDatas_.data(), readBytes) != readBytes)
+			// Bone palettes are written in order, each with one entry per bone of its mesh node.
+			DBG_ASSERT(impl->data_.numBonePalettes_ == impl->data_.numInverseBindPoses_);
+			impl->bonePaletteOffsets_.resize(impl->data_.numBonePalettes_ + 1, 0);
+			for(const auto& meshNode : impl->meshNodes_)
+				if(meshNode.bonePaletteIdx_ >= 0)
+					impl->bonePaletteOffsets_[meshNode.bonePaletteIdx_ + 1] = meshNode.noofBones_;
+			for(i32 idx = 0; idx < impl->data_.numBonePalettes_; ++idx)
+				impl->bonePaletteOffsets_[idx + 1] += impl->bonePaletteOffsets_[idx];
+			impl->boneNodeIndices_.resize(impl->bonePaletteOffsets_.back());
+			impl->inverseBindPoses_.resize(impl->bonePaletteOffsets_.back());
+
+			readBytes = sizeof(i32) * impl->boneNodeIndices_.size();
+			if(inFile.Read(impl->boneNodeIndices_.data(), readBytes) != readBytes)
 			{
 				delete impl;
 				return false;
 			}
 
-			readBytes = sizeof(MeshNodeInverseBindpose) * impl->data_.numInverseBindPoses_;
-			if(inFile.Read(impl->meshNodeInverseBindposeDatas_.data(), readBytes) != readBytes)
+			readBytes = sizeof(Math::Mat44) * impl->inverseBindPoses_.size();
+			if(inFile.Read(impl->inverseBindPoses_.data(), readBytes) != readBytes)
 			{
 				delete impl;
 				return false;
@@ -135,6 +146,14 @@ namespace Graphics
 				return false;
 			}
 
+			impl->meshlets_.resize(impl->data_.numMeshlets_);
+			readBytes = sizeof(ModelMeshlet) * impl->data_.numMeshlets_;
+			if(inFile.Read(impl->meshlets_.data(), readBytes) != readBytes)
+			{
+				delete impl;
+				return false;
+			}
+
 			// Now load in and create vertex + index buffers.
 			if(GPU::Manager::IsInitialized())
 			{
@@ -301,12 +320,31 @@ namespace Graphics
 		return retVal;
 	}
 
+	Core::ArrayView<ModelMeshlet> Model::GetMeshMeshlets(i32 meshIdx) const
+	{
+		DBG_ASSERT(meshIdx < impl_->data_.numMeshNodes_);
+		const auto& meshNode = impl_->meshNodes_[meshIdx];
+		if(meshNode.meshletIdx_ >= 0)
+			return Core::ArrayView<ModelMeshlet>(impl_->meshlets_.data() + meshNode.meshletIdx_,
+			    impl_->meshlets_.data() + meshNode.meshletIdx_ + meshNode.noofMeshlets_);
+		return Core::ArrayView<ModelMeshlet>();
+	}
+
 	Material* Model::GetMeshMaterial(i32 meshIdx) const
 	{
 		DBG_ASSERT(meshIdx < impl_->data_.numMeshNodes_);
 		return impl_->materials_[meshIdx];
 	}
 
+	Math::AABB Model::GetMeshAABB(i32 meshIdx) const
+	{
+		DBG_ASSERT(meshIdx < impl_->data_.numMeshNodes_);
+		const auto& meshNode = impl_->meshNodes_[meshIdx];
+		if(meshNode.aabbIdx_ >= 0)
+			return impl_->meshNodeAABBDatas_[meshNode.aabbIdx_].aabb_;
+		return Math::AABB();
+	}
+
 	Math::Mat44 Model::GetMeshWorldTransform(i32 meshIdx) const
 	{
 		DBG_ASSERT(meshIdx < impl_->data_.numMeshNodes_);
@@ -314,6 +352,43 @@ namespace Graphics
 		return impl_->nodeDatas_.world_[meshNode.nodeIdx_];
 	}
 
+	i32 Model::GetNumNodes() const { return impl_->data_.numNodes_; }
+
+	i32 Model::GetMeshNodeIdx(i32 meshIdx) const
+	{
+		DBG_ASSERT(meshIdx < impl_->data_.numMeshNodes_);
+		return impl_->meshNodes_[meshIdx].nodeIdx_;
+	}
+
+	i32 Model::AddToHierarchy(TransformHierarchy& hierarchy, i32 parentIdx) const
+	{
+		const auto& nodeDatas = impl_->nodeDatas_;
+		const i32 baseIdx = hierarchy.GetNumNodes();
+		for(i32 idx = 0; idx < impl_->data_.numNodes_; ++idx)
+		{
+			// Converter writes parents before their children.
+			const i32 nodeParentIdx = nodeDatas.parents_[idx];
+			DBG_ASSERT(nodeParentIdx < idx);
+			hierarchy.AddNode(nodeParentIdx >= 0 ? baseIdx + nodeParentIdx : parentIdx, nodeDatas.local_[idx]);
+		}
+		return baseIdx;
+	}
+
+	i32 Model::AddSkinningBones(i32 meshIdx, SkinningBones& bones, i32 nodeBaseIdx) const
+	{
+		DBG_ASSERT(meshIdx < impl_->data_.numMeshNodes_);
+		const auto& meshNode = impl_->meshNodes_[meshIdx];
+		if(meshNode.bonePaletteIdx_ < 0)
+			return -1;
+
+		const i32 firstBoneIdx = bones.Size();
+		const i32 begin = impl_->bonePaletteOffsets_[meshNode.bonePaletteIdx_];
+		const i32 end = impl_->bonePaletteOffsets_[meshNode.bonePaletteIdx_ + 1];
+		for(i32 idx = begin; idx < end; ++idx)
+			bones.Add(nodeBaseIdx + impl_->boneNodeIndices_[idx], impl_->inverseBindPoses_[idx]);
+		return firstBoneIdx;
+	}
+
 	ModelImpl::ModelImpl() {}
 
 	ModelImpl::~ModelImpl()
@@ -31,6 +31,7 @@ namespace Graphics
 		i32 numBonePalettes_ = 0;
 		i32 numInverseBindPoses_ = 0;
 		i32 numMaterials_ = 0;
+		i32 numMeshlets_ = 0;
 	};
 
 	struct MeshNode
@@ -43,6 +44,8 @@ namespace Graphics
 		i32 inverseBindPoseIdx_ = -1;
 		i32 meshIdx_ = -1;
 		i32 drawIdx_ = -1;
+		i32 meshletIdx_ = -1;
+		i32 noofMeshlets_ = 0;
 	};
 
 	struct MeshNodeAABB
@@ -101,13 +104,17 @@ namespace Graphics
 		// Mesh node data.
 		Core::Vector<MeshNode> meshNodes_;
 		Core::Vector<MeshNodeAABB> meshNodeAABBDatas_;
-		Core::Vector<MeshNodeBonePalette> meshNodeBonePaletteDatas_;
-		Core::Vector<MeshNodeInverseBindpose> meshNodeInverseBindposeDatas_;
+
+		// Bone data for all palettes. Palette n's bones are [bonePaletteOffsets_[n], bonePaletteOffsets_[n + 1]).
+		Core::Vector<i32> bonePaletteOffsets_;
+		Core::Vector<i32> boneNodeIndices_;
+		Core::Vector<Math::Mat44> inverseBindPoses_;
 
 		// Actual mesh data.
 		Core::Vector<ModelMeshData> modelMeshes_;
 		Core::Vector<GPU::VertexElement> elements_;
 		Core::Vector<ModelMeshDraw> draws_;
+		Core::Vector<ModelMeshlet> meshlets_;
 
 		Core::Vector<GPU::Handle> vbs_;
 		Core::Vector<GPU::Handle> ibs_;
@@ -0,0 +1,280 @@
+#include "graphics/pipeline_state_cache.h"
+#include "graphics/private/pipeline_state_cache_impl.h"
+
+#include "core/debug.h"
+#include "core/string.h"
+#include "core/timer.h"
+#include "gpu/manager.h"
+#include "job/manager.h"
+
+#include <cstdarg>
+
+namespace Graphics
+{
+	namespace
+	{
+		PipelineStateCacheImpl* impl_ = nullptr;
+	}
+
+	PipelineStateCacheImpl::PipelineStateCacheImpl() {}
+
+	PipelineStateCacheImpl::~PipelineStateCacheImpl()
+	{
+		DBG_ASSERT_MSG(entries_.size() == 0, "Pipeline states are still referenced.");
+
+		for(auto it : entries_)
+		{
+			if(GPU::Manager::IsInitialized())
+				GPU::Manager::DestroyResource(it.value->handle_);
+			delete it.value;
+		}
+	}
+
+	void PipelineStateCacheImpl::Create()
+	{
+		DBG_ASSERT(impl_ == nullptr);
+		impl_ = new PipelineStateCacheImpl();
+	}
+
+	void PipelineStateCacheImpl::Destroy()
+	{
+		DBG_ASSERT(impl_ != nullptr);
+		delete impl_;
+		impl_ = nullptr;
+	}
+
+	PipelineStateCacheImpl* PipelineStateCacheImpl::Get()
+	{
+		DBG_ASSERT(impl_ != nullptr);
+		return impl_;
+	}
+
+	template<typename CREATE_FN>
+	GPU::Handle PipelineStateCacheImpl::AcquireInternal(u64 hash, bool isPrewarm, CREATE_FN createFn)
+	{
+		Entry* entry = nullptr;
+		bool create = false;
+		{
+			Core::ScopedMutex lock(mutex_);
+			if(auto* found = entries_.find(hash))
+			{
+				entry = *found;
+				if(!isPrewarm)
+					stats_.numHits_++;
+			}
+			else
+			{
+				entry = new Entry();
+				entries_.insert(hash, entry);
+				create = true;
+			}
+			entry->refCount_++;
+		}
+
+		if(create)
+		{
+			Core::Timer timer;
+			timer.Mark();
+			GPU::Handle handle = createFn();
+			const f64 time = timer.GetTime();
+
+			Core::ScopedMutex lock(mutex_);
+			entry->handle_ = handle;
+			if(isPrewarm)
+			{
+				stats_.numPrewarmed_++;
+				stats_.prewarmTime_ += time;
+			}
+			else
+			{
+				stats_.numMisses_++;
+				stats_.missTime_ += time;
+			}
+			Core::AtomicExchg(&entry->isReady_, 1);
+			return handle;
+		}
+
+		// Another thread is creating it, wait until it's done.
+		while(entry->isReady_ == 0)
+		{
+			if(Job::Manager::IsInitialized())
+				Job::Manager::YieldCPU();
+			else
+				Core::SwitchThread();
+		}
+
+		Core::ScopedMutex lock(mutex_);
+		return entry->handle_;
+	}
+
+	GPU::Handle PipelineStateCacheImpl::Acquire(
+	    u64 hash, const GPU::GraphicsPipelineStateDesc& desc, bool isPrewarm, const char* debugFmt, ...)
+	{
+		Core::String debugName;
+		va_list args;
+		va_start(args, debugFmt);
+		debugName.Printfv(debugFmt, args);
+		va_end(args);
+
+		return AcquireInternal(hash, isPrewarm,
+		    [&]() { return GPU::Manager::CreateGraphicsPipelineState(desc, "%s", debugName.c_str()); });
+	}
+
+	GPU::Handle PipelineStateCacheImpl::Acquire(
+	    u64 hash, const GPU::ComputePipelineStateDesc& desc, bool isPrewarm, const char* debugFmt, ...)
+	{
+		Core::String debugName;
+		va_list args;
+		va_start(args, debugFmt);
+		debugName.Printfv(debugFmt, args);
+		va_end(args);
+
+		return AcquireInternal(hash, isPrewarm,
+		    [&]() { return GPU::Manager::CreateComputePipelineState(desc, "%s", debugName.c_str()); });
+	}
+
+	void PipelineStateCacheImpl::Release(u64 hash)
+	{
+		Entry* entry = nullptr;
+		{
+			Core::ScopedMutex lock(mutex_);
+			auto* found = entries_.find(hash);
+			DBG_ASSERT(found);
+			if(found == nullptr)
+				return;
+
+			entry = *found;
+			DBG_ASSERT(entry->refCount_ > 0);
+			if(--entry->refCount_ > 0)
+				return;
+			entries_.erase(hash);
+		}
+
+		// Last reference is only dropped once the creator has finished, so handle is valid to destroy.
+		DBG_ASSERT(entry->isReady_);
+		if(GPU::Manager::IsInitialized())
+			GPU::Manager::DestroyResource(entry->handle_);
+		delete entry;
+	}
+
+	void PipelineStateCacheImpl::Record(
+	    u64 hash, u64 oldHash, const char* shaderName, const char* techniqueName, const ShaderTechniqueDesc& desc)
+	{
+		Core::ScopedMutex lock(mutex_);
+		if(oldHash != 0 && oldHash != hash)
+			records_.erase(oldHash);
+
+		if(records_.find(hash) == nullptr)
+		{
+			PipelineStateCacheRecord record;
+			record.hash_ = hash;
+			strcpy_s(record.shaderName_, sizeof(record.shaderName_), shaderName);
+			strcpy_s(record.techniqueName_, sizeof(record.techniqueName_), techniqueName);
+			record.desc_ = desc;
+			records_.insert(hash, record);
+		}
+	}
+
+	void PipelineStateCacheImpl::GetRecords(const char* shaderName, Core::Vector<PipelineStateCacheRecord>& outRecords)
+	{
+		Core::ScopedMutex lock(mutex_);
+		for(const auto& it : records_)
+			if(strcmp(it.value.shaderName_, shaderName) == 0)
+				outRecords.push_back(it.value);
+	}
+
+	bool PipelineStateCacheImpl::Load(const char* path)
+	{
+		Core::File file(path, Core::FileFlags::READ);
+		if(!file)
+			return false;
+
+		PipelineStateCacheHeader header;
+		if(file.Read(&header, sizeof(header)) != sizeof(header))
+			return false;
+
+		if(header.magic_ != PipelineStateCacheHeader::MAGIC)
+			return false;
+
+		if(header.majorVersion_ != PipelineStateCacheHeader::MAJOR_VERSION)
+		{
+			DBG_LOG("PipelineStateCache: \"%s\" major version mismatch, ignoring.\n", path);
+			return false;
+		}
+
+		// Records must fill the rest of the file exactly.
+		const i64 readBytes = (i64)header.numRecords_ * sizeof(PipelineStateCacheRecord);
+		if(header.numRecords_ < 0 || file.Size() != (i64)sizeof(header) + readBytes)
+		{
+			DBG_LOG("PipelineStateCache: \"%s\" is corrupt, ignoring.\n", path);
+			return false;
+		}
+
+		Core::Vector<PipelineStateCacheRecord> records;
+		records.resize(header.numRecords_);
+		if(file.Read(records.data(), readBytes) != readBytes)
+			return false;
+
+		for(const auto& record : records)
+		{
+			if(record.shaderName_[sizeof(record.shaderName_) - 1] != '\0' ||
+			    record.techniqueName_[sizeof(record.techniqueName_) - 1] != '\0')
+			{
+				DBG_LOG("PipelineStateCache: \"%s\" is corrupt, ignoring.\n", path);
+				return false;
+			}
+		}
+
+		Core::ScopedMutex lock(mutex_);
+		for(const auto& record : records)
+			records_.insert(record.hash_, record);
+		return true;
+	}
+
+	bool PipelineStateCacheImpl::Save(const char* path)
+	{
+		Core::Vector<PipelineStateCacheRecord> records;
+		{
+			Core::ScopedMutex lock(mutex_);
+			records.reserve(records_.size());
+			for(const auto& it : records_)
+				records.push_back(it.value);
+		}
+
+		Core::File file(path, Core::FileFlags::DEFAULT_WRITE);
+		if(!file)
+			return false;
+
+		PipelineStateCacheHeader header;
+		header.numRecords_ = records.size();
+		if(file.Write(&header, sizeof(header)) != sizeof(header))
+			return false;
+
+		const i64 writeBytes = records.size() * sizeof(PipelineStateCacheRecord);
+		return file.Write(records.data(), writeBytes) == writeBytes;
+	}
+
+	PipelineStateCacheStats PipelineStateCacheImpl::GetStats()
+	{
+		Core::ScopedMutex lock(mutex_);
+		PipelineStateCacheStats stats = stats_;
+		stats.numEntries_ = entries_.size();
+		stats.numRecords_ = records_.size();
+		return stats;
+	}
+
+	void PipelineStateCacheImpl::ResetStats()
+	{
+		Core::ScopedMutex lock(mutex_);
+		stats_ = PipelineStateCacheStats();
+	}
+
+	bool PipelineStateCache::Load(const char* path) { return PipelineStateCacheImpl::Get()->Load(path); }
+
+	bool PipelineStateCache::Save(const char* path) { return PipelineStateCacheImpl::Get()->Save(path); }
+
+	PipelineStateCacheStats PipelineStateCache::GetStats() { return PipelineStateCacheImpl::Get()->GetStats(); }
+
+	void PipelineStateCache::ResetStats() { PipelineStateCacheImpl::Get()->ResetStats(); }
+
+} // namespace Graphics
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "graphics/pipeline_state_cache.h"
+#include "graphics/private/shader_impl.h"
+#include "core/concurrency.h"
+#include "core/file.h"
+#include "core/map.h"
+#include "core/vector.h"
+#include "gpu/resources.h"
+
+namespace Graphics
+{
+	/**
+	 * Pipeline state cache file header.
+	 */
+	struct PipelineStateCacheHeader
+	{
+		/// Magic number.
+		static const u32 MAGIC = 0x43535350;
+		/// Major version signifies a breaking change to the binary format.
+		static const i16 MAJOR_VERSION = 0x0001;
+		/// Minor version signifies non-breaking change to binary format.
+		static const i16 MINOR_VERSION = 0x0000;
+
+		u32 magic_ = MAGIC;
+		i16 majorVersion_ = MAJOR_VERSION;
+		i16 minorVersion_ = MINOR_VERSION;
+
+		i32 numRecords_ = 0;
+	};
+
+	/**
+	 * Technique used in a previous run, stored in the cache file.
+	 */
+	struct PipelineStateCacheRecord
+	{
+		/// Pipeline state hash at the time it was recorded.
+		u64 hash_ = 0;
+		char shaderName_[Core::MAX_PATH_LENGTH] = {'\0'};
+		char techniqueName_[MAX_NAME_LENGTH] = {'\0'};
+		ShaderTechniqueDesc desc_;
+	};
+
+	class PipelineStateCacheImpl
+	{
+	public:
+		PipelineStateCacheImpl();
+		~PipelineStateCacheImpl();
+
+		/// Created & destroyed with the shader factory.
+		static void Create();
+		static void Destroy();
+		static PipelineStateCacheImpl* Get();
+
+		/**
+		 * Acquire pipeline state for @a hash, creating it from @a desc if not present.
+		 * If another thread is creating the same pipeline state, this will wait for it.
+		 * Every acquire must be paired with a Release, even if the returned handle is invalid.
+		 * @param isPrewarm Acquired ahead of use, only counts toward prewarm statistics.
+		 */
+		GPU::Handle Acquire(u64 hash, const GPU::GraphicsPipelineStateDesc& desc, bool isPrewarm,
+		    const char* debugFmt, ...);
+		GPU::Handle Acquire(u64 hash, const GPU::ComputePipelineStateDesc& desc, bool isPrewarm,
+		    const char* debugFmt, ...);
+
+		/**
+		 * Release pipeline state for @a hash. Destroyed once no longer referenced.
+		 */
+		void Release(u64 hash);
+
+		/**
+		 * Record technique so it can be prewarmed in later runs.
+		 * @param oldHash Previously recorded hash to replace, or 0.
+		 */
+		void Record(u64 hash, u64 oldHash, const char* shaderName, const char* techniqueName,
+		    const ShaderTechniqueDesc& desc);
+
+		/**
+		 * Get all records for @a shaderName.
+		 */
+		void GetRecords(const char* shaderName, Core::Vector<PipelineStateCacheRecord>& outRecords);
+
+		bool Load(const char* path);
+		bool Save(const char* path);
+
+		PipelineStateCacheStats GetStats();
+		void ResetStats();
+
+	private:
+		struct Entry
+		{
+			GPU::Handle handle_;
+			i32 refCount_ = 0;
+			volatile i32 isReady_ = 0;
+		};
+
+		template<typename CREATE_FN>
+		GPU::Handle AcquireInternal(u64 hash, bool isPrewarm, CREATE_FN createFn);
+
+		Core::Mutex mutex_;
+		Core::Map<u64, Entry*> entries_;
+		Core::Map<u64, PipelineStateCacheRecord> records_;
+		PipelineStateCacheStats stats_;
+	};
+
+} // namespace Graphics
@@ -3,10 +3,13 @@
 #include "graphics/private/render_pass_impl.h"
 
 #include "core/concurrency.h"
+#include "core/hash.h"
 #include "core/linear_allocator.h"
+#include "core/map.h"
 #include "core/misc.h"
 #include "core/set.h"
 #include "core/string.h"
+#include "core/timer.h"
 #include "core/vector.h"
 
 #include "gpu/command_list.h"
@@ -22,14 +25,70 @@
 
 namespace
 {
+	// Descs have padding, so compare & hash them per field rather than as raw memory. Handles are a single u32.
 	bool operator==(const Graphics::RenderGraphBufferDesc& a, const Graphics::RenderGraphBufferDesc& b)
 	{
-		return memcmp(&a, &b, sizeof(a)) == 0;
+		return a.bindFlags_ == b.bindFlags_ && a.size_ == b.size_;
 	}
 
 	bool operator==(const Graphics::RenderGraphTextureDesc& a, const Graphics::RenderGraphTextureDesc& b)
 	{
-		return memcmp(&a, &b, sizeof(a)) == 0;
+		return a.type_ == b.type_ && a.bindFlags_ == b.bindFlags_ && a.format_ == b.format_ &&
+		       a.width_ == b.width_ && a.height_ == b.height_ && a.depth_ == b.depth_ && a.levels_ == b.levels_ &&
+		       a.elements_ == b.elements_;
+	}
+
+	u64 HashDesc(u64 hash, const GPU::BufferDesc& desc)
+	{
+		hash = Core::Hash(hash, (u32)desc.bindFlags_);
+		return Core::Hash(hash, desc.size_);
+	}
+
+	u64 HashDesc(u64 hash, const GPU::TextureDesc& desc)
+	{
+		hash = Core::Hash(hash, (i32)desc.type_);
+		hash = Core::Hash(hash, (u32)desc.bindFlags_);
+		hash = Core::Hash(hash, (i32)desc.format_);
+		hash = Core::Hash(hash, desc.width_);
+		hash = Core::Hash(hash, desc.height_);
+		hash = Core::Hash(hash, desc.depth_);
+		hash = Core::Hash(hash, desc.levels_);
+		return Core::Hash(hash, desc.elements_);
+	}
+
+	u64 HashDesc(u64 hash, const GPU::BindingView& desc)
+	{
+		hash = Core::HashFNV1a(hash, &desc.resource_, sizeof(desc.resource_));
+		hash = Core::Hash(hash, (i32)desc.format_);
+		return Core::Hash(hash, (i32)desc.dimension_);
+	}
+
+	u64 HashDesc(u64 hash, const GPU::FrameBindingSetDesc& desc)
+	{
+		for(const auto& rtv : desc.rtvs_)
+		{
+			hash = HashDesc(hash, (const GPU::BindingView&)rtv);
+			hash = Core::Hash(hash, rtv.mipSlice_);
+			hash = Core::Hash(hash, rtv.firstArraySlice_);
+			hash = Core::Hash(hash, rtv.planeSlice_FirstWSlice_);
+			hash = Core::Hash(hash, rtv.arraySize_);
+			hash = Core::Hash(hash, rtv.wSize_);
+		}
+		hash = HashDesc(hash, (const GPU::BindingView&)desc.dsv_);
+		hash = Core::Hash(hash, (u32)desc.dsv_.flags_);
+		hash = Core::Hash(hash, desc.dsv_.mipSlice_);
+		hash = Core::Hash(hash, desc.dsv_.firstArraySlice_);
+		return Core::Hash(hash, desc.dsv_.arraySize_);
+	}
+
+	u64 HashResources(u64 hash, const Graphics::RenderGraphResource* resources, i32 numResources)
+	{
+		for(i32 idx = 0; idx < numResources; ++idx)
+		{
+			hash = Core::Hash(hash, resources[idx].idx_);
+			hash = Core::Hash(hash, resources[idx].version_);
+		}
+		return hash;
 	}
 }
 
@@ -38,6 +97,16 @@ namespace Graphics
 	// Memory for to be allocated from the render graph at runtime.
 	static constexpr i32 MAX_FRAME_DATA = 1024 * 1024;
 
+	// Queues render passes can be scheduled on.
+	static constexpr i32 NUM_QUEUES = 2;
+	static constexpr GPU::CommandQueueType QUEUE_TYPES[NUM_QUEUES] = {
+	    GPU::CommandQueueType::GRAPHICS, GPU::CommandQueueType::COMPUTE};
+
+	static i32 QueueIdx(GPU::CommandQueueType queueType)
+	{
+		return queueType == GPU::CommandQueueType::COMPUTE ? 1 : 0;
+	}
+
 	struct RenderPassEntry
 	{
 		RenderPass* renderPass_ = nullptr;
@@ -67,6 +136,30 @@ namespace Graphics
 
 		// Built during execute.
 		Core::Vector<RenderPassEntry*> executeRenderPasses_;
+		Core::Vector<RenderGraphPassSchedule> executeSchedule_;
+
+		// Fences for cross-queue synchronization. Indexed by QueueIdx.
+		Core::Array<GPU::Handle, NUM_QUEUES> fences_;
+		Core::Array<i64, NUM_QUEUES> fenceValues_ = {};
+
+		// Fence values covering the last reads & writes of each GPU resource on each queue by previous executes,
+		// keyed by GPU::Handle::GetCombined. Passes on one queue wait on these from the other queue.
+		struct ResourceQueueUse
+		{
+			Core::Array<i64, NUM_QUEUES> readValues_ = {};
+			Core::Array<i64, NUM_QUEUES> writeValues_ = {};
+		};
+		Core::Map<i32, ResourceQueueUse> resourceQueueUses_;
+		// Highest fence value of the other queue each queue has waited on.
+		Core::Array<i64, NUM_QUEUES> waitedValues_ = {};
+
+		// Compiled state reused between executes while the topology hash matches.
+		u64 compiledHash_ = 0;
+		Core::Vector<i32> compiledPassOrder_;
+		Core::Vector<GPU::Handle> compiledResources_;
+		Core::Vector<GPU::Handle> frameBindingSets_;
+
+		RenderGraphStats stats_;
 
 		// Frame data for allocation.
 		Core::LinearAllocator frameAllocator_;
@@ -135,6 +228,121 @@ namespace Graphics
 			}
 		}
 
+		/**
+		 * Does @a before write a resource @a after uses, or use a resource that @a after writes?
+		 */
+		static bool HasHazard(const RenderPassImpl* before, const RenderPassImpl* after)
+		{
+			for(const auto& outputRes : before->GetOutputs())
+			{
+				for(const auto& res : after->GetInputs())
+					if(res.idx_ == outputRes.idx_)
+						return true;
+				for(const auto& res : after->GetOutputs())
+					if(res.idx_ == outputRes.idx_)
+						return true;
+			}
+			for(const auto& inputRes : before->GetInputs())
+			{
+				for(const auto& res : after->GetOutputs())
+					if(res.idx_ == inputRes.idx_)
+						return true;
+			}
+			return false;
+		}
+
+		void ScheduleRenderPasses()
+		{
+			const i32 numPasses = executeRenderPasses_.size();
+			executeSchedule_.clear();
+			executeSchedule_.resize(numPasses);
+
+			for(i32 idx = 0; idx < numPasses; ++idx)
+			{
+				const auto* renderPass = executeRenderPasses_[idx]->renderPass_->impl_;
+				executeSchedule_[idx].queue_ =
+				    renderPass->asyncCompute_ ? GPU::CommandQueueType::COMPUTE : GPU::CommandQueueType::GRAPHICS;
+			}
+
+			// Last pass on the other queue each queue has waited on. Work on a queue completes in order,
+			// so waiting on anything at or before this is redundant.
+			Core::Array<i32, NUM_QUEUES> lastWaitIdx;
+			lastWaitIdx.fill(-1);
+
+			for(i32 idx = 0; idx < numPasses; ++idx)
+			{
+				auto& schedule = executeSchedule_[idx];
+				const auto* renderPass = executeRenderPasses_[idx]->renderPass_->impl_;
+				const i32 queueIdx = QueueIdx(schedule.queue_);
+
+				// Find newest pass on the other queue with a hazard.
+				for(i32 otherIdx = idx - 1; otherIdx > lastWaitIdx[queueIdx]; --otherIdx)
+				{
+					auto& otherSchedule = executeSchedule_[otherIdx];
+					if(otherSchedule.queue_ == schedule.queue_)
+						continue;
+
+					if(HasHazard(executeRenderPasses_[otherIdx]->renderPass_->impl_, renderPass))
+					{
+						schedule.waitPassIdx_ = otherIdx;
+						otherSchedule.signal_ = true;
+						lastWaitIdx[queueIdx] = otherIdx;
+						break;
+					}
+				}
+			}
+		}
+
+		/**
+		 * @return Fence value of the other queue a pass on @a queueIdx must wait on, for resources it uses that
+		 * previous executes used on the other queue with a hazard. 0 if none.
+		 */
+		i64 GetPreviousExecuteWait(const RenderPassImpl* renderPass, i32 queueIdx)
+		{
+			const i32 otherQueueIdx = 1 - queueIdx;
+			i64 waitValue = 0;
+			auto AddResource = [&](const RenderGraphResource& res, bool write) {
+				const GPU::Handle handle = resourceDescs_[res.idx_].handle_;
+				if(!handle)
+					return;
+				if(const auto* use = resourceQueueUses_.find(handle.GetCombined()))
+				{
+					waitValue = Core::Max(waitValue, use->writeValues_[otherQueueIdx]);
+					if(write)
+						waitValue = Core::Max(waitValue, use->readValues_[otherQueueIdx]);
+				}
+			};
+
+			// Writes are also inputs, so test them first.
+			for(const auto& res : renderPass->GetOutputs())
+				AddResource(res, true);
+			for(const auto& res : renderPass->GetInputs())
+				AddResource(res, false);
+			return waitValue;
+		}
+
+		/**
+		 * Store resource uses of the executed passes, covered by each queue's last fence value.
+		 */
+		void StoreResourceQueueUses()
+		{
+			for(i32 idx = 0; idx < executeRenderPasses_.size(); ++idx)
+			{
+				const i32 queueIdx = QueueIdx(executeSchedule_[idx].queue_);
+				const i64 value = fenceValues_[queueIdx];
+				if(value == 0)
+					continue;
+
+				const auto* renderPass = executeRenderPasses_[idx]->renderPass_->impl_;
+				for(const auto& res : renderPass->GetInputs())
+					if(const GPU::Handle handle = resourceDescs_[res.idx_].handle_)
+						resourceQueueUses_[handle.GetCombined()].readValues_[queueIdx] = value;
+				for(const auto& res : renderPass->GetOutputs())
+					if(const GPU::Handle handle = resourceDescs_[res.idx_].handle_)
+						resourceQueueUses_[handle.GetCombined()].writeValues_[queueIdx] = value;
+			}
+		}
+
 		void CreateResources()
 		{
 			for(i32 idx : resourcesNeeded_)
@@ -173,6 +381,7 @@ namespace Graphics
 							resDesc.handle_ =
 							    GPU::Manager::CreateTexture(resDesc.textureDesc_, nullptr, resDesc.name_.data());
 						}
+						stats_.numSetupResourcesCreated_++;
 
 						resDesc.inUse_ = 1;
 						transientResources_.push_back(resDesc);
@@ -200,11 +409,11 @@ namespace Graphics
 			}
 		}
 
-		void CreateFrameBindingSets()
+		void SetupFrameBindingDescs()
 		{
-			for(auto& entry : renderPassEntries_)
+			for(auto* entry : executeRenderPasses_)
 			{
-				auto* renderPass = entry.renderPass_->impl_;
+				auto* renderPass = entry->renderPass_->impl_;
 				if(renderPass->dsv_ || renderPass->rtvs_[0])
 				{
 					auto dsvRes = renderPass->dsv_;
@@ -216,12 +425,100 @@ namespace Graphics
 						if(rtvRes)
 							renderPass->fbsDesc_.rtvs_[idx].resource_ = GetTexture(rtvRes, nullptr);
 					}
+				}
+			}
+		}
 
-					renderPass->fbs_ = GPU::Manager::CreateFrameBindingSet(renderPass->fbsDesc_, entry.name_.data());
+		void CreateFrameBindingSets()
+		{
+			DestroyFrameBindingSets();
+			frameBindingSets_.resize(renderPassEntries_.size());
+
+			SetupFrameBindingDescs();
+			for(auto* entry : executeRenderPasses_)
+			{
+				auto* renderPass = entry->renderPass_->impl_;
+				if(renderPass->dsv_ || renderPass->rtvs_[0])
+				{
+					renderPass->fbs_ = GPU::Manager::CreateFrameBindingSet(renderPass->fbsDesc_, entry->name_.data());
+					frameBindingSets_[entry->idx_] = renderPass->fbs_;
+					stats_.numSetupResourcesCreated_++;
 				}
 			}
 		}
 
+		void DestroyFrameBindingSets()
+		{
+			for(auto fbs : frameBindingSets_)
+				if(fbs)
+					GPU::Manager::DestroyResource(fbs);
+			frameBindingSets_.clear();
+		}
+
+		/**
+		 * Hash everything declared during setup that affects the compiled graph.
+		 */
+		u64 HashTopology(RenderGraphResource finalRes) const
+		{
+			u64 hash = 0;
+			hash = Core::Hash(hash, finalRes.idx_);
+			hash = Core::Hash(hash, finalRes.version_);
+			hash = Core::Hash(hash, renderPassEntries_.size());
+			for(const auto& entry : renderPassEntries_)
+			{
+				const auto* renderPass = entry.renderPass_->impl_;
+				hash = Core::Hash(hash, entry.name_.data());
+				hash = HashResources(hash, renderPass->inputs_.data(), renderPass->numInputs_);
+				hash = HashResources(hash, renderPass->outputs_.data(), renderPass->numOutputs_);
+				hash = HashResources(hash, renderPass->rtvs_.data(), renderPass->rtvs_.size());
+				hash = HashResources(hash, &renderPass->dsv_, 1);
+				hash = HashDesc(hash, renderPass->fbsDesc_);
+				hash = Core::Hash(hash, (u8)renderPass->asyncCompute_);
+			}
+
+			hash = Core::Hash(hash, resourceDescs_.size());
+			for(const auto& resDesc : resourceDescs_)
+			{
+				hash = Core::Hash(hash, (i32)resDesc.resType_);
+				hash = Core::HashFNV1a(hash, &resDesc.handle_, sizeof(resDesc.handle_));
+				if(resDesc.resType_ == GPU::ResourceType::BUFFER)
+					hash = HashDesc(hash, resDesc.bufferDesc_);
+				else
+					hash = HashDesc(hash, resDesc.textureDesc_);
+			}
+			return hash;
+		}
+
+		void StoreCompiled(u64 hash)
+		{
+			compiledHash_ = hash;
+
+			compiledPassOrder_.clear();
+			compiledPassOrder_.reserve(executeRenderPasses_.size());
+			for(const auto* entry : executeRenderPasses_)
+				compiledPassOrder_.push_back(entry->idx_);
+
+			compiledResources_.resize(resourceDescs_.size());
+			for(i32 idx = 0; idx < resourceDescs_.size(); ++idx)
+				compiledResources_[idx] = resourceDescs_[idx].handle_;
+		}
+
+		void RestoreCompiled()
+		{
+			executeRenderPasses_.clear();
+			executeRenderPasses_.reserve(compiledPassOrder_.size());
+			for(i32 idx : compiledPassOrder_)
+				executeRenderPasses_.push_back(&renderPassEntries_[idx]);
+
+			DBG_ASSERT(compiledResources_.size() == resourceDescs_.size());
+			for(i32 idx = 0; idx < resourceDescs_.size(); ++idx)
+				resourceDescs_[idx].handle_ = compiledResources_[idx];
+
+			SetupFrameBindingDescs();
+			for(auto* entry : executeRenderPasses_)
+				entry->renderPass_->impl_->fbs_ = frameBindingSets_[entry->idx_];
+		}
+
 		GPU::Handle GetHandle(RenderGraphResource res) const
 		{
 			const auto& resDesc = resourceDescs_[res.idx_];
@@ -452,6 +749,8 @@ namespace Graphics
 		return false;
 	}
 
+	void RenderGraphBuilder::SetAsyncCompute(bool enable) { renderPass_->impl_->asyncCompute_ = enable; }
+
 	void* RenderGraphBuilder::Alloc(i32 size) { return impl_->frameAllocator_.Allocate(size); }
 
 	RenderGraphResources::RenderGraphResources(RenderGraphImpl* impl, RenderPassImpl* renderPass)
@@ -571,6 +870,12 @@ namespace Graphics
 
 		for(auto cmdHandle : impl_->cmdHandles_)
 			GPU::Manager::DestroyResource(cmdHandle);
+
+		for(auto fence : impl_->fences_)
+			if(fence)
+				GPU::Manager::DestroyResource(fence);
+
+		impl_->DestroyFrameBindingSets();
 		delete impl_;
 	}
 
@@ -636,40 +941,68 @@ namespace Graphics
 			DBG_LOG("ERROR: Unable to find finalRes in graph.");
 		}
 
-		// Add finalRes to outputs to start traversal.
-		const i32 MAX_OUTPUTS = Core::Max(GPU::MAX_UAV_BINDINGS, GPU::MAX_BOUND_RTVS);
-		Core::Vector<RenderGraphResource> outputs;
-		outputs.reserve(MAX_OUTPUTS);
-
-		outputs.push_back(finalRes);
+		Core::Timer setupTimer;
+		setupTimer.Mark();
+		impl_->stats_.numSetupResourcesCreated_ = 0;
 
-		// From finalRes, work backwards and push all render passes that are required onto the stack.
-		auto& renderPasses = impl_->renderPassEntries_;
+		// Reuse previous compile if nothing has changed.
+		const u64 topologyHash = impl_->HashTopology(finalRes);
+		const bool setupCached = impl_->compiledHash_ != 0 && impl_->compiledHash_ == topologyHash;
+		if(setupCached)
+		{
+			rmt_ScopedCPUSample(RenderGraph_RestoreCompiled, RMTSF_None);
+			impl_->RestoreCompiled();
+		}
+		else
 		{
-			rmt_ScopedCPUSample(RenderGraph_AddDependencies, RMTSF_None);
-			impl_->executeRenderPasses_.clear();
-			impl_->executeRenderPasses_.reserve(renderPasses.size());
+			// Add finalRes to outputs to start traversal.
+			const i32 MAX_OUTPUTS = Core::Max(GPU::MAX_UAV_BINDINGS, GPU::MAX_BOUND_RTVS);
+			Core::Vector<RenderGraphResource> outputs;
+			outputs.reserve(MAX_OUTPUTS);
 
-			impl_->AddDependencies(impl_->executeRenderPasses_, outputs);
+			outputs.push_back(finalRes);
 
-			std::reverse(impl_->executeRenderPasses_.begin(), impl_->executeRenderPasses_.end());
-		}
+			// From finalRes, work backwards and push all render passes that are required onto the stack.
+			auto& renderPasses = impl_->renderPassEntries_;
+			{
+				rmt_ScopedCPUSample(RenderGraph_AddDependencies, RMTSF_None);
+				impl_->executeRenderPasses_.clear();
+				impl_->executeRenderPasses_.reserve(renderPasses.size());
 
-		{
-			rmt_ScopedCPUSample(RenderGraph_FilterPasses, RMTSF_None);
-			impl_->FilterRenderPasses(impl_->executeRenderPasses_);
-		}
+				impl_->AddDependencies(impl_->executeRenderPasses_, outputs);
 
-		{
-			rmt_ScopedCPUSample(RenderGraph_CreateResources, RMTSF_None);
-			impl_->CreateResources();
-		}
+				std::reverse(impl_->executeRenderPasses_.begin(), impl_->executeRenderPasses_.end());
+			}
 
-		{
-			rmt_ScopedCPUSample(RenderGraph_CreateFrameBindingSets, RMTSF_None);
-			impl_->CreateFrameBindingSets();
+			{
+				rmt_ScopedCPUSample(RenderGraph_FilterPasses, RMTSF_None);
+				impl_->FilterRenderPasses(impl_->executeRenderPasses_);
+			}
+
+			{
+				rmt_ScopedCPUSample(RenderGraph_ScheduleRenderPasses, RMTSF_None);
+				impl_->ScheduleRenderPasses();
+			}
+
+			{
+				rmt_ScopedCPUSample(RenderGraph_CreateResources, RMTSF_None);
+				impl_->CreateResources();
+			}
+
+			{
+				rmt_ScopedCPUSample(RenderGraph_CreateFrameBindingSets, RMTSF_None);
+				impl_->CreateFrameBindingSets();
+			}
+
+			impl_->StoreCompiled(topologyHash);
 		}
 
+		impl_->stats_.setupTime_ = setupTimer.GetTime();
+		impl_->stats_.setupCached_ = setupCached;
+		if(setupCached)
+			impl_->stats_.numCachedCompiles_++;
+		else
+			impl_->stats_.numCompiles_++;
 
 		// Create more command lists as required.
 		const i32 numPasses = impl_->executeRenderPasses_.size();
@@ -743,9 +1076,18 @@ namespace Graphics
 				if(auto event = cmdList.Event(0x00000000, entry->name_.data()))
 					entry->renderPass_->Execute(resources, cmdList);
 
+				if(entry->renderPass_->impl_->asyncCompute_ &&
+				    Core::ContainsAnyFlags(cmdList.GetType(), GPU::CommandQueueType::GRAPHICS))
+				{
+					Core::AtomicInc(&impl->compilationFailures_);
+					DBG_ASSERT_MSG(false, "Async compute render pass \"%s\" recorded graphics commands.",
+					    entry->name_.data());
+					return;
+				}
+
 				if(cmdList.GetType() != GPU::CommandQueueType::NONE)
 				{
-					if(!GPU::Manager::CompileCommandList(cmdHandle, cmdList))
+					if(!GPU::Manager::CompileCommandList(cmdHandle, cmdList, impl->executeSchedule_[idx].queue_))
 					{
 						Core::AtomicInc(&impl->compilationFailures_);
 						DBG_ASSERT_MSG(
@@ -771,38 +1113,123 @@ namespace Graphics
 		static bool individualSubmission = false;
 
 		//Core::Log("Execute done\n");
-		// Submit all command lists with commands in sequential order.
+		// Submit all command lists with commands in sequential order, batching per queue until a
+		// fence signal or wait requires the pending batch to be flushed.
 		rmt_ScopedCPUSample(RenderGraph_SubmitCommandLists, RMTSF_None);
-		if(individualSubmission)
-		{
-			for(i32 idx = 0; idx < numPasses; ++idx)
+		Core::Array<Core::Vector<GPU::Handle>, NUM_QUEUES> pendingCmdHandles;
+		Core::Array<bool, NUM_QUEUES> pendingSignal = {};
+		Core::Vector<i64> signalValues;
+		signalValues.resize(numPasses, 0);
+
+		auto FlushQueue = [&](i32 queueIdx) {
+			auto& cmdHandles = pendingCmdHandles[queueIdx];
+			if(cmdHandles.size() > 0)
 			{
-				auto& entry = impl_->executeRenderPasses_[idx];
-				auto cmdHandle = impl_->cmdHandles_[idx];
-				if(!GPU::Manager::SubmitCommandLists(cmdHandle))
+				if(!GPU::Manager::SubmitCommandLists(cmdHandles, QUEUE_TYPES[queueIdx]))
 				{
-					DBG_ASSERT_MSG(false, "Failed to submit command list for render pass \"%s\".", entry->name_.data());
+					DBG_ASSERT_MSG(false, "Failed to submit command lists.");
 					return false;
 				}
+				cmdHandles.clear();
+				pendingSignal[queueIdx] = true;
 			}
-		}
-		else
+			return true;
+		};
+
+		auto SignalQueue = [&](i32 queueIdx) {
+			auto& fence = impl_->fences_[queueIdx];
+			if(!fence)
+				fence = GPU::Manager::CreateFence(queueIdx == 0 ? "RenderGraph Graphics" : "RenderGraph Compute");
+			pendingSignal[queueIdx] = false;
+			return GPU::Manager::SignalFence(QUEUE_TYPES[queueIdx], fence, ++impl_->fenceValues_[queueIdx]);
+		};
+
+		auto WaitQueue = [&](i32 queueIdx, i64 value) {
+			const i32 otherQueueIdx = 1 - queueIdx;
+			if(value <= impl_->waitedValues_[queueIdx])
+				return true;
+			DBG_ASSERT(impl_->fences_[otherQueueIdx]);
+			impl_->waitedValues_[queueIdx] = value;
+			return FlushQueue(queueIdx) &&
+			       GPU::Manager::WaitOnFence(QUEUE_TYPES[queueIdx], impl_->fences_[otherQueueIdx], value);
+		};
+
+		for(i32 idx = 0; idx < numPasses; ++idx)
 		{
-			Core::Vector<GPU::Handle> cmdLists;
-			jobDescs.resize(numPasses);
-			for(i32 idx = 0; idx < numPasses; ++idx)
+			const auto& schedule = impl_->executeSchedule_[idx];
+			const i32 queueIdx = QueueIdx(schedule.queue_);
+
+			// Resources used on the other queue by previous executes, e.g. compute overwriting what last frame's
+			// graphics passes are still reading. Not part of the cached schedule, as it depends on handles.
+			const i64 previousWaitValue =
+			    impl_->GetPreviousExecuteWait(impl_->executeRenderPasses_[idx]->renderPass_->impl_, queueIdx);
+			if(previousWaitValue > 0 && !WaitQueue(queueIdx, previousWaitValue))
+				return false;
+
+			if(schedule.waitPassIdx_ >= 0)
 			{
-				const auto& cmdList = impl_->cmdLists_[idx];
-				auto cmdHandle = impl_->cmdHandles_[idx];
-				if(cmdList.NumCommands() > 0)
-					cmdLists.push_back(cmdHandle);
+				DBG_ASSERT(signalValues[schedule.waitPassIdx_] > 0);
+				if(!WaitQueue(queueIdx, signalValues[schedule.waitPassIdx_]))
+					return false;
 			}
-			if(!GPU::Manager::SubmitCommandLists(cmdLists))
+
+			// Only command lists that were compiled, ones with more than debug events.
+			if(impl_->cmdLists_[idx].GetType() != GPU::CommandQueueType::NONE)
 			{
-				DBG_ASSERT_MSG(false, "Failed to submit command lists.");
+				if(individualSubmission)
+				{
+					if(!FlushQueue(queueIdx))
+						return false;
+
+					auto& entry = impl_->executeRenderPasses_[idx];
+					if(!GPU::Manager::SubmitCommandLists(
+					       Core::ArrayView<GPU::Handle>(&impl_->cmdHandles_[idx], 1), schedule.queue_))
+					{
+						DBG_ASSERT_MSG(
+						    false, "Failed to submit command list for render pass \"%s\".", entry->name_.data());
+						return false;
+					}
+					pendingSignal[queueIdx] = true;
+				}
+				else
+				{
+					pendingCmdHandles[queueIdx].push_back(impl_->cmdHandles_[idx]);
+				}
+			}
+
+			if(schedule.signal_)
+			{
+				if(!FlushQueue(queueIdx) || !SignalQueue(queueIdx))
+					return false;
+				signalValues[idx] = impl_->fenceValues_[queueIdx];
+			}
+		}
+
+		// Submit remaining work, signalling each queue that has any so the next execute can wait on the resources
+		// it used. Graphics only waits on compute here if the final resource was produced on compute, as that is
+		// consumed outside of the graph (present, etc).
+		const i32 graphicsIdx = QueueIdx(GPU::CommandQueueType::GRAPHICS);
+		const i32 computeIdx = QueueIdx(GPU::CommandQueueType::COMPUTE);
+		for(i32 queueIdx = 0; queueIdx < NUM_QUEUES; ++queueIdx)
+		{
+			if(!FlushQueue(queueIdx))
 				return false;
+			if(pendingSignal[queueIdx] && !SignalQueue(queueIdx))
+				return false;
+		}
+
+		for(i32 idx = 0; idx < numPasses; ++idx)
+		{
+			if(impl_->executeSchedule_[idx].queue_ != GPU::CommandQueueType::COMPUTE)
+				continue;
+			for(const auto& outputRes : impl_->executeRenderPasses_[idx]->renderPass_->impl_->GetOutputs())
+			{
+				if(outputRes.idx_ == finalRes.idx_ && !WaitQueue(graphicsIdx, impl_->fenceValues_[computeIdx]))
+					return false;
 			}
 		}
+
+		impl_->StoreResourceQueueUses();
 		return true;
 	}
 
@@ -821,6 +1248,15 @@ namespace Graphics
 		}
 	}
 
+	void RenderGraph::GetExecutedSchedule(RenderGraphPassSchedule* schedule) const
+	{
+		DBG_ASSERT(schedule);
+		for(i32 idx = 0; idx < impl_->executeSchedule_.size(); ++idx)
+			schedule[idx] = impl_->executeSchedule_[idx];
+	}
+
+	const RenderGraphStats& RenderGraph::GetStats() const { return impl_->stats_; }
+
 	void RenderGraph::GetResourceName(RenderGraphResource res, const char** name) const
 	{
 		if(name)
@@ -22,13 +22,11 @@ namespace Graphics
 		GPU::FrameBindingSetDesc fbsDesc_;
 		Core::Array<RenderGraphResource, GPU::MAX_BOUND_RTVS> rtvs_;
 		RenderGraphResource dsv_;
+		// Owned by RenderGraph, may outlive the pass.
 		GPU::Handle fbs_;
 
-		~RenderPassImpl()
-		{
-			if(fbs_)
-				GPU::Manager::DestroyResource(fbs_);
-		}
+		// Submit to async compute queue.
+		bool asyncCompute_ = false;
 
 		void AddInput(RenderGraphResource res)
 		{
@@ -1,15 +1,19 @@
 #include "graphics/shader.h"
+#include "graphics/private/pipeline_state_cache_impl.h"
 #include "graphics/private/shader_impl.h"
 
 #include "resource/factory.h"
 #include "resource/manager.h"
 
+#include "core/concurrency.h"
 #include "core/debug.h"
 #include "core/file.h"
 #include "core/hash.h"
 #include "core/misc.h"
 #include "gpu/enum.h"
 #include "gpu/manager.h"
+#include "job/function_job.h"
+#include "job/manager.h"
 #include "serialization/serializer.h"
 
 #include <algorithm>
@@ -42,6 +46,7 @@ namespace Graphics
 	bool ShaderBindingSetHeader::Serialize(Serialization::Serializer& serializer)
 	{
 		SERIALIZE_STRING_MEMBER(name_);
+		SERIALIZE_MEMBER(nameHash_);
 		SERIALIZE_MEMBER(isShared_);
 		SERIALIZE_MEMBER(frequency_);
 		SERIALIZE_MEMBER(numCBVs_);
@@ -54,6 +59,7 @@ namespace Graphics
 	bool ShaderBindingHeader::Serialize(Serialization::Serializer& serializer)
 	{
 		SERIALIZE_STRING_MEMBER(name_);
+		SERIALIZE_MEMBER(nameHash_);
 		serializer.Serialize("handle_", (u32&)handle_);
 		return true;
 	}
@@ -69,6 +75,7 @@ namespace Graphics
 	bool ShaderTechniqueHeader::Serialize(Serialization::Serializer& serializer)
 	{
 		SERIALIZE_STRING_MEMBER(name_);
+		SERIALIZE_MEMBER(nameHash_);
 		SERIALIZE_MEMBER(vs_);
 		SERIALIZE_MEMBER(gs_);
 		SERIALIZE_MEMBER(hs_);
@@ -86,9 +93,38 @@ namespace Graphics
 		return true;
 	}
 
+	namespace
+	{
+		/// Get section of @a num elements at @a inOutOffset in @a data and advance past it.
+		/// @return Section, or nullptr if it doesn't fit within @a dataSize.
+		template<typename TYPE>
+		const TYPE* GetSection(const u8* data, i64 dataSize, i64& inOutOffset, i32 num)
+		{
+			const i64 numBytes = (i64)num * sizeof(TYPE);
+			if(num < 0 || inOutOffset + numBytes > dataSize)
+				return nullptr;
+			const TYPE* section = reinterpret_cast<const TYPE*>(data + inOutOffset);
+			inOutOffset += numBytes;
+			return section;
+		}
+
+		/// Get view of @a num elements at @a inOutData and advance past them.
+		template<typename TYPE>
+		Core::ArrayView<TYPE> TakeView(u8*& inOutData, i32 num)
+		{
+			TYPE* begin = reinterpret_cast<TYPE*>(inOutData);
+			inOutData += num * sizeof(TYPE);
+			return Core::ArrayView<TYPE>(begin, num);
+		}
+	}
+
 	class ShaderFactory : public Resource::IFactory
 	{
 	public:
+		ShaderFactory() { PipelineStateCacheImpl::Create(); }
+
+		~ShaderFactory() { PipelineStateCacheImpl::Destroy(); }
+
 		bool CreateResource(Resource::IFactoryContext& context, void** outResource, const Core::UUID& type) override
 		{
 			DBG_ASSERT(type == Shader::GetTypeUUID());
@@ -118,12 +154,13 @@ namespace Graphics
 			Graphics::ShaderHeader header;
 			i32 readBytes = 0;
 
-			auto OnFailure = [impl](const char* error) {
+			auto OnFailure = [&impl](const char* error) {
 				DBG_LOG("ShaderFactory: Failed to load. Error: %s\n", error);
 				delete impl;
 			};
 
 			// Read in desc.
+			const i64 baseOffset = inFile.Tell();
 			readBytes = sizeof(header);
 			if(inFile.Read(&header, readBytes) != readBytes)
 			{
@@ -145,86 +182,119 @@ namespace Graphics
 			if(header.minorVersion_ != Graphics::ShaderHeader::MINOR_VERSION)
 				DBG_LOG("Minor version differs from expected. Can still load successfully.");
 
-			// Creating shader impl.
-			impl = new ShaderImpl();
-			impl->name_ = name;
-			impl->header_ = header;
+			// Map the whole shader. Headers are copied out in a single allocation, and bytecode is used in place.
+			const i64 dataSize = inFile.Size() - baseOffset;
+			auto mapped = Core::MappedFile(inFile, baseOffset, dataSize);
+			if(!mapped)
+			{
+				OnFailure("Unable to map shader.");
+				return false;
+			}
+			const u8* data = static_cast<const u8*>(mapped.GetAddress());
 
-			impl->bindingSetHeaders_.resize(header.numBindingSets_);
-			readBytes = impl->bindingSetHeaders_.size() * sizeof(ShaderBindingSetHeader);
-			if(inFile.Read(impl->bindingSetHeaders_.data(), readBytes) != readBytes)
+			i64 dataOffset = sizeof(header);
+			const auto* bindingSetHeaders =
+			    GetSection<ShaderBindingSetHeader>(data, dataSize, dataOffset, header.numBindingSets_);
+			if(bindingSetHeaders == nullptr)
 			{
 				OnFailure("Unable to read binding set headers.");
 				return false;
 			}
 
 			i32 numBindings = 0;
-			for(const auto& bindingSet : impl->bindingSetHeaders_)
+			for(i32 idx = 0; idx < header.numBindingSets_; ++idx)
 			{
+				const auto& bindingSet = bindingSetHeaders[idx];
 				numBindings += bindingSet.numCBVs_;
 				numBindings += bindingSet.numSRVs_;
 				numBindings += bindingSet.numUAVs_;
 				numBindings += bindingSet.numSamplers_;
 			}
 
-			impl->bindingHeaders_.resize(numBindings);
-			readBytes = impl->bindingHeaders_.size() * sizeof(ShaderBindingHeader);
-			if(inFile.Read(impl->bindingHeaders_.data(), readBytes) != readBytes)
+			if(GetSection<ShaderBindingHeader>(data, dataSize, dataOffset, numBindings) == nullptr)
 			{
 				OnFailure("Unable to read binding headers.");
 				return false;
 			}
 
-			impl->bytecodeHeaders_.resize(header.numShaders_);
-			readBytes = impl->bytecodeHeaders_.size() * sizeof(ShaderBytecodeHeader);
-			if(inFile.Read(impl->bytecodeHeaders_.data(), readBytes) != readBytes)
+			const auto* bytecodeHeaders =
+			    GetSection<ShaderBytecodeHeader>(data, dataSize, dataOffset, header.numShaders_);
+			if(bytecodeHeaders == nullptr)
 			{
 				OnFailure("Unable to read bytecode headers.");
 				return false;
 			}
 
-			i32 bytecodeSize = 0;
-			for(const auto& bytecodeHeader : impl->bytecodeHeaders_)
-			{
-				bytecodeSize = Core::Max(bytecodeSize, bytecodeHeader.offset_ + bytecodeHeader.numBytes_);
-			}
-
-			impl->techniqueHeaders_.resize(header.numTechniques_);
-			readBytes = impl->techniqueHeaders_.size() * sizeof(ShaderTechniqueHeader);
-			if(inFile.Read(impl->techniqueHeaders_.data(), readBytes) != readBytes)
+			if(GetSection<ShaderTechniqueHeader>(data, dataSize, dataOffset, header.numTechniques_) == nullptr)
 			{
 				OnFailure("Unable to read technique headers.");
 				return false;
 			}
 
-			impl->samplerStateHeaders_.resize(header.numSamplerStates_);
-			readBytes = impl->samplerStateHeaders_.size() * sizeof(ShaderSamplerStateHeader);
-			if(inFile.Read(impl->samplerStateHeaders_.data(), readBytes) != readBytes)
+			if(GetSection<ShaderSamplerStateHeader>(data, dataSize, dataOffset, header.numSamplerStates_) == nullptr)
 			{
 				OnFailure("Unable to read sampler state headers.");
 				return false;
 			}
 
-			impl->bytecode_.resize(bytecodeSize);
-			readBytes = impl->bytecode_.size();
-			if(inFile.Read(impl->bytecode_.data(), readBytes) != readBytes)
+			const i64 headerDataSize = dataOffset - sizeof(header);
+			const i64 bytecodeOffset = Core::PotRoundUp(dataOffset, ShaderHeader::BYTECODE_ALIGNMENT);
+			i64 bytecodeSize = 0;
+			for(i32 idx = 0; idx < header.numShaders_; ++idx)
+			{
+				const auto& bytecodeHeader = bytecodeHeaders[idx];
+				bytecodeSize = Core::Max(bytecodeSize, (i64)bytecodeHeader.offset_ + bytecodeHeader.numBytes_);
+			}
+
+			if(bytecodeOffset + bytecodeSize > dataSize)
 			{
 				OnFailure("Unable to read bytecode.");
 				return false;
 			}
+			const u8* bytecode = data + bytecodeOffset;
+
+			// Creating shader impl.
+			impl = new ShaderImpl();
+			impl->name_ = name;
+			impl->header_ = header;
+
+			impl->headerData_.resize((i32)headerDataSize);
+			memcpy(impl->headerData_.data(), data + sizeof(header), headerDataSize);
+
+			u8* headerData = impl->headerData_.data();
+			impl->bindingSetHeaders_ = TakeView<ShaderBindingSetHeader>(headerData, header.numBindingSets_);
+			impl->bindingHeaders_ = TakeView<ShaderBindingHeader>(headerData, numBindings);
+			impl->bytecodeHeaders_ = TakeView<ShaderBytecodeHeader>(headerData, header.numShaders_);
+			impl->techniqueHeaders_ = TakeView<ShaderTechniqueHeader>(headerData, header.numTechniques_);
+			impl->samplerStateHeaders_ = TakeView<ShaderSamplerStateHeader>(headerData, header.numSamplerStates_);
+
+			// Build name lookups from hashes precomputed by the converter.
+			for(i32 idx = 0; idx < impl->bindingHeaders_.size(); ++idx)
+			{
+				const u32 nameHash = impl->bindingHeaders_[idx].nameHash_;
+				if(impl->bindingIndices_.find(nameHash) == nullptr)
+					impl->bindingIndices_.insert(nameHash, idx);
+			}
+
+			for(i32 idx = 0; idx < impl->bindingSetHeaders_.size(); ++idx)
+				impl->bindingSetIndices_.insert(impl->bindingSetHeaders_[idx].nameHash_, idx);
+
+			for(i32 idx = 0; idx < impl->techniqueHeaders_.size(); ++idx)
+				impl->techniqueIndices_.insert(impl->techniqueHeaders_[idx].nameHash_, idx);
 
 			// Create all the shaders & sampler states.
 			GPU::Handle handle;
 			if(GPU::Manager::IsInitialized())
 			{
-				impl->shaders_.reserve(impl->shaders_.size());
+				impl->shaders_.reserve(impl->bytecodeHeaders_.size());
+				impl->shaderHashes_.reserve(impl->bytecodeHeaders_.size());
 				i32 shaderIdx = 0;
-				for(const auto& bytecode : impl->bytecodeHeaders_)
+				for(const auto& bytecodeHeader : impl->bytecodeHeaders_)
 				{
 					GPU::ShaderDesc desc;
-					desc.data_ = &impl->bytecode_[bytecode.offset_];
-					desc.dataSize_ = bytecode.numBytes_;
-					desc.type_ = bytecode.type_;
+					desc.data_ = bytecode + bytecodeHeader.offset_;
+					desc.dataSize_ = bytecodeHeader.numBytes_;
+					desc.type_ = bytecodeHeader.type_;
 					handle = GPU::Manager::CreateShader(desc, "%s/shader_%d", name, shaderIdx++);
 					if(!handle)
 					{
@@ -233,12 +303,13 @@ namespace Graphics
 					}
 
 					impl->shaders_.push_back(handle);
+					impl->shaderHashes_.push_back(Core::HashFNV1a(0, desc.data_, desc.dataSize_));
 				}
 
 				impl->samplerStates_.reserve(impl->samplerStateHeaders_.size());
 
-				// Bytecode no longer needed once created.
-				impl->bytecode_.clear();
+				// Create pipeline states used in previous runs ahead of their techniques.
+				impl->PrewarmPipelineStates();
 			}
 
 			// Add binding sets to the factory.
@@ -250,20 +321,21 @@ namespace Graphics
 					const i32 numHandles = bindingSetHeader.numCBVs_ + bindingSetHeader.numSRVs_ +
 					                       bindingSetHeader.numUAVs_ + bindingSetHeader.numSamplers_;
 
-					auto it = std::find_if(bindingSetHeaders_.begin(), bindingSetHeaders_.end(),
-					    [&bindingSetHeader](const ShaderBindingSetHeader& other) {
-						    return memcmp(&bindingSetHeader, &other, sizeof(ShaderBindingSetHeader)) == 0;
-						});
-
-					if(it == bindingSetHeaders_.end())
+					if(FindBindingSetIdx(bindingSetHeader) == -1)
 					{
+						const i32 idx = bindingSetHeaders_.size();
 						bindingSetHeaders_.push_back(bindingSetHeader);
+						bindingSetHeaderIndices_.insert(HashBindingSetHeader(bindingSetHeader), idx);
+						if(bindingSetIndices_.find(bindingSetHeader.nameHash_) == nullptr)
+							bindingSetIndices_.insert(bindingSetHeader.nameHash_, idx);
 
 						const auto* handleBegin = impl->bindingHeaders_.data() + handleOffset;
 						const auto* handleEnd = handleBegin + numHandles;
 
 						BindingSetHandles handles;
 						handles.headers_.insert(handleBegin, handleEnd);
+						for(i32 handleIdx = 0; handleIdx < numHandles; ++handleIdx)
+							handles.indices_.insert(handles.headers_[handleIdx].nameHash_, handleIdx);
 						bindingSetHandles_.emplace_back(std::move(handles));
 					}
 
@@ -295,8 +367,10 @@ namespace Graphics
 
 				// Setup technique descs, hashes, and empty pipeline states.
 				std::swap(impl->techniqueDescHashes_, shader->impl_->techniqueDescHashes_);
+				std::swap(impl->techniqueDescIndices_, shader->impl_->techniqueDescIndices_);
 				std::swap(impl->techniqueDescs_, shader->impl_->techniqueDescs_);
 				impl->pipelineStates_.resize(impl->techniqueDescs_.size());
+				impl->pipelineStateHashes_.resize(impl->techniqueDescs_.size());
 
 				// Swap techniques over.
 				std::swap(impl->techniques_, shader->impl_->techniques_);
@@ -323,38 +397,46 @@ namespace Graphics
 
 		bool SerializeSettings(Serialization::Serializer& ser) override { return true; }
 
+		static u64 HashBindingSetHeader(const ShaderBindingSetHeader& header)
+		{
+			return Core::HashFNV1a(0, &header, sizeof(ShaderBindingSetHeader));
+		}
+
 		i32 FindBindingSetIdx(const char* name)
 		{
-			for(i32 idx = 0; idx < bindingSetHeaders_.size(); ++idx)
-			{
-				const auto& bindingSetHeader = bindingSetHeaders_[idx];
-				if(strcmp(name, bindingSetHeader.name_) == 0)
-				{
-					return idx;
-				}
-			}
-			return -1;
+			return FindHeaderIndex(bindingSetIndices_, bindingSetHeaders_, name, HashShaderName(name));
 		}
 
 		i32 FindBindingSetIdx(const ShaderBindingSetHeader& header)
 		{
-			for(i32 idx = 0; idx < bindingSetHeaders_.size(); ++idx)
-			{
-				const auto& bindingSetHeader = bindingSetHeaders_[idx];
-				if(memcmp(&header, &bindingSetHeader, sizeof(ShaderBindingSetHeader)) == 0)
-				{
-					return idx;
-				}
-			}
+			const u64 hash = HashBindingSetHeader(header);
+			const i32* idx = bindingSetHeaderIndices_.find(hash);
+			if(idx == nullptr)
+				return -1;
+			if(memcmp(&header, &bindingSetHeaders_[*idx], sizeof(ShaderBindingSetHeader)) == 0)
+				return *idx;
+
+			// Hash matched a different header, scan for it.
+			for(i32 scanIdx = 0; scanIdx < bindingSetHeaders_.size(); ++scanIdx)
+				if(memcmp(&header, &bindingSetHeaders_[scanIdx], sizeof(ShaderBindingSetHeader)) == 0)
+					return scanIdx;
 			return -1;
 		}
 
 		Core::RWLock rwLock_;
 		Core::Vector<ShaderBindingSetHeader> bindingSetHeaders_;
 
+		// Binding set indices by name hash, and by hash of the whole header.
+		// Names are only unique within a shader, so shaders resolve names through their own headers. Shared binding
+		// sets have no shader to resolve through, so they use the first registered binding set with that name.
+		Core::Map<u32, i32> bindingSetIndices_;
+		Core::Map<u64, i32> bindingSetHeaderIndices_;
+
 		struct BindingSetHandles
 		{
 			Core::Vector<ShaderBindingHeader> headers_;
+			// Header indices by name hash.
+			Core::Map<u32, i32> indices_;
 		};
 
 		Core::Vector<BindingSetHandles> bindingSetHandles_;
@@ -585,14 +667,9 @@ namespace Graphics
 		if(auto readLock = Core::ScopedReadLock(factory->rwLock_))
 		{
 			const auto& handles = factory->bindingSetHandles_[impl_->idx_];
-
-			auto it = std::find_if(handles.headers_.begin(), handles.headers_.end(),
-			    [name](const ShaderBindingHeader& a) { return strcmp(name, a.name_) == 0; });
-
-			if(it != handles.headers_.end())
-			{
-				return it->handle_;
-			}
+			const i32 idx = FindHeaderIndex(handles.indices_, handles.headers_, name, HashShaderName(name));
+			if(idx >= 0)
+				return handles.headers_[idx].handle_;
 		}
 		return (ShaderBindingHandle)ShaderBindingFlags::INVALID;
 	}
@@ -602,9 +679,13 @@ namespace Graphics
 		DBG_ASSERT(impl_);
 		DBG_ASSERT(Core::ContainsAllFlags((ShaderBindingFlags)handle, ShaderBindingFlags::SAMPLER));
 		const i32 idx = handle & (i32)ShaderBindingFlags::INDEX_MASK;
-		if(impl_->samplers_[idx] != sampler && GPU::Manager::IsInitialized())
-			GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, sampler);
-		impl_->samplers_[idx] = sampler;
+		if(impl_->samplers_[idx] != sampler)
+		{
+			if(GPU::Manager::IsInitialized())
+				GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, sampler);
+			impl_->samplers_[idx] = sampler;
+			impl_->version_ = ShaderBindingSetImpl::AllocVersion();
+		}
 
 		return *this;
 	}
@@ -614,9 +695,13 @@ namespace Graphics
 		DBG_ASSERT(impl_);
 		DBG_ASSERT(Core::ContainsAllFlags((ShaderBindingFlags)handle, ShaderBindingFlags::CBV));
 		const i32 idx = handle & (i32)ShaderBindingFlags::INDEX_MASK;
-		if(impl_->cbvs_[idx] != binding && GPU::Manager::IsInitialized())
-			GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
-		impl_->cbvs_[idx] = binding;
+		if(impl_->cbvs_[idx] != binding)
+		{
+			if(GPU::Manager::IsInitialized())
+				GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
+			impl_->cbvs_[idx] = binding;
+			impl_->version_ = ShaderBindingSetImpl::AllocVersion();
+		}
 		return *this;
 	}
 
@@ -625,9 +710,13 @@ namespace Graphics
 		DBG_ASSERT(impl_);
 		DBG_ASSERT(Core::ContainsAllFlags((ShaderBindingFlags)handle, ShaderBindingFlags::SRV));
 		const i32 idx = handle & (i32)ShaderBindingFlags::INDEX_MASK;
-		if(impl_->srvs_[idx] != binding && GPU::Manager::IsInitialized())
-			GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
-		impl_->srvs_[idx] = binding;
+		if(impl_->srvs_[idx] != binding)
+		{
+			if(GPU::Manager::IsInitialized())
+				GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
+			impl_->srvs_[idx] = binding;
+			impl_->version_ = ShaderBindingSetImpl::AllocVersion();
+		}
 		return *this;
 	}
 
@@ -636,9 +725,13 @@ namespace Graphics
 		DBG_ASSERT(impl_);
 		DBG_ASSERT(Core::ContainsAllFlags((ShaderBindingFlags)handle, ShaderBindingFlags::UAV));
 		const i32 idx = handle & (i32)ShaderBindingFlags::INDEX_MASK;
-		if(impl_->uavs_[idx] != binding && GPU::Manager::IsInitialized())
-			GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
-		impl_->uavs_[idx] = binding;
+		if(impl_->uavs_[idx] != binding)
+		{
+			if(GPU::Manager::IsInitialized())
+				GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
+			impl_->uavs_[idx] = binding;
+			impl_->version_ = ShaderBindingSetImpl::AllocVersion();
+		}
 		return *this;
 	}
 
@@ -647,9 +740,13 @@ namespace Graphics
 		DBG_ASSERT(impl_);
 		for(i32 idx = 0; idx < impl_->srvs_.size(); ++idx)
 		{
-			if(impl_->srvs_[idx] != binding && GPU::Manager::IsInitialized())
-				GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
-			impl_->srvs_[idx] = binding;
+			if(impl_->srvs_[idx] != binding)
+			{
+				if(GPU::Manager::IsInitialized())
+					GPU::Manager::UpdatePipelineBindings(impl_->pbs_, idx, binding);
+				impl_->srvs_[idx] = binding;
+				impl_->version_ = ShaderBindingSetImpl::AllocVersion();
+			}
 		}
 		return *this;
 	}
@@ -726,6 +823,12 @@ namespace Graphics
 		return true;
 	}
 
+	i32 ShaderBindingSetImpl::AllocVersion()
+	{
+		static volatile i32 nextVersion = 0;
+		return Core::AtomicInc(&nextVersion);
+	}
+
 	ShaderContext::ShaderContext(GPU::CommandList& cmdList)
 	{
 		auto* factory = Shader::GetFactory();
@@ -761,14 +864,14 @@ namespace Graphics
 	bool ShaderContext::CommitBindings(
 	    const ShaderTechnique& tech, GPU::Handle& outPs, Core::ArrayView<GPU::PipelineBinding>& outPb)
 	{
-		// Count number of required bindings.
-		// TODO: This should be packed into the technique itself.
-		GPU::PipelineBindingSetDesc tempDesc = {};
-		for(const auto& bindingSlot : tech.impl_->header_.bindingSlots_)
-		{
-			if(bindingSlot.idx_ == -1)
-				break;
+		const auto* techImpl = tech.impl_;
+		outPs = techImpl->shader_->pipelineStates_[techImpl->descIdx_];
 
+		// Key by technique layout and bound binding set versions, to reuse bindings committed earlier.
+		u64 hash = techImpl->bindingHash_;
+		for(i32 slotIdx = 0; slotIdx < techImpl->numBindingSlots_; ++slotIdx)
+		{
+			const auto& bindingSlot = techImpl->header_.bindingSlots_[slotIdx];
 			const auto* bindingSet = impl_->bindingSets_[bindingSlot.idx_];
 #if !defined(_RELEASE)
 			if(bindingSet == nullptr)
@@ -779,15 +882,18 @@ namespace Graphics
 			}
 #endif // !defined(_RELEASE)
 			DBG_ASSERT(bindingSet != nullptr);
+			hash = Core::Hash(hash, bindingSet->version_);
+		}
 
-			tempDesc.numCBVs_ = Core::Max(tempDesc.numCBVs_, bindingSlot.cbvReg_ + bindingSet->cbvs_.size());
-			tempDesc.numSRVs_ = Core::Max(tempDesc.numSRVs_, bindingSlot.srvReg_ + bindingSet->srvs_.size());
-			tempDesc.numUAVs_ = Core::Max(tempDesc.numUAVs_, bindingSlot.uavReg_ + bindingSet->uavs_.size());
-			tempDesc.numSamplers_ =
-			    Core::Max(tempDesc.numSamplers_, bindingSlot.samplerReg_ + bindingSet->samplers_.size());
+		auto* committed = impl_->committedBindings_.find(hash);
+		if(committed && committed->Matches(*techImpl, impl_->bindingSets_))
+		{
+			outPb = committed->pb_;
+			return true;
 		}
 
 		// Allocate pipeline binding.
+		const auto& tempDesc = techImpl->bindingDesc_;
 		GPU::PipelineBinding pb = {};
 		pb.pbs_ = GPU::Manager::AllocTemporaryPipelineBindingSet(tempDesc);
 		pb.cbvs_.num_ = tempDesc.numCBVs_;
@@ -795,13 +901,10 @@ namespace Graphics
 		pb.uavs_.num_ = tempDesc.numUAVs_;
 		pb.samplers_.num_ = tempDesc.numSamplers_;
 
-		for(const auto& bindingSlot : tech.impl_->header_.bindingSlots_)
+		for(i32 slotIdx = 0; slotIdx < techImpl->numBindingSlots_; ++slotIdx)
 		{
-			if(bindingSlot.idx_ == -1)
-				break;
-
+			const auto& bindingSlot = techImpl->header_.bindingSlots_[slotIdx];
 			const auto* bindingSet = impl_->bindingSets_[bindingSlot.idx_];
-			DBG_ASSERT(bindingSet != nullptr);
 
 			for(const auto& binding : bindingSet->cbvs_)
 				DBG_ASSERT(binding.resource_.IsValid());
@@ -831,19 +934,44 @@ namespace Graphics
 			srcPbs.samplers_.dstOffset_ = 0;
 			srcPbs.samplers_.srcOffset_ = 0;
 
-			if(tech.impl_->header_.cs_ == -1)
-			{
-				int a = 0;
-				++a;
-			}
-
 			GPU::Manager::CopyPipelineBindings(dstPbs, srcPbs);
 		}
 
 		GPU::Manager::ValidatePipelineBindings(pb);
 
 		outPb = impl_->cmdList_.Push(Core::ArrayView<GPU::PipelineBinding>(pb));
-		outPs = tech.impl_->shader_->pipelineStates_[tech.impl_->descIdx_];
+
+		// On a hash collision, replace the older entry.
+		ShaderContextImpl::CommittedBindings newCommitted;
+		newCommitted.numBindingSlots_ = techImpl->numBindingSlots_;
+		for(i32 slotIdx = 0; slotIdx < techImpl->numBindingSlots_; ++slotIdx)
+		{
+			const auto& bindingSlot = techImpl->header_.bindingSlots_[slotIdx];
+			newCommitted.bindingSlots_[slotIdx] = bindingSlot;
+			newCommitted.versions_[slotIdx] = impl_->bindingSets_[bindingSlot.idx_]->version_;
+		}
+		newCommitted.pb_ = outPb;
+		impl_->committedBindings_.insert(hash, newCommitted);
+		return true;
+	}
+
+	bool ShaderContextImpl::CommittedBindings::Matches(
+	    const ShaderTechniqueImpl& tech, const Core::Vector<ShaderBindingSetImpl*>& bindingSets) const
+	{
+		if(numBindingSlots_ != tech.numBindingSlots_)
+			return false;
+
+		// Binding layout is derived from binding slots, so only those & versions need comparing.
+		for(i32 slotIdx = 0; slotIdx < numBindingSlots_; ++slotIdx)
+		{
+			const auto& a = bindingSlots_[slotIdx];
+			const auto& b = tech.header_.bindingSlots_[slotIdx];
+			if(a.idx_ != b.idx_ || a.cbvReg_ != b.cbvReg_ || a.srvReg_ != b.srvReg_ || a.uavReg_ != b.uavReg_ ||
+			    a.samplerReg_ != b.samplerReg_)
+				return false;
+			if(versions_[slotIdx] != bindingSets[b.idx_]->version_)
+				return false;
+		}
 		return true;
 	}
 
@@ -857,16 +985,39 @@ namespace Graphics
 #endif // !defined(_RELEASE)
 	}
 
+	struct ShaderPrewarmImpl
+	{
+		Core::Vector<PipelineStateCacheRecord> records_;
+		Core::Vector<GPU::Handle> pipelineStates_;
+		Core::Vector<u64> hashes_;
+		Job::FunctionJob* job_ = nullptr;
+		Job::Counter* counter_ = nullptr;
+	};
+
 	ShaderImpl::ShaderImpl() {}
 
 	ShaderImpl::~ShaderImpl()
 	{
 		DBG_ASSERT_MSG(techniques_.size() == 0, "Techniques still reference this shader.");
 
+		if(prewarm_)
+		{
+			if(prewarm_->counter_)
+				Job::Manager::WaitForCounter(prewarm_->counter_, 0);
+			delete prewarm_->job_;
+
+			for(auto hash : prewarm_->hashes_)
+				if(hash != 0)
+					PipelineStateCacheImpl::Get()->Release(hash);
+			delete prewarm_;
+		}
+
+		for(auto hash : pipelineStateHashes_)
+			if(hash != 0)
+				PipelineStateCacheImpl::Get()->Release(hash);
+
 		if(GPU::Manager::IsInitialized())
 		{
-			for(auto ps : pipelineStates_)
-				GPU::Manager::DestroyResource(ps);
 			for(auto s : shaders_)
 				GPU::Manager::DestroyResource(s);
 			for(auto s : samplerStates_)
@@ -876,17 +1027,16 @@ namespace Graphics
 
 	i32 ShaderImpl::GetBindingIndex(const char* name) const
 	{
-		for(i32 idx = 0; idx < bindingHeaders_.size(); ++idx)
-		{
-			const auto& binding = bindingHeaders_[idx];
-			if(strcmp(binding.name_, name) == 0)
-				return idx;
-		}
-		return -1;
+		return FindHeaderIndex(bindingIndices_, bindingHeaders_, name, HashShaderName(name));
 	}
 
 	const char* ShaderImpl::GetBindingName(i32 idx) const { return bindingHeaders_[idx].name_; }
 
+	i32 ShaderImpl::GetTechniqueIndex(const char* name, u32 nameHash) const
+	{
+		return FindHeaderIndex(techniqueIndices_, techniqueHeaders_, name, nameHash);
+	}
+
 	ShaderTechniqueImpl* ShaderImpl::CreateTechnique(const char* name, const ShaderTechniqueDesc& desc)
 	{
 		Job::ScopedWriteLock lock(rwLock_);
@@ -895,27 +1045,27 @@ namespace Graphics
 		i32 foundIdx = -1;
 		u64 hash = Core::HashFNV1a(0, &desc, sizeof(desc));
 		hash = Core::Hash(hash, name);
-		for(i32 idx = 0; idx < techniqueDescHashes_.size(); ++idx)
+		if(const i32* idx = techniqueDescIndices_.find(hash))
 		{
-			if(techniqueDescHashes_[idx] == hash)
-			{
-				DBG_ASSERT_MSG(techniqueDescs_[idx] == desc, "Technique hash collision!");
-				foundIdx = idx;
-			}
+			DBG_ASSERT_MSG(techniqueDescs_[*idx] == desc, "Technique hash collision!");
+			foundIdx = *idx;
 		}
 
 		// None found, push to end of list.
 		if(foundIdx == -1)
 		{
+			techniqueDescIndices_.insert(hash, techniqueDescHashes_.size());
 			techniqueDescHashes_.push_back(hash);
 			techniqueDescs_.push_back(desc);
 			pipelineStates_.resize(techniqueDescs_.size());
+			pipelineStateHashes_.resize(techniqueDescs_.size());
 			foundIdx = techniqueDescs_.size() - 1;
 		}
 
 		auto* impl = new ShaderTechniqueImpl();
 		impl->shader_ = this;
 		strcpy_s(impl->header_.name_, sizeof(impl->header_.name_), name);
+		impl->header_.nameHash_ = HashShaderName(name);
 		impl->descIdx_ = foundIdx;
 
 		techniques_.push_back(impl);
@@ -932,7 +1082,9 @@ namespace Graphics
 		auto* factory = Shader::GetFactory();
 		if(auto readLock = Core::ScopedReadLock(factory->rwLock_))
 		{
-			i32 idx = factory->FindBindingSetIdx(name);
+			// Resolve name within this shader, as other shaders may have a different binding set of the same name.
+			const i32 localIdx = FindHeaderIndex(bindingSetIndices_, bindingSetHeaders_, name, HashShaderName(name));
+			const i32 idx = localIdx >= 0 ? factory->FindBindingSetIdx(bindingSetHeaders_[localIdx]) : -1;
 			if(idx >= 0)
 			{
 				const auto& bindingSetHeader = factory->bindingSetHeaders_[idx];
@@ -972,14 +1124,9 @@ namespace Graphics
 
 		// Find valid technique header.
 		const ShaderTechniqueHeader* techHeader = nullptr;
-		for(const auto& it : techniqueHeaders_)
-		{
-			if(strcmp(it.name_, impl->header_.name_) == 0)
-			{
-				techHeader = &it;
-				break;
-			}
-		}
+		const i32 techIdx = GetTechniqueIndex(impl->header_.name_, impl->header_.nameHash_);
+		if(techIdx >= 0)
+			techHeader = &techniqueHeaders_[techIdx];
 
 		if(techHeader == nullptr)
 		{
@@ -993,39 +1140,17 @@ namespace Graphics
 		if(!psHandle && GPU::Manager::IsInitialized())
 		{
 			const auto& desc = techniqueDescs_[impl->descIdx_];
-			DBG_ASSERT(techHeader->vs_ != -1 || techHeader->cs_ != -1);
-
-			if(techHeader->cs_ != -1)
+			const u64 hash = AcquirePipelineState(*techHeader, desc, false, psHandle);
+			if(psHandle)
 			{
-				GPU::ComputePipelineStateDesc psDesc;
-				psDesc.shader_ = shaders_[techHeader->cs_];
-				psHandle =
-				    GPU::Manager::CreateComputePipelineState(psDesc, "%s/%s", name_.c_str(), impl->header_.name_);
+				pipelineStates_[impl->descIdx_] = psHandle;
+				pipelineStateHashes_[impl->descIdx_] = hash;
+				PipelineStateCacheImpl::Get()->Record(hash, 0, name_.c_str(), techHeader->name_, desc);
 			}
 			else
 			{
-				GPU::GraphicsPipelineStateDesc psDesc;
-				psDesc.shaders_[(i32)GPU::ShaderType::VS] =
-				    techHeader->vs_ != -1 ? shaders_[techHeader->vs_] : GPU::Handle();
-				psDesc.shaders_[(i32)GPU::ShaderType::HS] =
-				    techHeader->hs_ != -1 ? shaders_[techHeader->hs_] : GPU::Handle();
-				psDesc.shaders_[(i32)GPU::ShaderType::DS] =
-				    techHeader->ds_ != -1 ? shaders_[techHeader->ds_] : GPU::Handle();
-				psDesc.shaders_[(i32)GPU::ShaderType::GS] =
-				    techHeader->gs_ != -1 ? shaders_[techHeader->gs_] : GPU::Handle();
-				psDesc.shaders_[(i32)GPU::ShaderType::PS] =
-				    techHeader->ps_ != -1 ? shaders_[techHeader->ps_] : GPU::Handle();
-				psDesc.renderState_ = techHeader->rs_;
-				psDesc.numVertexElements_ = desc.numVertexElements_;
-				memcpy(&psDesc.vertexElements_[0], desc.vertexElements_.data(), sizeof(psDesc.vertexElements_));
-				psDesc.topology_ = desc.topology_;
-				psDesc.numRTs_ = desc.numRTs_;
-				memcpy(&psDesc.rtvFormats_[0], desc.rtvFormats_.data(), sizeof(psDesc.rtvFormats_));
-				psDesc.dsvFormat_ = desc.dsvFormat_;
-				psHandle =
-				    GPU::Manager::CreateGraphicsPipelineState(psDesc, "%s/%s", name_.c_str(), impl->header_.name_);
+				PipelineStateCacheImpl::Get()->Release(hash);
 			}
-			pipelineStates_[impl->descIdx_] = psHandle;
 		}
 
 		if(!psHandle)
@@ -1039,6 +1164,31 @@ namespace Graphics
 		impl->shader_ = this;
 		impl->header_ = *techHeader;
 
+		// Binding layout only depends on the technique's binding slots, so count required bindings once here.
+		impl->numBindingSlots_ = 0;
+		impl->bindingDesc_ = GPU::PipelineBindingSetDesc();
+		auto* factory = Shader::GetFactory();
+		if(auto readLock = Core::ScopedReadLock(factory->rwLock_))
+		{
+			auto& desc = impl->bindingDesc_;
+			for(const auto& bindingSlot : impl->header_.bindingSlots_)
+			{
+				if(bindingSlot.idx_ == -1)
+					break;
+
+				const auto& bindingSetHeader = factory->bindingSetHeaders_[bindingSlot.idx_];
+				desc.numCBVs_ = Core::Max(desc.numCBVs_, bindingSlot.cbvReg_ + bindingSetHeader.numCBVs_);
+				desc.numSRVs_ = Core::Max(desc.numSRVs_, bindingSlot.srvReg_ + bindingSetHeader.numSRVs_);
+				desc.numUAVs_ = Core::Max(desc.numUAVs_, bindingSlot.uavReg_ + bindingSetHeader.numUAVs_);
+				desc.numSamplers_ =
+				    Core::Max(desc.numSamplers_, bindingSlot.samplerReg_ + bindingSetHeader.numSamplers_);
+				++impl->numBindingSlots_;
+			}
+		}
+		impl->bindingHash_ = Core::HashFNV1a(0, &impl->bindingDesc_, sizeof(impl->bindingDesc_));
+		impl->bindingHash_ = Core::HashFNV1a(impl->bindingHash_, impl->header_.bindingSlots_.data(),
+		    sizeof(ShaderTechniqueBindingSlot) * impl->numBindingSlots_);
+
 #if 0
 		// Set samplers.
 		for(i32 idx = 0; idx < impl->samplers_.size(); ++idx)
@@ -1061,4 +1211,107 @@ namespace Graphics
 		return true;
 	}
 
+	u64 ShaderImpl::AcquirePipelineState(const ShaderTechniqueHeader& techHeader, const ShaderTechniqueDesc& desc,
+	    bool isPrewarm, GPU::Handle& outHandle)
+	{
+		DBG_ASSERT(techHeader.vs_ != -1 || techHeader.cs_ != -1);
+		auto* cache = PipelineStateCacheImpl::Get();
+
+		auto HashShader = [this](u64 hash, i32 idx) {
+			const u64 shaderHash = idx != -1 ? shaderHashes_[idx] : 0;
+			return Core::HashFNV1a(hash, &shaderHash, sizeof(shaderHash));
+		};
+
+		u64 hash = 0;
+		if(techHeader.cs_ != -1)
+		{
+			hash = HashShader(hash, techHeader.cs_);
+
+			GPU::ComputePipelineStateDesc psDesc;
+			psDesc.shader_ = shaders_[techHeader.cs_];
+			outHandle = cache->Acquire(hash, psDesc, isPrewarm, "%s/%s", name_.c_str(), techHeader.name_);
+		}
+		else
+		{
+			hash = HashShader(hash, techHeader.vs_);
+			hash = HashShader(hash, techHeader.hs_);
+			hash = HashShader(hash, techHeader.ds_);
+			hash = HashShader(hash, techHeader.gs_);
+			hash = HashShader(hash, techHeader.ps_);
+			hash = Core::HashFNV1a(hash, &techHeader.rs_, sizeof(techHeader.rs_));
+			hash = Core::HashFNV1a(hash, &desc.numVertexElements_, sizeof(desc.numVertexElements_));
+			hash = Core::HashFNV1a(
+			    hash, desc.vertexElements_.data(), sizeof(GPU::VertexElement) * desc.numVertexElements_);
+			hash = Core::HashFNV1a(hash, &desc.topology_, sizeof(desc.topology_));
+			hash = Core::HashFNV1a(hash, &desc.numRTs_, sizeof(desc.numRTs_));
+			hash = Core::HashFNV1a(hash, desc.rtvFormats_.data(), sizeof(GPU::Format) * desc.numRTs_);
+			hash = Core::HashFNV1a(hash, &desc.dsvFormat_, sizeof(desc.dsvFormat_));
+
+			GPU::GraphicsPipelineStateDesc psDesc;
+			psDesc.shaders_[(i32)GPU::ShaderType::VS] = techHeader.vs_ != -1 ? shaders_[techHeader.vs_] : GPU::Handle();
+			psDesc.shaders_[(i32)GPU::ShaderType::HS] = techHeader.hs_ != -1 ? shaders_[techHeader.hs_] : GPU::Handle();
+			psDesc.shaders_[(i32)GPU::ShaderType::DS] = techHeader.ds_ != -1 ? shaders_[techHeader.ds_] : GPU::Handle();
+			psDesc.shaders_[(i32)GPU::ShaderType::GS] = techHeader.gs_ != -1 ? shaders_[techHeader.gs_] : GPU::Handle();
+			psDesc.shaders_[(i32)GPU::ShaderType::PS] = techHeader.ps_ != -1 ? shaders_[techHeader.ps_] : GPU::Handle();
+			psDesc.renderState_ = techHeader.rs_;
+			psDesc.numVertexElements_ = desc.numVertexElements_;
+			memcpy(&psDesc.vertexElements_[0], desc.vertexElements_.data(), sizeof(psDesc.vertexElements_));
+			psDesc.topology_ = desc.topology_;
+			psDesc.numRTs_ = desc.numRTs_;
+			memcpy(&psDesc.rtvFormats_[0], desc.rtvFormats_.data(), sizeof(psDesc.rtvFormats_));
+			psDesc.dsvFormat_ = desc.dsvFormat_;
+			outHandle = cache->Acquire(hash, psDesc, isPrewarm, "%s/%s", name_.c_str(), techHeader.name_);
+		}
+
+		return hash;
+	}
+
+	void ShaderImpl::PrewarmPipelineStates()
+	{
+		DBG_ASSERT(prewarm_ == nullptr);
+
+		Core::Vector<PipelineStateCacheRecord> records;
+		PipelineStateCacheImpl::Get()->GetRecords(name_.c_str(), records);
+		if(records.size() == 0)
+			return;
+
+		prewarm_ = new ShaderPrewarmImpl();
+		prewarm_->records_ = std::move(records);
+		prewarm_->pipelineStates_.resize(prewarm_->records_.size());
+		prewarm_->hashes_.resize(prewarm_->records_.size());
+
+		auto PrewarmFn = [this](i32 idx) {
+			const auto& record = prewarm_->records_[idx];
+			const i32 techIdx = GetTechniqueIndex(record.techniqueName_, HashShaderName(record.techniqueName_));
+			if(techIdx >= 0)
+			{
+				const auto& techHeader = techniqueHeaders_[techIdx];
+				auto* cache = PipelineStateCacheImpl::Get();
+				GPU::Handle& psHandle = prewarm_->pipelineStates_[idx];
+				const u64 hash = AcquirePipelineState(techHeader, record.desc_, true, psHandle);
+				if(psHandle)
+				{
+					// Replace record if shader has changed since it was recorded.
+					prewarm_->hashes_[idx] = hash;
+					cache->Record(hash, record.hash_, record.shaderName_, record.techniqueName_, record.desc_);
+				}
+				else
+				{
+					cache->Release(hash);
+				}
+			}
+		};
+
+		if(Job::Manager::IsInitialized())
+		{
+			prewarm_->job_ = new Job::FunctionJob("ShaderImpl::PrewarmPipelineStates", PrewarmFn);
+			prewarm_->job_->RunMultiple(Job::Priority::LOW, 0, prewarm_->records_.size() - 1, &prewarm_->counter_);
+		}
+		else
+		{
+			for(i32 idx = 0; idx < prewarm_->records_.size(); ++idx)
+				PrewarmFn(idx);
+		}
+	}
+
 } // namespace Graphics
@@ -1,5 +1,7 @@
 #pragma once
+#include "core/array_view.h"
 #include "core/hash.h"
+#include "core/map.h"
 #include "core/set.h"
 #include "core/string.h"
 #include "core/vector.h"
@@ -7,6 +9,8 @@
 #include "graphics/shader.h"
 #include "job/concurrency.h"
 
+#include <cstring>
+
 namespace Serialization
 {
 	class Serializer;
@@ -34,14 +38,38 @@ namespace Graphics
 	DEFINE_ENUM_CLASS_FLAG_OPERATOR(ShaderBindingFlags, |);
 	DEFINE_ENUM_CLASS_FLAG_OPERATOR(ShaderBindingFlags, &);
 
+	/// Hash of technique, binding set & binding names, as stored in their headers.
+	inline u32 HashShaderName(const char* name) { return (u32)Core::Hash(0, name); }
+
+	/**
+	 * Find index of header named @a name, looking up @a nameHash in @a indices.
+	 * Falls back to a linear scan if the hash matches a different name.
+	 * @return Index into @a headers, -1 if not found.
+	 */
+	template<typename HEADERS>
+	i32 FindHeaderIndex(const Core::Map<u32, i32>& indices, const HEADERS& headers, const char* name, u32 nameHash)
+	{
+		const i32* idx = indices.find(nameHash);
+		if(idx == nullptr)
+			return -1;
+		if(strcmp(headers[*idx].name_, name) == 0)
+			return *idx;
+		for(i32 scanIdx = 0; scanIdx < headers.size(); ++scanIdx)
+			if(headers[scanIdx].nameHash_ == nameHash && strcmp(headers[scanIdx].name_, name) == 0)
+				return scanIdx;
+		return -1;
+	}
+
 	struct GRAPHICS_DLL ShaderHeader
 	{
 		/// Magic number.
 		static const u32 MAGIC = 0x229C08ED;
 		/// Major version signifies a breaking change to the binary format.
-		static const i16 MAJOR_VERSION = 0x0004;
+		static const i16 MAJOR_VERSION = 0x0006;
 		/// Minor version signifies non-breaking change to binary format.
 		static const i16 MINOR_VERSION = 0x0000;
+		/// Alignment of bytecode section & each shader's bytecode, relative to the start of the header.
+		static const i32 BYTECODE_ALIGNMENT = 16;
 
 		u32 magic_ = MAGIC;
 		i16 majorVersion_ = MAJOR_VERSION;
@@ -59,6 +87,7 @@ namespace Graphics
 	struct GRAPHICS_DLL ShaderBindingSetHeader
 	{
 		char name_[MAX_NAME_LENGTH] = {'\0'};
+		u32 nameHash_ = 0;
 		bool isShared_ = false;
 		i32 frequency_ = 0;
 		i32 numCBVs_ = 0;
@@ -72,6 +101,7 @@ namespace Graphics
 	struct GRAPHICS_DLL ShaderBindingHeader
 	{
 		char name_[MAX_NAME_LENGTH] = {'\0'};
+		u32 nameHash_ = 0;
 		ShaderBindingHandle handle_;
 
 		bool Serialize(Serialization::Serializer& serializer);
@@ -98,6 +128,7 @@ namespace Graphics
 	struct GRAPHICS_DLL ShaderTechniqueHeader
 	{
 		char name_[MAX_NAME_LENGTH] = {'\0'};
+		u32 nameHash_ = 0;
 		i32 vs_ = -1;
 		i32 hs_ = -1;
 		i32 ds_ = -1;
@@ -124,23 +155,38 @@ namespace Graphics
 	{
 		Core::String name_;
 		Graphics::ShaderHeader header_;
-		Core::Vector<ShaderBindingSetHeader> bindingSetHeaders_;
-		Core::Vector<ShaderBindingHeader> bindingHeaders_;
-		Core::Vector<ShaderBytecodeHeader> bytecodeHeaders_;
-		Core::Vector<ShaderTechniqueHeader> techniqueHeaders_;
-		Core::Vector<ShaderSamplerStateHeader> samplerStateHeaders_;
-		Core::Vector<u8> bytecode_;
+
+		// Header sections, copied from the converted shader in a single allocation.
+		Core::Vector<u8> headerData_;
+		Core::ArrayView<ShaderBindingSetHeader> bindingSetHeaders_;
+		Core::ArrayView<ShaderBindingHeader> bindingHeaders_;
+		Core::ArrayView<ShaderBytecodeHeader> bytecodeHeaders_;
+		Core::ArrayView<ShaderTechniqueHeader> techniqueHeaders_;
+		Core::ArrayView<ShaderSamplerStateHeader> samplerStateHeaders_;
+
+		// Header indices by name hash, built from hashes precomputed by the converter.
+		Core::Map<u32, i32> bindingSetIndices_;
+		Core::Map<u32, i32> bindingIndices_;
+		Core::Map<u32, i32> techniqueIndices_;
 
 		Core::Vector<GPU::Handle> samplerStates_;
 		Core::Vector<GPU::Handle> shaders_;
 
+		// Hash of each shader's bytecode, used to key the pipeline state cache.
+		Core::Vector<u64> shaderHashes_;
+
 		// All technique impls currently active.
 		Core::Vector<ShaderTechniqueImpl*> techniques_;
 
 		// Data that's between different techniques.
 		Core::Vector<u64> techniqueDescHashes_;
+		Core::Map<u64, i32> techniqueDescIndices_;
 		Core::Vector<ShaderTechniqueDesc> techniqueDescs_;
 		Core::Vector<GPU::Handle> pipelineStates_;
+		Core::Vector<u64> pipelineStateHashes_;
+
+		// Pipeline states being prewarmed from the pipeline state cache.
+		struct ShaderPrewarmImpl* prewarm_ = nullptr;
 
 		Job::RWLock rwLock_;
 
@@ -153,6 +199,9 @@ namespace Graphics
 		/// Get binding name from index.
 		const char* GetBindingName(i32 idx) const;
 
+		/// Get technique header index from name.
+		i32 GetTechniqueIndex(const char* name, u32 nameHash) const;
+
 		/// Create technique to match @a name and @a desc.
 		ShaderTechniqueImpl* CreateTechnique(const char* name, const ShaderTechniqueDesc& desc);
 
@@ -161,6 +210,13 @@ namespace Graphics
 
 		/// Setup @a impl to reference the currently loaded shader appropriately.
 		bool SetupTechnique(ShaderTechniqueImpl* impl);
+
+		/// Acquire pipeline state from the pipeline state cache. Must be released by hash.
+		u64 AcquirePipelineState(const ShaderTechniqueHeader& techHeader, const ShaderTechniqueDesc& desc,
+		    bool isPrewarm, GPU::Handle& outHandle);
+
+		/// Begin creating pipeline states recorded for this shader on job workers.
+		void PrewarmPipelineStates();
 	};
 
 	struct ShaderTechniqueImpl
@@ -169,6 +225,11 @@ namespace Graphics
 		ShaderTechniqueHeader header_;
 		i32 descIdx_ = -1;
 
+		// Pipeline binding layout of header_'s binding slots, and its hash. Setup by SetupTechnique.
+		i32 numBindingSlots_ = 0;
+		GPU::PipelineBindingSetDesc bindingDesc_;
+		u64 bindingHash_ = 0;
+
 		void Invalidate()
 		{
 			header_.vs_ = -1;
@@ -188,9 +249,15 @@ namespace Graphics
 
 	struct ShaderBindingSetImpl
 	{
+		/// @return Version unique across all binding sets.
+		static i32 AllocVersion();
+
 		ShaderBindingSetHeader header_;
 		i32 idx_ = -1;
 
+		// Changed whenever bindings change, so committed bindings can be reused until then.
+		i32 version_ = AllocVersion();
+
 		GPU::Handle pbs_;
 
 		Core::Vector<GPU::BindingCBV> cbvs_;
@@ -209,6 +276,22 @@ namespace Graphics
 		GPU::CommandList& cmdList_;
 		Core::Vector<ShaderBindingSetImpl*> bindingSets_;
 
+		// Binding slots and binding set versions that pipeline bindings were committed for.
+		// Stored in full, so a hash collision can't reuse another technique's bindings.
+		struct CommittedBindings
+		{
+			i32 numBindingSlots_ = 0;
+			Core::Array<ShaderTechniqueBindingSlot, MAX_BOUND_BINDING_SETS> bindingSlots_;
+			Core::Array<i32, MAX_BOUND_BINDING_SETS> versions_;
+			Core::ArrayView<GPU::PipelineBinding> pb_;
+
+			bool Matches(const ShaderTechniqueImpl& tech, const Core::Vector<ShaderBindingSetImpl*>& bindingSets) const;
+		};
+
+		// Pipeline bindings committed with this context, keyed by technique layout & binding set versions.
+		// Contexts only record a single command list within a frame, so temporary binding sets stay valid.
+		Core::Map<u64, CommittedBindings> committedBindings_;
+
 #if !defined(_RELEASE)
 		struct Callstack
 		{
@@ -0,0 +1,221 @@
+#include "graphics/skinning.h"
+#include "graphics/transform_hierarchy.h"
+#include "core/debug.h"
+#include "core/misc.h"
+#include "job/parallel_for.h"
+#include "math/simd.h"
+
+namespace Graphics
+{
+	namespace
+	{
+		using namespace Math::SIMD;
+
+		template<typename GET_WORLD>
+		void ComputeSkinningMatricesImpl(const SkinningBones& bones, const GET_WORLD& getWorld,
+		    Core::Vector<Math::Mat44>& outMatrices, i32 batchSize)
+		{
+			DBG_ASSERT(batchSize > 0);
+			DBG_ASSERT(bones.nodeIndices_.size() == bones.inverseBindPoses_.size());
+			outMatrices.resize(bones.Size());
+
+			const i32* nodeIndices = bones.nodeIndices_.data();
+			const Math::Mat44* inverseBindPoses = bones.inverseBindPoses_.data();
+			Math::Mat44* matrices = outMatrices.data();
+			Job::ParallelFor("ComputeSkinningMatrices", bones.Size(), batchSize,
+			    [nodeIndices, inverseBindPoses, matrices, getWorld](i32 begin, i32 end) {
+				    for(i32 idx = begin; idx < end; ++idx)
+					    MulMatrix44(matrices[idx][0], inverseBindPoses[idx][0], getWorld(nodeIndices[idx])[0]);
+			    });
+		}
+
+		struct SkinningStreams
+		{
+			const f32* position_[3];
+			const f32* normal_[3];
+			const i32* bones_[SkinningVertices::MAX_INFLUENCES];
+			const f32* weights_[SkinningVertices::MAX_INFLUENCES];
+			f32* outPosition_[3];
+			f32* outNormal_[3];
+			const Math::Mat44* matrices_;
+		};
+
+		/// Blend influencing matrices of vertex @a idx, and transform its position & normal.
+		inline void SkinVertex(const SkinningStreams& streams, i32 idx, Float4& outPosition, Float4& outNormal)
+		{
+			Float4 rows[4];
+			for(i32 influence = 0; influence < SkinningVertices::MAX_INFLUENCES; ++influence)
+			{
+				const f32* matrix = streams.matrices_[streams.bones_[influence][idx]][0];
+				const Float4 weight = Splat(streams.weights_[influence][idx]);
+				for(i32 row = 0; row < 4; ++row)
+				{
+					const Float4 weighted = Mul(weight, LoadAligned(matrix + row * 4));
+					rows[row] = influence == 0 ? weighted : Add(weighted, rows[row]);
+				}
+			}
+
+			outNormal = Mul(Splat(streams.normal_[0][idx]), rows[0]);
+			outNormal = MulAdd(Splat(streams.normal_[1][idx]), rows[1], outNormal);
+			outNormal = MulAdd(Splat(streams.normal_[2][idx]), rows[2], outNormal);
+
+			outPosition = MulAdd(Splat(streams.position_[0][idx]), rows[0], rows[3]);
+			outPosition = MulAdd(Splat(streams.position_[1][idx]), rows[1], outPosition);
+			outPosition = MulAdd(Splat(streams.position_[2][idx]), rows[2], outPosition);
+		}
+
+		void SkinVertexRange(const SkinningStreams& streams, i32 begin, i32 end)
+		{
+			// Skin 4 vertices at a time, and transpose their results back into structure of arrays.
+			i32 idx = begin;
+			for(; (idx + 4) <= end; idx += 4)
+			{
+				Float4 positions[4];
+				Float4 normals[4];
+				for(i32 lane = 0; lane < 4; ++lane)
+					SkinVertex(streams, idx + lane, positions[lane], normals[lane]);
+
+				Transpose(positions[0], positions[1], positions[2], positions[3]);
+				Transpose(normals[0], normals[1], normals[2], normals[3]);
+				for(i32 component = 0; component < 3; ++component)
+				{
+					Store(streams.outPosition_[component] + idx, positions[component]);
+					Store(streams.outNormal_[component] + idx, normals[component]);
+				}
+			}
+
+			for(; idx < end; ++idx)
+			{
+				Float4 position, normal;
+				SkinVertex(streams, idx, position, normal);
+
+				alignas(16) f32 positionData[4];
+				alignas(16) f32 normalData[4];
+				StoreAligned(positionData, position);
+				StoreAligned(normalData, normal);
+				for(i32 component = 0; component < 3; ++component)
+				{
+					streams.outPosition_[component][idx] = positionData[component];
+					streams.outNormal_[component][idx] = normalData[component];
+				}
+			}
+		}
+	}
+
+	void SkinningBones::Add(i32 nodeIdx, const Math::Mat44& inverseBindPose)
+	{
+		nodeIndices_.push_back(nodeIdx);
+		inverseBindPoses_.push_back(inverseBindPose);
+	}
+
+	void SkinningBones::Clear()
+	{
+		nodeIndices_.clear();
+		inverseBindPoses_.clear();
+	}
+
+	void ComputeSkinningMatrices(
+	    const SkinningBones& bones, const Math::Mat44* worlds, Core::Vector<Math::Mat44>& outMatrices, i32 batchSize)
+	{
+		ComputeSkinningMatricesImpl(
+		    bones, [worlds](i32 nodeIdx) -> const Math::Mat44& { return worlds[nodeIdx]; }, outMatrices, batchSize);
+	}
+
+	void ComputeSkinningMatrices(const SkinningBones& bones, const TransformHierarchy& hierarchy,
+	    Core::Vector<Math::Mat44>& outMatrices, i32 batchSize)
+	{
+		const TransformHierarchy* hierarchyPtr = &hierarchy;
+		ComputeSkinningMatricesImpl(bones,
+		    [hierarchyPtr](i32 nodeIdx) -> const Math::Mat44& { return hierarchyPtr->GetWorld(nodeIdx); }, outMatrices,
+		    batchSize);
+	}
+
+	void SkinningVertices::Add(
+	    const Math::Vec3& position, const Math::Vec3& normal, const i32* bones, const f32* weights)
+	{
+		x_.push_back(position.x);
+		y_.push_back(position.y);
+		z_.push_back(position.z);
+		nx_.push_back(normal.x);
+		ny_.push_back(normal.y);
+		nz_.push_back(normal.z);
+		for(i32 influence = 0; influence < MAX_INFLUENCES; ++influence)
+		{
+			bones_[influence].push_back(bones[influence]);
+			weights_[influence].push_back(weights[influence]);
+		}
+	}
+
+	void SkinningVertices::Resize(i32 num)
+	{
+		x_.resize(num);
+		y_.resize(num);
+		z_.resize(num);
+		nx_.resize(num);
+		ny_.resize(num);
+		nz_.resize(num);
+		for(i32 influence = 0; influence < MAX_INFLUENCES; ++influence)
+		{
+			bones_[influence].resize(num);
+			weights_[influence].resize(num);
+		}
+	}
+
+	void SkinningVertices::Clear()
+	{
+		x_.clear();
+		y_.clear();
+		z_.clear();
+		nx_.clear();
+		ny_.clear();
+		nz_.clear();
+		for(i32 influence = 0; influence < MAX_INFLUENCES; ++influence)
+		{
+			bones_[influence].clear();
+			weights_[influence].clear();
+		}
+	}
+
+	void SkinnedVertices::Resize(i32 num)
+	{
+		x_.resize(num);
+		y_.resize(num);
+		z_.resize(num);
+		nx_.resize(num);
+		ny_.resize(num);
+		nz_.resize(num);
+	}
+
+	void SkinVertices(
+	    const SkinningVertices& vertices, const Math::Mat44* matrices, SkinnedVertices& outVertices, i32 batchSize)
+	{
+		DBG_ASSERT(batchSize > 0);
+		outVertices.Resize(vertices.Size());
+
+		SkinningStreams streams;
+		streams.position_[0] = vertices.x_.data();
+		streams.position_[1] = vertices.y_.data();
+		streams.position_[2] = vertices.z_.data();
+		streams.normal_[0] = vertices.nx_.data();
+		streams.normal_[1] = vertices.ny_.data();
+		streams.normal_[2] = vertices.nz_.data();
+		for(i32 influence = 0; influence < SkinningVertices::MAX_INFLUENCES; ++influence)
+		{
+			streams.bones_[influence] = vertices.bones_[influence].data();
+			streams.weights_[influence] = vertices.weights_[influence].data();
+		}
+		streams.outPosition_[0] = outVertices.x_.data();
+		streams.outPosition_[1] = outVertices.y_.data();
+		streams.outPosition_[2] = outVertices.z_.data();
+		streams.outNormal_[0] = outVertices.nx_.data();
+		streams.outNormal_[1] = outVertices.ny_.data();
+		streams.outNormal_[2] = outVertices.nz_.data();
+		streams.matrices_ = matrices;
+
+		// Keep batches a multiple of 4 so only the last one has a scalar tail.
+		const SkinningStreams* streamsPtr = &streams;
+		Job::ParallelFor("SkinVertices", vertices.Size(), Core::PotRoundUp(batchSize, 4),
+		    [streamsPtr](i32 begin, i32 end) { SkinVertexRange(*streamsPtr, begin, end); });
+	}
+
+} // namespace Graphics
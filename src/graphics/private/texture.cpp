@@ -1,5 +1,6 @@
 #include "graphics/texture.h"
 #include "graphics/private/texture_impl.h"
+#include "graphics/private/texture_streaming_impl.h"
 
 #include "resource/factory.h"
 #include "resource/manager.h"
@@ -13,11 +14,55 @@
 #include "gpu/utils.h"
 #include "serialization/serializer.h"
 
+#include <cmath>
+
 namespace Graphics
 {
+	GPU::Handle CreateTextureLevels(const TextureHeader& header, const TextureSubResourceHeader* subRscHeaders,
+	    i32 level, const u8* data, i64 dataOffset, const char* name, GPU::TextureDesc& outDesc)
+	{
+		const auto& fullDesc = header.desc_;
+		DBG_ASSERT(level >= 0 && level < fullDesc.levels_);
+
+		outDesc = fullDesc;
+		outDesc.width_ = Core::Max(1, fullDesc.width_ >> level);
+		outDesc.height_ = Core::Max(1, fullDesc.height_ >> level);
+		outDesc.depth_ = Core::Max((i16)1, (i16)(fullDesc.depth_ >> level));
+		outDesc.levels_ = fullDesc.levels_ - (i16)level;
+
+		// Setup subresources.
+		Core::Vector<GPU::TextureSubResourceData> subRscs;
+		subRscs.reserve(outDesc.levels_ * outDesc.elements_);
+		for(i32 element = 0; element < fullDesc.elements_; ++element)
+		{
+			for(i32 idx = level; idx < fullDesc.levels_; ++idx)
+			{
+				const auto width = Core::Max(1, fullDesc.width_ >> idx);
+				const auto height = Core::Max(1, fullDesc.height_ >> idx);
+				const auto texLayoutInfo = GPU::GetTextureLayoutInfo(fullDesc.format_, width, height);
+				const auto& subRscHeader = subRscHeaders[GetTextureSubResourceIdx(fullDesc, element, idx)];
+
+				GPU::TextureSubResourceData subRsc;
+				subRsc.data_ = data + (subRscHeader.offset_ - dataOffset);
+				subRsc.rowPitch_ = texLayoutInfo.pitch_;
+				subRsc.slicePitch_ = texLayoutInfo.slicePitch_;
+				subRscs.push_back(subRsc);
+			}
+		}
+
+		// Create GPU texture if initialized.
+		if(!GPU::Manager::IsInitialized())
+			return GPU::Handle();
+		return GPU::Manager::CreateTexture(outDesc, subRscs.data(), "%s/%s", name, "texture");
+	}
+
 	class TextureFactory : public Resource::IFactory
 	{
 	public:
+		TextureFactory() { TextureStreamingImpl::Create(); }
+
+		~TextureFactory() { TextureStreamingImpl::Destroy(); }
+
 		bool CreateResource(Resource::IFactoryContext& context, void** outResource, const Core::UUID& type) override
 		{
 			DBG_ASSERT(type == Texture::GetTypeUUID());
@@ -42,76 +87,54 @@ namespace Graphics
 
 			const bool isReload = texture->IsReady();
 
-			GPU::TextureDesc desc;
-
-			// Read in desc.
-			if(inFile.Read(&desc, sizeof(desc)) != sizeof(desc))
+			// Read in header.
+			const i64 baseOffset = inFile.Tell();
+			TextureHeader header;
+			if(inFile.Read(&header, sizeof(header)) != sizeof(header))
 			{
 				return false;
 			}
-			i64 bytes =
-			    GPU::GetTextureSize(desc.format_, desc.width_, desc.height_, desc.depth_, desc.levels_, desc.elements_);
 
-			GPU::Handle handle;
-
-			auto CreateTexture = [&](const u8* texData) {
-				// Setup subresources.
-				i32 numSubRsc = desc.levels_ * desc.elements_;
-				Core::Vector<GPU::TextureSubResourceData> subRscs;
-				subRscs.reserve(numSubRsc);
-
-				// Should we skip loading mip levels?
-				i16 skipMips = skipMips_;
-				if(desc.levels_ < skipMips)
-				{
-					skipMips = desc.levels_ - 1;
-				}
+			if(header.magic_ != TextureHeader::MAGIC || header.majorVersion_ != TextureHeader::MAJOR_VERSION)
+			{
+				DBG_LOG("TextureFactory: Unable to load \"%s\", magic or version mismatch.\n", name);
+				return false;
+			}
 
-				auto formatInfo = GPU::GetFormatInfo(desc.format_);
+			const auto& fullDesc = header.desc_;
+			Core::Vector<TextureSubResourceHeader> subRscHeaders;
+			subRscHeaders.resize(fullDesc.levels_ * fullDesc.elements_);
+			const i64 readBytes = subRscHeaders.size() * sizeof(TextureSubResourceHeader);
+			if(inFile.Read(subRscHeaders.data(), readBytes) != readBytes)
+			{
+				return false;
+			}
 
-				i64 texDataOffset = 0;
-				for(i32 element = 0; element < desc.elements_; ++element)
+			const i64 dataSize = inFile.Size() - baseOffset;
+			for(const auto& subRscHeader : subRscHeaders)
+			{
+				if(subRscHeader.offset_ < 0 || (subRscHeader.offset_ + subRscHeader.size_) > dataSize)
 				{
-					for(i32 level = 0; level < desc.levels_; ++level)
-					{
-						const auto width = Core::Max(1, desc.width_ >> level);
-						const auto height = Core::Max(1, desc.height_ >> level);
-						const auto depth = Core::Max(1, desc.depth_ >> level);
-
-						const auto texLayoutInfo = GPU::GetTextureLayoutInfo(desc.format_, width, height);
-						const auto subRscSize = GPU::GetTextureSize(desc.format_, width, height, depth, 1, 1);
-
-						GPU::TextureSubResourceData subRsc;
-						subRsc.data_ = texData + texDataOffset;
-						subRsc.rowPitch_ = texLayoutInfo.pitch_;
-						subRsc.slicePitch_ = texLayoutInfo.slicePitch_;
-
-						texDataOffset += subRscSize;
-
-						if(level >= skipMips)
-						{
-							subRscs.push_back(subRsc);
-						}
-					}
+					DBG_LOG("TextureFactory: Unable to load \"%s\", subresource out of bounds.\n", name);
+					return false;
 				}
+			}
 
-				desc.width_ = Core::Max(1, desc.width_ >> (i32)skipMips);
-				desc.height_ = Core::Max(1, desc.height_ >> (i32)skipMips);
-				desc.depth_ = Core::Max((i16)1, desc.depth_ >> skipMips);
-				desc.levels_ -= skipMips_;
+			// Should we skip loading mip levels?
+			const i32 minLevel = Core::Min((i32)skipMips_, fullDesc.levels_ - 1);
 
-				// Create GPU texture if initialized.
-				if(GPU::Manager::IsInitialized())
-				{
-					handle = GPU::Manager::CreateTexture(desc, subRscs.data(), "%s/%s", name, "texture");
-				}
-			};
+			// Streamed textures only load their tail levels, the rest are streamed in when requested.
+			auto* streaming = TextureStreamingImpl::Get();
+			const i32 tailLevel =
+			    streaming->IsEnabled() ? Core::Max(minLevel, streaming->GetTailLevel(fullDesc)) : minLevel;
 
 			// Map texture data and create.
-			if(auto mapped = Core::MappedFile(inFile, inFile.Tell(), bytes))
+			GPU::TextureDesc desc;
+			GPU::Handle handle;
+			if(auto mapped = Core::MappedFile(inFile, baseOffset, dataSize))
 			{
 				const u8* texData = static_cast<const u8*>(mapped.GetAddress());
-				CreateTexture(texData);
+				handle = CreateTextureLevels(header, subRscHeaders.data(), tailLevel, texData, 0, name, desc);
 			}
 			else
 			{
@@ -123,11 +146,28 @@ namespace Graphics
 			auto impl = new TextureImpl();
 			impl->desc_ = desc;
 			impl->handle_ = handle;
+			impl->header_ = header;
+			impl->minLevel_ = minLevel;
+			impl->tailLevel_ = tailLevel;
+			impl->residentLevel_ = tailLevel;
+
+			if(impl->IsStreamed())
+			{
+				impl->name_ = name;
+				impl->path_ = inFile.GetPath();
+				impl->fileOffset_ = baseOffset;
+				impl->subRscHeaders_ = std::move(subRscHeaders);
+				streaming->AddTexture(impl);
+			}
 
 			if(isReload)
 			{
-				auto lock = Resource::Manager::TakeReloadLock();
-				std::swap(texture->impl_, impl);
+				impl->version_ = texture->impl_->version_ + 1;
+				{
+					auto lock = Resource::Manager::TakeReloadLock();
+					std::swap(texture->impl_, impl);
+				}
+				// Outside of reload lock, as streaming takes it while holding its own lock.
 				delete impl;
 			}
 			else
@@ -145,6 +185,10 @@ namespace Graphics
 			if(auto object = ser.Object("texture"))
 			{
 				retVal &= ser.Serialize("skipMips", skipMips_);
+
+				i32 streamingBudget = 0;
+				if(ser.Serialize("streamingBudget", streamingBudget) && streamingBudget > 0)
+					TextureStreamingImpl::Get()->SetBudget((i64)streamingBudget * 1024 * 1024, 64);
 			}
 			return retVal;
 		}
@@ -180,8 +224,52 @@ namespace Graphics
 		return impl_->handle_;
 	}
 
+	i32 Texture::GetVersion() const
+	{
+		DBG_ASSERT(impl_);
+		return impl_->version_;
+	}
+
+	void Texture::RequestLevel(i32 level)
+	{
+		DBG_ASSERT(impl_);
+		auto* streaming = TextureStreamingImpl::Get();
+		if(!impl_->IsStreamed() || streaming == nullptr)
+			return;
+
+		// First request this frame replaces the previous frame's, later ones keep the most detailed.
+		// Frame & level are packed together so both are updated by the same compare & exchange.
+		const i64 request =
+		    TextureImpl::PackRequested(streaming->GetFrame(), Core::Clamp(level, 0, TextureImpl::MAX_LEVEL));
+		i64 requested = impl_->requested_;
+		while(request > requested)
+		{
+			const i64 oldRequested = Core::AtomicCmpExchg(&impl_->requested_, request, requested);
+			if(oldRequested == requested)
+				break;
+			requested = oldRequested;
+		}
+	}
+
+	i32 Texture::GetLevelForScreenSize(f32 screenSize) const
+	{
+		DBG_ASSERT(impl_);
+		const auto& fullDesc = impl_->header_.desc_;
+		const f32 size = (f32)Core::Max(fullDesc.width_, fullDesc.height_);
+		if(screenSize >= size)
+			return 0;
+		const i32 level = (i32)std::log2(size / Core::Max(1.0f, screenSize));
+		return Core::Min(level, fullDesc.levels_ - 1);
+	}
+
 	TextureImpl::~TextureImpl()
 	{
+		if(IsStreamed())
+		{
+			if(auto* streaming = TextureStreamingImpl::Get())
+				streaming->RemoveTexture(this);
+		}
+
 		if(GPU::Manager::IsInitialized())
 		{
 			GPU::Manager::DestroyResource(handle_);
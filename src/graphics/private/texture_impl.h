@@ -1,13 +1,93 @@
 #pragma once
+#include "core/string.h"
+#include "core/vector.h"
 #include "gpu/resources.h"
 
 namespace Graphics
 {
+	struct TextureHeader
+	{
+		/// Magic number.
+		static const u32 MAGIC = 0x58455454;
+		/// Major version signifies a breaking change to the binary format.
+		static const i16 MAJOR_VERSION = 0x0001;
+		/// Minor version signifies non-breaking change to binary format.
+		static const i16 MINOR_VERSION = 0x0000;
+
+		u32 magic_ = MAGIC;
+		i16 majorVersion_ = MAJOR_VERSION;
+		i16 minorVersion_ = MINOR_VERSION;
+
+		/// Full texture desc. Followed by a TextureSubResourceHeader per subresource, in GPU subresource order.
+		GPU::TextureDesc desc_;
+	};
+
+	/**
+	 * Location of a single subresource's data.
+	 * Data is stored a level at a time, from most to least detailed, so all levels from any given
+	 * level down to the smallest are contiguous and can be read in one go.
+	 */
+	struct TextureSubResourceHeader
+	{
+		/// Offset from start of TextureHeader.
+		i64 offset_ = 0;
+		i64 size_ = 0;
+	};
+
+	/**
+	 * Get subresource index of @a level in @a element.
+	 */
+	inline i32 GetTextureSubResourceIdx(const GPU::TextureDesc& desc, i32 element, i32 level)
+	{
+		return element * desc.levels_ + level;
+	}
+
+	/**
+	 * Create GPU texture using levels from @a level down to the smallest.
+	 * @param data File data, starting at @a dataOffset from the start of the TextureHeader.
+	 * @param outDesc Desc of created texture.
+	 * @return Texture handle. Invalid if GPU manager isn't initialized.
+	 */
+	GPU::Handle CreateTextureLevels(const TextureHeader& header, const TextureSubResourceHeader* subRscHeaders,
+	    i32 level, const u8* data, i64 dataOffset, const char* name, GPU::TextureDesc& outDesc);
+
 	struct TextureImpl
 	{
 		GPU::Handle handle_;
 		GPU::TextureDesc desc_;
 
+		/// Changed every time handle_ changes, so bindings can be updated.
+		volatile i32 version_ = 0;
+
+		// Streaming state. Only set up if streamed.
+		Core::String name_;
+		Core::String path_;
+		/// Offset of TextureHeader within file at path_.
+		i64 fileOffset_ = 0;
+		TextureHeader header_;
+		Core::Vector<TextureSubResourceHeader> subRscHeaders_;
+		/// Most detailed level allowed.
+		i32 minLevel_ = 0;
+		/// Least detailed level streamed. Levels from this one down are always resident.
+		i32 tailLevel_ = 0;
+		/// Most detailed level currently resident.
+		i32 residentLevel_ = 0;
+		/// Most detailed level requested, and on which streaming frame. See PackRequested.
+		volatile i64 requested_ = 0;
+		/// Pending stream request.
+		struct TextureStreamRequest* request_ = nullptr;
+
+		bool IsStreamed() const { return tailLevel_ > minLevel_; }
+
+		/**
+		 * Pack request so later frames compare greater, then more detailed levels within a frame.
+		 * This lets requests from multiple threads be merged with a single compare & exchange max.
+		 */
+		static i64 PackRequested(i32 frame, i32 level) { return (i64)frame * 0x100000000LL + (MAX_LEVEL - level); }
+		static i32 GetRequestedFrame(i64 requested) { return (i32)(requested >> 32); }
+		static i32 GetRequestedLevel(i64 requested) { return MAX_LEVEL - (i32)(requested & 0xffffffff); }
+		static const i32 MAX_LEVEL = 0xffff;
+
 		~TextureImpl();
 	};
 
@@ -0,0 +1,287 @@
+#include "graphics/texture_streaming.h"
+#include "graphics/private/texture_streaming_impl.h"
+#include "graphics/private/material_impl.h"
+
+#include "core/debug.h"
+#include "core/misc.h"
+#include "gpu/manager.h"
+#include "resource/manager.h"
+
+#include <algorithm>
+
+namespace Graphics
+{
+	namespace
+	{
+		TextureStreamingImpl* impl_ = nullptr;
+
+		/// @return Size of all levels from @a level down to the smallest.
+		i64 GetLevelsSize(const TextureImpl* texture, i32 level)
+		{
+			const auto& desc = texture->header_.desc_;
+			i64 size = 0;
+			for(i32 element = 0; element < desc.elements_; ++element)
+				for(i32 idx = level; idx < desc.levels_; ++idx)
+					size += texture->subRscHeaders_[GetTextureSubResourceIdx(desc, element, idx)].size_;
+			return size;
+		}
+	}
+
+	TextureStreamingImpl::TextureStreamingImpl() {}
+
+	TextureStreamingImpl::~TextureStreamingImpl()
+	{
+		// Reads write into requests, so they must complete before they can be freed.
+		for(auto* request : requests_)
+		{
+			while(!request->result_.IsComplete())
+				Core::SwitchThread();
+			if(request->texture_)
+				request->texture_->request_ = nullptr;
+			delete request;
+		}
+
+		for(auto* texture : textures_)
+			texture->tailLevel_ = texture->minLevel_;
+	}
+
+	void TextureStreamingImpl::Create()
+	{
+		DBG_ASSERT(impl_ == nullptr);
+		impl_ = new TextureStreamingImpl();
+	}
+
+	void TextureStreamingImpl::Destroy()
+	{
+		DBG_ASSERT(impl_ != nullptr);
+		delete impl_;
+		impl_ = nullptr;
+	}
+
+	TextureStreamingImpl* TextureStreamingImpl::Get() { return impl_; }
+
+	void TextureStreamingImpl::SetBudget(i64 budgetBytes, i32 tailSize)
+	{
+		DBG_ASSERT(budgetBytes >= 0);
+		DBG_ASSERT(tailSize > 0);
+		Core::ScopedMutex lock(mutex_);
+		budgetBytes_ = budgetBytes;
+		tailSize_ = tailSize;
+	}
+
+	i32 TextureStreamingImpl::GetTailLevel(const GPU::TextureDesc& desc) const
+	{
+		for(i32 level = 0; level < desc.levels_; ++level)
+		{
+			if(Core::Max(desc.width_ >> level, desc.height_ >> level) <= tailSize_)
+				return level;
+		}
+		return desc.levels_ - 1;
+	}
+
+	void TextureStreamingImpl::AddTexture(TextureImpl* texture)
+	{
+		DBG_ASSERT(texture->IsStreamed());
+		Core::ScopedMutex lock(mutex_);
+		texture->requested_ = TextureImpl::PackRequested(frame_ - EVICT_FRAMES - 1, texture->tailLevel_);
+		textures_.push_back(texture);
+	}
+
+	void TextureStreamingImpl::RemoveTexture(TextureImpl* texture)
+	{
+		Core::ScopedMutex lock(mutex_);
+		auto it = std::find(textures_.begin(), textures_.end(), texture);
+		if(it != textures_.end())
+			textures_.erase(it);
+
+		if(texture->request_)
+		{
+			texture->request_->texture_ = nullptr;
+			texture->request_ = nullptr;
+		}
+	}
+
+	void TextureStreamingImpl::Update()
+	{
+		Core::ScopedMutex lock(mutex_);
+		const i32 frame = Core::AtomicInc(&frame_);
+
+		// Complete finished requests.
+		for(i32 idx = 0; idx < requests_.size();)
+		{
+			auto* request = requests_[idx];
+			if(request->result_.IsComplete())
+			{
+				CompleteRequest(request);
+				delete request;
+				requests_.erase(requests_.begin() + idx);
+			}
+			else
+			{
+				++idx;
+			}
+		}
+
+		// Determine level wanted by each texture.
+		struct Candidate
+		{
+			TextureImpl* texture_ = nullptr;
+			i32 level_ = 0;
+			i32 frame_ = 0;
+		};
+
+		Core::Vector<Candidate> candidates;
+		candidates.reserve(textures_.size());
+		i64 usedBytes = 0;
+		i64 requestedBytes = 0;
+		for(auto* texture : textures_)
+		{
+			Candidate candidate;
+			candidate.texture_ = texture;
+			candidate.level_ = texture->tailLevel_;
+			const i64 requested = texture->requested_;
+			candidate.frame_ = TextureImpl::GetRequestedFrame(requested);
+			if((frame - candidate.frame_) <= EVICT_FRAMES)
+				candidate.level_ = Core::Clamp(
+				    TextureImpl::GetRequestedLevel(requested), texture->minLevel_, texture->tailLevel_);
+			candidates.push_back(candidate);
+
+			// Tail levels are always resident.
+			usedBytes += GetLevelsSize(texture, texture->tailLevel_);
+			requestedBytes += GetLevelsSize(texture, candidate.level_);
+		}
+
+		// Most recently requested, then most detailed, get their levels first. The rest get what fits in budget.
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			if(a.frame_ != b.frame_)
+				return a.frame_ > b.frame_;
+			return a.level_ < b.level_;
+		});
+
+		for(auto& candidate : candidates)
+		{
+			const i64 tailBytes = GetLevelsSize(candidate.texture_, candidate.texture_->tailLevel_);
+			i64 levelBytes = GetLevelsSize(candidate.texture_, candidate.level_) - tailBytes;
+			while(levelBytes > 0 && (usedBytes + levelBytes) > budgetBytes_)
+				levelBytes = GetLevelsSize(candidate.texture_, ++candidate.level_) - tailBytes;
+			usedBytes += levelBytes;
+		}
+
+		// Evict first so memory is released before more is streamed in.
+		for(const auto& candidate : candidates)
+		{
+			auto* texture = candidate.texture_;
+			if(texture->request_ == nullptr && candidate.level_ > texture->residentLevel_)
+				IssueRequest(texture, candidate.level_);
+		}
+
+		for(const auto& candidate : candidates)
+		{
+			if(requests_.size() >= MAX_PENDING_REQUESTS)
+				break;
+
+			auto* texture = candidate.texture_;
+			if(texture->request_ == nullptr && candidate.level_ < texture->residentLevel_)
+				IssueRequest(texture, candidate.level_);
+		}
+
+		stats_.requestedBytes_ = requestedBytes;
+	}
+
+	bool TextureStreamingImpl::IssueRequest(TextureImpl* texture, i32 level)
+	{
+		// Levels are stored most detailed first, so all of them from level down are contiguous.
+		const auto& desc = texture->header_.desc_;
+		i64 begin = texture->subRscHeaders_[GetTextureSubResourceIdx(desc, 0, level)].offset_;
+		i64 end = begin;
+		for(i32 element = 0; element < desc.elements_; ++element)
+		{
+			for(i32 idx = level; idx < desc.levels_; ++idx)
+			{
+				const auto& subRscHeader = texture->subRscHeaders_[GetTextureSubResourceIdx(desc, element, idx)];
+				begin = Core::Min(begin, subRscHeader.offset_);
+				end = Core::Max(end, subRscHeader.offset_ + subRscHeader.size_);
+			}
+		}
+
+		auto* request = new TextureStreamRequest();
+		request->texture_ = texture;
+		request->level_ = level;
+		request->dataOffset_ = begin;
+		request->file_ = Core::File(texture->path_.c_str(), Core::FileFlags::DEFAULT_READ);
+		if(!request->file_)
+		{
+			DBG_LOG("TextureStreaming: Unable to open \"%s\"\n", texture->path_.c_str());
+			delete request;
+			return false;
+		}
+
+		request->data_.resize((i32)(end - begin));
+		Resource::Manager::ReadFileData(
+		    request->file_, texture->fileOffset_ + begin, end - begin, request->data_.data(), &request->result_);
+
+		texture->request_ = request;
+		requests_.push_back(request);
+		return true;
+	}
+
+	void TextureStreamingImpl::CompleteRequest(TextureStreamRequest* request)
+	{
+		auto* texture = request->texture_;
+		if(texture == nullptr)
+			return;
+
+		texture->request_ = nullptr;
+		if(request->result_.result_ != Resource::Result::SUCCESS)
+		{
+			DBG_LOG("TextureStreaming: Failed to read \"%s\"\n", texture->path_.c_str());
+			return;
+		}
+
+		GPU::TextureDesc desc;
+		GPU::Handle handle = CreateTextureLevels(texture->header_, texture->subRscHeaders_.data(), request->level_,
+		    request->data_.data(), request->dataOffset_, texture->name_.c_str(), desc);
+		if(!handle)
+			return;
+
+		if(request->level_ < texture->residentLevel_)
+			++stats_.numStreamedIn_;
+		else
+			++stats_.numEvicted_;
+
+		// Old texture is kept alive by the GPU manager until frames using it are complete.
+		auto reloadLock = Resource::Manager::TakeReloadLock();
+		GPU::Manager::DestroyResource(texture->handle_);
+		texture->handle_ = handle;
+		texture->desc_ = desc;
+		texture->residentLevel_ = request->level_;
+		Core::AtomicInc(&texture->version_);
+	}
+
+	TextureStreamingStats TextureStreamingImpl::GetStats()
+	{
+		Core::ScopedMutex lock(mutex_);
+		TextureStreamingStats stats = stats_;
+		stats.numTextures_ = textures_.size();
+		stats.numPendingRequests_ = requests_.size();
+		stats.budgetBytes_ = budgetBytes_;
+		stats.residentBytes_ = 0;
+		for(const auto* texture : textures_)
+			stats.residentBytes_ += GetLevelsSize(texture, texture->residentLevel_);
+		return stats;
+	}
+
+	void TextureStreaming::SetBudget(i64 budgetBytes, i32 tailSize)
+	{
+		TextureStreamingImpl::Get()->SetBudget(budgetBytes, tailSize);
+	}
+
+	void TextureStreaming::Update()
+	{
+		TextureStreamingImpl::Get()->Update();
+		UpdateMaterialTextureBindings();
+	}
+
+	TextureStreamingStats TextureStreaming::GetStats() { return TextureStreamingImpl::Get()->GetStats(); }
+
+} // namespace Graphics
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "graphics/texture_streaming.h"
+#include "graphics/private/texture_impl.h"
+#include "core/concurrency.h"
+#include "core/file.h"
+#include "core/vector.h"
+#include "resource/types.h"
+
+namespace Graphics
+{
+	/**
+	 * Read of levels for a streamed texture.
+	 */
+	struct TextureStreamRequest
+	{
+		/// Texture to update. nullptr if destroyed while the read is pending.
+		TextureImpl* texture_ = nullptr;
+		/// Most detailed level being read.
+		i32 level_ = 0;
+		/// Offset of data_ from start of TextureHeader.
+		i64 dataOffset_ = 0;
+		Core::File file_;
+		Core::Vector<u8> data_;
+		Resource::AsyncResult result_;
+	};
+
+	class TextureStreamingImpl
+	{
+	public:
+		/// Frames a requested level is kept resident for after it was last requested.
+		static const i32 EVICT_FRAMES = 60;
+		/// Maximum number of stream requests pending at once.
+		static const i32 MAX_PENDING_REQUESTS = 16;
+
+		TextureStreamingImpl();
+		~TextureStreamingImpl();
+
+		/// Created & destroyed with the texture factory.
+		static void Create();
+		static void Destroy();
+		/// @return Impl, or nullptr if texture factory isn't registered.
+		static TextureStreamingImpl* Get();
+
+		void SetBudget(i64 budgetBytes, i32 tailSize);
+		bool IsEnabled() const { return budgetBytes_ > 0; }
+		i32 GetFrame() const { return frame_; }
+
+		/// @return Least detailed level to stream for @a desc.
+		i32 GetTailLevel(const GPU::TextureDesc& desc) const;
+
+		/// Add texture set up for streaming.
+		void AddTexture(TextureImpl* texture);
+		/// Remove texture. Any pending request is discarded once its read completes.
+		void RemoveTexture(TextureImpl* texture);
+
+		void Update();
+		TextureStreamingStats GetStats();
+
+	private:
+		bool IssueRequest(TextureImpl* texture, i32 level);
+		void CompleteRequest(TextureStreamRequest* request);
+
+		Core::Mutex mutex_;
+		i64 budgetBytes_ = 0;
+		i32 tailSize_ = 64;
+		volatile i32 frame_ = 0;
+		Core::Vector<TextureImpl*> textures_;
+		Core::Vector<TextureStreamRequest*> requests_;
+		TextureStreamingStats stats_;
+	};
+
+} // namespace Graphics
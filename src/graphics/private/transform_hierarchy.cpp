@@ -0,0 +1,162 @@
+#include "graphics/transform_hierarchy.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "job/parallel_for.h"
+#include "math/simd.h"
+
+#include <cstring>
+
+namespace Graphics
+{
+	i32 TransformHierarchy::AddNode(i32 parentIdx, const Math::Mat44& local)
+	{
+		DBG_ASSERT(parentIdx < GetNumNodes());
+		const i32 level = parentIdx >= 0 ? nodeLevels_[parentIdx] + 1 : 0;
+
+		// Append unsorted, the next update will move it into its level.
+		nodeParents_.push_back(parentIdx);
+		nodeLevels_.push_back(level);
+		sortedIdxs_.push_back(locals_.size());
+		locals_.push_back(local);
+		worlds_.push_back(local);
+		parents_.push_back(parentIdx >= 0 ? sortedIdxs_[parentIdx] : -1);
+		dirty_.push_back(1);
+
+		dirtyLevel_ = dirtyLevel_ >= 0 ? Core::Min(dirtyLevel_, level) : level;
+		unsorted_ = true;
+		return nodeParents_.size() - 1;
+	}
+
+	void TransformHierarchy::Clear()
+	{
+		nodeParents_.clear();
+		nodeLevels_.clear();
+		sortedIdxs_.clear();
+		locals_.clear();
+		worlds_.clear();
+		parents_.clear();
+		dirty_.clear();
+		levelOffsets_.clear();
+		dirtyLevel_ = -1;
+		unsorted_ = false;
+	}
+
+	void TransformHierarchy::SetLocal(i32 nodeIdx, const Math::Mat44& local)
+	{
+		DBG_ASSERT(nodeIdx >= 0 && nodeIdx < GetNumNodes());
+		const i32 sortedIdx = sortedIdxs_[nodeIdx];
+		const i32 level = nodeLevels_[nodeIdx];
+		locals_[sortedIdx] = local;
+		dirty_[sortedIdx] = 1;
+		dirtyLevel_ = dirtyLevel_ >= 0 ? Core::Min(dirtyLevel_, level) : level;
+	}
+
+	void TransformHierarchy::SortByDepth()
+	{
+		const i32 numNodes = GetNumNodes();
+
+		// Counting sort by level, stable so siblings keep their relative order.
+		i32 numLevels = 0;
+		for(i32 level : nodeLevels_)
+			numLevels = Core::Max(numLevels, level + 1);
+
+		levelOffsets_.clear();
+		levelOffsets_.resize(numLevels + 1, 0);
+		for(i32 level : nodeLevels_)
+			++levelOffsets_[level + 1];
+		for(i32 level = 0; level < numLevels; ++level)
+			levelOffsets_[level + 1] += levelOffsets_[level];
+
+		Core::Vector<i32> levelCursors(levelOffsets_);
+		Core::Vector<i32> sortedIdxs;
+		sortedIdxs.resize(numNodes);
+		for(i32 nodeIdx = 0; nodeIdx < numNodes; ++nodeIdx)
+			sortedIdxs[nodeIdx] = levelCursors[nodeLevels_[nodeIdx]]++;
+
+		Core::Vector<Math::Mat44> locals;
+		Core::Vector<Math::Mat44> worlds;
+		Core::Vector<i32> parents;
+		Core::Vector<u8> dirty;
+		locals.resize(numNodes);
+		worlds.resize(numNodes);
+		parents.resize(numNodes);
+		dirty.resize(numNodes);
+		for(i32 nodeIdx = 0; nodeIdx < numNodes; ++nodeIdx)
+		{
+			const i32 oldIdx = sortedIdxs_[nodeIdx];
+			const i32 newIdx = sortedIdxs[nodeIdx];
+			const i32 parentIdx = nodeParents_[nodeIdx];
+			locals[newIdx] = locals_[oldIdx];
+			worlds[newIdx] = worlds_[oldIdx];
+			parents[newIdx] = parentIdx >= 0 ? sortedIdxs[parentIdx] : -1;
+			dirty[newIdx] = dirty_[oldIdx];
+		}
+
+		sortedIdxs_.swap(sortedIdxs);
+		locals_.swap(locals);
+		worlds_.swap(worlds);
+		parents_.swap(parents);
+		dirty_.swap(dirty);
+		unsorted_ = false;
+	}
+
+	i32 TransformHierarchy::Update(i32 batchSize)
+	{
+		DBG_ASSERT(batchSize > 0);
+		if(unsorted_)
+			SortByDepth();
+		if(dirtyLevel_ < 0)
+			return 0;
+
+		const Math::Mat44* locals = locals_.data();
+		Math::Mat44* worlds = worlds_.data();
+		const i32* parents = parents_.data();
+		u8* dirty = dirty_.data();
+		volatile i32 numUpdated = 0;
+		volatile i32* numUpdatedPtr = &numUpdated;
+
+		// Roots have no parent to multiply by.
+		const i32 numRoots = levelOffsets_[1];
+		if(dirtyLevel_ == 0)
+		{
+			for(i32 idx = 0; idx < numRoots; ++idx)
+			{
+				if(dirty[idx])
+				{
+					worlds[idx] = locals[idx];
+					++numUpdated;
+				}
+			}
+		}
+
+		// Levels above the first dirty one are unchanged. Within a level, a node is recomputed if it
+		// or its parent is dirty, and then marked dirty itself so the change propagates to its children.
+		for(i32 level = Core::Max(1, dirtyLevel_); level < GetNumLevels(); ++level)
+		{
+			const i32 levelBegin = levelOffsets_[level];
+			const i32 levelSize = levelOffsets_[level + 1] - levelBegin;
+			Job::ParallelFor("TransformHierarchy::Update", levelSize, batchSize,
+			    [levelBegin, locals, worlds, parents, dirty, numUpdatedPtr](i32 begin, i32 end) {
+				    i32 batchUpdated = 0;
+				    for(i32 idx = levelBegin + begin; idx < levelBegin + end; ++idx)
+				    {
+					    const i32 parentIdx = parents[idx];
+					    if(dirty[idx] | dirty[parentIdx])
+					    {
+						    Math::SIMD::MulMatrix44(worlds[idx][0], locals[idx][0], worlds[parentIdx][0]);
+						    dirty[idx] = 1;
+						    ++batchUpdated;
+					    }
+				    }
+				    if(batchUpdated > 0)
+					    Core::AtomicAdd(numUpdatedPtr, batchUpdated);
+			    });
+		}
+
+		const i32 dirtyBegin = levelOffsets_[dirtyLevel_];
+		memset(dirty + dirtyBegin, 0, dirty_.size() - dirtyBegin);
+		dirtyLevel_ = -1;
+		return numUpdated;
+	}
+
+} // namespace Graphics
@@ -4,6 +4,7 @@
 #include "graphics/render_resources.h"
 #include "graphics/render_pass.h"
 #include "core/function.h"
+#include "gpu/commands.h"
 
 namespace Graphics
 {
@@ -16,6 +17,36 @@ namespace Graphics
 
 	using RenderGraphExecFn = Core::Function<void(RenderGraph&, void*), 256>;
 
+	/**
+	 * Queue scheduling for an executed render pass.
+	 */
+	struct GRAPHICS_DLL RenderGraphPassSchedule
+	{
+		/// Queue pass is submitted to. GRAPHICS or COMPUTE.
+		GPU::CommandQueueType queue_ = GPU::CommandQueueType::GRAPHICS;
+		/// Index of executed pass on the other queue that must complete first, -1 if none.
+		i32 waitPassIdx_ = -1;
+		/// Queue signals a fence after this pass for another queue to wait on.
+		bool signal_ = false;
+	};
+
+	/**
+	 * Render graph statistics.
+	 */
+	struct GRAPHICS_DLL RenderGraphStats
+	{
+		/// CPU time spent in setup (dependency resolution, scheduling, resource creation) by the last Execute.
+		f64 setupTime_ = 0.0;
+		/// Did the last Execute reuse the previous compiled graph?
+		bool setupCached_ = false;
+		/// GPU resources (buffers, textures, frame binding sets) created by setup in the last Execute.
+		i32 numSetupResourcesCreated_ = 0;
+		/// Total number of full compiles.
+		i32 numCompiles_ = 0;
+		/// Total number of compiles reused from a previous Execute.
+		i32 numCachedCompiles_ = 0;
+	};
+
 	class GRAPHICS_DLL RenderGraphBuilder final
 	{
 	public:
@@ -68,6 +99,14 @@ namespace Graphics
 		 */
 		RenderGraphResource SetDSV(RenderGraphResource res, GPU::BindingDSV binding = GPU::BindingDSV());
 
+		/**
+		 * Run this pass on the async compute queue.
+		 * Pass must only record commands that are valid on a compute queue (dispatch, copy, update).
+		 * Cross-queue dependencies are determined from reads & writes and synchronized with fences.
+		 * @param enable Enable async compute.
+		 */
+		void SetAsyncCompute(bool enable = true);
+
 		/**
 		 * @return Buffer desc from render graph.
 		 */
@@ -247,6 +286,8 @@ namespace Graphics
 		 * added, and cull any parts of the graph that are unconnected.
 		 * It will then create the appropriate resource,, then execute the render passes 
 		 * in the best order determined.
+		 * If the declared passes, resources and descs are identical to the previous Execute,
+		 * the previous compile result is reused and only the render passes are executed.
 		 * @param finalRes Final output resource for the graph. Will take newest version.
 		 * @return true if successful.
 		 */
@@ -264,6 +305,19 @@ namespace Graphics
 		 */
 		void GetExecutedRenderPasses(const RenderPass** renderPasses, const char** renderPassNames) const;
 
+		/**
+		 * Get queue schedule for executed render passes, in the same order as GetExecutedRenderPasses.
+		 * Passes also wait on the other queue for resources it used in previous executes. The graphics queue only
+		 * waits on compute at the end of Execute if the final resource was written on compute.
+		 * @pre schedule points to an array large enough for all executed render passes.
+		 */
+		void GetExecutedSchedule(RenderGraphPassSchedule* schedule) const;
+
+		/**
+		 * @return Statistics.
+		 */
+		const RenderGraphStats& GetStats() const;
+
 		/**
 		 * Get resource name.
 		 */
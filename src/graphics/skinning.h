@@ -0,0 +1,97 @@
+#pragma once
+
+#include "graphics/dll.h"
+#include "graphics/fwd_decls.h"
+#include "core/vector.h"
+#include "math/mat44.h"
+#include "math/vec3.h"
+
+namespace Graphics
+{
+	/**
+	 * Bones of any number of bone palettes, flattened so their skinning matrices can be computed in one pass.
+	 */
+	struct GRAPHICS_DLL SkinningBones
+	{
+		void Add(i32 nodeIdx, const Math::Mat44& inverseBindPose);
+		void Clear();
+		i32 Size() const { return nodeIndices_.size(); }
+
+		/// Node each bone is attached to.
+		Core::Vector<i32> nodeIndices_;
+		/// Inverse bind pose of each bone.
+		Core::Vector<Math::Mat44> inverseBindPoses_;
+	};
+
+	/**
+	 * Compute skinning matrices, inverse bind pose * node world transform, for all @a bones.
+	 * Split across job workers in batches of @a batchSize.
+	 * @param worlds World transforms, indexed by node.
+	 * @param outMatrices Skinning matrix for each bone. Resized to number of bones.
+	 */
+	GRAPHICS_DLL void ComputeSkinningMatrices(const SkinningBones& bones, const Math::Mat44* worlds,
+	    Core::Vector<Math::Mat44>& outMatrices, i32 batchSize = 1024);
+
+	/**
+	 * Compute skinning matrices for all @a bones, with nodes in @a hierarchy.
+	 * @pre @a hierarchy is up to date.
+	 */
+	GRAPHICS_DLL void ComputeSkinningMatrices(const SkinningBones& bones, const TransformHierarchy& hierarchy,
+	    Core::Vector<Math::Mat44>& outMatrices, i32 batchSize = 1024);
+
+	/**
+	 * Vertices to be skinned on the CPU, stored as structure of arrays.
+	 * Used for headless validation, and for platforms without compute.
+	 */
+	struct GRAPHICS_DLL SkinningVertices
+	{
+		static const i32 MAX_INFLUENCES = 4;
+
+		/**
+		 * Add vertex. Unused influences should have a weight of 0.
+		 * @param bones Index of each influencing bone in the matrices passed to SkinVertices.
+		 * @param weights Weight of each influence, should sum to 1.
+		 */
+		void Add(const Math::Vec3& position, const Math::Vec3& normal, const i32* bones, const f32* weights);
+		void Resize(i32 num);
+		void Clear();
+		i32 Size() const { return x_.size(); }
+
+		Core::Vector<f32> x_;
+		Core::Vector<f32> y_;
+		Core::Vector<f32> z_;
+		Core::Vector<f32> nx_;
+		Core::Vector<f32> ny_;
+		Core::Vector<f32> nz_;
+		Core::Vector<i32> bones_[MAX_INFLUENCES];
+		Core::Vector<f32> weights_[MAX_INFLUENCES];
+	};
+
+	/**
+	 * Skinned vertices, stored as structure of arrays.
+	 */
+	struct GRAPHICS_DLL SkinnedVertices
+	{
+		void Resize(i32 num);
+		i32 Size() const { return x_.size(); }
+
+		Core::Vector<f32> x_;
+		Core::Vector<f32> y_;
+		Core::Vector<f32> z_;
+		Core::Vector<f32> nx_;
+		Core::Vector<f32> ny_;
+		Core::Vector<f32> nz_;
+	};
+
+	/**
+	 * Skin @a vertices with linear blend skinning.
+	 * Each vertex's influencing matrices are blended, then applied to its position and normal.
+	 * Normals are not renormalised.
+	 * Split across job workers in batches of @a batchSize.
+	 * @param matrices Skinning matrices, indexed by SkinningVertices::bones_.
+	 * @param outVertices Skinned vertices. Resized to number of vertices.
+	 */
+	GRAPHICS_DLL void SkinVertices(const SkinningVertices& vertices, const Math::Mat44* matrices,
+	    SkinnedVertices& outVertices, i32 batchSize = 4096);
+
+} // namespace Graphics
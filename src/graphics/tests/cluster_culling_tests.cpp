@@ -0,0 +1,332 @@
+#include "catch.hpp"
+#include "core/vector.h"
+#include "graphics/cluster_culling.h"
+#include "graphics/culling.h"
+#include "graphics/converters/mesh_optimizer.h"
+#include "graphics/render_graph.h"
+#include "graphics/render_pass.h"
+#include "graphics/shader.h"
+#include "math/aabb.h"
+#include "math/mat44.h"
+#include "math/vec3.h"
+#include "test_shared.h"
+
+#include <cmath>
+
+namespace
+{
+	/// UV sphere of unit radius, with clockwise outward facing triangles.
+	void CreateSphere(i32 numRings, i32 numSegments, Core::Vector<Math::Vec3>& outPositions,
+	    Core::Vector<u32>& outIndices)
+	{
+		const f32 pi = 3.14159265f;
+		for(i32 ring = 0; ring <= numRings; ++ring)
+		{
+			const f32 theta = pi * (f32)ring / (f32)numRings;
+			for(i32 segment = 0; segment <= numSegments; ++segment)
+			{
+				const f32 phi = 2.0f * pi * (f32)segment / (f32)numSegments;
+				outPositions.push_back(
+				    Math::Vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+			}
+		}
+
+		for(i32 ring = 0; ring < numRings; ++ring)
+		{
+			for(i32 segment = 0; segment < numSegments; ++segment)
+			{
+				const u32 i00 = ring * (numSegments + 1) + segment;
+				const u32 i10 = i00 + 1;
+				const u32 i01 = i00 + numSegments + 1;
+				const u32 i11 = i01 + 1;
+				const u32 tris[6] = {i00, i10, i01, i10, i11, i01};
+				for(u32 index : tris)
+					outIndices.push_back(index);
+			}
+		}
+	}
+
+	struct SphereMesh
+	{
+		Graphics::ModelMeshDraw draw_;
+		Core::Vector<Graphics::ModelMeshlet> meshlets_;
+	};
+
+	/// Sphere mesh as if placed at @a vertexOffset & @a indexOffset in shared buffers.
+	SphereMesh CreateSphereMesh(i32 numRings, i32 vertexOffset, i32 indexOffset)
+	{
+		Core::Vector<Math::Vec3> positions;
+		Core::Vector<u32> indices;
+		CreateSphere(numRings, numRings, positions, indices);
+
+		SphereMesh mesh;
+		mesh.draw_.vertexOffset_ = vertexOffset;
+		mesh.draw_.indexOffset_ = indexOffset;
+		mesh.draw_.noofVertices_ = positions.size();
+		mesh.draw_.noofIndices_ = indices.size();
+		Graphics::BuildMeshlets(
+		    mesh.meshlets_, indices.data(), indices.size(), &positions[0].x, sizeof(Math::Vec3), positions.size());
+		return mesh;
+	}
+
+	Core::ArrayView<const Graphics::ModelMeshlet> GetMeshlets(const SphereMesh& mesh)
+	{
+		return Core::ArrayView<const Graphics::ModelMeshlet>(mesh.meshlets_.data(), mesh.meshlets_.size());
+	}
+
+	Math::Mat44 GetViewProj()
+	{
+		// Camera at origin looking down +z.
+		Math::Mat44 viewProj;
+		viewProj.PerspProjectionVertical(0.5f, 1.0f, 0.1f, 1000.0f);
+		return viewProj;
+	}
+
+	Math::Mat44 GetTranslation(const Math::Vec3& translation)
+	{
+		Math::Mat44 world;
+		world.Translation(translation);
+		return world;
+	}
+}
+
+TEST_CASE("cluster-culling-tests-layout")
+{
+	const SphereMesh sphereA = CreateSphereMesh(32, 0, 0);
+	const SphereMesh sphereB = CreateSphereMesh(16, sphereA.draw_.noofVertices_, sphereA.draw_.noofIndices_);
+	REQUIRE(sphereA.meshlets_.size() > sphereB.meshlets_.size());
+
+	Graphics::ClusterScene scene;
+	REQUIRE(scene.AddMesh(GPU::Handle(), sphereA.draw_, GetMeshlets(sphereA)) == 0);
+	REQUIRE(scene.AddMesh(GPU::Handle(), sphereB.draw_, GetMeshlets(sphereB)) == 1);
+	REQUIRE(scene.GetClusters().size() == (sphereA.meshlets_.size() + sphereB.meshlets_.size()));
+	REQUIRE(scene.GetMaxDrawArgs() == 0);
+	REQUIRE(scene.GetMaxInstanceClusters() == 0);
+
+	// Cluster index ranges are absolute.
+	const auto meshes = scene.GetMeshes();
+	const auto clusters = scene.GetClusters();
+	REQUIRE(meshes[1].baseCluster_ == sphereA.meshlets_.size());
+	for(i32 idx = 0; idx < sphereB.meshlets_.size(); ++idx)
+	{
+		const auto& cluster = clusters[meshes[1].baseCluster_ + idx];
+		REQUIRE(cluster.indexOffset_ == sphereB.draw_.indexOffset_ + sphereB.meshlets_[idx].indexOffset_);
+		REQUIRE(cluster.noofIndices_ == sphereB.meshlets_[idx].noofIndices_);
+		REQUIRE(cluster.radius_ == sphereB.meshlets_[idx].radius_);
+	}
+
+	// Draw argument ranges fit every cluster of every instance, without overlapping.
+	scene.AddInstance(1, Math::Mat44());
+	scene.AddInstance(0, Math::Mat44());
+	REQUIRE(scene.AddInstance(1, Math::Mat44()) == 2);
+	REQUIRE(scene.GetInstances().size() == 3);
+	REQUIRE(scene.GetMaxInstanceClusters() == sphereA.meshlets_.size());
+	REQUIRE(scene.GetMeshes()[0].baseDrawArg_ == 0);
+	REQUIRE(scene.GetMeshes()[0].maxDrawArgs_ == sphereA.meshlets_.size());
+	REQUIRE(scene.GetMeshes()[1].baseDrawArg_ == sphereA.meshlets_.size());
+	REQUIRE(scene.GetMeshes()[1].maxDrawArgs_ == sphereB.meshlets_.size() * 2);
+	REQUIRE(scene.GetMaxDrawArgs() == sphereA.meshlets_.size() + sphereB.meshlets_.size() * 2);
+
+	scene.ClearInstances();
+	REQUIRE(scene.GetInstances().size() == 0);
+	REQUIRE(scene.GetMaxDrawArgs() == 0);
+	REQUIRE(scene.GetMeshes()[1].maxDrawArgs_ == 0);
+	REQUIRE(scene.GetClusters().size() == clusters.size());
+}
+
+TEST_CASE("cluster-culling-tests-cull")
+{
+	const SphereMesh sphere = CreateSphereMesh(32, 100, 200);
+	const Math::Vec3 eye(0.0f, 0.0f, 0.0f);
+	const Math::Mat44 viewProj = GetViewProj();
+
+	Graphics::ClusterScene scene;
+	scene.AddMesh(GPU::Handle(), sphere.draw_, GetMeshlets(sphere));
+
+	// Inside frustum, partially outside, fully outside.
+	const Math::Vec3 translations[] = {
+	    Math::Vec3(0.0f, 0.0f, 5.0f), Math::Vec3(3.0f, 0.0f, 5.0f), Math::Vec3(0.0f, 0.0f, -5.0f)};
+	for(const auto& translation : translations)
+		scene.AddInstance(0, GetTranslation(translation));
+
+	Core::Vector<GPU::DrawIndexedIdArgs> drawArgs;
+	Core::Vector<u32> drawCounts;
+	const i32 numVisible = scene.Cull(viewProj, eye, true, nullptr, drawArgs, drawCounts);
+	REQUIRE(drawArgs.size() == scene.GetMaxDrawArgs());
+	REQUIRE(drawCounts.size() == 1);
+	REQUIRE(drawCounts[0] == numVisible);
+
+	// Matches culling each instance's meshlets in mesh space.
+	i32 argIdx = 0;
+	i32 numInstanceVisible[3] = {};
+	for(i32 instanceIdx = 0; instanceIdx < 3; ++instanceIdx)
+	{
+		const Math::Mat44 world = GetTranslation(translations[instanceIdx]);
+		Math::Mat44 invWorld = world;
+		invWorld.Inverse();
+
+		Core::Vector<i32> visible;
+		Graphics::CullMeshlets(Graphics::CullingFrustum(world * viewProj), eye * invWorld, sphere.meshlets_.data(),
+		    sphere.meshlets_.size(), visible);
+		numInstanceVisible[instanceIdx] = visible.size();
+
+		for(i32 meshletIdx : visible)
+		{
+			const auto& meshlet = sphere.meshlets_[meshletIdx];
+			const auto& args = drawArgs[argIdx++];
+			REQUIRE(args.drawId_ == instanceIdx);
+			REQUIRE(args.args_.indexCountPerInstance_ == meshlet.noofIndices_);
+			REQUIRE(args.args_.instanceCount_ == 1);
+			REQUIRE(args.args_.startVertexLocation_ == sphere.draw_.indexOffset_ + meshlet.indexOffset_);
+			REQUIRE(args.args_.baseVertexLocation_ == sphere.draw_.vertexOffset_);
+		}
+	}
+	REQUIRE(argIdx == numVisible);
+
+	// Back faces of the visible sphere are culled, and more clusters are culled partially outside the frustum.
+	REQUIRE(numInstanceVisible[0] > 0);
+	REQUIRE(numInstanceVisible[0] < sphere.meshlets_.size());
+	REQUIRE(numInstanceVisible[1] < numInstanceVisible[0]);
+	REQUIRE(numInstanceVisible[2] == 0);
+
+	// Without backface culling, every cluster of the sphere in the frustum is visible.
+	scene.ClearInstances();
+	scene.AddInstance(0, GetTranslation(translations[0]));
+	REQUIRE(scene.Cull(viewProj, eye, false, nullptr, drawArgs, drawCounts) == sphere.meshlets_.size());
+}
+
+TEST_CASE("cluster-culling-tests-occlusion")
+{
+	const SphereMesh sphere = CreateSphereMesh(16, 0, 0);
+	const Math::Mat44 viewProj = GetViewProj();
+
+	Graphics::OcclusionBuffer occlusion(256, 128);
+	occlusion.Begin(viewProj);
+	occlusion.AddOccluder(Math::AABB(Math::Vec3(-10.0f, -10.0f, 20.0f), Math::Vec3(10.0f, 10.0f, 21.0f)));
+	occlusion.End();
+
+	Graphics::ClusterScene scene;
+	scene.AddMesh(GPU::Handle(), sphere.draw_, GetMeshlets(sphere));
+	scene.AddMesh(GPU::Handle(), sphere.draw_, GetMeshlets(sphere));
+	// In front of occluder.
+	scene.AddInstance(0, GetTranslation(Math::Vec3(0.0f, 0.0f, 10.0f)));
+	// Behind occluder.
+	scene.AddInstance(1, GetTranslation(Math::Vec3(0.0f, 0.0f, 50.0f)));
+
+	Core::Vector<GPU::DrawIndexedIdArgs> drawArgs;
+	Core::Vector<u32> drawCounts;
+	const Math::Vec3 eye(0.0f, 0.0f, 0.0f);
+	scene.Cull(viewProj, eye, false, nullptr, drawArgs, drawCounts);
+	REQUIRE(drawCounts[0] == sphere.meshlets_.size());
+	REQUIRE(drawCounts[1] == sphere.meshlets_.size());
+
+	scene.Cull(viewProj, eye, false, &occlusion, drawArgs, drawCounts);
+	REQUIRE(drawCounts[0] == sphere.meshlets_.size());
+	REQUIRE(drawCounts[1] == 0);
+}
+
+TEST_CASE("cluster-culling-tests-render-graph")
+{
+	ScopedEngine engine("NULL");
+
+	Graphics::Shader* shader = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(shader, "shaders/cluster_culling.esf"));
+	Resource::Manager::WaitForResource(shader);
+
+	const SphereMesh sphere0 = CreateSphereMesh(16, 0, 0);
+	const SphereMesh sphere1 = CreateSphereMesh(8, sphere0.draw_.noofVertices_, sphere0.draw_.noofIndices_);
+
+	Graphics::ClusterScene scene;
+	scene.AddMesh(GPU::Handle(), sphere0.draw_, GetMeshlets(sphere0));
+	scene.AddMesh(GPU::Handle(), sphere1.draw_, GetMeshlets(sphere1));
+	for(i32 idx = 0; idx < 3; ++idx)
+		scene.AddInstance(0, GetTranslation(Math::Vec3((f32)idx, 0.0f, 5.0f)));
+	for(i32 idx = 0; idx < 2; ++idx)
+		scene.AddInstance(1, GetTranslation(Math::Vec3((f32)idx, 1.0f, 5.0f)));
+
+	Graphics::ClusterCullingSettings settings;
+	settings.viewProj_ = GetViewProj();
+
+	struct ConsumerData
+	{
+		Graphics::RenderGraphResource inTransforms_;
+		Graphics::RenderGraphResource inDrawArgs_;
+		Graphics::RenderGraphResource inDrawCounts_;
+		Graphics::RenderGraphResource outResult_;
+	};
+
+	// Outputs are created & written once by the culling pass, sized for the whole scene.
+	{
+		Graphics::RenderGraph graph;
+		const auto clusters = Graphics::AddClusterCullingPass(graph, scene, shader, settings);
+		REQUIRE(clusters.outTransforms_);
+		REQUIRE(clusters.outDrawArgs_);
+		REQUIRE(clusters.outDrawCounts_);
+		REQUIRE(clusters.outTransforms_.version_ == 1);
+		REQUIRE(clusters.outDrawArgs_.version_ == 1);
+		REQUIRE(clusters.outDrawCounts_.version_ == 1);
+
+		const char* name = nullptr;
+		graph.GetResourceName(clusters.outDrawArgs_, &name);
+		REQUIRE(strcmp(name, "Cluster Culling Draw Args") == 0);
+
+		Graphics::RenderGraphBufferDesc transformsDesc;
+		Graphics::RenderGraphBufferDesc drawArgsDesc;
+		Graphics::RenderGraphBufferDesc drawCountsDesc;
+		REQUIRE(graph.GetBuffer(clusters.outTransforms_, &transformsDesc));
+		REQUIRE(graph.GetBuffer(clusters.outDrawArgs_, &drawArgsDesc));
+		REQUIRE(graph.GetBuffer(clusters.outDrawCounts_, &drawCountsDesc));
+		REQUIRE(transformsDesc.size_ == scene.GetInstances().size() * sizeof(Math::Mat44));
+		REQUIRE(drawArgsDesc.size_ == scene.GetMaxDrawArgs() * sizeof(GPU::DrawIndexedIdArgs));
+		REQUIRE(drawCountsDesc.size_ == scene.GetMeshes().size() * sizeof(u32));
+		REQUIRE(scene.GetMaxDrawArgs() == 3 * sphere0.meshlets_.size() + 2 * sphere1.meshlets_.size());
+
+		REQUIRE(Core::ContainsAllFlags(transformsDesc.bindFlags_, GPU::BindFlags::SHADER_RESOURCE));
+		REQUIRE(Core::ContainsAllFlags(drawArgsDesc.bindFlags_, GPU::BindFlags::UNORDERED_ACCESS));
+		REQUIRE(Core::ContainsAllFlags(drawCountsDesc.bindFlags_, GPU::BindFlags::UNORDERED_ACCESS));
+		REQUIRE(!Core::ContainsAnyFlags(drawArgsDesc.bindFlags_, GPU::BindFlags::INDIRECT_BUFFER));
+
+		// Consumer reading culling outputs the way the mesh passes do adds the indirect bind flag,
+		// and both passes execute in order.
+		const auto& consumer = graph.AddCallbackRenderPass<ConsumerData>("Cluster Consumer",
+		    [&](Graphics::RenderGraphBuilder& builder, ConsumerData& data) {
+			    data.inTransforms_ = builder.Read(clusters.outTransforms_, GPU::BindFlags::SHADER_RESOURCE);
+			    data.inDrawArgs_ = builder.Read(clusters.outDrawArgs_, GPU::BindFlags::INDIRECT_BUFFER);
+			    data.inDrawCounts_ = builder.Read(clusters.outDrawCounts_, GPU::BindFlags::INDIRECT_BUFFER);
+			    data.outResult_ = builder.Write(
+			        builder.Create("Cluster Consumer Result", Graphics::RenderGraphBufferDesc(sizeof(u32))),
+			        GPU::BindFlags::UNORDERED_ACCESS);
+		    },
+		    [](Graphics::RenderGraphResources& res, GPU::CommandList& cmdList, const ConsumerData& data) {});
+		REQUIRE(graph.GetBuffer(clusters.outDrawArgs_, &drawArgsDesc));
+		REQUIRE(graph.GetBuffer(clusters.outDrawCounts_, &drawCountsDesc));
+		REQUIRE(Core::ContainsAllFlags(
+		    drawArgsDesc.bindFlags_, GPU::BindFlags::UNORDERED_ACCESS | GPU::BindFlags::INDIRECT_BUFFER));
+		REQUIRE(Core::ContainsAllFlags(
+		    drawCountsDesc.bindFlags_, GPU::BindFlags::UNORDERED_ACCESS | GPU::BindFlags::INDIRECT_BUFFER));
+
+		REQUIRE(graph.Execute(consumer.GetData().outResult_));
+		const i32 numPasses = graph.GetNumExecutedRenderPasses();
+		REQUIRE(numPasses == 2);
+		const char* names[2] = {};
+		graph.GetExecutedRenderPasses(nullptr, names);
+		REQUIRE(strcmp(names[0], settings.name_) == 0);
+		REQUIRE(strcmp(names[1], "Cluster Consumer") == 0);
+	}
+
+	// Empty scene keeps one element per buffer, so descs stay valid.
+	{
+		Graphics::ClusterScene emptyScene;
+		Graphics::RenderGraph graph;
+		const auto clusters = Graphics::AddClusterCullingPass(graph, emptyScene, shader, settings);
+
+		Graphics::RenderGraphBufferDesc drawArgsDesc;
+		Graphics::RenderGraphBufferDesc drawCountsDesc;
+		REQUIRE(graph.GetBuffer(clusters.outDrawArgs_, &drawArgsDesc));
+		REQUIRE(graph.GetBuffer(clusters.outDrawCounts_, &drawCountsDesc));
+		REQUIRE(drawArgsDesc.size_ == sizeof(GPU::DrawIndexedIdArgs));
+		REQUIRE(drawCountsDesc.size_ == sizeof(u32));
+	}
+
+	REQUIRE(Resource::Manager::ReleaseResource(shader));
+}
@@ -8,6 +8,16 @@ TEST_CASE("graphics-tests-converter-model")
 	Graphics::Model* model = nullptr;
 	REQUIRE(Resource::Manager::RequestResource(model, "model_tests/teapot.obj"));
 	Resource::Manager::WaitForResource(model);
+
+	// Meshlets cover all of each mesh's triangles.
+	for(i32 idx = 0; idx < model->GetNumMeshes(); ++idx)
+	{
+		i32 numIndices = 0;
+		for(const auto& meshlet : model->GetMeshMeshlets(idx))
+			numIndices += meshlet.noofIndices_;
+		REQUIRE(numIndices == model->GetMeshDraw(idx).noofIndices_);
+	}
+
 	REQUIRE(Resource::Manager::ReleaseResource(model));
 }
 
@@ -0,0 +1,196 @@
+#include "catch.hpp"
+#include "core/concurrency.h"
+#include "core/misc.h"
+#include "core/random.h"
+#include "core/timer.h"
+#include "graphics/culling.h"
+#include "job/manager.h"
+
+namespace
+{
+	f32 RandomFloat(Core::Random& rng, f32 min, f32 max)
+	{
+		return min + ((f32)(rng.Generate() & 0xffff) / 65535.0f) * (max - min);
+	}
+
+	Math::Mat44 GetViewProj()
+	{
+		// Camera at origin looking down +z.
+		Math::Mat44 viewProj;
+		viewProj.PerspProjectionVertical(0.5f, 1.0f, 0.1f, 1000.0f);
+		return viewProj;
+	}
+
+	void CreateBoxes(i32 num, Graphics::CullingBoxes& outBoxes, Graphics::CullingSpheres& outSpheres)
+	{
+		Core::Random rng;
+		for(i32 idx = 0; idx < num; ++idx)
+		{
+			const Math::Vec3 center(RandomFloat(rng, -500.0f, 500.0f), RandomFloat(rng, -500.0f, 500.0f),
+			    RandomFloat(rng, -100.0f, 900.0f));
+			const Math::Vec3 extents(RandomFloat(rng, 0.1f, 10.0f), RandomFloat(rng, 0.1f, 10.0f),
+			    RandomFloat(rng, 0.1f, 10.0f));
+			outBoxes.Add(Math::AABB(center - extents, center + extents));
+			outSpheres.Add(center, extents.Magnitude());
+		}
+	}
+
+	/// Reference test: outside if all corners are outside of any plane.
+	bool IsBoxVisible(const Graphics::CullingFrustum& frustum, const Math::AABB& aabb)
+	{
+		for(const auto& plane : frustum.planes_)
+		{
+			bool allOutside = true;
+			for(u32 idx = 0; idx < 8 && allOutside; ++idx)
+			{
+				const Math::Vec3 corner = aabb.Corner(idx);
+				allOutside = (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w) < 0.0f;
+			}
+			if(allOutside)
+				return false;
+		}
+		return true;
+	}
+
+	bool IsSphereVisible(const Graphics::CullingFrustum& frustum, const Math::Vec3& center, f32 radius)
+	{
+		for(const auto& plane : frustum.planes_)
+			if((plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w) < -radius)
+				return false;
+		return true;
+	}
+
+	void CheckFrustumCulling(i32 batchSize)
+	{
+		Graphics::CullingBoxes boxes;
+		Graphics::CullingSpheres spheres;
+		CreateBoxes(10007, boxes, spheres);
+
+		const Graphics::CullingFrustum frustum(GetViewProj());
+		Graphics::CullingParams params;
+		params.batchSize_ = batchSize;
+
+		Core::Vector<i32> expected;
+		for(i32 idx = 0; idx < boxes.Size(); ++idx)
+		{
+			const Math::AABB aabb(Math::Vec3(boxes.minX_[idx], boxes.minY_[idx], boxes.minZ_[idx]),
+			    Math::Vec3(boxes.maxX_[idx], boxes.maxY_[idx], boxes.maxZ_[idx]));
+			if(IsBoxVisible(frustum, aabb))
+				expected.push_back(idx);
+		}
+		REQUIRE(expected.size() > 0);
+		REQUIRE(expected.size() < boxes.Size());
+
+		Core::Vector<i32> visible;
+		REQUIRE(Graphics::CullBoxes(frustum, boxes, visible, params) == expected.size());
+		REQUIRE(visible.size() == expected.size());
+		for(i32 idx = 0; idx < visible.size(); ++idx)
+			REQUIRE(visible[idx] == expected[idx]);
+
+		expected.clear();
+		for(i32 idx = 0; idx < spheres.Size(); ++idx)
+		{
+			const Math::Vec3 center(spheres.x_[idx], spheres.y_[idx], spheres.z_[idx]);
+			if(IsSphereVisible(frustum, center, spheres.radius_[idx]))
+				expected.push_back(idx);
+		}
+
+		REQUIRE(Graphics::CullSpheres(frustum, spheres, visible, params) == expected.size());
+		REQUIRE(visible.size() == expected.size());
+		for(i32 idx = 0; idx < visible.size(); ++idx)
+			REQUIRE(visible[idx] == expected[idx]);
+	}
+}
+
+TEST_CASE("culling-tests-frustum-st")
+{
+	CheckFrustumCulling(1);
+	CheckFrustumCulling(256);
+	CheckFrustumCulling(4096);
+}
+
+TEST_CASE("culling-tests-frustum-mt")
+{
+	Job::Manager::Scoped jobManager(4, 256, 32 * 1024);
+	CheckFrustumCulling(1);
+	CheckFrustumCulling(256);
+	CheckFrustumCulling(4096);
+}
+
+TEST_CASE("culling-tests-occlusion")
+{
+	const Math::Mat44 viewProj = GetViewProj();
+	Graphics::OcclusionBuffer occlusion(256, 128);
+	occlusion.Begin(viewProj);
+	occlusion.AddOccluder(Math::AABB(Math::Vec3(-10.0f, -10.0f, 20.0f), Math::Vec3(10.0f, 10.0f, 21.0f)));
+	occlusion.End();
+
+	REQUIRE(occlusion.GetDepth(128, 64) < 1.0f);
+	REQUIRE(occlusion.GetDepth(0, 0) == 1.0f);
+
+	Graphics::CullingBoxes boxes;
+	// Behind occluder.
+	boxes.Add(Math::AABB(Math::Vec3(-1.0f, -1.0f, 50.0f), Math::Vec3(1.0f, 1.0f, 51.0f)));
+	// In front of occluder.
+	boxes.Add(Math::AABB(Math::Vec3(-1.0f, -1.0f, 5.0f), Math::Vec3(1.0f, 1.0f, 6.0f)));
+	// Beside occluder.
+	boxes.Add(Math::AABB(Math::Vec3(25.0f, -1.0f, 50.0f), Math::Vec3(26.0f, 1.0f, 51.0f)));
+	// Partially behind occluder.
+	boxes.Add(Math::AABB(Math::Vec3(8.0f, -1.0f, 30.0f), Math::Vec3(20.0f, 1.0f, 31.0f)));
+	// Intersecting occluder.
+	boxes.Add(Math::AABB(Math::Vec3(-1.0f, -1.0f, 19.0f), Math::Vec3(1.0f, 1.0f, 22.0f)));
+	// Crossing near plane.
+	boxes.Add(Math::AABB(Math::Vec3(-1.0f, -1.0f, -1.0f), Math::Vec3(1.0f, 1.0f, 1.0f)));
+
+	for(i32 idx = 0; idx < boxes.Size(); ++idx)
+	{
+		const Math::AABB aabb(Math::Vec3(boxes.minX_[idx], boxes.minY_[idx], boxes.minZ_[idx]),
+		    Math::Vec3(boxes.maxX_[idx], boxes.maxY_[idx], boxes.maxZ_[idx]));
+		REQUIRE(occlusion.IsVisible(aabb) == (idx != 0));
+	}
+
+	Graphics::CullingParams params;
+	params.occlusion_ = &occlusion;
+	Core::Vector<i32> visible;
+	REQUIRE(Graphics::CullBoxes(Graphics::CullingFrustum(viewProj), boxes, visible, params) == 5);
+	REQUIRE(visible[0] == 1);
+
+	// Cleared buffer occludes nothing.
+	occlusion.Begin(viewProj);
+	occlusion.End();
+	REQUIRE(Graphics::CullBoxes(Graphics::CullingFrustum(viewProj), boxes, visible, params) == 6);
+}
+
+TEST_CASE("culling-tests-benchmark")
+{
+	const i32 NUM_BOXES = 128 * 1024;
+	const i32 NUM_ITERATIONS = 16;
+
+	Graphics::CullingBoxes boxes;
+	Graphics::CullingSpheres spheres;
+	CreateBoxes(NUM_BOXES, boxes, spheres);
+
+	const Graphics::CullingFrustum frustum(GetViewProj());
+	Core::Vector<i32> visible;
+
+	auto Measure = [&](const char* name) {
+		Core::Timer timer;
+		timer.Mark();
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+			Graphics::CullBoxes(frustum, boxes, visible);
+		const f64 boxTime = timer.GetTime() / NUM_ITERATIONS;
+
+		timer.Mark();
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+			Graphics::CullSpheres(frustum, spheres, visible);
+		const f64 sphereTime = timer.GetTime() / NUM_ITERATIONS;
+
+		Core::Log("Culling %d bounds (%s): boxes %.3f ms, spheres %.3f ms\n", NUM_BOXES, name, boxTime * 1000.0,
+		    sphereTime * 1000.0);
+	};
+
+	Measure("single threaded");
+
+	Job::Manager::Scoped jobManager(Core::GetNumLogicalCores(), 256, 32 * 1024);
+	Measure("job workers");
+}
@@ -0,0 +1,296 @@
+#include "catch.hpp"
+#include "core/random.h"
+#include "core/vector.h"
+#include "graphics/culling.h"
+#include "graphics/converters/mesh_optimizer.h"
+#include "math/vec3.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/// Grid of quads with triangles in random order, as a worst case for the vertex cache.
+	void CreateGrid(i32 size, Core::Vector<Math::Vec3>& outPositions, Core::Vector<u32>& outIndices)
+	{
+		for(i32 y = 0; y <= size; ++y)
+			for(i32 x = 0; x <= size; ++x)
+				outPositions.push_back(Math::Vec3((f32)x, (f32)y, 0.0f));
+
+		Core::Vector<u32> quads;
+		for(i32 y = 0; y < size; ++y)
+		{
+			for(i32 x = 0; x < size; ++x)
+			{
+				const u32 i00 = y * (size + 1) + x;
+				const u32 i10 = i00 + 1;
+				const u32 i01 = i00 + size + 1;
+				const u32 i11 = i01 + 1;
+				const u32 tris[6] = {i00, i01, i10, i10, i01, i11};
+				for(u32 index : tris)
+					outIndices.push_back(index);
+			}
+		}
+
+		Core::Random rng;
+		const i32 numTris = outIndices.size() / 3;
+		for(i32 idx = numTris - 1; idx > 0; --idx)
+		{
+			const i32 other = (i32)((u32)rng.Generate() % (u32)(idx + 1));
+			for(i32 corner = 0; corner < 3; ++corner)
+				std::swap(outIndices[idx * 3 + corner], outIndices[other * 3 + corner]);
+		}
+	}
+
+	/// UV sphere of unit radius, with clockwise outward facing triangles.
+	void CreateSphere(i32 numRings, i32 numSegments, Core::Vector<Math::Vec3>& outPositions,
+	    Core::Vector<u32>& outIndices)
+	{
+		const f32 pi = 3.14159265f;
+		for(i32 ring = 0; ring <= numRings; ++ring)
+		{
+			const f32 theta = pi * (f32)ring / (f32)numRings;
+			for(i32 segment = 0; segment <= numSegments; ++segment)
+			{
+				const f32 phi = 2.0f * pi * (f32)segment / (f32)numSegments;
+				outPositions.push_back(
+				    Math::Vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+			}
+		}
+
+		for(i32 ring = 0; ring < numRings; ++ring)
+		{
+			for(i32 segment = 0; segment < numSegments; ++segment)
+			{
+				const u32 i00 = ring * (numSegments + 1) + segment;
+				const u32 i10 = i00 + 1;
+				const u32 i01 = i00 + numSegments + 1;
+				const u32 i11 = i01 + 1;
+				const u32 tris[6] = {i00, i10, i01, i10, i11, i01};
+				for(u32 index : tris)
+					outIndices.push_back(index);
+			}
+		}
+	}
+
+	/// @return true if @a a and @a b contain the same triangles, in any order.
+	bool SameTriangles(const Core::Vector<u32>& a, const Core::Vector<u32>& b)
+	{
+		auto GetTriangles = [](const Core::Vector<u32>& indices) {
+			Core::Vector<u64> tris;
+			for(i32 idx = 0; idx < indices.size(); idx += 3)
+				tris.push_back(((u64)indices[idx] << 42) | ((u64)indices[idx + 1] << 21) | (u64)indices[idx + 2]);
+			std::sort(tris.begin(), tris.end());
+			return tris;
+		};
+
+		const Core::Vector<u64> trisA = GetTriangles(a);
+		const Core::Vector<u64> trisB = GetTriangles(b);
+		return trisA.size() == trisB.size() && std::equal(trisA.begin(), trisA.end(), trisB.begin());
+	}
+}
+
+TEST_CASE("mesh-optimizer-tests-analyze")
+{
+	// Single triangle, all vertices miss.
+	const u32 tri[3] = {0, 1, 2};
+	auto stats = Graphics::AnalyzeVertexCache(tri, 3, 3);
+	REQUIRE(stats.acmr_ == 3.0f);
+	REQUIRE(stats.atvr_ == 1.0f);
+
+	// Quad, 4 vertices for 2 triangles.
+	const u32 quad[6] = {0, 1, 2, 2, 1, 3};
+	stats = Graphics::AnalyzeVertexCache(quad, 6, 4);
+	REQUIRE(stats.acmr_ == 2.0f);
+	REQUIRE(stats.atvr_ == 1.0f);
+
+	// Same triangle twice with a cache of 3 hits, but not with a cache of 2.
+	const u32 twice[6] = {0, 1, 2, 0, 1, 2};
+	REQUIRE(Graphics::AnalyzeVertexCache(twice, 6, 3, 3).acmr_ == 1.5f);
+	REQUIRE(Graphics::AnalyzeVertexCache(twice, 6, 3, 2).acmr_ == 3.0f);
+}
+
+TEST_CASE("mesh-optimizer-tests-vertex-cache")
+{
+	Core::Vector<Math::Vec3> positions;
+	Core::Vector<u32> indices;
+	CreateGrid(64, positions, indices);
+
+	Core::Vector<u32> optimized;
+	optimized.resize(indices.size());
+	Graphics::OptimizeVertexCache(optimized.data(), indices.data(), indices.size(), positions.size());
+	REQUIRE(SameTriangles(optimized, indices));
+
+	const auto before = Graphics::AnalyzeVertexCache(indices.data(), indices.size(), positions.size());
+	const auto after = Graphics::AnalyzeVertexCache(optimized.data(), optimized.size(), positions.size());
+	REQUIRE(before.acmr_ > 2.0f);
+	REQUIRE(after.acmr_ < 0.8f);
+	REQUIRE(after.atvr_ < 1.6f);
+}
+
+TEST_CASE("mesh-optimizer-tests-overdraw")
+{
+	Core::Vector<Math::Vec3> positions;
+	Core::Vector<u32> indices;
+	CreateGrid(64, positions, indices);
+
+	Core::Vector<u32> cacheOptimized;
+	cacheOptimized.resize(indices.size());
+	Graphics::OptimizeVertexCache(cacheOptimized.data(), indices.data(), indices.size(), positions.size());
+
+	const f32 threshold = 1.05f;
+	Core::Vector<u32> optimized;
+	optimized.resize(indices.size());
+	Graphics::OptimizeOverdraw(optimized.data(), cacheOptimized.data(), indices.size(), &positions[0].x,
+	    sizeof(Math::Vec3), positions.size(), 16, threshold);
+	REQUIRE(SameTriangles(optimized, indices));
+
+	const auto before = Graphics::AnalyzeVertexCache(cacheOptimized.data(), indices.size(), positions.size());
+	const auto after = Graphics::AnalyzeVertexCache(optimized.data(), indices.size(), positions.size());
+	REQUIRE(after.acmr_ <= before.acmr_ * threshold);
+}
+
+TEST_CASE("mesh-optimizer-tests-vertex-fetch")
+{
+	Core::Vector<Math::Vec3> positions;
+	Core::Vector<u32> indices;
+	CreateGrid(16, positions, indices);
+
+	// Unreferenced vertex.
+	positions.push_back(Math::Vec3(-1.0f, -1.0f, -1.0f));
+
+	Core::Vector<u32> remap;
+	remap.resize(positions.size());
+	REQUIRE(Graphics::OptimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), positions.size()) ==
+	        positions.size() - 1);
+	REQUIRE(remap.back() == positions.size() - 1);
+
+	Core::Vector<u32> remapped(indices);
+	Graphics::RemapIndices(remapped.data(), remapped.size(), remap.data());
+
+	Core::Vector<Math::Vec3> remappedPositions;
+	remappedPositions.resize(positions.size());
+	Graphics::RemapVertices(
+	    remappedPositions.data(), positions.data(), positions.size(), sizeof(Math::Vec3), remap.data());
+
+	// Vertices are in order of first use, and still describe the same triangles.
+	u32 nextNew = 0;
+	for(i32 idx = 0; idx < indices.size(); ++idx)
+	{
+		REQUIRE(remapped[idx] <= nextNew);
+		if(remapped[idx] == nextNew)
+			++nextNew;
+		REQUIRE(remappedPositions[remapped[idx]] == positions[indices[idx]]);
+	}
+	REQUIRE(remappedPositions.back() == positions.back());
+}
+
+TEST_CASE("mesh-optimizer-tests-meshlets")
+{
+	Core::Vector<Math::Vec3> positions;
+	Core::Vector<u32> indices;
+	CreateSphere(64, 64, positions, indices);
+
+	Core::Vector<u32> optimized;
+	optimized.resize(indices.size());
+	Graphics::OptimizeVertexCache(optimized.data(), indices.data(), indices.size(), positions.size());
+
+	const i32 maxVertices = 64;
+	const i32 maxTriangles = 124;
+	Core::Vector<Graphics::ModelMeshlet> meshlets;
+	const i32 numMeshlets = Graphics::BuildMeshlets(meshlets, optimized.data(), optimized.size(), &positions[0].x,
+	    sizeof(Math::Vec3), positions.size(), maxVertices, maxTriangles);
+	REQUIRE(numMeshlets == meshlets.size());
+	REQUIRE(numMeshlets >= (optimized.size() / 3 + maxTriangles - 1) / maxTriangles);
+
+	// Meshlets cover all triangles in order, within limits and bounds.
+	i32 indexOffset = 0;
+	for(const auto& meshlet : meshlets)
+	{
+		REQUIRE(meshlet.indexOffset_ == indexOffset);
+		REQUIRE(meshlet.noofIndices_ > 0);
+		REQUIRE(meshlet.noofIndices_ <= maxTriangles * 3);
+		indexOffset += meshlet.noofIndices_;
+
+		Core::Vector<u32> vertices;
+		vertices.insert(optimized.begin() + meshlet.indexOffset_,
+		    optimized.begin() + meshlet.indexOffset_ + meshlet.noofIndices_);
+		std::sort(vertices.begin(), vertices.end());
+		REQUIRE((std::unique(vertices.begin(), vertices.end()) - vertices.begin()) <= maxVertices);
+
+		for(u32 vertexIdx : vertices)
+			REQUIRE((positions[vertexIdx] - meshlet.center_).Magnitude() <= meshlet.radius_ + 1e-5f);
+	}
+	REQUIRE(indexOffset == optimized.size());
+
+	// Backfacing meshlets must have no front facing triangles, from any eye position.
+	Core::Random rng;
+	i32 numBackfacing = 0;
+	for(i32 eyeIdx = 0; eyeIdx < 64; ++eyeIdx)
+	{
+		auto RandomCoord = [&rng]() { return ((f32)(rng.Generate() & 0xffff) / 65535.0f) * 8.0f - 4.0f; };
+		const Math::Vec3 eye(RandomCoord(), RandomCoord(), RandomCoord());
+		for(const auto& meshlet : meshlets)
+		{
+			if(!Graphics::IsMeshletBackfacing(meshlet, eye))
+				continue;
+			++numBackfacing;
+
+			for(i32 idx = meshlet.indexOffset_; idx < meshlet.indexOffset_ + meshlet.noofIndices_; idx += 3)
+			{
+				const Math::Vec3 a = positions[optimized[idx]];
+				const Math::Vec3 b = positions[optimized[idx + 1]];
+				const Math::Vec3 c = positions[optimized[idx + 2]];
+				const Math::Vec3 normal = (b - a).Cross(c - a);
+				REQUIRE(normal.Dot(a - eye) >= -1e-5f);
+			}
+		}
+	}
+	REQUIRE(numBackfacing > 0);
+
+	// Eye at the centre of an outward facing sphere only sees back faces.
+	Core::Vector<i32> visible;
+	Graphics::CullingFrustum frustum;
+	for(auto& plane : frustum.planes_)
+		plane = Math::Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	Graphics::CullMeshlets(frustum, Math::Vec3(0.0f, 0.0f, 0.0f), meshlets.data(), meshlets.size(), visible);
+	REQUIRE(visible.size() < meshlets.size());
+}
+
+TEST_CASE("mesh-optimizer-tests-vertex-encoding")
+{
+	Core::Vector<Math::Vec3> positions;
+	Core::Vector<u32> indices;
+	CreateSphere(16, 16, positions, indices);
+
+	// Octahedral round trip, with 16 bit SNORM precision.
+	Core::Vector<f32> encoded;
+	encoded.resize(positions.size() * 2);
+	Graphics::EncodeOctahedral(encoded.data(), &positions[0].x, sizeof(Math::Vec3), positions.size());
+	for(f32& value : encoded)
+	{
+		REQUIRE(value >= -1.0f);
+		REQUIRE(value <= 1.0f);
+		value = std::round(value * 32767.0f) / 32767.0f;
+	}
+
+	Core::Vector<Math::Vec3> decoded;
+	decoded.resize(positions.size());
+	Graphics::DecodeOctahedral(&decoded[0].x, encoded.data(), positions.size());
+	for(i32 idx = 0; idx < positions.size(); ++idx)
+		REQUIRE(decoded[idx].Dot(positions[idx].Normal()) > 0.99999f);
+
+	// Quantized positions are in [0, 1] relative to bounds, and flat axes encode as 0.
+	const f32 boundsMin[3] = {-1.0f, -1.0f, 0.0f};
+	const f32 boundsMax[3] = {1.0f, 1.0f, 0.0f};
+	Core::Vector<f32> quantized;
+	quantized.resize(positions.size() * 3);
+	Graphics::QuantizePositions(
+	    quantized.data(), &positions[0].x, sizeof(Math::Vec3), positions.size(), boundsMin, boundsMax);
+	for(i32 idx = 0; idx < positions.size(); ++idx)
+	{
+		REQUIRE(std::abs(quantized[idx * 3] - (positions[idx].x * 0.5f + 0.5f)) < 1e-6f);
+		REQUIRE(std::abs(quantized[idx * 3 + 1] - (positions[idx].y * 0.5f + 0.5f)) < 1e-6f);
+		REQUIRE(quantized[idx * 3 + 2] == 0.0f);
+	}
+}
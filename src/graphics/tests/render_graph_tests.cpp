@@ -231,6 +231,33 @@ namespace
 		};
 
 
+		class RenderPassAsyncSSAO : public Graphics::RenderPass
+		{
+		public:
+			RenderPassAsyncSSAO(
+			    Graphics::RenderGraphBuilder& builder, DebugData& debugData, Graphics::RenderGraphResource depth)
+			    : Graphics::RenderPass(builder)
+			    , debugData_(debugData)
+			{
+				builder.SetAsyncCompute();
+				depth_ = builder.Read(depth, GPU::BindFlags::SHADER_RESOURCE);
+				ssao_ = builder.Write(builder.Create("SSAO", GetSSAOTextureDesc()), GPU::BindFlags::UNORDERED_ACCESS);
+			};
+
+			virtual ~RenderPassAsyncSSAO() {}
+			void Execute(Graphics::RenderGraphResources& res, GPU::CommandList& cmdList) override
+			{
+				debugData_.AddPass("RenderPassAsyncSSAO");
+			}
+
+			DebugData& debugData_;
+
+			Graphics::RenderGraphResource depth_;
+
+			Graphics::RenderGraphResource ssao_;
+		};
+
+
 		class RenderPassLighting : public Graphics::RenderPass
 		{
 		public:
@@ -537,13 +564,13 @@ namespace
 
 TEST_CASE("render-graph-tests-construct")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 	Graphics::RenderGraph graph;
 }
 
 TEST_CASE("render-graph-tests-forward-simple")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 	Graphics::RenderGraph graph;
 
 	DebugData debugData;
@@ -559,7 +586,7 @@ TEST_CASE("render-graph-tests-forward-simple")
 
 TEST_CASE("render-graph-tests-forward-advanced")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 	Graphics::RenderGraph graph;
 
 	DebugData debugData;
@@ -580,7 +607,7 @@ TEST_CASE("render-graph-tests-forward-advanced")
 
 TEST_CASE("render-graph-tests-deferred-simple")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 	Graphics::RenderGraph graph;
 
 	DebugData debugData;
@@ -598,9 +625,118 @@ TEST_CASE("render-graph-tests-deferred-simple")
 	REQUIRE(debugData.HavePass("RenderPassLighting"));
 }
 
+TEST_CASE("render-graph-tests-async-compute")
+{
+	ScopedEngine engine("NULL");
+	Graphics::RenderGraph graph;
+
+	DebugData debugData;
+
+	auto& renderPassDepthPrepass = graph.AddRenderPass<Mock::RenderPassDepthPrepass>("Depth Prepass", debugData);
+	auto& renderPassSolid =
+	    graph.AddRenderPass<Mock::RenderPassSolid>("Solid", debugData, renderPassDepthPrepass.depth_);
+	auto& renderPassSSAO =
+	    graph.AddRenderPass<Mock::RenderPassAsyncSSAO>("Async SSAO", debugData, renderPassDepthPrepass.depth_);
+	auto& renderPassLighting =
+	    graph.AddRenderPass<Mock::RenderPassLighting>("Lighting", debugData, renderPassSolid.depth_,
+	        renderPassSolid.albedo_, renderPassSolid.material_, renderPassSolid.normal_, renderPassSSAO.ssao_);
+
+	REQUIRE(graph.Execute(renderPassLighting.hdr_));
+	REQUIRE(debugData.HavePass("RenderPassAsyncSSAO"));
+
+	const i32 numPasses = graph.GetNumExecutedRenderPasses();
+	REQUIRE(numPasses == 4);
+
+	Core::Vector<const char*> names(numPasses);
+	Core::Vector<Graphics::RenderGraphPassSchedule> schedule(numPasses);
+	graph.GetExecutedRenderPasses(nullptr, names.data());
+	graph.GetExecutedSchedule(schedule.data());
+
+	auto FindPass = [&](const char* name) {
+		for(i32 idx = 0; idx < numPasses; ++idx)
+			if(strcmp(names[idx], name) == 0)
+				return idx;
+		return -1;
+	};
+
+	const i32 depthIdx = FindPass("Depth Prepass");
+	const i32 solidIdx = FindPass("Solid");
+	const i32 ssaoIdx = FindPass("Async SSAO");
+	const i32 lightingIdx = FindPass("Lighting");
+	REQUIRE(depthIdx < ssaoIdx);
+	REQUIRE(ssaoIdx < lightingIdx);
+
+	// Only SSAO goes to the compute queue.
+	REQUIRE(schedule[depthIdx].queue_ == GPU::CommandQueueType::GRAPHICS);
+	REQUIRE(schedule[solidIdx].queue_ == GPU::CommandQueueType::GRAPHICS);
+	REQUIRE(schedule[ssaoIdx].queue_ == GPU::CommandQueueType::COMPUTE);
+	REQUIRE(schedule[lightingIdx].queue_ == GPU::CommandQueueType::GRAPHICS);
+
+	// SSAO waits on depth written by graphics, lighting waits on SSAO written by compute.
+	REQUIRE(schedule[ssaoIdx].waitPassIdx_ == depthIdx);
+	REQUIRE(schedule[depthIdx].signal_);
+	REQUIRE(schedule[lightingIdx].waitPassIdx_ == ssaoIdx);
+	REQUIRE(schedule[ssaoIdx].signal_);
+
+	// Same queue dependencies need no fences.
+	REQUIRE(schedule[depthIdx].waitPassIdx_ == -1);
+	REQUIRE(schedule[solidIdx].waitPassIdx_ == -1);
+	REQUIRE(!schedule[solidIdx].signal_);
+	REQUIRE(!schedule[lightingIdx].signal_);
+}
+
+TEST_CASE("render-graph-tests-cached-setup")
+{
+	ScopedEngine engine("NULL");
+	Graphics::RenderGraph graph;
+
+	DebugData debugData;
+
+	Graphics::RenderGraphResource hdrRes;
+	Graphics::RenderGraphResource depthRes;
+
+	// First execute has to do a full compile.
+	Mock::CreateDeferred(graph, debugData, hdrRes, depthRes);
+	REQUIRE(graph.Execute(hdrRes));
+	const auto compiledStats = graph.GetStats();
+	REQUIRE(!compiledStats.setupCached_);
+	REQUIRE(compiledStats.numCompiles_ == 1);
+	REQUIRE(compiledStats.numSetupResourcesCreated_ > 0);
+
+	// Same topology should reuse the compiled graph without creating any resources.
+	f64 cachedSetupTime = 0.0;
+	for(i32 frame = 0; frame < 8; ++frame)
+	{
+		graph.Clear();
+		debugData.passes_.clear();
+		Mock::CreateDeferred(graph, debugData, hdrRes, depthRes);
+		REQUIRE(graph.Execute(hdrRes));
+		REQUIRE(graph.GetStats().setupCached_);
+		REQUIRE(graph.GetStats().numSetupResourcesCreated_ == 0);
+		REQUIRE(debugData.passes_.size() == 4);
+		REQUIRE(graph.GetNumExecutedRenderPasses() == 4);
+		cachedSetupTime += graph.GetStats().setupTime_;
+	}
+	REQUIRE(graph.GetStats().numCompiles_ == 1);
+	REQUIRE(graph.GetStats().numCachedCompiles_ == 8);
+	Core::Log("render-graph-tests-cached-setup: Compiled setup %f ms, cached setup %f ms avg\n",
+	    compiledStats.setupTime_ * 1000.0, cachedSetupTime * 1000.0 / 8.0);
+
+	// Changed topology must recompile.
+	graph.Clear();
+	debugData.passes_.clear();
+	Graphics::RenderGraphResource colorRes;
+	Mock::CreateForward(graph, debugData, colorRes, depthRes);
+	REQUIRE(graph.Execute(colorRes));
+	REQUIRE(!graph.GetStats().setupCached_);
+	REQUIRE(graph.GetStats().numCompiles_ == 2);
+	REQUIRE(graph.GetStats().numSetupResourcesCreated_ > 0);
+	REQUIRE(debugData.HavePass("RenderPassHUD"));
+}
+
 TEST_CASE("render-graph-tests-pipeline-plugin")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 	ImGui::Manager::Scoped imgui;
 	Draw::ImGuiPipeline imguiPipeline;
 	Graphics::RenderGraph graph;
@@ -699,7 +835,7 @@ TEST_CASE("render-graph-tests-pipeline-plugin")
 
 TEST_CASE("render-graph-tests-draw-simple")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 	ImGui::Manager::Scoped imgui;
 	Draw::ImGuiPipeline imguiPipeline;
 	Graphics::RenderGraph graph;
@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include "core/file.h"
+#include "core/vector.h"
+
+#include "graphics/converters/shader_compile_cache.h"
+
+namespace
+{
+	const char* CACHE_PATH = "shader_compile_cache_tests";
+	const char* NAME = "shader_tests/00-basic.esf";
+	const char* SOURCE = "float4 vs_main(float4 pos : POSITION) : SV_POSITION { return pos; }";
+
+	void CheckBindings(const Core::Vector<Graphics::ShaderBinding>& a, const Core::Vector<Graphics::ShaderBinding>& b)
+	{
+		REQUIRE(a.size() == b.size());
+		for(i32 idx = 0; idx < a.size(); ++idx)
+		{
+			REQUIRE(a[idx].slot_ == b[idx].slot_);
+			REQUIRE(a[idx].name_ == b[idx].name_);
+		}
+	}
+}
+
+TEST_CASE("shader-compile-cache-tests-key")
+{
+	Graphics::ShaderCompileCache cache(CACHE_PATH, "compiler-1");
+	Graphics::ShaderCompileCache otherCache(CACHE_PATH, "compiler-2");
+
+	auto key = cache.GetKey(NAME, SOURCE, "vs_main", "vs_5_1");
+	auto SameKey = [&key](const Core::HashSHA1Digest& other) {
+		return memcmp(key.data8_, other.data8_, sizeof(key.data8_)) == 0;
+	};
+
+	REQUIRE(SameKey(cache.GetKey(NAME, SOURCE, "vs_main", "vs_5_1")));
+	REQUIRE(!SameKey(cache.GetKey(NAME, SOURCE, "vs_main", "vs_5_0")));
+	REQUIRE(!SameKey(cache.GetKey(NAME, SOURCE, "ps_main", "vs_5_1")));
+	REQUIRE(!SameKey(cache.GetKey(NAME, "float4 vs_main() : SV_POSITION { return 0; }", "vs_main", "vs_5_1")));
+	REQUIRE(!SameKey(otherCache.GetKey(NAME, SOURCE, "vs_main", "vs_5_1")));
+	// Name is embedded in debug bytecode.
+	REQUIRE(!SameKey(cache.GetKey("shader_tests/01-basic.esf", SOURCE, "vs_main", "vs_5_1")));
+}
+
+TEST_CASE("shader-compile-cache-tests-store-find")
+{
+	const u8 byteCode[] = {0x44, 0x58, 0x42, 0x43, 0x01, 0x02, 0x03, 0x04, 0x05};
+	const u8 strippedByteCode[] = {0x44, 0x58, 0x42, 0x43, 0x01};
+	const char errors[] = "warning X3206: implicit truncation of vector type";
+
+	Graphics::ShaderCompileOutput output;
+	output.type_ = GPU::ShaderType::VS;
+	output.byteCodeBegin_ = byteCode;
+	output.byteCodeEnd_ = byteCode + sizeof(byteCode);
+	output.strippedByteCodeBegin_ = strippedByteCode;
+	output.strippedByteCodeEnd_ = strippedByteCode + sizeof(strippedByteCode);
+	output.errorsBegin_ = errors;
+	output.errorsEnd_ = errors + sizeof(errors);
+	output.cbuffers_.emplace_back(0, "viewParams");
+	output.cbuffers_.emplace_back(1, "lightParams");
+	output.srvs_.emplace_back(0, "inObject");
+	output.samplers_.emplace_back(3, "SS_LINEAR_WRAP");
+
+	Core::HashSHA1Digest key;
+	{
+		Graphics::ShaderCompileCache cache(CACHE_PATH, "compiler-1");
+		key = cache.GetKey(NAME, SOURCE, "vs_main", "vs_5_1");
+		REQUIRE(cache.Store(key, output));
+
+		// Storing an existing key succeeds, and leaves no temporary files behind.
+		REQUIRE(cache.Store(key, output));
+		REQUIRE(Core::FileFindInPath(CACHE_PATH, "tmp", nullptr, 0) == 0);
+	}
+
+	// Fresh cache finds output stored by the previous one.
+	Graphics::ShaderCompileCache cache(CACHE_PATH, "compiler-1");
+	Graphics::ShaderCompileOutput found;
+	REQUIRE(cache.Find(key, found));
+	REQUIRE(cache.GetStats().numHits_ == 1);
+	REQUIRE(found);
+	REQUIRE(found.type_ == output.type_);
+	REQUIRE((found.byteCodeEnd_ - found.byteCodeBegin_) == sizeof(byteCode));
+	REQUIRE(memcmp(found.byteCodeBegin_, byteCode, sizeof(byteCode)) == 0);
+	REQUIRE((found.strippedByteCodeEnd_ - found.strippedByteCodeBegin_) == sizeof(strippedByteCode));
+	REQUIRE(memcmp(found.strippedByteCodeBegin_, strippedByteCode, sizeof(strippedByteCode)) == 0);
+	REQUIRE((found.errorsEnd_ - found.errorsBegin_) == sizeof(errors));
+	REQUIRE(memcmp(found.errorsBegin_, errors, sizeof(errors)) == 0);
+	REQUIRE(memcmp(found.byteCodeHash_.data8_, Core::HashSHA1(byteCode, sizeof(byteCode)).data8_,
+	            sizeof(found.byteCodeHash_.data8_)) == 0);
+	CheckBindings(found.cbuffers_, output.cbuffers_);
+	CheckBindings(found.samplers_, output.samplers_);
+	CheckBindings(found.srvs_, output.srvs_);
+	CheckBindings(found.uavs_, output.uavs_);
+
+	// Different inputs miss.
+	REQUIRE(!cache.Find(cache.GetKey(NAME, SOURCE, "vs_main", "vs_5_0"), found));
+	REQUIRE(cache.GetStats().numMisses_ == 1);
+}
@@ -138,6 +138,65 @@ TEST_CASE("graphics-tests-shader-preprocessor")
 	}
 }
 
+TEST_CASE("graphics-tests-shader-preprocessor-include-cache")
+{
+	const char* testPath = "shader_preprocessor_tests";
+	Core::FileCreateDir(testPath);
+
+	auto WriteFile = [](const char* fileName, const char* data) {
+		Core::File file(fileName, Core::FileFlags::DEFAULT_WRITE);
+		REQUIRE(file);
+		file.Write(data, strlen(data));
+	};
+
+	auto commonPath = Core::String().Printf("%s/common.esh", testPath);
+	auto unusedPath = Core::String().Printf("%s/unused.esh", testPath);
+	auto windowsPath = Core::String().Printf("%s/windows.esh", testPath);
+	WriteFile(commonPath.c_str(), "#ifndef COMMON_ESH\n#define COMMON_ESH\nfloat4 Common() { return 1; }\n#endif\n");
+	WriteFile(unusedPath.c_str(), "float4 Unused() { return 0; }\n");
+	WriteFile(windowsPath.c_str(), "float4 Windows()\r\n{\r\n\treturn 1;\r\n}\r\n");
+
+	const char* shaderCode = "#include \"common.esh\"\n#include \"common.esh\"\nfloat4 main() { return Common(); }\n";
+
+	auto Preprocess = [&](Graphics::ShaderIncludeCache* includeCache, Core::String& outOutput) {
+		Graphics::ShaderPreprocessor shaderPreprocessor(includeCache);
+		shaderPreprocessor.AddInclude(testPath);
+		REQUIRE(shaderPreprocessor.Preprocess("test.esf", shaderCode));
+		outOutput = shaderPreprocessor.GetOutput();
+
+		// Only files actually included are dependencies, and only once each.
+		i32 numCommon = 0;
+		for(const auto& dep : shaderPreprocessor.GetDependencies())
+		{
+			REQUIRE(strstr(dep.c_str(), "unused.esh") == nullptr);
+			if(strstr(dep.c_str(), "common.esh"))
+				++numCommon;
+		}
+		REQUIRE(numCommon == 1);
+	};
+
+	Core::String uncachedOutput;
+	Preprocess(nullptr, uncachedOutput);
+
+	Graphics::ShaderIncludeCache includeCache;
+	Core::String cachedOutputA;
+	Core::String cachedOutputB;
+	Preprocess(&includeCache, cachedOutputA);
+	Preprocess(&includeCache, cachedOutputB);
+	REQUIRE(cachedOutputA == uncachedOutput);
+	REQUIRE(cachedOutputB == uncachedOutput);
+
+	// Common header is read once, then served from memory for every other include.
+	REQUIRE(includeCache.GetStats().numMisses_ == 1);
+	REQUIRE(includeCache.GetStats().numHits_ == 3);
+
+	// Line endings are normalized when read.
+	const auto* windowsFile = includeCache.GetFile(windowsPath.c_str());
+	REQUIRE(windowsFile);
+	REQUIRE(windowsFile->data_ == "float4 Windows()\n{\n\treturn 1;\n}\n");
+	REQUIRE(includeCache.GetFile("shader_preprocessor_tests/missing.esh") == nullptr);
+}
+
 TEST_CASE("graphics-tests-shader-parser")
 {
 	const char* testPath = "../../../../res/shader_tests/parser";
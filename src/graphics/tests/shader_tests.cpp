@@ -1,7 +1,9 @@
 #include "catch.hpp"
 #include "client/manager.h"
 #include "client/window.h"
+#include "core/allocator.h"
 #include "core/misc.h"
+#include "graphics/pipeline_state_cache.h"
 #include "math/vec2.h"
 #include "math/vec4.h"
 #include "math/mat44.h"
@@ -168,7 +170,7 @@ namespace
 
 TEST_CASE("graphics-tests-shader-request")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 
 	Graphics::Shader* shader = nullptr;
 	REQUIRE(Resource::Manager::RequestResource(shader, "shader_tests/00-basic.esf"));
@@ -178,7 +180,7 @@ TEST_CASE("graphics-tests-shader-request")
 
 TEST_CASE("graphics-tests-shader-graphics-create-technique")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 
 	Window window("test");
 	TriangleDrawer drawer;
@@ -224,7 +226,7 @@ TEST_CASE("graphics-tests-shader-graphics-create-technique")
 
 TEST_CASE("graphics-tests-shader-compute-create-technique")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 
 	Window window("test");
 	TriangleDrawer drawer;
@@ -376,7 +378,7 @@ TEST_CASE("graphics-tests-shader-compute-create-technique")
 
 TEST_CASE("graphics-tests-shader-graphics-binding-sets")
 {
-	ScopedEngine engine;
+	ScopedEngine engine("NULL");
 
 	Window window("test");
 	TriangleDrawer drawer;
@@ -427,3 +429,315 @@ TEST_CASE("graphics-tests-shader-graphics-binding-sets")
 
 	REQUIRE(Resource::Manager::ReleaseResource(shader));
 }
+
+TEST_CASE("graphics-tests-shader-pipeline-state-cache")
+{
+	const char* cachePath = "pipeline_state_cache_tests.dat";
+	const char* badCachePath = "pipeline_state_cache_tests_bad.dat";
+
+	auto techDesc =
+	    Graphics::ShaderTechniqueDesc()
+	        .SetVertexElement(
+	            0, GPU::VertexElement(0, 0, GPU::Format::R32G32B32A32_FLOAT, GPU::VertexUsage::POSITION, 0))
+	        .SetVertexElement(
+	            1, GPU::VertexElement(0, 16, GPU::Format::R32G32_FLOAT, GPU::VertexUsage::TEXCOORD, 0))
+	        .SetTopology(GPU::TopologyType::TRIANGLE)
+	        .SetRTVFormat(0, GPU::Format::R8G8B8A8_UNORM);
+
+	// First run records technique and saves it.
+	i32 numRecords = 0;
+	{
+		ScopedEngine engine("NULL");
+		Graphics::PipelineStateCache::ResetStats();
+
+		// First use creates pipeline state on the calling thread.
+		Graphics::Shader* shader = nullptr;
+		REQUIRE(Resource::Manager::RequestResource(shader, "shader_tests/00-basic.esf"));
+		Resource::Manager::WaitForResource(shader);
+		{
+			auto tech = shader->CreateTechnique("TECH_MAIN", techDesc);
+			REQUIRE(tech);
+		}
+
+		auto stats = Graphics::PipelineStateCache::GetStats();
+		REQUIRE(stats.numMisses_ == 1);
+		REQUIRE(stats.numEntries_ == 1);
+		REQUIRE(stats.numRecords_ >= 1);
+
+		REQUIRE(Resource::Manager::ReleaseResource(shader));
+		REQUIRE(Graphics::PipelineStateCache::GetStats().numEntries_ == 0);
+
+		numRecords = stats.numRecords_;
+		REQUIRE(Graphics::PipelineStateCache::Save(cachePath));
+	}
+
+	// Later run, with a new cache and GPU manager, prewarms from the saved file.
+	{
+		ScopedEngine engine("NULL");
+		REQUIRE(Graphics::PipelineStateCache::GetStats().numRecords_ == 0);
+
+		Core::Vector<u8> data;
+		{
+			Core::File file(cachePath, Core::FileFlags::READ);
+			REQUIRE(file);
+			data.resize((i32)file.Size());
+			REQUIRE(file.Read(data.data(), data.size()) == data.size());
+		}
+
+		auto LoadBad = [&](const Core::Vector<u8>& badData) {
+			{
+				Core::File file(badCachePath, Core::FileFlags::DEFAULT_WRITE);
+				REQUIRE(file);
+				REQUIRE(file.Write(badData.data(), badData.size()) == badData.size());
+			}
+			const bool loaded = Graphics::PipelineStateCache::Load(badCachePath);
+			Core::FileRemove(badCachePath);
+			return loaded;
+		};
+
+		// Stale, from a different major version. It follows the u32 magic number.
+		{
+			auto badData = data;
+			badData[sizeof(u32)]++;
+			REQUIRE(!LoadBad(badData));
+		}
+
+		// Corrupt, truncated mid record.
+		{
+			auto badData = data;
+			badData.resize(badData.size() - 1);
+			REQUIRE(!LoadBad(badData));
+		}
+
+		// Corrupt, not a cache file.
+		{
+			auto badData = data;
+			for(auto& byte : badData)
+				byte = 0xcd;
+			REQUIRE(!LoadBad(badData));
+		}
+
+		REQUIRE(Graphics::PipelineStateCache::GetStats().numRecords_ == 0);
+
+		REQUIRE(Graphics::PipelineStateCache::Load(cachePath));
+		REQUIRE(Graphics::PipelineStateCache::GetStats().numRecords_ == numRecords);
+
+		// Loading shader prewarms recorded technique on a job worker.
+		Graphics::PipelineStateCache::ResetStats();
+		Graphics::Shader* shader = nullptr;
+		REQUIRE(Resource::Manager::RequestResource(shader, "shader_tests/00-basic.esf"));
+		Resource::Manager::WaitForResource(shader);
+		while(Graphics::PipelineStateCache::GetStats().numPrewarmed_ == 0)
+			Core::SwitchThread();
+
+		// First use of a prewarmed technique is a hit.
+		{
+			auto tech = shader->CreateTechnique("TECH_MAIN", techDesc);
+			REQUIRE(tech);
+		}
+
+		auto stats = Graphics::PipelineStateCache::GetStats();
+		REQUIRE(stats.numMisses_ == 0);
+		REQUIRE(stats.numPrewarmed_ == 1);
+		REQUIRE(stats.numHits_ == 1);
+
+		REQUIRE(Resource::Manager::ReleaseResource(shader));
+	}
+
+	Core::FileRemove(cachePath);
+}
+
+TEST_CASE("graphics-tests-shader-commit-bindings-benchmark")
+{
+	ScopedEngine engine("NULL");
+
+	TriangleDrawer drawer;
+
+	Graphics::Shader* shader = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(shader, "shader_tests/00-basic.esf"));
+	Resource::Manager::WaitForResource(shader);
+
+	auto tech = shader->CreateTechnique("TECH_MAIN", drawer.techDesc_);
+	REQUIRE(tech);
+
+	const i32 numObjects = 1024;
+	const i32 numDraws = 2048;
+
+	GPU::BufferDesc viewParamsDesc;
+	viewParamsDesc.bindFlags_ = GPU::BindFlags::CONSTANT_BUFFER;
+	viewParamsDesc.size_ = 4096;
+	GPU::Handle viewParams = GPU::Manager::CreateBuffer(viewParamsDesc, nullptr, "viewParams");
+
+	GPU::BufferDesc objectDesc;
+	objectDesc.bindFlags_ = GPU::BindFlags::SHADER_RESOURCE;
+	objectDesc.size_ = sizeof(Math::Mat44) * numObjects;
+	GPU::Handle objects = GPU::Manager::CreateBuffer(objectDesc, nullptr, "objects");
+
+	auto viewBindingSet = shader->CreateBindingSet("ViewBindings");
+	auto objectBindingSet = shader->CreateBindingSet("ObjectBindings");
+	auto materialBindingSet = shader->CreateBindingSet("MaterialBindings");
+
+	viewBindingSet.Set("viewParams", GPU::Binding::CBuffer(viewParams, 0, 2048));
+	viewBindingSet.Set("lightParams", GPU::Binding::CBuffer(viewParams, 2048, 2048));
+	materialBindingSet.Set("tex_diffuse", GPU::Binding::Texture2D(drawer.texture_->GetHandle(), GPU::Format::INVALID,
+	                                          0, drawer.texture_->GetDesc().levels_));
+
+	auto SetObject = [&](i32 idx) {
+		objectBindingSet.Set("inObject",
+		    GPU::Binding::Buffer(objects, GPU::Format::INVALID, idx, numObjects - idx, sizeof(Math::Mat44)));
+	};
+	SetObject(0);
+
+	// Commit bindings for every draw, with objects either unchanged or changed between draws.
+	auto Measure = [&](const char* name, bool changeObject) {
+		GPU::CommandList cmdList(16 * 1024 * 1024);
+		Graphics::ShaderContext shaderCtx(cmdList);
+
+		Core::Timer timer;
+		timer.Mark();
+		if(auto viewBind = shaderCtx.BeginBindingScope(viewBindingSet))
+		{
+			if(auto materialBind = shaderCtx.BeginBindingScope(materialBindingSet))
+			{
+				if(auto objectBind = shaderCtx.BeginBindingScope(objectBindingSet))
+				{
+					for(i32 idx = 0; idx < numDraws; ++idx)
+					{
+						if(changeObject)
+							SetObject(idx % numObjects);
+
+						GPU::Handle ps;
+						Core::ArrayView<GPU::PipelineBinding> pb;
+						REQUIRE(shaderCtx.CommitBindings(tech, ps, pb));
+					}
+				}
+			}
+		}
+		Core::Log("CommitBindings (%s): %d draws %.3f ms\n", name, numDraws, timer.GetTime() * 1000.0);
+	};
+
+	// Unchanged binding sets reuse the bindings committed for the previous draw.
+	{
+		GPU::CommandList cmdList;
+		Graphics::ShaderContext shaderCtx(cmdList);
+		if(auto viewBind = shaderCtx.BeginBindingScope(viewBindingSet))
+		{
+			if(auto materialBind = shaderCtx.BeginBindingScope(materialBindingSet))
+			{
+				if(auto objectBind = shaderCtx.BeginBindingScope(objectBindingSet))
+				{
+					GPU::Handle ps[2];
+					Core::ArrayView<GPU::PipelineBinding> pb[2];
+					REQUIRE(shaderCtx.CommitBindings(tech, ps[0], pb[0]));
+					REQUIRE(shaderCtx.CommitBindings(tech, ps[1], pb[1]));
+					REQUIRE(ps[0] == ps[1]);
+					REQUIRE(pb[0].data() == pb[1].data());
+
+					SetObject(1);
+					REQUIRE(shaderCtx.CommitBindings(tech, ps[1], pb[1]));
+					REQUIRE(pb[0].data() != pb[1].data());
+				}
+			}
+		}
+		SetObject(0);
+	}
+
+	Measure("repeated bindings", false);
+	Measure("changed bindings", true);
+
+	tech = Graphics::ShaderTechnique();
+	viewBindingSet = Graphics::ShaderBindingSet();
+	objectBindingSet = Graphics::ShaderBindingSet();
+	materialBindingSet = Graphics::ShaderBindingSet();
+
+	GPU::Manager::DestroyResource(objects);
+	GPU::Manager::DestroyResource(viewParams);
+
+	REQUIRE(Resource::Manager::ReleaseResource(shader));
+}
+
+TEST_CASE("graphics-tests-shader-lookup-benchmark")
+{
+	ScopedEngine engine("NULL");
+
+	TriangleDrawer drawer;
+
+	Graphics::Shader* shader = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(shader, "shader_tests/00-basic.esf"));
+	Resource::Manager::WaitForResource(shader);
+
+	const i32 numLookups = 100000;
+
+	auto viewBindingSet = shader->CreateBindingSet("ViewBindings");
+	REQUIRE(viewBindingSet);
+	REQUIRE(viewBindingSet.GetBindingHandle("viewParams") != 0);
+	REQUIRE(viewBindingSet.GetBindingHandle("lightParams") != 0);
+	REQUIRE(viewBindingSet.GetBindingHandle("viewParams") != viewBindingSet.GetBindingHandle("lightParams"));
+	REQUIRE(viewBindingSet.GetBindingHandle("inObject") == 0);
+	REQUIRE(!shader->CreateBindingSet("MissingBindings"));
+
+	Core::Timer timer;
+	timer.Mark();
+	u32 handleSum = 0;
+	for(i32 idx = 0; idx < numLookups; ++idx)
+		handleSum += viewBindingSet.GetBindingHandle((idx & 1) ? "viewParams" : "lightParams");
+	const f64 bindingTime = timer.GetTime();
+	REQUIRE(handleSum != 0);
+
+	timer.Mark();
+	for(i32 idx = 0; idx < numLookups / 100; ++idx)
+	{
+		auto bindingSet = Graphics::Shader::CreateSharedBindingSet("ObjectBindings");
+		REQUIRE(bindingSet);
+	}
+	const f64 bindingSetTime = timer.GetTime();
+
+	timer.Mark();
+	for(i32 idx = 0; idx < numLookups / 100; ++idx)
+	{
+		auto tech = shader->CreateTechnique("TECH_MAIN", drawer.techDesc_);
+		REQUIRE(tech);
+	}
+	const f64 techniqueTime = timer.GetTime();
+
+	Core::Log("Shader lookups: %d bindings %.3f ms, %d shared binding sets %.3f ms, %d techniques %.3f ms\n",
+	    numLookups, bindingTime * 1000.0, numLookups / 100, bindingSetTime * 1000.0, numLookups / 100,
+	    techniqueTime * 1000.0);
+
+	viewBindingSet = Graphics::ShaderBindingSet();
+
+	REQUIRE(Resource::Manager::ReleaseResource(shader));
+}
+
+TEST_CASE("graphics-tests-shader-load-benchmark")
+{
+	ScopedEngine engine("NULL");
+
+	// Convert up front, so only loading is measured.
+	Graphics::Shader* shader = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(shader, "shader_tests/00-basic.esf"));
+	Resource::Manager::WaitForResource(shader);
+	REQUIRE(Resource::Manager::ReleaseResource(shader));
+
+	const i32 numLoads = 32;
+	f64 loadTime = 0.0;
+	i64 numAllocations = 0;
+	Core::Timer timer;
+	for(i32 idx = 0; idx < numLoads; ++idx)
+	{
+		// Only counted when the general allocator is tracked.
+		const i64 numAllocationsBefore = Core::GeneralAllocator().GetStats().numAllocations_;
+		timer.Mark();
+		REQUIRE(Resource::Manager::RequestResource(shader, "shader_tests/00-basic.esf"));
+		Resource::Manager::WaitForResource(shader);
+		loadTime += timer.GetTime();
+		numAllocations += Core::GeneralAllocator().GetStats().numAllocations_ - numAllocationsBefore;
+
+		REQUIRE(shader->IsReady());
+		REQUIRE(shader->CreateBindingSet("ViewBindings"));
+		REQUIRE(Resource::Manager::ReleaseResource(shader));
+	}
+
+	Core::Log("Shader load: %d loads %.3f ms (%.3f ms avg), %lld allocations held per load\n", numLoads,
+	    loadTime * 1000.0, (loadTime * 1000.0) / numLoads, numAllocations / numLoads);
+}
@@ -0,0 +1,197 @@
+#include "catch.hpp"
+#include "core/concurrency.h"
+#include "core/random.h"
+#include "core/timer.h"
+#include "graphics/skinning.h"
+#include "graphics/transform_hierarchy.h"
+#include "job/manager.h"
+
+#include <cmath>
+
+namespace
+{
+	i32 RandomInt(Core::Random& rng, i32 max) { return (i32)((u32)rng.Generate() % (u32)max); }
+
+	f32 RandomFloat(Core::Random& rng, f32 min, f32 max)
+	{
+		return min + ((f32)(rng.Generate() & 0xffff) / 65535.0f) * (max - min);
+	}
+
+	Math::Mat44 RandomTransform(Core::Random& rng)
+	{
+		Math::Mat44 transform;
+		transform.Rotation(
+		    Math::Vec3(RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f)));
+		transform.Translation(
+		    Math::Vec3(RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f)));
+		return transform;
+	}
+
+	void CreateBones(
+	    i32 numNodes, i32 numBones, Core::Vector<Math::Mat44>& outWorlds, Graphics::SkinningBones& outBones)
+	{
+		Core::Random rng;
+		outWorlds.resize(numNodes);
+		for(auto& world : outWorlds)
+			world = RandomTransform(rng);
+		for(i32 idx = 0; idx < numBones; ++idx)
+			outBones.Add(RandomInt(rng, numNodes), RandomTransform(rng));
+	}
+
+	void CreateVertices(i32 num, i32 numBones, Graphics::SkinningVertices& outVertices)
+	{
+		Core::Random rng;
+		for(i32 idx = 0; idx < num; ++idx)
+		{
+			i32 bones[Graphics::SkinningVertices::MAX_INFLUENCES];
+			f32 weights[Graphics::SkinningVertices::MAX_INFLUENCES];
+			f32 totalWeight = 0.0f;
+			for(i32 influence = 0; influence < Graphics::SkinningVertices::MAX_INFLUENCES; ++influence)
+			{
+				bones[influence] = RandomInt(rng, numBones);
+				weights[influence] = RandomFloat(rng, 0.0f, 1.0f);
+				totalWeight += weights[influence];
+			}
+			for(auto& weight : weights)
+				weight /= totalWeight;
+
+			const Math::Vec3 position(
+			    RandomFloat(rng, -10.0f, 10.0f), RandomFloat(rng, -10.0f, 10.0f), RandomFloat(rng, -10.0f, 10.0f));
+			const Math::Vec3 normal(
+			    RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f));
+			outVertices.Add(position, normal, bones, weights);
+		}
+	}
+
+	void CheckSkinningMatrices(i32 batchSize)
+	{
+		Core::Vector<Math::Mat44> worlds;
+		Graphics::SkinningBones bones;
+		CreateBones(257, 1031, worlds, bones);
+
+		Core::Vector<Math::Mat44> matrices;
+		Graphics::ComputeSkinningMatrices(bones, worlds.data(), matrices, batchSize);
+		REQUIRE(matrices.size() == bones.Size());
+		for(i32 idx = 0; idx < bones.Size(); ++idx)
+		{
+			const Math::Mat44 expected = bones.inverseBindPoses_[idx] * worlds[bones.nodeIndices_[idx]];
+			for(u32 row = 0; row < 4; ++row)
+				for(u32 col = 0; col < 4; ++col)
+					REQUIRE(matrices[idx][row][col] == expected[row][col]);
+		}
+
+		// Same again, with worlds from a hierarchy of roots.
+		Graphics::TransformHierarchy hierarchy;
+		for(const auto& world : worlds)
+			hierarchy.AddNode(-1, world);
+		hierarchy.Update();
+
+		Core::Vector<Math::Mat44> hierarchyMatrices;
+		Graphics::ComputeSkinningMatrices(bones, hierarchy, hierarchyMatrices, batchSize);
+		REQUIRE(hierarchyMatrices.size() == bones.Size());
+		for(i32 idx = 0; idx < bones.Size(); ++idx)
+			for(u32 row = 0; row < 4; ++row)
+				for(u32 col = 0; col < 4; ++col)
+					REQUIRE(hierarchyMatrices[idx][row][col] == matrices[idx][row][col]);
+	}
+
+	void CheckSkinVertices(i32 batchSize)
+	{
+		Core::Vector<Math::Mat44> worlds;
+		Graphics::SkinningBones bones;
+		CreateBones(64, 64, worlds, bones);
+
+		Core::Vector<Math::Mat44> matrices;
+		Graphics::ComputeSkinningMatrices(bones, worlds.data(), matrices);
+
+		// Odd count, so there is a tail to handle.
+		Graphics::SkinningVertices vertices;
+		CreateVertices(10007, bones.Size(), vertices);
+
+		Graphics::SkinnedVertices skinned;
+		Graphics::SkinVertices(vertices, matrices.data(), skinned, batchSize);
+		REQUIRE(skinned.Size() == vertices.Size());
+
+		// Reference: transform by each influence, then blend results.
+		for(i32 idx = 0; idx < vertices.Size(); ++idx)
+		{
+			const Math::Vec4 position(vertices.x_[idx], vertices.y_[idx], vertices.z_[idx], 1.0f);
+			const Math::Vec4 normal(vertices.nx_[idx], vertices.ny_[idx], vertices.nz_[idx], 0.0f);
+			Math::Vec4 expectedPosition(0.0f, 0.0f, 0.0f, 0.0f);
+			Math::Vec4 expectedNormal(0.0f, 0.0f, 0.0f, 0.0f);
+			for(i32 influence = 0; influence < Graphics::SkinningVertices::MAX_INFLUENCES; ++influence)
+			{
+				const Math::Mat44& matrix = matrices[vertices.bones_[influence][idx]];
+				const f32 weight = vertices.weights_[influence][idx];
+				expectedPosition = expectedPosition + (position * matrix) * weight;
+				expectedNormal = expectedNormal + (normal * matrix) * weight;
+			}
+
+			const f32 epsilon = 1e-4f;
+			REQUIRE(std::abs(skinned.x_[idx] - expectedPosition.x) < epsilon);
+			REQUIRE(std::abs(skinned.y_[idx] - expectedPosition.y) < epsilon);
+			REQUIRE(std::abs(skinned.z_[idx] - expectedPosition.z) < epsilon);
+			REQUIRE(std::abs(skinned.nx_[idx] - expectedNormal.x) < epsilon);
+			REQUIRE(std::abs(skinned.ny_[idx] - expectedNormal.y) < epsilon);
+			REQUIRE(std::abs(skinned.nz_[idx] - expectedNormal.z) < epsilon);
+		}
+	}
+}
+
+TEST_CASE("skinning-tests-st")
+{
+	CheckSkinningMatrices(1);
+	CheckSkinningMatrices(256);
+	CheckSkinVertices(1);
+	CheckSkinVertices(1000);
+	CheckSkinVertices(4096);
+}
+
+TEST_CASE("skinning-tests-mt")
+{
+	Job::Manager::Scoped jobManager(4, 256, 32 * 1024);
+	CheckSkinningMatrices(1);
+	CheckSkinningMatrices(256);
+	CheckSkinVertices(1);
+	CheckSkinVertices(1000);
+	CheckSkinVertices(4096);
+}
+
+TEST_CASE("skinning-tests-benchmark")
+{
+	const i32 NUM_NODES = 10 * 1024;
+	const i32 NUM_BONES = 10 * 1024;
+	const i32 NUM_VERTICES = 1024 * 1024;
+	const i32 NUM_ITERATIONS = 8;
+
+	Core::Vector<Math::Mat44> worlds;
+	Graphics::SkinningBones bones;
+	CreateBones(NUM_NODES, NUM_BONES, worlds, bones);
+
+	Graphics::SkinningVertices vertices;
+	CreateVertices(NUM_VERTICES, NUM_BONES, vertices);
+
+	Core::Vector<Math::Mat44> matrices;
+	Graphics::SkinnedVertices skinned;
+
+	auto Measure = [&](const char* name) {
+		Core::Timer timer;
+		timer.Mark();
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+			Graphics::ComputeSkinningMatrices(bones, worlds.data(), matrices);
+		const f64 matrixTime = timer.GetTime() / NUM_ITERATIONS;
+
+		timer.Mark();
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+			Graphics::SkinVertices(vertices, matrices.data(), skinned);
+		const f64 vertexTime = timer.GetTime() / NUM_ITERATIONS;
+
+		Core::Log("Skinning (%s): %d bones %.3f ms, %d vertices %.3f ms\n", name, NUM_BONES, matrixTime * 1000.0,
+		    NUM_VERTICES, vertexTime * 1000.0);
+	};
+
+	Measure("single threaded");
+
+	Job::Manager::Scoped jobManager(Core::GetNumLogicalCores(), 256, 32 * 1024);
+	Measure("job workers");
+}
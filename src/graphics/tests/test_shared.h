@@ -19,9 +19,10 @@
 
 namespace
 {
-	GPU::SetupParams GetDefaultSetupParams()
+	GPU::SetupParams GetDefaultSetupParams(const char* api = nullptr)
 	{
 		GPU::SetupParams setupParams;
+		setupParams.api_ = api;
 		setupParams.debugFlags_ = GPU::DebugFlags::NONE;
 		return setupParams;
 	}
@@ -31,7 +32,7 @@ namespace
 	public:
 		Client::Window window;
 		Plugin::Manager::Scoped pluginManager;
-		GPU::Manager::Scoped gpuManager = GPU::Manager::Scoped(GetDefaultSetupParams());
+		GPU::Manager::Scoped gpuManager;
 		Job::Manager::Scoped jobManager = Job::Manager::Scoped(2, 256, 32 * 1024);
 		Resource::Manager::Scoped resourceManager;
 
@@ -39,8 +40,13 @@ namespace
 		GPU::Handle scHandle;
 		GPU::Handle fbsHandle;
 
-		ScopedEngine()
+		/**
+		 * @param api GPU backend to use, nullptr for the default one. Tests that don't need
+		 * results from a real device should use "NULL".
+		 */
+		ScopedEngine(const char* api = nullptr)
 		    : window("unit-test-engine", 100, 100, 1024, 768, true)
+		    , gpuManager(GetDefaultSetupParams(api))
 		{
 			Graphics::Material::RegisterFactory();
 			Graphics::Model::RegisterFactory();
@@ -0,0 +1,101 @@
+#include "catch.hpp"
+#include "test_shared.h"
+
+#include "graphics/material.h"
+#include "graphics/texture_streaming.h"
+
+namespace
+{
+	/// Enable streaming for the scope, so a failing test doesn't leave it enabled for others.
+	struct ScopedStreamingBudget
+	{
+		ScopedStreamingBudget(i64 budgetBytes, i32 tailSize)
+		{
+			Graphics::TextureStreaming::SetBudget(budgetBytes, tailSize);
+		}
+		~ScopedStreamingBudget() { Graphics::TextureStreaming::SetBudget(0); }
+	};
+
+	/// Request level 0 and update streaming until @a condition is met, or too many frames pass.
+	template<typename CONDITION>
+	bool UpdateStreaming(Graphics::Texture* texture, CONDITION&& condition)
+	{
+		for(i32 frame = 0; frame < 1000; ++frame)
+		{
+			texture->RequestLevel(0);
+			Graphics::TextureStreaming::Update();
+			if(condition())
+				return true;
+			Core::Sleep(0.001);
+		}
+		return false;
+	}
+}
+
+TEST_CASE("graphics-tests-texture-streaming")
+{
+	ScopedEngine engine;
+
+	// 128x128 with a full mip chain. Tail starts at the 16x16 level.
+	ScopedStreamingBudget budget(64 * 1024 * 1024, 16);
+
+	Graphics::Texture* texture = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(texture, "test_texture_png.png"));
+	Resource::Manager::WaitForResource(texture);
+	REQUIRE(texture->GetDesc().width_ == 16);
+	REQUIRE(texture->GetLevelForScreenSize(128.0f) == 0);
+	REQUIRE(texture->GetLevelForScreenSize(32.0f) == 2);
+	REQUIRE(Graphics::TextureStreaming::GetStats().numTextures_ == 1);
+
+	// Stream in all levels.
+	const i32 version = texture->GetVersion();
+	REQUIRE(UpdateStreaming(texture, [&]() { return texture->GetDesc().width_ == 128; }));
+	REQUIRE(texture->GetVersion() != version);
+
+	auto stats = Graphics::TextureStreaming::GetStats();
+	REQUIRE(stats.numStreamedIn_ > 0);
+	REQUIRE(stats.residentBytes_ == stats.requestedBytes_);
+
+	// Evict down to the tail when over budget.
+	Graphics::TextureStreaming::SetBudget(1, 16);
+	REQUIRE(UpdateStreaming(texture, [&]() { return texture->GetDesc().width_ == 16; }));
+
+	stats = Graphics::TextureStreaming::GetStats();
+	REQUIRE(stats.numEvicted_ > 0);
+	REQUIRE(stats.residentBytes_ < stats.requestedBytes_);
+
+	REQUIRE(Resource::Manager::ReleaseResource(texture));
+	REQUIRE(Graphics::TextureStreaming::GetStats().numTextures_ == 0);
+}
+
+TEST_CASE("graphics-tests-texture-streaming-material")
+{
+	ScopedEngine engine;
+	ScopedStreamingBudget budget(64 * 1024 * 1024, 16);
+
+	Graphics::Material* material = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(material, "test_material.material"));
+	Resource::Manager::WaitForResource(material);
+	REQUIRE(material->GetBindingSet());
+
+	// Same texture the material uses.
+	Graphics::Texture* texture = nullptr;
+	REQUIRE(Resource::Manager::RequestResource(texture, "test_texture.png"));
+	Resource::Manager::WaitForResource(texture);
+	REQUIRE(texture->GetDesc().width_ == 16);
+
+	// Material use requests levels, and updating streaming rebinds them.
+	bool streamedIn = false;
+	for(i32 frame = 0; frame < 1000 && !streamedIn; ++frame)
+	{
+		material->RequestTextureLevels(128.0f);
+		Graphics::TextureStreaming::Update();
+		streamedIn = texture->GetDesc().width_ == 128;
+		Core::Sleep(0.001);
+	}
+	REQUIRE(streamedIn);
+	REQUIRE(material->GetBindingSet().Validate());
+
+	REQUIRE(Resource::Manager::ReleaseResource(texture));
+	REQUIRE(Resource::Manager::ReleaseResource(material));
+}
@@ -0,0 +1,148 @@
+#include "catch.hpp"
+#include "core/concurrency.h"
+#include "core/random.h"
+#include "core/timer.h"
+#include "graphics/transform_hierarchy.h"
+#include "job/manager.h"
+
+namespace
+{
+	i32 RandomInt(Core::Random& rng, i32 max) { return (i32)((u32)rng.Generate() % (u32)max); }
+
+	Math::Mat44 RandomTransform(Core::Random& rng)
+	{
+		auto RandomFloat = [&rng]() { return ((f32)(rng.Generate() & 0xffff) / 65535.0f) * 2.0f - 1.0f; };
+		Math::Mat44 transform;
+		transform.Rotation(Math::Vec3(RandomFloat(), RandomFloat(), RandomFloat()));
+		transform.Translation(Math::Vec3(RandomFloat(), RandomFloat(), RandomFloat()));
+		return transform;
+	}
+
+	/// Parents are picked from the previous @a window nodes: a small window gives deep trees, a large one wide trees.
+	void CreateHierarchy(i32 num, i32 window, Graphics::TransformHierarchy& outHierarchy)
+	{
+		Core::Random rng;
+		for(i32 idx = 0; idx < num; ++idx)
+		{
+			i32 parentIdx = -1;
+			if(idx > 0 && RandomInt(rng, 16) != 0)
+				parentIdx = idx - 1 - RandomInt(rng, Core::Min(idx, window));
+			outHierarchy.AddNode(parentIdx, RandomTransform(rng));
+		}
+	}
+
+	void CheckWorldTransforms(const Graphics::TransformHierarchy& hierarchy)
+	{
+		Core::Vector<Math::Mat44> expected;
+		expected.resize(hierarchy.GetNumNodes());
+		for(i32 idx = 0; idx < hierarchy.GetNumNodes(); ++idx)
+		{
+			const i32 parentIdx = hierarchy.GetParent(idx);
+			expected[idx] = parentIdx >= 0 ? hierarchy.GetLocal(idx) * expected[parentIdx] : hierarchy.GetLocal(idx);
+		}
+
+		for(i32 idx = 0; idx < hierarchy.GetNumNodes(); ++idx)
+			for(u32 row = 0; row < 4; ++row)
+				for(u32 col = 0; col < 4; ++col)
+					REQUIRE(hierarchy.GetWorld(idx)[row][col] == expected[idx][row][col]);
+	}
+
+	void CheckTransformHierarchy(i32 batchSize)
+	{
+		Graphics::TransformHierarchy hierarchy;
+		CreateHierarchy(10007, 64, hierarchy);
+		REQUIRE(hierarchy.Update(batchSize) == hierarchy.GetNumNodes());
+		REQUIRE(hierarchy.GetNumLevels() > 1);
+		CheckWorldTransforms(hierarchy);
+
+		// Nothing changed.
+		REQUIRE(hierarchy.Update(batchSize) == 0);
+
+		// Change some nodes, only they and their descendants should be updated.
+		Core::Random rng;
+		Core::Vector<bool> changed;
+		changed.resize(hierarchy.GetNumNodes(), false);
+		for(i32 idx = 0; idx < 32; ++idx)
+		{
+			const i32 nodeIdx = RandomInt(rng, hierarchy.GetNumNodes());
+			hierarchy.SetLocal(nodeIdx, RandomTransform(rng));
+			changed[nodeIdx] = true;
+		}
+
+		i32 numExpected = 0;
+		for(i32 idx = 0; idx < hierarchy.GetNumNodes(); ++idx)
+		{
+			const i32 parentIdx = hierarchy.GetParent(idx);
+			if(parentIdx >= 0 && changed[parentIdx])
+				changed[idx] = true;
+			numExpected += changed[idx] ? 1 : 0;
+		}
+		REQUIRE(hierarchy.Update(batchSize) == numExpected);
+		CheckWorldTransforms(hierarchy);
+
+		// Add nodes, parented to existing ones.
+		CreateHierarchy(1000, 64, hierarchy);
+		REQUIRE(hierarchy.Update(batchSize) == 1000);
+		CheckWorldTransforms(hierarchy);
+	}
+}
+
+TEST_CASE("transform-hierarchy-tests-st")
+{
+	CheckTransformHierarchy(1);
+	CheckTransformHierarchy(256);
+	CheckTransformHierarchy(4096);
+}
+
+TEST_CASE("transform-hierarchy-tests-mt")
+{
+	Job::Manager::Scoped jobManager(4, 256, 32 * 1024);
+	CheckTransformHierarchy(1);
+	CheckTransformHierarchy(256);
+	CheckTransformHierarchy(4096);
+}
+
+TEST_CASE("transform-hierarchy-tests-benchmark")
+{
+	const i32 NUM_NODES = 64 * 1024;
+	const i32 NUM_ITERATIONS = 16;
+
+	Graphics::TransformHierarchy hierarchy;
+	CreateHierarchy(NUM_NODES, NUM_NODES, hierarchy);
+	hierarchy.Update();
+
+	Core::Random rng;
+	const Math::Mat44 transform = RandomTransform(rng);
+
+	auto Measure = [&](const char* name) {
+		// Touch every root, so the whole hierarchy is recomputed.
+		Core::Timer timer;
+		timer.Mark();
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+		{
+			for(i32 idx = 0; idx < NUM_NODES; ++idx)
+				if(hierarchy.GetParent(idx) < 0)
+					hierarchy.SetLocal(idx, transform);
+			hierarchy.Update();
+		}
+		const f64 fullTime = timer.GetTime() / NUM_ITERATIONS;
+
+		// Touch a few nodes.
+		timer.Mark();
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+		{
+			for(i32 idx = 0; idx < 16; ++idx)
+				hierarchy.SetLocal(RandomInt(rng, NUM_NODES), transform);
+			hierarchy.Update();
+		}
+		const f64 partialTime = timer.GetTime() / NUM_ITERATIONS;
+
+		Core::Log("Transform hierarchy %d nodes, %d levels (%s): full %.3f ms, partial %.3f ms\n", NUM_NODES,
+		    hierarchy.GetNumLevels(), name, fullTime * 1000.0, partialTime * 1000.0);
+	};
+
+	Measure("single threaded");
+
+	Job::Manager::Scoped jobManager(Core::GetNumLogicalCores(), 256, 32 * 1024);
+	Measure("job workers");
+}
@@ -12,19 +12,34 @@ namespace Graphics
 	class GRAPHICS_DLL Texture
 	{
 	public:
-		DECLARE_RESOURCE(Texture, "Graphics.Texture", 0);
+		DECLARE_RESOURCE(Texture, "Graphics.Texture", 1);
 		Texture();
 		~Texture();
 
 		/// @return Is texture ready for use?
 		bool IsReady() const { return !!impl_; }
 
-		/// @return Texture desc.
+		/// @return Texture desc. Only covers resident levels if streamed.
 		const GPU::TextureDesc& GetDesc() const;
 
 		/// @return Texture handle.
 		GPU::Handle GetHandle() const;
 
+		/// @return Version, incremented whenever the handle changes due to streaming or reload.
+		i32 GetVersion() const;
+
+		/**
+		 * Request @a level be made resident. Should be called every frame the texture is used,
+		 * as textures not requested for a while are evicted. Does nothing if not streamed.
+		 * @see TextureStreaming.
+		 */
+		void RequestLevel(i32 level);
+
+		/**
+		 * @return Level required for texture to be drawn at @a screenSize pixels across.
+		 */
+		i32 GetLevelForScreenSize(f32 screenSize) const;
+
 	private:
 		Texture(const Texture&) = delete;
 		Texture& operator=(const Texture&) = delete;
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "graphics/dll.h"
+#include "core/types.h"
+
+namespace Graphics
+{
+	/**
+	 * Texture streaming statistics.
+	 */
+	struct GRAPHICS_DLL TextureStreamingStats
+	{
+		/// Number of textures being streamed.
+		i32 numTextures_ = 0;
+		/// Number of stream requests waiting on file reads.
+		i32 numPendingRequests_ = 0;
+		/// Number of times more detailed levels were streamed in.
+		i32 numStreamedIn_ = 0;
+		/// Number of times levels were evicted.
+		i32 numEvicted_ = 0;
+		/// Bytes of streamed textures currently resident.
+		i64 residentBytes_ = 0;
+		/// Bytes streamed textures would use if all requested levels were resident.
+		i64 requestedBytes_ = 0;
+		/// Memory budget for streamed textures.
+		i64 budgetBytes_ = 0;
+	};
+
+	/**
+	 * Global texture streaming.
+	 * While enabled, textures load only their tail levels, and more detailed levels are read in
+	 * asynchronously as they are requested with Texture::RequestLevel. Levels no longer requested, or
+	 * least recently requested when over budget, are evicted.
+	 * Can also be configured with "streamingBudget" (MB) in the "texture" resource settings.
+	 * @pre Texture factory must be registered.
+	 */
+	class GRAPHICS_DLL TextureStreaming final
+	{
+	public:
+		/**
+		 * Set memory budget for streamed textures.
+		 * Only textures loaded afterwards are affected by enabling or disabling streaming.
+		 * @param budgetBytes Budget in bytes. 0 disables streaming.
+		 * @param tailSize Textures are streamed down to the first level that fits within @a tailSize.
+		 */
+		static void SetBudget(i64 budgetBytes, i32 tailSize = 64);
+
+		/**
+		 * Complete finished stream requests, then issue new ones for requested levels.
+		 * Material texture bindings are updated to match.
+		 * Should be called once per frame, while no command lists using materials are being recorded.
+		 */
+		static void Update();
+
+		/**
+		 * @return Current statistics.
+		 */
+		static TextureStreamingStats GetStats();
+
+	private:
+		TextureStreaming() = delete;
+		~TextureStreaming() = delete;
+	};
+
+} // namespace Graphics
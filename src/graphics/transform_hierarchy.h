@@ -0,0 +1,89 @@
+#pragma once
+
+#include "graphics/dll.h"
+#include "core/misc.h"
+#include "core/vector.h"
+#include "math/mat44.h"
+
+namespace Graphics
+{
+	/**
+	 * Runtime node transform hierarchy.
+	 * Nodes are stored sorted by depth, so world transforms can be computed a level at a time:
+	 * every parent in a level has been computed by the previous one, and nodes within a level are
+	 * independent. Large levels are split across job workers.
+	 * Only nodes whose local transform was set since the last update, and their descendants, are recomputed.
+	 * Transforms use the same convention as the model converter: world = local * parentWorld.
+	 */
+	class GRAPHICS_DLL TransformHierarchy final
+	{
+	public:
+		TransformHierarchy() = default;
+		~TransformHierarchy() = default;
+
+		/**
+		 * Add node.
+		 * @param parentIdx Parent node, or -1 for a root.
+		 * @param local Local transform.
+		 * @return Node index.
+		 * @pre parentIdx < GetNumNodes().
+		 */
+		i32 AddNode(i32 parentIdx, const Math::Mat44& local);
+
+		/**
+		 * Remove all nodes.
+		 */
+		void Clear();
+
+		/**
+		 * Set local transform of @a nodeIdx. Its world transform, and those of its descendants,
+		 * are recomputed on the next update.
+		 */
+		void SetLocal(i32 nodeIdx, const Math::Mat44& local);
+
+		/**
+		 * Update world transforms of all dirty nodes.
+		 * @param batchSize Number of nodes per job within a level.
+		 * @return Number of world transforms computed.
+		 */
+		i32 Update(i32 batchSize = 1024);
+
+		const Math::Mat44& GetLocal(i32 nodeIdx) const { return locals_[sortedIdxs_[nodeIdx]]; }
+
+		/**
+		 * @return World transform of @a nodeIdx as of the last update.
+		 */
+		const Math::Mat44& GetWorld(i32 nodeIdx) const { return worlds_[sortedIdxs_[nodeIdx]]; }
+
+		i32 GetParent(i32 nodeIdx) const { return nodeParents_[nodeIdx]; }
+		i32 GetNumNodes() const { return nodeParents_.size(); }
+
+		/**
+		 * @return Number of levels, as of the last update.
+		 */
+		i32 GetNumLevels() const { return Core::Max(0, levelOffsets_.size() - 1); }
+
+	private:
+		void SortByDepth();
+
+		/// Per node, by node index.
+		Core::Vector<i32> nodeParents_;
+		Core::Vector<i32> nodeLevels_;
+		Core::Vector<i32> sortedIdxs_;
+
+		/// Per node, sorted by depth. Parents are sorted indices.
+		Core::Vector<Math::Mat44> locals_;
+		Core::Vector<Math::Mat44> worlds_;
+		Core::Vector<i32> parents_;
+		Core::Vector<u8> dirty_;
+
+		/// Sorted index of first node in each level, plus total number of nodes.
+		Core::Vector<i32> levelOffsets_;
+
+		/// Lowest level with a dirty node, or -1 if nothing is dirty.
+		i32 dirtyLevel_ = -1;
+		/// Nodes have been added since the last update.
+		bool unsorted_ = false;
+	};
+
+} // namespace Graphics
@@ -9,6 +9,7 @@
 #include "core/type_conversion.h"
 #include "core/vector.h"
 #include "gpu/utils.h"
+#include "job/manager.h"
 #include "math/utils.h"
 
 #include <squish.h>
@@ -419,6 +420,14 @@ namespace Image
 {
 	namespace
 	{
+		/// Maximum texels per block compression tile. Kept small so slow encoders balance across job workers.
+		static const i32 MAX_COMPRESS_TILE_TEXELS = 128 * 128;
+
+		/// Width & height of tiles processed by GenerateMipChain.
+		static const i32 MIP_CHAIN_TILE_SIZE = 64;
+		/// Levels generated per tile, until a tile is a single 4x4 block.
+		static const i32 MIP_CHAIN_TILE_LEVELS = 5;
+
 		bool SetupOutput(Image& output, const Image& input, ImageFormat outputFormat)
 		{
 			if(!output)
@@ -431,6 +440,187 @@ namespace Image
 			return output.GetWidth() == input.GetWidth() && output.GetHeight() == input.GetHeight() &&
 			       output.GetDepth() == input.GetDepth() && output.GetFormat() == outputFormat;
 		}
+
+		/**
+		 * Run @a numJobs instances of @a jobFn on job workers and wait for them.
+		 * Runs them in order on the calling thread if the job manager isn't initialized.
+		 */
+		void DispatchJobs(i32 numJobs, Job::JobFunc jobFn, void* data, const char* name)
+		{
+			if(Job::Manager::IsInitialized() && numJobs > 1)
+			{
+				Core::Vector<Job::JobDesc> jobDescs;
+				jobDescs.resize(numJobs);
+				for(i32 idx = 0; idx < jobDescs.size(); ++idx)
+				{
+					auto& jobDesc = jobDescs[idx];
+					jobDesc.func_ = jobFn;
+					jobDesc.param_ = idx;
+					jobDesc.data_ = data;
+					jobDesc.name_ = name;
+				}
+
+				Job::Counter* counter = nullptr;
+				Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+				Job::Manager::WaitForCounter(counter, 0);
+			}
+			else
+			{
+				for(i32 idx = 0; idx < numJobs; ++idx)
+					jobFn(idx, data);
+			}
+		}
+
+		using CompressFn = void(ispc::rgba_surface*, uint8_t*);
+		using CompressBc7Fn = void(ispc::rgba_surface*, uint8_t*, ispc::bc7_enc_settings*);
+
+		/**
+		 * Block compressor for a format & quality.
+		 */
+		struct BlockCompressor
+		{
+			CompressFn* compressFn_ = nullptr;
+			CompressBc7Fn* compressBc7Fn_ = nullptr;
+			ispc::bc7_enc_settings bc7Settings_ = {};
+			ispc::bc7_enc_settings bc7SettingsAlpha_ = {};
+			/// Bytes per 4x4 block.
+			i32 blockBytes_ = 0;
+
+			explicit operator bool() const { return compressFn_ || compressBc7Fn_; }
+
+			/// Compress @a surface into @a dst. @a hasAlpha selects alpha settings for BC7.
+			void Compress(ispc::rgba_surface* surface, u8* dst, bool hasAlpha) const
+			{
+				if(compressFn_)
+				{
+					compressFn_(surface, dst);
+				}
+				else
+				{
+					ispc::bc7_enc_settings settings = hasAlpha ? bc7SettingsAlpha_ : bc7Settings_;
+					compressBc7Fn_(surface, dst, &settings);
+				}
+			}
+		};
+
+		BlockCompressor GetBlockCompressor(ImageFormat format, ConvertQuality quality)
+		{
+			BlockCompressor compressor;
+			switch(format)
+			{
+			case ImageFormat::BC1_UNORM:
+			case ImageFormat::BC1_UNORM_SRGB:
+				compressor.compressFn_ = ispc::CompressBlocksBC1_ispc;
+				break;
+			case ImageFormat::BC3_UNORM:
+			case ImageFormat::BC3_UNORM_SRGB:
+				compressor.compressFn_ = ispc::CompressBlocksBC3_ispc;
+				break;
+			case ImageFormat::BC4_UNORM:
+				//case ImageFormat::BC4_SNORM:
+				compressor.compressFn_ = ispc::CompressBlocksBC4_ispc;
+				break;
+			case ImageFormat::BC5_UNORM:
+				//case ImageFormat::BC5_SNORM:
+				compressor.compressFn_ = ispc::CompressBlocksBC5_ispc;
+				break;
+			case ImageFormat::BC7_UNORM:
+			case ImageFormat::BC7_UNORM_SRGB:
+				compressor.compressBc7Fn_ = ispc::CompressBlocksBC7_ispc;
+				break;
+			}
+
+			if(!compressor)
+				return compressor;
+
+			compressor.blockBytes_ = GPU::GetFormatInfo(format).blockBits_ >> 3;
+
+			ispc::bc6h_enc_settings bc6hSettings = {};
+			ispc::etc_enc_settings etcSettings = {};
+
+			switch(quality)
+			{
+			case ConvertQuality::VERY_HIGH:
+				GetProfile_bc6h_veryslow(&bc6hSettings);
+				GetProfile_slow(&compressor.bc7Settings_);
+				GetProfile_alpha_slow(&compressor.bc7SettingsAlpha_);
+				GetProfile_etc_slow(&etcSettings);
+				break;
+			case ConvertQuality::HIGH:
+				GetProfile_bc6h_slow(&bc6hSettings);
+				GetProfile_basic(&compressor.bc7Settings_);
+				GetProfile_alpha_basic(&compressor.bc7SettingsAlpha_);
+				GetProfile_etc_slow(&etcSettings);
+				break;
+			case ConvertQuality::MEDIUM:
+				GetProfile_bc6h_basic(&bc6hSettings);
+				GetProfile_basic(&compressor.bc7Settings_);
+				GetProfile_alpha_basic(&compressor.bc7SettingsAlpha_);
+				GetProfile_etc_slow(&etcSettings);
+				break;
+			case ConvertQuality::LOW:
+				GetProfile_bc6h_fast(&bc6hSettings);
+				GetProfile_fast(&compressor.bc7Settings_);
+				GetProfile_alpha_fast(&compressor.bc7SettingsAlpha_);
+				GetProfile_etc_slow(&etcSettings);
+				break;
+			case ConvertQuality::VERY_LOW:
+				GetProfile_bc6h_veryfast(&bc6hSettings);
+				GetProfile_veryfast(&compressor.bc7Settings_);
+				GetProfile_alpha_veryfast(&compressor.bc7SettingsAlpha_);
+				GetProfile_etc_slow(&etcSettings);
+				break;
+			}
+			return compressor;
+		}
+
+		/// @return true if any of the @a w x @a h texels, with row pitch @a stride texels, are translucent.
+		bool HasAlpha(const u32* data, i32 w, i32 h, i32 stride)
+		{
+			for(i32 y = 0; y < h; ++y)
+			{
+				for(i32 x = 0; x < w; ++x)
+				{
+					SRGBAColor col = reinterpret_cast<const SRGBAColor&>(data[x + y * stride]);
+					if(col.a < 255)
+						return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Pad @a levelW x @a levelH texels out to @a paddedW x @a paddedH by repeating the last column & row.
+		 */
+		void PadData(
+		    Core::Vector<u32>& paddedData, const u32* levelData, i32 levelW, i32 levelH, i32 paddedW, i32 paddedH)
+		{
+			// Only grows, so the same memory can be reused for subsequent levels & tiles.
+			if(paddedData.size() < paddedW * paddedH)
+				paddedData.resize(paddedW * paddedH);
+
+			// Copy rows, repeating last texel.
+			const u32* srcData = levelData;
+			u32* dstData = paddedData.data();
+			for(i32 y = 0; y < levelH; ++y)
+			{
+				DBG_ASSERT(paddedData.belongs(dstData, paddedW));
+				memcpy(dstData, srcData, levelW * sizeof(u32));
+				for(i32 x = levelW; x < paddedW; ++x)
+					dstData[x] = srcData[levelW - 1];
+				srcData += levelW;
+				dstData += paddedW;
+			}
+
+			// Repeat last row.
+			srcData = paddedData.data() + ((levelH - 1) * paddedW);
+			for(i32 y = levelH; y < paddedH; ++y)
+			{
+				DBG_ASSERT(paddedData.belongs(dstData, paddedW));
+				memcpy(dstData, srcData, paddedW * sizeof(u32));
+				dstData += paddedW;
+			}
+		}
 	}
 
 
@@ -476,180 +666,80 @@ namespace Image
 			return true;
 		}
 
-		auto PadData = [](
-		    Core::Vector<u32>& paddedData, const u32* levelData, i32 levelW, i32 levelH, i32 paddedW, i32 paddedH) {
-			// Always going largest to smallest, so only need to allocate once and reuse the memory
-			// for subsequent levels.
-			if(paddedData.empty())
-				paddedData.resize(paddedW * paddedH);
-
-			// Copy rows.
-			const u32* srcData = levelData;
-			u32* dstData = paddedData.data();
-			for(i32 y = 0; y < levelH; ++y)
-			{
-				DBG_ASSERT(paddedData.belongs(dstData, levelW));
-				memcpy(dstData, srcData, levelW * sizeof(u32));
-				dstData += paddedW;
-			}
-
-			// Pad out.
-			srcData = paddedData.data() + (levelW - 1);
-			dstData = paddedData.data() + levelW;
-			for(i32 y = 0; y < paddedH; ++y)
-			{
-				const u32 src = *srcData;
-				for(i32 x = levelW; x < paddedW; ++x)
-				{
-					DBG_ASSERT(paddedData.belongs(dstData, 1));
-					*dstData++ = src;
-				}
-				srcData += paddedW;
-				dstData += levelW;
-			}
-
-			srcData = paddedData.data() + ((levelH - 1) * paddedW);
-			dstData = paddedData.data() + (levelH * paddedW);
-			for(i32 y = levelH; y < paddedH; ++y)
-			{
-				DBG_ASSERT(paddedData.belongs(dstData, levelW));
-				memcpy(dstData, srcData, levelW * sizeof(u32));
-
-				srcData += levelW;
-				dstData += paddedW;
-			}
-		};
-
 		// Block compressed support.
 		if(input.GetFormat() == ImageFormat::R8G8B8A8_UNORM)
 		{
-			using CompressFn = void(ispc::rgba_surface*, uint8_t*);
-			using CompressBc7Fn = void(ispc::rgba_surface*, uint8_t*, struct bc7_enc_settings*);
-
-			CompressFn* compressFn = nullptr;
-			CompressBc7Fn* compressBc7Fn = nullptr;
-
-			switch(output.GetFormat())
+			const BlockCompressor compressor = GetBlockCompressor(output.GetFormat(), quality);
+			if(compressor)
 			{
-			case ImageFormat::BC1_UNORM:
-			case ImageFormat::BC1_UNORM_SRGB:
-				compressFn = ispc::CompressBlocksBC1_ispc;
-				break;
-			case ImageFormat::BC3_UNORM:
-			case ImageFormat::BC3_UNORM_SRGB:
-				compressFn = ispc::CompressBlocksBC3_ispc;
-				break;
-			case ImageFormat::BC4_UNORM:
-				//case ImageFormat::BC4_SNORM:
-				compressFn = ispc::CompressBlocksBC4_ispc;
-				break;
-			case ImageFormat::BC5_UNORM:
-				//case ImageFormat::BC5_SNORM:
-				compressFn = ispc::CompressBlocksBC5_ispc;
-				break;
-			case ImageFormat::BC7_UNORM:
-			case ImageFormat::BC7_UNORM_SRGB:
-				compressBc7Fn = ispc::CompressBlocksBC7_ispc;
-				break;
-			}
-
-			if(compressFn || compressBc7Fn)
-			{
-				ispc::bc6h_enc_settings bc6hSettings = {};
-				ispc::bc7_enc_settings bc7Settings = {};
-				ispc::bc7_enc_settings bc7SettingsAlpha = {};
-				ispc::etc_enc_settings etcSettings = {};
+				// Split every level into tiles of whole block rows, so large levels spread across job
+				// workers and small levels are encoded concurrently with them.
+				struct CompressTile
+				{
+					ispc::rgba_surface surface_;
+					u8* dst_;
+					bool hasAlpha_;
+				};
 
-				switch(quality)
+				struct CompressContext
 				{
-				case ConvertQuality::VERY_HIGH:
-					GetProfile_bc6h_veryslow(&bc6hSettings);
-					GetProfile_slow(&bc7Settings);
-					GetProfile_alpha_slow(&bc7SettingsAlpha);
-					GetProfile_etc_slow(&etcSettings);
-					break;
-				case ConvertQuality::HIGH:
-					GetProfile_bc6h_slow(&bc6hSettings);
-					GetProfile_basic(&bc7Settings);
-					GetProfile_alpha_basic(&bc7SettingsAlpha);
-					GetProfile_etc_slow(&etcSettings);
-					break;
-				case ConvertQuality::MEDIUM:
-					GetProfile_bc6h_basic(&bc6hSettings);
-					GetProfile_basic(&bc7Settings);
-					GetProfile_alpha_basic(&bc7SettingsAlpha);
-					GetProfile_etc_slow(&etcSettings);
-					break;
-				case ConvertQuality::LOW:
-					GetProfile_bc6h_fast(&bc6hSettings);
-					GetProfile_fast(&bc7Settings);
-					GetProfile_alpha_fast(&bc7SettingsAlpha);
-					GetProfile_etc_slow(&etcSettings);
-					break;
-				case ConvertQuality::VERY_LOW:
-					GetProfile_bc6h_veryfast(&bc6hSettings);
-					GetProfile_veryfast(&bc7Settings);
-					GetProfile_alpha_veryfast(&bc7SettingsAlpha);
-					GetProfile_etc_slow(&etcSettings);
-					break;
-				}
+					const BlockCompressor* compressor_;
+					CompressTile* tiles_;
+				};
 
 				const i32 numLevels = Core::Min(input.GetLevels(), output.GetLevels());
 				i32 levelW = input.GetWidth();
 				i32 levelH = input.GetHeight();
 
-				Core::Vector<u32> tempPadding;
+				// Reserved up front, tiles point into padded data.
+				Core::Vector<Core::Vector<u32>> paddedLevels;
+				paddedLevels.reserve(numLevels);
 
-				for(i32 level = 0; level < output.GetLevels(); ++level)
+				Core::Vector<CompressTile> tiles;
+				for(i32 level = 0; level < numLevels; ++level)
 				{
 					const i32 paddedW = Core::PotRoundUp(levelW, 4);
 					const i32 paddedH = Core::PotRoundUp(levelH, 4);
 
 					const u32* levelData = input.GetMipData<u32>(level);
+					const bool hasAlpha = compressor.compressBc7Fn_ && HasAlpha(levelData, levelW, levelH, levelW);
 
 					// If the level data is not the correct size then we'll need to pad it out.
 					if((levelW & 3) != 0 || (levelH & 3) != 0)
 					{
-						PadData(tempPadding, levelData, levelW, levelH, paddedW, paddedH);
-						levelData = tempPadding.data();
+						paddedLevels.emplace_back();
+						PadData(paddedLevels.back(), levelData, levelW, levelH, paddedW, paddedH);
+						levelData = paddedLevels.back().data();
 					}
 
-					ispc::rgba_surface surface;
-					surface.ptr = (u8*)(levelData);
-					surface.width = paddedW;
-					surface.height = paddedH;
-					surface.stride = paddedW * sizeof(u32);
-
-					if(compressFn)
+					const i32 blocksW = paddedW / 4;
+					const i32 blocksH = paddedH / 4;
+					const i32 tileBlockRows = Core::Max(1, MAX_COMPRESS_TILE_TEXELS / (paddedW * 4));
+					for(i32 blockRow = 0; blockRow < blocksH; blockRow += tileBlockRows)
 					{
-						compressFn(&surface, output.GetMipData<u8>(level));
-					}
-					else if(compressBc7Fn)
-					{
-						// Determine settings.
-						ispc::bc7_enc_settings settings = bc7Settings;
-						for(i32 y = 0; y < levelH; ++y)
-						{
-							for(i32 x = 0; x < levelW; ++x)
-							{
-								const i32 idx = x + y * paddedW;
-								SRGBAColor col = reinterpret_cast<const SRGBAColor&>(levelData[idx]);
-
-								if(col.a < 255)
-								{
-									settings = bc7SettingsAlpha;
-									break;
-								}
-							}
-						}
-
-						compressBc7Fn(&surface, output.GetMipData<u8>(level), &settings);
+						CompressTile tile;
+						tile.surface_.ptr = (u8*)(levelData + blockRow * 4 * paddedW);
+						tile.surface_.width = paddedW;
+						tile.surface_.height = Core::Min(tileBlockRows, blocksH - blockRow) * 4;
+						tile.surface_.stride = paddedW * sizeof(u32);
+						tile.dst_ = output.GetMipData<u8>(level) + blockRow * blocksW * compressor.blockBytes_;
+						tile.hasAlpha_ = hasAlpha;
+						tiles.push_back(tile);
 					}
 
 					levelW = Core::Max(levelW >> 1, 1);
 					levelH = Core::Max(levelH >> 1, 1);
 				}
 
+				CompressContext context = {&compressor, tiles.data()};
+				DispatchJobs(tiles.size(),
+				    [](i32 param, void* data) {
+					    auto* context = reinterpret_cast<CompressContext*>(data);
+					    auto& tile = context->tiles_[param];
+					    context->compressor_->Compress(&tile.surface_, tile.dst_, tile.hasAlpha_);
+					},
+				    &context, "Image::Convert compress tile");
+
 				return true;
 			}
 		}
@@ -814,6 +904,265 @@ namespace Image
 	}
 
 
+	namespace
+	{
+		/**
+		 * Box filter @a w x @a h linear texels down to @a dstW x @a dstH.
+		 * Odd last rows & columns are dropped as with GenerateMips, unless a dimension is already 1.
+		 */
+		void DownsampleTile(ispc::Color* output, i32 dstW, i32 dstH, const ispc::Color* input, i32 w, i32 h)
+		{
+			if(w > 1 && h > 1)
+			{
+				DBG_ASSERT(dstW == w / 2 && dstH == h / 2);
+				ispc::ImageProc_Downsample2x(w, h, input, output);
+				return;
+			}
+
+			for(i32 y = 0; y < dstH; ++y)
+			{
+				const i32 y0 = Core::Min(y * 2, h - 1);
+				const i32 y1 = Core::Min(y * 2 + 1, h - 1);
+				for(i32 x = 0; x < dstW; ++x)
+				{
+					const i32 x0 = Core::Min(x * 2, w - 1);
+					const i32 x1 = Core::Min(x * 2 + 1, w - 1);
+					const ispc::Color& a = input[x0 + y0 * w];
+					const ispc::Color& b = input[x1 + y0 * w];
+					const ispc::Color& c = input[x0 + y1 * w];
+					const ispc::Color& d = input[x1 + y1 * w];
+					ispc::Color& o = output[x + y * dstW];
+					o.r = (a.r + b.r + c.r + d.r) * 0.25f;
+					o.g = (a.g + b.g + c.g + d.g) * 0.25f;
+					o.b = (a.b + b.b + c.b + d.b) * 0.25f;
+					o.a = (a.a + b.a + c.a + d.a) * 0.25f;
+				}
+			}
+		}
+
+		struct MipChainContext
+		{
+			const Image* input_ = nullptr;
+			Image* output_ = nullptr;
+			/// Compressor for output, or nullptr if output is R8G8B8A8_UNORM.
+			const BlockCompressor* compressor_ = nullptr;
+			i32 numLevels_ = 0;
+			/// Levels generated within tiles. The rest are generated from tail_.
+			i32 numTileLevels_ = 0;
+			i32 tilesX_ = 0;
+			i32 tilesY_ = 0;
+			/// Linear texels for level numTileLevels_, written by all tiles.
+			ispc::Color* tail_ = nullptr;
+			i32 tailW_ = 0;
+		};
+
+		/**
+		 * Write @a w x @a h texels into @a level of output at @a x, @a y, block compressing if required.
+		 */
+		void WriteMipChainTexels(const MipChainContext& context, Core::Vector<u32>& paddedData, i32 level, i32 x,
+		    i32 y, const u32* texels, i32 w, i32 h)
+		{
+			Image& output = *context.output_;
+			const i32 levelW = Core::Max(output.GetWidth() >> level, 1);
+			if(context.compressor_ == nullptr)
+			{
+				u32* dstData = output.GetMipData<u32>(level) + x + y * levelW;
+				for(i32 row = 0; row < h; ++row)
+					memcpy(dstData + row * levelW, texels + row * w, w * sizeof(u32));
+				return;
+			}
+
+			// Tile origins are block aligned, so only tiles on the right & bottom edges are padded.
+			DBG_ASSERT((x & 3) == 0 && (y & 3) == 0);
+			const BlockCompressor& compressor = *context.compressor_;
+			const i32 paddedW = Core::PotRoundUp(w, 4);
+			const i32 paddedH = Core::PotRoundUp(h, 4);
+			PadData(paddedData, texels, w, h, paddedW, paddedH);
+			const bool hasAlpha = compressor.compressBc7Fn_ && HasAlpha(texels, w, h, w);
+
+			// Compressor writes blocks contiguously, so encode a block row at a time.
+			const i32 levelBlocksW = Core::PotRoundUp(levelW, 4) / 4;
+			u8* dstData = output.GetMipData<u8>(level);
+			for(i32 blockY = 0; blockY < paddedH / 4; ++blockY)
+			{
+				ispc::rgba_surface surface;
+				surface.ptr = reinterpret_cast<u8*>(paddedData.data() + blockY * 4 * paddedW);
+				surface.width = paddedW;
+				surface.height = 4;
+				surface.stride = paddedW * sizeof(u32);
+
+				const i32 blockIdx = (x / 4) + ((y / 4) + blockY) * levelBlocksW;
+				compressor.Compress(&surface, dstData + blockIdx * compressor.blockBytes_, hasAlpha);
+			}
+		}
+
+		/**
+		 * Generate the tile levels for one row of tiles.
+		 * Each tile goes from source texels to encoded output for all tile levels while its
+		 * working set stays in cache.
+		 */
+		void MipChainTileRowJob(i32 tileY, void* data)
+		{
+			const auto& context = *reinterpret_cast<const MipChainContext*>(data);
+			const Image& input = *context.input_;
+			const i32 inputW = input.GetWidth();
+
+			// Scratch is reused for every tile in the row.
+			Core::Vector<u32> texels;
+			Core::Vector<u32> paddedData;
+			Core::Vector<ispc::Color> linearA;
+			Core::Vector<ispc::Color> linearB;
+			texels.resize(MIP_CHAIN_TILE_SIZE * MIP_CHAIN_TILE_SIZE);
+			linearA.resize(MIP_CHAIN_TILE_SIZE * MIP_CHAIN_TILE_SIZE);
+			linearB.resize(MIP_CHAIN_TILE_SIZE * MIP_CHAIN_TILE_SIZE);
+
+			for(i32 tileX = 0; tileX < context.tilesX_; ++tileX)
+			{
+				i32 x = tileX * MIP_CHAIN_TILE_SIZE;
+				i32 y = tileY * MIP_CHAIN_TILE_SIZE;
+				i32 w = Core::Min(MIP_CHAIN_TILE_SIZE, inputW - x);
+				i32 h = Core::Min(MIP_CHAIN_TILE_SIZE, input.GetHeight() - y);
+
+				// Top level is the source texels.
+				const u32* srcData = input.GetMipData<u32>(0) + x + y * inputW;
+				for(i32 row = 0; row < h; ++row)
+					memcpy(texels.data() + row * w, srcData + row * inputW, w * sizeof(u32));
+				WriteMipChainTexels(context, paddedData, 0, x, y, texels.data(), w, h);
+
+				ispc::Color* curr = linearA.data();
+				ispc::Color* next = linearB.data();
+				ispc::ImageProc_Unpack_R8G8B8A8(w * h, reinterpret_cast<ispc::Color_R8G8B8A8*>(texels.data()), curr);
+				ispc::ImageProc_GammaToLinear(w, h, curr, curr);
+
+				for(i32 level = 1; level < context.numLevels_; ++level)
+				{
+					// Dimensions only clamp to 1 when there is a single tile along that axis.
+					const i32 nextW = context.tilesX_ == 1 ? Core::Max(w >> 1, 1) : w >> 1;
+					const i32 nextH = context.tilesY_ == 1 ? Core::Max(h >> 1, 1) : h >> 1;
+					if(nextW == 0 || nextH == 0)
+						break;
+
+					DownsampleTile(next, nextW, nextH, curr, w, h);
+					std::swap(curr, next);
+					w = nextW;
+					h = nextH;
+					x >>= 1;
+					y >>= 1;
+
+					// Remaining levels span multiple tiles, hand over to the tail.
+					if(level == context.numTileLevels_)
+					{
+						for(i32 row = 0; row < h; ++row)
+						{
+							memcpy(context.tail_ + x + (y + row) * context.tailW_, curr + row * w,
+							    w * sizeof(ispc::Color));
+						}
+						break;
+					}
+
+					ispc::ImageProc_LinearToGamma(w, h, curr, next);
+					ispc::ImageProc_Pack_R8G8B8A8(w * h, next, reinterpret_cast<ispc::Color_R8G8B8A8*>(texels.data()));
+					WriteMipChainTexels(context, paddedData, level, x, y, texels.data(), w, h);
+				}
+			}
+		}
+	}
+
+
+	bool GenerateMipChain(Image& output, const Image& input, const MipChainParams& params)
+	{
+		if(input.GetFormat() != ImageFormat::R8G8B8A8_UNORM || input.GetType() != ImageType::TEX2D ||
+		    input.GetDepth() != 1)
+			return false;
+
+		const i32 width = input.GetWidth();
+		const i32 height = input.GetHeight();
+		const i32 maxLevels = 32 - Core::CountLeadingZeros((u32)Core::Max(width, height));
+		const i32 numLevels = params.levels_ > 0 ? Core::Min(params.levels_, maxLevels) : maxLevels;
+
+		BlockCompressor compressor;
+		if(params.format_ != ImageFormat::R8G8B8A8_UNORM)
+		{
+			compressor = GetBlockCompressor(params.format_, params.quality_);
+			if(!compressor)
+				return false;
+		}
+
+		Image newOutput(ImageType::TEX2D, params.format_, width, height, 1, numLevels, nullptr, nullptr);
+
+		MipChainContext context;
+		context.input_ = &input;
+		context.output_ = &newOutput;
+		context.compressor_ = compressor ? &compressor : nullptr;
+		context.numLevels_ = numLevels;
+		context.numTileLevels_ = Core::Min(numLevels, MIP_CHAIN_TILE_LEVELS);
+		context.tilesX_ = (width + MIP_CHAIN_TILE_SIZE - 1) / MIP_CHAIN_TILE_SIZE;
+		context.tilesY_ = (height + MIP_CHAIN_TILE_SIZE - 1) / MIP_CHAIN_TILE_SIZE;
+
+		const i32 tailLevel = context.numTileLevels_;
+		i32 levelW = Core::Max(width >> tailLevel, 1);
+		i32 levelH = Core::Max(height >> tailLevel, 1);
+		Core::Vector<ispc::Color> tailA;
+		Core::Vector<ispc::Color> tailB;
+		if(tailLevel < numLevels)
+		{
+			tailA.resize(levelW * levelH);
+			tailB.resize(levelW * levelH);
+			context.tail_ = tailA.data();
+			context.tailW_ = levelW;
+		}
+
+		DispatchJobs(context.tilesY_, MipChainTileRowJob, &context, "Image::GenerateMipChain");
+
+		// Tail is at most 1/1024th of the source, so is generated on the calling thread.
+		if(tailLevel < numLevels)
+		{
+			Image tailImage(ImageType::TEX2D, ImageFormat::R8G8B8A8_UNORM, levelW, levelH, 1, numLevels - tailLevel,
+			    nullptr, nullptr);
+
+			ispc::Color* curr = tailA.data();
+			ispc::Color* next = tailB.data();
+			for(i32 level = tailLevel; level < numLevels; ++level)
+			{
+				ispc::ImageProc_LinearToGamma(levelW, levelH, curr, next);
+				ispc::ImageProc_Pack_R8G8B8A8(
+				    levelW * levelH, next, tailImage.GetMipData<ispc::Color_R8G8B8A8>(level - tailLevel));
+
+				if(level < numLevels - 1)
+				{
+					const i32 nextW = Core::Max(levelW >> 1, 1);
+					const i32 nextH = Core::Max(levelH >> 1, 1);
+					DownsampleTile(next, nextW, nextH, curr, levelW, levelH);
+					std::swap(curr, next);
+					levelW = nextW;
+					levelH = nextH;
+				}
+			}
+
+			if(compressor)
+			{
+				Image encoded;
+				if(!Convert(encoded, tailImage, params.format_, params.quality_))
+					return false;
+				std::swap(tailImage, encoded);
+			}
+
+			levelW = tailImage.GetWidth();
+			levelH = tailImage.GetHeight();
+			for(i32 level = 0; level < tailImage.GetLevels(); ++level)
+			{
+				const i64 levelBytes = GPU::GetTextureSize(params.format_, levelW, levelH, 1, 1, 1);
+				memcpy(newOutput.GetMipData<u8>(tailLevel + level), tailImage.GetMipData<u8>(level), levelBytes);
+				levelW = Core::Max(levelW >> 1, 1);
+				levelH = Core::Max(levelH >> 1, 1);
+			}
+		}
+
+		std::swap(output, newOutput);
+		return true;
+	}
+
+
 	RGBAColor CalculatePSNR(const Image& base, const Image& compare)
 	{
 		RGBAColor psnr = INFINITE_PSNR_RGBA;
@@ -33,6 +33,8 @@ namespace Image
 	/**
 	 * Convert @a input image to @a outFormat. 
 	 * @a output will be created if not provided.
+	 * Block compression is split into tiles of block rows across all levels, and encoded on job
+	 * workers if the job manager is initialized.
 	 * @return success.
 	 */
 	IMAGE_DLL bool Convert(
@@ -68,6 +70,34 @@ namespace Image
 	 */
 	IMAGE_DLL bool GenerateMips(Image& output, const Image& input);
 
+	/**
+	 * Parameters for GenerateMipChain.
+	 */
+	struct IMAGE_DLL MipChainParams
+	{
+		/// Output format. R8G8B8A8_UNORM or a block compressed format supported by Convert.
+		ImageFormat format_ = ImageFormat::R8G8B8A8_UNORM;
+		/// Quality for block compression.
+		ConvertQuality quality_ = ConvertQuality::MEDIUM;
+		/// Number of levels to generate. 0 for the full chain.
+		i32 levels_ = 0;
+	};
+
+	/**
+	 * Generate a mip chain from a gamma space image, and encode it to the output format.
+	 * Equivalent to Convert to float, GammaToLinear, GenerateMips, LinearToGamma, then Convert back
+	 * (and to the output format), but fused into a single pass over tiles of the input. Only per-tile
+	 * floating point scratch is allocated rather than full float copies of the image, and tiles are
+	 * processed on job workers if the job manager is initialized.
+	 * @a output will always be created.
+	 * @param output Output image.
+	 * @param input Input image.
+	 * @param params Parameters.
+	 * @pre @a input is a 2D R8G8B8A8_UNORM image with depth of 1. Only level 0 is read.
+	 * @return success.
+	 */
+	IMAGE_DLL bool GenerateMipChain(Image& output, const Image& input, const MipChainParams& params);
+
 	/**
 	 * Calculate PSNR.
 	 * @param base Base image.
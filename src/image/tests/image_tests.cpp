@@ -5,9 +5,14 @@
 #include "image/save.h"
 
 #include "core/array.h"
+#include "core/concurrency.h"
 #include "core/file.h"
 #include "core/function.h"
 #include "core/misc.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "gpu/utils.h"
+#include "job/manager.h"
 
 #include "catch.hpp"
 
@@ -31,23 +36,25 @@ namespace
 		MAX
 	};
 
-	Image::Image CreateTestImage(PatternType patternType, Image::RGBAColor color, i32 numLevels = 1)
+	Image::Image CreateTestImage(
+	    PatternType patternType, Image::RGBAColor color, i32 numLevels = 1, i32 size = TEST_SIZE)
 	{
 		auto image = Image::Image(
-		    GPU::TextureType::TEX2D, GPU::Format::R8G8B8A8_UNORM, TEST_SIZE, TEST_SIZE, 1, numLevels, nullptr, nullptr);
+		    GPU::TextureType::TEX2D, GPU::Format::R8G8B8A8_UNORM, size, size, 1, numLevels, nullptr, nullptr);
 
 		if(image)
 		{
-			Core::Array<Core::Function<u32(i32, i32, i32, Image::RGBAColor)>, (i32)PatternType::MAX> patternFns = {
-			    [](i32 x, i32 y, i32 l, Image::RGBAColor color) -> u32 { return Image::ToSRGBA(color); },
-			    [](i32 x, i32 y, i32 l, Image::RGBAColor color) -> u32 {
-				    const f32 xf = (f32)(x << l) / (f32)(TEST_SIZE - 1);
-				    const f32 yf = (f32)(y << l) / (f32)(TEST_SIZE - 1);
+			using PatternFn = Core::Function<u32(i32, i32, i32, i32, Image::RGBAColor)>;
+			Core::Array<PatternFn, (i32)PatternType::MAX> patternFns = {
+			    [](i32 x, i32 y, i32 l, i32 size, Image::RGBAColor color) -> u32 { return Image::ToSRGBA(color); },
+			    [](i32 x, i32 y, i32 l, i32 size, Image::RGBAColor color) -> u32 {
+				    const f32 xf = (f32)(x << l) / (f32)(size - 1);
+				    const f32 yf = (f32)(y << l) / (f32)(size - 1);
 				    return Image::ToSRGBA(Image::RGBAColor(xf, yf, 0.0f, 1.0f));
 				},
-			    [](i32 x, i32 y, i32 l, Image::RGBAColor color) -> u32 {
-				    const f32 xf = (f32)(x << l) / (f32)(TEST_SIZE - 1);
-				    const f32 yf = (f32)(y << l) / (f32)(TEST_SIZE - 1);
+			    [](i32 x, i32 y, i32 l, i32 size, Image::RGBAColor color) -> u32 {
+				    const f32 xf = (f32)(x << l) / (f32)(size - 1);
+				    const f32 yf = (f32)(y << l) / (f32)(size - 1);
 				    auto hsv = Image::HSVColor(xf, 1.0f, yf);
 				    auto rgba = Image::ToRGB(hsv) * color;
 				    auto srgb = Image::ToSRGBA(rgba);
@@ -65,7 +72,7 @@ namespace
 					i32 idx = y * w;
 					for(i32 x = 0; x < w; ++x)
 					{
-						data[idx] = patternFn(x, y, l, color);
+						data[idx] = patternFn(x, y, l, size, color);
 						++idx;
 					}
 				}
@@ -147,6 +154,172 @@ TEST_CASE("image-tests-convert")
 #endif
 }
 
+TEST_CASE("image-tests-compress-benchmark")
+{
+	const i32 BENCHMARK_SIZE = 1024;
+	i32 levels = 32 - Core::CountLeadingZeros((u32)BENCHMARK_SIZE);
+	auto image = CreateTestImage(
+	    PatternType::HUE_GRADIENT, Image::RGBAColor(1.0f, 1.0f, 1.0f, 1.0f), levels, BENCHMARK_SIZE);
+	REQUIRE(image);
+
+	struct BenchmarkCase
+	{
+		Image::ImageFormat format_;
+		Image::ConvertQuality quality_;
+		const char* name_;
+	};
+
+	const BenchmarkCase cases[] = {
+	    {Image::ImageFormat::BC1_UNORM, Image::ConvertQuality::MEDIUM, "BC1 (MEDIUM)"},
+	    {Image::ImageFormat::BC3_UNORM, Image::ConvertQuality::MEDIUM, "BC3 (MEDIUM)"},
+	    {Image::ImageFormat::BC4_UNORM, Image::ConvertQuality::MEDIUM, "BC4 (MEDIUM)"},
+	    {Image::ImageFormat::BC5_UNORM, Image::ConvertQuality::MEDIUM, "BC5 (MEDIUM)"},
+	    {Image::ImageFormat::BC7_UNORM, Image::ConvertQuality::VERY_LOW, "BC7 (VERY_LOW)"},
+	    {Image::ImageFormat::BC7_UNORM, Image::ConvertQuality::LOW, "BC7 (LOW)"},
+	    {Image::ImageFormat::BC7_UNORM, Image::ConvertQuality::MEDIUM, "BC7 (MEDIUM)"},
+	    {Image::ImageFormat::BC7_UNORM, Image::ConvertQuality::HIGH, "BC7 (HIGH)"},
+	    {Image::ImageFormat::BC7_UNORM, Image::ConvertQuality::VERY_HIGH, "BC7 (VERY_HIGH)"},
+	};
+	const i32 numCases = sizeof(cases) / sizeof(cases[0]);
+
+	f64 numMPix = 0.0;
+	for(i32 level = 0; level < levels; ++level)
+	{
+		const i32 levelSize = Core::Max(BENCHMARK_SIZE >> level, 1);
+		numMPix += (f64)(levelSize * levelSize) / 1000000.0;
+	}
+
+	// Single threaded when job manager isn't initialized.
+	Core::Vector<Image::Image> singleOutputs;
+	Core::Vector<f64> singleTimes;
+	singleOutputs.resize(numCases);
+	singleTimes.resize(numCases);
+	for(i32 idx = 0; idx < numCases; ++idx)
+	{
+		Core::Timer timer;
+		timer.Mark();
+		REQUIRE(Image::Convert(singleOutputs[idx], image, cases[idx].format_, cases[idx].quality_));
+		singleTimes[idx] = timer.GetTime();
+	}
+
+	const i32 numWorkers = Core::GetNumLogicalCores();
+	Job::Manager::Scoped jobManager(numWorkers, 256, 32 * 1024);
+
+	Core::Log("Block compression, %dx%d, %d levels:\n", BENCHMARK_SIZE, BENCHMARK_SIZE, levels);
+	for(i32 idx = 0; idx < numCases; ++idx)
+	{
+		Image::Image output;
+		Core::Timer timer;
+		timer.Mark();
+		REQUIRE(Image::Convert(output, image, cases[idx].format_, cases[idx].quality_));
+		const f64 time = timer.GetTime();
+
+		// Tiled encode must match single threaded encode exactly.
+		for(i32 level = 0; level < levels; ++level)
+		{
+			const i32 levelSize = Core::Max(BENCHMARK_SIZE >> level, 1);
+			const i64 levelBytes = GPU::GetTextureSize(cases[idx].format_, levelSize, levelSize, 1, 1, 1);
+			REQUIRE(memcmp(singleOutputs[idx].GetMipData<u8>(level), output.GetMipData<u8>(level), levelBytes) == 0);
+		}
+
+		Core::Log(" - %-16s %8.2f MPix/s (1 thread), %8.2f MPix/s (%d workers)\n", cases[idx].name_,
+		    numMPix / singleTimes[idx], numMPix / time, numWorkers);
+	}
+}
+
+TEST_CASE("image-tests-mip-chain")
+{
+	// Square, and non power of 2 with partial tiles.
+	const i32 sizes[][2] = {{TEST_SIZE, TEST_SIZE}, {300, 200}};
+	for(const auto& size : sizes)
+	{
+		const i32 width = size[0];
+		const i32 height = size[1];
+		const i32 levels = 32 - Core::CountLeadingZeros((u32)Core::Max(width, height));
+
+		Image::Image image(
+		    GPU::TextureType::TEX2D, GPU::Format::R8G8B8A8_UNORM, width, height, 1, 1, nullptr, nullptr);
+		REQUIRE(image);
+		u32* data = image.GetMipData<u32>(0);
+		for(i32 y = 0; y < height; ++y)
+		{
+			for(i32 x = 0; x < width; ++x)
+			{
+				auto hsv = Image::HSVColor((f32)x / (f32)(width - 1), 1.0f, (f32)y / (f32)(height - 1));
+				data[x + y * width] = Image::ToSRGBA(Image::ToRGB(hsv));
+			}
+		}
+
+		// Reference is the unfused chain.
+		Image::Image lsImage(GPU::TextureType::TEX2D, GPU::Format::R32G32B32A32_FLOAT, width, height, 1, levels,
+		    nullptr, nullptr);
+		Image::Image refImage(
+		    GPU::TextureType::TEX2D, GPU::Format::R8G8B8A8_UNORM, width, height, 1, levels, nullptr, nullptr);
+		REQUIRE(Image::Convert(lsImage, image, Image::ImageFormat::R32G32B32A32_FLOAT));
+		REQUIRE(Image::GammaToLinear(lsImage, lsImage));
+		REQUIRE(Image::GenerateMips(lsImage, lsImage));
+		REQUIRE(Image::LinearToGamma(lsImage, lsImage));
+		REQUIRE(Image::Convert(refImage, lsImage, Image::ImageFormat::R8G8B8A8_UNORM));
+
+		Image::MipChainParams params;
+		Image::Image output;
+		REQUIRE(Image::GenerateMipChain(output, image, params));
+		REQUIRE(output.GetLevels() == levels);
+		REQUIRE(output.GetFormat() == Image::ImageFormat::R8G8B8A8_UNORM);
+
+		i32 levelW = width;
+		i32 levelH = height;
+		bool skipLevel = false;
+		for(i32 level = 0; level < levels; ++level)
+		{
+			// GenerateMips doesn't write levels downsampled from a single row or column.
+			if(!skipLevel)
+			{
+				const u8* refData = refImage.GetMipData<u8>(level);
+				const u8* outData = output.GetMipData<u8>(level);
+				i32 maxDiff = 0;
+				for(i32 idx = 0; idx < levelW * levelH * 4; ++idx)
+					maxDiff = Core::Max(maxDiff, std::abs((i32)refData[idx] - (i32)outData[idx]));
+				CHECK(maxDiff <= 1);
+			}
+
+			skipLevel = levelW == 1 || levelH == 1;
+			levelW = Core::Max(levelW >> 1, 1);
+			levelH = Core::Max(levelH >> 1, 1);
+		}
+
+		// Encoded output must match when tiles are run on job workers.
+		params.format_ = Image::ImageFormat::BC1_UNORM;
+		Image::Image encoded;
+		REQUIRE(Image::GenerateMipChain(encoded, image, params));
+		{
+			Job::Manager::Scoped jobManager(Core::GetNumLogicalCores(), 256, 32 * 1024);
+			for(auto format : {Image::ImageFormat::R8G8B8A8_UNORM, Image::ImageFormat::BC1_UNORM})
+			{
+				const Image::Image& compare = format == Image::ImageFormat::BC1_UNORM ? encoded : output;
+				params.format_ = format;
+				Image::Image jobOutput;
+				REQUIRE(Image::GenerateMipChain(jobOutput, image, params));
+
+				levelW = width;
+				levelH = height;
+				for(i32 level = 0; level < levels; ++level)
+				{
+					const i64 levelBytes = GPU::GetTextureSize(format, levelW, levelH, 1, 1, 1);
+					REQUIRE(memcmp(compare.GetMipData<u8>(level), jobOutput.GetMipData<u8>(level), levelBytes) == 0);
+					levelW = Core::Max(levelW >> 1, 1);
+					levelH = Core::Max(levelH >> 1, 1);
+				}
+			}
+		}
+
+		params.format_ = Image::ImageFormat::BC7_UNORM;
+		params.quality_ = Image::ConvertQuality::VERY_LOW;
+		REQUIRE(Image::GenerateMipChain(encoded, image, params));
+		REQUIRE(encoded.GetFormat() == Image::ImageFormat::BC7_UNORM);
+	}
+}
+
 TEST_CASE("image-tests-process")
 {
 	const f32 MINIMUM_PSNR = 30.0f;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "job/dll.h"
+#include "job/types.h"
+#include "core/function.h"
+
+namespace Job
+{
+	/// Parallel for function, called with the range [begin, end).
+	using ParallelForFunction = Core::Function<void(i32, i32), 64>;
+
+	/**
+	 * Split [0, @a num) into ranges of @a batchSize and call @a func for each of them on job workers.
+	 * Blocks until all ranges are complete. Ranges are run in order on the calling thread if the job
+	 * manager isn't initialized, or if there is only a single range.
+	 * @param name Name of jobs for profiling.
+	 * @param num Number of items.
+	 * @param batchSize Number of items per job.
+	 * @param func Function to call for each range.
+	 * @pre batchSize > 0.
+	 */
+	JOB_DLL void ParallelFor(const char* name, i32 num, i32 batchSize, const ParallelForFunction& func);
+
+} // namespace Job
@@ -0,0 +1,57 @@
+#include "job/parallel_for.h"
+#include "job/manager.h"
+#include "core/misc.h"
+#include "core/vector.h"
+
+namespace Job
+{
+	namespace
+	{
+		struct ParallelForData
+		{
+			const ParallelForFunction* func_ = nullptr;
+			i32 num_ = 0;
+			i32 batchSize_ = 0;
+		};
+	}
+
+	void ParallelFor(const char* name, i32 num, i32 batchSize, const ParallelForFunction& func)
+	{
+		DBG_ASSERT(batchSize > 0);
+		if(num <= 0)
+			return;
+
+		const i32 numBatches = (num + batchSize - 1) / batchSize;
+		if(!Manager::IsInitialized() || numBatches == 1)
+		{
+			for(i32 begin = 0; begin < num; begin += batchSize)
+				func(begin, Core::Min(begin + batchSize, num));
+			return;
+		}
+
+		ParallelForData data;
+		data.func_ = &func;
+		data.num_ = num;
+		data.batchSize_ = batchSize;
+
+		Core::Vector<JobDesc> jobDescs;
+		jobDescs.resize(numBatches);
+		for(i32 idx = 0; idx < numBatches; ++idx)
+		{
+			auto& jobDesc = jobDescs[idx];
+			jobDesc.func_ = [](i32 param, void* data) {
+				const auto* parallelFor = reinterpret_cast<const ParallelForData*>(data);
+				const i32 begin = param * parallelFor->batchSize_;
+				(*parallelFor->func_)(begin, Core::Min(begin + parallelFor->batchSize_, parallelFor->num_));
+			};
+			jobDesc.param_ = idx;
+			jobDesc.data_ = &data;
+			jobDesc.name_ = name;
+		}
+
+		Counter* counter = nullptr;
+		Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+		Manager::WaitForCounter(counter, 0);
+	}
+
+} // namespace Job
@@ -0,0 +1,113 @@
+#include "job/radix_sort.h"
+#include "job/manager.h"
+#include "job/parallel_for.h"
+#include "core/misc.h"
+
+#include <cstring>
+
+namespace Job
+{
+	namespace
+	{
+		static const i32 RADIX_BITS = 8;
+		static const i32 RADIX_SIZE = 1 << RADIX_BITS;
+		static const i32 NUM_DIGITS = 64 / RADIX_BITS;
+
+		/// Minimum number of keys per job.
+		static const i32 MIN_CHUNK_SIZE = 16 * 1024;
+		static const i32 MAX_CHUNKS = 64;
+
+		i32 GetDigit(u64 key, i32 digit) { return (i32)((key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1)); }
+	}
+
+	void RadixSort(Core::Vector<u64>& keys, Core::Vector<i32>& values)
+	{
+		DBG_ASSERT(keys.size() == values.size());
+		const i32 num = keys.size();
+		if(num <= 1)
+			return;
+
+		const i32 maxChunks = Manager::IsInitialized() ? Core::Clamp(num / MIN_CHUNK_SIZE, 1, MAX_CHUNKS) : 1;
+		const i32 chunkSize = (num + maxChunks - 1) / maxChunks;
+		const i32 numChunks = (num + chunkSize - 1) / chunkSize;
+
+		// Histograms for every digit, only used to find digits that can be skipped.
+		Core::Vector<i32> histograms;
+		histograms.resize(numChunks * NUM_DIGITS * RADIX_SIZE);
+		ParallelFor("Job::RadixSort histogram", num, chunkSize, [&](i32 begin, i32 end) {
+			i32* histogram = histograms.data() + (begin / chunkSize) * NUM_DIGITS * RADIX_SIZE;
+			for(i32 idx = begin; idx < end; ++idx)
+			{
+				const u64 key = keys[idx];
+				for(i32 digit = 0; digit < NUM_DIGITS; ++digit)
+					histogram[digit * RADIX_SIZE + GetDigit(key, digit)]++;
+			}
+		});
+
+		Core::Vector<u64> tmpKeys;
+		Core::Vector<i32> tmpValues;
+		tmpKeys.resize(num);
+		tmpValues.resize(num);
+
+		// Output offset of each bucket for each chunk, for the current digit.
+		Core::Vector<i32> offsets;
+		offsets.resize(numChunks * RADIX_SIZE);
+
+		for(i32 digit = 0; digit < NUM_DIGITS; ++digit)
+		{
+			// Skip digit if all keys share it.
+			bool skip = false;
+			for(i32 bucket = 0; bucket < RADIX_SIZE && !skip; ++bucket)
+			{
+				i32 total = 0;
+				for(i32 chunk = 0; chunk < numChunks; ++chunk)
+					total += histograms[(chunk * NUM_DIGITS + digit) * RADIX_SIZE + bucket];
+				skip = total == num;
+			}
+			if(skip)
+				continue;
+
+			// Keys have been reordered by previous passes, so recount per chunk for this digit.
+			ParallelFor("Job::RadixSort count", num, chunkSize, [&](i32 begin, i32 end) {
+				i32* count = offsets.data() + (begin / chunkSize) * RADIX_SIZE;
+				memset(count, 0, sizeof(i32) * RADIX_SIZE);
+				for(i32 idx = begin; idx < end; ++idx)
+					count[GetDigit(keys[idx], digit)]++;
+			});
+
+			// Exclusive prefix sum, bucket major then chunk, so the scatter is stable.
+			i32 offset = 0;
+			for(i32 bucket = 0; bucket < RADIX_SIZE; ++bucket)
+			{
+				for(i32 chunk = 0; chunk < numChunks; ++chunk)
+				{
+					i32& count = offsets[chunk * RADIX_SIZE + bucket];
+					const i32 chunkCount = count;
+					count = offset;
+					offset += chunkCount;
+				}
+			}
+
+			const u64* srcKeys = keys.data();
+			const i32* srcValues = values.data();
+			u64* dstKeys = tmpKeys.data();
+			i32* dstValues = tmpValues.data();
+			i32* chunkOffsets = offsets.data();
+			ParallelFor("Job::RadixSort scatter", num, chunkSize,
+			    [srcKeys, srcValues, dstKeys, dstValues, chunkOffsets, chunkSize, digit](i32 begin, i32 end) {
+				    i32* offset = chunkOffsets + (begin / chunkSize) * RADIX_SIZE;
+				    for(i32 idx = begin; idx < end; ++idx)
+				    {
+					    const u64 key = srcKeys[idx];
+					    const i32 dst = offset[GetDigit(key, digit)]++;
+					    dstKeys[dst] = key;
+					    dstValues[dst] = srcValues[idx];
+				    }
+				});
+
+			keys.swap(tmpKeys);
+			values.swap(tmpValues);
+		}
+	}
+
+} // namespace Job
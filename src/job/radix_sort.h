@@ -0,0 +1,17 @@
+#pragma once
+
+#include "job/dll.h"
+#include "core/vector.h"
+
+namespace Job
+{
+	/**
+	 * Stable sort of @a keys, applying the same reordering to @a values.
+	 * LSD radix sort on 8 bit digits, with histogram and scatter passes split across job workers.
+	 * Digits that are the same for all keys are skipped, so keys only using low bits sort faster.
+	 * Runs on the calling thread if the job manager isn't initialized.
+	 * @pre keys.size() == values.size().
+	 */
+	JOB_DLL void RadixSort(Core::Vector<u64>& keys, Core::Vector<i32>& values);
+
+} // namespace Job
@@ -3,12 +3,17 @@
 #include "catch.hpp"
 
 #include "core/concurrency.h"
+#include "core/pair.h"
 #include "core/timer.h"
 #include "core/vector.h"
 #include "job/basic_job.h"
 #include "job/concurrency.h"
 #include "job/function_job.h"
 #include "job/manager.h"
+#include "job/parallel_for.h"
+#include "job/radix_sort.h"
+
+#include <algorithm>
 
 using namespace Core;
 
@@ -318,3 +323,130 @@ TEST_CASE("job-tests-3-jobs")
 
 	REQUIRE(result == (VALUE1 + VALUE2));
 }
+
+TEST_CASE("job-tests-parallel-for")
+{
+	const i32 NUM_ITEMS = 10007;
+	Core::Vector<i32> items;
+	items.resize(NUM_ITEMS, 0);
+
+	auto RunParallelFor = [&items](i32 batchSize) {
+		for(auto& item : items)
+			item = 0;
+		Job::ParallelFor("parallelFor", items.size(), batchSize, [&items](i32 begin, i32 end) {
+			for(i32 idx = begin; idx < end; ++idx)
+				items[idx] += idx;
+		});
+		for(i32 idx = 0; idx < items.size(); ++idx)
+			REQUIRE(items[idx] == idx);
+	};
+
+	// Without manager, runs on calling thread.
+	RunParallelFor(1000);
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+	RunParallelFor(1);
+	RunParallelFor(64);
+	RunParallelFor(1000);
+	RunParallelFor(NUM_ITEMS);
+}
+
+namespace
+{
+	void FillRadixSortKeys(Core::Vector<u64>& keys, Core::Vector<i32>& values, i32 num, u64 mask)
+	{
+		u64 state = 0x9e3779b97f4a7c15ULL;
+		keys.resize(num);
+		values.resize(num);
+		for(i32 idx = 0; idx < num; ++idx)
+		{
+			// xorshift64, avoids the low quality low bits of a plain LCG.
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			keys[idx] = state & mask;
+			values[idx] = idx;
+		}
+	}
+
+	void CheckRadixSort(i32 num, u64 mask)
+	{
+		Core::Vector<u64> keys;
+		Core::Vector<i32> values;
+		FillRadixSortKeys(keys, values, num, mask);
+		const Core::Vector<u64> original = keys;
+
+		Job::RadixSort(keys, values);
+		REQUIRE(keys.size() == num);
+		REQUIRE(values.size() == num);
+		for(i32 idx = 0; idx < num; ++idx)
+		{
+			REQUIRE(keys[idx] == original[values[idx]]);
+			if(idx > 0)
+			{
+				REQUIRE(keys[idx - 1] <= keys[idx]);
+				// Stable.
+				if(keys[idx - 1] == keys[idx])
+					REQUIRE(values[idx - 1] < values[idx]);
+			}
+		}
+	}
+}
+
+TEST_CASE("job-tests-radix-sort")
+{
+	CheckRadixSort(0, ~0ULL);
+	CheckRadixSort(1, ~0ULL);
+	CheckRadixSort(1000, ~0ULL);
+	CheckRadixSort(1000, 0xff00ff);
+	CheckRadixSort(100000, 0xf0000000000000ffULL);
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+	CheckRadixSort(1000, ~0ULL);
+	CheckRadixSort(100000, ~0ULL);
+	CheckRadixSort(100000, 0xf0000000000000ffULL);
+	CheckRadixSort(1000003, ~0ULL);
+}
+
+TEST_CASE("job-tests-radix-sort-benchmark")
+{
+	// Same shape as render packet sort keys: 1M keys sorted with their packet indices.
+	const i32 NUM_KEYS = 1024 * 1024;
+	const i32 NUM_ITERATIONS = 8;
+
+	Core::Vector<u64> keys;
+	Core::Vector<i32> values;
+
+	auto Measure = [&](const char* name, auto sortFn) {
+		f64 time = 0.0;
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+		{
+			FillRadixSortKeys(keys, values, NUM_KEYS, ~0ULL);
+			Timer timer;
+			timer.Mark();
+			sortFn();
+			time += timer.GetTime();
+		}
+		Core::Log("Sort %d keys (%s): %f ms\n", NUM_KEYS, name, (time / NUM_ITERATIONS) * 1000.0);
+	};
+
+	auto StdSort = [&]() {
+		Core::Vector<Core::Pair<u64, i32>> pairs;
+		pairs.resize(keys.size());
+		for(i32 idx = 0; idx < keys.size(); ++idx)
+			pairs[idx] = Core::Pair<u64, i32>(keys[idx], values[idx]);
+		std::stable_sort(pairs.begin(), pairs.end(),
+		    [](const Core::Pair<u64, i32>& a, const Core::Pair<u64, i32>& b) { return a.first < b.first; });
+		for(i32 idx = 0; idx < keys.size(); ++idx)
+		{
+			keys[idx] = pairs[idx].first;
+			values[idx] = pairs[idx].second;
+		}
+	};
+
+	Measure("std::stable_sort", StdSort);
+	Measure("radix, single threaded", [&]() { Job::RadixSort(keys, values); });
+
+	Job::Manager::Scoped manager(Core::GetNumLogicalCores(), MAX_FIBERS, FIBER_STACK_SIZE);
+	Measure("radix, job workers", [&]() { Job::RadixSort(keys, values); });
+}
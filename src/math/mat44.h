@@ -9,11 +9,12 @@ namespace Math
 {
 	/**
 	 * 4x4 Matrix.
+	 * Rows are 16 byte aligned for SIMD loads & stores.
 	 */
 	class MATH_DLL Mat44 final
 	{
 	private:
-		Vec4 Row0_;
+		alignas(16) Vec4 Row0_;
 		Vec4 Row1_;
 		Vec4 Row2_;
 		Vec4 Row3_;
@@ -1,4 +1,5 @@
 #include "math/aabb.h"
+#include "math/simd.h"
 #include "core/float.h"
 #include "core/debug.h"
 #include "core/misc.h"
@@ -204,17 +205,26 @@ namespace Math
 
 	AABB AABB::Transform(const Mat44& Transform) const
 	{
-		AABB NewAABB;
-
-		// Add transformed corners.
-		NewAABB.ExpandBy(Corner(0) * Transform);
-		NewAABB.ExpandBy(Corner(1) * Transform);
-		NewAABB.ExpandBy(Corner(2) * Transform);
-		NewAABB.ExpandBy(Corner(3) * Transform);
-		NewAABB.ExpandBy(Corner(4) * Transform);
-		NewAABB.ExpandBy(Corner(5) * Transform);
-		NewAABB.ExpandBy(Corner(6) * Transform);
-		NewAABB.ExpandBy(Corner(7) * Transform);
+		using namespace SIMD;
+
+		// Equivalent to transforming all 8 corners: each axis contributes the smaller of its min & max
+		// products to the new minimum, and the larger to the new maximum.
+		Float4 newMin = LoadAligned(Transform[3]);
+		Float4 newMax = newMin;
+		for(u32 i = 0; i < 3; ++i)
+		{
+			const Float4 row = LoadAligned(Transform[i]);
+			const Float4 a = Mul(Splat((&Min_.x)[i]), row);
+			const Float4 b = Mul(Splat((&Max_.x)[i]), row);
+			newMin = Add(newMin, Min(a, b));
+			newMax = Add(newMax, Max(a, b));
+		}
+
+		alignas(16) f32 outMin[4];
+		alignas(16) f32 outMax[4];
+		StoreAligned(outMin, newMin);
+		StoreAligned(outMax, newMax);
+		AABB NewAABB(Vec3(outMin[0], outMin[1], outMin[2]), Vec3(outMax[0], outMax[1], outMax[2]));
 
 		DBG_ASSERT(!NewAABB.IsEmpty());
 		return NewAABB;
@@ -1,6 +1,7 @@
 #include "math/mat33.h"
 #include "math/mat44.h"
 
+#include "math/simd.h"
 #include "math/vec2.h"
 #include "math/vec3.h"
 
@@ -26,23 +27,9 @@ namespace Math
 
 	Mat44 Mat44::operator*(const Mat44& Rhs) const
 	{
-		const Mat44& Lhs = (*this);
-		return Mat44(Lhs[0][0] * Rhs[0][0] + Lhs[0][1] * Rhs[1][0] + Lhs[0][2] * Rhs[2][0] + Lhs[0][3] * Rhs[3][0],
-		    Lhs[0][0] * Rhs[0][1] + Lhs[0][1] * Rhs[1][1] + Lhs[0][2] * Rhs[2][1] + Lhs[0][3] * Rhs[3][1],
-		    Lhs[0][0] * Rhs[0][2] + Lhs[0][1] * Rhs[1][2] + Lhs[0][2] * Rhs[2][2] + Lhs[0][3] * Rhs[3][2],
-		    Lhs[0][0] * Rhs[0][3] + Lhs[0][1] * Rhs[1][3] + Lhs[0][2] * Rhs[2][3] + Lhs[0][3] * Rhs[3][3],
-		    Lhs[1][0] * Rhs[0][0] + Lhs[1][1] * Rhs[1][0] + Lhs[1][2] * Rhs[2][0] + Lhs[1][3] * Rhs[3][0],
-		    Lhs[1][0] * Rhs[0][1] + Lhs[1][1] * Rhs[1][1] + Lhs[1][2] * Rhs[2][1] + Lhs[1][3] * Rhs[3][1],
-		    Lhs[1][0] * Rhs[0][2] + Lhs[1][1] * Rhs[1][2] + Lhs[1][2] * Rhs[2][2] + Lhs[1][3] * Rhs[3][2],
-		    Lhs[1][0] * Rhs[0][3] + Lhs[1][1] * Rhs[1][3] + Lhs[1][2] * Rhs[2][3] + Lhs[1][3] * Rhs[3][3],
-		    Lhs[2][0] * Rhs[0][0] + Lhs[2][1] * Rhs[1][0] + Lhs[2][2] * Rhs[2][0] + Lhs[2][3] * Rhs[3][0],
-		    Lhs[2][0] * Rhs[0][1] + Lhs[2][1] * Rhs[1][1] + Lhs[2][2] * Rhs[2][1] + Lhs[2][3] * Rhs[3][1],
-		    Lhs[2][0] * Rhs[0][2] + Lhs[2][1] * Rhs[1][2] + Lhs[2][2] * Rhs[2][2] + Lhs[2][3] * Rhs[3][2],
-		    Lhs[2][0] * Rhs[0][3] + Lhs[2][1] * Rhs[1][3] + Lhs[2][2] * Rhs[2][3] + Lhs[2][3] * Rhs[3][3],
-		    Lhs[3][0] * Rhs[0][0] + Lhs[3][1] * Rhs[1][0] + Lhs[3][2] * Rhs[2][0] + Lhs[3][3] * Rhs[3][0],
-		    Lhs[3][0] * Rhs[0][1] + Lhs[3][1] * Rhs[1][1] + Lhs[3][2] * Rhs[2][1] + Lhs[3][3] * Rhs[3][1],
-		    Lhs[3][0] * Rhs[0][2] + Lhs[3][1] * Rhs[1][2] + Lhs[3][2] * Rhs[2][2] + Lhs[3][3] * Rhs[3][2],
-		    Lhs[3][0] * Rhs[0][3] + Lhs[3][1] * Rhs[1][3] + Lhs[3][2] * Rhs[2][3] + Lhs[3][3] * Rhs[3][3]);
+		Mat44 Out;
+		SIMD::MulMatrix44(Out[0], (*this)[0], Rhs[0]);
+		return Out;
 	}
 
 	f32 Mat44::Determinant()
@@ -80,76 +67,80 @@ namespace Math
 		Row2_ = Vec4(-sy * cr + cy * sp * sr, sr * sy + cy * sp * cr, cy * cp, 0.0f);
 	}
 
+	namespace
+	{
+		using namespace SIMD;
+
+		/// 2x2 row major matrix multiply, A * B.
+		inline Float4 Mat22Mul(Float4 a, Float4 b)
+		{
+			return Add(Mul(a, Swizzle<0, 3, 0, 3>(b)), Mul(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+		}
+
+		/// 2x2 row major matrix adjugate multiply, A# * B.
+		inline Float4 Mat22AdjMul(Float4 a, Float4 b)
+		{
+			return Sub(Mul(Swizzle<3, 3, 0, 0>(a), b), Mul(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b)));
+		}
+
+		/// 2x2 row major matrix multiply adjugate, A * B#.
+		inline Float4 Mat22MulAdj(Float4 a, Float4 b)
+		{
+			return Sub(Mul(a, Swizzle<3, 0, 3, 0>(b)), Mul(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+		}
+	}
+
 	void Mat44::Inverse()
 	{
-		const Mat44& Lhs = (*this);
-		f32 Det, InvDet;
-
-		const f32 Det2_01_01 = Lhs[0][0] * Lhs[1][1] - Lhs[0][1] * Lhs[1][0];
-		const f32 Det2_01_02 = Lhs[0][0] * Lhs[1][2] - Lhs[0][2] * Lhs[1][0];
-		const f32 Det2_01_03 = Lhs[0][0] * Lhs[1][3] - Lhs[0][3] * Lhs[1][0];
-		const f32 Det2_01_12 = Lhs[0][1] * Lhs[1][2] - Lhs[0][2] * Lhs[1][1];
-		const f32 Det2_01_13 = Lhs[0][1] * Lhs[1][3] - Lhs[0][3] * Lhs[1][1];
-		const f32 Det2_01_23 = Lhs[0][2] * Lhs[1][3] - Lhs[0][3] * Lhs[1][2];
-
-		const f32 Det3_201_012 = Lhs[2][0] * Det2_01_12 - Lhs[2][1] * Det2_01_02 + Lhs[2][2] * Det2_01_01;
-		const f32 Det3_201_013 = Lhs[2][0] * Det2_01_13 - Lhs[2][1] * Det2_01_03 + Lhs[2][3] * Det2_01_01;
-		const f32 Det3_201_023 = Lhs[2][0] * Det2_01_23 - Lhs[2][2] * Det2_01_03 + Lhs[2][3] * Det2_01_02;
-		const f32 Det3_201_123 = Lhs[2][1] * Det2_01_23 - Lhs[2][2] * Det2_01_13 + Lhs[2][3] * Det2_01_12;
-
-		Det = (-Det3_201_123 * Lhs[3][0] + Det3_201_023 * Lhs[3][1] - Det3_201_013 * Lhs[3][2] +
-		       Det3_201_012 * Lhs[3][3]);
-
-		InvDet = 1.0f / Det;
-
-		const f32 Det2_03_01 = Lhs[0][0] * Lhs[3][1] - Lhs[0][1] * Lhs[3][0];
-		const f32 Det2_03_02 = Lhs[0][0] * Lhs[3][2] - Lhs[0][2] * Lhs[3][0];
-		const f32 Det2_03_03 = Lhs[0][0] * Lhs[3][3] - Lhs[0][3] * Lhs[3][0];
-		const f32 Det2_03_12 = Lhs[0][1] * Lhs[3][2] - Lhs[0][2] * Lhs[3][1];
-		const f32 Det2_03_13 = Lhs[0][1] * Lhs[3][3] - Lhs[0][3] * Lhs[3][1];
-		const f32 Det2_03_23 = Lhs[0][2] * Lhs[3][3] - Lhs[0][3] * Lhs[3][2];
-
-		const f32 Det2_13_01 = Lhs[1][0] * Lhs[3][1] - Lhs[1][1] * Lhs[3][0];
-		const f32 Det2_13_02 = Lhs[1][0] * Lhs[3][2] - Lhs[1][2] * Lhs[3][0];
-		const f32 Det2_13_03 = Lhs[1][0] * Lhs[3][3] - Lhs[1][3] * Lhs[3][0];
-		const f32 Det2_13_12 = Lhs[1][1] * Lhs[3][2] - Lhs[1][2] * Lhs[3][1];
-		const f32 Det2_13_13 = Lhs[1][1] * Lhs[3][3] - Lhs[1][3] * Lhs[3][1];
-		const f32 Det2_13_23 = Lhs[1][2] * Lhs[3][3] - Lhs[1][3] * Lhs[3][2];
-
-		const f32 Det3_203_012 = Lhs[2][0] * Det2_03_12 - Lhs[2][1] * Det2_03_02 + Lhs[2][2] * Det2_03_01;
-		const f32 Det3_203_013 = Lhs[2][0] * Det2_03_13 - Lhs[2][1] * Det2_03_03 + Lhs[2][3] * Det2_03_01;
-		const f32 Det3_203_023 = Lhs[2][0] * Det2_03_23 - Lhs[2][2] * Det2_03_03 + Lhs[2][3] * Det2_03_02;
-		const f32 Det3_203_123 = Lhs[2][1] * Det2_03_23 - Lhs[2][2] * Det2_03_13 + Lhs[2][3] * Det2_03_12;
-
-		const f32 Det3_213_012 = Lhs[2][0] * Det2_13_12 - Lhs[2][1] * Det2_13_02 + Lhs[2][2] * Det2_13_01;
-		const f32 Det3_213_013 = Lhs[2][0] * Det2_13_13 - Lhs[2][1] * Det2_13_03 + Lhs[2][3] * Det2_13_01;
-		const f32 Det3_213_023 = Lhs[2][0] * Det2_13_23 - Lhs[2][2] * Det2_13_03 + Lhs[2][3] * Det2_13_02;
-		const f32 Det3_213_123 = Lhs[2][1] * Det2_13_23 - Lhs[2][2] * Det2_13_13 + Lhs[2][3] * Det2_13_12;
-
-		const f32 Det3_301_012 = Lhs[3][0] * Det2_01_12 - Lhs[3][1] * Det2_01_02 + Lhs[3][2] * Det2_01_01;
-		const f32 Det3_301_013 = Lhs[3][0] * Det2_01_13 - Lhs[3][1] * Det2_01_03 + Lhs[3][3] * Det2_01_01;
-		const f32 Det3_301_023 = Lhs[3][0] * Det2_01_23 - Lhs[3][2] * Det2_01_03 + Lhs[3][3] * Det2_01_02;
-		const f32 Det3_301_123 = Lhs[3][1] * Det2_01_23 - Lhs[3][2] * Det2_01_13 + Lhs[3][3] * Det2_01_12;
-
-		Row0_.x = -Det3_213_123 * InvDet;
-		Row1_.x = Det3_213_023 * InvDet;
-		Row2_.x = -Det3_213_013 * InvDet;
-		Row3_.x = Det3_213_012 * InvDet;
-
-		Row0_.y = Det3_203_123 * InvDet;
-		Row1_.y = -Det3_203_023 * InvDet;
-		Row2_.y = Det3_203_013 * InvDet;
-		Row3_.y = -Det3_203_012 * InvDet;
-
-		Row0_.z = Det3_301_123 * InvDet;
-		Row1_.z = -Det3_301_023 * InvDet;
-		Row2_.z = Det3_301_013 * InvDet;
-		Row3_.z = -Det3_301_012 * InvDet;
-
-		Row0_.w = -Det3_201_123 * InvDet;
-		Row1_.w = Det3_201_023 * InvDet;
-		Row2_.w = -Det3_201_013 * InvDet;
-		Row3_.w = Det3_201_012 * InvDet;
+		// Block-wise inverse, splitting into 2x2 sub matrices:
+		// | A B |-1    1   | X Y |
+		// | C D |    = --- | Z W |
+		//              |M|
+		const Float4 row0 = LoadAligned((*this)[0]);
+		const Float4 row1 = LoadAligned((*this)[1]);
+		const Float4 row2 = LoadAligned((*this)[2]);
+		const Float4 row3 = LoadAligned((*this)[3]);
+
+		const Float4 A = Shuffle<0, 1, 0, 1>(row0, row1);
+		const Float4 B = Shuffle<2, 3, 2, 3>(row0, row1);
+		const Float4 C = Shuffle<0, 1, 0, 1>(row2, row3);
+		const Float4 D = Shuffle<2, 3, 2, 3>(row2, row3);
+
+		// (|A|, |B|, |C|, |D|)
+		const Float4 detSub = Sub(Mul(Shuffle<0, 2, 0, 2>(row0, row2), Shuffle<1, 3, 1, 3>(row1, row3)),
+		    Mul(Shuffle<1, 3, 1, 3>(row0, row2), Shuffle<0, 2, 0, 2>(row1, row3)));
+		const Float4 detA = Splat<0>(detSub);
+		const Float4 detB = Splat<1>(detSub);
+		const Float4 detC = Splat<2>(detSub);
+		const Float4 detD = Splat<3>(detSub);
+
+		const Float4 D_C = Mat22AdjMul(D, C);
+		const Float4 A_B = Mat22AdjMul(A, B);
+
+		// X# = |D|A - B(D#C), W# = |A|D - C(A#B)
+		Float4 X_ = Sub(Mul(detD, A), Mat22Mul(B, D_C));
+		Float4 W_ = Sub(Mul(detA, D), Mat22Mul(C, A_B));
+		// Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+		Float4 Y_ = Sub(Mul(detB, C), Mat22MulAdj(D, A_B));
+		Float4 Z_ = Sub(Mul(detC, B), Mat22MulAdj(A, D_C));
+
+		// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+		Float4 tr = Mul(A_B, Swizzle<0, 2, 1, 3>(D_C));
+		tr = Add(tr, Swizzle<1, 0, 3, 2>(tr));
+		tr = Add(tr, Swizzle<2, 3, 0, 1>(tr));
+		const Float4 detM = Sub(Add(Mul(detA, detD), Mul(detB, detC)), tr);
+
+		const Float4 rcpDetM = Div(Set(1.0f, -1.0f, -1.0f, 1.0f), detM);
+		X_ = Mul(X_, rcpDetM);
+		Y_ = Mul(Y_, rcpDetM);
+		Z_ = Mul(Z_, rcpDetM);
+		W_ = Mul(W_, rcpDetM);
+
+		// Apply adjugate while storing.
+		StoreAligned((*this)[0], Shuffle<3, 1, 3, 1>(X_, Y_));
+		StoreAligned((*this)[1], Shuffle<2, 0, 2, 0>(X_, Y_));
+		StoreAligned((*this)[2], Shuffle<3, 1, 3, 1>(Z_, W_));
+		StoreAligned((*this)[3], Shuffle<2, 0, 2, 0>(Z_, W_));
 	}
 
 	void Mat44::LookAt(const Vec3& position, const Vec3& lookAt, const Vec3& upVec)
@@ -253,17 +244,28 @@ namespace Math
 
 	Vec3 operator*(const Vec3& Lhs, const Mat44& Rhs)
 	{
-		return Vec3(Lhs.x * Rhs[0][0] + Lhs.y * Rhs[1][0] + Lhs.z * Rhs[2][0] + Rhs[3][0],
-		    Lhs.x * Rhs[0][1] + Lhs.y * Rhs[1][1] + Lhs.z * Rhs[2][1] + Rhs[3][1],
-		    Lhs.x * Rhs[0][2] + Lhs.y * Rhs[1][2] + Lhs.z * Rhs[2][2] + Rhs[3][2]);
+		using namespace SIMD;
+		Float4 out = Mul(Splat(Lhs.x), LoadAligned(Rhs[0]));
+		out = MulAdd(Splat(Lhs.y), LoadAligned(Rhs[1]), out);
+		out = MulAdd(Splat(Lhs.z), LoadAligned(Rhs[2]), out);
+		out = Add(out, LoadAligned(Rhs[3]));
+
+		alignas(16) f32 result[4];
+		StoreAligned(result, out);
+		return Vec3(result[0], result[1], result[2]);
 	}
 
 	Vec4 operator*(const Vec4& Lhs, const Mat44& Rhs)
 	{
-		return Vec4(Lhs.x * Rhs[0][0] + Lhs.y * Rhs[1][0] + Lhs.z * Rhs[2][0] + Lhs.w * Rhs[3][0],
-		    Lhs.x * Rhs[0][1] + Lhs.y * Rhs[1][1] + Lhs.z * Rhs[2][1] + Lhs.w * Rhs[3][1],
-		    Lhs.x * Rhs[0][2] + Lhs.y * Rhs[1][2] + Lhs.z * Rhs[2][2] + Lhs.w * Rhs[3][2],
-		    Lhs.x * Rhs[0][3] + Lhs.y * Rhs[1][3] + Lhs.z * Rhs[2][3] + Lhs.w * Rhs[3][3]);
+		using namespace SIMD;
+		Float4 out = Mul(Splat(Lhs.x), LoadAligned(Rhs[0]));
+		out = MulAdd(Splat(Lhs.y), LoadAligned(Rhs[1]), out);
+		out = MulAdd(Splat(Lhs.z), LoadAligned(Rhs[2]), out);
+		out = MulAdd(Splat(Lhs.w), LoadAligned(Rhs[3]), out);
+
+		Vec4 result;
+		Store(&result.x, out);
+		return result;
 	}
 
 } // namespace Math
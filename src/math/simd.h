@@ -0,0 +1,220 @@
+#pragma once
+
+#include "core/portability.h"
+#include "core/types.h"
+
+/**
+ * 4 wide SIMD abstraction used to implement math types.
+ * SSE2 on x86, NEON on ARM, and a scalar fallback elsewhere.
+ * Define MATH_SIMD to 0 to force the scalar fallback.
+ */
+#if !defined(MATH_SIMD)
+#define MATH_SIMD 1
+#endif
+
+#if MATH_SIMD && (ARCH_X86_64 || ARCH_X86)
+#define MATH_SIMD_SSE 1
+#include <emmintrin.h>
+#elif MATH_SIMD && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define MATH_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define MATH_SIMD_SCALAR 1
+#endif
+
+namespace Math
+{
+	namespace SIMD
+	{
+#if MATH_SIMD_SSE
+		using Float4 = __m128;
+
+		inline Float4 Load(const f32* src) { return _mm_loadu_ps(src); }
+		inline Float4 LoadAligned(const f32* src) { return _mm_load_ps(src); }
+		inline void Store(f32* dst, Float4 v) { _mm_storeu_ps(dst, v); }
+		inline void StoreAligned(f32* dst, Float4 v) { _mm_store_ps(dst, v); }
+		inline Float4 Set(f32 x, f32 y, f32 z, f32 w) { return _mm_setr_ps(x, y, z, w); }
+		inline Float4 Splat(f32 v) { return _mm_set1_ps(v); }
+		inline Float4 Zero() { return _mm_setzero_ps(); }
+
+		inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+		inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+		inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+		inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+		inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+		inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+		inline Float4 Abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+		/// (a[X], a[Y], b[Z], b[W])
+		template<i32 X, i32 Y, i32 Z, i32 W>
+		inline Float4 Shuffle(Float4 a, Float4 b)
+		{
+			return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+		}
+
+		/// Bit mask of lanes where a >= b, lane 0 in bit 0.
+		inline i32 MaskGreaterEqual(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmpge_ps(a, b)); }
+
+#elif MATH_SIMD_NEON
+		using Float4 = float32x4_t;
+
+		inline Float4 Load(const f32* src) { return vld1q_f32(src); }
+		inline Float4 LoadAligned(const f32* src) { return vld1q_f32(src); }
+		inline void Store(f32* dst, Float4 v) { vst1q_f32(dst, v); }
+		inline void StoreAligned(f32* dst, Float4 v) { vst1q_f32(dst, v); }
+		inline Float4 Set(f32 x, f32 y, f32 z, f32 w)
+		{
+			const f32 v[4] = {x, y, z, w};
+			return vld1q_f32(v);
+		}
+		inline Float4 Splat(f32 v) { return vdupq_n_f32(v); }
+		inline Float4 Zero() { return vdupq_n_f32(0.0f); }
+
+		inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+		inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+		inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+		inline Float4 Div(Float4 a, Float4 b)
+		{
+#if defined(__aarch64__) || defined(_M_ARM64)
+			return vdivq_f32(a, b);
+#else
+			// Reciprocal estimate with two Newton-Raphson steps.
+			Float4 r = vrecpeq_f32(b);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			return vmulq_f32(a, r);
+#endif
+		}
+		inline Float4 Min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+		inline Float4 Max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+		inline Float4 Abs(Float4 a) { return vabsq_f32(a); }
+
+		template<i32 X, i32 Y, i32 Z, i32 W>
+		inline Float4 Shuffle(Float4 a, Float4 b)
+		{
+			Float4 r = vdupq_n_f32(vgetq_lane_f32(a, X));
+			r = vsetq_lane_f32(vgetq_lane_f32(a, Y), r, 1);
+			r = vsetq_lane_f32(vgetq_lane_f32(b, Z), r, 2);
+			r = vsetq_lane_f32(vgetq_lane_f32(b, W), r, 3);
+			return r;
+		}
+
+		inline i32 MaskGreaterEqual(Float4 a, Float4 b)
+		{
+			const uint32x4_t ge = vcgeq_f32(a, b);
+			return (vgetq_lane_u32(ge, 0) & 1) | (vgetq_lane_u32(ge, 1) & 2) | (vgetq_lane_u32(ge, 2) & 4) |
+			       (vgetq_lane_u32(ge, 3) & 8);
+		}
+
+#else
+		struct Float4
+		{
+			f32 v[4];
+		};
+
+		inline Float4 Load(const f32* src) { return {{src[0], src[1], src[2], src[3]}}; }
+		inline Float4 LoadAligned(const f32* src) { return Load(src); }
+		inline void Store(f32* dst, Float4 a)
+		{
+			for(i32 i = 0; i < 4; ++i)
+				dst[i] = a.v[i];
+		}
+		inline void StoreAligned(f32* dst, Float4 a) { Store(dst, a); }
+		inline Float4 Set(f32 x, f32 y, f32 z, f32 w) { return {{x, y, z, w}}; }
+		inline Float4 Splat(f32 v) { return {{v, v, v, v}}; }
+		inline Float4 Zero() { return Splat(0.0f); }
+
+#define MATH_SIMD_SCALAR_OP(NAME, EXPR)                                                                                \
+	inline Float4 NAME(Float4 a, Float4 b)                                                                             \
+	{                                                                                                                  \
+		Float4 r;                                                                                                      \
+		for(i32 i = 0; i < 4; ++i)                                                                                     \
+			r.v[i] = EXPR;                                                                                             \
+		return r;                                                                                                      \
+	}
+
+		MATH_SIMD_SCALAR_OP(Add, a.v[i] + b.v[i])
+		MATH_SIMD_SCALAR_OP(Sub, a.v[i] - b.v[i])
+		MATH_SIMD_SCALAR_OP(Mul, a.v[i] * b.v[i])
+		MATH_SIMD_SCALAR_OP(Div, a.v[i] / b.v[i])
+		MATH_SIMD_SCALAR_OP(Min, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+		MATH_SIMD_SCALAR_OP(Max, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+#undef MATH_SIMD_SCALAR_OP
+
+		inline Float4 Abs(Float4 a)
+		{
+			for(i32 i = 0; i < 4; ++i)
+				a.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i];
+			return a;
+		}
+
+		template<i32 X, i32 Y, i32 Z, i32 W>
+		inline Float4 Shuffle(Float4 a, Float4 b)
+		{
+			return {{a.v[X], a.v[Y], b.v[Z], b.v[W]}};
+		}
+
+		inline i32 MaskGreaterEqual(Float4 a, Float4 b)
+		{
+			i32 mask = 0;
+			for(i32 i = 0; i < 4; ++i)
+				mask |= a.v[i] >= b.v[i] ? (1 << i) : 0;
+			return mask;
+		}
+
+#endif
+
+		/// (a[X], a[Y], a[Z], a[W])
+		template<i32 X, i32 Y, i32 Z, i32 W>
+		inline Float4 Swizzle(Float4 a)
+		{
+			return Shuffle<X, Y, Z, W>(a, a);
+		}
+
+		/// Broadcast lane @a L to all lanes.
+		template<i32 L>
+		inline Float4 Splat(Float4 a)
+		{
+			return Shuffle<L, L, L, L>(a, a);
+		}
+
+		/// a * b + c, evaluated as a multiply then an add so results match scalar code.
+		inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return Add(Mul(a, b), c); }
+
+		/// Transpose 4x4 matrix held in rows @a r0 to @a r3.
+		inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+		{
+			const Float4 t0 = Shuffle<0, 1, 0, 1>(r0, r1);
+			const Float4 t1 = Shuffle<2, 3, 2, 3>(r0, r1);
+			const Float4 t2 = Shuffle<0, 1, 0, 1>(r2, r3);
+			const Float4 t3 = Shuffle<2, 3, 2, 3>(r2, r3);
+			r0 = Shuffle<0, 2, 0, 2>(t0, t2);
+			r1 = Shuffle<1, 3, 1, 3>(t0, t2);
+			r2 = Shuffle<0, 2, 0, 2>(t1, t3);
+			r3 = Shuffle<1, 3, 1, 3>(t1, t3);
+		}
+
+		/**
+		 * 4x4 row major matrix multiply, @a out = @a lhs * @a rhs.
+		 * Each output row is a linear combination of rhs rows, summed in the same order as the scalar form.
+		 * All matrices must be 16 byte aligned. @a out may alias @a lhs, but not @a rhs.
+		 */
+		inline void MulMatrix44(f32* out, const f32* lhs, const f32* rhs)
+		{
+			const Float4 rhs0 = LoadAligned(rhs + 0);
+			const Float4 rhs1 = LoadAligned(rhs + 4);
+			const Float4 rhs2 = LoadAligned(rhs + 8);
+			const Float4 rhs3 = LoadAligned(rhs + 12);
+			for(i32 i = 0; i < 16; i += 4)
+			{
+				const Float4 row = LoadAligned(lhs + i);
+				Float4 result = Mul(Splat<0>(row), rhs0);
+				result = MulAdd(Splat<1>(row), rhs1, result);
+				result = MulAdd(Splat<2>(row), rhs2, result);
+				result = MulAdd(Splat<3>(row), rhs3, result);
+				StoreAligned(out + i, result);
+			}
+		}
+
+	} // namespace SIMD
+} // namespace Math
@@ -0,0 +1,216 @@
+#include "core/debug.h"
+#include "core/misc.h"
+#include "core/random.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "math/aabb.h"
+#include "math/mat44.h"
+#include "math/simd.h"
+
+#include "catch.hpp"
+
+#include <cmath>
+
+namespace
+{
+	// Scalar reference implementations, as they were before SIMD.
+	Math::Mat44 ScalarMul(const Math::Mat44& Lhs, const Math::Mat44& Rhs)
+	{
+		Math::Mat44 Out;
+		for(u32 i = 0; i < 4; ++i)
+			for(u32 j = 0; j < 4; ++j)
+				Out[i][j] =
+				    Lhs[i][0] * Rhs[0][j] + Lhs[i][1] * Rhs[1][j] + Lhs[i][2] * Rhs[2][j] + Lhs[i][3] * Rhs[3][j];
+		return Out;
+	}
+
+	Math::Vec4 ScalarTransform(const Math::Vec4& Lhs, const Math::Mat44& Rhs)
+	{
+		return Math::Vec4(Lhs.x * Rhs[0][0] + Lhs.y * Rhs[1][0] + Lhs.z * Rhs[2][0] + Lhs.w * Rhs[3][0],
+		    Lhs.x * Rhs[0][1] + Lhs.y * Rhs[1][1] + Lhs.z * Rhs[2][1] + Lhs.w * Rhs[3][1],
+		    Lhs.x * Rhs[0][2] + Lhs.y * Rhs[1][2] + Lhs.z * Rhs[2][2] + Lhs.w * Rhs[3][2],
+		    Lhs.x * Rhs[0][3] + Lhs.y * Rhs[1][3] + Lhs.z * Rhs[2][3] + Lhs.w * Rhs[3][3]);
+	}
+
+	Math::Vec3 ScalarTransform(const Math::Vec3& Lhs, const Math::Mat44& Rhs)
+	{
+		return Math::Vec3(Lhs.x * Rhs[0][0] + Lhs.y * Rhs[1][0] + Lhs.z * Rhs[2][0] + Rhs[3][0],
+		    Lhs.x * Rhs[0][1] + Lhs.y * Rhs[1][1] + Lhs.z * Rhs[2][1] + Rhs[3][1],
+		    Lhs.x * Rhs[0][2] + Lhs.y * Rhs[1][2] + Lhs.z * Rhs[2][2] + Rhs[3][2]);
+	}
+
+	/// Cofactor expansion.
+	Math::Mat44 ScalarInverse(const Math::Mat44& m)
+	{
+		f32 inv[16];
+		const f32* a = m[0];
+		inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] +
+		         a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+		inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] -
+		         a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+		inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] +
+		         a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+		inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] -
+		          a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+		inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] -
+		         a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+		inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] +
+		         a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+		inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] -
+		         a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+		inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] +
+		          a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+		inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] +
+		         a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+		inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] -
+		         a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+		inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] +
+		          a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+		inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] -
+		          a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+		inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] -
+		         a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+		inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] +
+		         a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+		inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] -
+		          a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+		inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] +
+		          a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+		const f32 invDet = 1.0f / (a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12]);
+		for(f32& v : inv)
+			v *= invDet;
+		return Math::Mat44(inv);
+	}
+
+	Math::AABB ScalarTransform(const Math::AABB& aabb, const Math::Mat44& transform)
+	{
+		Math::AABB out;
+		for(u32 i = 0; i < 8; ++i)
+			out.ExpandBy(ScalarTransform(aabb.Corner(i), transform));
+		return out;
+	}
+
+	f32 RandomFloat(Core::Random& rng) { return (f32)(rng.Generate() & 0xffff) / 32767.5f - 1.0f; }
+
+	Math::Mat44 RandomTransform(Core::Random& rng)
+	{
+		Math::Mat44 rotation;
+		rotation.Rotation(Math::Vec3(RandomFloat(rng) * 3.0f, RandomFloat(rng) * 3.0f, RandomFloat(rng) * 3.0f));
+		Math::Mat44 scale;
+		scale.Scale(Math::Vec3(1.5f + RandomFloat(rng), 1.5f + RandomFloat(rng), 1.5f + RandomFloat(rng)));
+		Math::Mat44 out = scale * rotation;
+		out.Translation(Math::Vec3(RandomFloat(rng) * 100.0f, RandomFloat(rng) * 100.0f, RandomFloat(rng) * 100.0f));
+		return out;
+	}
+
+	f32 MaxError(const Math::Mat44& a, const Math::Mat44& b)
+	{
+		f32 error = 0.0f;
+		for(u32 i = 0; i < 4; ++i)
+			for(u32 j = 0; j < 4; ++j)
+				error = Core::Max(error, std::abs(a[i][j] - b[i][j]));
+		return error;
+	}
+
+	f32 MaxError(const Math::Vec3& a, const Math::Vec3& b)
+	{
+		return Core::Max(std::abs(a.x - b.x), Core::Max(std::abs(a.y - b.y), std::abs(a.z - b.z)));
+	}
+}
+
+TEST_CASE("simd-tests-mat44")
+{
+	Core::Random rng;
+	for(i32 i = 0; i < 256; ++i)
+	{
+		const Math::Mat44 a = RandomTransform(rng);
+		const Math::Mat44 b = RandomTransform(rng);
+
+		// Summed in the same order, so must match exactly.
+		CHECK(a * b == ScalarMul(a, b));
+
+		const Math::Vec4 v(RandomFloat(rng), RandomFloat(rng), RandomFloat(rng), 1.0f);
+		CHECK(v * a == ScalarTransform(v, a));
+		const Math::Vec3 v3(v.x, v.y, v.z);
+		CHECK(v3 * a == ScalarTransform(v3, a));
+
+		Math::Mat44 inverse = a;
+		inverse.Inverse();
+		CHECK(MaxError(inverse, ScalarInverse(a)) < 1e-4f);
+		CHECK(MaxError(a * inverse, Math::Mat44()) < 1e-4f);
+
+		const Math::Vec3 minimum(RandomFloat(rng), RandomFloat(rng), RandomFloat(rng));
+		const Math::AABB aabb(minimum, minimum + Math::Vec3(1.0f, 2.0f, 3.0f));
+		const Math::AABB transformed = aabb.Transform(a);
+		const Math::AABB reference = ScalarTransform(aabb, a);
+		CHECK(MaxError(transformed.Minimum(), reference.Minimum()) < 1e-4f);
+		CHECK(MaxError(transformed.Maximum(), reference.Maximum()) < 1e-4f);
+	}
+}
+
+TEST_CASE("simd-tests-benchmark")
+{
+	const i32 NUM_ITEMS = 4096;
+	const i32 NUM_ITERATIONS = 256;
+
+	Core::Random rng;
+	Core::Vector<Math::Mat44> matrices;
+	Core::Vector<Math::Mat44> outMatrices;
+	Core::Vector<Math::Vec4> vectors;
+	Core::Vector<Math::Vec4> outVectors;
+	Core::Vector<Math::AABB> boxes;
+	Core::Vector<Math::AABB> outBoxes;
+	matrices.reserve(NUM_ITEMS);
+	vectors.reserve(NUM_ITEMS);
+	boxes.reserve(NUM_ITEMS);
+	for(i32 i = 0; i < NUM_ITEMS; ++i)
+	{
+		matrices.push_back(RandomTransform(rng));
+		vectors.push_back(Math::Vec4(RandomFloat(rng), RandomFloat(rng), RandomFloat(rng), 1.0f));
+		const Math::Vec3 minimum(RandomFloat(rng), RandomFloat(rng), RandomFloat(rng));
+		boxes.push_back(Math::AABB(minimum, minimum + Math::Vec3(1.0f, 1.0f, 1.0f)));
+	}
+	outMatrices.resize(NUM_ITEMS);
+	outVectors.resize(NUM_ITEMS);
+	outBoxes.resize(NUM_ITEMS);
+
+	const Math::Mat44 transform = RandomTransform(rng);
+
+	// Returns nanoseconds per operation.
+	auto Measure = [&](auto&& func) {
+		Core::Timer timer;
+		timer.Mark();
+		for(i32 iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+			for(i32 i = 0; i < NUM_ITEMS; ++i)
+				func(i);
+		return (timer.GetTime() * 1000000000.0) / ((f64)NUM_ITEMS * NUM_ITERATIONS);
+	};
+
+	struct Result
+	{
+		const char* name_;
+		f64 scalar_;
+		f64 simd_;
+	};
+
+	const Result results[] = {
+	    {"Mat44 * Mat44", Measure([&](i32 i) { outMatrices[i] = ScalarMul(matrices[i], transform); }),
+	        Measure([&](i32 i) { outMatrices[i] = matrices[i] * transform; })},
+	    {"Vec4 * Mat44", Measure([&](i32 i) { outVectors[i] = ScalarTransform(vectors[i], transform); }),
+	        Measure([&](i32 i) { outVectors[i] = vectors[i] * transform; })},
+	    {"Mat44::Inverse", Measure([&](i32 i) { outMatrices[i] = ScalarInverse(matrices[i]); }), Measure([&](i32 i) {
+		     outMatrices[i] = matrices[i];
+		     outMatrices[i].Inverse();
+		 })},
+	    {"AABB::Transform", Measure([&](i32 i) { outBoxes[i] = ScalarTransform(boxes[i], transform); }),
+	        Measure([&](i32 i) { outBoxes[i] = boxes[i].Transform(transform); })},
+	};
+
+	Core::Log("Math, %d items x %d iterations:\n", NUM_ITEMS, NUM_ITERATIONS);
+	for(const auto& result : results)
+	{
+		Core::Log(" - %-16s %8.2f ns (scalar), %8.2f ns (simd), %5.2fx\n", result.name_, result.scalar_,
+		    result.simd_, result.scalar_ / result.simd_);
+	}
+}
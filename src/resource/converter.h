@@ -55,6 +55,14 @@ namespace Resource
 		 */
 		virtual void AddError(const char* errorFile, int errorLine, const char* errorMsg, ...) = 0;
 
+		/**
+		 * Add timing.
+		 * Time taken by a stage of conversion, to help track down slow conversions.
+		 * @param stage Name of stage.
+		 * @param time Time in seconds.
+		 */
+		virtual void AddTiming(const char* stage, f64 time) = 0;
+
 		/**
 		 * Get path resolver.
 		 */
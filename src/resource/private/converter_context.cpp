@@ -46,6 +46,11 @@ namespace Resource
 		Core::Log("\n");
 	}
 
+	void ConverterContext::AddTiming(const char* stage, f64 time)
+	{
+		Core::Log("...%s: %.2f ms.\n", stage, time * 1000.0);
+	}
+
 	Core::IFilePathResolver* ConverterContext::GetPathResolver() { return pathResolver_; }
 
 	bool ConverterContext::Convert(IConverter* converter, const char* sourceFile, const char* destPath)
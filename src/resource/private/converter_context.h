@@ -16,6 +16,7 @@ namespace Resource
 		void AddResourceDependency(const char* fileName, const Core::UUID& type) override;
 		void AddOutput(const char* fileName) override;
 		void AddError(const char* errorFile, int errorLine, const char* errorMsg, ...) override;
+		void AddTiming(const char* stage, f64 time) override;
 		Core::IFilePathResolver* GetPathResolver() override;
 		bool Convert(IConverter* converter, const char* sourceFile, const char* destPath);
 		void SetMetaData(MetaDataCb callback, void* metaData) override;
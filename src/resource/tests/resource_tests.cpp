@@ -43,6 +43,11 @@ namespace
 			Core::Log("\n");
 		}
 
+		void AddTiming(const char* stage, f64 time) override
+		{
+			Core::Log("AddTiming: %s %.2f ms\n", stage, time * 1000.0);
+		}
+
 		Core::IFilePathResolver* GetPathResolver() override { return nullptr; }
 
 		void SetMetaData(MetaDataCb callback, void* metaData) override {}